@@ -0,0 +1,242 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Builds the API Trace response text from the calls that each thread
+///         logged during a traced frame.
+//==============================================================================
+
+#include "APITraceBuilder.h"
+#include "MultithreadedTraceAnalyzerLayer.h"
+#include "ThreadTraceRegistry.h"
+#include "BinaryTraceFile.h"
+#include <queue>
+
+//--------------------------------------------------------------------------
+/// The position of the next call to merge from a single thread's trace buffer.
+//--------------------------------------------------------------------------
+struct TraceMergeCursor
+{
+    /// The start time of the call at mEntryIndex.
+    UINT64 mStartTime;
+
+    /// The registry slot of the thread. Used to keep the order stable when start times match.
+    unsigned int mThreadIndex;
+
+    /// The index of the next call to merge from the thread's buffer.
+    size_t mEntryIndex;
+
+    /// The thread's trace buffer.
+    const ThreadTraceData* mThreadTrace;
+};
+
+//--------------------------------------------------------------------------
+/// Orders the merge heap so that the cursor with the earliest call is on top.
+//--------------------------------------------------------------------------
+struct TraceMergeCursorLater
+{
+    //--------------------------------------------------------------------------
+    /// Check if a cursor's call should be written after another cursor's call.
+    /// \param inLeft The first cursor to compare.
+    /// \param inRight The second cursor to compare.
+    /// \returns True if the call at inLeft started after the call at inRight.
+    //--------------------------------------------------------------------------
+    bool operator()(const TraceMergeCursor& inLeft, const TraceMergeCursor& inRight) const
+    {
+        if (inLeft.mStartTime != inRight.mStartTime)
+        {
+            return inLeft.mStartTime > inRight.mStartTime;
+        }
+
+        return inLeft.mThreadIndex > inRight.mThreadIndex;
+    }
+};
+
+//--------------------------------------------------------------------------
+/// Retrieve the start time of a logged call as an integer that can be compared.
+/// \param inThreadTrace The thread trace buffer that the call was logged into.
+/// \param inEntryIndex The index of the call within the thread's buffer.
+/// \returns The raw start timestamp for the call.
+//--------------------------------------------------------------------------
+static UINT64 GetCallStartTime(const ThreadTraceData* inThreadTrace, size_t inEntryIndex)
+{
+    const CallsTiming& callTiming = inThreadTrace->mAPICallTimer.GetTimingByIndex(inEntryIndex);
+
+#if defined (_WIN32)
+    return static_cast<UINT64>(callTiming.m_startTime.QuadPart);
+#else
+    return static_cast<UINT64>(callTiming.m_startTime);
+#endif
+}
+
+//--------------------------------------------------------------------------
+/// Constructor.
+/// \param inThreadTraces The registry of per-thread trace buffers to build the response from.
+/// \param inFrameStartTime The time that the traced frame started. Call times are relative to it.
+//--------------------------------------------------------------------------
+APITraceBuilder::APITraceBuilder(const ThreadTraceRegistry& inThreadTraces, const GPS_TIMESTAMP& inFrameStartTime)
+    : mThreadTraces(inThreadTraces)
+    , mFrameStartTime(inFrameStartTime)
+{
+}
+
+//--------------------------------------------------------------------------
+/// Build the API Trace with one block of calls per thread, each in call order.
+/// \param inAPIName The name of the traced API. Used in the CodeXL preamble for each thread.
+/// \returns A line-delimited, ASCII-encoded, version of the API Trace data, or "NODATA" if nothing was traced.
+//--------------------------------------------------------------------------
+std::string APITraceBuilder::GetPerThreadAPITraceTXT(const char* inAPIName) const
+{
+    // A switch to determine at the last moment whether or not we should send our generated response back to the client.
+    bool bWriteResponseString = false;
+
+    // Concatenate all of the logged call lines into a single string that we can send to the client.
+    std::stringstream traceString;
+    unsigned int numThreads = mThreadTraces.GetNumThreads();
+
+    for (unsigned int threadIndex = 0; threadIndex < numThreads; ++threadIndex)
+    {
+        DWORD threadId = 0;
+        const ThreadTraceData* currentTrace = mThreadTraces.GetThreadData(threadIndex, threadId);
+
+        // Skip slots whose thread is still being registered.
+        if (currentTrace == NULL)
+        {
+            continue;
+        }
+
+        GPS_TIMESTAMP timeFrequency = currentTrace->mAPICallTimer.GetTimeFrequency();
+        size_t numEntries = currentTrace->mLoggedCallVector.size();
+
+        // Thread buffers are kept between frames, so skip threads that didn't trace anything this time.
+        if (numEntries == 0)
+        {
+            continue;
+        }
+
+        // The CodeXL format includes a preamble section for each traced thread.
+        FormatAPITraceThreadHeader(traceString, inAPIName, threadId, numEntries);
+
+        for (size_t entryIndex = 0; entryIndex < numEntries; ++entryIndex)
+        {
+            WriteAPITraceLine(traceString, currentTrace, entryIndex, timeFrequency);
+        }
+
+        bWriteResponseString = true;
+    }
+
+    // If for some reason we failed to write a valid response string, reply with a known failure signal so the client handles it properly.
+    if (!bWriteResponseString)
+    {
+        traceString << "NODATA";
+    }
+
+    return traceString.str();
+}
+
+//--------------------------------------------------------------------------
+/// Build a single API Trace stream where the calls from every thread are interleaved by start time.
+/// The per-thread logs are already in call order, so they're combined with a k-way heap merge.
+/// \returns A line-delimited, ASCII-encoded, version of the API Trace data, or "NODATA" if nothing was traced.
+//--------------------------------------------------------------------------
+std::string APITraceBuilder::GetMergedAPITraceTXT() const
+{
+    std::stringstream traceString;
+    std::priority_queue<TraceMergeCursor, std::vector<TraceMergeCursor>, TraceMergeCursorLater> mergeHeap;
+
+    // Seed the heap with the first call from each thread that traced something.
+    unsigned int numThreads = mThreadTraces.GetNumThreads();
+
+    for (unsigned int threadIndex = 0; threadIndex < numThreads; ++threadIndex)
+    {
+        DWORD threadId = 0;
+        const ThreadTraceData* currentTrace = mThreadTraces.GetThreadData(threadIndex, threadId);
+
+        if (currentTrace != NULL && !currentTrace->mLoggedCallVector.empty())
+        {
+            TraceMergeCursor threadCursor;
+            threadCursor.mStartTime = GetCallStartTime(currentTrace, 0);
+            threadCursor.mThreadIndex = threadIndex;
+            threadCursor.mEntryIndex = 0;
+            threadCursor.mThreadTrace = currentTrace;
+            mergeHeap.push(threadCursor);
+        }
+    }
+
+    // If for some reason we failed to write a valid response string, reply with a known failure signal so the client handles it properly.
+    if (mergeHeap.empty())
+    {
+        return "NODATA";
+    }
+
+    GPS_TIMESTAMP timeFrequency = mergeHeap.top().mThreadTrace->mAPICallTimer.GetTimeFrequency();
+
+    // Write the earliest remaining call, and replace it in the heap with the next call from the same thread.
+    while (!mergeHeap.empty())
+    {
+        TraceMergeCursor nextCursor = mergeHeap.top();
+        mergeHeap.pop();
+
+        WriteAPITraceLine(traceString, nextCursor.mThreadTrace, nextCursor.mEntryIndex, timeFrequency);
+
+        nextCursor.mEntryIndex++;
+
+        if (nextCursor.mEntryIndex < nextCursor.mThreadTrace->mLoggedCallVector.size())
+        {
+            nextCursor.mStartTime = GetCallStartTime(nextCursor.mThreadTrace, nextCursor.mEntryIndex);
+            mergeHeap.push(nextCursor);
+        }
+    }
+
+    return traceString.str();
+}
+
+//--------------------------------------------------------------------------
+/// Convert a logged call's timestamps into milliseconds from the start of the frame.
+/// \param inThreadTrace The thread trace buffer that the call was logged into.
+/// \param inEntryIndex The index of the call within the thread's buffer.
+/// \param inTimeFrequency The frequency of the timer used to collect call timestamps.
+/// \param outStartTime The start time of the call.
+/// \param outEndTime The end time of the call.
+//--------------------------------------------------------------------------
+void APITraceBuilder::GetCallTimes(const ThreadTraceData* inThreadTrace, size_t inEntryIndex, GPS_TIMESTAMP& inTimeFrequency, double& outStartTime, double& outEndTime) const
+{
+    const TimingLog& currentTimer = inThreadTrace->mAPICallTimer;
+    const CallsTiming& callTiming = currentTimer.GetTimingByIndex(inEntryIndex);
+
+    bool conversionResults = currentTimer.ConvertTimestampToDoubles(callTiming.m_startTime,
+                                                                    callTiming.m_endTime,
+                                                                    outStartTime,
+                                                                    outEndTime,
+                                                                    mFrameStartTime,
+                                                                    &inTimeFrequency);
+
+    // We should always be able to convert from GPS_TIMESTAMPs to doubles.
+    PsAssert(conversionResults == true);
+    (void)conversionResults;
+}
+
+//--------------------------------------------------------------------------
+/// Append a single logged call to the API Trace response.
+/// \param ioTraceString The API Trace response stream to append to.
+/// \param inThreadTrace The thread trace buffer that the call was logged into.
+/// \param inEntryIndex The index of the call within the thread's buffer.
+/// \param inTimeFrequency The frequency of the timer used to collect call timestamps.
+//--------------------------------------------------------------------------
+void APITraceBuilder::WriteAPITraceLine(std::stringstream& ioTraceString, const ThreadTraceData* inThreadTrace, size_t inEntryIndex, GPS_TIMESTAMP& inTimeFrequency) const
+{
+    double deltaStartTime, deltaEndTime;
+    GetCallTimes(inThreadTrace, inEntryIndex, inTimeFrequency, deltaStartTime, deltaEndTime);
+
+    const APIEntry* callEntry = inThreadTrace->mLoggedCallVector[inEntryIndex];
+
+    // This exists as a sanity check. If a duration stretches past this point, we can be pretty sure something is messed up.
+    // This signal value is basically random, with the goal of it being large enough to catch any obvious duration errors.
+    if (deltaEndTime > 8000000000.0f)
+    {
+        const char* functionName = callEntry->GetAPIName();
+        Log(logWARNING, "The duration for APIEntry '%s' with index '%d' is suspicious. Tracing the application may have hung, producing inflated results.\n", functionName, inEntryIndex);
+    }
+
+    callEntry->AppendAPITraceLine(ioTraceString, deltaStartTime, deltaEndTime);
+}
@@ -0,0 +1,80 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Builds the API Trace response text from the calls that each thread
+///         logged during a traced frame.
+//==============================================================================
+
+#ifndef APITRACEBUILDER_H
+#define APITRACEBUILDER_H
+
+#include <sstream>
+#include <string>
+#include "TimingLog.h"
+
+class ThreadTraceData;
+class ThreadTraceRegistry;
+
+//--------------------------------------------------------------------------
+/// APITraceBuilder writes the calls logged in a ThreadTraceRegistry as API Trace
+/// response text, either as one block per thread, or as a single stream with the
+/// calls from every thread interleaved by start time. The thread traces must not
+/// be logged into or cleared while the response is built.
+//--------------------------------------------------------------------------
+class APITraceBuilder
+{
+public:
+    //--------------------------------------------------------------------------
+    /// Constructor.
+    /// \param inThreadTraces The registry of per-thread trace buffers to build the response from.
+    /// \param inFrameStartTime The time that the traced frame started. Call times are relative to it.
+    //--------------------------------------------------------------------------
+    APITraceBuilder(const ThreadTraceRegistry& inThreadTraces, const GPS_TIMESTAMP& inFrameStartTime);
+
+    //--------------------------------------------------------------------------
+    /// Build the API Trace with one block of calls per thread, each in call order.
+    /// \param inAPIName The name of the traced API. Used in the CodeXL preamble for each thread.
+    /// \returns A line-delimited, ASCII-encoded, version of the API Trace data, or "NODATA" if nothing was traced.
+    //--------------------------------------------------------------------------
+    std::string GetPerThreadAPITraceTXT(const char* inAPIName) const;
+
+    //--------------------------------------------------------------------------
+    /// Build a single API Trace stream where the calls from every thread are interleaved by start time.
+    /// The per-thread logs are already in call order, so they're combined with a k-way heap merge.
+    /// \returns A line-delimited, ASCII-encoded, version of the API Trace data, or "NODATA" if nothing was traced.
+    //--------------------------------------------------------------------------
+    std::string GetMergedAPITraceTXT() const;
+
+    //--------------------------------------------------------------------------
+    /// Convert a logged call's timestamps into milliseconds from the start of the frame.
+    /// \param inThreadTrace The thread trace buffer that the call was logged into.
+    /// \param inEntryIndex The index of the call within the thread's buffer.
+    /// \param inTimeFrequency The frequency of the timer used to collect call timestamps.
+    /// \param outStartTime The start time of the call.
+    /// \param outEndTime The end time of the call.
+    //--------------------------------------------------------------------------
+    void GetCallTimes(const ThreadTraceData* inThreadTrace, size_t inEntryIndex, GPS_TIMESTAMP& inTimeFrequency, double& outStartTime, double& outEndTime) const;
+
+private:
+    //--------------------------------------------------------------------------
+    /// Append a single logged call to the API Trace response.
+    /// \param ioTraceString The API Trace response stream to append to.
+    /// \param inThreadTrace The thread trace buffer that the call was logged into.
+    /// \param inEntryIndex The index of the call within the thread's buffer.
+    /// \param inTimeFrequency The frequency of the timer used to collect call timestamps.
+    //--------------------------------------------------------------------------
+    void WriteAPITraceLine(std::stringstream& ioTraceString, const ThreadTraceData* inThreadTrace, size_t inEntryIndex, GPS_TIMESTAMP& inTimeFrequency) const;
+
+    //--------------------------------------------------------------------------
+    /// The registry of per-thread trace buffers.
+    //--------------------------------------------------------------------------
+    const ThreadTraceRegistry& mThreadTraces;
+
+    //--------------------------------------------------------------------------
+    /// The time that the traced frame started.
+    //--------------------------------------------------------------------------
+    GPS_TIMESTAMP mFrameStartTime;
+};
+
+#endif // APITRACEBUILDER_H
@@ -0,0 +1,173 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  A bump allocator that hands out memory from large contiguous slabs.
+//==============================================================================
+
+#ifndef ARENAALLOCATOR_H
+#define ARENAALLOCATOR_H
+
+#include <vector>
+#include <string.h>
+
+//--------------------------------------------------------------------------
+/// The default size of each slab allocated by the ArenaAllocator.
+//--------------------------------------------------------------------------
+static const size_t s_DefaultArenaSlabSize = 256 * 1024;
+
+//--------------------------------------------------------------------------
+/// ArenaAllocator hands out memory by bumping an offset within a large slab. When a slab
+/// is full, the next one is used (or allocated). Individual allocations are never freed.
+/// Instead, Reset() rewinds the arena in O(1) and keeps the slabs for reuse, so a thread
+/// that traces every frame stops allocating once it has reached its peak usage.
+/// Objects constructed in the arena never have their destructors run, so they must not own
+/// any resources.
+/// The ArenaAllocator is not threadsafe. Each thread is expected to use its own instance.
+//--------------------------------------------------------------------------
+class ArenaAllocator
+{
+public:
+    //--------------------------------------------------------------------------
+    /// Constructor.
+    /// \param inSlabSize The size of each slab that allocations are carved out of.
+    //--------------------------------------------------------------------------
+    explicit ArenaAllocator(size_t inSlabSize = s_DefaultArenaSlabSize)
+        : mSlabSize(inSlabSize)
+        , mCurrentSlab(0)
+        , mCurrentOffset(0)
+    {
+    }
+
+    //--------------------------------------------------------------------------
+    /// Destructor releases every slab owned by the arena.
+    //--------------------------------------------------------------------------
+    ~ArenaAllocator()
+    {
+        for (size_t slabIndex = 0; slabIndex < mSlabs.size(); ++slabIndex)
+        {
+            delete[] mSlabs[slabIndex].mMemory;
+        }
+
+        mSlabs.clear();
+    }
+
+    //--------------------------------------------------------------------------
+    /// Allocate a block of memory from the arena.
+    /// \param inSize The size of the requested block in bytes.
+    /// \param inAlignment The required alignment of the block. Must be a power of two.
+    /// \returns A pointer to the new block.
+    //--------------------------------------------------------------------------
+    void* Allocate(size_t inSize, size_t inAlignment = sizeof(void*))
+    {
+        while (mCurrentSlab < mSlabs.size())
+        {
+            Slab& currentSlab = mSlabs[mCurrentSlab];
+            size_t alignedOffset = (mCurrentOffset + (inAlignment - 1)) & ~(inAlignment - 1);
+
+            if (alignedOffset + inSize <= currentSlab.mSize)
+            {
+                mCurrentOffset = alignedOffset + inSize;
+                return currentSlab.mMemory + alignedOffset;
+            }
+
+            // This slab is full. Move on to the next one that was kept from a previous Reset.
+            mCurrentSlab++;
+            mCurrentOffset = 0;
+        }
+
+        // Every slab is full, so allocate a new one. Oversized requests get a slab sized to fit.
+        Slab newSlab;
+        newSlab.mSize = (inSize + inAlignment > mSlabSize) ? (inSize + inAlignment) : mSlabSize;
+        newSlab.mMemory = new char[newSlab.mSize];
+        mSlabs.push_back(newSlab);
+        mCurrentSlab = mSlabs.size() - 1;
+        mCurrentOffset = 0;
+
+        return Allocate(inSize, inAlignment);
+    }
+
+    //--------------------------------------------------------------------------
+    /// Copy a null-terminated string into the arena.
+    /// \param inString The string to copy.
+    /// \returns A pointer to the copy, which remains valid until the next Reset.
+    //--------------------------------------------------------------------------
+    const char* CopyString(const char* inString)
+    {
+        size_t stringLength = strlen(inString) + 1;
+        char* stringCopy = static_cast<char*>(Allocate(stringLength, 1));
+        memcpy(stringCopy, inString, stringLength);
+
+        return stringCopy;
+    }
+
+    //--------------------------------------------------------------------------
+    /// Rewind the arena so that all slabs can be reused. Previously allocated memory becomes invalid.
+    //--------------------------------------------------------------------------
+    void Reset()
+    {
+        mCurrentSlab = 0;
+        mCurrentOffset = 0;
+    }
+
+    //--------------------------------------------------------------------------
+    /// Retrieve the total number of bytes reserved by the arena's slabs.
+    /// \returns The number of bytes owned by the arena.
+    //--------------------------------------------------------------------------
+    size_t GetReservedSize() const
+    {
+        size_t reservedSize = 0;
+
+        for (size_t slabIndex = 0; slabIndex < mSlabs.size(); ++slabIndex)
+        {
+            reservedSize += mSlabs[slabIndex].mSize;
+        }
+
+        return reservedSize;
+    }
+
+private:
+    //--------------------------------------------------------------------------
+    /// Disable copying, since the arena owns its slabs.
+    //--------------------------------------------------------------------------
+    ArenaAllocator(const ArenaAllocator&);
+
+    //--------------------------------------------------------------------------
+    /// Disable assignment, since the arena owns its slabs.
+    //--------------------------------------------------------------------------
+    ArenaAllocator& operator=(const ArenaAllocator&);
+
+    //--------------------------------------------------------------------------
+    /// A single contiguous block of memory that allocations are carved out of.
+    //--------------------------------------------------------------------------
+    struct Slab
+    {
+        /// The slab's memory.
+        char* mMemory;
+
+        /// The size of the slab in bytes.
+        size_t mSize;
+    };
+
+    //--------------------------------------------------------------------------
+    /// The slabs owned by the arena, in the order they are filled.
+    //--------------------------------------------------------------------------
+    std::vector<Slab> mSlabs;
+
+    //--------------------------------------------------------------------------
+    /// The size used for new slabs.
+    //--------------------------------------------------------------------------
+    size_t mSlabSize;
+
+    //--------------------------------------------------------------------------
+    /// The index of the slab that is currently being filled.
+    //--------------------------------------------------------------------------
+    size_t mCurrentSlab;
+
+    //--------------------------------------------------------------------------
+    /// The offset of the next free byte in the current slab.
+    //--------------------------------------------------------------------------
+    size_t mCurrentOffset;
+};
+
+#endif // ARENAALLOCATOR_H
@@ -0,0 +1,487 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Writes log messages to the log file from a background thread, so
+///         that logging threads only copy the message into a buffer.
+//==============================================================================
+
+#include <AMDTOSWrappers/Include/osThread.h>
+
+#if defined (_WIN32)
+    #include <windows.h>
+#elif defined (_LINUX)
+    #include "WinDefs.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include "AsyncLogWriter.h"
+#include "Logger.h"
+
+#if defined (_WIN32)
+    __declspec(thread) static void* s_ThreadLogRing = NULL;
+    __declspec(thread) static bool s_bThreadIsDraining = false;
+#elif defined (_LINUX)
+    static __thread void* s_ThreadLogRing = NULL;
+    static __thread bool s_bThreadIsDraining = false;
+#endif
+
+//--------------------------------------------------------------------------
+/// Hands the thread's ring back to the writer when the thread exits. Only
+/// touched when the thread first logs, so logging itself stays on the plain
+/// thread-local pointer above.
+//--------------------------------------------------------------------------
+class ThreadLogRingReleaser
+{
+public:
+    /// Constructor
+    ThreadLogRingReleaser() : mRing(NULL) {}
+
+    /// Destructor. Runs as the thread exits.
+    ~ThreadLogRingReleaser()
+    {
+        if (mRing != NULL)
+        {
+            s_ThreadLogRing = NULL;
+            AsyncLogWriter::ReleaseThreadRing((AsyncLogWriter::LogRing*)mRing);
+        }
+    }
+
+    /// The thread's ring.
+    void* mRing;
+};
+
+static thread_local ThreadLogRingReleaser s_ThreadLogRingReleaser;
+
+//--------------------------------------------------------------------------
+/// Copy data into a ring, wrapping around the end of the ring if necessary.
+/// \param ioRingBuffer The ring's storage.
+/// \param inPosition The total number of bytes written to the ring before this data.
+/// \param inData The data to copy.
+/// \param inSize The number of bytes to copy.
+//--------------------------------------------------------------------------
+static void CopyIntoRing(char* ioRingBuffer, size_t inPosition, const void* inData, size_t inSize)
+{
+    size_t offset = inPosition & (s_LogRingSize - 1);
+    size_t firstPart = (inSize < (s_LogRingSize - offset)) ? inSize : (s_LogRingSize - offset);
+
+    memcpy(&ioRingBuffer[offset], inData, firstPart);
+    memcpy(ioRingBuffer, (const char*)inData + firstPart, inSize - firstPart);
+}
+
+//--------------------------------------------------------------------------
+/// Copy data out of a ring, wrapping around the end of the ring if necessary.
+/// \param inRingBuffer The ring's storage.
+/// \param inPosition The total number of bytes read from the ring before this data.
+/// \param outData The destination for the data.
+/// \param inSize The number of bytes to copy.
+//--------------------------------------------------------------------------
+static void CopyFromRing(const char* inRingBuffer, size_t inPosition, void* outData, size_t inSize)
+{
+    size_t offset = inPosition & (s_LogRingSize - 1);
+    size_t firstPart = (inSize < (s_LogRingSize - offset)) ? inSize : (s_LogRingSize - offset);
+
+    memcpy(outData, &inRingBuffer[offset], firstPart);
+    memcpy((char*)outData + firstPart, inRingBuffer, inSize - firstPart);
+}
+
+//--------------------------------------------------------------------------
+/// Accessor to the single instance, which starts the writer thread when it's created.
+/// \returns The AsyncLogWriter instance.
+//--------------------------------------------------------------------------
+AsyncLogWriter* AsyncLogWriter::Instance()
+{
+    // Never deleted. The writer thread must outlive any code that might still log during shutdown.
+    static AsyncLogWriter* writer = new AsyncLogWriter;
+    return writer;
+}
+
+//--------------------------------------------------------------------------
+/// Private constructor, to adhere to the singleton pattern. Starts the writer thread.
+//--------------------------------------------------------------------------
+AsyncLogWriter::AsyncLogWriter()
+    : mRings(NULL)
+    , mNumRings(0)
+    , mNumDroppedMessages(0)
+    , mWriterThread(NULL)
+    , mbWriterRunning(false)
+    , mbWakeRequested(false)
+    , mbStopRequested(false)
+    , mbWriterStopped(false)
+{
+    // The thread runs until Shutdown is called when the server is unloaded.
+    mWriterThread = new std::thread(&AsyncLogWriter::WriterThreadMain, this);
+    mbWriterRunning.store(true, std::memory_order_release);
+}
+
+//--------------------------------------------------------------------------
+/// The writer is never destroyed, since logging may happen during process shutdown.
+//--------------------------------------------------------------------------
+AsyncLogWriter::~AsyncLogWriter()
+{
+}
+
+//--------------------------------------------------------------------------
+/// Queue a message to be written to the log file. Only blocks if the message is synchronous.
+/// \param inMessage The formatted message to write.
+/// \param inbSynchronous True to write the message, and everything queued before it, to the log file before returning.
+/// \returns True if the message was queued, false if it was dropped.
+//--------------------------------------------------------------------------
+bool AsyncLogWriter::Write(const char* inMessage, bool inbSynchronous)
+{
+    LogRing* ring = GetThreadRing();
+
+    // Without the writer thread, nothing else will write the message.
+    bool bSynchronous = inbSynchronous || (mbWriterRunning.load(std::memory_order_acquire) == false);
+
+    unsigned int messageLength = (unsigned int)strlen(inMessage);
+    size_t requiredSize = sizeof(messageLength) + messageLength;
+
+    // Only this thread advances the write position. The writer thread may advance the read position at any time.
+    size_t writePos = ring->mWritePos.load(std::memory_order_relaxed);
+    size_t usedSize = writePos - ring->mReadPos.load(std::memory_order_acquire);
+    bool bQueued = (requiredSize <= (s_LogRingSize - usedSize));
+
+    // Something logged while this thread writes a batch, such as a failure to lock or open the log file,
+    // can't be flushed, since the drain lock is already held. It's written with the next batch instead.
+    if (s_bThreadIsDraining)
+    {
+        bSynchronous = false;
+    }
+
+    if (!bQueued && bSynchronous)
+    {
+        // A synchronous message can wait for the ring to be emptied, rather than be dropped.
+        Flush();
+        usedSize = writePos - ring->mReadPos.load(std::memory_order_acquire);
+        bQueued = (requiredSize <= (s_LogRingSize - usedSize));
+    }
+
+    if (bQueued)
+    {
+        CopyIntoRing(ring->mBuffer, writePos, &messageLength, sizeof(messageLength));
+        CopyIntoRing(ring->mBuffer, writePos + sizeof(messageLength), inMessage, messageLength);
+        ring->mWritePos.store(writePos + requiredSize, std::memory_order_release);
+
+        usedSize += requiredSize;
+    }
+    else
+    {
+        ring->mNumDropped.fetch_add(1, std::memory_order_relaxed);
+        mNumDroppedMessages.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (bSynchronous)
+    {
+        Flush();
+    }
+    else if (usedSize > (s_LogRingSize / 2))
+    {
+        // Don't wait for the next batch if the ring is filling up, since messages would start being dropped.
+        {
+            std::lock_guard<std::mutex> wakeLock(mWakeMutex);
+            mbWakeRequested = true;
+        }
+
+        mWakeCondition.notify_all();
+    }
+
+    return bQueued;
+}
+
+//--------------------------------------------------------------------------
+/// Write every message queued so far to the log file before returning.
+//--------------------------------------------------------------------------
+void AsyncLogWriter::Flush()
+{
+    std::lock_guard<std::mutex> drainLock(mDrainMutex);
+    DrainAndWrite();
+}
+
+//--------------------------------------------------------------------------
+/// Stop the writer thread once it has written its last batch, and write anything
+/// queued after that. Messages logged afterwards are written as they're queued.
+/// \param inbProcessTerminating True if the process is exiting, in which case the
+/// writer thread has already been killed, so it isn't waited for.
+//--------------------------------------------------------------------------
+void AsyncLogWriter::Shutdown(bool inbProcessTerminating)
+{
+    bool bWriterStopped = false;
+
+    {
+        std::unique_lock<std::mutex> wakeLock(mWakeMutex);
+
+        if (mWriterThread == NULL)
+        {
+            return;
+        }
+
+        mbStopRequested = true;
+        mWakeCondition.notify_all();
+
+        // When the process is terminating, every other thread has already been killed, and the writer would never answer.
+        // Otherwise, it may still have been killed by something else, so don't wait forever.
+        if (!inbProcessTerminating)
+        {
+            bWriterStopped = mWakeCondition.wait_for(wakeLock, std::chrono::milliseconds(s_LogShutdownTimeoutMs), [this] { return mbWriterStopped; });
+        }
+    }
+
+    mbWriterRunning.store(false, std::memory_order_release);
+
+#if defined (_WIN32)
+    // Shutdown is called from DllMain. Joining there would deadlock on the loader lock,
+    // since the exiting thread needs it. The thread has written its last batch, so let it go.
+    mWriterThread->detach();
+#else
+
+    if (bWriterStopped)
+    {
+        mWriterThread->join();
+    }
+    else
+    {
+        mWriterThread->detach();
+    }
+
+#endif
+
+    {
+        std::lock_guard<std::mutex> wakeLock(mWakeMutex);
+        delete mWriterThread;
+        mWriterThread = NULL;
+    }
+
+    if (bWriterStopped)
+    {
+        Flush();
+    }
+    else
+    {
+        // A writer thread that was killed while draining never released the drain lock.
+        std::unique_lock<std::mutex> drainLock(mDrainMutex, std::try_to_lock);
+
+        if (drainLock.owns_lock())
+        {
+            DrainAndWrite();
+        }
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Retrieve the calling thread's ring, claiming a free ring, or creating and
+/// registering a new one, on first use.
+/// \returns The calling thread's ring.
+//--------------------------------------------------------------------------
+AsyncLogWriter::LogRing* AsyncLogWriter::GetThreadRing()
+{
+    LogRing* ring = (LogRing*)s_ThreadLogRing;
+
+    if (ring == NULL)
+    {
+        // Rings are never removed from the list, since the writer walks it without a lock.
+        // Reuse one left behind by an exited thread, so the list only grows with the number of live threads.
+        for (LogRing* freeRing = mRings.load(std::memory_order_acquire); freeRing != NULL; freeRing = freeRing->mNextRing)
+        {
+            int expectedState = LOG_RING_FREE;
+
+            // A free ring is empty, and its positions carry on from where the previous thread left them.
+            if ((freeRing->mState.load(std::memory_order_relaxed) == LOG_RING_FREE) &&
+                freeRing->mState.compare_exchange_strong(expectedState, LOG_RING_OWNED, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                ring = freeRing;
+                break;
+            }
+        }
+
+        if (ring == NULL)
+        {
+            ring = new LogRing;
+            ring->mWritePos.store(0, std::memory_order_relaxed);
+            ring->mReadPos.store(0, std::memory_order_relaxed);
+            ring->mNumDropped.store(0, std::memory_order_relaxed);
+            ring->mState.store(LOG_RING_OWNED, std::memory_order_relaxed);
+            ring->mNextRing = mRings.load(std::memory_order_relaxed);
+
+            while (!mRings.compare_exchange_weak(ring->mNextRing, ring, std::memory_order_release, std::memory_order_relaxed))
+            {
+            }
+
+            mNumRings.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        ring->mThreadId.store((unsigned int)osGetCurrentThreadId(), std::memory_order_relaxed);
+
+        s_ThreadLogRing = ring;
+        s_ThreadLogRingReleaser.mRing = ring;
+    }
+
+    return ring;
+}
+
+//--------------------------------------------------------------------------
+/// Called when a thread that has logged exits. Its ring is freed once the
+/// writer has drained it.
+/// \param inRing The exiting thread's ring.
+//--------------------------------------------------------------------------
+void AsyncLogWriter::ReleaseThreadRing(LogRing* inRing)
+{
+    // Publishes the thread's last messages along with the state, for the drain that frees the ring.
+    inRing->mState.store(LOG_RING_OWNER_EXITED, std::memory_order_release);
+}
+
+//--------------------------------------------------------------------------
+/// The writer thread's loop. Writes a batch whenever it's woken, or when the write interval passes.
+//--------------------------------------------------------------------------
+void AsyncLogWriter::WriterThreadMain()
+{
+    bool bStopRequested = false;
+
+    while (!bStopRequested)
+    {
+        {
+            std::unique_lock<std::mutex> wakeLock(mWakeMutex);
+            mWakeCondition.wait_for(wakeLock, std::chrono::milliseconds(s_LogWriteIntervalMs), [this] { return mbWakeRequested || mbStopRequested; });
+            mbWakeRequested = false;
+            bStopRequested = mbStopRequested;
+        }
+
+        Flush();
+    }
+
+    {
+        std::lock_guard<std::mutex> wakeLock(mWakeMutex);
+        mbWriterStopped = true;
+    }
+
+    mWakeCondition.notify_all();
+}
+
+//--------------------------------------------------------------------------
+/// Move every queued message out of the rings and write them to the log file.
+/// Must be called with mDrainMutex locked.
+//--------------------------------------------------------------------------
+void AsyncLogWriter::DrainAndWrite()
+{
+    s_bThreadIsDraining = true;
+
+    mBatch.clear();
+
+    for (LogRing* ring = mRings.load(std::memory_order_acquire); ring != NULL; ring = ring->mNextRing)
+    {
+        // Read before the write position, so if the thread has exited, all of its messages are seen below.
+        int state = ring->mState.load(std::memory_order_acquire);
+
+        if (state == LOG_RING_FREE)
+        {
+            continue;
+        }
+
+        unsigned int numDropped = ring->mNumDropped.exchange(0, std::memory_order_relaxed);
+        size_t readPos = ring->mReadPos.load(std::memory_order_relaxed);
+        size_t writePos = ring->mWritePos.load(std::memory_order_acquire);
+
+        while (readPos != writePos)
+        {
+            unsigned int messageLength = 0;
+            CopyFromRing(ring->mBuffer, readPos, &messageLength, sizeof(messageLength));
+            readPos += sizeof(messageLength);
+
+            size_t batchSize = mBatch.size();
+            mBatch.resize(batchSize + messageLength);
+            CopyFromRing(ring->mBuffer, readPos, &mBatch[batchSize], messageLength);
+            readPos += messageLength;
+        }
+
+        // Hand the space back to the owning thread.
+        ring->mReadPos.store(readPos, std::memory_order_release);
+
+        if (numDropped > 0)
+        {
+            char droppedMessage[256];
+            sprintf_s(droppedMessage, sizeof(droppedMessage), "Dropped %u log messages from TID %u, because they were logged faster than they could be written.\n", numDropped, ring->mThreadId.load(std::memory_order_relaxed));
+            mBatch.append(droppedMessage);
+        }
+
+        if (state == LOG_RING_OWNER_EXITED)
+        {
+            // The ring is empty and nothing more will be written into it, so a new thread may claim it.
+            ring->mState.store(LOG_RING_FREE, std::memory_order_release);
+        }
+    }
+
+    if (!mBatch.empty())
+    {
+        WriteBatchToLogFile(mBatch);
+    }
+
+    s_bThreadIsDraining = false;
+}
+
+//--------------------------------------------------------------------------
+/// Append one batch to the log file, rotating the file first if it's too large.
+/// \param inBatch The messages to write.
+//--------------------------------------------------------------------------
+void AsyncLogWriter::WriteBatchToLogFile(const std::string& inBatch)
+{
+    const char* logFilenameString = GetLogFilename();
+
+    if (logFilenameString == NULL)
+    {
+        return;
+    }
+
+    // The log file is shared with other processes, so it's only held open while a batch is written.
+    std::string logFilename(logFilenameString);
+
+    // Avoid flooding the log if the file can't be opened. Only report again after it has been opened successfully.
+    static bool s_bReportedOpenFailure = false;
+
+    if (LogMutexLock())   // wait for exclusive access to logfile
+    {
+        FILE* f = NULL;
+        fopen_s(&f, logFilename.c_str(), "a+");    // append
+
+        if (f != NULL)
+        {
+            fseek(f, 0, SEEK_END);
+
+            if (ftell(f) > s_MaxLogFileSize)
+            {
+                // Keep the previous log, so the messages leading up to the rotation aren't lost.
+                std::string rotatedFilename = logFilename + ".1";
+
+                fclose(f);
+                remove(rotatedFilename.c_str());
+                rename(logFilename.c_str(), rotatedFilename.c_str());
+
+                fopen_s(&f, logFilename.c_str(), "w+");
+            }
+        }
+
+        if (f != NULL)
+        {
+            fwrite(inBatch.c_str(), 1, inBatch.size(), f);
+            fclose(f);
+
+            s_bReportedOpenFailure = false;
+        }
+        else if (!s_bReportedOpenFailure)
+        {
+            // Not logged, since the message would only go back into the log file that can't be opened.
+            char errorMessage[1024];
+            sprintf_s(errorMessage, sizeof(errorMessage), "Unable to open logfile %s for append. %u bytes of messages dropped.\n", logFilename.c_str(), (unsigned int)inBatch.size());
+
+            s_bReportedOpenFailure = true;
+            fputs(errorMessage, stderr);
+#if defined (_WIN32)
+            OutputDebugStringA(errorMessage);
+#endif
+        }
+
+        LogMutexUnlock();
+    }
+}
@@ -0,0 +1,237 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Writes log messages to the log file from a background thread, so
+///         that logging threads only copy the message into a buffer.
+//==============================================================================
+
+#ifndef ASYNCLOGWRITER_H
+#define ASYNCLOGWRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <stddef.h>
+
+//--------------------------------------------------------------------------
+/// The size in bytes of each thread's message ring. Must be a power of two.
+//--------------------------------------------------------------------------
+static const size_t s_LogRingSize = 64 * 1024;
+
+//--------------------------------------------------------------------------
+/// The longest time in milliseconds that a message waits in a ring before it's written.
+//--------------------------------------------------------------------------
+static const unsigned int s_LogWriteIntervalMs = 50;
+
+//--------------------------------------------------------------------------
+/// Once the log file grows beyond this size, it's renamed and a new one is started.
+//--------------------------------------------------------------------------
+static const long s_MaxLogFileSize = 32 * 1024 * 1024;
+
+//--------------------------------------------------------------------------
+/// The longest time in milliseconds that Shutdown waits for the writer thread to write its last batch.
+//--------------------------------------------------------------------------
+static const unsigned int s_LogShutdownTimeoutMs = 1000;
+
+//--------------------------------------------------------------------------
+/// AsyncLogWriter gives each logging thread its own single-producer ring of
+/// formatted messages. A background thread drains all of the rings, and writes
+/// each batch into the log file with a single open of the file under the
+/// inter-process log mutex. Logging threads never wait for the file or the mutex.
+/// If a thread's ring is full, the message is dropped and counted, and the
+/// writer notes the number of dropped messages in the log. Synchronous messages,
+/// and every message once the writer has been shut down, are written to the file
+/// before Write returns. When a thread exits, its ring is reused by the next new
+/// thread once the writer has drained it.
+//--------------------------------------------------------------------------
+class AsyncLogWriter
+{
+public:
+    //--------------------------------------------------------------------------
+    /// Accessor to the single instance, which starts the writer thread when it's created.
+    /// \returns The AsyncLogWriter instance.
+    //--------------------------------------------------------------------------
+    static AsyncLogWriter* Instance();
+
+    //--------------------------------------------------------------------------
+    /// Queue a message to be written to the log file. Only blocks if the message is synchronous.
+    /// \param inMessage The formatted message to write.
+    /// \param inbSynchronous True to write the message, and everything queued before it, to the log file before returning.
+    /// \returns True if the message was queued, false if it was dropped.
+    //--------------------------------------------------------------------------
+    bool Write(const char* inMessage, bool inbSynchronous);
+
+    //--------------------------------------------------------------------------
+    /// Write every message queued so far to the log file before returning.
+    //--------------------------------------------------------------------------
+    void Flush();
+
+    //--------------------------------------------------------------------------
+    /// Stop the writer thread once it has written its last batch, and write anything
+    /// queued after that. Messages logged afterwards are written as they're queued.
+    /// \param inbProcessTerminating True if the process is exiting, in which case the
+    /// writer thread has already been killed, so it isn't waited for.
+    //--------------------------------------------------------------------------
+    void Shutdown(bool inbProcessTerminating);
+
+    //--------------------------------------------------------------------------
+    /// Retrieve the number of messages dropped because a thread's ring was full.
+    /// \returns The total number of dropped messages.
+    //--------------------------------------------------------------------------
+    unsigned int GetNumDroppedMessages() const { return mNumDroppedMessages.load(std::memory_order_relaxed); }
+
+    //--------------------------------------------------------------------------
+    /// Retrieve the number of rings that have been created. Rings are reused once their thread exits.
+    /// \returns The number of rings in the writer's list.
+    //--------------------------------------------------------------------------
+    unsigned int GetNumRings() const { return mNumRings.load(std::memory_order_relaxed); }
+
+private:
+    /// Releases each thread's ring when the thread exits.
+    friend class ThreadLogRingReleaser;
+
+    //--------------------------------------------------------------------------
+    /// Who a ring belongs to.
+    //--------------------------------------------------------------------------
+    enum LogRingState
+    {
+        LOG_RING_OWNED,         ///< A running thread writes into the ring.
+        LOG_RING_OWNER_EXITED,  ///< The ring's thread has exited, but its last messages may not have been written yet.
+        LOG_RING_FREE,          ///< The ring is empty, and can be claimed by a new thread.
+    };
+
+    //--------------------------------------------------------------------------
+    /// A ring of messages written by one thread. Each message is stored as its
+    /// length followed by its characters, and may wrap around the end of the ring.
+    //--------------------------------------------------------------------------
+    struct LogRing
+    {
+        /// The ring's storage.
+        char mBuffer[s_LogRingSize];
+
+        /// The total number of bytes ever written into the ring. Only modified by the owning thread.
+        std::atomic<size_t> mWritePos;
+
+        /// The total number of bytes ever read out of the ring. Only modified while draining.
+        std::atomic<size_t> mReadPos;
+
+        /// The number of messages dropped since the ring was last drained.
+        std::atomic<unsigned int> mNumDropped;
+
+        /// The ID of the thread that owns the ring.
+        std::atomic<unsigned int> mThreadId;
+
+        /// One of LogRingState. Rings are handed from thread to thread rather than freed, since the list is never locked.
+        std::atomic<int> mState;
+
+        /// The next ring in the writer's list.
+        LogRing* mNextRing;
+    };
+
+    //--------------------------------------------------------------------------
+    /// Private constructor, to adhere to the singleton pattern. Starts the writer thread.
+    //--------------------------------------------------------------------------
+    AsyncLogWriter();
+
+    //--------------------------------------------------------------------------
+    /// The writer is never destroyed, since logging may happen during process shutdown.
+    //--------------------------------------------------------------------------
+    ~AsyncLogWriter();
+
+    //--------------------------------------------------------------------------
+    /// Retrieve the calling thread's ring, claiming a free ring, or creating and
+    /// registering a new one, on first use.
+    /// \returns The calling thread's ring.
+    //--------------------------------------------------------------------------
+    LogRing* GetThreadRing();
+
+    //--------------------------------------------------------------------------
+    /// Called when a thread that has logged exits. Its ring is freed once the
+    /// writer has drained it.
+    /// \param inRing The exiting thread's ring.
+    //--------------------------------------------------------------------------
+    static void ReleaseThreadRing(LogRing* inRing);
+
+    //--------------------------------------------------------------------------
+    /// The writer thread's loop. Writes a batch whenever it's woken, or when the write interval passes.
+    //--------------------------------------------------------------------------
+    void WriterThreadMain();
+
+    //--------------------------------------------------------------------------
+    /// Move every queued message out of the rings and write them to the log file.
+    /// Must be called with mDrainMutex locked. Anything the calling thread logs while
+    /// the batch is written is queued, and written with the next batch.
+    //--------------------------------------------------------------------------
+    void DrainAndWrite();
+
+    //--------------------------------------------------------------------------
+    /// Append one batch to the log file, rotating the file first if it's too large.
+    /// \param inBatch The messages to write.
+    //--------------------------------------------------------------------------
+    static void WriteBatchToLogFile(const std::string& inBatch);
+
+    //--------------------------------------------------------------------------
+    /// The head of the list of all rings. New rings are pushed onto the front.
+    //--------------------------------------------------------------------------
+    std::atomic<LogRing*> mRings;
+
+    //--------------------------------------------------------------------------
+    /// The number of rings in the list.
+    //--------------------------------------------------------------------------
+    std::atomic<unsigned int> mNumRings;
+
+    //--------------------------------------------------------------------------
+    /// The total number of dropped messages.
+    //--------------------------------------------------------------------------
+    std::atomic<unsigned int> mNumDroppedMessages;
+
+    //--------------------------------------------------------------------------
+    /// The background writer thread, or NULL once it has been shut down.
+    //--------------------------------------------------------------------------
+    std::thread* mWriterThread;
+
+    //--------------------------------------------------------------------------
+    /// True if the writer thread is running. Once it's shut down, messages are written as they're queued.
+    //--------------------------------------------------------------------------
+    std::atomic<bool> mbWriterRunning;
+
+    //--------------------------------------------------------------------------
+    /// Only one thread may read from the rings at a time.
+    //--------------------------------------------------------------------------
+    std::mutex mDrainMutex;
+
+    //--------------------------------------------------------------------------
+    /// Used with mWakeCondition to wake the writer thread.
+    //--------------------------------------------------------------------------
+    std::mutex mWakeMutex;
+
+    //--------------------------------------------------------------------------
+    /// Signalled when a ring is filling up, when the writer is asked to stop, and when it has stopped.
+    //--------------------------------------------------------------------------
+    std::condition_variable mWakeCondition;
+
+    //--------------------------------------------------------------------------
+    /// Set along with mWakeCondition, so a wakeup isn't lost if the writer is busy.
+    //--------------------------------------------------------------------------
+    bool mbWakeRequested;
+
+    //--------------------------------------------------------------------------
+    /// Set by Shutdown to ask the writer thread to write its last batch and exit.
+    //--------------------------------------------------------------------------
+    bool mbStopRequested;
+
+    //--------------------------------------------------------------------------
+    /// Set by the writer thread once it has written its last batch.
+    //--------------------------------------------------------------------------
+    bool mbWriterStopped;
+
+    //--------------------------------------------------------------------------
+    /// The batch being built by DrainAndWrite. Kept between batches to reuse its storage.
+    //--------------------------------------------------------------------------
+    std::string mBatch;
+};
+
+#endif // ASYNCLOGWRITER_H
@@ -0,0 +1,734 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  A compact, indexed, binary container for API Trace responses, with
+///         a memory-mapped reader that converts back to the text format, and
+///         the functions that write that text format.
+//==============================================================================
+
+#if defined (_LINUX)
+    #include <sys/types.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#include "BinaryTraceFile.h"
+#include "misc.h"
+#include <stdio.h>
+#include <string.h>
+#include <queue>
+#include <sstream>
+
+//--------------------------------------------------------------------------
+/// The magic string at the start and end of every binary trace file.
+//--------------------------------------------------------------------------
+static const char s_BinaryTraceMagic[8] = { 'G', 'P', 'S', 'B', 'T', 'R', 'C', '\0' };
+
+//--------------------------------------------------------------------------
+/// Round a file offset up to the next multiple of 8.
+/// \param inOffset The offset to round up.
+/// \returns The aligned offset.
+//--------------------------------------------------------------------------
+static UINT64 AlignTraceOffset(UINT64 inOffset)
+{
+    return (inOffset + 7) & ~static_cast<UINT64>(7);
+}
+
+//--------------------------------------------------------------------------
+/// The text format that this build writes, as stored in BinaryTraceFooter::mFlags.
+//--------------------------------------------------------------------------
+#if defined(CODEXL_GRAPHICS)
+    static const UINT32 s_BinaryTraceFormatFlags = s_BinaryTraceFlagCodeXL;
+#else
+    static const UINT32 s_BinaryTraceFormatFlags = 0;
+#endif
+
+//--------------------------------------------------------------------------
+/// Write one call as a line of the API Trace text response.
+/// \param ioTraceResponse The stream to write the line to.
+/// \param inThreadId The Id of the thread that made the call.
+/// \param inAPIType The API group that the function belongs to.
+/// \param inFunctionId The FuncId of the function.
+/// \param inInterface The interface handle, as written in the response.
+/// \param inFunctionName The "Interface_FunctionName" string.
+/// \param inParameters The call's parameters.
+/// \param inReturnValue The call's return value.
+/// \param inStartTime The start time of the call, in milliseconds from the start of the frame.
+/// \param inEndTime The end time of the call, in milliseconds from the start of the frame.
+/// \param inSampleId The sample Id of the call.
+//--------------------------------------------------------------------------
+void FormatAPITraceLine(std::ostream& ioTraceResponse, UINT32 inThreadId, UINT32 inAPIType, UINT32 inFunctionId, const char* inInterface, const char* inFunctionName,
+                        const char* inParameters, const char* inReturnValue, double inStartTime, double inEndTime, UINT32 inSampleId)
+{
+#if defined(CODEXL_GRAPHICS)
+    // Below is an API Trace response that "CodeXL Graphics" understands how to parse.
+    // APIType APIFunctionId InterfacePtr D3D12Interface_FunctionName(Parameters) = ReturnValue StartMillisecond EndMillisecond SampleId
+    PS_UNREFERENCED_PARAMETER(inThreadId);
+    ioTraceResponse << inAPIType << " " << inFunctionId << " ";
+#else
+    // Below is an API Trace response that GPUPerfStudio understands how to parse. This format is mirrored in client code:
+    // ThreadId Interface_FunctionName(Parameters) = ReturnValue StartTime EndTime SampleId
+    PS_UNREFERENCED_PARAMETER(inAPIType);
+    PS_UNREFERENCED_PARAMETER(inFunctionId);
+    ioTraceResponse << inThreadId << " ";
+#endif
+
+    ioTraceResponse
+            << inInterface << " "
+            << inFunctionName
+            << "(" << inParameters << ") = "
+            << inReturnValue
+            << " " << std::fixed << inStartTime    // We don't want this number to get converted to scientific noation. Used std::fixed.
+            << " " << std::fixed << inEndTime
+            << " " << inSampleId
+            << std::endl;  // Finish the string with a newline to play nice with the next logged call.
+}
+
+//--------------------------------------------------------------------------
+/// Write the text that comes before each thread's calls in the per-thread API Trace text response.
+/// \param ioTraceResponse The stream to write the text to.
+/// \param inAPIName The name of the traced API.
+/// \param inThreadId The Id of the thread.
+/// \param inNumCalls The number of calls traced by the thread.
+//--------------------------------------------------------------------------
+void FormatAPITraceThreadHeader(std::ostream& ioTraceResponse, const char* inAPIName, UINT32 inThreadId, size_t inNumCalls)
+{
+#if defined(CODEXL_GRAPHICS)
+    // Write the trace type, API, ThreadID, and count of APIs traced.
+    ioTraceResponse << "//==API Trace==" << std::endl;
+    ioTraceResponse << "//API=" << inAPIName << std::endl;
+    ioTraceResponse << "//ThreadID=" << inThreadId << std::endl;
+    ioTraceResponse << "//ThreadAPICount=" << inNumCalls << std::endl;
+#else
+    PS_UNREFERENCED_PARAMETER(ioTraceResponse);
+    PS_UNREFERENCED_PARAMETER(inAPIName);
+    PS_UNREFERENCED_PARAMETER(inThreadId);
+    PS_UNREFERENCED_PARAMETER(inNumCalls);
+#endif
+}
+
+//--------------------------------------------------------------------------
+/// Default constructor.
+//--------------------------------------------------------------------------
+BinaryTraceWriter::BinaryTraceWriter()
+    : mPrefixString(s_BinaryTraceNoString)
+    , mSuffixString(s_BinaryTraceNoString)
+    , mAPIString(s_BinaryTraceNoString)
+    , mbMerged(false)
+{
+}
+
+//--------------------------------------------------------------------------
+/// Start a new section. All calls added after this are part of the new section.
+/// \param inFrameIndex The index of the frame that the calls were traced in.
+/// \param inThreadId The Id of the thread that made the calls.
+//--------------------------------------------------------------------------
+void BinaryTraceWriter::BeginSection(unsigned int inFrameIndex, DWORD inThreadId)
+{
+    BinaryTraceSection newSection;
+    newSection.mFrameIndex = inFrameIndex;
+    newSection.mThreadId = static_cast<UINT32>(inThreadId);
+
+    // Stored as a call index until the file is written and the real offset is known.
+    newSection.mFirstCallOffset = mCalls.size();
+    newSection.mNumCalls = 0;
+    newSection.mReserved = 0;
+
+    mSections.push_back(newSection);
+}
+
+//--------------------------------------------------------------------------
+/// Add a call to the current section.
+/// \param inAPIType The API group that the function belongs to.
+/// \param inFunctionId The FuncId of the function.
+/// \param inInterface The interface handle, as written in the text response.
+/// \param inFunctionName The "Interface_FunctionName" string.
+/// \param inParameters The call's parameters.
+/// \param inReturnValue The call's return value.
+/// \param inStartTime The start time of the call, in milliseconds from the start of the frame.
+/// \param inEndTime The end time of the call, in milliseconds from the start of the frame.
+/// \param inSampleId The sample Id of the call.
+//--------------------------------------------------------------------------
+void BinaryTraceWriter::AddCall(UINT32 inAPIType, UINT32 inFunctionId, const char* inInterface, const char* inFunctionName, const char* inParameters, const char* inReturnValue,
+                                double inStartTime, double inEndTime, UINT32 inSampleId)
+{
+    if (mSections.empty())
+    {
+        Log(logERROR, "BinaryTraceWriter::AddCall called before BeginSection.\n");
+        return;
+    }
+
+    BinaryTraceCall newCall;
+    newCall.mInterfaceString = InternString(inInterface);
+    newCall.mFunctionNameString = InternString(inFunctionName);
+    newCall.mParametersString = InternString(inParameters);
+    newCall.mReturnValueString = InternString(inReturnValue);
+    newCall.mStartTime = inStartTime;
+    newCall.mEndTime = inEndTime;
+    newCall.mSampleId = inSampleId;
+    newCall.mFunctionId = inFunctionId;
+    newCall.mAPIType = inAPIType;
+    newCall.mReserved = 0;
+
+    mCalls.push_back(newCall);
+    mSections.back().mNumCalls++;
+}
+
+//--------------------------------------------------------------------------
+/// Set the text that comes before and after the API calls when the trace is converted back to text.
+/// \param inPrefix The text that comes before the API calls.
+/// \param inSuffix The text that comes after the API calls.
+//--------------------------------------------------------------------------
+void BinaryTraceWriter::SetSurroundingText(const std::string& inPrefix, const std::string& inSuffix)
+{
+    mPrefixString = InternString(inPrefix.c_str());
+    mSuffixString = InternString(inSuffix.c_str());
+}
+
+//--------------------------------------------------------------------------
+/// Set the name of the traced API, which the text form may include for each thread.
+/// \param inAPIName The name of the traced API.
+//--------------------------------------------------------------------------
+void BinaryTraceWriter::SetAPIName(const char* inAPIName)
+{
+    mAPIString = InternString(inAPIName);
+}
+
+//--------------------------------------------------------------------------
+/// Write the collected trace to a file.
+/// \param inFilePath The path to the file to write.
+/// \returns True if the whole file was written.
+//--------------------------------------------------------------------------
+bool BinaryTraceWriter::WriteToFile(const char* inFilePath) const
+{
+    FILE* traceFile = NULL;
+    fopen_s(&traceFile, inFilePath, "wb");
+
+    if (traceFile == NULL)
+    {
+        Log(logERROR, "Failed to open binary trace file for writing: '%s'\n", inFilePath);
+        return false;
+    }
+
+    // Work out where each block will live in the file.
+    BinaryTraceHeader header;
+    memcpy(header.mMagic, s_BinaryTraceMagic, sizeof(header.mMagic));
+    header.mVersion = s_BinaryTraceVersion;
+    header.mHeaderSize = sizeof(BinaryTraceHeader);
+
+    UINT64 callsOffset = sizeof(BinaryTraceHeader);
+    UINT64 stringOffsetsOffset = callsOffset + mCalls.size() * sizeof(BinaryTraceCall);
+    UINT64 stringDataOffset = stringOffsetsOffset + mStringOffsets.size() * sizeof(UINT32);
+    UINT64 sectionIndexOffset = AlignTraceOffset(stringDataOffset + mStringData.size());
+
+    BinaryTraceFooter footer;
+    footer.mSectionIndexOffset = sectionIndexOffset;
+    footer.mStringOffsetsOffset = stringOffsetsOffset;
+    footer.mStringDataOffset = stringDataOffset;
+    footer.mStringDataSize = mStringData.size();
+    footer.mNumSections = static_cast<UINT32>(mSections.size());
+    footer.mNumStrings = static_cast<UINT32>(mStringOffsets.size());
+    footer.mPrefixString = mPrefixString;
+    footer.mSuffixString = mSuffixString;
+    footer.mAPIString = mAPIString;
+    footer.mFlags = (mbMerged ? s_BinaryTraceFlagMerged : 0) | s_BinaryTraceFormatFlags;
+    footer.mVersion = s_BinaryTraceVersion;
+    footer.mReserved = 0;
+    memcpy(footer.mMagic, s_BinaryTraceMagic, sizeof(footer.mMagic));
+
+    // Turn each section's first call index into a file offset.
+    std::vector<BinaryTraceSection> sectionIndex(mSections);
+
+    for (size_t sectionIndexPos = 0; sectionIndexPos < sectionIndex.size(); ++sectionIndexPos)
+    {
+        sectionIndex[sectionIndexPos].mFirstCallOffset = callsOffset + sectionIndex[sectionIndexPos].mFirstCallOffset * sizeof(BinaryTraceCall);
+    }
+
+    static const char s_Padding[8] = { 0 };
+    size_t paddingSize = static_cast<size_t>(sectionIndexOffset - (stringDataOffset + mStringData.size()));
+
+    bool bWrittenSuccessfully = (fwrite(&header, sizeof(header), 1, traceFile) == 1);
+
+    if (bWrittenSuccessfully && !mCalls.empty())
+    {
+        bWrittenSuccessfully = (fwrite(&mCalls[0], sizeof(BinaryTraceCall), mCalls.size(), traceFile) == mCalls.size());
+    }
+
+    if (bWrittenSuccessfully && !mStringOffsets.empty())
+    {
+        bWrittenSuccessfully = (fwrite(&mStringOffsets[0], sizeof(UINT32), mStringOffsets.size(), traceFile) == mStringOffsets.size());
+    }
+
+    if (bWrittenSuccessfully && !mStringData.empty())
+    {
+        bWrittenSuccessfully = (fwrite(mStringData.data(), 1, mStringData.size(), traceFile) == mStringData.size());
+    }
+
+    if (bWrittenSuccessfully && paddingSize > 0)
+    {
+        bWrittenSuccessfully = (fwrite(s_Padding, 1, paddingSize, traceFile) == paddingSize);
+    }
+
+    if (bWrittenSuccessfully && !sectionIndex.empty())
+    {
+        bWrittenSuccessfully = (fwrite(&sectionIndex[0], sizeof(BinaryTraceSection), sectionIndex.size(), traceFile) == sectionIndex.size());
+    }
+
+    if (bWrittenSuccessfully)
+    {
+        bWrittenSuccessfully = (fwrite(&footer, sizeof(footer), 1, traceFile) == 1);
+    }
+
+    if (fclose(traceFile) != 0)
+    {
+        bWrittenSuccessfully = false;
+    }
+
+    if (!bWrittenSuccessfully)
+    {
+        Log(logERROR, "Failed to write binary trace file: '%s'\n", inFilePath);
+    }
+
+    return bWrittenSuccessfully;
+}
+
+//--------------------------------------------------------------------------
+/// Find or add a string in the string table.
+/// \param inString The string to look up.
+/// \returns The string's index in the string table.
+//--------------------------------------------------------------------------
+UINT32 BinaryTraceWriter::InternString(const char* inString)
+{
+    const char* stringToIntern = (inString != NULL) ? inString : "";
+    std::unordered_map<std::string, UINT32>::iterator stringIter = mStringIndices.find(stringToIntern);
+
+    if (stringIter != mStringIndices.end())
+    {
+        return stringIter->second;
+    }
+
+    UINT32 stringIndex = static_cast<UINT32>(mStringOffsets.size());
+    mStringOffsets.push_back(static_cast<UINT32>(mStringData.size()));
+    mStringData.append(stringToIntern);
+    mStringData.push_back('\0');
+    mStringIndices[stringToIntern] = stringIndex;
+
+    return stringIndex;
+}
+
+//--------------------------------------------------------------------------
+/// Default constructor.
+//--------------------------------------------------------------------------
+BinaryTraceReader::BinaryTraceReader()
+#if defined (_WIN32)
+    : mFileHandle(INVALID_HANDLE_VALUE)
+    , mMappingHandle(NULL)
+#else
+    : mFileDescriptor(-1)
+#endif
+    , mMappedData(NULL)
+    , mMappedSize(0)
+    , mFooter(NULL)
+    , mSections(NULL)
+    , mStringOffsets(NULL)
+    , mStringData(NULL)
+{
+}
+
+//--------------------------------------------------------------------------
+/// Destructor unmaps the file.
+//--------------------------------------------------------------------------
+BinaryTraceReader::~BinaryTraceReader()
+{
+    Close();
+}
+
+//--------------------------------------------------------------------------
+/// Map a binary trace file and validate its header, footer and index.
+/// \param inFilePath The path to the file to open.
+/// \returns True if the file was mapped and is a valid binary trace.
+//--------------------------------------------------------------------------
+bool BinaryTraceReader::Open(const char* inFilePath)
+{
+    Close();
+
+#if defined (_WIN32)
+    mFileHandle = CreateFileA(inFilePath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+
+    if (mFileHandle == INVALID_HANDLE_VALUE)
+    {
+        Log(logERROR, "Failed to open binary trace file '%s'. Error %d\n", inFilePath, GetLastError());
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+
+    if (GetFileSizeEx(mFileHandle, &fileSize) == FALSE || fileSize.QuadPart < static_cast<LONGLONG>(sizeof(BinaryTraceHeader) + sizeof(BinaryTraceFooter)))
+    {
+        Log(logERROR, "Binary trace file '%s' is too small to be valid.\n", inFilePath);
+        Close();
+        return false;
+    }
+
+    mMappingHandle = CreateFileMapping(mFileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+
+    if (mMappingHandle != NULL)
+    {
+        mMappedData = static_cast<const char*>(MapViewOfFile(mMappingHandle, FILE_MAP_READ, 0, 0, 0));
+    }
+
+    mMappedSize = static_cast<UINT64>(fileSize.QuadPart);
+#else
+    mFileDescriptor = open(inFilePath, O_RDONLY);
+
+    if (mFileDescriptor == -1)
+    {
+        Log(logERROR, "Failed to open binary trace file '%s'.\n", inFilePath);
+        return false;
+    }
+
+    struct stat fileStats;
+
+    if (fstat(mFileDescriptor, &fileStats) != 0 || fileStats.st_size < static_cast<off_t>(sizeof(BinaryTraceHeader) + sizeof(BinaryTraceFooter)))
+    {
+        Log(logERROR, "Binary trace file '%s' is too small to be valid.\n", inFilePath);
+        Close();
+        return false;
+    }
+
+    void* mappedFile = mmap(NULL, fileStats.st_size, PROT_READ, MAP_PRIVATE, mFileDescriptor, 0);
+
+    if (mappedFile != MAP_FAILED)
+    {
+        mMappedData = static_cast<const char*>(mappedFile);
+    }
+
+    mMappedSize = static_cast<UINT64>(fileStats.st_size);
+#endif
+
+    if (mMappedData == NULL)
+    {
+        Log(logERROR, "Failed to map binary trace file '%s'.\n", inFilePath);
+        Close();
+        return false;
+    }
+
+    if (!Validate())
+    {
+        Log(logERROR, "Binary trace file '%s' is not a valid version %d trace.\n", inFilePath, s_BinaryTraceVersion);
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------
+/// Unmap the file. Any pointers returned by the reader become invalid.
+//--------------------------------------------------------------------------
+void BinaryTraceReader::Close()
+{
+#if defined (_WIN32)
+
+    if (mMappedData != NULL)
+    {
+        UnmapViewOfFile(mMappedData);
+    }
+
+    if (mMappingHandle != NULL)
+    {
+        CloseHandle(mMappingHandle);
+        mMappingHandle = NULL;
+    }
+
+    if (mFileHandle != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(mFileHandle);
+        mFileHandle = INVALID_HANDLE_VALUE;
+    }
+
+#else
+
+    if (mMappedData != NULL)
+    {
+        munmap(const_cast<char*>(mMappedData), static_cast<size_t>(mMappedSize));
+    }
+
+    if (mFileDescriptor != -1)
+    {
+        close(mFileDescriptor);
+        mFileDescriptor = -1;
+    }
+
+#endif
+
+    mMappedData = NULL;
+    mMappedSize = 0;
+    mFooter = NULL;
+    mSections = NULL;
+    mStringOffsets = NULL;
+    mStringData = NULL;
+}
+
+//--------------------------------------------------------------------------
+/// Find the section holding the calls traced by a thread in a frame.
+/// \param inFrameIndex The index of the frame.
+/// \param inThreadId The Id of the thread.
+/// \returns The section, or NULL if the thread didn't trace anything in the frame.
+//--------------------------------------------------------------------------
+const BinaryTraceSection* BinaryTraceReader::FindSection(UINT32 inFrameIndex, UINT32 inThreadId) const
+{
+    UINT32 numSections = GetNumSections();
+
+    for (UINT32 sectionIndex = 0; sectionIndex < numSections; ++sectionIndex)
+    {
+        if (mSections[sectionIndex].mFrameIndex == inFrameIndex && mSections[sectionIndex].mThreadId == inThreadId)
+        {
+            return &mSections[sectionIndex];
+        }
+    }
+
+    return NULL;
+}
+
+//--------------------------------------------------------------------------
+/// Retrieve the calls in a section.
+/// \param inSection The section to retrieve the calls for.
+/// \returns A pointer to the section's first call within the mapped file.
+//--------------------------------------------------------------------------
+const BinaryTraceCall* BinaryTraceReader::GetCalls(const BinaryTraceSection& inSection) const
+{
+    return reinterpret_cast<const BinaryTraceCall*>(mMappedData + inSection.mFirstCallOffset);
+}
+
+//--------------------------------------------------------------------------
+/// Retrieve a string from the string table.
+/// \param inStringIndex The index of the string.
+/// \returns The string within the mapped file, or an empty string if the index is invalid.
+//--------------------------------------------------------------------------
+const char* BinaryTraceReader::GetString(UINT32 inStringIndex) const
+{
+    if (mFooter == NULL || inStringIndex >= mFooter->mNumStrings)
+    {
+        return "";
+    }
+
+    return mStringData + mStringOffsets[inStringIndex];
+}
+
+//--------------------------------------------------------------------------
+/// The position of the next call to convert from a single section. Used to interleave merged traces.
+//--------------------------------------------------------------------------
+struct BinaryTraceCursor
+{
+    /// The start time of the call at mCallIndex.
+    double mStartTime;
+
+    /// The index of the section. Used to keep the order stable when start times match.
+    UINT32 mSectionIndex;
+
+    /// The index of the next call within the section.
+    UINT32 mCallIndex;
+};
+
+//--------------------------------------------------------------------------
+/// Orders the merge heap so that the cursor with the earliest call is on top.
+//--------------------------------------------------------------------------
+struct BinaryTraceCursorLater
+{
+    //--------------------------------------------------------------------------
+    /// Check if a cursor's call should be written after another cursor's call.
+    /// \param inLeft The first cursor to compare.
+    /// \param inRight The second cursor to compare.
+    /// \returns True if the call at inLeft started after the call at inRight.
+    //--------------------------------------------------------------------------
+    bool operator()(const BinaryTraceCursor& inLeft, const BinaryTraceCursor& inRight) const
+    {
+        if (inLeft.mStartTime != inRight.mStartTime)
+        {
+            return inLeft.mStartTime > inRight.mStartTime;
+        }
+
+        return inLeft.mSectionIndex > inRight.mSectionIndex;
+    }
+};
+
+//--------------------------------------------------------------------------
+/// Convert the trace back into the text format that clients expect.
+/// \param outTraceText The string that the text form of the trace is written to.
+//--------------------------------------------------------------------------
+void BinaryTraceReader::ConvertToText(std::string& outTraceText) const
+{
+    outTraceText.clear();
+
+    if (mFooter == NULL)
+    {
+        return;
+    }
+
+    outTraceText.append(GetString(mFooter->mPrefixString));
+
+    UINT32 numSections = GetNumSections();
+    bool bWroteCalls = false;
+
+    if ((mFooter->mFlags & s_BinaryTraceFlagMerged) != 0)
+    {
+        std::priority_queue<BinaryTraceCursor, std::vector<BinaryTraceCursor>, BinaryTraceCursorLater> mergeHeap;
+
+        for (UINT32 sectionIndex = 0; sectionIndex < numSections; ++sectionIndex)
+        {
+            if (mSections[sectionIndex].mNumCalls > 0)
+            {
+                BinaryTraceCursor sectionCursor;
+                sectionCursor.mStartTime = GetCalls(mSections[sectionIndex])[0].mStartTime;
+                sectionCursor.mSectionIndex = sectionIndex;
+                sectionCursor.mCallIndex = 0;
+                mergeHeap.push(sectionCursor);
+            }
+        }
+
+        while (!mergeHeap.empty())
+        {
+            BinaryTraceCursor nextCursor = mergeHeap.top();
+            mergeHeap.pop();
+
+            const BinaryTraceSection& section = mSections[nextCursor.mSectionIndex];
+            const BinaryTraceCall* sectionCalls = GetCalls(section);
+            AppendCallText(outTraceText, section.mThreadId, sectionCalls[nextCursor.mCallIndex]);
+            bWroteCalls = true;
+
+            nextCursor.mCallIndex++;
+
+            if (nextCursor.mCallIndex < section.mNumCalls)
+            {
+                nextCursor.mStartTime = sectionCalls[nextCursor.mCallIndex].mStartTime;
+                mergeHeap.push(nextCursor);
+            }
+        }
+    }
+    else
+    {
+        for (UINT32 sectionIndex = 0; sectionIndex < numSections; ++sectionIndex)
+        {
+            const BinaryTraceSection& section = mSections[sectionIndex];
+            const BinaryTraceCall* sectionCalls = GetCalls(section);
+
+            if (section.mNumCalls > 0)
+            {
+                std::stringstream threadHeader;
+                FormatAPITraceThreadHeader(threadHeader, GetString(mFooter->mAPIString), section.mThreadId, section.mNumCalls);
+                outTraceText.append(threadHeader.str());
+            }
+
+            for (UINT32 callIndex = 0; callIndex < section.mNumCalls; ++callIndex)
+            {
+                AppendCallText(outTraceText, section.mThreadId, sectionCalls[callIndex]);
+                bWroteCalls = true;
+            }
+        }
+    }
+
+    // Match the known failure signal that the text response uses when nothing was traced.
+    if (!bWroteCalls)
+    {
+        outTraceText.append("NODATA");
+    }
+
+    outTraceText.append(GetString(mFooter->mSuffixString));
+}
+
+//--------------------------------------------------------------------------
+/// Check that the mapped file's header, footer and index are consistent with its size.
+/// \returns True if the mapped file is a valid binary trace.
+//--------------------------------------------------------------------------
+bool BinaryTraceReader::Validate()
+{
+    const BinaryTraceHeader* header = reinterpret_cast<const BinaryTraceHeader*>(mMappedData);
+
+    if (memcmp(header->mMagic, s_BinaryTraceMagic, sizeof(header->mMagic)) != 0 || header->mVersion != s_BinaryTraceVersion || header->mHeaderSize != sizeof(BinaryTraceHeader))
+    {
+        return false;
+    }
+
+    UINT64 footerOffset = mMappedSize - sizeof(BinaryTraceFooter);
+    const BinaryTraceFooter* footer = reinterpret_cast<const BinaryTraceFooter*>(mMappedData + footerOffset);
+
+    if (memcmp(footer->mMagic, s_BinaryTraceMagic, sizeof(footer->mMagic)) != 0 || footer->mVersion != s_BinaryTraceVersion)
+    {
+        return false;
+    }
+
+    // The text is rebuilt in this build's format, so a trace written for the other client can't be converted.
+    if ((footer->mFlags & s_BinaryTraceFlagCodeXL) != s_BinaryTraceFormatFlags)
+    {
+        Log(logERROR, "The binary trace was written for a different client's trace format.\n");
+        return false;
+    }
+
+    // Each block must be aligned, and must lie between the header and the footer in the expected order.
+    if ((footer->mSectionIndexOffset % 8) != 0 || (footer->mStringOffsetsOffset % 8) != 0 ||
+        footer->mStringOffsetsOffset < sizeof(BinaryTraceHeader) ||
+        footer->mStringDataOffset < footer->mStringOffsetsOffset + static_cast<UINT64>(footer->mNumStrings) * sizeof(UINT32) ||
+        footer->mSectionIndexOffset < footer->mStringDataOffset + footer->mStringDataSize ||
+        footerOffset < footer->mSectionIndexOffset + static_cast<UINT64>(footer->mNumSections) * sizeof(BinaryTraceSection))
+    {
+        return false;
+    }
+
+    const BinaryTraceSection* sections = reinterpret_cast<const BinaryTraceSection*>(mMappedData + footer->mSectionIndexOffset);
+
+    for (UINT32 sectionIndex = 0; sectionIndex < footer->mNumSections; ++sectionIndex)
+    {
+        const BinaryTraceSection& section = sections[sectionIndex];
+
+        if (section.mFirstCallOffset < sizeof(BinaryTraceHeader) || (section.mFirstCallOffset % 8) != 0 ||
+            section.mFirstCallOffset + static_cast<UINT64>(section.mNumCalls) * sizeof(BinaryTraceCall) > footer->mStringOffsetsOffset)
+        {
+            return false;
+        }
+    }
+
+    // Every string must start inside the string data, and the data must end with a terminator.
+    const UINT32* stringOffsets = reinterpret_cast<const UINT32*>(mMappedData + footer->mStringOffsetsOffset);
+    const char* stringData = mMappedData + footer->mStringDataOffset;
+
+    if (footer->mNumStrings > 0 && (footer->mStringDataSize == 0 || stringData[footer->mStringDataSize - 1] != '\0'))
+    {
+        return false;
+    }
+
+    for (UINT32 stringIndex = 0; stringIndex < footer->mNumStrings; ++stringIndex)
+    {
+        if (stringOffsets[stringIndex] >= footer->mStringDataSize)
+        {
+            return false;
+        }
+    }
+
+    mFooter = footer;
+    mSections = sections;
+    mStringOffsets = stringOffsets;
+    mStringData = stringData;
+
+    return true;
+}
+
+//--------------------------------------------------------------------------
+/// Append a single call to the text form of the trace.
+/// \param ioTraceText The text to append to.
+/// \param inThreadId The Id of the thread that made the call.
+/// \param inCall The call to append.
+//--------------------------------------------------------------------------
+void BinaryTraceReader::AppendCallText(std::string& ioTraceText, UINT32 inThreadId, const BinaryTraceCall& inCall) const
+{
+    std::stringstream callLine;
+    FormatAPITraceLine(callLine, inThreadId, inCall.mAPIType, inCall.mFunctionId,
+                       GetString(inCall.mInterfaceString), GetString(inCall.mFunctionNameString),
+                       GetString(inCall.mParametersString), GetString(inCall.mReturnValueString),
+                       inCall.mStartTime, inCall.mEndTime, inCall.mSampleId);
+
+    ioTraceText.append(callLine.str());
+}
@@ -0,0 +1,470 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  A compact, indexed, binary container for API Trace responses, with
+///         a memory-mapped reader that converts back to the text format, and
+///         the functions that write that text format.
+//==============================================================================
+
+#ifndef BINARYTRACEFILE_H
+#define BINARYTRACEFILE_H
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "CommonTypes.h"
+
+//--------------------------------------------------------------------------
+/// Write one call as a line of the API Trace text response. This is the only place
+/// the line format is defined, so the text response and the text rebuilt from a
+/// binary trace always match. The format depends on the client that the server
+/// is built for:
+/// GPUPerfStudio: ThreadId Interface Interface_FunctionName(Parameters) = ReturnValue StartTime EndTime SampleId
+/// CodeXL:        APIType FunctionId Interface Interface_FunctionName(Parameters) = ReturnValue StartTime EndTime SampleId
+/// \param ioTraceResponse The stream to write the line to.
+/// \param inThreadId The Id of the thread that made the call.
+/// \param inAPIType The API group that the function belongs to.
+/// \param inFunctionId The FuncId of the function.
+/// \param inInterface The interface handle, as written in the response.
+/// \param inFunctionName The "Interface_FunctionName" string.
+/// \param inParameters The call's parameters.
+/// \param inReturnValue The call's return value.
+/// \param inStartTime The start time of the call, in milliseconds from the start of the frame.
+/// \param inEndTime The end time of the call, in milliseconds from the start of the frame.
+/// \param inSampleId The sample Id of the call.
+//--------------------------------------------------------------------------
+void FormatAPITraceLine(std::ostream& ioTraceResponse, UINT32 inThreadId, UINT32 inAPIType, UINT32 inFunctionId, const char* inInterface, const char* inFunctionName,
+                        const char* inParameters, const char* inReturnValue, double inStartTime, double inEndTime, UINT32 inSampleId);
+
+//--------------------------------------------------------------------------
+/// Write the text that comes before each thread's calls in the per-thread API Trace
+/// text response. Only CodeXL expects anything here; GPUPerfStudio's lines each
+/// carry their own ThreadId, so nothing is written for it.
+/// \param ioTraceResponse The stream to write the text to.
+/// \param inAPIName The name of the traced API.
+/// \param inThreadId The Id of the thread.
+/// \param inNumCalls The number of calls traced by the thread.
+//--------------------------------------------------------------------------
+void FormatAPITraceThreadHeader(std::ostream& ioTraceResponse, const char* inAPIName, UINT32 inThreadId, size_t inNumCalls);
+
+//--------------------------------------------------------------------------
+/// The version of the binary trace container written by this build. Readers reject other versions.
+//--------------------------------------------------------------------------
+static const UINT32 s_BinaryTraceVersion = 2;
+
+//--------------------------------------------------------------------------
+/// The file extension used for binary trace files.
+//--------------------------------------------------------------------------
+static const char* const s_BinaryTraceExtension = "btr";
+
+//--------------------------------------------------------------------------
+/// Set in BinaryTraceFooter::mFlags when the text form should interleave all threads by start time.
+//--------------------------------------------------------------------------
+static const UINT32 s_BinaryTraceFlagMerged = 0x1;
+
+//--------------------------------------------------------------------------
+/// Set in BinaryTraceFooter::mFlags when the trace was written for CodeXL's text format.
+/// Readers reject traces written for the other format.
+//--------------------------------------------------------------------------
+static const UINT32 s_BinaryTraceFlagCodeXL = 0x2;
+
+//--------------------------------------------------------------------------
+/// Used in place of a string table index when there is no string.
+//--------------------------------------------------------------------------
+static const UINT32 s_BinaryTraceNoString = 0xFFFFFFFF;
+
+//--------------------------------------------------------------------------
+/// The binary trace file layout is:
+///     BinaryTraceHeader
+///     BinaryTraceCall[]       One contiguous run of calls per section.
+///     UINT32[]                The offset of each string within the string data.
+///     char[]                  The null-terminated string data.
+///     BinaryTraceSection[]    The index of sections, by frame and thread.
+///     BinaryTraceFooter
+/// All blocks are 8-byte aligned so that a mapped file can be read in place.
+//--------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------
+/// The header at the start of every binary trace file.
+//--------------------------------------------------------------------------
+struct BinaryTraceHeader
+{
+    /// Identifies the file as a binary trace. Always "GPSBTRC".
+    char mMagic[8];
+
+    /// The version of the container.
+    UINT32 mVersion;
+
+    /// The size of this header. Calls begin directly after it.
+    UINT32 mHeaderSize;
+};
+
+//--------------------------------------------------------------------------
+/// A single traced call. Every text field is stored as an index into the string table,
+/// so repeated function names, interfaces and return values are only stored once.
+//--------------------------------------------------------------------------
+struct BinaryTraceCall
+{
+    /// The string table index of the interface handle.
+    UINT32 mInterfaceString;
+
+    /// The string table index of the "Interface_FunctionName" string.
+    UINT32 mFunctionNameString;
+
+    /// The string table index of the call's parameters.
+    UINT32 mParametersString;
+
+    /// The string table index of the call's return value.
+    UINT32 mReturnValueString;
+
+    /// The start time of the call, in milliseconds from the start of the frame.
+    double mStartTime;
+
+    /// The end time of the call, in milliseconds from the start of the frame.
+    double mEndTime;
+
+    /// The sample Id used to associate the call with GPU profiling results.
+    UINT32 mSampleId;
+
+    /// The FuncId of the function that was called.
+    UINT32 mFunctionId;
+
+    /// The API group that the function belongs to.
+    UINT32 mAPIType;
+
+    /// Padding to keep each call 8-byte aligned.
+    UINT32 mReserved;
+};
+
+//--------------------------------------------------------------------------
+/// An entry in the footer index. Each section holds the calls traced by one thread in one frame.
+//--------------------------------------------------------------------------
+struct BinaryTraceSection
+{
+    /// The index of the frame that the calls were traced in.
+    UINT32 mFrameIndex;
+
+    /// The Id of the thread that made the calls.
+    UINT32 mThreadId;
+
+    /// The file offset of the section's first BinaryTraceCall.
+    UINT64 mFirstCallOffset;
+
+    /// The number of calls in the section.
+    UINT32 mNumCalls;
+
+    /// Padding to keep each section 8-byte aligned.
+    UINT32 mReserved;
+};
+
+//--------------------------------------------------------------------------
+/// The footer at the end of every binary trace file. Readers start here to find the index and string table.
+//--------------------------------------------------------------------------
+struct BinaryTraceFooter
+{
+    /// The file offset of the first BinaryTraceSection.
+    UINT64 mSectionIndexOffset;
+
+    /// The file offset of the string offset table.
+    UINT64 mStringOffsetsOffset;
+
+    /// The file offset of the string data.
+    UINT64 mStringDataOffset;
+
+    /// The size of the string data in bytes.
+    UINT64 mStringDataSize;
+
+    /// The number of sections in the index.
+    UINT32 mNumSections;
+
+    /// The number of strings in the string table.
+    UINT32 mNumStrings;
+
+    /// The string table index of the text that comes before the API calls in the text response.
+    UINT32 mPrefixString;
+
+    /// The string table index of the text that comes after the API calls in the text response.
+    UINT32 mSuffixString;
+
+    /// The string table index of the name of the traced API.
+    UINT32 mAPIString;
+
+    /// A combination of the s_BinaryTraceFlag values.
+    UINT32 mFlags;
+
+    /// The version of the container. Matches the header.
+    UINT32 mVersion;
+
+    /// Padding to keep the footer 8-byte aligned.
+    UINT32 mReserved;
+
+    /// Identifies the end of a complete file. Always "GPSBTRC".
+    char mMagic[8];
+};
+
+//--------------------------------------------------------------------------
+/// BinaryTraceWriter collects traced calls in memory and writes them out as a binary trace file.
+/// Calls are added to the section that was most recently started with BeginSection.
+//--------------------------------------------------------------------------
+class BinaryTraceWriter
+{
+public:
+    //--------------------------------------------------------------------------
+    /// Default constructor.
+    //--------------------------------------------------------------------------
+    BinaryTraceWriter();
+
+    //--------------------------------------------------------------------------
+    /// Start a new section. All calls added after this are part of the new section.
+    /// \param inFrameIndex The index of the frame that the calls were traced in.
+    /// \param inThreadId The Id of the thread that made the calls.
+    //--------------------------------------------------------------------------
+    void BeginSection(unsigned int inFrameIndex, DWORD inThreadId);
+
+    //--------------------------------------------------------------------------
+    /// Add a call to the current section.
+    /// \param inAPIType The API group that the function belongs to.
+    /// \param inFunctionId The FuncId of the function.
+    /// \param inInterface The interface handle, as written in the text response.
+    /// \param inFunctionName The "Interface_FunctionName" string.
+    /// \param inParameters The call's parameters.
+    /// \param inReturnValue The call's return value.
+    /// \param inStartTime The start time of the call, in milliseconds from the start of the frame.
+    /// \param inEndTime The end time of the call, in milliseconds from the start of the frame.
+    /// \param inSampleId The sample Id of the call.
+    //--------------------------------------------------------------------------
+    void AddCall(UINT32 inAPIType, UINT32 inFunctionId, const char* inInterface, const char* inFunctionName, const char* inParameters, const char* inReturnValue,
+                 double inStartTime, double inEndTime, UINT32 inSampleId);
+
+    //--------------------------------------------------------------------------
+    /// Set the text that comes before and after the API calls when the trace is converted back to text.
+    /// \param inPrefix The text that comes before the API calls.
+    /// \param inSuffix The text that comes after the API calls.
+    //--------------------------------------------------------------------------
+    void SetSurroundingText(const std::string& inPrefix, const std::string& inSuffix);
+
+    //--------------------------------------------------------------------------
+    /// Set the name of the traced API, which the text form may include for each thread.
+    /// \param inAPIName The name of the traced API.
+    //--------------------------------------------------------------------------
+    void SetAPIName(const char* inAPIName);
+
+    //--------------------------------------------------------------------------
+    /// Choose whether the text form interleaves all threads by start time, instead of writing one thread at a time.
+    /// \param inbMerged True to interleave the calls from all threads.
+    //--------------------------------------------------------------------------
+    void SetMerged(bool inbMerged) { mbMerged = inbMerged; }
+
+    //--------------------------------------------------------------------------
+    /// Retrieve the number of calls added to the writer.
+    /// \returns The number of calls in all sections.
+    //--------------------------------------------------------------------------
+    size_t GetNumCalls() const { return mCalls.size(); }
+
+    //--------------------------------------------------------------------------
+    /// Write the collected trace to a file.
+    /// \param inFilePath The path to the file to write.
+    /// \returns True if the whole file was written.
+    //--------------------------------------------------------------------------
+    bool WriteToFile(const char* inFilePath) const;
+
+private:
+    //--------------------------------------------------------------------------
+    /// Find or add a string in the string table.
+    /// \param inString The string to look up.
+    /// \returns The string's index in the string table.
+    //--------------------------------------------------------------------------
+    UINT32 InternString(const char* inString);
+
+    //--------------------------------------------------------------------------
+    /// All calls in the order they were added. Sections refer to contiguous runs of these.
+    //--------------------------------------------------------------------------
+    std::vector<BinaryTraceCall> mCalls;
+
+    //--------------------------------------------------------------------------
+    /// The sections in the order they were started. Call offsets are stored as call indices until written.
+    //--------------------------------------------------------------------------
+    std::vector<BinaryTraceSection> mSections;
+
+    //--------------------------------------------------------------------------
+    /// The offset of each string within mStringData.
+    //--------------------------------------------------------------------------
+    std::vector<UINT32> mStringOffsets;
+
+    //--------------------------------------------------------------------------
+    /// The null-terminated string data.
+    //--------------------------------------------------------------------------
+    std::string mStringData;
+
+    //--------------------------------------------------------------------------
+    /// A lookup of each string's index in the string table.
+    //--------------------------------------------------------------------------
+    std::unordered_map<std::string, UINT32> mStringIndices;
+
+    //--------------------------------------------------------------------------
+    /// The string table index of the text that comes before the API calls.
+    //--------------------------------------------------------------------------
+    UINT32 mPrefixString;
+
+    //--------------------------------------------------------------------------
+    /// The string table index of the text that comes after the API calls.
+    //--------------------------------------------------------------------------
+    UINT32 mSuffixString;
+
+    //--------------------------------------------------------------------------
+    /// The string table index of the name of the traced API.
+    //--------------------------------------------------------------------------
+    UINT32 mAPIString;
+
+    //--------------------------------------------------------------------------
+    /// True if the text form interleaves all threads by start time.
+    //--------------------------------------------------------------------------
+    bool mbMerged;
+};
+
+//--------------------------------------------------------------------------
+/// BinaryTraceReader memory-maps a binary trace file. Calls and strings are read in place
+/// without being copied, and remain valid until the reader is closed.
+//--------------------------------------------------------------------------
+class BinaryTraceReader
+{
+public:
+    //--------------------------------------------------------------------------
+    /// Default constructor.
+    //--------------------------------------------------------------------------
+    BinaryTraceReader();
+
+    //--------------------------------------------------------------------------
+    /// Destructor unmaps the file.
+    //--------------------------------------------------------------------------
+    ~BinaryTraceReader();
+
+    //--------------------------------------------------------------------------
+    /// Map a binary trace file and validate its header, footer and index.
+    /// \param inFilePath The path to the file to open.
+    /// \returns True if the file was mapped and is a valid binary trace.
+    //--------------------------------------------------------------------------
+    bool Open(const char* inFilePath);
+
+    //--------------------------------------------------------------------------
+    /// Unmap the file. Any pointers returned by the reader become invalid.
+    //--------------------------------------------------------------------------
+    void Close();
+
+    //--------------------------------------------------------------------------
+    /// Retrieve the number of sections in the file's index.
+    /// \returns The number of sections.
+    //--------------------------------------------------------------------------
+    UINT32 GetNumSections() const { return (mFooter != NULL) ? mFooter->mNumSections : 0; }
+
+    //--------------------------------------------------------------------------
+    /// Retrieve a section from the file's index.
+    /// \param inSectionIndex The index of the section. Must be less than GetNumSections().
+    /// \returns The section.
+    //--------------------------------------------------------------------------
+    const BinaryTraceSection& GetSection(UINT32 inSectionIndex) const { return mSections[inSectionIndex]; }
+
+    //--------------------------------------------------------------------------
+    /// Find the section holding the calls traced by a thread in a frame.
+    /// \param inFrameIndex The index of the frame.
+    /// \param inThreadId The Id of the thread.
+    /// \returns The section, or NULL if the thread didn't trace anything in the frame.
+    //--------------------------------------------------------------------------
+    const BinaryTraceSection* FindSection(UINT32 inFrameIndex, UINT32 inThreadId) const;
+
+    //--------------------------------------------------------------------------
+    /// Retrieve the calls in a section.
+    /// \param inSection The section to retrieve the calls for.
+    /// \returns A pointer to the section's first call within the mapped file.
+    //--------------------------------------------------------------------------
+    const BinaryTraceCall* GetCalls(const BinaryTraceSection& inSection) const;
+
+    //--------------------------------------------------------------------------
+    /// Retrieve a string from the string table.
+    /// \param inStringIndex The index of the string.
+    /// \returns The string within the mapped file, or an empty string if the index is invalid.
+    //--------------------------------------------------------------------------
+    const char* GetString(UINT32 inStringIndex) const;
+
+    //--------------------------------------------------------------------------
+    /// Convert the trace back into the text format that clients expect.
+    /// \param outTraceText The string that the text form of the trace is written to.
+    //--------------------------------------------------------------------------
+    void ConvertToText(std::string& outTraceText) const;
+
+private:
+    //--------------------------------------------------------------------------
+    /// Disable copying, since the reader owns the mapping.
+    //--------------------------------------------------------------------------
+    BinaryTraceReader(const BinaryTraceReader&);
+
+    //--------------------------------------------------------------------------
+    /// Disable assignment, since the reader owns the mapping.
+    //--------------------------------------------------------------------------
+    BinaryTraceReader& operator=(const BinaryTraceReader&);
+
+    //--------------------------------------------------------------------------
+    /// Check that the mapped file's header, footer and index are consistent with its size.
+    /// \returns True if the mapped file is a valid binary trace.
+    //--------------------------------------------------------------------------
+    bool Validate();
+
+    //--------------------------------------------------------------------------
+    /// Append a single call to the text form of the trace.
+    /// \param ioTraceText The text to append to.
+    /// \param inThreadId The Id of the thread that made the call.
+    /// \param inCall The call to append.
+    //--------------------------------------------------------------------------
+    void AppendCallText(std::string& ioTraceText, UINT32 inThreadId, const BinaryTraceCall& inCall) const;
+
+#if defined (_WIN32)
+    //--------------------------------------------------------------------------
+    /// The handle to the open file.
+    //--------------------------------------------------------------------------
+    HANDLE mFileHandle;
+
+    //--------------------------------------------------------------------------
+    /// The handle to the file mapping.
+    //--------------------------------------------------------------------------
+    HANDLE mMappingHandle;
+#else
+    //--------------------------------------------------------------------------
+    /// The descriptor of the open file.
+    //--------------------------------------------------------------------------
+    int mFileDescriptor;
+#endif
+
+    //--------------------------------------------------------------------------
+    /// The start of the mapped file.
+    //--------------------------------------------------------------------------
+    const char* mMappedData;
+
+    //--------------------------------------------------------------------------
+    /// The size of the mapped file in bytes.
+    //--------------------------------------------------------------------------
+    UINT64 mMappedSize;
+
+    //--------------------------------------------------------------------------
+    /// The footer within the mapped file.
+    //--------------------------------------------------------------------------
+    const BinaryTraceFooter* mFooter;
+
+    //--------------------------------------------------------------------------
+    /// The section index within the mapped file.
+    //--------------------------------------------------------------------------
+    const BinaryTraceSection* mSections;
+
+    //--------------------------------------------------------------------------
+    /// The string offset table within the mapped file.
+    //--------------------------------------------------------------------------
+    const UINT32* mStringOffsets;
+
+    //--------------------------------------------------------------------------
+    /// The string data within the mapped file.
+    //--------------------------------------------------------------------------
+    const char* mStringData;
+};
+
+#endif // BINARYTRACEFILE_H
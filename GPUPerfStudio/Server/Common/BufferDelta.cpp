@@ -2,17 +2,533 @@
 // Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
 /// \author AMD Developer Tools Team
 /// \file
-/// \brief  TODO add documentation
+/// \brief  A class that can calculate, store, and reapply a delta between
+///         two buffers of equal size.
 //==============================================================================
- 
+
 #if defined (_LINUX)
     #include "WinDefs.h"
 #endif
 #include "BufferDelta.h"
 #include <assert.h>
+#include <string.h>
 #include "Logger.h"
 #include "StreamLog.h"
 
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+    #define BUFFER_DELTA_X86
+    #include <emmintrin.h>
+    #include <immintrin.h>
+    #if defined(_WIN32)
+        #include <intrin.h>
+    #endif
+#endif
+
+#if defined(BUFFER_DELTA_X86) && defined(__GNUC__)
+    // GCC only allows the intrinsics in functions that are compiled for the instruction set.
+    #define BUFFER_DELTA_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define BUFFER_DELTA_TARGET(isa)
+#endif
+
+/// The number of bytes compared for each step of the scan. Each step produces a 64 bit mask.
+static const size_t DELTA_BLOCK_SIZE = 64;
+
+/// A mask with one bit set for each byte in a block that differs between the buffers.
+typedef unsigned long long DeltaMask;
+
+//===============================================================================================
+/// Counts the unset bits below the lowest set bit.
+/// \param[in] mask a mask with at least one bit set
+/// \return the index of the lowest set bit
+//===============================================================================================
+static inline unsigned int CountTrailingZeros(DeltaMask mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index = 0;
+#if defined(_M_X64)
+    _BitScanForward64(&index, mask);
+#else
+
+    if (_BitScanForward(&index, (unsigned long)mask) == 0)
+    {
+        _BitScanForward(&index, (unsigned long)(mask >> 32));
+        index += 32;
+    }
+
+#endif
+    return (unsigned int)index;
+#else
+    return (unsigned int)__builtin_ctzll(mask);
+#endif
+}
+
+//===============================================================================================
+/// Finds the highest set bit.
+/// \param[in] mask a mask with at least one bit set
+/// \return the index of the highest set bit
+//===============================================================================================
+static inline unsigned int HighestSetBit(DeltaMask mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index = 0;
+#if defined(_M_X64)
+    _BitScanReverse64(&index, mask);
+#else
+
+    if (_BitScanReverse(&index, (unsigned long)(mask >> 32)) != 0)
+    {
+        index += 32;
+    }
+    else
+    {
+        _BitScanReverse(&index, (unsigned long)mask);
+    }
+
+#endif
+    return (unsigned int)index;
+#else
+    return 63 - (unsigned int)__builtin_clzll(mask);
+#endif
+}
+
+//===============================================================================================
+/// Turns the masks from each block into the list of changed ranges, merging ranges that are
+/// separated by fewer than mergeGap unchanged bytes.
+//===============================================================================================
+class ChangedRangeBuilder
+{
+public:
+    //===============================================================================================
+    /// Constructor
+    /// \param[out] offsets receives the offset of each range
+    /// \param[out] sizes receives the size of each range
+    /// \param[in] mergeGap ranges separated by fewer unchanged bytes than this are merged
+    //===============================================================================================
+    ChangedRangeBuilder(std::vector<size_t>& offsets, std::vector<size_t>& sizes, size_t mergeGap)
+        : m_offsets(offsets),
+          m_sizes(sizes),
+          m_mergeGap(mergeGap),
+          m_bInRange(false),
+          m_rangeStart(0),
+          m_rangeEnd(0),
+          m_totalBytes(0)
+    {
+    }
+
+    //===============================================================================================
+    /// Adds the changed bytes in one block.
+    /// \param[in] blockOffset the offset of the block in the buffers
+    /// \param[in] mask one bit per byte of the block, set if the byte differs
+    //===============================================================================================
+    inline void AddBlock(size_t blockOffset, DeltaMask mask)
+    {
+        // when no gap inside the block is wide enough to split a range, which is common when
+        // most bytes have changed, the whole block is one run as far as the ranges are concerned
+        unsigned int firstBit = CountTrailingZeros(mask);
+        unsigned int lastBit = HighestSetBit(mask);
+
+        if (!HasSplittingGap(mask, firstBit, lastBit))
+        {
+            AddRun(blockOffset + firstBit, lastBit - firstBit + 1);
+            return;
+        }
+
+        while (mask != 0)
+        {
+            // find the next run of differing bytes in the block
+            unsigned int runStart = CountTrailingZeros(mask);
+            DeltaMask remaining = ~(mask >> runStart);
+            unsigned int runLength = (remaining == 0) ? (64 - runStart) : CountTrailingZeros(remaining);
+
+            AddRun(blockOffset + runStart, runLength);
+
+            // clear the bits of the run
+            unsigned int runEnd = runStart + runLength;
+            mask = (runEnd >= 64) ? 0 : (mask & (~(DeltaMask)0 << runEnd));
+        }
+    }
+
+    //===============================================================================================
+    /// Stores the last range.
+    /// \return the total number of bytes in the ranges
+    //===============================================================================================
+    size_t Finish()
+    {
+        if (m_bInRange)
+        {
+            StoreRange();
+            m_bInRange = false;
+        }
+
+        return m_totalBytes;
+    }
+
+private:
+    //===============================================================================================
+    /// Checks whether the unchanged bytes between the first and last changed bytes of a block
+    /// include a gap that is at least m_mergeGap bytes long.
+    /// \param[in] mask one bit per byte of the block, set if the byte differs
+    /// \param[in] firstBit the lowest set bit in the mask
+    /// \param[in] lastBit the highest set bit in the mask
+    /// \return true if the block's changes must be split into more than one range
+    //===============================================================================================
+    inline bool HasSplittingGap(DeltaMask mask, unsigned int firstBit, unsigned int lastBit) const
+    {
+        if (firstBit == lastBit)
+        {
+            return false;
+        }
+
+        if (m_mergeGap >= 64)
+        {
+            // the gaps inside a block are always shorter than this
+            return false;
+        }
+
+        // only the unchanged bytes between the first and last changed bytes count
+        DeltaMask inside = (~(DeltaMask)0 >> (63 - lastBit)) & (~(DeltaMask)0 << firstBit);
+        DeltaMask gaps = ~mask & inside;
+
+        if (m_mergeGap <= 1)
+        {
+            return gaps != 0;
+        }
+
+        // after each step, a bit stays set only if it begins a gap at least gapLength bytes long
+        size_t gapLength = 1;
+
+        while (gaps != 0 && gapLength * 2 <= m_mergeGap)
+        {
+            gaps &= gaps >> gapLength;
+            gapLength *= 2;
+        }
+
+        if (gapLength < m_mergeGap)
+        {
+            gaps &= gaps >> (m_mergeGap - gapLength);
+        }
+
+        return gaps != 0;
+    }
+
+    //===============================================================================================
+    /// Adds a run of differing bytes, extending the current range if the run is close enough.
+    /// \param[in] offset the offset of the run
+    /// \param[in] size the number of bytes in the run
+    //===============================================================================================
+    inline void AddRun(size_t offset, size_t size)
+    {
+        // runs that touch are always joined, such as a run that continues into the next block
+        if (m_bInRange && (offset == m_rangeEnd || offset - m_rangeEnd < m_mergeGap))
+        {
+            m_rangeEnd = offset + size;
+            return;
+        }
+
+        if (m_bInRange)
+        {
+            StoreRange();
+        }
+
+        m_bInRange = true;
+        m_rangeStart = offset;
+        m_rangeEnd = offset + size;
+    }
+
+    //===============================================================================================
+    /// Stores the current range.
+    //===============================================================================================
+    inline void StoreRange()
+    {
+        m_offsets.push_back(m_rangeStart);
+        m_sizes.push_back(m_rangeEnd - m_rangeStart);
+        m_totalBytes += m_rangeEnd - m_rangeStart;
+    }
+
+    /// receives the offset of each range
+    std::vector<size_t>& m_offsets;
+
+    /// receives the size of each range
+    std::vector<size_t>& m_sizes;
+
+    /// ranges separated by fewer unchanged bytes than this are merged
+    size_t m_mergeGap;
+
+    /// true if a range has been started, but not stored
+    bool m_bInRange;
+
+    /// the offset of the current range
+    size_t m_rangeStart;
+
+    /// the offset just after the last differing byte in the current range
+    size_t m_rangeEnd;
+
+    /// the total size of the stored ranges
+    size_t m_totalBytes;
+};
+
+//===============================================================================================
+/// Builds the mask of differing bytes by comparing one byte at a time.
+/// Used for the end of the buffers, which may be shorter than a block.
+/// \param[in] pBase the original data
+/// \param[in] pDiff the modified data
+/// \param[in] numBytes the number of bytes to compare; at most 64
+/// \return one bit per byte, set if the byte differs
+//===============================================================================================
+static inline DeltaMask CompareBytes(const char* pBase, const char* pDiff, size_t numBytes)
+{
+    DeltaMask mask = 0;
+
+    for (size_t i = 0; i < numBytes; ++i)
+    {
+        if (pBase[i] != pDiff[i])
+        {
+            mask |= (DeltaMask)1 << i;
+        }
+    }
+
+    return mask;
+}
+
+//===============================================================================================
+/// Scans whole blocks 8 bytes at a time, on CPUs without SSE2.
+/// \param[in] pBase the original data
+/// \param[in] pDiff the modified data
+/// \param[in] numBlocks the number of 64 byte blocks to scan
+/// \param[in,out] builder receives the changed bytes
+//===============================================================================================
+static void ScanBlocksPortable(const char* pBase, const char* pDiff, size_t numBlocks, ChangedRangeBuilder& builder)
+{
+    for (size_t block = 0; block < numBlocks; ++block)
+    {
+        size_t offset = block * DELTA_BLOCK_SIZE;
+        DeltaMask mask = 0;
+
+        for (size_t word = 0; word < DELTA_BLOCK_SIZE; word += sizeof(unsigned long long))
+        {
+            // memcpy, since the buffers may not be aligned
+            unsigned long long baseWord;
+            unsigned long long diffWord;
+            memcpy(&baseWord, &pBase[offset + word], sizeof(baseWord));
+            memcpy(&diffWord, &pDiff[offset + word], sizeof(diffWord));
+
+            if (baseWord != diffWord)
+            {
+                mask |= CompareBytes(&pBase[offset + word], &pDiff[offset + word], sizeof(unsigned long long)) << word;
+            }
+        }
+
+        if (mask != 0)
+        {
+            builder.AddBlock(offset, mask);
+        }
+    }
+}
+
+#ifdef BUFFER_DELTA_X86
+
+//===============================================================================================
+/// Scans whole blocks as four 16 byte SSE2 comparisons.
+/// \param[in] pBase the original data
+/// \param[in] pDiff the modified data
+/// \param[in] numBlocks the number of 64 byte blocks to scan
+/// \param[in,out] builder receives the changed bytes
+//===============================================================================================
+BUFFER_DELTA_TARGET("sse2")
+static void ScanBlocksSSE2(const char* pBase, const char* pDiff, size_t numBlocks, ChangedRangeBuilder& builder)
+{
+    for (size_t block = 0; block < numBlocks; ++block)
+    {
+        size_t offset = block * DELTA_BLOCK_SIZE;
+        const __m128i* pBase128 = (const __m128i*)&pBase[offset];
+        const __m128i* pDiff128 = (const __m128i*)&pDiff[offset];
+
+        __m128i eq0 = _mm_cmpeq_epi8(_mm_loadu_si128(pBase128 + 0), _mm_loadu_si128(pDiff128 + 0));
+        __m128i eq1 = _mm_cmpeq_epi8(_mm_loadu_si128(pBase128 + 1), _mm_loadu_si128(pDiff128 + 1));
+        __m128i eq2 = _mm_cmpeq_epi8(_mm_loadu_si128(pBase128 + 2), _mm_loadu_si128(pDiff128 + 2));
+        __m128i eq3 = _mm_cmpeq_epi8(_mm_loadu_si128(pBase128 + 3), _mm_loadu_si128(pDiff128 + 3));
+
+        // skip the common case of an unchanged block without building the full mask
+        __m128i all = _mm_and_si128(_mm_and_si128(eq0, eq1), _mm_and_si128(eq2, eq3));
+
+        if (_mm_movemask_epi8(all) == 0xFFFF)
+        {
+            continue;
+        }
+
+        DeltaMask equalMask = (DeltaMask)(unsigned int)_mm_movemask_epi8(eq0) |
+                              ((DeltaMask)(unsigned int)_mm_movemask_epi8(eq1) << 16) |
+                              ((DeltaMask)(unsigned int)_mm_movemask_epi8(eq2) << 32) |
+                              ((DeltaMask)(unsigned int)_mm_movemask_epi8(eq3) << 48);
+
+        builder.AddBlock(offset, ~equalMask);
+    }
+}
+
+//===============================================================================================
+/// Scans whole blocks as two 32 byte AVX2 comparisons.
+/// \param[in] pBase the original data
+/// \param[in] pDiff the modified data
+/// \param[in] numBlocks the number of 64 byte blocks to scan
+/// \param[in,out] builder receives the changed bytes
+//===============================================================================================
+BUFFER_DELTA_TARGET("avx2")
+static void ScanBlocksAVX2(const char* pBase, const char* pDiff, size_t numBlocks, ChangedRangeBuilder& builder)
+{
+    for (size_t block = 0; block < numBlocks; ++block)
+    {
+        size_t offset = block * DELTA_BLOCK_SIZE;
+        const __m256i* pBase256 = (const __m256i*)&pBase[offset];
+        const __m256i* pDiff256 = (const __m256i*)&pDiff[offset];
+
+        __m256i eq0 = _mm256_cmpeq_epi8(_mm256_loadu_si256(pBase256 + 0), _mm256_loadu_si256(pDiff256 + 0));
+        __m256i eq1 = _mm256_cmpeq_epi8(_mm256_loadu_si256(pBase256 + 1), _mm256_loadu_si256(pDiff256 + 1));
+
+        // skip the common case of an unchanged block without building the full mask
+        if (_mm256_movemask_epi8(_mm256_and_si256(eq0, eq1)) == -1)
+        {
+            continue;
+        }
+
+        DeltaMask equalMask = (DeltaMask)(unsigned int)_mm256_movemask_epi8(eq0) |
+                              ((DeltaMask)(unsigned int)_mm256_movemask_epi8(eq1) << 32);
+
+        builder.AddBlock(offset, ~equalMask);
+    }
+}
+
+//===============================================================================================
+/// Checks whether the CPU and OS support AVX2.
+/// \return true if AVX2 can be used
+//===============================================================================================
+static bool IsAVX2Supported()
+{
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+
+    if (info[0] < 7)
+    {
+        return false;
+    }
+
+    // the OS must save the YMM registers, as well as the CPU supporting AVX
+    __cpuid(info, 1);
+    bool bOSXSave = (info[2] & (1 << 27)) != 0;
+    bool bAVX = (info[2] & (1 << 28)) != 0;
+
+    if (!bOSXSave || !bAVX || (_xgetbv(0) & 0x6) != 0x6)
+    {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+//===============================================================================================
+/// Checks whether the CPU supports SSE2.
+/// \return true if SSE2 can be used
+//===============================================================================================
+static bool IsSSE2Supported()
+{
+#if defined(_M_X64) || defined(__x86_64__)
+    // every 64 bit x86 CPU has SSE2
+    return true;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2") != 0;
+#endif
+}
+
+#endif // BUFFER_DELTA_X86
+
+/// The signature of the functions that scan whole blocks.
+typedef void (*ScanBlocksFunction)(const char* pBase, const char* pDiff, size_t numBlocks, ChangedRangeBuilder& builder);
+
+//===============================================================================================
+/// Chooses the fastest block scanner that the CPU supports.
+/// \return the block scanner
+//===============================================================================================
+static ScanBlocksFunction SelectScanBlocksFunction()
+{
+#ifdef BUFFER_DELTA_X86
+
+    if (IsAVX2Supported())
+    {
+        return ScanBlocksAVX2;
+    }
+
+    if (IsSSE2Supported())
+    {
+        return ScanBlocksSSE2;
+    }
+
+#endif // BUFFER_DELTA_X86
+
+    return ScanBlocksPortable;
+}
+
+/// The block scanner used by every BufferDelta.
+static ScanBlocksFunction s_scanBlocks = SelectScanBlocksFunction();
+
+//===============================================================================================
+bool BufferDelta::SetScanner(BufferDeltaScanner scanner)
+{
+    ScanBlocksFunction scanBlocks = NULL;
+
+    switch (scanner)
+    {
+        case BUFFER_DELTA_SCANNER_BEST:
+        {
+            scanBlocks = SelectScanBlocksFunction();
+            break;
+        }
+
+#ifdef BUFFER_DELTA_X86
+
+        case BUFFER_DELTA_SCANNER_AVX2:
+        {
+            scanBlocks = IsAVX2Supported() ? ScanBlocksAVX2 : NULL;
+            break;
+        }
+
+        case BUFFER_DELTA_SCANNER_SSE2:
+        {
+            scanBlocks = IsSSE2Supported() ? ScanBlocksSSE2 : NULL;
+            break;
+        }
+
+#endif // BUFFER_DELTA_X86
+
+        case BUFFER_DELTA_SCANNER_PORTABLE:
+        {
+            scanBlocks = ScanBlocksPortable;
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    if (scanBlocks == NULL)
+    {
+        return false;
+    }
+
+    s_scanBlocks = scanBlocks;
+    return true;
+}
+
 //===============================================================================================
 BufferDelta::BufferDelta(char* baseBuffer, char* diffBuffer, size_t numBytes)
 {
@@ -22,6 +538,7 @@ BufferDelta::BufferDelta(char* baseBuffer, char* diffBuffer, size_t numBytes)
 
 #ifndef USE_VECTOR_FOR_DATA
     m_pDiffs = NULL;
+    m_diffsCapacity = 0;
 #endif
 
     CalculateDelta(baseBuffer, diffBuffer, numBytes);
@@ -32,6 +549,7 @@ BufferDelta::BufferDelta(void)
 {
 #ifndef USE_VECTOR_FOR_DATA
     m_pDiffs = NULL;
+    m_diffsCapacity = 0;
 #endif
 #if defined(VERIFY_DELTA_RESULTS) || !defined(APPLY_DELTA)
     m_copiedDiffBuffer = NULL;
@@ -42,6 +560,17 @@ BufferDelta::BufferDelta(void)
 BufferDelta::~BufferDelta(void)
 {
     Clear();
+
+#ifndef USE_VECTOR_FOR_DATA
+
+    if (m_pDiffs != NULL)
+    {
+        delete [] m_pDiffs;
+        m_pDiffs = NULL;
+        m_diffsCapacity = 0;
+    }
+
+#endif
 }
 
 void BufferDelta::Clear()
@@ -56,15 +585,7 @@ void BufferDelta::Clear()
 
 #endif // defined(VERIFY_DELTA_RESULTS) || !defined(APPLY_DELTA)
 
-#ifndef USE_VECTOR_FOR_DATA
-
-    if (m_pDiffs != NULL)
-    {
-        delete [] m_pDiffs;
-        m_pDiffs = NULL;
-    }
-
-#else
+#ifdef USE_VECTOR_FOR_DATA
     m_data.clear();
 #endif
 
@@ -73,7 +594,50 @@ void BufferDelta::Clear()
 }
 
 //===============================================================================================
-void BufferDelta::CalculateDelta(const char* baseBuffer, const char* diffBuffer, const size_t numBytes)
+char* BufferDelta::ReserveDiffs(size_t numBytes)
+{
+#ifdef USE_VECTOR_FOR_DATA
+    m_data.resize(numBytes);
+    return (numBytes > 0) ? &m_data[0] : NULL;
+#else
+
+    if (numBytes > m_diffsCapacity)
+    {
+        if (m_pDiffs != NULL)
+        {
+            delete [] m_pDiffs;
+        }
+
+        m_pDiffs = new char[numBytes];
+        m_diffsCapacity = numBytes;
+    }
+
+    return m_pDiffs;
+#endif // USE_VECTOR_FOR_DATA
+}
+
+//===============================================================================================
+size_t BufferDelta::FindChangedRanges(const char* baseBuffer, const char* diffBuffer, size_t numBytes, size_t mergeGap)
+{
+    ChangedRangeBuilder builder(m_offset, m_size, mergeGap);
+
+    size_t numBlocks = numBytes / DELTA_BLOCK_SIZE;
+    s_scanBlocks(baseBuffer, diffBuffer, numBlocks, builder);
+
+    // the end of the buffers may not fill a whole block
+    size_t tailOffset = numBlocks * DELTA_BLOCK_SIZE;
+    DeltaMask tailMask = CompareBytes(&baseBuffer[tailOffset], &diffBuffer[tailOffset], numBytes - tailOffset);
+
+    if (tailMask != 0)
+    {
+        builder.AddBlock(tailOffset, tailMask);
+    }
+
+    return builder.Finish();
+}
+
+//===============================================================================================
+void BufferDelta::CalculateDelta(const char* baseBuffer, const char* diffBuffer, const size_t numBytes, const size_t mergeGap)
 {
     Clear();
 
@@ -85,246 +649,28 @@ void BufferDelta::CalculateDelta(const char* baseBuffer, const char* diffBuffer,
         m_offset.push_back(0);
         m_size.push_back(numBytes);
 
-#ifdef USE_VECTOR_FOR_DATA
-        m_data.reserve(numBytes);
-
-        const char* pDiff = diffBuffer;
-
-        for (size_t i = 0; i < numBytes; ++i)
-        {
-            m_data.push_back(*pDiff++);
-        }
-
-#else
-        m_pDiffs = new char[numBytes];
-        memcpy_s(m_pDiffs, numBytes, diffBuffer, numBytes);
-#endif // USE_VECTOR_FOR_DATA
+        char* pDiffs = ReserveDiffs(numBytes);
+        memcpy(pDiffs, diffBuffer, numBytes);
     }
     else
     {
-#ifdef USE_VECTOR_FOR_DATA
-
-        // loop over the entire buffer to find deltas
-        for (size_t i = 0; i < numBytes; ++i)
-        {
-            // find a location in the buffer where the data does not match
-            if (baseBuffer[i] != diffBuffer[i])
-            {
-                // store the current location as an offset
-                size_t offset = i;
-                m_offset.push_back(offset);
-
-                // from this offset, continue incrementing i and storing the data
-                // until a location is found where the data is same or the end of the buffer is reached.
-                // That marks the end of the current delta, but the outer loop will continue to check for
-                // additional changes.
-                while (i < numBytes &&
-                       baseBuffer[i] != diffBuffer[i])
-                {
-                    m_data.push_back(diffBuffer[i]);
-                    ++i;
-                }
-
-                // now store the number of bytes that were different
-                m_size.push_back(i - offset);
-            }
-        }
-
-#else
-        size_t totalBytes = 0;
-
-        const char* pBase = baseBuffer;
-        const char* pDiff = diffBuffer;
-
-        //---------------------------------
-        // single byte, multi delta approach
-
-        //// first, loop over the entire buffer to find deltas
-        //for (size_t i = 0; i < numBytes; ++i)
-        //{
-        //   // find a location in the buffer where the data does not match
-        //   if (*pBase != *pDiff)
-        //   {
-        //      // store the current location as an offset
-        //      size_t offset = i;
-        //      m_offset.push_back(offset);
-
-        //      // from this offset, continue incrementing i and storing the data
-        //      // until a location is found where the data is the same or the end of the buffer is reached.
-        //      // That marks the end of the current delta, but the outer loop will continue to check for
-        //      // additional changes.
-        //      while (i < numBytes &&
-        //             *pBase != *pDiff)
-        //      {
-        //         ++i;
-        //         ++pBase;
-        //         ++pDiff;
-        //      }
-
-        //      // now store the number of bytes that were different
-        //      m_size.push_back(i - offset);
-        //      totalBytes += (i - offset);
-        //   }
-
-        //   ++pBase;
-        //   ++pDiff;
-        //}
-
-        //// now, use size and offset information to copy data
-        //m_pDiffs = new char[totalBytes];
-
-        //size_t offset = 0;
-        //size_t size = 1;
-        //for (size_t i = 0; i < m_size.size(); ++i)
-        //{
-        //   size = m_size[i];
-        //   memcpy_s(&m_pDiffs[offset], size, &diffBuffer[m_offset[i]], size);
-        //   offset += size;
-        //}
-
-        //-------------------
-        // multi-byte, multi delta approach
-
-        const unsigned int* pUIBase = (const unsigned int*) pBase;
-        const unsigned int* pUIDiff = (const unsigned int*) pDiff;
-
-        // first, loop over the entire buffer to find deltas
-        for (size_t i = 0; i < numBytes; ++i)
-        {
-            if (numBytes - i < sizeof(unsigned int))
-            {
-                // less than sizeof(unsigned int) bytes left, so use byte-wise comparison
-
-                // find a location in the buffer where the data does not match
-                if (baseBuffer[i] != diffBuffer[i])
-                {
-                    // store the current location as an offset
-                    size_t offset = i;
-                    m_offset.push_back(offset);
-
-                    // from this offset, continue incrementing i and storing the data
-                    // until a location is found where the data is the same or the end of the buffer is reached.
-                    // That marks the end of the current delta, but the outer loop will continue to check for
-                    // additional changes.
-                    while (i < numBytes &&
-                           baseBuffer[i] != diffBuffer[i])
-                    {
-                        ++i;
-                    }
-
-                    // now store the number of bytes that were different
-                    m_size.push_back(i - offset);
-                    totalBytes += (i - offset);
-                }
-            }
-            else
-            {
-                // find a location in the buffer where the data does not match
-                if (*pUIBase != *pUIDiff)
-                {
-                    // store the current location as an offset
-                    size_t offset = i;
-                    m_offset.push_back(offset);
-
-                    // from this offset, continue incrementing i and storing the data
-                    // until a location is found where the data is the same or the end of the buffer is reached.
-                    // That marks the end of the current delta, but the outer loop will continue to check for
-                    // additional changes.
-                    while (numBytes - i >= sizeof(unsigned int) &&
-                           *pUIBase != *pUIDiff)
-                    {
-                        i += sizeof(unsigned int);
-                        ++pUIBase;
-                        ++pDiff;
-                    }
-
-                    // now store the number of bytes that were different
-                    m_size.push_back(i - offset);
-                    totalBytes += (i - offset);
-                }
-
-                ++pUIBase;
-                ++pUIDiff;
-                i += sizeof(unsigned int) - 1; // one less since the loop will also increment by 1
-            }
-        }
+        // first, find all of the changed ranges, so that the changed data can be copied into storage of the right size
+        size_t totalBytes = FindChangedRanges(baseBuffer, diffBuffer, numBytes, mergeGap);
 
         // now, use size and offset information to copy data
-        m_pDiffs = new char[totalBytes];
+        char* pDiffs = ReserveDiffs(totalBytes);
 
         size_t offset = 0;
-        size_t size = 1;
 
         for (size_t i = 0; i < m_size.size(); ++i)
         {
-            size = m_size[i];
-            memcpy_s(&m_pDiffs[offset], size, &diffBuffer[m_offset[i]], size);
-            offset += size;
+            memcpy(&pDiffs[offset], &diffBuffer[m_offset[i]], m_size[i]);
+            offset += m_size[i];
         }
-
-        //-------------------
-        // single delta approach
-
-        //// first, find initial delta
-        //size_t i = 0;
-        //for (i = 0; i < numBytes; ++i)
-        //{
-        //   // find a location in the buffer where the data does not match
-        //   if (*pBase != *pDiff)
-        //   {
-        //      // store the current location as an offset
-        //      size_t offset = i;
-        //      m_offset.push_back(offset);
-        //      break;
-        //  }
-
-        //   ++pBase;
-        //   ++pDiff;
-        //}
-
-        //if (i == numBytes)
-        //{
-        //   // there was no delta
-        //}
-        //else
-        //{
-        //   // second, find final delta (from the end of the buffer
-        //   pBase = &baseBuffer[numBytes-1];
-        //   pDiff = &diffBuffer[numBytes-1];
-
-        //   for (size_t i = numBytes; i >0; --i)
-        //   {
-        //      // find a location in the buffer where the data does not match
-        //      if (*pBase != *pDiff)
-        //      {
-        //         // calculate the size of the delta
-        //         size_t endOffset = i;
-        //         totalBytes = endOffset - m_offset[0] + 1;
-        //         m_size.push_back(totalBytes);
-        //         Log( logERROR, "Buffer delta starts at %d of size %d.\n", m_offset[0], totalBytes);
-        //         break;
-        //     }
-
-        //      --pBase;
-        //      --pDiff;
-        //   }
-
-        //   // now, use size and offset information to copy data
-        //   m_pDiffs = new char[totalBytes];
-
-        //   size_t offset = 0;
-        //   size_t size = 1;
-        //   for (size_t i = 0; i < m_size.size(); ++i)
-        //   {
-        //      size = m_size[i];
-        //      memcpy_s(&m_pDiffs[offset], size, &diffBuffer[m_offset[i]], size);
-        //      offset += size;
-        //   }
-        //}
-
-#endif // USE_VECTOR_FOR_DATA
     }
 
+#else
+    (void)mergeGap;
 #endif // APPLY_DELTA
 
 #if defined(VERIFY_DELTA_RESULTS) || !defined(APPLY_DELTA)
@@ -380,4 +726,4 @@ void BufferDelta::ApplyDelta(char* pBuffer)
     }
 
 #endif //VERIFY_DELTA_RESULTS
-}
\ No newline at end of file
+}
@@ -16,6 +16,20 @@
 
 //#define USE_VECTOR_FOR_DATA
 
+/// Changed ranges that are separated by fewer than this many unchanged bytes are stored
+/// as a single range. Each range costs an offset and a size, so merging ranges that are
+/// closer than that saves space, and makes ApplyDelta do fewer, larger copies.
+#define BUFFER_DELTA_DEFAULT_MERGE_GAP (2 * sizeof(size_t))
+
+/// The ways that BufferDelta can scan the buffers for changed bytes.
+enum BufferDeltaScanner
+{
+    BUFFER_DELTA_SCANNER_BEST,      ///< the fastest one that the CPU supports
+    BUFFER_DELTA_SCANNER_AVX2,      ///< two 32 byte AVX2 comparisons per 64 byte block
+    BUFFER_DELTA_SCANNER_SSE2,      ///< four 16 byte SSE2 comparisons per 64 byte block
+    BUFFER_DELTA_SCANNER_PORTABLE,  ///< 8 bytes at a time, without vector instructions
+};
+
 /// A class that can calculate, store, and reapply a delta between
 /// two buffers of equal size.
 class BufferDelta
@@ -46,8 +60,9 @@ public:
     /// \param[in] baseBuffer Original buffer data
     /// \param[in] diffBuffer Modified buffer
     /// \param[in] numBytes size of the buffer in bytes
+    /// \param[in] mergeGap changed ranges separated by fewer unchanged bytes than this are stored as one range
     //===============================================================================================
-    void CalculateDelta(const char* baseBuffer, const char* diffBuffer, const size_t numBytes);
+    void CalculateDelta(const char* baseBuffer, const char* diffBuffer, const size_t numBytes, const size_t mergeGap = BUFFER_DELTA_DEFAULT_MERGE_GAP);
 
     //===============================================================================================
     /// Apply deltas to a buffer.
@@ -56,13 +71,40 @@ public:
     //===============================================================================================
     void ApplyDelta(char* pBuffer);
 
+    //===============================================================================================
+    /// Chooses how every BufferDelta scans for changed bytes. The fastest scanner that the CPU
+    /// supports is used by default; the others are for comparing them. Must not be called while
+    /// any delta is being calculated.
+    /// \param[in] scanner the scanner to use
+    /// \return false if the CPU doesn't support the scanner, in which case it isn't changed
+    //===============================================================================================
+    static bool SetScanner(BufferDeltaScanner scanner);
+
 private:
 
     //===============================================================================================
-    /// Clears the data inside this delta
+    /// Clears the data inside this delta. The storage for the changed data is kept for reuse.
     //===============================================================================================
     void Clear();
 
+    //===============================================================================================
+    /// Finds the ranges of bytes that differ between two buffers, and stores them in m_offset and
+    /// m_size. Uses the widest vector instructions that the CPU supports.
+    /// \param[in] baseBuffer Original buffer data
+    /// \param[in] diffBuffer Modified buffer
+    /// \param[in] numBytes size of the buffers in bytes
+    /// \param[in] mergeGap changed ranges separated by fewer unchanged bytes than this are stored as one range
+    /// \return the total number of bytes in the ranges
+    //===============================================================================================
+    size_t FindChangedRanges(const char* baseBuffer, const char* diffBuffer, size_t numBytes, size_t mergeGap);
+
+    //===============================================================================================
+    /// Makes sure the storage for the changed data can hold the given number of bytes.
+    /// \param[in] numBytes the number of bytes of changed data
+    /// \return a pointer to the storage
+    //===============================================================================================
+    char* ReserveDiffs(size_t numBytes);
+
 #if defined(VERIFY_DELTA_RESULTS) || !defined(APPLY_DELTA)
     /// A copy of the buffer after the app has made changes to it.
     char* m_copiedDiffBuffer;
@@ -77,6 +119,9 @@ private:
 #else
     /// manually managed array of diffs
     char* m_pDiffs;
+
+    /// the number of bytes allocated for m_pDiffs, which is reused by each delta calculation
+    size_t m_diffsCapacity;
 #endif // USE_VECTOR_FOR_DATA
 
     /// list of offsets to chucks
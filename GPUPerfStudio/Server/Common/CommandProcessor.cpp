@@ -510,6 +510,27 @@ bool CommandResponse::IsActive()
     return false;
 }
 
+//--------------------------------------------------------------------------
+/// Sends a response made of several null-terminated strings, one after the other
+/// \param requestID the request to respond to
+/// \param cpsMimeType the mimetype to send the response as
+/// \param cpsSegments the strings that make up the response
+/// \param uNumSegments the number of strings
+/// \param bStreaming indicates that the response is to a streaming request
+/// \return true if the response was sent; false otherwise
+//--------------------------------------------------------------------------
+static bool SendTextSegments(CommunicationID requestID, const char* cpsMimeType, const char* const* cpsSegments, unsigned int uNumSegments, bool bStreaming)
+{
+    std::vector< unsigned int > segmentSizes(uNumSegments);
+
+    for (unsigned int i = 0; i < uNumSegments; i++)
+    {
+        segmentSizes[i] = (unsigned int) strlen(cpsSegments[i]);
+    }
+
+    return SendResponseSegments(requestID, cpsMimeType, cpsSegments, &segmentSizes[0], uNumSegments, bStreaming);
+}
+
 //void CommandResponse::SendZero()
 //{
 //   Send("0", 1);
@@ -538,32 +559,24 @@ void CommandResponse::Send(const char* pData, unsigned int uBytes)
             }
         }
 
-        // string which is used to add tags around XML and HTML responses
-        string strResponse;
-
         bool bResult = false;
 
         switch (m_eContentType)
         {
             case CONTENT_XML:
             {
-                strResponse += XMLHeader().asCharArray();
-                strResponse += "<XML src='";
-                strResponse += GetURL();
-                strResponse += "'>";
-                strResponse += (char*) pData;
-                strResponse += "</XML>";
-                bResult = SendResponse(*iRequestID, "text/xml", strResponse.c_str(), (unsigned int) strResponse.size(), m_bStreamingEnabled);
+                // the tags are sent as separate pieces around the data, rather than copying everything into one string first
+                gtASCIIString strXMLHeader = XMLHeader();
+                const char* cpsSegments[] = { strXMLHeader.asCharArray(), "<XML src='", GetURL(), "'>", (char*) pData, "</XML>" };
+                bResult = SendTextSegments(*iRequestID, "text/xml", cpsSegments, sizeof(cpsSegments) / sizeof(cpsSegments[0]), m_bStreamingEnabled);
                 m_eResponseState = SENT_RESPONSE;
                 break;
             }
 
             case CONTENT_HTML:
             {
-                strResponse += "<HTML>";
-                strResponse += (char*) pData;
-                strResponse += "</HTML>";
-                bResult = SendResponse(*iRequestID, "text/html", strResponse.c_str(), (unsigned int) strResponse.size(), m_bStreamingEnabled);
+                const char* cpsSegments[] = { "<HTML>", (char*) pData, "</HTML>" };
+                bResult = SendTextSegments(*iRequestID, "text/html", cpsSegments, sizeof(cpsSegments) / sizeof(cpsSegments[0]), m_bStreamingEnabled);
                 m_eResponseState = SENT_RESPONSE;
                 break;
             }
@@ -11,15 +11,25 @@
 #include "ICommunication.h"
 #include "ICommunication_Impl.h"
 #include "HTTPRequest.h"
+#include "ResponseCompression.h"
 #include "SharedMemoryManager.h"
 #include "Logger.h"
 #include "timer.h"
+#include <algorithm>
 #include <unordered_map>
+#include <vector>
 #include "parser.h"
 #include "defines.h"
 #include "misc.h"
 #include "mymutex.h"
 #include "NamedSemaphore.h"
+#include "SharedGlobal.h"
+
+#ifdef _LINUX
+    #include <atomic>
+    #include <thread>
+    #include "NetConnectionManager.h"
+#endif
 
 typedef bool (*ProcessRequest_type)(CommunicationID);
 ProcessRequest_type g_processRequest = NULL;
@@ -43,17 +53,31 @@ public:
         m_bStreamingEnabled = false;
         m_dwMaxStreamsPerSecond = COMM_MAX_STREAM_RATE;
         m_dwLastSent = 0;
+        m_uAcceptedEncodings = 0;
+#ifdef _LINUX
+        m_pNetRequest = NULL;
+#endif
     }
 
     /// Destructor
     ~Response()
     {
         SAFE_DELETE(client_socket);
+#ifdef _LINUX
+        SAFE_DELETE(m_pNetRequest);
+#endif
     }
 
     /// The underlying socket which was received on
     NetSocket* client_socket;
 
+#ifdef _LINUX
+    /// The request, if it was received on a keep-alive connection by g_pNetConnectionManager
+    /// rather than from the web server; the response is then queued on that connection
+    /// instead of being sent over client_socket
+    NetRequest* m_pNetRequest;
+#endif
+
     /// Indicates whether or not to tell the client to cache the response
     bool m_bSendNoCache;
 
@@ -70,6 +94,9 @@ public:
 
     /// The time that the last response was sent at
     unsigned long m_dwLastSent;
+
+    /// The HTTP_CONTENT_ENCODING flags of the encodings that the client accepts
+    unsigned int m_uAcceptedEncodings;
 };
 
 
@@ -118,23 +145,76 @@ static mutex s_mutex;
 // timer for rate-limiting streaming responses
 static Timer g_streamTimer;
 
+// A contiguous piece of response data, so that a response made up of several
+// pieces can be sent with a single gather send, without first copying the
+// pieces into a single buffer
+typedef NetSocket::SendBuffer ResponseSegment;
+
+// A chunk of memory that BufferResponse copies data into
+struct BufferedResponseChunk
+{
+    char* pData;            ///< the chunk's storage
+    unsigned int uSize;     ///< the number of bytes used
+    unsigned int uCapacity; ///< the number of bytes allocated
+};
+
+// the size of the first chunk of a buffered response; each further chunk is
+// at least as large as all of the previous ones, so buffering a response
+// takes linear time and only a logarithmic number of chunks are sent
+static const unsigned int s_uMinBufferedResponseChunkSize = 64 * 1024;
+
 // static data for buffering a response
-static char* g_pBufferedResponse;
+static std::vector< BufferedResponseChunk > g_bufferedResponseChunks;
 static unsigned int g_uBufferedResponseSize;
 
 // shared memory name;
 static char g_strSharedMemoryName[ PS_MAX_PATH ];
 
+#ifdef _LINUX
+// how long the keep-alive connection thread waits for activity before it
+// checks whether it should stop
+static const int s_nNetConnectionPollTimeoutMs = 100;
+
+// accepts keep-alive connections made straight to this process, if
+// OptionKeepAlivePort is set, and services them from g_netConnectionThread
+static NetConnectionManager* g_pNetConnectionManager = NULL;
+static std::thread g_netConnectionThread;
+static std::atomic<bool> g_bStopNetConnectionThread(false);
+
+// the requests received by g_pNetConnectionManager that haven't been
+// responded to yet, and the ones of those that haven't been processed yet;
+// both are protected by s_mutex
+typedef std::unordered_map< CommunicationID, NetRequest > NetRequestMap;
+static NetRequestMap g_netRequestMap;
+static std::vector< CommunicationID > g_pendingNetRequests;
+#endif
+
 //=============================================================================
 //     "private" methods - only used in this file
 //=============================================================================
 void CloseConnection(Response& rResponse);
+void GenerateStatusLine(Response& rResponse, const char* pStatus, char* pOut, DWORD dwBufferSize);
 void GenerateHeader(Response& rResponse, char* pOut, DWORD dwBufferSize);
+bool IsNetResponse(const Response& rResponse);
+bool SendRaw(Response& rResponse, const ResponseSegment* pBuffers, unsigned int uNumBuffers);
 bool Send(Response& rResponse, const char* mime, const char* pData, unsigned long dwSize);
+bool SendSegments(Response& rResponse, const char* mime, const ResponseSegment* pSegments, unsigned int uNumSegments);
+bool SendFile(Response& rResponse, const char* mime, FILE* pFile, unsigned long dwFileSize);
+bool SendHeaderAndData(Response& rResponse, const char* mime, unsigned long dwSize, const ResponseSegment* pSegments, unsigned int uNumSegments, FILE* pFile);
+bool SendBinarySegments(CommunicationID& requestID, const ResponseSegment* pSegments, unsigned int uNumSegments);
+bool SendMimeSegments(CommunicationID& requestID, const char* cpMimeType, const ResponseSegment* pSegments, unsigned int uNumSegments);
+void ClearBufferedResponse();
+unsigned int GetAcceptedEncodings(CommunicationID requestID);
 int FindMimeType(const char* filename);
-bool OutputHTTPError(NetSocket* socket, int nErrorCode);
+bool OutputHTTPError(Response& rResponse, int nErrorCode);
 bool MakeResponse(CommunicationID requestID, Response** ppResponse);
 void DestroyResponse(CommunicationID& rRequestID, Response** ppResponse);
+#ifdef _LINUX
+bool QueueNetResponseData(Response& rResponse, const ResponseSegment* pBuffers, unsigned int uNumBuffers, FILE* pFile, unsigned long dwFileSize, bool bFinished);
+void StartNetConnectionManager();
+void StopNetConnectionManager();
+HTTPRequestHeader* GetPendingNetRequest(bool bRemove, CommunicationID& rRequestID);
+#endif
 
 //--------------------------------------------------------------
 /** Performs linear search through mimetypes array looking for
@@ -160,12 +240,33 @@ int FindMimeType(const char* filename)
     return (0);   // return default mimetype  'text/plain'
 }
 
+//-----------------------------------------------------------------------------
+/// Generates the status line of an HTTP header. Responses on keep-alive
+/// connections also say whether the connection stays open after them.
+//-----------------------------------------------------------------------------
+void GenerateStatusLine(Response& rResponse, const char* pStatus, char* pOut, DWORD dwBufferSize)
+{
+#ifdef _LINUX
+
+    if (rResponse.m_pNetRequest != NULL)
+    {
+        sprintf_s(pOut, dwBufferSize, "HTTP/1.1 %s\r\nConnection: %s\r\n", pStatus, rResponse.m_pNetRequest->mbKeepAlive ? "keep-alive" : "close");
+        return;
+    }
+
+#else
+    PS_UNREFERENCED_PARAMETER(rResponse);
+#endif
+
+    sprintf_s(pOut, dwBufferSize, "HTTP/1.0 %s\r\n", pStatus);
+}
+
 //-----------------------------------------------------------------------------
 /// Generates an HTTP header according to the options stored in the Response
 //-----------------------------------------------------------------------------
 void GenerateHeader(Response& rResponse, char* pOut, DWORD dwBufferSize)
 {
-    strcpy_s(pOut, dwBufferSize, "HTTP/1.0 200 OK\r\n");
+    GenerateStatusLine(rResponse, "200 OK", pOut, dwBufferSize);
 
     if (rResponse.m_bSendNoCache == true)
     {
@@ -190,6 +291,52 @@ void GenerateHeader(Response& rResponse, char* pOut, DWORD dwBufferSize)
 * \return true if the Response could be sent; false if there was an error*/
 //-----------------------------------------------------------------------------
 bool Send(Response& rResponse, const char* mime, const char* pData, unsigned long dwSize)
+{
+    ResponseSegment segment = { pData, dwSize };
+    return SendSegments(rResponse, mime, &segment, 1);
+}
+
+//-----------------------------------------------------------------------------
+/// SendSegments
+///
+/** Sends the specified pieces of data, one after the other, as a single
+* response of the specified mime type over the socket contained in the Response
+* \return true if the Response could be sent; false if there was an error*/
+//-----------------------------------------------------------------------------
+bool SendSegments(Response& rResponse, const char* mime, const ResponseSegment* pSegments, unsigned int uNumSegments)
+{
+    unsigned long dwSize = 0;
+
+    for (unsigned int i = 0; i < uNumSegments; i++)
+    {
+        dwSize += (unsigned long)pSegments[i].size;
+    }
+
+    return SendHeaderAndData(rResponse, mime, dwSize, pSegments, uNumSegments, NULL);
+}
+
+//-----------------------------------------------------------------------------
+/// SendFile
+///
+/** Sends the contents of an open file as a specified mime type over the
+* socket contained in the Response
+* \return true if the Response could be sent; false if there was an error*/
+//-----------------------------------------------------------------------------
+bool SendFile(Response& rResponse, const char* mime, FILE* pFile, unsigned long dwFileSize)
+{
+    return SendHeaderAndData(rResponse, mime, dwFileSize, NULL, 0, pFile);
+}
+
+//-----------------------------------------------------------------------------
+/// SendHeaderAndData
+///
+/** Sends the HTTP header followed by the data pieces and then the file, if
+* either are given. The header and the data pieces are sent with a single
+* gather send, and the file is sent straight from the OS file cache where
+* possible.
+* \return true if the Response could be sent; false if there was an error*/
+//-----------------------------------------------------------------------------
+bool SendHeaderAndData(Response& rResponse, const char* mime, unsigned long dwSize, const ResponseSegment* pSegments, unsigned int uNumSegments, FILE* pFile)
 {
     char sendbuffer[COMM_BUFFER_SIZE];
     sendbuffer[0] = 0;
@@ -206,6 +353,21 @@ bool Send(Response& rResponse, const char* mime, const char* pData, unsigned lon
         strncat_s(sendbuffer, COMM_BUFFER_SIZE, "--BoundaryString\r\n", COMM_BUFFER_SIZE);
     }
 
+    // multipart parts can't be given their own encoding, so only complete responses are compressed
+    std::vector< unsigned char > compressed;
+    ResponseSegment compressedSegment = { NULL, 0 };
+
+    if (rResponse.m_bStreamingEnabled == false &&
+        pFile == NULL &&
+        CompressResponse(rResponse.m_uAcceptedEncodings, mime, pSegments, uNumSegments, dwSize, compressed, sendbuffer, COMM_BUFFER_SIZE) == true)
+    {
+        compressedSegment.pData = &compressed[0];
+        compressedSegment.size = compressed.size();
+        pSegments = &compressedSegment;
+        uNumSegments = 1;
+        dwSize = (unsigned long)compressed.size();
+    }
+
     DWORD len = (DWORD)strlen(sendbuffer);
     sprintf_s(sendbuffer + len, COMM_BUFFER_SIZE - len, "Content-Type: %s\r\n"
               "Content-Length: %ld\r\n"
@@ -213,16 +375,37 @@ bool Send(Response& rResponse, const char* mime, const char* pData, unsigned lon
               mime,
               dwSize);
 
-    // send header
-    bool res = rResponse.client_socket->Send(sendbuffer, (DWORD)strlen(sendbuffer));
+    // send the header and data together
+    std::vector< ResponseSegment > buffers;
+    buffers.reserve(uNumSegments + 1);
 
-    if (res == true)
+    ResponseSegment header = { sendbuffer, strlen(sendbuffer) };
+    buffers.push_back(header);
+    buffers.insert(buffers.end(), pSegments, pSegments + uNumSegments);
+
+    bool res = false;
+
+#ifdef _LINUX
+
+    if (rResponse.m_pNetRequest != NULL)
     {
-        // if header could be sent
-        // send data
-        res = rResponse.client_socket->Send(pData, dwSize);
+        // the connection manager sends the data in place, and the file with sendfile;
+        // a streaming response isn't finished until the connection is closed
+        res = QueueNetResponseData(rResponse, &buffers[0], (unsigned int)buffers.size(), pFile, (pFile != NULL) ? dwSize : 0, rResponse.m_bStreamingEnabled == false);
     }
     else
+#endif
+    {
+        // if a file follows, let the header go out in the same packets as the start of the file
+        res = rResponse.client_socket->SendVector(&buffers[0], (int)buffers.size(), pFile != NULL);
+
+        if (res == true && pFile != NULL)
+        {
+            res = rResponse.client_socket->SendFile(pFile, dwSize);
+        }
+    }
+
+    if (res == false)
     {
         osSystemErrorCode systemLastError = osGetLastSystemError();
 
@@ -242,7 +425,7 @@ bool Send(Response& rResponse, const char* mime, const char* pData, unsigned lon
     }
 
     // if the response is not streaming,
-    // the connection should be closed
+    // the connection should be closed, unless it is kept alive by the connection manager
     // otherwise it should be left open
     if (rResponse.m_bStreamingEnabled == false)
     {
@@ -253,41 +436,90 @@ bool Send(Response& rResponse, const char* mime, const char* pData, unsigned lon
 }
 
 //-----------------------------------------------------------------------------
-/// Closes the connection that the specified Response uses
+/// Closes the connection that the specified Response uses. A keep-alive
+/// connection is only closed if the client asked for it to be, once the
+/// response has been sent; otherwise the response is just finished.
 //-----------------------------------------------------------------------------
 void CloseConnection(Response& rResponse)
 {
     rResponse.m_bNeedToSendHeader = true;
     rResponse.m_bStreamingEnabled = false;
+
+#ifdef _LINUX
+
+    if (rResponse.m_pNetRequest != NULL)
+    {
+        // does nothing if the response has already been finished
+        QueueNetResponseData(rResponse, NULL, 0, NULL, 0, true);
+        return;
+    }
+
+#endif
+
     rResponse.client_socket->close();
     rResponse.client_socket = 0;
 }
 
+//-----------------------------------------------------------------------------
+/// Indicates whether the specified Response is queued on a keep-alive
+/// connection by g_pNetConnectionManager, rather than sent over client_socket
+//-----------------------------------------------------------------------------
+bool IsNetResponse(const Response& rResponse)
+{
+#ifdef _LINUX
+    return (rResponse.m_pNetRequest != NULL);
+#else
+    PS_UNREFERENCED_PARAMETER(rResponse);
+    return false;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+/// Sends the specified pieces of data, one after the other, over the
+/// connection that the specified Response uses, without adding a header
+/// \return true if the data could be sent; false if there was an error
+//-----------------------------------------------------------------------------
+bool SendRaw(Response& rResponse, const ResponseSegment* pBuffers, unsigned int uNumBuffers)
+{
+#ifdef _LINUX
+
+    if (rResponse.m_pNetRequest != NULL)
+    {
+        return QueueNetResponseData(rResponse, pBuffers, uNumBuffers, NULL, 0, false);
+    }
+
+#endif
+
+    return rResponse.client_socket->SendVector(pBuffers, (int)uNumBuffers, false);
+}
+
 //-----------------------------------------------------------------------------
 /** Generates and sends the HTML needed to specify that a particular numeric
 * error has occurred. These error codes are well-defined
 * See http://www.w3.org/Protocols/rfc2616/rfc2616-sec10.html for status codes */
 //-----------------------------------------------------------------------------
-bool OutputHTTPError(NetSocket* socket, int nErrorCode)
+bool OutputHTTPError(Response& rResponse, int nErrorCode)
 {
     /// generate the error code html
-    static char headerBuffer[COMM_BUFFER_SIZE];
-    static char htmlBuffer[COMM_BUFFER_SIZE];
+    char statusBuffer[SMALL_BUFFER_SIZE];
+    char headerBuffer[COMM_BUFFER_SIZE];
+    char htmlBuffer[COMM_BUFFER_SIZE];
 
+    sprintf_s(statusBuffer, SMALL_BUFFER_SIZE, "%d", nErrorCode);
     sprintf_s(htmlBuffer, COMM_BUFFER_SIZE, "<html><body><h2>Error: %d</h2></body></html>", nErrorCode);
-    sprintf_s(headerBuffer, COMM_BUFFER_SIZE, "HTTP/1.0 %d\r\nContent-Type: text/html\r\nContent-Length: %zd\r\n\r\n", nErrorCode, strlen(htmlBuffer));
+    GenerateStatusLine(rResponse, statusBuffer, headerBuffer, COMM_BUFFER_SIZE);
+
+    DWORD len = (DWORD)strlen(headerBuffer);
+    sprintf_s(headerBuffer + len, COMM_BUFFER_SIZE - len, "Content-Type: text/html\r\nContent-Length: %zd\r\n\r\n", strlen(htmlBuffer));
 
-    bool nRes1;
-    bool nRes2;
-    nRes1 = socket->Send(headerBuffer, (DWORD)strlen(headerBuffer));
-    nRes2 = socket->Send(htmlBuffer, (DWORD)strlen(htmlBuffer));
+    ResponseSegment buffers[] = { { headerBuffer, strlen(headerBuffer) }, { htmlBuffer, strlen(htmlBuffer) } };
+    bool bRes = SendRaw(rResponse, buffers, sizeof(buffers) / sizeof(buffers[0]));
 
-    socket->close();
+    CloseConnection(rResponse);
 
-    if ((nRes1 == false) ||
-        (nRes2 == false))
+    if (bRes == false)
     {
-        Log(logERROR, "Failed to send HTTPError %d over socket %lu because of error %lu\n", nErrorCode, socket, osGetLastSystemError());
+        Log(logERROR, "Failed to send HTTPError %d because of error %lu\n", nErrorCode, osGetLastSystemError());
         return false;
     }
 
@@ -337,6 +569,19 @@ bool MakeResponse(CommunicationID requestID, Response** ppResponse)
     HTTPRequestHeader* pRequest = iterRequest->second;
     PsAssert(pRequest != NULL);
 
+    (*ppResponse)->m_uAcceptedEncodings = pRequest->GetAcceptedEncodings();
+
+#ifdef _LINUX
+    NetRequestMap::iterator iterNetRequest = g_netRequestMap.find(requestID);
+
+    if (iterNetRequest != g_netRequestMap.end())
+    {
+        // the response is queued on the keep-alive connection that the request came in on
+        (*ppResponse)->m_pNetRequest = new NetRequest(iterNetRequest->second);
+        g_netRequestMap.erase(iterNetRequest);
+    }
+    else
+#endif
     if (pRequest->GetReceivedOverSocket() == true)
     {
         (*ppResponse)->client_socket = pRequest->GetClientSocket();
@@ -358,7 +603,7 @@ bool MakeResponse(CommunicationID requestID, Response** ppResponse)
 #endif
     }
 
-    if ((*ppResponse)->client_socket == NULL)
+    if ((*ppResponse)->client_socket == NULL && IsNetResponse(**ppResponse) == false)
     {
         int Err = NetSocket::LastError();
         Log(logERROR, "Could not create socket: NetSocket failed with error: %ld\n", Err);
@@ -385,6 +630,16 @@ bool MakeResponse(CommunicationID requestID, Response** ppResponse)
         // set the response as streaming with the specified rate
         (*ppResponse)->m_bStreamingEnabled = true;
         (*ppResponse)->m_dwMaxStreamsPerSecond = uRate;
+
+#ifdef _LINUX
+
+        // a stream only ends when its connection is closed, so it can't be kept alive
+        if ((*ppResponse)->m_pNetRequest != NULL)
+        {
+            (*ppResponse)->m_pNetRequest->mbKeepAlive = false;
+        }
+
+#endif
         g_streamingResponseMap[ requestID ] = *ppResponse;
     }
     else
@@ -414,15 +669,13 @@ void DestroyResponse(CommunicationID& rRequestID, Response** ppResponse)
     // protect the maps from being changed by other threads using the mutex
     ScopeLock lock(s_mutex);
 
-    // remove from streaming map
-    if ((*ppResponse)->m_bStreamingEnabled)
-    {
-        ResponseMap::iterator iter = g_streamingResponseMap.find(rRequestID);
+    // remove from streaming map; CloseConnection clears m_bStreamingEnabled
+    // before a closed stream is destroyed, so look the response up either way
+    ResponseMap::iterator iter = g_streamingResponseMap.find(rRequestID);
 
-        if (iter != g_streamingResponseMap.end())
-        {
-            g_streamingResponseMap.erase(iter);
-        }
+    if (iter != g_streamingResponseMap.end() && iter->second == *ppResponse)
+    {
+        g_streamingResponseMap.erase(iter);
     }
 
     SAFE_DELETE(*ppResponse);
@@ -489,6 +742,183 @@ bool ShouldResponseBeSent(CommunicationID requestID, bool bUpdateTime)
     return false;
 }
 
+#ifdef _LINUX
+//-----------------------------------------------------------------------------
+/// Queues part of a response on the keep-alive connection that its request
+/// came in on
+///
+/// \param rResponse the response, which must have an m_pNetRequest
+/// \param pBuffers the pieces of data to queue, one after the other
+/// \param uNumBuffers the number of pieces
+/// \param pFile a file whose contents follow the pieces, or NULL
+/// \param dwFileSize the number of bytes of pFile to send
+/// \param bFinished true if this is the last part of the response
+///
+/// \return true if the data was queued; false if the connection has been
+///   closed, or the response was already finished
+//-----------------------------------------------------------------------------
+bool QueueNetResponseData(Response& rResponse, const ResponseSegment* pBuffers, unsigned int uNumBuffers, FILE* pFile, unsigned long dwFileSize, bool bFinished)
+{
+    PsAssert(rResponse.m_pNetRequest != NULL);
+
+    // the connections are closed once DeinitCommunication has been called
+    if (g_pNetConnectionManager == NULL)
+    {
+        return false;
+    }
+
+    return g_pNetConnectionManager->SendResponseData(*rResponse.m_pNetRequest, pBuffers, uNumBuffers, pFile, dwFileSize, bFinished);
+}
+
+//-----------------------------------------------------------------------------
+/// Turns the requests received on keep-alive connections into requests that
+/// GetPendingRequests processes along with the ones from the web server
+//-----------------------------------------------------------------------------
+class NetRequestHandler : public INetRequestHandler
+{
+public:
+
+    /// Called on g_netConnectionThread for each request that is received
+    /// \param inManager the manager that received the request
+    /// \param inRequest the request
+    virtual void OnRequest(NetConnectionManager& inManager, const NetRequest& inRequest)
+    {
+        HTTPRequestHeader* pRequest = new HTTPRequestHeader();
+        string strError;
+
+        if (pRequest->ParseWebRequest(inRequest.mHeader.data(), inRequest.mHeader.size(), inRequest.mBody.data(), inRequest.mBody.size(), strError) != HTTP_NO_ERROR)
+        {
+            Log(logERROR, "Failed to parse a request received on a keep-alive connection: %s\n", strError.c_str());
+            delete pRequest;
+
+            const char* pHtml = "<html><body><h2>Error: 400</h2></body></html>";
+            inManager.SendResponse(inRequest, 400, "text/html", pHtml, strlen(pHtml));
+            return;
+        }
+
+        pRequest->SetClientSocket(NULL);
+        pRequest->SetReceivedOverSocket(true);
+
+        // heap pointers are aligned, so setting the low bit keeps these IDs apart
+        // from the socket pointers that identify the web server's requests
+        CommunicationID requestID = CommunicationID(pRequest) | 1;
+
+        // protect the maps from being changed by other threads using the mutex
+        ScopeLock lock(s_mutex);
+
+        g_requestMap[requestID] = pRequest;
+        g_netRequestMap[requestID] = inRequest;
+        g_pendingNetRequests.push_back(requestID);
+    }
+};
+
+static NetRequestHandler g_netRequestHandler;
+
+//-----------------------------------------------------------------------------
+/// Starts accepting keep-alive connections straight to this process on the
+/// port set by OptionKeepAlivePort, if it is set. Automation clients can then
+/// send many requests over one connection, rather than a connection per
+/// request through the web server. The connections are serviced by
+/// g_netConnectionThread, so the render thread never waits on the network.
+//-----------------------------------------------------------------------------
+void StartNetConnectionManager()
+{
+    unsigned int uPort = SG_GET_UINT(OptionKeepAlivePort);
+
+    if (uPort == 0 || g_pNetConnectionManager != NULL)
+    {
+        return;
+    }
+
+    NetConnectionManager* pManager = new NetConnectionManager(&g_netRequestHandler);
+
+    if (pManager->Listen((u_short)uPort) == false)
+    {
+        Log(logERROR, "InitCommunication: Can't accept keep-alive connections on port %u.\n", uPort);
+        delete pManager;
+        return;
+    }
+
+    g_pNetConnectionManager = pManager;
+    g_bStopNetConnectionThread.store(false);
+
+    g_netConnectionThread = std::thread([pManager]()
+    {
+        // wake up regularly to see whether the thread should stop
+        while (g_bStopNetConnectionThread.load() == false && pManager->Poll(s_nNetConnectionPollTimeoutMs) == true)
+        {
+        }
+    });
+}
+
+//-----------------------------------------------------------------------------
+/// Stops g_netConnectionThread, closes every keep-alive connection, and
+/// forgets the requests received on them that haven't been responded to
+//-----------------------------------------------------------------------------
+void StopNetConnectionManager()
+{
+    if (g_pNetConnectionManager == NULL)
+    {
+        return;
+    }
+
+    g_bStopNetConnectionThread.store(true);
+    g_netConnectionThread.join();
+
+    // protect the maps from being changed by other threads using the mutex
+    ScopeLock lock(s_mutex);
+
+    SAFE_DELETE(g_pNetConnectionManager);
+
+    while (g_netRequestMap.empty() == false)
+    {
+        RemoveRequest(g_netRequestMap.begin()->first);
+    }
+
+    g_pendingNetRequests.clear();
+}
+
+//-----------------------------------------------------------------------------
+/// Takes the oldest request received on a keep-alive connection that hasn't
+/// been processed yet
+///
+/// \param bRemove true to take the request; false to leave it pending
+/// \param rRequestID [out] the ID of the request
+///
+/// \return the request, or NULL if there are no pending requests
+//-----------------------------------------------------------------------------
+HTTPRequestHeader* GetPendingNetRequest(bool bRemove, CommunicationID& rRequestID)
+{
+    // protect the maps from being changed by other threads using the mutex
+    ScopeLock lock(s_mutex);
+
+    while (g_pendingNetRequests.empty() == false)
+    {
+        rRequestID = g_pendingNetRequests.front();
+
+        if (bRemove)
+        {
+            g_pendingNetRequests.erase(g_pendingNetRequests.begin());
+        }
+
+        RequestMap::iterator iterRequest = g_requestMap.find(rRequestID);
+
+        if (iterRequest != g_requestMap.end())
+        {
+            return iterRequest->second;
+        }
+
+        // the request was removed before it was processed
+        if (bRemove == false)
+        {
+            g_pendingNetRequests.erase(g_pendingNetRequests.begin());
+        }
+    }
+
+    return NULL;
+}
+#endif
+
 //=============================================================================
 //
 // EntryPoints for Receiving Data
@@ -545,8 +975,11 @@ bool InitCommunication(const char* strShortDescription, ProcessRequest_type pPro
     ScopeLock lock(s_mutex);
 
     g_requestMap.clear();
-    g_pBufferedResponse = NULL;
-    g_uBufferedResponseSize = 0;
+    ClearBufferedResponse();
+
+#ifdef _LINUX
+    StartNetConnectionManager();
+#endif
 
     return true;
 }
@@ -559,10 +992,18 @@ bool InitCommunication(const char* strShortDescription, ProcessRequest_type pPro
 //-----------------------------------------------------------------------------
 void DeinitCommunication()
 {
+#ifdef _LINUX
+    StopNetConnectionManager();
+#endif
+
     smClose(g_strSharedMemoryName);
     smClose("PLUGINS_TO_GPS");
 
     g_processRequest = NULL;
+
+    ClearBufferedResponse();
+
+    DeleteIdleCompressors();
 }
 
 //-----------------------------------------------------------------------------
@@ -575,6 +1016,20 @@ void DeinitCommunication()
 //-----------------------------------------------------------------------------
 void GetPendingRequests()
 {
+#ifdef _LINUX
+    // process the requests that were received on keep-alive connections
+    CommunicationID netRequestID = 0;
+
+    while (GetPendingNetRequest(true, netRequestID) != NULL)
+    {
+        if (g_processRequest(netRequestID) == false)
+        {
+            SendHTTPErrorResponse(netRequestID, 404);
+        }
+    }
+
+#endif
+
     if (smLockGet(g_strSharedMemoryName) == false)
     {
         return;
@@ -625,6 +1080,17 @@ void GetPendingRequests()
 
 gtASCIIString PeekPendingRequests()
 {
+#ifdef _LINUX
+    CommunicationID netRequestID = 0;
+    HTTPRequestHeader* pNetRequest = GetPendingNetRequest(false, netRequestID);
+
+    if (pNetRequest != NULL)
+    {
+        return pNetRequest->GetUrl();
+    }
+
+#endif
+
     if (smLockGet(g_strSharedMemoryName) == false)
     {
         return "";
@@ -656,6 +1122,22 @@ gtASCIIString PeekPendingRequests()
 
 void GetSinglePendingRequest()
 {
+#ifdef _LINUX
+    // take the requests in the order that PeekPendingRequests shows them
+    CommunicationID netRequestID = 0;
+
+    if (GetPendingNetRequest(true, netRequestID) != NULL)
+    {
+        if (g_processRequest(netRequestID) == false)
+        {
+            SendHTTPErrorResponse(netRequestID, 404);
+        }
+
+        return;
+    }
+
+#endif
+
     if (smLockGet(g_strSharedMemoryName) == false)
     {
         return;
@@ -756,6 +1238,32 @@ void* GetRequestBinary(CommunicationID requestID)
     return pRequest;
 }
 
+//-----------------------------------------------------------------------------
+/// GetAcceptedEncodings
+///
+/// Gets the content encodings that the client accepts in the response to a
+/// request, as listed in the request's Accept-Encoding header
+///
+/// \param requestID id of the request
+///
+/// \return a combination of HTTP_CONTENT_ENCODING flags; 0 if the request
+///  could not be found
+//-----------------------------------------------------------------------------
+unsigned int GetAcceptedEncodings(CommunicationID requestID)
+{
+    // protect the maps from being changed by other threads using the mutex
+    ScopeLock lock(s_mutex);
+
+    RequestMap::iterator iterRequest = g_requestMap.find(requestID);
+
+    if (iterRequest == g_requestMap.end())
+    {
+        return 0;
+    }
+
+    return iterRequest->second->GetAcceptedEncodings();
+}
+
 //-----------------------------------------------------------------------------
 /// IsResponseRateLimited
 ///
@@ -783,6 +1291,49 @@ bool IsResponseRateLimited(CommunicationID requestID)
 //
 //=============================================================================
 
+//---------------------------------------------------------
+/// PutResponseSegments
+///
+/// Puts one buffer of a response, made of several pieces, into the
+/// PLUGINS_TO_GPS shared memory. The pieces are serialized straight into a
+/// region reserved for the whole buffer, so the reader can take it in a single
+/// chunk. If no region is free for the whole buffer, it is put in chunks as
+/// the reader frees up space, copying each chunk straight from the pieces.
+/// \pre smLockPut has been called successfully
+///
+/// \param pSegments the pieces of the buffer
+/// \param uNumSegments the number of pieces
+/// \param dwNumBytes the total size of the pieces
+///
+/// \return true if the buffer was put; false otherwise
+//---------------------------------------------------------
+static bool PutResponseSegments(const ResponseSegment* pSegments, unsigned int uNumSegments, unsigned long dwNumBytes)
+{
+    char* pReserved = (char*)smReservePut("PLUGINS_TO_GPS", dwNumBytes);
+
+    if (pReserved == NULL)
+    {
+        // an empty buffer can't be put either way, and smPutSegments fails for it
+        std::vector< SMSegment > smSegments(uNumSegments);
+
+        for (unsigned int i = 0; i < uNumSegments; i++)
+        {
+            smSegments[i].pData = pSegments[i].pData;
+            smSegments[i].dwNumBytes = (unsigned long)pSegments[i].size;
+        }
+
+        return smPutSegments("PLUGINS_TO_GPS", smSegments.empty() ? NULL : &smSegments[0], uNumSegments);
+    }
+
+    for (unsigned int i = 0; i < uNumSegments; i++)
+    {
+        memcpy(pReserved, pSegments[i].pData, pSegments[i].size);
+        pReserved += pSegments[i].size;
+    }
+
+    return smCommitPut("PLUGINS_TO_GPS", dwNumBytes);
+}
+
 //---------------------------------------------------------
 /// SendResponse
 ///
@@ -798,6 +1349,44 @@ bool IsResponseRateLimited(CommunicationID requestID)
 //---------------------------------------------------------
 bool SendResponse(CommunicationID requestID, const char* cpsMimeType, const char* cpsResponse, unsigned int uResponseSize, bool bStreaming)
 {
+    return SendResponseSegments(requestID, cpsMimeType, &cpsResponse, &uResponseSize, 1, bStreaming);
+}
+
+//---------------------------------------------------------
+/// SendResponseSegments
+///
+/// Sends a response that is made of several pieces, one after the other,
+/// either over sockets or shared memory. Over shared memory, the pieces are
+/// written straight into the region reserved for the response, so the caller
+/// doesn't need to put them together first.
+///
+/// \param requestID the requestID to send the response to
+/// \param cpsMimeType the mimetype to send the response as
+/// \param cpsSegments the pieces of the response
+/// \param puSegmentSizes the size of each piece
+/// \param uNumSegments the number of pieces
+/// \param bStreaming indicates that the response it to a streaming request
+///
+/// \return true if the response is 'sent' correctly; false otherwise
+//---------------------------------------------------------
+bool SendResponseSegments(CommunicationID requestID, const char* cpsMimeType, const char* const* cpsSegments, const unsigned int* puSegmentSizes, unsigned int uNumSegments, bool bStreaming)
+{
+    std::vector< ResponseSegment > segments;
+    segments.reserve(uNumSegments);
+
+    unsigned long dwResponseSize = 0;
+
+    for (unsigned int i = 0; i < uNumSegments; i++)
+    {
+        // a NULL response is how a streaming response asks for the connection to be closed
+        if (cpsSegments[i] != NULL)
+        {
+            ResponseSegment segment = { cpsSegments[i], puSegmentSizes[i] };
+            segments.push_back(segment);
+            dwResponseSize += puSegmentSizes[i];
+        }
+    }
+
     // find out if this is a streaming response
     if (bStreaming)
     {
@@ -805,11 +1394,21 @@ bool SendResponse(CommunicationID requestID, const char* cpsMimeType, const char
         // this is a streaming response
         // use the socket for comms
 
-        return SendMimeResponse(requestID, cpsMimeType, cpsResponse, uResponseSize);
+        return SendMimeSegments(requestID, cpsMimeType, segments.empty() ? NULL : &segments[0], (unsigned int)segments.size());
     }
 
+    // the shared memory response has no way to carry a Content-Encoding header,
+    // so a response that should be compressed goes straight to the client's socket
+    if (ShouldCompressResponse(GetAcceptedEncodings(requestID), cpsMimeType, dwResponseSize) == true)
+    {
+        Log(logTRACE, "Sending compressed response over socket\n");
+        return SendMimeSegments(requestID, cpsMimeType, segments.empty() ? NULL : &segments[0], (unsigned int)segments.size());
+    }
+
+    unsigned long dwMimeTypeSize = (unsigned long) strlen(cpsMimeType) * sizeof(const char);
+
     // use Shared memory if this is not a streaming response
-    if (smLockPut("PLUGINS_TO_GPS", sizeof(requestID) + ((unsigned long) strlen(cpsMimeType) * sizeof(const char)) + uResponseSize, 3) == false)
+    if (smLockPut("PLUGINS_TO_GPS", sizeof(requestID) + dwMimeTypeSize + dwResponseSize, 3) == false)
     {
         Log(logASSERT, "Not enough space in shared memory for response.\n");
         return false;
@@ -832,9 +1431,12 @@ bool SendResponse(CommunicationID requestID, const char* cpsMimeType, const char
         Log(logWARNING, "Failed to open PLUGINS_TO_GPS_SEMAPHORE. Response may be delayed.\n");
     }
 
-    bool bResult = (smPut("PLUGINS_TO_GPS", &requestID, sizeof(requestID)) &&
-                    smPut("PLUGINS_TO_GPS", (void*)cpsMimeType, (unsigned long) strlen(cpsMimeType) * sizeof(const char)) &&
-                    smPut("PLUGINS_TO_GPS", (void*)cpsResponse, uResponseSize));
+    ResponseSegment requestIDSegment = { &requestID, sizeof(requestID) };
+    ResponseSegment mimeTypeSegment = { cpsMimeType, dwMimeTypeSize };
+
+    bool bResult = (PutResponseSegments(&requestIDSegment, 1, sizeof(requestID)) &&
+                    PutResponseSegments(&mimeTypeSegment, 1, dwMimeTypeSize) &&
+                    PutResponseSegments(segments.empty() ? NULL : &segments[0], (unsigned int)segments.size(), dwResponseSize));
 
     smUnlockPut("PLUGINS_TO_GPS");
 
@@ -871,51 +1473,70 @@ bool BufferResponse(const char* cpData, unsigned int uSizeInBytes)
         return false;
     }
 
-    char* pNewBuffer = NULL;
+    // fill up whatever space is left in the last chunk
+    if (g_bufferedResponseChunks.empty() == false)
+    {
+        BufferedResponseChunk& rLastChunk = g_bufferedResponseChunks.back();
+        unsigned int uCopySize = std::min<unsigned int>(rLastChunk.uCapacity - rLastChunk.uSize, uSizeInBytes);
 
-    unsigned int nBufferSize = g_uBufferedResponseSize + uSizeInBytes;
+        memcpy_s(rLastChunk.pData + rLastChunk.uSize, rLastChunk.uCapacity - rLastChunk.uSize, cpData, uCopySize);
+        rLastChunk.uSize += uCopySize;
+        g_uBufferedResponseSize += uCopySize;
 
-    try
-    {
-        pNewBuffer = new char[ nBufferSize ];
-    }
-    catch (std::bad_alloc)
-    {
-        Log(logERROR, "BufferResponse: Out of memory\n");
-        return false;
+        cpData += uCopySize;
+        uSizeInBytes -= uCopySize;
     }
 
-    if (g_pBufferedResponse != NULL)
+    if (uSizeInBytes > 0)
     {
-        // copy existing data if there is any
-        memcpy_s(pNewBuffer, nBufferSize, g_pBufferedResponse, g_uBufferedResponseSize);
+        // the previous chunks are never copied, so make the new chunk large
+        // enough that the number of chunks grows logarithmically
+        BufferedResponseChunk newChunk;
+        newChunk.uSize = uSizeInBytes;
+        newChunk.uCapacity = std::max<unsigned int>(std::max<unsigned int>(g_uBufferedResponseSize, s_uMinBufferedResponseChunkSize), uSizeInBytes);
+
+        try
+        {
+            newChunk.pData = new char[ newChunk.uCapacity ];
+        }
+        catch (std::bad_alloc)
+        {
+            Log(logERROR, "BufferResponse: Out of memory\n");
+            return false;
+        }
 
-        // cleanup previous buffered response
-        delete g_pBufferedResponse;
+        // copy parameter data into buffered memory
+        memcpy_s(newChunk.pData, newChunk.uCapacity, cpData, uSizeInBytes);
 
-        // move new Buffer to be the buffered response
-        g_pBufferedResponse = pNewBuffer;
-        pNewBuffer = g_pBufferedResponse + g_uBufferedResponseSize;
-    }
-    else
-    {
-        // there was no previous buffered response,
-        // so make the global pointer be the same as the new buffer
-        g_pBufferedResponse = pNewBuffer;
+        g_bufferedResponseChunks.push_back(newChunk);
+        g_uBufferedResponseSize += uSizeInBytes;
     }
 
-    // copy parameter data into buffered memory
-    memcpy_s(pNewBuffer, nBufferSize, cpData, uSizeInBytes);
+    return true;
+}
 
-    g_uBufferedResponseSize += uSizeInBytes;
+//-----------------------------------------------------------------------------
+/// ClearBufferedResponse
+///
+/// Frees all of the data that was buffered using BufferResponse(...).
+//-----------------------------------------------------------------------------
+void ClearBufferedResponse()
+{
+    for (std::vector< BufferedResponseChunk >::iterator iter = g_bufferedResponseChunks.begin(); iter != g_bufferedResponseChunks.end(); ++iter)
+    {
+        delete [] iter->pData;
+    }
 
-    return true;
+    g_bufferedResponseChunks.clear();
+    g_uBufferedResponseSize = 0;
 }
 
 //-----------------------------------------------------------------------------
 /// SendBufferResponse
 ///
 /// Sends the buffered response that was built using BufferResponse(...).
+/// The buffered chunks are sent one after the other rather than being copied
+/// into a single buffer, and are freed once they have been sent.
 ///
 /// \param requestID An ID for a particular request; the plugin will get this
 ///  id as a parameter to the ProcessRequest( ) function
@@ -924,7 +1545,26 @@ bool BufferResponse(const char* cpData, unsigned int uSizeInBytes)
 //-----------------------------------------------------------------------------
 bool SendBufferResponse(CommunicationID& requestID)
 {
-    return SendBinaryResponse(requestID, g_pBufferedResponse, g_uBufferedResponseSize);
+    if (g_bufferedResponseChunks.empty())
+    {
+        Log(logERROR, "Failed to send buffered response because no data has been buffered\n");
+        return false;
+    }
+
+    std::vector< ResponseSegment > segments;
+    segments.reserve(g_bufferedResponseChunks.size());
+
+    for (std::vector< BufferedResponseChunk >::const_iterator iter = g_bufferedResponseChunks.begin(); iter != g_bufferedResponseChunks.end(); ++iter)
+    {
+        ResponseSegment segment = { iter->pData, iter->uSize };
+        segments.push_back(segment);
+    }
+
+    bool bResult = SendBinarySegments(requestID, &segments[0], (unsigned int)segments.size());
+
+    ClearBufferedResponse();
+
+    return bResult;
 }
 
 //-----------------------------------------------------------------------------
@@ -949,6 +1589,24 @@ bool SendBinaryResponse(CommunicationID& requestID,
         return false;
     }
 
+    ResponseSegment segment = { cpData, uSizeInBytes };
+    return SendBinarySegments(requestID, &segment, 1);
+}
+
+//-----------------------------------------------------------------------------
+/// SendBinarySegments
+///
+/// Sends several pieces of raw data, one after the other, as a single response.
+///
+/// \param requestID An ID for a particular request; the plugin will get this
+///  id as a parameter to the ProcessRequest( ) function
+/// \param pSegments the pieces of data that make up the response
+/// \param uNumSegments the number of pieces pointed to by pSegments
+///
+/// \return true if the response could be sent; false otherwise
+//-----------------------------------------------------------------------------
+bool SendBinarySegments(CommunicationID& requestID, const ResponseSegment* pSegments, unsigned int uNumSegments)
+{
     // see if the response is streaming and rate limited
     if (ShouldResponseBeSent(requestID, true) == true)
     {
@@ -965,7 +1623,7 @@ bool SendBinaryResponse(CommunicationID& requestID,
         return false;
     }
 
-    if (Send(*pResponse, "application/octet-stream", cpData, uSizeInBytes) == false)
+    if (SendSegments(*pResponse, "application/octet-stream", pSegments, uNumSegments) == false)
     {
         Log(logERROR, "Failed to 'Send' response for requestID %d\n", requestID);
 
@@ -1228,13 +1886,12 @@ bool SendFileResponse(CommunicationID& requestID, const char* cpFile)
     // collect file data and generate response
     FILE* in;
     long fileSize;
-    char* fileBuffer;
     fopen_s(&in, cpFile, "rb");    // read binary
 
     if (!in)
     {
         // file error, not found?
-        OutputHTTPError(pResponse->client_socket, 404);     // 404 - not found
+        OutputHTTPError(*pResponse, 404);     // 404 - not found
         return false;
     }
 
@@ -1243,22 +1900,16 @@ bool SendFileResponse(CommunicationID& requestID, const char* cpFile)
     fileSize = ftell(in);
     fseek(in, 0, SEEK_SET);
 
-    // allocate Buffer_ and read in file contents
-    fileBuffer = new char[fileSize];
-    fread(fileBuffer, sizeof(char), fileSize, in);
+    // send the file contents straight from the file, rather than reading them into memory first
+    bool bRes = SendFile(*pResponse, mimetypes[ FindMimeType(cpFile)].mime, in, fileSize);
     fclose(in);
 
-    bool bRes = Send(*pResponse, mimetypes[ FindMimeType(cpFile)].mime, fileBuffer, fileSize);
-
     if (bRes == false)
     {
         Log(logERROR, "Failed to 'Send' response for requestID %d\n", requestID);
         DestroyResponse(requestID, &pResponse);
     }
-
-    delete [] fileBuffer;
-
-    if (pResponse->m_bStreamingEnabled == false)
+    else if (pResponse->m_bStreamingEnabled == false)
     {
         DestroyResponse(requestID, &pResponse);
     }
@@ -1283,6 +1934,27 @@ bool SendFileResponse(CommunicationID& requestID, const char* cpFile)
 /// \return true if the response could be sent; false otherwise
 //-----------------------------------------------------------------------------
 bool SendMimeResponse(CommunicationID& requestID, const char* cpMimeType, const char* cpData, unsigned int uSizeInBytes)
+{
+    ResponseSegment segment = { cpData, uSizeInBytes };
+    return SendMimeSegments(requestID, cpMimeType, (cpData != NULL) ? &segment : NULL, (cpData != NULL) ? 1 : 0);
+}
+
+//-----------------------------------------------------------------------------
+/// SendMimeSegments
+///
+/// Sends the specified pieces of data, one after the other, as a single
+/// response of the specified mime type over the request's socket.
+///
+/// \param requestID An ID for a particular request
+/// \param cpMimeType A string identifying which MIME type to use for
+///  interpreting the data
+/// \param pSegments the pieces of the response; NULL closes a streaming
+///  connection
+/// \param uNumSegments the number of pieces
+///
+/// \return true if the response could be sent; false otherwise
+//-----------------------------------------------------------------------------
+bool SendMimeSegments(CommunicationID& requestID, const char* cpMimeType, const ResponseSegment* pSegments, unsigned int uNumSegments)
 {
     if (cpMimeType == NULL)
     {
@@ -1308,17 +1980,18 @@ bool SendMimeResponse(CommunicationID& requestID, const char* cpMimeType, const
     // if Data is NULL then close streaming connection
     if (pResponse->m_bStreamingEnabled == true)
     {
-        if (cpData == NULL)
+        if (pSegments == NULL)
         {
             const char* pstr = "--BoundaryString\r\n";
-            pResponse->client_socket->Send(pstr, (unsigned int)strlen(pstr));
+            ResponseSegment boundary = { pstr, strlen(pstr) };
+            SendRaw(*pResponse, &boundary, 1);
             CloseConnection(*pResponse);
             DestroyResponse(requestID, &pResponse);
             return true;
         }
     }
 
-    if (Send(*pResponse, cpMimeType, cpData, uSizeInBytes) == false)
+    if (SendSegments(*pResponse, cpMimeType, pSegments, uNumSegments) == false)
     {
         DestroyResponse(requestID, &pResponse);
         return false;
@@ -1360,7 +2033,7 @@ bool SendHTTPErrorResponse(CommunicationID& requestID, int nErrorCode)
         return false;
     }
 
-    if (OutputHTTPError(pResponse->client_socket, nErrorCode) == false)
+    if (OutputHTTPError(*pResponse, nErrorCode) == false)
     {
         DestroyResponse(requestID, &pResponse);
         return false;
@@ -1408,21 +2081,21 @@ bool SendRedirectResponse(CommunicationID& requestID, const char* pNewURL)
     }
 
     // generate the redirect html
-    static char headerBuffer[COMM_BUFFER_SIZE];
-    static char htmlBuffer[COMM_BUFFER_SIZE];
+    char headerBuffer[COMM_BUFFER_SIZE];
+    char htmlBuffer[COMM_BUFFER_SIZE];
 
     sprintf_s(htmlBuffer, COMM_BUFFER_SIZE, "<html><body><a href=\"%s\">%s</a></body></html>", pNewURL, pNewURL);
-    sprintf_s(headerBuffer, COMM_BUFFER_SIZE, "HTTP/1.0 301\r\nContent-Type: text/html\r\nContent-Length: %zd\r\nLocation: %s\r\n\r\n", strlen(htmlBuffer), pNewURL);
+    GenerateStatusLine(*pResponse, "301", headerBuffer, COMM_BUFFER_SIZE);
+
+    DWORD len = (DWORD)strlen(headerBuffer);
+    sprintf_s(headerBuffer + len, COMM_BUFFER_SIZE - len, "Content-Type: text/html\r\nContent-Length: %zd\r\nLocation: %s\r\n\r\n", strlen(htmlBuffer), pNewURL);
 
-    bool nRes1;
-    bool nRes2;
-    nRes1 = pResponse->client_socket->Send(headerBuffer, (DWORD)strlen(headerBuffer));
-    nRes2 = pResponse->client_socket->Send(htmlBuffer, (DWORD)strlen(htmlBuffer));
+    ResponseSegment buffers[] = { { headerBuffer, strlen(headerBuffer) }, { htmlBuffer, strlen(htmlBuffer) } };
+    bool bRes = SendRaw(*pResponse, buffers, sizeof(buffers) / sizeof(buffers[0]));
 
-    pResponse->client_socket->close();
+    CloseConnection(*pResponse);
 
-    if ((nRes1 == false) ||
-        (nRes2 == false))
+    if (bRes == false)
     {
         DestroyResponse(requestID, &pResponse);
         return false;
@@ -1500,4 +2173,8 @@ void RemoveRequest(CommunicationID requestID)
         delete pRequest;
         g_requestMap.erase(iter);
     }
+
+#ifdef _LINUX
+    g_netRequestMap.erase(requestID);
+#endif
 }
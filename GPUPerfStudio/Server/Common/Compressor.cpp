@@ -2,74 +2,185 @@
 // Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
 /// \author AMD Developer Tools Team
 /// \file
-/// \brief  TODO add documentation
+/// \brief  Compresses data with zlib, in either the deflate (zlib) or the gzip
+///         format, reusing the same compression state for each piece of data.
 //==============================================================================
 
+#include <string.h>
 #include "Compressor.h"
+#include "Logger.h"
 
 #ifdef USE_GZIP
 
-static void strm_init(z_stream* strm)
+/// The base-two logarithm of the compression window size.
+static const int s_WindowBits = 15;
+
+/// Added to the window bits to make zlib write a gzip header and trailer instead of a zlib one.
+static const int s_GzipEncoding = 16;
+
+/// The amount of memory zlib uses for its internal compression state.
+static const int s_MemLevel = 8;
+
+//--------------------------------------------------------------------------
+/// Constructor.
+/// \param inFormat The format to write the compressed data in.
+/// \param inLevel The zlib compression level, from 0 (none) to 9 (smallest).
+//--------------------------------------------------------------------------
+Compressor::Compressor(Format inFormat, int inLevel)
+    : mFormat(inFormat)
+    , mbInitialized(false)
+    , mCompressedSize(0)
 {
-    strm->zalloc = Z_NULL;
-    strm->zfree  = Z_NULL;
-    strm->opaque = Z_NULL;
-    CALL_ZLIB(deflateInit2(strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
-                           windowBits | GZIP_ENCODING, 8,
-                           Z_DEFAULT_STRATEGY));
-}
+    memset(&mStream, 0, sizeof(mStream));
+    mStream.zalloc = Z_NULL;
+    mStream.zfree = Z_NULL;
+    mStream.opaque = Z_NULL;
 
-unsigned char* m_pData;
-unsigned int m_nLength;
+    int windowBits = (inFormat == FORMAT_GZIP) ? (s_WindowBits | s_GzipEncoding) : s_WindowBits;
+    int status = deflateInit2(&mStream, inLevel, Z_DEFLATED, windowBits, s_MemLevel, Z_DEFAULT_STRATEGY);
+
+    if (status == Z_OK)
+    {
+        mbInitialized = true;
+    }
+    else
+    {
+        Log(logERROR, "Failed to initialize zlib compression at level %d: error %d\n", inLevel, status);
+    }
+}
 
-unsigned int GetCompressedSize()
+//--------------------------------------------------------------------------
+/// Destructor. Frees the zlib stream.
+//--------------------------------------------------------------------------
+Compressor::~Compressor()
 {
-    return m_nLength;
+    if (mbInitialized)
+    {
+        deflateEnd(&mStream);
+    }
 }
 
-unsigned char* GetCompressedData()
+//--------------------------------------------------------------------------
+/// Compress a piece of data in one step.
+/// \param inData The data to compress.
+/// \param inSize The number of bytes to compress.
+/// \param outCompressed Receives the compressed data.
+/// \returns True if the data was compressed, false if there was an error.
+//--------------------------------------------------------------------------
+bool Compressor::Compress(const void* inData, size_t inSize, std::vector<unsigned char>& outCompressed)
 {
-    return m_pData;
+    // Begin sizes the output with deflateBound, so this completes in a single call to deflate.
+    return (Begin(inSize, outCompressed) &&
+            Append(inData, inSize, outCompressed) &&
+            Finish(outCompressed));
 }
 
-void CleanupCompressedData()
+//--------------------------------------------------------------------------
+/// Start compressing data that is given in several pieces.
+/// \param inTotalSize The total number of bytes that will be appended.
+/// \param outCompressed Receives the compressed data.
+/// \returns True if compression was started, false if there was an error.
+//--------------------------------------------------------------------------
+bool Compressor::Begin(size_t inTotalSize, std::vector<unsigned char>& outCompressed)
 {
-    if (m_pData != NULL)
+    if (mbInitialized == false)
     {
-        free(m_pData);
+        return false;
     }
 
-    m_nLength = 0;
+    // Reuse the stream's internal buffers, rather than freeing and reallocating them.
+    if (deflateReset(&mStream) != Z_OK)
+    {
+        Log(logERROR, "Failed to reset zlib compression\n");
+        return false;
+    }
+
+    mCompressedSize = 0;
+    outCompressed.resize(deflateBound(&mStream, (uLong)inTotalSize));
+
+    return true;
 }
 
-void Compress(const char* pMessage)
+//--------------------------------------------------------------------------
+/// Compress the next piece of data.
+/// \param inData The data to compress.
+/// \param inSize The number of bytes to compress.
+/// \param ioCompressed The compressed data that was passed to Begin.
+/// \returns True if the data was compressed, false if there was an error.
+//--------------------------------------------------------------------------
+bool Compressor::Append(const void* inData, size_t inSize, std::vector<unsigned char>& ioCompressed)
 {
-    // Cleanup any previous data
-    CleanupCompressedData();
+    if (inSize == 0)
+    {
+        return true;
+    }
 
-    unsigned int memSize = (unsigned int)strlen(pMessage) * sizeof(unsigned char);
+    mStream.next_in = (Bytef*)inData;
+    mStream.avail_in = (uInt)inSize;
 
-    m_pData = (unsigned char*) malloc(strlen(pMessage) * sizeof(unsigned char));
+    return Deflate(Z_NO_FLUSH, ioCompressed);
+}
 
-    unsigned char out[CHUNK];
-    z_stream strm;
-    strm_init(& strm);
-    strm.next_in = (unsigned char*) pMessage;
-    strm.avail_in = memSize;
+//--------------------------------------------------------------------------
+/// Write the end of the compressed data.
+/// \param ioCompressed The compressed data that was passed to Begin.
+/// \returns True if the compressed data is complete, false if there was an error.
+//--------------------------------------------------------------------------
+bool Compressor::Finish(std::vector<unsigned char>& ioCompressed)
+{
+    mStream.next_in = Z_NULL;
+    mStream.avail_in = 0;
 
-    do
+    if (Deflate(Z_FINISH, ioCompressed) == false)
     {
-        int have;
-        strm.avail_out = CHUNK;
-        strm.next_out = out;
-        CALL_ZLIB(deflate(& strm, Z_FINISH));
-        have = CHUNK - strm.avail_out;
-        memcpy(&m_pData[m_nLength], out, have);
-        m_nLength += have;
+        return false;
     }
-    while (strm.avail_out == 0);
 
-    deflateEnd(& strm);
+    ioCompressed.resize(mCompressedSize);
+    return true;
+}
+
+//--------------------------------------------------------------------------
+/// Run deflate over the input that has been given to the stream, growing
+/// the output as needed.
+/// \param inFlush The zlib flush mode. Z_FINISH completes the compressed data.
+/// \param ioCompressed The compressed data.
+/// \returns True if successful, false if zlib reported an error.
+//--------------------------------------------------------------------------
+bool Compressor::Deflate(int inFlush, std::vector<unsigned char>& ioCompressed)
+{
+    for (;;)
+    {
+        // The output is normally sized by Begin, but the size hint may have been too small.
+        if (mCompressedSize == ioCompressed.size())
+        {
+            ioCompressed.resize(ioCompressed.size() * 2 + 64);
+        }
+
+        mStream.next_out = &ioCompressed[mCompressedSize];
+        mStream.avail_out = (uInt)(ioCompressed.size() - mCompressedSize);
+
+        int status = deflate(&mStream, inFlush);
+
+        mCompressedSize = ioCompressed.size() - mStream.avail_out;
+
+        if (status == Z_STREAM_END)
+        {
+            return true;
+        }
+
+        if (status != Z_OK && status != Z_BUF_ERROR)
+        {
+            Log(logERROR, "zlib compression failed with error %d\n", status);
+            return false;
+        }
+
+        // Without Z_FINISH, deflate is done once it has taken all of the input and has output space left over.
+        if (inFlush != Z_FINISH && mStream.avail_in == 0 && mStream.avail_out > 0)
+        {
+            return true;
+        }
+    }
 }
 
-#endif
+#endif // USE_GZIP
@@ -2,89 +2,135 @@
 // Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
 /// \author AMD Developer Tools Team
 /// \file
-/// \brief  TODO add documentation
+/// \brief  Compresses data with zlib, in either the deflate (zlib) or the gzip
+///         format, reusing the same compression state for each piece of data.
 //==============================================================================
 
+#ifndef COMPRESSOR_H
+#define COMPRESSOR_H
+
 #include <stdio.h>
-#include <sstream>
+#include <vector>
 
 #ifdef USE_GZIP
 
 #include "zlib.h"
 
-#define CHUNK 0x4000
-#define windowBits 15
-#define GZIP_ENCODING 16
-
-#define CALL_ZLIB(x) {                                                  \
-        int status;                                                     \
-        status = x;                                                     \
-        if (status < 0) {                                               \
-            fprintf (stderr,                                            \
-                     "%s:%d: %s returned a bad status of %d.\n",        \
-                     __FILE__, __LINE__, #x, status);                   \
-            exit (EXIT_FAILURE);                                        \
-        }                                                               \
-    }
-
-
-unsigned int GetCompressedSize();
-
-unsigned char* GetCompressedData();
-
-void Compress(const char* pMessage);
-
-void CleanupCompressedData();
-
-/*class Compressor
+//--------------------------------------------------------------------------
+/// Compressor wraps a single zlib deflate stream. The stream is initialized
+/// once, and reset for each piece of data, so its internal buffers are only
+/// allocated once. The output is sized with deflateBound, so any input,
+/// including input that doesn't compress, fits in the output.
+///
+/// A Compressor holds no state that is shared with other instances, so
+/// several threads may compress at the same time using one Compressor each.
+/// A single Compressor must only be used by one thread at a time.
+//--------------------------------------------------------------------------
+class Compressor
 {
 public:
-
-   Compressor::Compressor()
-      :  m_pData(NULL),
-         m_nLength(0)
-   {
-   }
-
-   Compressor::~Compressor()
-   {
-      if ( m_pData != NULL )
-      {
-         free(m_pData);
-      }
-   }
-
-   void Compress(const char* pMessage);
-
-
-   unsigned int GetCompressedSize()
-   {
-      return m_nLength;
-   }
-
-   unsigned char *GetCompressedData()
-   {
-      return m_pData;
-   }
-
-   void Cleanup()
-   {
-      if ( m_pData != NULL )
-      {
-         free(m_pData);
-      }
-
-      m_nLength = 0;
-   }
-
-
+    //--------------------------------------------------------------------------
+    /// The formats that the compressed data can be written in.
+    //--------------------------------------------------------------------------
+    enum Format
+    {
+        /// The zlib format, as used by the HTTP "deflate" content encoding.
+        FORMAT_DEFLATE,
+
+        /// The gzip format, as used by the HTTP "gzip" content encoding and .gz files.
+        FORMAT_GZIP
+    };
+
+    //--------------------------------------------------------------------------
+    /// Constructor.
+    /// \param inFormat The format to write the compressed data in.
+    /// \param inLevel The zlib compression level, from 0 (none) to 9 (smallest).
+    //--------------------------------------------------------------------------
+    Compressor(Format inFormat, int inLevel = Z_DEFAULT_COMPRESSION);
+
+    //--------------------------------------------------------------------------
+    /// Destructor. Frees the zlib stream.
+    //--------------------------------------------------------------------------
+    ~Compressor();
+
+    //--------------------------------------------------------------------------
+    /// Retrieve the format that the compressed data is written in.
+    /// \returns The format.
+    //--------------------------------------------------------------------------
+    Format GetFormat() const { return mFormat; }
+
+    //--------------------------------------------------------------------------
+    /// Compress a piece of data in one step.
+    /// \param inData The data to compress.
+    /// \param inSize The number of bytes to compress.
+    /// \param outCompressed Receives the compressed data.
+    /// \returns True if the data was compressed, false if there was an error.
+    //--------------------------------------------------------------------------
+    bool Compress(const void* inData, size_t inSize, std::vector<unsigned char>& outCompressed);
+
+    //--------------------------------------------------------------------------
+    /// Start compressing data that is given in several pieces. Each piece is
+    /// passed to Append, then Finish completes the compressed data.
+    /// \param inTotalSize The total number of bytes that will be appended,
+    /// so that the output can be sized once. Only used as a size hint.
+    /// \param outCompressed Receives the compressed data.
+    /// \returns True if compression was started, false if there was an error.
+    //--------------------------------------------------------------------------
+    bool Begin(size_t inTotalSize, std::vector<unsigned char>& outCompressed);
+
+    //--------------------------------------------------------------------------
+    /// Compress the next piece of data.
+    /// \param inData The data to compress.
+    /// \param inSize The number of bytes to compress.
+    /// \param ioCompressed The compressed data that was passed to Begin.
+    /// \returns True if the data was compressed, false if there was an error.
+    //--------------------------------------------------------------------------
+    bool Append(const void* inData, size_t inSize, std::vector<unsigned char>& ioCompressed);
+
+    //--------------------------------------------------------------------------
+    /// Write the end of the compressed data.
+    /// \param ioCompressed The compressed data that was passed to Begin.
+    /// \returns True if the compressed data is complete, false if there was an error.
+    //--------------------------------------------------------------------------
+    bool Finish(std::vector<unsigned char>& ioCompressed);
 
 private:
-
-   unsigned char* m_pData;
-
-   unsigned int m_nLength;
-
-};*/
-
-#endif
+    //--------------------------------------------------------------------------
+    /// Run deflate over the input that has been given to the stream, growing
+    /// the output as needed.
+    /// \param inFlush The zlib flush mode. Z_FINISH completes the compressed data.
+    /// \param ioCompressed The compressed data.
+    /// \returns True if successful, false if zlib reported an error.
+    //--------------------------------------------------------------------------
+    bool Deflate(int inFlush, std::vector<unsigned char>& ioCompressed);
+
+    /// Disable copying, since the zlib stream can't be shared.
+    Compressor(const Compressor&);
+
+    /// Disable assignment, since the zlib stream can't be shared.
+    Compressor& operator=(const Compressor&);
+
+    //--------------------------------------------------------------------------
+    /// The zlib stream, reused for each piece of data.
+    //--------------------------------------------------------------------------
+    z_stream mStream;
+
+    //--------------------------------------------------------------------------
+    /// The format that the compressed data is written in.
+    //--------------------------------------------------------------------------
+    Format mFormat;
+
+    //--------------------------------------------------------------------------
+    /// True if the zlib stream was initialized.
+    //--------------------------------------------------------------------------
+    bool mbInitialized;
+
+    //--------------------------------------------------------------------------
+    /// The number of bytes of compressed data written since Begin.
+    //--------------------------------------------------------------------------
+    size_t mCompressedSize;
+};
+
+#endif // USE_GZIP
+
+#endif // COMPRESSOR_H
@@ -0,0 +1,245 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  A fixed-size, per-thread ring of recently traced calls, used to
+///         keep a rolling history of the last few frames.
+//==============================================================================
+
+#ifndef FLIGHTRECORDER_H
+#define FLIGHTRECORDER_H
+
+#include <stddef.h>
+#include <atomic>
+#include <vector>
+#include "CommonTypes.h"
+
+/// Forward declare this, since the definition exists in multiple places.
+enum FuncId : int;
+
+//--------------------------------------------------------------------------
+/// The number of calls that each thread's FlightRecorderRing can hold. A thread
+/// that makes more calls than this over the requested number of frames holds
+/// fewer frames, and the dump is shortened to the frames that are complete.
+//--------------------------------------------------------------------------
+static const unsigned int s_FlightRecorderCallsPerThread = 32768;
+
+//--------------------------------------------------------------------------
+/// The maximum number of frames that the flight recorder can be configured to keep.
+//--------------------------------------------------------------------------
+static const unsigned int s_MaxFlightRecorderFrames = 64;
+
+//--------------------------------------------------------------------------
+/// The shortest time in milliseconds between two automatic dumps of the flight recorder.
+//--------------------------------------------------------------------------
+static const unsigned int s_MinFlightRecorderDumpIntervalMs = 10000;
+
+//--------------------------------------------------------------------------
+/// The information kept for each call traced by the flight recorder.
+//--------------------------------------------------------------------------
+struct FlightRecorderCall
+{
+    /// The index of the frame that the call was made in.
+    unsigned int mFrameIndex;
+
+    /// The function that was called.
+    FuncId mFunctionId;
+
+    /// The interface that the call was made through.
+    void* mInterface;
+
+    /// The return value of the call, or FUNCTION_RETURNS_VOID.
+    INT64 mReturnValue;
+
+    /// The timestamp collected directly before the call.
+    GPS_TIMESTAMP mStartTime;
+
+    /// The timestamp collected directly after the call.
+    GPS_TIMESTAMP mEndTime;
+};
+
+//--------------------------------------------------------------------------
+/// The information kept for each frame traced by the flight recorder.
+//--------------------------------------------------------------------------
+struct FlightRecorderFrame
+{
+    /// The index of the frame.
+    unsigned int mFrameIndex;
+
+    /// The timestamp collected when the frame began.
+    GPS_TIMESTAMP mStartTime;
+
+    /// The CPU duration of the frame in milliseconds.
+    float mCPUFrameDuration;
+};
+
+//--------------------------------------------------------------------------
+/// The flight recorder contents copied out of every thread's ring, so that they can be
+/// formatted away from the render thread while the rings carry on being overwritten.
+//--------------------------------------------------------------------------
+struct FlightRecorderSnapshot
+{
+    //--------------------------------------------------------------------------
+    /// A call copied out of a thread's ring.
+    //--------------------------------------------------------------------------
+    struct CopiedCall
+    {
+        DWORD mThreadId;                    ///< The thread that made the call.
+        FlightRecorderCall mCall;           ///< The recorded call.
+    };
+
+    /// The number of frames that were asked for. Zero if no frame has been recorded.
+    unsigned int mRequestedFrameCount;
+
+    /// The index of the first frame for which every thread's calls are held.
+    unsigned int mFirstFrameIndex;
+
+    /// The index of the last recorded frame.
+    unsigned int mLastFrameIndex;
+
+    /// The frames from mFirstFrameIndex to mLastFrameIndex.
+    std::vector<FlightRecorderFrame> mFrames;
+
+    /// The calls made in those frames, grouped by thread.
+    std::vector<CopiedCall> mCalls;
+};
+
+//--------------------------------------------------------------------------
+/// FlightRecorderRing holds the most recent calls traced on a single thread. Recording a
+/// call only writes into the next slot, overwriting the oldest call once the ring is full.
+/// The ring is only written by its owning thread, but can be read from any thread. Each
+/// slot has a sequence number that is odd while the slot is being written, so readers can
+/// detect and skip a slot that was overwritten while it was being copied. Each slot also
+/// stores the index of the record it holds, since the writer fills a slot before publishing
+/// the new record count, and a reader could otherwise take the new record for the old one.
+//--------------------------------------------------------------------------
+class FlightRecorderRing
+{
+public:
+    //--------------------------------------------------------------------------
+    /// Default constructor. The slots aren't allocated until the first call is recorded.
+    //--------------------------------------------------------------------------
+    FlightRecorderRing()
+        : mSlots(NULL)
+        , mNumRecorded(0)
+    {
+    }
+
+    //--------------------------------------------------------------------------
+    /// Destructor releases the ring's slots.
+    //--------------------------------------------------------------------------
+    ~FlightRecorderRing()
+    {
+        delete[] mSlots;
+        mSlots = NULL;
+    }
+
+    //--------------------------------------------------------------------------
+    /// Record a call into the ring. Must only be called from the thread that owns the ring.
+    /// \param inCall The call to record.
+    //--------------------------------------------------------------------------
+    void Record(const FlightRecorderCall& inCall)
+    {
+        unsigned int numRecorded = mNumRecorded.load(std::memory_order_relaxed);
+
+        if (mSlots == NULL)
+        {
+            // Allocated once per thread. The ring is reused for the rest of the session.
+            mSlots = new RingSlot[s_FlightRecorderCallsPerThread];
+        }
+
+        RingSlot& slot = mSlots[numRecorded % s_FlightRecorderCallsPerThread];
+        unsigned int sequence = slot.mSequence.load(std::memory_order_relaxed);
+
+        slot.mSequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.mRecordIndex = numRecorded;
+        slot.mCall = inCall;
+        slot.mSequence.store(sequence + 2, std::memory_order_release);
+
+        mNumRecorded.store(numRecorded + 1, std::memory_order_release);
+    }
+
+    //--------------------------------------------------------------------------
+    /// Retrieve the total number of calls recorded into the ring, including calls that have been overwritten.
+    /// \returns The number of calls recorded into the ring.
+    //--------------------------------------------------------------------------
+    unsigned int GetNumRecorded() const { return mNumRecorded.load(std::memory_order_acquire); }
+
+    //--------------------------------------------------------------------------
+    /// Copy a recorded call out of the ring.
+    /// \param inRecordIndex The index of the call to read, in the order the calls were recorded.
+    /// \param outCall The copied call.
+    /// \returns True if the call was copied. False if it has been, or is being, overwritten.
+    //--------------------------------------------------------------------------
+    bool ReadCall(unsigned int inRecordIndex, FlightRecorderCall& outCall) const
+    {
+        // Calls older than the ring's capacity have already been overwritten.
+        unsigned int numRecorded = GetNumRecorded();
+
+        if (inRecordIndex >= numRecorded || (numRecorded - inRecordIndex) > s_FlightRecorderCallsPerThread)
+        {
+            return false;
+        }
+
+        const RingSlot& slot = mSlots[inRecordIndex % s_FlightRecorderCallsPerThread];
+        unsigned int sequenceBefore = slot.mSequence.load(std::memory_order_acquire);
+
+        if ((sequenceBefore & 1) != 0)
+        {
+            return false;
+        }
+
+        unsigned int slotRecordIndex = slot.mRecordIndex;
+        outCall = slot.mCall;
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        unsigned int sequenceAfter = slot.mSequence.load(std::memory_order_relaxed);
+
+        // The slot must not have been rewritten while it was copied, and must hold the requested record.
+        return (sequenceBefore == sequenceAfter) && (slotRecordIndex == inRecordIndex);
+    }
+
+private:
+    //--------------------------------------------------------------------------
+    /// Disable copying, since the ring owns its slots.
+    //--------------------------------------------------------------------------
+    FlightRecorderRing(const FlightRecorderRing&);
+
+    //--------------------------------------------------------------------------
+    /// Disable assignment, since the ring owns its slots.
+    //--------------------------------------------------------------------------
+    FlightRecorderRing& operator=(const FlightRecorderRing&);
+
+    //--------------------------------------------------------------------------
+    /// A single slot within the ring.
+    //--------------------------------------------------------------------------
+    struct RingSlot
+    {
+        //--------------------------------------------------------------------------
+        /// Constructor marks the slot as unwritten.
+        //--------------------------------------------------------------------------
+        RingSlot() : mSequence(0), mRecordIndex(0) { }
+
+        /// Incremented before and after the call is written. Odd while a write is in progress.
+        std::atomic<unsigned int> mSequence;
+
+        /// The index of the recorded call, in the order the calls were recorded.
+        unsigned int mRecordIndex;
+
+        /// The recorded call.
+        FlightRecorderCall mCall;
+    };
+
+    //--------------------------------------------------------------------------
+    /// The ring's slots. Published to readers by the first increment of mNumRecorded.
+    //--------------------------------------------------------------------------
+    RingSlot* mSlots;
+
+    //--------------------------------------------------------------------------
+    /// The total number of calls recorded into the ring.
+    //--------------------------------------------------------------------------
+    std::atomic<unsigned int> mNumRecorded;
+};
+
+#endif // FLIGHTRECORDER_H
@@ -13,7 +13,6 @@
 #include "misc.h"
 #include "SharedGlobal.h"
 #include "GPUPerfAPIUtils/GPUPerfAPIUtil.h"
-#include "Compressor.h"
 #include <AMDTBaseTools/Include/gtASCIIString.h>
 #ifdef _WIN32
     #include "ADLUtil.h"
@@ -1972,40 +1971,10 @@ void FrameProfiler::SendCounterResultString(CommandResponse& rRequest, const cha
         result << "</XML>";
     }
 
-    ////// Exmaple of how to use gzip compression
-#ifdef USE_GZIP
-    Compress(result.str().c_str());
-    unsigned int dataSize = GetCompressedSize();
-    unsigned char* pData = GetCompressedData();
-
-    FILE* fPtr = NULL;
-
-    fopen_s(&fPtr, "c:\\temp\\profileSource.xml.gz", "wb");
-
-    if (fPtr != NULL)
-    {
-        size_t  written = fwrite(pData, 1, dataSize, fPtr);
-
-        if (written == 0)
-        {
-            Log(logERROR, "Nothing written to compressed XML file.\n");
-        }
-
-        fclose(fPtr);
-    }
-
-#endif
-
     // Send data to the client
     rRequest.Send(result.str().c_str());
     AddProfiledCall(rRequest, "Ok", 0);
 
-#ifdef USE_GZIP
-    // Clean up the memory
-    CleanupCompressedData();
-#endif
-
-
     // close the stream;
     if (rRequest.GetStreamingEnabled())
     {
@@ -6,6 +6,8 @@
 //==============================================================================
 
 #include <AMDTOSWrappers/Include/osSystemError.h>
+#include <ctype.h>
+#include <algorithm>
 #include "HTTPRequest.h"
 #include "CommandTimingManager.h"
 
@@ -22,6 +24,7 @@ void HTTPRequestHeader::InitializeHeaderData()
     memset(&m_httpHeaderData.client_ip, 0, sizeof(SockAddrIn));
     memset(&m_httpHeaderData.ProtoInfo, 0, sizeof(m_httpHeaderData.ProtoInfo));
     m_httpHeaderData.nPostDataSize = 0 ;
+    m_httpHeaderData.nAcceptedEncodings = 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////
@@ -127,6 +130,15 @@ unsigned int HTTPRequestHeader::GetPostDataSize()
     return m_httpHeaderData.nPostDataSize;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////
+/// Gets the content encodings that the client accepts in the response.
+/// \return A combination of HTTP_CONTENT_ENCODING flags.
+////////////////////////////////////////////////////////////////////////////////////////////
+unsigned int HTTPRequestHeader::GetAcceptedEncodings()
+{
+    return m_httpHeaderData.nAcceptedEncodings;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////
 /// Set the post data
 /// \param pData The input data to copy.
@@ -198,7 +210,8 @@ HTTP_REQUEST_RESULT HTTPRequestHeader::ReadWebRequest(string& strError)
     char readBuffer[COMM_BUFFER_SIZE];
     // clear the memory.
     ZeroMemory(readBuffer, COMM_BUFFER_SIZE);
-    // Read up to a buffer size worth of data. The function will detect the end of the header and will not read any more data.
+    // Read up to a buffer size worth of data. The function stops once it has the end of the header; any POST data
+    // that arrived in the same reads is kept in m_receivedPostData, where ReadPostData picks it up.
     nRead = SocketReadHeader(GetClientSocket(), readBuffer, COMM_BUFFER_SIZE);
 
     // Check for error
@@ -238,6 +251,61 @@ HTTP_REQUEST_RESULT HTTPRequestHeader::ReadWebRequest(string& strError)
     return HTTP_NO_ERROR;
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////
+/// Parses an HTTP header, and the POST data that followed it, that have already been
+/// received, such as by the NetConnectionManager.
+/// \param pHeader The request line and header fields.
+/// \param nHeaderSize The number of bytes in the header.
+/// \param pPostData The data that followed the header.
+/// \param nPostDataSize The number of bytes that followed the header.
+/// \param strError Output error string.
+/// \return HTTP_NO_ERROR if success, HTTP_PARSE_ERROR if fail.
+////////////////////////////////////////////////////////////////////////////////////////////
+HTTP_REQUEST_RESULT HTTPRequestHeader::ParseWebRequest(const char* pHeader, gtSize_t nHeaderSize, const char* pPostData, gtSize_t nPostDataSize, string& strError)
+{
+    if (nHeaderSize >= COMM_BUFFER_SIZE)
+    {
+        strError = "HTTPRequestHeader: The header is larger than the buffer.";
+        return HTTP_PARSE_ERROR;
+    }
+
+    // ExtractHeaderData tokenizes the header in place, so parse a copy of it.
+    char readBuffer[COMM_BUFFER_SIZE];
+    memcpy(readBuffer, pHeader, nHeaderSize);
+    readBuffer[nHeaderSize] = '\0';
+
+    if (ExtractHeaderData(&readBuffer[0]) == false)
+    {
+        strError = "HTTPRequestHeader: ExtractHeaderData failed.";
+        return HTTP_PARSE_ERROR;
+    }
+
+    unsigned int nContentLength = GetPostDataSize();
+
+    if (nContentLength > 0)
+    {
+        if (nPostDataSize < nContentLength)
+        {
+            strError = "HTTPRequestHeader: The POST data is shorter than the Content-Length.";
+            return HTTP_PARSE_ERROR;
+        }
+
+        char* pData = (char*)malloc(sizeof(char) * nContentLength + 1);
+
+        if (pData == NULL)
+        {
+            strError = "HTTPRequestHeader: Malloc failed in POST data.";
+            return HTTP_PARSE_ERROR;
+        }
+
+        memcpy(pData, pPostData, nContentLength);
+        pData[nContentLength] = '\0';
+        SetPostData(pData);
+    }
+
+    return HTTP_NO_ERROR;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////
 /// Read the POST data section of a web request. It can read from shared memory or a socket.
 /// Both input streams read pointers must be set at the beginning of the POST data.
@@ -278,8 +346,15 @@ bool HTTPRequestHeader::ReadPostData(string& strError, bool bUseSharedMemory, co
 
     if (bUseSharedMemory == false)
     {
-        // Read data from a socket
-        nRead = SocketRead(GetClientSocket(), m_pPostData, nContentLength);
+        // Use any data that was received along with the header first, then read the rest from the socket
+        nRead = (m_receivedPostData.size() < nContentLength) ? m_receivedPostData.size() : nContentLength;
+        memcpy(m_pPostData, m_receivedPostData.data(), nRead);
+        m_receivedPostData.clear();
+
+        if (nRead < nContentLength)
+        {
+            nRead += SocketRead(GetClientSocket(), m_pPostData + nRead, nContentLength - nRead);
+        }
     }
     else
     {
@@ -335,22 +410,48 @@ gtSize_t HTTPRequestHeader::SocketReadHeader(NetSocket* client_socket, char* pOu
     gtSize_t  totalsize = 0;
     bool success = false;
 
+    // How much of the "\r\n\r\n" that ends the header has been matched so far. This is carried
+    // between reads, so each received byte is only looked at once.
+    int nTerminatorMatched = 0;
+
+    m_receivedPostData.clear();
+
     do
     {
-        success = client_socket->Receive(pOutBuffer + totalsize, 1, size);
+        // read as much as is available, leaving room for the terminating NULL
+        success = client_socket->Receive(pOutBuffer + totalsize, nBufferSize - 1 - totalsize, size);
 
         if (size > 0 && success == true)
         {
-            totalsize += size;
-
-            // are we done reading the http header?
-            if (strstr(pOutBuffer, "\r\n\r\n"))
+            for (gtSize_t i = totalsize; i < totalsize + size; i++)
             {
-                break;
+                if (pOutBuffer[i] == '\r')
+                {
+                    nTerminatorMatched = (nTerminatorMatched == 2) ? 3 : 1;
+                }
+                else if (pOutBuffer[i] == '\n' && (nTerminatorMatched == 1 || nTerminatorMatched == 3))
+                {
+                    nTerminatorMatched++;
+                }
+                else
+                {
+                    nTerminatorMatched = 0;
+                }
+
+                // are we done reading the http header?
+                if (nTerminatorMatched == 4)
+                {
+                    // keep anything after the header; it is the start of the POST data
+                    gtSize_t headerSize = i + 1;
+                    m_receivedPostData.assign(pOutBuffer + headerSize, totalsize + size - headerSize);
+                    return headerSize;
+                }
             }
 
+            totalsize += size;
+
             // have we overrun the buffer?
-            if (totalsize > nBufferSize - 1)
+            if (totalsize >= nBufferSize - 1)
             {
                 success = false;
             }
@@ -375,6 +476,9 @@ bool HTTPRequestHeader::ExtractHeaderData(char* pReceiveBuffer)
     char* pos = NULL;
     char* context = NULL;
 
+    // The header fields can be in any order, so look for Accept-Encoding before the buffer is tokenized.
+    m_httpHeaderData.nAcceptedEncodings = ParseAcceptedEncodings(pReceiveBuffer);
+
     ////////////////////////////////////////////////////////////////////////
     // tokenize the buffer for method
     pos = strtok_s(pReceiveBuffer, " ", &context);
@@ -494,3 +598,97 @@ int HTTPRequestHeader::GetContentLength(char* pBuffer)
 
     return nLength ;
 }
+
+////////////////////////////////////////////////////////////////////////
+/// Get the content encodings listed in the Accept-Encoding header
+/// \param pBuffer The buffer to search in.
+/// \return A combination of HTTP_CONTENT_ENCODING flags.
+////////////////////////////////////////////////////////////////////////
+unsigned int HTTPRequestHeader::ParseAcceptedEncodings(const char* pBuffer)
+{
+    const char* p = NULL;
+    const char* pLine = pBuffer;
+
+    // Header field names are case-insensitive, and only count at the start of a line, so a URL or another
+    // field's value that happens to contain the name isn't mistaken for it. The header ends at the first blank line.
+    while (pLine != NULL && *pLine != '\0' && *pLine != '\r' && *pLine != '\n')
+    {
+        if (_strnicmp(pLine, "Accept-Encoding:", 16) == 0)
+        {
+            p = pLine;
+            break;
+        }
+
+        pLine = strchr(pLine, '\n');
+
+        if (pLine != NULL)
+        {
+            pLine++;
+        }
+    }
+
+    if (p == NULL)
+    {
+        return 0;
+    }
+
+    // Advance beyond the "Accept-Encoding:" part, and only look at the rest of the line.
+    p += 16;
+    size_t lineLength = strcspn(p, "\r\n");
+
+    unsigned int nEncodings = 0;
+    string strLine(p, lineLength);
+    size_t start = 0;
+
+    // The value is a comma separated list, such as "gzip, deflate;q=0.5, br"
+    while (start < strLine.size())
+    {
+        size_t end = strLine.find(',', start);
+
+        if (end == string::npos)
+        {
+            end = strLine.size();
+        }
+
+        string strCoding = strLine.substr(start, end - start);
+        start = end + 1;
+
+        // An encoding with a quality of zero is not acceptable.
+        size_t params = strCoding.find(';');
+
+        if (params != string::npos)
+        {
+            float fQuality = 1.0f;
+            size_t quality = strCoding.find("q=", params);
+
+            if (quality != string::npos && sscanf_s(strCoding.c_str() + quality + 2, "%f", &fQuality) == 1 && fQuality <= 0.0f)
+            {
+                continue;
+            }
+
+            strCoding.erase(params);
+        }
+
+        size_t first = strCoding.find_first_not_of(" \t");
+        size_t last = strCoding.find_last_not_of(" \t");
+
+        if (first == string::npos)
+        {
+            continue;
+        }
+
+        strCoding = strCoding.substr(first, last - first + 1);
+        std::transform(strCoding.begin(), strCoding.end(), strCoding.begin(), ::tolower);
+
+        if (strCoding == "gzip")
+        {
+            nEncodings |= HTTP_ENCODING_GZIP;
+        }
+        else if (strCoding == "deflate")
+        {
+            nEncodings |= HTTP_ENCODING_DEFLATE;
+        }
+    }
+
+    return nEncodings;
+}
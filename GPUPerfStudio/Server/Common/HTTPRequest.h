@@ -38,6 +38,15 @@ enum HTTP_REQUEST_RESULT
     HTTP_POST_DATA_ERROR
 };
 
+/// Flags for the content encodings that a client will accept in a response.
+enum HTTP_CONTENT_ENCODING
+{
+    /// The client accepts zlib compressed responses.
+    HTTP_ENCODING_DEFLATE = 0x1,
+    /// The client accepts gzip compressed responses.
+    HTTP_ENCODING_GZIP = 0x2
+};
+
 #if defined (_WIN32)
     typedef  IN_ADDR     SockAddrIn;
 #else
@@ -78,6 +87,9 @@ typedef struct
     /// The size of the data passed in POST
     unsigned int nPostDataSize;
 
+    /// The HTTP_CONTENT_ENCODING flags of the encodings listed in the Accept-Encoding header
+    unsigned int nAcceptedEncodings;
+
 } HTTPHeaderData;
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -188,6 +200,12 @@ public:
     ////////////////////////////////////////////////////////////////////////////////////////////
     unsigned int GetPostDataSize();
 
+    ////////////////////////////////////////////////////////////////////////////////////////////
+    /// Gets the content encodings that the client accepts in the response.
+    /// \return A combination of HTTP_CONTENT_ENCODING flags.
+    ////////////////////////////////////////////////////////////////////////////////////////////
+    unsigned int GetAcceptedEncodings();
+
     ////////////////////////////////////////////////////////////////////////////////////////////
     /// Set the post data
     /// \param pData The input data to copy.
@@ -225,6 +243,18 @@ public:
     ////////////////////////////////////////////////////////////////////////////////////////////
     HTTP_REQUEST_RESULT ReadWebRequest(string& strError);
 
+    ////////////////////////////////////////////////////////////////////////////////////////////
+    /// Parses an HTTP header, and the POST data that followed it, that have already been
+    /// received, such as by the NetConnectionManager.
+    /// \param pHeader The request line and header fields.
+    /// \param nHeaderSize The number of bytes in the header.
+    /// \param pPostData The data that followed the header.
+    /// \param nPostDataSize The number of bytes that followed the header.
+    /// \param strError Output error string.
+    /// \return HTTP_NO_ERROR if success, HTTP_PARSE_ERROR if fail.
+    ////////////////////////////////////////////////////////////////////////////////////////////
+    HTTP_REQUEST_RESULT ParseWebRequest(const char* pHeader, gtSize_t nHeaderSize, const char* pPostData, gtSize_t nPostDataSize, string& strError);
+
     ////////////////////////////////////////////////////////////////////////////////////////////
     /// Read the POST data section of a web request. It can read from shared memory or a socket.
     /// Both input streams read pointers must be set at the beginning of the POST data.
@@ -242,6 +272,13 @@ public:
     ////////////////////////////////////////////////////////////////////////////////////////////
     int GetContentLength(char* pBuffer);
 
+    ////////////////////////////////////////////////////////////////////////////////////////////
+    /// Get the content encodings listed in the Accept-Encoding header
+    /// \param pBuffer The buffer to search in.
+    /// \return A combination of HTTP_CONTENT_ENCODING flags.
+    ////////////////////////////////////////////////////////////////////////////////////////////
+    unsigned int ParseAcceptedEncodings(const char* pBuffer);
+
     ////////////////////////////////////////////////////////////////////////////////////////////
     /// Get the the ProtoInfo
     /// \return the proto info
@@ -265,11 +302,12 @@ private:
     static gtSize_t SocketRead(NetSocket* client_socket, char* receiveBuffer, gtSize_t bytesToRead);
 
     ///////////////////////////////////////////////////////////////////////////////////////
-    /// Read just the web header
+    /// Read just the web header. The socket is read in blocks, so any data received after
+    /// the end of the header is kept in m_receivedPostData for ReadPostData.
     /// \param client_socket The socket connection.
     /// \param receiveBuffer The buffer to read the data into.
     /// \param nBufferSize The size of the output buffer.
-    /// \return The number of bytes read.
+    /// \return The number of bytes in the header.
     ///////////////////////////////////////////////////////////////////////////////////////
     gtSize_t SocketReadHeader(NetSocket* client_socket, char* pOutBuffer, gtSize_t nBufferSize);
 
@@ -287,6 +325,9 @@ private:
 
     /// Pointer to the data passed in POST.
     char* m_pPostData;
+
+    /// The start of the POST data, if it was received from the socket along with the header.
+    string m_receivedPostData;
 };
 
 #endif // GPS_HTTPREQUEST_H
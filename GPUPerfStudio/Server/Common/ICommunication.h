@@ -141,6 +141,25 @@ bool IsResponseRateLimited(CommunicationID requestID);
 //---------------------------------------------------------
 bool SendResponse(CommunicationID requestID, const char* cpsMimeType, const char* cpsResponse, unsigned int uResponseSize, bool bStreaming);
 
+//---------------------------------------------------------
+/// SendResponseSegments
+///
+/// Sends a response that is made of several pieces, one after the other,
+/// either over sockets or shared memory. Over shared memory, the pieces are
+/// written straight into the region reserved for the response, so the caller
+/// doesn't need to put them together first.
+///
+/// \param requestID the requestID to send the response to
+/// \param cpsMimeType the mimetype to send the response as
+/// \param cpsSegments the pieces of the response
+/// \param puSegmentSizes the size of each piece
+/// \param uNumSegments the number of pieces
+/// \param bStreaming indicates that the response it to a streaming request
+///
+/// \return true if the response is 'sent' correctly; false otherwise
+//---------------------------------------------------------
+bool SendResponseSegments(CommunicationID requestID, const char* cpsMimeType, const char* const* cpsSegments, const unsigned int* puSegmentSizes, unsigned int uNumSegments, bool bStreaming);
+
 //-----------------------------------------------------------------------------
 /// BufferResponse
 ///
@@ -19,7 +19,7 @@ enum eObjectType : int;
 class IInstanceBase
 {
 public:
-    IInstanceBase() : mbIsDestroyed(false) {}
+    IInstanceBase() : mbIsDestroyed(false), mNextInstanceOfType(NULL) {}
     virtual ~IInstanceBase() {}
 
     //--------------------------------------------------------------------------
@@ -85,8 +85,23 @@ public:
     //--------------------------------------------------------------------------
     inline void FlagAsDestroyed() { mbIsDestroyed = true; }
 
+    //--------------------------------------------------------------------------
+    /// Retrieve the next instance with the same type and parent device. Used by the ObjectTreeIndex.
+    /// \returns The next instance created with the same type and parent device, or NULL if this is the last one.
+    //--------------------------------------------------------------------------
+    inline IInstanceBase* GetNextInstanceOfType() const { return mNextInstanceOfType; }
+
+    //--------------------------------------------------------------------------
+    /// Link the next instance with the same type and parent device. Used by the ObjectTreeIndex.
+    /// \param inNextInstance The next instance created with the same type and parent device.
+    //--------------------------------------------------------------------------
+    inline void SetNextInstanceOfType(IInstanceBase* inNextInstance) { mNextInstanceOfType = inNextInstance; }
+
 private:
     bool mbIsDestroyed;
+
+    /// The next instance with the same type and parent device, in creation order.
+    IInstanceBase* mNextInstanceOfType;
 };
 
 #endif // IINSTANCEBASE_H
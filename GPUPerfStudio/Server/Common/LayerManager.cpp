@@ -142,6 +142,9 @@ bool LayerManager::PopEnabledLayer()
 /// Gets called at the beginning of the frame
 void LayerManager::BeginFrame()
 {
+    // Log statements only check the cached log level, so pick up a level set by the client once a frame.
+    _RefreshCachedLogLevel();
+
     // increase the frame count if not currently captured
     if (m_instantCaptureState != INSTANT_CAPTURE_CAPTURED)
     {
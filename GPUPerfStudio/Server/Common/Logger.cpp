@@ -15,13 +15,41 @@
     #include "OSWrappers.h"
 #endif
 
+#include <limits.h>
 #include "Logger.h"
 #include "misc.h"
 #include "SharedGlobal.h"
 #include "NamedMutex.h"
+#include "AsyncLogWriter.h"
 
 static const char* s_mutexName = "PerfStudioLogfileMutex";
 
+// Nothing is known about the log level until SharedGlobal first copies the shared options, so let everything through.
+std::atomic<int> g_CachedLogLevel(INT_MAX);
+std::atomic<std::atomic<unsigned int>*> g_pSharedOptionsGeneration(NULL);
+
+// The shared options generation that g_CachedLogLevel was taken from. Odd, so it never matches a finished write,
+// and the first refresh after SharedGlobal is initialized reads the level.
+static std::atomic<unsigned int> s_CachedLogLevelGeneration(1);
+
+void _RefreshCachedLogLevel(void)
+{
+    std::atomic<unsigned int>* pSharedGeneration = g_pSharedOptionsGeneration.load(std::memory_order_relaxed);
+
+    if ((pSharedGeneration != NULL) &&
+        (pSharedGeneration->load(std::memory_order_relaxed) != s_CachedLogLevelGeneration.load(std::memory_order_relaxed)))
+    {
+        // Reading any shared option retakes this process' snapshot, which updates g_CachedLogLevel.
+        SG_GET_INT(OptionLogLevel);
+    }
+}
+
+void _SetCachedLogLevel(int logLevel, unsigned int generation)
+{
+    g_CachedLogLevel.store(logLevel, std::memory_order_relaxed);
+    s_CachedLogLevelGeneration.store(generation, std::memory_order_relaxed);
+}
+
 // Mutex functionality. Uses a platform-independent NamedMutex object, which must be dynamically allocated
 // since the logging functions could be called when the shared library is loaded (reason yet unknown) and
 // when this happens, the loader may not have initialized static data.
@@ -176,43 +204,28 @@ bool _SetupLog(const bool console, const char* module, const char* file, int lin
 }
 
 //
-// Write log messages into the logfile.
+// Queue log messages to be written into the logfile by the AsyncLogWriter's background thread.
+// Errors and asserts are written to the logfile before returning, since they often come just before a crash.
 //
-static void _logWrite(const char* pMessage)
+static void _logWrite(const char* pMessage, enum LogType type)
 {
-    FILE* f;
-    const char* logFilename = GetLogFilename();
-
-    if (logFilename != NULL)
+    if (SG_GET_BOOL(OptionNoLogfile) == false)
     {
-        if (LogMutexLock())   // wait for exclusive access to logfile
-        {
-            fopen_s(&f, logFilename, "a+");    // append
-
-            if (f != NULL)
-            {
-                fprintf(f, "%s", pMessage);
-                fclose(f);
-            }
-            else
-            {
-#if defined (_WIN32)
-                __declspec(thread) static bool recursiveWrite = false;  // Avoid getting into an infinite loop if file can't be opened.
-#elif defined (_LINUX)
-                static __thread bool recursiveWrite = false;  // Avoid getting into an infinite loop if file can't be opened.
-#endif
+        AsyncLogWriter::Instance()->Write(pMessage, type <= logERROR);
+    }
+}
 
-                if (!recursiveWrite)
-                {
-                    recursiveWrite = true;
-                    LogConsole(logERROR, "Unable to open logfile %s for append. Message Dropped = \n\t%s\n", logFilename, pMessage);
-                    recursiveWrite = false;
-                }
-            }
+// Write all queued log messages to the logfile before returning.
+void LogFlush(void)
+{
+    AsyncLogWriter::Instance()->Flush();
+}
 
-            LogMutexUnlock();
-        }
-    }
+// Stop the background log writer, and write everything that's queued. Later messages are written as they're logged.
+// If the process is terminating, the writer thread is already gone, so it isn't waited for.
+void LogShutdown(bool inbProcessTerminating)
+{
+    AsyncLogWriter::Instance()->Shutdown(inbProcessTerminating);
 }
 
 #define PS_LOG_MAX_LENGTH 1024
@@ -324,6 +337,7 @@ void _Log(enum LogType type, const char* fmt, ...)
 {
     // check to see if logging of the level is enabled, or if s_LogConsole is specified
     // if not, don't process it.
+    // This also refreshes g_CachedLogLevel if the shared options have changed.
     int logLevel = SG_GET_INT(OptionLogLevel);
 
     if (((type - logERROR) > logLevel && s_LogConsole == false))
@@ -445,7 +459,7 @@ void _Log(enum LogType type, const char* fmt, ...)
 
     if (truncated == false)
     {
-        if (SG_GET_INT(OptionLogLevel) >= logTRACE - logERROR)
+        if (logLevel >= logTRACE - logERROR)
         {
             // Add the indent
             for (int i = 0; (i < logIndent) && (nLen < PS_LOG_MAX_LENGTH - 1); i++, nLen++)
@@ -494,7 +508,7 @@ void _Log(enum LogType type, const char* fmt, ...)
             printf("%s", pRaw);
         }
 
-        _logWrite(pRaw);
+        _logWrite(pRaw, type);
     }
     else
     {
@@ -503,13 +517,13 @@ void _Log(enum LogType type, const char* fmt, ...)
             // Console messages are always printed in console and in log file
             // regardless of logLEVEL
             printf("%s", pConsole);
-            _logWrite(pLogString);
+            _logWrite(pLogString, type);
             OutputDebugString(fullString);
         }
         else
         {
             // not a console message - filter based on log level
-            if ((type - logERROR) <= SG_GET_INT(OptionLogLevel))
+            if ((type - logERROR) <= logLevel)
             {
                 if (type == logTRACE)
                 {
@@ -517,7 +531,7 @@ void _Log(enum LogType type, const char* fmt, ...)
                     printf("%s", pConsole);
                 }
 
-                _logWrite(pLogString);
+                _logWrite(pLogString, type);
                 OutputDebugString(fullString);
             }
         }
@@ -574,4 +588,7 @@ void _LogFooter(void)
     _Log(logRAW,  "PID: %i\n", osGetCurrentProcessId());
     _Log(logRAW,  "Time: %s\n", GetTimeStr().asCharArray());
     _Log(logRAW, "--------------THE END------------------\n");
+
+    // The footer is logged during shutdown, so make sure nothing is left in the queue.
+    LogFlush();
 }
\ No newline at end of file
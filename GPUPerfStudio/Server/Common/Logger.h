@@ -13,10 +13,22 @@
 #endif
 
 #include <assert.h>
+#include <atomic>
+#include <stddef.h>
 
 // Uncomment this next line to get __FILE__, __LINE__ and __FUNCTION__ information in log file
 // # define PS_LOG_DEBUG
 
+// The most verbose LogType that is compiled into the build. Log and LogTrace statements for more verbose
+// types compile away entirely, including their arguments. Define this in the build to override the default.
+#ifndef PS_LOG_COMPILED_LEVEL
+    #ifdef _DEBUG
+        #define PS_LOG_COMPILED_LEVEL logTRACE
+    #else
+        #define PS_LOG_COMPILED_LEVEL logDEBUG
+    #endif
+#endif
+
 // Log messages can be errors, warnings or messages
 enum LogType
 {
@@ -38,6 +50,36 @@ enum LogTraceType
     traceMESSAGE
 };
 
+// The value of OptionLogLevel, cached so that disabled log statements can be skipped with a single relaxed load.
+// Updated by SharedGlobal whenever this process copies the shared options, and by _RefreshCachedLogLevel when
+// another process changes them. Until then, every statement is passed through to _Log, which checks the shared
+// option itself.
+extern std::atomic<int> g_CachedLogLevel;
+
+// The write generation of the shared options, in the shared memory. NULL until SharedGlobal is initialized.
+extern std::atomic<std::atomic<unsigned int>*> g_pSharedOptionsGeneration;
+
+// Bring g_CachedLogLevel up to date if another process has written the shared options since it was cached.
+// Log statements don't check, so this is called once a frame by LayerManager::BeginFrame. Defined in Logger.cpp.
+void _RefreshCachedLogLevel(void);
+
+// Update the cached log level, along with the shared options generation it was read at. Only called by SharedGlobal.
+// Defined in Logger.cpp.
+void _SetCachedLogLevel(int logLevel, unsigned int generation);
+
+// Check whether a log statement of the given type should be formatted. The first part of the test is a
+// compile-time constant for the literal types used in Log statements, so statements for types that
+// aren't compiled in are removed entirely.
+inline bool _LogLevelEnabled(enum LogType type)
+{
+    if (type > PS_LOG_COMPILED_LEVEL)
+    {
+        return false;
+    }
+
+    return ((type - logERROR) <= g_CachedLogLevel.load(std::memory_order_relaxed));
+}
+
 // These macros are all of the form:
 //
 // #define Foo  if (0) ; else _Foo
@@ -46,10 +88,13 @@ enum LogTraceType
 // this trick is used to allow the use of varargs to the Log functions while still supporting
 // overloading for __FILE__, __LINE__ and __FUNCTION__
 // _SetupLog() always returns 0
+//
+// Log and LogTrace check _LogLevelEnabled first, so disabled statements don't evaluate their arguments.
+// LogConsole messages are always printed, regardless of the log level.
 
 #define LogConsole if(_SetupLog(true, LOG_MODULE, __FILE__, __LINE__, __FUNCTION__)) ; else _Log
-#define LogTrace if(_SetupLog(false, LOG_MODULE, __FILE__, __LINE__, __FUNCTION__)) ; else _LogTrace
-#define Log if(_SetupLog(false, LOG_MODULE, __FILE__, __LINE__, __FUNCTION__)) ; else _Log
+#define LogTrace(...) if(!_LogLevelEnabled(logTRACE) || _SetupLog(false, LOG_MODULE, __FILE__, __LINE__, __FUNCTION__)) ; else _LogTrace(__VA_ARGS__)
+#define Log(type, ...) if(!_LogLevelEnabled(type) || _SetupLog(false, LOG_MODULE, __FILE__, __LINE__, __FUNCTION__)) ; else _Log(type, __VA_ARGS__)
 #define LogHeader if(_SetupLog(false, LOG_MODULE, __FILE__, __LINE__, __FUNCTION__)) ; else _LogHeader
 #define LogFooter if(_SetupLog(false, LOG_MODULE, __FILE__, __LINE__, __FUNCTION__)) ; else _LogFooter
 
@@ -81,5 +126,10 @@ void _LogHeader(void);
 void _LogFooter(void);
 const char* GetLogFilename(void);
 void LogFileInitialize(void);
+void LogFlush(void);
+void LogShutdown(bool inbProcessTerminating);
+
+bool LogMutexLock(void);
+void LogMutexUnlock(void);
 
 #endif // GPS_LOGGER_H
@@ -0,0 +1,209 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Address index implementation file for MDO.
+///         A sorted array of the guarded memory ranges, used to find which
+///         resource a page guard exception landed in without taking locks.
+//==============================================================================
+
+#include "mdoAddressIndex.h"
+
+#include <algorithm>
+#include <thread>
+
+/**
+**************************************************************************************************
+*   MdoAddressIndex::MdoAddressIndex
+*
+*   @brief
+*       Create an empty index
+**************************************************************************************************
+*/
+MdoAddressIndex::MdoAddressIndex() :
+    m_pRanges(new AddressRanges()),
+    m_epoch(0)
+{
+    m_activeLookups[0] = 0;
+    m_activeLookups[1] = 0;
+}
+
+/**
+**************************************************************************************************
+*   MdoAddressIndex::~MdoAddressIndex
+*
+*   @brief
+*       Free the range list
+**************************************************************************************************
+*/
+MdoAddressIndex::~MdoAddressIndex()
+{
+    delete m_pRanges.load();
+}
+
+/**
+**************************************************************************************************
+*   MdoAddressIndex::Publish
+*
+*   @brief
+*       Make a new range list visible to lookups, then free the replaced list. Lookups that
+*       start after the epoch changes are counted against the new epoch and can only see the
+*       new list, so once the old epoch's count drains, no lookup holds the replaced list.
+*       Lookups never block, so the wait is short.
+**************************************************************************************************
+*/
+void MdoAddressIndex::Publish(AddressRanges* pRanges)
+{
+    AddressRanges* pOldRanges = m_pRanges.exchange(pRanges);
+
+    const UINT32 oldEpoch = m_epoch++;
+
+    while (m_activeLookups[oldEpoch & 1].load() != 0)
+    {
+        std::this_thread::yield();
+    }
+
+    delete pOldRanges;
+}
+
+/**
+**************************************************************************************************
+*   MdoAddressIndex::Insert
+*
+*   @brief
+*       Add a resource's memory range, replacing the range the resource had before, if any
+**************************************************************************************************
+*/
+void MdoAddressIndex::Insert(UINT64 start, UINT32 size, MdoResource* pResource)
+{
+    ScopedLock lock(&m_mtx);
+
+    const AddressRanges* pCurrRanges = m_pRanges.load();
+    AddressRanges* pNewRanges = new AddressRanges();
+    pNewRanges->reserve(pCurrRanges->size() + 1);
+
+    AddressRange newRange;
+    newRange.start = start;
+    newRange.end = start + size;
+    newRange.pResource = pResource;
+
+    bool inserted = false;
+
+    for (UINT32 i = 0; i < pCurrRanges->size(); i++)
+    {
+        const AddressRange& currRange = (*pCurrRanges)[i];
+
+        if (currRange.pResource == pResource)
+        {
+            continue;
+        }
+
+        if ((inserted == false) && (currRange.start > start))
+        {
+            pNewRanges->push_back(newRange);
+            inserted = true;
+        }
+
+        MDO_ASSERT((currRange.end <= newRange.start) || (currRange.start >= newRange.end));
+
+        pNewRanges->push_back(currRange);
+    }
+
+    if (inserted == false)
+    {
+        pNewRanges->push_back(newRange);
+    }
+
+    Publish(pNewRanges);
+}
+
+/**
+**************************************************************************************************
+*   MdoAddressIndex::Remove
+*
+*   @brief
+*       Remove a resource's memory range
+**************************************************************************************************
+*/
+void MdoAddressIndex::Remove(MdoResource* pResource)
+{
+    ScopedLock lock(&m_mtx);
+
+    const AddressRanges* pCurrRanges = m_pRanges.load();
+    bool found = false;
+
+    for (UINT32 i = 0; i < pCurrRanges->size(); i++)
+    {
+        if ((*pCurrRanges)[i].pResource == pResource)
+        {
+            found = true;
+            break;
+        }
+    }
+
+    if (found == true)
+    {
+        AddressRanges* pNewRanges = new AddressRanges();
+        pNewRanges->reserve(pCurrRanges->size() - 1);
+
+        for (UINT32 i = 0; i < pCurrRanges->size(); i++)
+        {
+            if ((*pCurrRanges)[i].pResource != pResource)
+            {
+                pNewRanges->push_back((*pCurrRanges)[i]);
+            }
+        }
+
+        Publish(pNewRanges);
+    }
+}
+
+/**
+**************************************************************************************************
+*   MdoAddressIndex::Find
+*
+*   @brief
+*       Find the resource whose range holds an address. Takes no locks, so it can be called
+*       from the exception filter while another thread updates the index.
+*
+*   @return
+*       An MdoResource ptr, or nullptr if no range holds the address
+**************************************************************************************************
+*/
+MdoResource* MdoAddressIndex::Find(UINT64 address)
+{
+    MdoResource* pOut = nullptr;
+
+    // Count this lookup against the current epoch. If the epoch changed before the count was
+    // seen, an update may not wait for this lookup, so count it against the new epoch instead.
+    UINT32 epoch = m_epoch.load();
+    m_activeLookups[epoch & 1]++;
+
+    while (m_epoch.load() != epoch)
+    {
+        m_activeLookups[epoch & 1]--;
+
+        epoch = m_epoch.load();
+        m_activeLookups[epoch & 1]++;
+    }
+
+    const AddressRanges* pRanges = m_pRanges.load();
+
+    // Find the last range starting at or below the address
+    AddressRanges::const_iterator it = std::upper_bound(pRanges->begin(), pRanges->end(), address,
+                                                        [](UINT64 addr, const AddressRange& range) { return addr < range.start; });
+
+    if (it != pRanges->begin())
+    {
+        --it;
+
+        if (address < it->end)
+        {
+            pOut = it->pResource;
+        }
+    }
+
+    m_activeLookups[epoch & 1]--;
+
+    return pOut;
+}
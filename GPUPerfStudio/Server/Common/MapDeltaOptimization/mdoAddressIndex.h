@@ -0,0 +1,55 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Address index header file for MDO.
+///         A sorted array of the guarded memory ranges, used to find which
+///         resource a page guard exception landed in without taking locks.
+//==============================================================================
+
+#ifndef __MDO_ADDRESS_INDEX_H__
+#define __MDO_ADDRESS_INDEX_H__
+
+#include "mdoUtil.h"
+
+#include <atomic>
+
+/**
+**************************************************************************************************
+* @brief A sorted, non-overlapping list of address ranges, each owned by one MdoResource.
+*        Lookups are a binary search that takes no locks, so they are safe from the exception
+*        filter. Updates copy the list, then publish the copy with a single atomic store.
+*        Each lookup is counted against the epoch it started in, so an update only waits for
+*        the few lookups that started before it, then frees the replaced list.
+**************************************************************************************************
+*/
+class MdoAddressIndex
+{
+public:
+    MdoAddressIndex();
+    ~MdoAddressIndex();
+
+    void Insert(UINT64 start, UINT32 size, MdoResource* pResource);
+    void Remove(MdoResource* pResource);
+
+    MdoResource* Find(UINT64 address);
+
+private:
+    struct AddressRange
+    {
+        UINT64       start;
+        UINT64       end;
+        MdoResource* pResource;
+    };
+
+    typedef std::vector<AddressRange> AddressRanges;
+
+    void Publish(AddressRanges* pRanges);
+
+    std::atomic<AddressRanges*> m_pRanges;
+    std::atomic<UINT32>         m_epoch;
+    std::atomic<UINT32>         m_activeLookups[2];
+    MdoMutex                    m_mtx;
+};
+
+#endif
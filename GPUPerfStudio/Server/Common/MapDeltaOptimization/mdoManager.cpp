@@ -18,6 +18,11 @@
 
 static MdoManager* g_pInstance = nullptr;
 
+#ifndef _WIN32
+// The SIGSEGV handler that was installed before ours, for faults outside of guarded memory
+static struct sigaction g_prevSegvAction;
+#endif
+
 /**
 ***************************************************************************************************
 *   MdoManager::Instance
@@ -42,6 +47,7 @@ MdoManager* MdoManager::Instance()
 *       This gets called when the app writes to guarded memory
 **************************************************************************************************
 */
+#ifdef _WIN32
 LONG WINAPI MdoManager::ExceptionFilter(_EXCEPTION_POINTERS* pException)
 {
     if (pException->ExceptionRecord->ExceptionCode == STATUS_GUARD_PAGE_VIOLATION)
@@ -53,6 +59,92 @@ LONG WINAPI MdoManager::ExceptionFilter(_EXCEPTION_POINTERS* pException)
 
     return EXCEPTION_CONTINUE_SEARCH;
 }
+#else
+/**
+**************************************************************************************************
+*   MdoManager::SignalHandler
+*
+*   @brief
+*       This gets called when the app writes to write-protected memory. Writes to guarded
+*       reflection memory are tracked, then the page is made writable and the write retried,
+*       like a guard page firing once. Any other fault goes to the previous handler.
+**************************************************************************************************
+*/
+void MdoManager::SignalHandler(int signal, siginfo_t* pInfo, void* pContext)
+{
+    if ((g_pInstance != nullptr) && (pInfo->si_code == SEGV_ACCERR))
+    {
+        const UINT64 pageSize = g_pInstance->m_pageSize;
+
+        // The whole page becomes writable, so track it from its start
+        const UINT64 pageBegin = (UINT64)pInfo->si_addr & ~(pageSize - 1);
+
+        if (g_pInstance->ExceptionFilter(pageBegin) == true)
+        {
+            mprotect((void*)pageBegin, (size_t)pageSize, PROT_READ | PROT_WRITE);
+            return;
+        }
+    }
+
+    if ((g_prevSegvAction.sa_flags & SA_SIGINFO) != 0)
+    {
+        if (g_prevSegvAction.sa_sigaction != nullptr)
+        {
+            g_prevSegvAction.sa_sigaction(signal, pInfo, pContext);
+        }
+    }
+    else if (g_prevSegvAction.sa_handler == SIG_DFL)
+    {
+        // Returning retries the faulting instruction, which now gets the default behavior
+        sigaction(SIGSEGV, &g_prevSegvAction, nullptr);
+    }
+    else if (g_prevSegvAction.sa_handler != SIG_IGN)
+    {
+        g_prevSegvAction.sa_handler(signal);
+    }
+}
+
+/**
+**************************************************************************************************
+*   MdoManager::InstallSignalHandler
+*
+*   @brief
+*       Install the SIGSEGV handler that tracks writes to guarded memory. The handler runs on
+*       an alternate signal stack if the faulting thread has one, and one is set up for the
+*       calling thread if it doesn't already have one. Signal stacks are per thread, and other
+*       threads can't be given one from here, so on them the handler runs on the faulting
+*       thread's own stack. That is fine for writes to guarded memory, which need very little
+*       stack. Only a stack overflow, which is passed on to the previous handler, needs the
+*       alternate stack, and that is left to whoever installed that handler.
+*
+*   @return
+*       True if successful
+**************************************************************************************************
+*/
+bool MdoManager::InstallSignalHandler()
+{
+    stack_t currStack = {};
+
+    if ((sigaltstack(nullptr, &currStack) == 0) && ((currStack.ss_flags & SS_DISABLE) != 0))
+    {
+        // Intentionally never freed, since the handler may run at any time after this
+        stack_t altStack = {};
+        altStack.ss_size = SIGSTKSZ;
+        altStack.ss_sp = new char[altStack.ss_size];
+        altStack.ss_flags = 0;
+
+        sigaltstack(&altStack, nullptr);
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = &MdoManager::SignalHandler;
+    action.sa_flags = SA_SIGINFO | SA_ONSTACK;
+    sigemptyset(&action.sa_mask);
+
+    return (sigaction(SIGSEGV, &action, &g_prevSegvAction) == 0);
+}
+#endif
 
 /**
 **************************************************************************************************
@@ -61,9 +153,13 @@ LONG WINAPI MdoManager::ExceptionFilter(_EXCEPTION_POINTERS* pException)
 *   @brief
 *       This logic determines and tracks the dirty range within a resource.
 *       It is specific to the current page that this exception landed in.
+*       It runs inside the signal handler on Linux, so it must not allocate or take locks.
+*
+*   @return
+*       True if the address is in a guarded resource
 **************************************************************************************************
 */
-void MdoManager::ExceptionFilter(UINT64 exceptionAddress)
+bool MdoManager::ExceptionFilter(UINT64 exceptionAddress)
 {
     MdoResource* pHomeResource = m_pResourceCache->FindResource(exceptionAddress);
 
@@ -106,8 +202,10 @@ void MdoManager::ExceptionFilter(UINT64 exceptionAddress)
         dirty.size = dirtyBytes;
         dirty.pData = nullptr;
 
-        pHomeResource->TrackDirtyPage(dirty);
+        pHomeResource->RecordDirtyPage(dirty);
     }
+
+    return (pHomeResource != nullptr);
 }
 
 /**
@@ -130,13 +228,15 @@ bool MdoManager::Init(const MdoConfig& mdoConfig)
     {
         if (mdoConfig.bypassExceptionFiltering == false)
         {
+#ifdef _WIN32
             AddVectoredExceptionHandler(1, &MdoManager::ExceptionFilter);
             //SetUnhandledExceptionFilter(&MdoManager::ExceptionFilter);
+#else
+            InstallSignalHandler();
+#endif
         }
 
-        SYSTEM_INFO si;
-        GetSystemInfo(&si);
-        m_pageSize = si.dwPageSize;
+        m_pageSize = MdoUtil::GetPageSize();
 
         memcpy(&m_mdoConfig, &mdoConfig, sizeof(mdoConfig));
 
@@ -21,7 +21,11 @@ class MdoStats;
 class MdoManager
 {
 public:
+#ifdef _WIN32
     static LONG WINAPI ExceptionFilter(_EXCEPTION_POINTERS* pException);
+#else
+    static void SignalHandler(int signal, siginfo_t* pInfo, void* pContext);
+#endif
     static MdoManager* Instance();
 
     ~MdoManager() {}
@@ -38,7 +42,7 @@ public:
     void TrackDestroy(UINT64 resHandle);
 
     // Hold our exception filter logic
-    void ExceptionFilter(UINT64 exceptionAddress);
+    bool ExceptionFilter(UINT64 exceptionAddress);
 
     // Create per-API resource cache
     virtual MdoResourceCache* CreateResourceCache(const MdoConfig& mdoConfig)
@@ -49,6 +53,9 @@ public:
 
 protected:
     bool Init(const MdoConfig& mdoConfig);
+#ifndef _WIN32
+    bool InstallSignalHandler();
+#endif
     MdoManager() : m_pResourceCache(nullptr), m_pMdoStats(nullptr), m_pageSize(0) {}
 
 private:
@@ -10,7 +10,9 @@
 
 #include "mdoResource.h"
 
+#include "mdoResourceCache.h"
 #include "mdoStats.h"
+#include "mdoVersionedStorage.h"
 
 /**
 **************************************************************************************************
@@ -21,11 +23,16 @@
 **************************************************************************************************
 */
 MdoResource::MdoResource() :
+    m_state(MDO_STATE_CAPTURE_START),
     m_captureMapId(-1),
     m_playbackMapId(0),
-    m_state(MDO_STATE_CAPTURE_START),
     m_size(0),
-    m_activeMappedCount(0)
+    m_activeMappedCount(0),
+    m_pPlaybackImage(nullptr),
+    m_playbackImageMapId(-1),
+    m_pRecordedDirtyPages(nullptr),
+    m_recordedDirtyPageCapacity(0),
+    m_recordedDirtyPageCount(0)
 {
     memset(&m_createInfo, 0, sizeof(m_createInfo));
     memset(&m_reflectionData, 0, sizeof(m_reflectionData));
@@ -56,11 +63,24 @@ MdoResource::~MdoResource()
 void MdoResource::NewReflectionData()
 {
     m_reflectionData.pReferenceData = new unsigned char[m_size];
-    m_reflectionData.pNewData = new unsigned char[m_size];
+    m_reflectionData.pNewData = MdoUtil::AllocGuardableMem(m_size);
+
+    // Each page faults at most once per guard. The memory needn't start on a page boundary,
+    // so it may touch one more page than its size suggests.
+    const UINT32 pageSize = MdoUtil::GetPageSize();
+
+    m_recordedDirtyPageCapacity = ((m_size + pageSize - 1) / pageSize) + 1;
+    m_pRecordedDirtyPages = new RecordedDirtyPage[m_recordedDirtyPageCapacity];
+    m_recordedDirtyPageCount = 0;
+
+    for (UINT32 i = 0; i < m_recordedDirtyPageCapacity; i++)
+    {
+        m_pRecordedDirtyPages[i].ready.store(false, std::memory_order_relaxed);
+    }
 
     if (m_createInfo.mdoConfig.deltaStorage == MDO_DELTA_STORAGE_PER_BYTE)
     {
-        m_reflectionData.pHistories = new SlotHistories[m_size];
+        m_reflectionData.pVersionedStorage = new MdoVersionedStorage(m_size);
     }
 
     memset(m_reflectionData.pReferenceData, 0, m_size);
@@ -78,11 +98,17 @@ void MdoResource::NewReflectionData()
 void MdoResource::DeleteReflectionData()
 {
     MDO_SAFE_DELETE_ARRAY(m_reflectionData.pReferenceData);
-    MDO_SAFE_DELETE_ARRAY(m_reflectionData.pNewData);
+
+    MdoUtil::FreeGuardableMem(m_reflectionData.pNewData, m_size);
+    m_reflectionData.pNewData = nullptr;
+
+    MDO_SAFE_DELETE_ARRAY(m_pRecordedDirtyPages);
+    m_recordedDirtyPageCapacity = 0;
+    m_recordedDirtyPageCount = 0;
 
     if (m_createInfo.mdoConfig.deltaStorage == MDO_DELTA_STORAGE_PER_BYTE)
     {
-        MDO_SAFE_DELETE_ARRAY(m_reflectionData.pHistories);
+        MDO_SAFE_DELETE(m_reflectionData.pVersionedStorage);
     }
 }
 
@@ -163,9 +189,9 @@ void MdoResource::NewUnmapEvent()
 *   MdoResource::CalcDeltaRegionsPerByteStorage
 *
 *   @brief
-*       This method delta storage works by storing a delta history for each byte in the buffer.
-*       Whenever a byte changes, a new "history" element is added for the current byte.
-*       The history element contains a record of the map number and new data.
+*       This method delta storage works by storing a version history for each chunk of the buffer.
+*       Whenever a chunk changes, a copy of the chunk is added to its history, tagged with the
+*       current map number. Memory therefore grows with the number of changed chunks.
 **************************************************************************************************
 */
 void MdoResource::CalcDeltaRegionsPerByteStorage()
@@ -177,45 +203,15 @@ void MdoResource::CalcDeltaRegionsPerByteStorage()
         memcpy(currMapEvent.pAppMapMirror, m_reflectionData.pNewData, m_size);
     }
 
-    // On the first map, we always want the full buffer
-    if (m_captureMapId == 0)
-    {
-        for (UINT32 i = 0; i < m_size; i++)
-        {
-            SlotHistory newHistory;
-            newHistory.mapId = m_captureMapId;
-            newHistory.data = m_reflectionData.pNewData[i];
+    MdoStats::StartCpuTimer();
 
-            m_reflectionData.pHistories[i].push_back(newHistory);
-        }
-    }
+    m_reflectionData.pVersionedStorage->RecordMap(
+        m_captureMapId,
+        m_reflectionData.pNewData,
+        m_reflectionData.pReferenceData,
+        currMapEvent.dirtyPages);
 
-    // Not the first map on this capture run
-    else
-    {
-        // Go through all pages
-        for (UINT32 i = 0; i < currMapEvent.dirtyPages.size(); i++)
-        {
-            DataChunks& dirtyPages = currMapEvent.dirtyPages;
-            DataChunk& currPage = dirtyPages[i];
-
-            const UINT32 pageBoundary = currPage.offset + currPage.size;
-
-            // Check all bytes of current dirty page
-            for (UINT32 j = currPage.offset; j < pageBoundary; j++)
-            {
-                // Add a new byte history element if there was a change
-                if (m_reflectionData.pNewData[j] != m_reflectionData.pReferenceData[j])
-                {
-                    SlotHistory newHistory;
-                    newHistory.mapId = m_captureMapId;
-                    newHistory.data = m_reflectionData.pNewData[j];
-
-                    m_reflectionData.pHistories[j].push_back(newHistory);
-                }
-            }
-        }
-    }
+    MdoStats::StopCpuTimer("Record versioned map delta");
 }
 
 /**
@@ -311,7 +307,162 @@ void MdoResource::CalcDeltaRegionsPerMapStorage()
 
             m_accumDeltas[m_captureMapId].push_back(currDelta1);
         }
+
+        if ((m_captureMapId % MDO_CHECKPOINT_INTERVAL) == 0)
+        {
+            StoreCheckpoint();
+        }
+    }
+}
+
+/**
+**************************************************************************************************
+*   MdoResource::StoreCheckpoint
+*
+*   @brief
+*       Keep a full copy of the resource as of the current map, so that playback can start
+*       from here instead of from the first map. The checkpoint budget is shared by every
+*       resource, so storing one may evict an older checkpoint from this or another resource.
+**************************************************************************************************
+*/
+void MdoResource::StoreCheckpoint()
+{
+    MdoResourceCache* pResourceCache = MdoResourceCache::Instance();
+
+    if ((pResourceCache != nullptr) && (pResourceCache->ReserveCheckpoint(m_size) == true))
+    {
+        unsigned char* pCheckpoint = new unsigned char[m_size];
+        MdoStats::TrackHeapAlloc(m_size, pCheckpoint);
+
+        memcpy(pCheckpoint, m_reflectionData.pNewData, m_size);
+
+        m_checkpoints[m_captureMapId] = pCheckpoint;
+    }
+}
+
+/**
+**************************************************************************************************
+*   MdoResource::EvictOldestCheckpoint
+*
+*   @brief
+*       Free the checkpoint with the lowest map id, to make room in the checkpoint budget.
+*       Playback still works without it, by applying the deltas from an earlier point.
+*
+*   @return
+*       True if a checkpoint was evicted
+**************************************************************************************************
+*/
+bool MdoResource::EvictOldestCheckpoint()
+{
+    if (m_checkpoints.empty() == true)
+    {
+        return false;
+    }
+
+    MapCheckpoints::iterator oldest = m_checkpoints.begin();
+
+    MdoStats::TrackHeapFree(oldest->second);
+    delete [] oldest->second;
+
+    m_checkpoints.erase(oldest);
+
+    MdoResourceCache* pResourceCache = MdoResourceCache::Instance();
+
+    if (pResourceCache != nullptr)
+    {
+        pResourceCache->ReleaseCheckpoint(m_size);
+    }
+
+    return true;
+}
+
+/**
+**************************************************************************************************
+*   MdoResource::RebuildPlaybackImage
+*
+*   @brief
+*       Bring the playback image up to the contents of the given map. Moving forward only
+*       applies the deltas of the maps in between, which is a single map's delta during normal
+*       playback. Moving backwards starts again from the nearest checkpoint at or before the map.
+**************************************************************************************************
+*/
+void MdoResource::RebuildPlaybackImage(int mapId)
+{
+    if (m_pPlaybackImage == nullptr)
+    {
+        m_pPlaybackImage = new unsigned char[m_size];
+        MdoStats::TrackHeapAlloc(m_size, m_pPlaybackImage);
+
+        m_playbackImageMapId = -1;
+    }
+
+    if (mapId == m_playbackImageMapId)
+    {
+        return;
+    }
+
+    int firstMapId = (mapId > m_playbackImageMapId) ? (m_playbackImageMapId + 1) : 0;
+
+    // Start from a checkpoint if it saves applying some deltas
+    MapCheckpoints::iterator checkpoint = m_checkpoints.upper_bound(mapId);
+
+    if (checkpoint != m_checkpoints.begin())
+    {
+        checkpoint--;
+
+        if (checkpoint->first >= firstMapId)
+        {
+            memcpy(m_pPlaybackImage, checkpoint->second, m_size);
+            firstMapId = checkpoint->first + 1;
+        }
+    }
+
+    if (firstMapId == 0)
+    {
+        memset(m_pPlaybackImage, 0, m_size);
+    }
+
+    // Write out the delta ranges of each map after the starting point, up to the current map id
+    for (OrderedAccumDeltas::iterator it = m_accumDeltas.lower_bound(firstMapId); it != m_accumDeltas.end(); it++)
+    {
+        if (it->first > mapId)
+        {
+            break;
+        }
+
+        DataChunks& currChunks = it->second;
+
+        for (UINT32 i = 0; i < currChunks.size(); i++)
+        {
+            memcpy(m_pPlaybackImage + currChunks[i].offset, currChunks[i].pData, (size_t)currChunks[i].size);
+        }
     }
+
+    m_playbackImageMapId = mapId;
+}
+
+/**
+**************************************************************************************************
+*   MdoResource::DeletePlaybackData
+*
+*   @brief
+*       Free the per-map checkpoints and the playback image
+**************************************************************************************************
+*/
+void MdoResource::DeletePlaybackData()
+{
+    while (m_checkpoints.empty() == false)
+    {
+        EvictOldestCheckpoint();
+    }
+
+    if (m_pPlaybackImage != nullptr)
+    {
+        MdoStats::TrackHeapFree(m_pPlaybackImage);
+        MDO_SAFE_DELETE_ARRAY(m_pPlaybackImage);
+    }
+
+    m_playbackImageMapId = -1;
 }
 
 /**
@@ -326,6 +477,8 @@ void MdoResource::CalcDeltaRegions()
 {
     MDO_ASSERT(m_captureMapId >= 0);
 
+    FoldRecordedDirtyPages();
+
     if (m_createInfo.mdoConfig.deltaStorage == MDO_DELTA_STORAGE_PER_BYTE)
     {
         CalcDeltaRegionsPerByteStorage();
@@ -368,62 +521,26 @@ bool MdoResource::UploadMapDelta()
             // Per-byte delta storage method
             if (m_createInfo.mdoConfig.deltaStorage == MDO_DELTA_STORAGE_PER_BYTE)
             {
-                char* pDriverLoc = nullptr;
+                MdoStats::StartCpuTimer();
 
-                // For each byte in the buffer...
-                for (UINT32 i = 0; i < m_size; i++)
-                {
-                    SlotHistories& currHistories = m_reflectionData.pHistories[i];
+                // Only the chunks that changed since the previous map are rebuilt
+                m_reflectionData.pVersionedStorage->Reconstruct(m_playbackMapId, pDriverMem);
 
-                    pDriverLoc = (char*)pDriverMem + i;
-
-                    UINT32 historyIdx = 0;
-
-                    // Identify the correct delta to use
-                    // It must be the latest delta, up until the current map id
-                    for (UINT32 j = 0; j < currHistories.size(); j++)
-                    {
-                        SlotHistory& currHistory = currHistories[j];
-
-                        if ((int)currHistory.mapId <= m_playbackMapId)
-                        {
-                            historyIdx = j;
-                        }
-                        else
-                        {
-                            break;
-                        }
-                    }
-
-                    // Write out the changed byte
-                    *pDriverLoc = currHistories[historyIdx].data;
-                }
+                MdoStats::StopCpuTimer("Reconstruct versioned map");
             }
 
             // Per-map delta storage method
             else
             {
-                memset(pDriverMem, 0, m_size);
+                MdoStats::StartCpuTimer();
 
-                // For each map that happened to this buffer...
-                for (std::map<int, DataChunks>::iterator it = m_accumDeltas.begin(); it != m_accumDeltas.end(); it++)
-                {
-                    // Write out the delta range, up until reaching the current map id
-                    // This will likely write a the byte more than once, so it's not as efficient as the prior method
-                    if (it->first <= m_playbackMapId)
-                    {
-                        DataChunks& currChunks = it->second;
+                // Only the previous map's image plus this map's delta is needed, so playback
+                // stays linear in the number of maps
+                RebuildPlaybackImage(m_playbackMapId);
 
-                        for (UINT32 i = 0; i < currChunks.size(); i++)
-                        {
-                            memcpy((char*)pDriverMem + currChunks[i].offset, currChunks[i].pData, (size_t)currChunks[i].size);
-                        }
-                    }
-                    else
-                    {
-                        break;
-                    }
-                }
+                memcpy(pDriverMem, m_pPlaybackImage, m_size);
+
+                MdoStats::StopCpuTimer("Reconstruct per-map delta");
             }
 
             // For debugging
@@ -455,13 +572,102 @@ bool MdoResource::UploadMapDelta()
     return success;
 }
 
+/**
+**************************************************************************************************
+*   MdoResource::RecordDirtyPage
+*
+*   @brief
+*       This tells the resource that a range of bytes was touched during this map. It gets
+*       called by the OS's exception handler, which may run in signal context, so it only
+*       claims a slot in the preallocated array with a lock-free atomic increment. Once the
+*       page is written, the slot's ready flag is set with release ordering, so the thread that
+*       folds the pages sees the whole page. The pages are folded into the map's dirty pages by
+*       FoldRecordedDirtyPages once the resource is unguarded.
+**************************************************************************************************
+*/
+void MdoResource::RecordDirtyPage(const DataChunk& dirtyPage)
+{
+    const UINT32 slot = m_recordedDirtyPageCount.fetch_add(1, std::memory_order_relaxed);
+
+    // A full array is noticed when folding, which then treats the whole resource as dirty
+    if (slot < m_recordedDirtyPageCapacity)
+    {
+        m_pRecordedDirtyPages[slot].dirtyPage = dirtyPage;
+        m_pRecordedDirtyPages[slot].ready.store(true, std::memory_order_release);
+    }
+}
+
+/**
+**************************************************************************************************
+*   MdoResource::FoldRecordedDirtyPages
+*
+*   @brief
+*       Move the pages recorded by the exception handler into the current map's dirty pages.
+*       Called once the memory is unguarded, so no more slots are claimed. A handler on another
+*       thread may have claimed a slot just before the unguard, so each slot is only read once
+*       its ready flag is set, and the flag is cleared for the next map.
+**************************************************************************************************
+*/
+void MdoResource::FoldRecordedDirtyPages()
+{
+    const UINT32 recordedCount = m_recordedDirtyPageCount.exchange(0, std::memory_order_acquire);
+    const bool overflowed = (recordedCount > m_recordedDirtyPageCapacity);
+    const UINT32 slotCount = overflowed ? m_recordedDirtyPageCapacity : recordedCount;
+
+    for (UINT32 i = 0; i < slotCount; i++)
+    {
+        // The handler that claimed the slot is at most a few instructions from setting the flag
+        while (m_pRecordedDirtyPages[i].ready.load(std::memory_order_acquire) == false)
+        {
+            MdoUtil::YieldThread();
+        }
+
+        m_pRecordedDirtyPages[i].ready.store(false, std::memory_order_relaxed);
+
+        if (overflowed == false)
+        {
+            TrackDirtyPage(m_pRecordedDirtyPages[i].dirtyPage);
+        }
+    }
+
+    if (overflowed)
+    {
+        DataChunk fullResource;
+        fullResource.offset = 0;
+        fullResource.size = m_size;
+        fullResource.pData = nullptr;
+
+        TrackDirtyPage(fullResource);
+    }
+}
+
+/**
+**************************************************************************************************
+*   MdoResource::DropRecordedDirtyPages
+*
+*   @brief
+*       Forget the pages recorded by the exception handler without tracking them. Only called
+*       while the memory isn't guarded, so no handler is writing a slot.
+**************************************************************************************************
+*/
+void MdoResource::DropRecordedDirtyPages()
+{
+    const UINT32 recordedCount = m_recordedDirtyPageCount.exchange(0, std::memory_order_acquire);
+    const UINT32 slotCount = (recordedCount > m_recordedDirtyPageCapacity) ? m_recordedDirtyPageCapacity : recordedCount;
+
+    for (UINT32 i = 0; i < slotCount; i++)
+    {
+        m_pRecordedDirtyPages[i].ready.store(false, std::memory_order_relaxed);
+    }
+}
+
 /**
 **************************************************************************************************
 *   MdoResource::TrackDirtyPage
 *
 *   @brief
 *       This tells the resource that the a range of bytes was touched during this map.
-*       It gets called by the OS's exception handler.
+*       Not safe to call from the OS's exception handler, which uses RecordDirtyPage instead.
 **************************************************************************************************
 */
 void MdoResource::TrackDirtyPage(const DataChunk& dirtyPage)
@@ -518,14 +724,16 @@ void MdoResource::ResetMapEvents()
 
     if (m_createInfo.mdoConfig.deltaStorage == MDO_DELTA_STORAGE_PER_BYTE)
     {
-        for (UINT32 i = 0; i < m_size; i++)
+        if (m_reflectionData.pVersionedStorage != nullptr)
         {
-            m_reflectionData.pHistories[i].clear();
+            m_reflectionData.pVersionedStorage->Reset();
         }
     }
     else
     {
         m_accumDeltas.clear();
+
+        DeletePlaybackData();
     }
 
     m_mapData.clear();
@@ -553,9 +761,34 @@ bool MdoResource::Guard()
     {
         if (m_activeMappedCount == 1)
         {
+            MdoResourceCache* pResourceCache = MdoResourceCache::Instance();
+
+            // Drop pages left over from a map that was never unguarded
+            DropRecordedDirtyPages();
+
+            // Index first, since the app may touch the memory as soon as it is guarded
+            if (pResourceCache != nullptr)
+            {
+                pResourceCache->IndexGuardedResource(this);
+            }
+
+#ifdef _WIN32
             DWORD oldProtect = 0;
             result = VirtualProtect(m_reflectionData.pNewData, m_size, PAGE_READWRITE | PAGE_GUARD, &oldProtect);
+#else
+            // Without page guards, write-protect the memory. The signal handler unprotects each page
+            // as it is first written, which matches a guard page firing once. The kernel doesn't
+            // raise a signal for its own writes, so a system call that writes into the memory,
+            // such as read() into a mapped pointer, fails with EFAULT instead. Apps that do that
+            // need bypassExceptionFiltering.
+            result = (mprotect(m_reflectionData.pNewData, m_size, PROT_READ) == 0) ? TRUE : FALSE;
+#endif
             MDO_ASSERT(result == TRUE);
+
+            if ((result != TRUE) && (pResourceCache != nullptr))
+            {
+                pResourceCache->UnindexResource(this);
+            }
         }
     }
     else
@@ -585,9 +818,20 @@ bool MdoResource::Unguard()
     {
         if (m_activeMappedCount == 1)
         {
+#ifdef _WIN32
             DWORD oldProtect = 0;
             result = VirtualProtect(m_reflectionData.pNewData, m_size, PAGE_READWRITE, &oldProtect);
+#else
+            result = (mprotect(m_reflectionData.pNewData, m_size, PROT_READ | PROT_WRITE) == 0) ? TRUE : FALSE;
+#endif
             MDO_ASSERT(result == TRUE);
+
+            MdoResourceCache* pResourceCache = MdoResourceCache::Instance();
+
+            if ((result == TRUE) && (pResourceCache != nullptr))
+            {
+                pResourceCache->UnindexResource(this);
+            }
         }
     }
     else
@@ -13,6 +13,16 @@
 
 #include "mdoUtil.h"
 
+#include <atomic>
+
+// A dirty page recorded by the exception filter. ready is set once the page has been written,
+// so the page can be read by another thread.
+struct RecordedDirtyPage
+{
+    DataChunk         dirtyPage;
+    std::atomic<bool> ready;
+};
+
 class MdoResource
 {
 public:
@@ -36,6 +46,7 @@ public:
     void NewReflectionData();
     void UpdateReferenceData();
 
+    void RecordDirtyPage(const DataChunk& dirtyPage);
     void TrackDirtyPage(const DataChunk& deltaData);
     void ResetMapEvents();
 
@@ -46,12 +57,22 @@ public:
 
     bool OriginalMapSuccessful();
 
+    UINT64 CheckpointByteSize() { return (UINT64)m_checkpoints.size() * m_size; }
+    bool EvictOldestCheckpoint();
+
 protected:
     MdoResource();
 
     void CalcDeltaRegionsPerByteStorage();
     void CalcDeltaRegionsPerMapStorage();
 
+    void StoreCheckpoint();
+    void RebuildPlaybackImage(int mapId);
+    void DeletePlaybackData();
+
+    void FoldRecordedDirtyPages();
+    void DropRecordedDirtyPages();
+
     MdoState              m_state;
     MdoResourceCreateInfo m_createInfo;
     ReflectionData        m_reflectionData;
@@ -62,6 +83,15 @@ protected:
     int                   m_playbackMapId;
     UINT32                m_size;
     int                   m_activeMappedCount;
+
+    MapCheckpoints        m_checkpoints;
+    unsigned char*        m_pPlaybackImage;
+    int                   m_playbackImageMapId;
+
+    // Filled in by the exception filter, and folded into m_mapData when the resource is unmapped
+    RecordedDirtyPage*    m_pRecordedDirtyPages;
+    UINT32                m_recordedDirtyPageCapacity;
+    std::atomic<UINT32>   m_recordedDirtyPageCount;
 };
 
 #endif
\ No newline at end of file
@@ -83,6 +83,8 @@ bool MdoResourceCache::UnregisterResource(UINT64 resHandle)
 
     if (pMdoResource != nullptr)
     {
+        UnindexResource(pMdoResource);
+
         pMdoResource->ResetMapEvents();
 
         delete pMdoResource;
@@ -142,6 +144,8 @@ void MdoResourceCache::TrackCreate(UINT64 resHandle)
     // Resource already present, so our pMdoResource must now use new data
     if (pResource != nullptr)
     {
+        UnindexResource(pResource);
+
         pResource->DeleteReflectionData();
         pResource->NewReflectionData();
     }
@@ -163,6 +167,8 @@ void MdoResourceCache::TrackDestroy(UINT64 resHandle)
     // Resource was delete it, so give back our MdoResource mem
     if (pResource != nullptr)
     {
+        UnindexResource(pResource);
+
         pResource->DeleteReflectionData();
     }
 }
@@ -190,32 +196,111 @@ void MdoResourceCache::ResetResources()
 
 /**
 **************************************************************************************************
-*   MdoResourceCache::FindResource
+*   MdoResourceCache::ReserveCheckpoint
 *
 *   @brief
-*       Locate a resource in the cache, given a memory location
+*       Make room in the checkpoint budget for a new checkpoint. While the budget is full, the
+*       oldest checkpoint of whichever resource holds the most checkpoint memory is evicted.
+*       The oldest checkpoints are the cheapest to lose, since playback can start from the first
+*       map instead. The resource asking for room may lose one of its own.
 *
 *   @return
-*       An MdoResource ptr
+*       True if the checkpoint fits in the budget
 **************************************************************************************************
 */
-MdoResource* MdoResourceCache::FindResource(UINT64 exceptionAddr)
+bool MdoResourceCache::ReserveCheckpoint(UINT32 size)
 {
-    MdoResource* pOut = nullptr;
+    if (size > MDO_CHECKPOINT_BUDGET)
+    {
+        return false;
+    }
 
-    for (ResourceMap::iterator it = m_resourceList.begin(); it != m_resourceList.end(); it++)
+    while ((m_checkpointBytes + size) > MDO_CHECKPOINT_BUDGET)
     {
-        MdoResource* pCurrResource = it->second;
+        MdoResource* pLargest = nullptr;
 
-        const UINT64 start = (UINT64)pCurrResource->GetReflectionData()->pNewData;
-        const UINT64 end = start + pCurrResource->ResourceByteSize();
+        for (ResourceMap::iterator it = m_resourceList.begin(); it != m_resourceList.end(); it++)
+        {
+            MdoResource* pCurrResource = it->second;
 
-        if ((exceptionAddr >= start) && (exceptionAddr < end))
+            if ((pCurrResource != nullptr) &&
+                ((pLargest == nullptr) || (pCurrResource->CheckpointByteSize() > pLargest->CheckpointByteSize())))
+            {
+                pLargest = pCurrResource;
+            }
+        }
+
+        // EvictOldestCheckpoint releases the evicted bytes
+        if ((pLargest == nullptr) || (pLargest->EvictOldestCheckpoint() == false))
         {
-            pOut = pCurrResource;
-            break;
+            return false;
         }
     }
 
-    return pOut;
+    m_checkpointBytes += size;
+
+    return true;
+}
+
+/**
+**************************************************************************************************
+*   MdoResourceCache::ReleaseCheckpoint
+*
+*   @brief
+*       Return a freed checkpoint's memory to the checkpoint budget
+**************************************************************************************************
+*/
+void MdoResourceCache::ReleaseCheckpoint(UINT32 size)
+{
+    MDO_ASSERT(m_checkpointBytes >= size);
+
+    m_checkpointBytes -= size;
+}
+
+/**
+**************************************************************************************************
+*   MdoResourceCache::FindResource
+*
+*   @brief
+*       Locate a guarded resource in the cache, given a memory location.
+*       Called from the exception filter, so this only searches the address index, which
+*       takes no locks.
+*
+*   @return
+*       An MdoResource ptr
+**************************************************************************************************
+*/
+MdoResource* MdoResourceCache::FindResource(UINT64 exceptionAddr)
+{
+    return m_guardedRanges.Find(exceptionAddr);
+}
+
+/**
+**************************************************************************************************
+*   MdoResourceCache::IndexGuardedResource
+*
+*   @brief
+*       Add a resource's reflection memory to the address index. Must be called before the
+*       memory is guarded, so that the first exception can find the resource.
+**************************************************************************************************
+*/
+void MdoResourceCache::IndexGuardedResource(MdoResource* pResource)
+{
+    const UINT64 start = (UINT64)pResource->GetReflectionData()->pNewData;
+
+    m_guardedRanges.Insert(start, pResource->ResourceByteSize(), pResource);
+}
+
+/**
+**************************************************************************************************
+*   MdoResourceCache::UnindexResource
+*
+*   @brief
+*       Remove a resource from the address index, once its memory is no longer guarded or is
+*       about to be freed
+**************************************************************************************************
+*/
+void MdoResourceCache::UnindexResource(MdoResource* pResource)
+{
+    m_guardedRanges.Remove(pResource);
 }
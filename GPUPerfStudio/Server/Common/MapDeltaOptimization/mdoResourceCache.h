@@ -10,6 +10,7 @@
 #define __MDO_RESOURCE_CACHE_H__
 
 #include "mdoUtil.h"
+#include "mdoAddressIndex.h"
 
 class MdoResourceCache
 {
@@ -25,9 +26,17 @@ public:
 
     MdoResource* FindResource(UINT64 exceptionAddr);
 
+    // Keep the guarded ranges searched by FindResource up to date
+    void IndexGuardedResource(MdoResource* pResource);
+    void UnindexResource(MdoResource* pResource);
+
+    // Share MDO_CHECKPOINT_BUDGET between all resources
+    bool ReserveCheckpoint(UINT32 size);
+    void ReleaseCheckpoint(UINT32 size);
+
 protected:
     bool Init(const MdoConfig& mdoConfig);
-    MdoResourceCache() {}
+    MdoResourceCache() : m_checkpointBytes(0) {}
 
     virtual MdoResource* RegisterResource(void* pDevice, UINT64 resHandle)
     {
@@ -39,8 +48,10 @@ protected:
     bool UnregisterResource(UINT64 resHandle);
     bool ResHandleExists(UINT64 resHandle);
 
-    MdoConfig   m_mdoConfig;
-    ResourceMap m_resourceList;
+    MdoConfig       m_mdoConfig;
+    ResourceMap     m_resourceList;
+    MdoAddressIndex m_guardedRanges;
+    UINT64          m_checkpointBytes;
 };
 
 #endif
\ No newline at end of file
@@ -46,6 +46,16 @@ void MdoStats::TrackHeapFree(void* pMem)
     if (g_pInstance != nullptr) { g_pInstance->TrackFree(pMem); }
 }
 
+void MdoStats::TrackVersionedStorageAlloc(UINT64 numBytes)
+{
+    if (g_pInstance != nullptr) { g_pInstance->TrackVersionedStorage(numBytes, 0); }
+}
+
+void MdoStats::TrackVersionedStorageFree(UINT64 numBytes)
+{
+    if (g_pInstance != nullptr) { g_pInstance->TrackVersionedStorage(0, numBytes); }
+}
+
 void MdoStats::StartCpuTimer()
 {
     if (g_pInstance != nullptr) { g_pInstance->StartTimer(); }
@@ -64,7 +74,7 @@ void MdoStats::StopCpuTimer(const std::string& desc)
 *       Create MdoStats object
 **************************************************************************************************
 */
-MdoStats::MdoStats(const MdoConfig& mdoConfig) : m_totalConsumption(0)
+MdoStats::MdoStats(const MdoConfig& mdoConfig) : m_totalConsumption(0), m_versionedStorageBytes(0)
 {
     memcpy(&m_mdoConfig, &mdoConfig, sizeof(mdoConfig));
 }
@@ -120,6 +130,30 @@ void MdoStats::TrackFree(void* pMem)
     }
 }
 
+/**
+**************************************************************************************************
+*   MdoStats::TrackVersionedStorage
+*
+*   @brief
+*       Track the bytes held by versioned storage across all resources, including the chunk
+*       bookkeeping that the heap allocations don't show
+**************************************************************************************************
+*/
+void MdoStats::TrackVersionedStorage(UINT64 allocBytes, UINT64 freeBytes)
+{
+    if (m_mdoConfig.dbgMdoSpaceUsage == true)
+    {
+        m_versionedStorageBytes += allocBytes;
+        m_versionedStorageBytes -= freeBytes;
+
+        std::stringstream s;
+        s << "VersionedStorage" << ((freeBytes > 0) ? "Free(" : "Alloc(") << ((freeBytes > 0) ? freeBytes : allocBytes)
+          << ") ... Running total: " << MdoUtil::FormatWithCommas(m_versionedStorageBytes) << " bytes";
+
+        MdoUtil::PrintLn(s.str().c_str());
+    }
+}
+
 /**
 **************************************************************************************************
 *   MdoStats::StartTimer
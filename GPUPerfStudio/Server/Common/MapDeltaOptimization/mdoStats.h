@@ -18,11 +18,14 @@ public:
 
     static void TrackHeapAlloc(UINT32 numBytes, void* pMem);
     static void TrackHeapFree(void* pMem);
+    static void TrackVersionedStorageAlloc(UINT64 numBytes);
+    static void TrackVersionedStorageFree(UINT64 numBytes);
     static void StartCpuTimer();
     static void StopCpuTimer(const std::string& desc);
 
     void TrackAlloc(UINT32 numBytes, void* pMem);
     void TrackFree(void* pMem);
+    void TrackVersionedStorage(UINT64 allocBytes, UINT64 freeBytes);
     void StartTimer();
     double StopTimer(const std::string& desc);
 
@@ -34,6 +37,7 @@ private:
     MdoConfig                         m_mdoConfig;
     std::unordered_map<void*, UINT32> m_allocSizes;
     UINT32                            m_totalConsumption;
+    UINT64                            m_versionedStorageBytes;
     MdoTimer                          m_timer;
 };
 
@@ -10,7 +10,7 @@
 #include "mdoUtil.h"
 
 // For logging/debugging
-std::string MdoUtil::FormatWithCommas(UINT32 value)
+std::string MdoUtil::FormatWithCommas(UINT64 value)
 {
     std::stringstream ss;
     ss.imbue(std::locale(""));
@@ -130,3 +130,52 @@ void MdoUtil::DumpFileToDiskArray(
     delete[] pBuffer;
     pBuffer = NULL;
 };
+
+// The OS page size, which is the granularity of page guarding
+UINT32 MdoUtil::GetPageSize()
+{
+#ifdef _WIN32
+    SYSTEM_INFO si;
+    GetSystemInfo(&si);
+    return si.dwPageSize;
+#else
+    return (UINT32)sysconf(_SC_PAGESIZE);
+#endif
+}
+
+// Allocate memory that can be page guarded without guarding anything else
+unsigned char* MdoUtil::AllocGuardableMem(UINT32 size)
+{
+#ifdef _WIN32
+    return new unsigned char[size];
+#else
+    // mprotect works on whole pages, so give the memory pages of its own
+    void* pMem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    return (pMem != MAP_FAILED) ? static_cast<unsigned char*>(pMem) : nullptr;
+#endif
+}
+
+// Free memory from AllocGuardableMem
+void MdoUtil::FreeGuardableMem(unsigned char* pMem, UINT32 size)
+{
+#ifdef _WIN32
+    UNREFERENCED_PARAMETER(size);
+    delete [] pMem;
+#else
+    if (pMem != nullptr)
+    {
+        munmap(pMem, size);
+    }
+#endif
+}
+
+// Give the rest of the calling thread's time slice to another thread
+void MdoUtil::YieldThread()
+{
+#ifdef _WIN32
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
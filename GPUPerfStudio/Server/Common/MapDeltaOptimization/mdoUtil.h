@@ -10,8 +10,27 @@
 #ifndef __MDO_UTIL_H__
 #define __MDO_UTIL_H__
 
-#include <windows.h>
-#include <process.h>
+#ifdef _WIN32
+    #include <windows.h>
+    #include <process.h>
+#else
+    #include <pthread.h>
+    #include <sched.h>
+    #include <signal.h>
+    #include <stdio.h>
+    #include <string.h>
+    #include <sys/mman.h>
+    #include <time.h>
+    #include <unistd.h>
+    #include "WinDefs.h"
+    #include "../OSWrappers.h"
+
+    typedef unsigned long long UINT64;
+
+    #ifndef UNREFERENCED_PARAMETER
+        #define UNREFERENCED_PARAMETER(x) (void)(x)
+    #endif
+#endif
 
 #include <string>
 #include <vector>
@@ -20,10 +39,16 @@
 #include <sstream>
 #include <fstream>
 
+#ifdef _WIN32
+    #define MDO_DEBUG_BREAK() __debugbreak()
+#else
+    #define MDO_DEBUG_BREAK() __builtin_trap()
+#endif
+
 #ifdef _DEBUG
-    #define MDO_ASSERT(__expr__) if (!(__expr__)) __debugbreak();
-    #define MDO_ASSERT_ALWAYS() __debugbreak();
-    #define MDO_ASSERT_NOT_IMPLEMENTED() __debugbreak();
+    #define MDO_ASSERT(__expr__) if (!(__expr__)) MDO_DEBUG_BREAK();
+    #define MDO_ASSERT_ALWAYS() MDO_DEBUG_BREAK();
+    #define MDO_ASSERT_NOT_IMPLEMENTED() MDO_DEBUG_BREAK();
 #else
     #define MDO_ASSERT(__expr__)
     #define MDO_ASSERT_ALWAYS()
@@ -40,6 +65,13 @@ enum MdoDeltaStorage
     MDO_DELTA_STORAGE_PER_BYTE,
 };
 
+// With per-map delta storage, a full copy of the resource is kept every this many maps,
+// so that playback can seek backwards without replaying every delta from the first map
+#define MDO_CHECKPOINT_INTERVAL 16
+
+// The most memory that all resources together may use for their per-map checkpoints
+#define MDO_CHECKPOINT_BUDGET (64 * 1024 * 1024)
+
 enum MdoState
 {
     MDO_STATE_CAPTURE_START,
@@ -48,6 +80,7 @@ enum MdoState
 };
 
 class MdoResource;
+class MdoVersionedStorage;
 
 struct MdoConfig
 {
@@ -69,19 +102,11 @@ struct MdoResMapInfo
     void*  pDriverMem;
 };
 
-struct SlotHistory
-{
-    UINT32        mapId;
-    unsigned char data;
-};
-
-typedef std::vector<SlotHistory> SlotHistories;
-
 struct ReflectionData
 {
-    unsigned char* pReferenceData;
-    unsigned char* pNewData;
-    SlotHistories* pHistories;
+    unsigned char*       pReferenceData;
+    unsigned char*       pNewData;
+    MdoVersionedStorage* pVersionedStorage;
 };
 
 struct MdoResourceCreateInfo
@@ -94,8 +119,8 @@ struct MdoResourceCreateInfo
 struct DataChunk
 {
     UINT32 offset;
-    UINT32 size;
-    void*  pData;
+    UINT32         size;
+    unsigned char* pData;
 };
 
 typedef std::vector<DataChunk> DataChunks;
@@ -112,6 +137,7 @@ struct MapEvent
 
 typedef std::unordered_map<int, MapEvent> MapEvents;
 typedef std::map<int, DataChunks> OrderedAccumDeltas;
+typedef std::map<int, unsigned char*> MapCheckpoints;
 typedef std::unordered_map<UINT64, MdoResource*> ResourceMap;
 
 /**
@@ -127,7 +153,7 @@ inline UINT64 Pow2Align(UINT64 val, UINT64 alignment)
 }
 
 // For logging/debugging
-std::string FormatWithCommas(UINT32 value);
+std::string FormatWithCommas(UINT64 value);
 
 // For logging/debugging
 void Print(const char* pStr);
@@ -149,6 +175,18 @@ void DumpFileToDiskArray(
     const std::string& path,
     const std::string& ext,
     UINT32             bytesPerRow);
+
+// The OS page size, which is the granularity of page guarding
+UINT32 GetPageSize();
+
+// Allocate memory that can be page guarded without guarding anything else
+unsigned char* AllocGuardableMem(UINT32 size);
+
+// Free memory from AllocGuardableMem
+void FreeGuardableMem(unsigned char* pMem, UINT32 size);
+
+// Give the rest of the calling thread's time slice to another thread
+void YieldThread();
 }
 
 #define USE_RDTSC 0
@@ -177,6 +215,8 @@ public:
         m_freq = static_cast<double>(freq.QuadPart);
 #endif
 
+#else
+        m_freq = 1000000000.0;
 #endif
     }
 
@@ -192,6 +232,8 @@ public:
         m_startTime = t.QuadPart;
 #endif
 
+#else
+        m_startTime = MonotonicNanoseconds();
 #endif
     }
 
@@ -209,12 +251,23 @@ public:
         endTime = t.QuadPart;
 #endif
 
+#else
+        endTime = MonotonicNanoseconds();
 #endif
 
         return static_cast<double>(endTime - m_startTime) / m_freq;
     }
 
 private:
+#ifndef _WIN32
+    static UINT64 MonotonicNanoseconds()
+    {
+        timespec t = {};
+        clock_gettime(CLOCK_MONOTONIC, &t);
+        return (static_cast<UINT64>(t.tv_sec) * 1000000000) + t.tv_nsec;
+    }
+#endif
+
     void Delay(double delay)
     {
 #ifdef _WIN32
@@ -237,6 +290,8 @@ private:
             }
         }
 
+#else
+        UNREFERENCED_PARAMETER(delay);
 #endif
     }
 
@@ -246,7 +301,8 @@ private:
 
 /**
 **************************************************************************************************
-* @brief A wrapper class to simplify using the OS's CRITICAL_SECTION
+* @brief A wrapper class to simplify using the OS's CRITICAL_SECTION, or a recursive pthread
+*        mutex on other platforms, which behaves the same way
 **************************************************************************************************
 */
 class MdoMutex
@@ -257,7 +313,15 @@ public:
     /// Initializes the critical section so that it can be used
     MdoMutex()
     {
+#ifdef _WIN32
         InitializeCriticalSection(&m_cs);
+#else
+        pthread_mutexattr_t attr;
+        pthread_mutexattr_init(&attr);
+        pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+        pthread_mutex_init(&m_cs, &attr);
+        pthread_mutexattr_destroy(&attr);
+#endif
     }
 
     /// Destructor
@@ -265,24 +329,40 @@ public:
     /// Deletes the critical section
     ~MdoMutex()
     {
+#ifdef _WIN32
         DeleteCriticalSection(&m_cs);
+#else
+        pthread_mutex_destroy(&m_cs);
+#endif
     }
 
     /// Locks the critical section
     void Lock()
     {
+#ifdef _WIN32
         EnterCriticalSection(&m_cs);
+#else
+        pthread_mutex_lock(&m_cs);
+#endif
     }
 
     /// Unlocks the critical section
     void Unlock()
     {
+#ifdef _WIN32
         LeaveCriticalSection(&m_cs);
+#else
+        pthread_mutex_unlock(&m_cs);
+#endif
     }
 
 private:
     /// The underlying critical section object
+#ifdef _WIN32
     CRITICAL_SECTION m_cs;
+#else
+    pthread_mutex_t  m_cs;
+#endif
 };
 
 /// Helper for Mutex class which Enters a critical section in the constructor and Leaves that section in the destructor
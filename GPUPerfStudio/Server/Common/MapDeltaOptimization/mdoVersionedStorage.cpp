@@ -0,0 +1,311 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Versioned storage implementation file for MDO.
+///         Stores every captured map of a resource as copy-on-write chunks,
+///         so memory grows with the bytes that changed rather than with the
+///         size of the resource, and any map can be rebuilt on playback.
+//==============================================================================
+
+#include "mdoVersionedStorage.h"
+
+#include <algorithm>
+
+#include "mdoStats.h"
+
+/**
+**************************************************************************************************
+*   MdoVersionedStorage::MdoVersionedStorage
+*
+*   @brief
+*       Create storage for a resource of the given size. No chunk contents are stored until
+*       the first map is recorded.
+**************************************************************************************************
+*/
+MdoVersionedStorage::MdoVersionedStorage(UINT32 size) :
+    m_size(size),
+    m_chunkCount((size + MDO_VERSIONED_CHUNK_SIZE - 1) / MDO_VERSIONED_CHUNK_SIZE),
+    m_pImage(nullptr),
+    m_imageMapId(-1),
+    m_storedBytes(0)
+{
+    m_chunkVersions.resize(m_chunkCount);
+}
+
+/**
+**************************************************************************************************
+*   MdoVersionedStorage::~MdoVersionedStorage
+*
+*   @brief
+*       Free all stored versions
+**************************************************************************************************
+*/
+MdoVersionedStorage::~MdoVersionedStorage()
+{
+    Reset();
+}
+
+/**
+**************************************************************************************************
+*   MdoVersionedStorage::ChunkByteSize
+*
+*   @brief
+*       The last chunk may be shorter than the others, if the resource size isn't a multiple
+*       of the chunk size.
+*
+*   @return
+*       The number of bytes in the chunk
+**************************************************************************************************
+*/
+UINT32 MdoVersionedStorage::ChunkByteSize(UINT32 chunk) const
+{
+    const UINT32 chunkOffset = chunk * MDO_VERSIONED_CHUNK_SIZE;
+
+    return ((m_size - chunkOffset) < MDO_VERSIONED_CHUNK_SIZE) ? (m_size - chunkOffset) : MDO_VERSIONED_CHUNK_SIZE;
+}
+
+/**
+**************************************************************************************************
+*   MdoVersionedStorage::RecordMap
+*
+*   @brief
+*       Store the chunks that changed in a map. On the first map every chunk is stored.
+*       After that, only chunks that overlap a dirty page and differ from the reference
+*       data are stored. Each map's chunks share one allocation.
+**************************************************************************************************
+*/
+void MdoVersionedStorage::RecordMap(
+    int                  mapId,
+    const unsigned char* pNewData,
+    const unsigned char* pReferenceData,
+    const DataChunks&    dirtyPages)
+{
+    MDO_ASSERT(mapId >= (int)m_mapVersions.size());
+
+    // Maps that weren't recorded, such as a map whose unmap failed, changed nothing
+    while ((int)m_mapVersions.size() < mapId)
+    {
+        MapVersion unchanged;
+        unchanged.pData = nullptr;
+
+        m_mapVersions.push_back(unchanged);
+    }
+
+    m_changedChunks.clear();
+
+    // On the first map, we always want the full buffer
+    if (mapId == 0)
+    {
+        for (UINT32 i = 0; i < m_chunkCount; i++)
+        {
+            m_changedChunks.push_back(i);
+        }
+    }
+    else
+    {
+        // Gather the chunks overlapping the dirty pages. Pages are reported in the order they
+        // were touched, and the first touch in a page needn't be chunk-aligned, so a chunk may
+        // be covered more than once.
+        for (UINT32 i = 0; i < dirtyPages.size(); i++)
+        {
+            const DataChunk& currPage = dirtyPages[i];
+
+            if (currPage.size == 0)
+            {
+                continue;
+            }
+
+            const UINT32 firstChunk = currPage.offset / MDO_VERSIONED_CHUNK_SIZE;
+            const UINT32 lastChunk = (currPage.offset + currPage.size - 1) / MDO_VERSIONED_CHUNK_SIZE;
+
+            for (UINT32 j = firstChunk; (j <= lastChunk) && (j < m_chunkCount); j++)
+            {
+                m_changedChunks.push_back(j);
+            }
+        }
+
+        std::sort(m_changedChunks.begin(), m_changedChunks.end());
+        m_changedChunks.erase(std::unique(m_changedChunks.begin(), m_changedChunks.end()), m_changedChunks.end());
+
+        // Keep only the chunks whose contents actually changed
+        UINT32 changedCount = 0;
+
+        for (UINT32 i = 0; i < m_changedChunks.size(); i++)
+        {
+            const UINT32 chunk = m_changedChunks[i];
+            const UINT32 chunkOffset = chunk * MDO_VERSIONED_CHUNK_SIZE;
+
+            if (memcmp(pNewData + chunkOffset, pReferenceData + chunkOffset, ChunkByteSize(chunk)) != 0)
+            {
+                m_changedChunks[changedCount++] = chunk;
+            }
+        }
+
+        m_changedChunks.resize(changedCount);
+    }
+
+    MapVersion newVersion;
+    newVersion.chunks = m_changedChunks;
+    newVersion.pData = nullptr;
+
+    if (newVersion.chunks.empty() == false)
+    {
+        const UINT32 dataSize = (UINT32)newVersion.chunks.size() * MDO_VERSIONED_CHUNK_SIZE;
+
+        newVersion.pData = new unsigned char[dataSize];
+        MdoStats::TrackHeapAlloc(dataSize, newVersion.pData);
+
+        // Copy each changed chunk, and point the chunk's history at the copy
+        for (UINT32 i = 0; i < newVersion.chunks.size(); i++)
+        {
+            const UINT32 chunk = newVersion.chunks[i];
+
+            ChunkVersion chunkVersion;
+            chunkVersion.mapId = mapId;
+            chunkVersion.pData = newVersion.pData + (i * MDO_VERSIONED_CHUNK_SIZE);
+
+            memcpy(chunkVersion.pData, pNewData + (chunk * MDO_VERSIONED_CHUNK_SIZE), ChunkByteSize(chunk));
+
+            m_chunkVersions[chunk].push_back(chunkVersion);
+        }
+
+        const UINT64 storedBytes = dataSize + (newVersion.chunks.size() * (sizeof(ChunkVersion) + sizeof(UINT32)));
+
+        m_storedBytes += storedBytes;
+        MdoStats::TrackVersionedStorageAlloc(storedBytes);
+    }
+
+    m_mapVersions.push_back(newVersion);
+}
+
+/**
+**************************************************************************************************
+*   MdoVersionedStorage::RebuildImage
+*
+*   @brief
+*       Bring the reconstructed image up to the contents of the given map. Moving forward by
+*       one map only copies that map's changed chunks. Any other move looks up each chunk's
+*       latest version at or before the map.
+**************************************************************************************************
+*/
+void MdoVersionedStorage::RebuildImage(int mapId)
+{
+    if (m_pImage == nullptr)
+    {
+        m_pImage = new unsigned char[m_size];
+        MdoStats::TrackHeapAlloc(m_size, m_pImage);
+
+        // Chunks never written by a recorded map read as zero, matching the reflection data
+        memset(m_pImage, 0, m_size);
+        m_imageMapId = -1;
+    }
+
+    if (mapId == m_imageMapId)
+    {
+        return;
+    }
+
+    if (mapId == m_imageMapId + 1)
+    {
+        const MapVersion& version = m_mapVersions[mapId];
+
+        for (UINT32 i = 0; i < version.chunks.size(); i++)
+        {
+            const UINT32 chunk = version.chunks[i];
+
+            memcpy(m_pImage + (chunk * MDO_VERSIONED_CHUNK_SIZE), version.pData + (i * MDO_VERSIONED_CHUNK_SIZE), ChunkByteSize(chunk));
+        }
+    }
+    else
+    {
+        for (UINT32 chunk = 0; chunk < m_chunkCount; chunk++)
+        {
+            const ChunkVersions& versions = m_chunkVersions[chunk];
+            unsigned char* pDest = m_pImage + (chunk * MDO_VERSIONED_CHUNK_SIZE);
+
+            // Versions are stored in map order, so find the first one after the map
+            ChunkVersions::const_iterator it = std::upper_bound(versions.begin(), versions.end(), mapId,
+                                                                [](int id, const ChunkVersion& version) { return id < version.mapId; });
+
+            if (it != versions.begin())
+            {
+                memcpy(pDest, (it - 1)->pData, ChunkByteSize(chunk));
+            }
+            else
+            {
+                memset(pDest, 0, ChunkByteSize(chunk));
+            }
+        }
+    }
+
+    m_imageMapId = mapId;
+}
+
+/**
+**************************************************************************************************
+*   MdoVersionedStorage::Reconstruct
+*
+*   @brief
+*       Write out the resource contents as they were after the given map. The whole resource
+*       is written, since the memory being written to needn't hold the previous map's contents.
+**************************************************************************************************
+*/
+void MdoVersionedStorage::Reconstruct(int mapId, void* pOut)
+{
+    MDO_ASSERT(mapId >= 0);
+
+    if (m_mapVersions.empty() == true)
+    {
+        memset(pOut, 0, m_size);
+        return;
+    }
+
+    // Maps after the last recorded one changed nothing
+    if (mapId >= (int)m_mapVersions.size())
+    {
+        mapId = (int)m_mapVersions.size() - 1;
+    }
+
+    RebuildImage(mapId);
+
+    memcpy(pOut, m_pImage, m_size);
+}
+
+/**
+**************************************************************************************************
+*   MdoVersionedStorage::Reset
+*
+*   @brief
+*       Free every stored version and the reconstructed image
+**************************************************************************************************
+*/
+void MdoVersionedStorage::Reset()
+{
+    for (UINT32 i = 0; i < m_mapVersions.size(); i++)
+    {
+        MdoStats::TrackHeapFree(m_mapVersions[i].pData);
+        MDO_SAFE_DELETE_ARRAY(m_mapVersions[i].pData);
+    }
+
+    m_mapVersions.clear();
+
+    for (UINT32 i = 0; i < m_chunkCount; i++)
+    {
+        m_chunkVersions[i].clear();
+    }
+
+    if (m_pImage != nullptr)
+    {
+        MdoStats::TrackHeapFree(m_pImage);
+        MDO_SAFE_DELETE_ARRAY(m_pImage);
+    }
+
+    m_imageMapId = -1;
+
+    if (m_storedBytes > 0)
+    {
+        MdoStats::TrackVersionedStorageFree(m_storedBytes);
+        m_storedBytes = 0;
+    }
+}
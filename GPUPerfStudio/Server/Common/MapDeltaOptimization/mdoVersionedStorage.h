@@ -0,0 +1,72 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Versioned storage header file for MDO.
+///         Stores every captured map of a resource as copy-on-write chunks,
+///         so memory grows with the bytes that changed rather than with the
+///         size of the resource, and any map can be rebuilt on playback.
+//==============================================================================
+
+#ifndef __MDO_VERSIONED_STORAGE_H__
+#define __MDO_VERSIONED_STORAGE_H__
+
+#include "mdoUtil.h"
+
+// The granularity at which changes are stored. A changed byte stores its whole chunk.
+#define MDO_VERSIONED_CHUNK_SIZE 256
+
+/**
+**************************************************************************************************
+* @brief A chunk-granular copy-on-write page table of a resource's contents over each map.
+*        Each chunk keeps the list of maps in which it changed, pointing at the chunk's
+*        contents after that map. Each map keeps the list of chunks it changed, so that
+*        rebuilding map N after map N-1 only copies the chunks that changed in map N.
+**************************************************************************************************
+*/
+class MdoVersionedStorage
+{
+public:
+    MdoVersionedStorage(UINT32 size);
+    ~MdoVersionedStorage();
+
+    void RecordMap(int mapId, const unsigned char* pNewData, const unsigned char* pReferenceData, const DataChunks& dirtyPages);
+    void Reconstruct(int mapId, void* pOut);
+
+    void Reset();
+
+private:
+    // One stored version of a chunk
+    struct ChunkVersion
+    {
+        int            mapId;
+        unsigned char* pData;
+    };
+
+    typedef std::vector<ChunkVersion> ChunkVersions;
+
+    // The chunks changed by one map, and the single allocation holding their contents
+    struct MapVersion
+    {
+        std::vector<UINT32> chunks;
+        unsigned char*      pData;
+    };
+
+    UINT32 ChunkByteSize(UINT32 chunk) const;
+
+    void RebuildImage(int mapId);
+
+    UINT32                     m_size;
+    UINT32                     m_chunkCount;
+    std::vector<ChunkVersions> m_chunkVersions;
+    std::vector<MapVersion>    m_mapVersions;
+    std::vector<UINT32>        m_changedChunks;
+
+    unsigned char*             m_pImage;
+    int                        m_imageMapId;
+
+    // Reported to MdoStats, so that Reset can take this resource's share back out of the total
+    UINT64                     m_storedBytes;
+};
+
+#endif
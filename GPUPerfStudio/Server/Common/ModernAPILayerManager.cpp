@@ -147,6 +147,7 @@ void ModernAPILayerManager::EndFrame()
     static double previousTime = currentTime;
 
     mFrameDuration = currentTime - previousTime;
+    previousTime = currentTime;
 
     if (mCmdGetCurrentFrameInfo.IsActive())
     {
@@ -200,8 +201,8 @@ float ModernAPILayerManager::GetElapsedTime()
 }
 
 //--------------------------------------------------------------------------
-/// Retrieve the total CPU duration of the last rendered frame in seconds.
-/// \returns The total CPU duration of the last rendered frame in seconds.
+/// Retrieve the total CPU duration of the last rendered frame in milliseconds.
+/// \returns The total CPU duration of the last rendered frame in milliseconds.
 //--------------------------------------------------------------------------
 float ModernAPILayerManager::GetCPUFrameDuration() const
 {
@@ -185,6 +185,12 @@ public:
     //--------------------------------------------------------------------------
     virtual void GetFrameInfo(FrameInfo& outFrameInfo) = 0;
 
+    //--------------------------------------------------------------------------
+    /// Retrieve the total CPU duration of the last rendered frame in milliseconds.
+    /// \returns The total CPU duration of the last rendered frame in milliseconds.
+    //--------------------------------------------------------------------------
+    float GetCPUFrameDuration() const;
+
 protected:
     //--------------------------------------------------------------------------
     /// Retrieve the total time that the application has been running in seconds.
@@ -192,12 +198,6 @@ protected:
     //--------------------------------------------------------------------------
     float GetElapsedTime();
 
-    //--------------------------------------------------------------------------
-    /// Retrieve the total CPU duration of the last rendered frame in seconds.
-    /// \returns The total CPU duration of the last rendered frame in seconds.
-    //--------------------------------------------------------------------------
-    float GetCPUFrameDuration() const;
-
 private:
     //--------------------------------------------------------------------------
     /// A command responsible for retrieving basic frame information as a chunk
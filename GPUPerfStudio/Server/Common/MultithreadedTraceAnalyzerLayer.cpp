@@ -9,13 +9,123 @@
 #include "misc.h"
 #include "SharedGlobal.h"
 #include "ModernAPILayerManager.h"
-#include "../Common/OSwrappers.h"
+#include "APITraceBuilder.h"
+#include "../Common/OSWrappers.h"
 #include <AMDTOSWrappers/Include/osProcess.h>
 #include <AMDTOSWrappers/Include/osFile.h>
 #include <AMDTOSWrappers/Include/osTime.h>
 #include <AMDTOSWrappers/Include/osDirectory.h>
 #include "../Common/xml.h"
 #include <tinyxml.h>
+#include <thread>
+#include <future>
+#include <atomic>
+#include <chrono>
+
+//--------------------------------------------------------------------------
+/// Everything needed to build a traced frame's response away from the render thread.
+/// The frame state is captured at EndFrame, since the render thread moves on before the response is built.
+//--------------------------------------------------------------------------
+struct TraceResponseJob
+{
+    //--------------------------------------------------------------------------
+    /// Default constructor. There's no response to send until a traced frame ends.
+    //--------------------------------------------------------------------------
+    TraceResponseJob()
+        : mbReady(false)
+        , mResponseCommand(NULL)
+    {
+    }
+
+    /// True if the response includes the API Trace.
+    bool mbAPITrace;
+
+    /// True if the response includes the GPU Trace.
+    bool mbGPUTrace;
+
+    /// True if the API and GPU Traces are returned through a single Linked Trace response.
+    bool mbLinkedTrace;
+
+    /// True if the Linked Trace is saved to disk, and the response is the path to its metadata file.
+    bool mbSaveToFile;
+
+    /// True if the saved Linked Trace stores the API calls in a binary trace file.
+    bool mbBinaryTrace;
+
+    /// True if the response is cached for AutoCapture instead of being sent.
+    bool mbAutotrace;
+
+    /// The index of the traced frame.
+    unsigned int mFrameIndex;
+
+    /// The frame info for the traced frame, written to the metadata file when saving.
+    FrameInfo mFrameInfo;
+
+    /// The GPU Trace response. Collected on the render thread while the API Trace is being built.
+    std::future<std::string> mGPUTraceResponse;
+
+    /// The worker thread building the response.
+    std::thread mWorker;
+
+    /// Set by BuildTraceResponse once the response is ready to be sent.
+    std::atomic<bool> mbReady;
+
+    /// The finished response.
+    std::string mResponse;
+
+    /// The command to send the finished response through, or NULL if there's nothing to send.
+    CommandResponse* mResponseCommand;
+};
+
+//--------------------------------------------------------------------------
+/// A flight recorder dump being saved to disk away from the render thread, along with
+/// what's needed to decide when the next automatic dump may be taken.
+//--------------------------------------------------------------------------
+struct FlightRecorderDumpJob
+{
+    //--------------------------------------------------------------------------
+    /// Default constructor. The first frame over the threshold is dumped.
+    //--------------------------------------------------------------------------
+    FlightRecorderDumpJob()
+        : mbArmed(true)
+        , mbDumpTaken(false)
+        , mbDone(false)
+        , mFrameIndex(0)
+        , mFrameDuration(0.0f)
+        , mThresholdMilliseconds(0.0f)
+    {
+    }
+
+    /// True if the next frame over the threshold is dumped. Cleared by a dump, and set again once a frame is under the threshold.
+    bool mbArmed;
+
+    /// True once a dump has been taken, so mLastDumpTime is valid.
+    bool mbDumpTaken;
+
+    /// The time that the last dump was taken.
+    std::chrono::steady_clock::time_point mLastDumpTime;
+
+    /// The worker thread saving the dump.
+    std::thread mWorker;
+
+    /// Set by the worker once the dump has been saved.
+    std::atomic<bool> mbDone;
+
+    /// The flight recorder contents, copied on the render thread and formatted by the worker.
+    FlightRecorderSnapshot mSnapshot;
+
+    /// The index of the frame that went over the threshold.
+    unsigned int mFrameIndex;
+
+    /// The frame info for the frame that went over the threshold, written to the metadata file.
+    FrameInfo mFrameInfo;
+
+    /// The CPU duration of the frame that went over the threshold.
+    float mFrameDuration;
+
+    /// The threshold that the frame went over.
+    float mThresholdMilliseconds;
+};
 
 //--------------------------------------------------------------------------
 /// The MetadataXMLVisitor will visit each XML Element and extract data
@@ -162,7 +272,13 @@ MultithreadedTraceAnalyzerLayer::MultithreadedTraceAnalyzerLayer()
     , mbCollectingApiTrace(false)
     , mbCollectingGPUTrace(false)
     , mbWaitingForAutocaptureClient(false)
+    , mbFlightRecording(false)
+    , mFlightRecorderFrameIndex(0)
+    , mbTracingFrame(false)
+    , mTraceResponseJob(new TraceResponseJob())
+    , mFlightRecorderDumpJob(new FlightRecorderDumpJob())
 {
+    memset(mFlightRecorderFrames, 0, sizeof(mFlightRecorderFrames));
 
     // Command that collects a CPU and GPU trace from the same frame.
     AddCommand(CONTENT_TEXT, "LinkedTrace", "LinkedTrace", "LinkedTrace.txt", DISPLAY, INCLUDE, mCmdLinkedTrace);
@@ -176,6 +292,18 @@ MultithreadedTraceAnalyzerLayer::MultithreadedTraceAnalyzerLayer()
 
     // Command used to automatically trace a target frame in an instrumented application.
     AddCommand(CONTENT_TEXT, "AutoTrace", "AutoTrace", "AutoTrace.txt", DISPLAY, INCLUDE, mCmdAutoCaptureCachedTrace);
+
+    // Command used to retrieve the most recent frames held by the flight recorder.
+    AddCommand(CONTENT_TEXT, "FlightRecorderDump", "FlightRecorderDump", "FlightRecorderDump.txt", DISPLAY, INCLUDE, mCmdFlightRecorderDump);
+
+    // Settings that control how trace responses are built. The server options provide the defaults, and the client can change them.
+    mCmdMergeAPITrace.SetValue(SG_GET_BOOL(OptionMergeAPITrace));
+    AddCommand(CONTENT_TEXT, "MergeAPITrace", "MergeAPITrace", "MergeAPITrace", NO_DISPLAY, INCLUDE, mCmdMergeAPITrace);
+    mCmdMergeAPITrace.SetEditableContentAutoReply(true);
+
+    mCmdAPITraceWorkerThread.SetValue(SG_GET_BOOL(OptionAPITraceWorkerThread));
+    AddCommand(CONTENT_TEXT, "APITraceWorkerThread", "APITraceWorkerThread", "APITraceWorkerThread", NO_DISPLAY, INCLUDE, mCmdAPITraceWorkerThread);
+    mCmdAPITraceWorkerThread.SetEditableContentAutoReply(true);
 }
 
 //--------------------------------------------------------------------------
@@ -183,8 +311,19 @@ MultithreadedTraceAnalyzerLayer::MultithreadedTraceAnalyzerLayer()
 //--------------------------------------------------------------------------
 MultithreadedTraceAnalyzerLayer::~MultithreadedTraceAnalyzerLayer()
 {
+    // The trace response worker reads the trace buffers, so it has to finish first.
+    FinishTraceResponse(true);
+    SAFE_DELETE(mTraceResponseJob);
+
+    if (mFlightRecorderDumpJob->mWorker.joinable())
+    {
+        mFlightRecorderDumpJob->mWorker.join();
+    }
+
+    SAFE_DELETE(mFlightRecorderDumpJob);
+
     // Destroy all of the buffered trace data.
-    ClearCPUThreadTraceData();
+    DestroyCPUThreadTraceData();
 }
 
 //--------------------------------------------------------------------------
@@ -194,6 +333,11 @@ MultithreadedTraceAnalyzerLayer::~MultithreadedTraceAnalyzerLayer()
 //--------------------------------------------------------------------------
 void MultithreadedTraceAnalyzerLayer::BeginFrame()
 {
+    mbTracingFrame = false;
+
+    // Send the last traced frame's response if the worker has finished building it.
+    bool bResponseWorkerBusy = (FinishTraceResponse(false) == false);
+
     // Check if automatic tracing is enabled for a specific frame. Determine which trace type by examining the result.
     int autotraceFlags = GetTraceTypeFlags();
 
@@ -204,13 +348,44 @@ void MultithreadedTraceAnalyzerLayer::BeginFrame()
     bool bAPITraceNeeded = m_apiTraceTXT.IsActive() || bLinkedTraceRequested || (autotraceFlags & kTraceType_API);
     bool bGPUTraceNeeded = m_cmdGPUTrace.IsActive() || bLinkedTraceRequested || (autotraceFlags & kTraceType_GPU);
 
+    // The worker reads the trace buffers until it's done, so a new trace can't be started before then.
+    // The flight recorder keeps its own rings, so it carries on recording frames meanwhile.
+    if ((bAPITraceNeeded || bGPUTraceNeeded) && bResponseWorkerBusy)
+    {
+        if (autotraceFlags != kTraceType_None)
+        {
+            // AutoTrace is for this frame in particular, and there's no request to reply to, so wait for the worker.
+            FinishTraceResponse(true);
+        }
+        else
+        {
+            // Tell the client that its request wasn't traced, rather than leaving it waiting with no reply.
+            CommandResponse* traceRequests[] = { &mCmdLinkedTrace, &mCmdLinkedTraceWithSave, &m_apiTraceTXT, &m_cmdGPUTrace };
+
+            for (unsigned int requestIndex = 0; requestIndex < sizeof(traceRequests) / sizeof(traceRequests[0]); ++requestIndex)
+            {
+                if (traceRequests[requestIndex]->IsActive())
+                {
+                    traceRequests[requestIndex]->SendError("Busy: the previous trace response is still being built. Request the trace again.");
+                }
+            }
+
+            bAPITraceNeeded = false;
+            bGPUTraceNeeded = false;
+        }
+    }
+
     if (bAPITraceNeeded || bGPUTraceNeeded)
     {
+        // A requested trace takes over from the flight recorder for this frame.
+        mbFlightRecording = false;
+
         // Clear out the previous trace data before tracing the new frame.
         Clear();
 
         // We need to enable tracing no matter what so that we go into the PreCall/PostCall.
         InterceptorBase* interceptor = GetInterceptor();
+        interceptor->SetFormatArguments(true);
         interceptor->SetCollectTrace(true);
 
         if (bAPITraceNeeded)
@@ -230,6 +405,17 @@ void MultithreadedTraceAnalyzerLayer::BeginFrame()
         }
 
         mFramestartTime = mFramestartTimer.GetRaw();
+        mbTracingFrame = true;
+    }
+    else if (SG_GET_UINT(OptionFlightRecorderFrames) > 0)
+    {
+        BeginFlightRecorderFrame();
+    }
+    else if (mbFlightRecording)
+    {
+        // The flight recorder has been switched off, so stop intercepting calls.
+        mbFlightRecording = false;
+        GetInterceptor()->SetCollectTrace(false);
     }
 }
 
@@ -240,6 +426,16 @@ void MultithreadedTraceAnalyzerLayer::BeginFrame()
 //--------------------------------------------------------------------------
 void MultithreadedTraceAnalyzerLayer::EndFrame()
 {
+    if (mbFlightRecording)
+    {
+        EndFlightRecorderFrame();
+    }
+
+    if (mCmdFlightRecorderDump.IsActive())
+    {
+        mCmdFlightRecorderDump.Send(GetFlightRecorderTXT().c_str());
+    }
+
     // Check again which trace type is active at the end of the frame. Need to match how it was started.
     int autotraceFlags = GetTraceTypeFlags();
 
@@ -253,8 +449,11 @@ void MultithreadedTraceAnalyzerLayer::EndFrame()
     bool bAPITraceResponseNeeded = m_apiTraceTXT.IsActive() || bLinkedTraceRequested || (autotraceFlags & kTraceType_API);
     bool bGPUTraceResponseNeeded = m_cmdGPUTrace.IsActive() || bLinkedTraceRequested || (autotraceFlags & kTraceType_GPU);
 
-    if (bAPITraceResponseNeeded || bGPUTraceResponseNeeded)
+    // Requests that arrived after BeginFrame are picked up by the next frame, so that a whole frame is traced.
+    if (mbTracingFrame && (bAPITraceResponseNeeded || bGPUTraceResponseNeeded))
     {
+        mbTracingFrame = false;
+
         // We're done collecting, so turn off the interception and profiler switch.
         InterceptorBase* interceptor = GetInterceptor();
         interceptor->SetCollectTrace(false);
@@ -263,80 +462,53 @@ void MultithreadedTraceAnalyzerLayer::EndFrame()
         AfterAPITrace();
         AfterGPUTrace();
 
-        std::string apiTraceResponseString, gpuTraceResponseString;
+        mbCollectingApiTrace = false;
 
-        if (bAPITraceResponseNeeded)
-        {
-            mbCollectingApiTrace = false;
-            apiTraceResponseString.assign(GetAPITraceTXT().c_str());
-        }
+        // Capture everything the response needs from this frame, since the render thread moves on before it's built.
+        ModernAPILayerManager* layerManager = interceptor->GetParentLayerManager();
 
-        if (bGPUTraceResponseNeeded)
-        {
-            mbGPUTraceAlreadyCollected = false;
-            gpuTraceResponseString.assign(GetGPUTraceTXT().c_str());
-        }
+        mTraceResponseJob->mbAPITrace = bAPITraceResponseNeeded;
+        mTraceResponseJob->mbGPUTrace = bGPUTraceResponseNeeded;
+        mTraceResponseJob->mbLinkedTrace = bLinkedTraceRequested;
+        mTraceResponseJob->mbSaveToFile = bSaveResponseToFile;
+        mTraceResponseJob->mbAutotrace = (autotraceFlags != kTraceType_None);
+        mTraceResponseJob->mFrameIndex = layerManager->GetFrameCount();
+        layerManager->GetFrameInfo(mTraceResponseJob->mFrameInfo);
+        mTraceResponseJob->mResponse.clear();
+        mTraceResponseJob->mResponseCommand = NULL;
 
-        std::stringstream fullResponseString;
+        // Linked traces that are saved to disk can skip the text API Trace and store the calls in the binary container.
+        // The container is converted back to this build's text format when it's loaded.
+        mTraceResponseJob->mbBinaryTrace = bLinkedTraceRequested && bSaveResponseToFile && (autotraceFlags == kTraceType_None) && SG_GET_BOOL(OptionBinaryTraceFile);
 
-        if (bAPITraceResponseNeeded)
-        {
-#if !defined(CODEXL_GRAPHICS)
+        std::promise<std::string> gpuTraceResponse;
+        mTraceResponseJob->mGPUTraceResponse = gpuTraceResponse.get_future();
+        mTraceResponseJob->mbReady = false;
 
-            // In Linked trace mode, insert a separator indicating the split between response types.
-            if (bLinkedTraceRequested)
-            {
-                fullResponseString << "//Type:API" << std::endl;
-            }
+        // Build the API Trace on a worker thread while this thread waits on the GPU Trace results.
+        // The worker also assembles and saves the response, and it's sent from a later BeginFrame once it's ready.
+        bool bUseWorkerThread = bAPITraceResponseNeeded && mCmdAPITraceWorkerThread.GetValue();
 
-#endif
-            fullResponseString << apiTraceResponseString.c_str() << std::endl;
-        }
-
-        if (bGPUTraceResponseNeeded)
+        if (bUseWorkerThread)
         {
-#if !defined(CODEXL_GRAPHICS)
-
-            // In Linked trace mode, insert a separator indicating the split between response types.
-            if (bLinkedTraceRequested)
-            {
-                fullResponseString << "//Type:GPU" << std::endl;
-            }
-
-#endif
-            fullResponseString << gpuTraceResponseString.c_str() << std::endl;
+            mTraceResponseJob->mWorker = std::thread(&MultithreadedTraceAnalyzerLayer::BuildTraceResponse, this);
         }
 
-        // If the autotrace flags are anything besides "None," we'll just store the trace log internally so the client can pick it up later.
-        bool bShouldCacheForAutotrace = (autotraceFlags != kTraceType_None);
-
-        if (bShouldCacheForAutotrace)
+        if (bGPUTraceResponseNeeded)
         {
-            // Don't send the response back through a command yet.
-            // The client will know to pick it up through a special AutoCapture command.
-            mCachedTraceResponse.assign(fullResponseString.str());
-            mbWaitingForAutocaptureClient = true;
+            mbGPUTraceAlreadyCollected = false;
+            gpuTraceResponse.set_value(GetGPUTraceTXT());
         }
         else
         {
-            // Send the response string back to the server through a specific request command.
-            if (bLinkedTraceRequested)
-            {
-                HandleLinkedTraceResponse(fullResponseString, bSaveResponseToFile);
-            }
-            else
-            {
-                if (bAPITraceResponseNeeded)
-                {
-                    m_apiTraceTXT.Send(apiTraceResponseString.c_str());
-                }
-                else if (bGPUTraceResponseNeeded)
-                {
-                    m_cmdGPUTrace.Send(gpuTraceResponseString.c_str());
-                }
-            }
+            gpuTraceResponse.set_value(std::string());
         }
 
+        if (bUseWorkerThread == false)
+        {
+            BuildTraceResponse();
+            FinishTraceResponse(true);
+        }
     }
 
     // When AutoCapture is enabled, we need to delay rendering so the user has time to retrieve the cached response.
@@ -439,9 +611,12 @@ bool MultithreadedTraceAnalyzerLayer::ReadTraceMetadataFile(const std::string& i
 /// Write a trace's metadata file and return the contenst through the out-param.
 /// \param inFullResponseString The full response string for a collected linked trace request.
 /// \param outMetadataXML The XML metadata string to return to the client.
+/// \param inFrameIndex The index of the traced frame.
+/// \param inFrameInfo The frame info for the traced frame.
+/// \param inBinaryTrace The binary form of the trace. When provided, it is written instead of the response string.
 /// \returns True if writing the metadata file was successful.
 //--------------------------------------------------------------------------
-bool MultithreadedTraceAnalyzerLayer::WriteTraceAndMetadataFiles(const std::stringstream& inFullResponseString, std::string& outMetadataXML)
+bool MultithreadedTraceAnalyzerLayer::WriteTraceAndMetadataFiles(const std::stringstream& inFullResponseString, std::string& outMetadataXML, unsigned int inFrameIndex, const FrameInfo& inFrameInfo, const BinaryTraceWriter* inBinaryTrace)
 {
     bool bWrittenSuccessfully = false;
 
@@ -541,7 +716,7 @@ bool MultithreadedTraceAnalyzerLayer::WriteTraceAndMetadataFiles(const std::stri
             // Metadata files will be saved to the temp directory with the following filename scheme:
             // "%TEMP%/ToolDirectory/Session[Index]/ApplicationBinaryName/Frame[Index]/description.xml"
 
-            int frameIndex = GetInterceptor()->GetParentLayerManager()->GetFrameCount();
+            int frameIndex = static_cast<int>(inFrameIndex);
 
             // Generate a "Session" folder with a number at the end. Compute the correct number by looking at the
             // Session folders that already exist
@@ -584,7 +759,8 @@ bool MultithreadedTraceAnalyzerLayer::WriteTraceAndMetadataFiles(const std::stri
 
                 // Construct a filename for the cached trace response.
                 gtASCIIString fullTraceFilename;
-                fullTraceFilename.appendFormattedString("LinkedTrace-%s-%d-%d-%d-%d-%d-%d.ltr", appName.asASCIICharArray(), year, month, day, hour, minute, second);
+                const char* traceFileExtension = (inBinaryTrace != NULL) ? s_BinaryTraceExtension : "ltr";
+                fullTraceFilename.appendFormattedString("LinkedTrace-%s-%d-%d-%d-%d-%d-%d.%s", appName.asASCIICharArray(), year, month, day, hour, minute, second, traceFileExtension);
 
                 gtASCIIString fullTraceFilePath = pathToDataDirectory;
                 fullTraceFilePath.appendFormattedString("%s", fullTraceFilename.asCharArray());
@@ -594,8 +770,15 @@ bool MultithreadedTraceAnalyzerLayer::WriteTraceAndMetadataFiles(const std::stri
 
                 // Write the contents of the trace response file.
                 osFile traceResponseFile(fullTraceResponseFilepathGTString);
-                bool bTraceResponseFileOpened = traceResponseFile.open(osChannel::OS_ASCII_TEXT_CHANNEL, osFile::OS_OPEN_TO_WRITE);
-                if (bTraceResponseFileOpened)
+
+                bool bTraceFileWritten = false;
+
+                if (inBinaryTrace != NULL)
+                {
+                    // The binary container holds everything needed to rebuild the response, so the text isn't written at all.
+                    bTraceFileWritten = inBinaryTrace->WriteToFile(fullTraceFilePath.asCharArray());
+                }
+                else if (traceResponseFile.open(osChannel::OS_ASCII_TEXT_CHANNEL, osFile::OS_OPEN_TO_WRITE))
                 {
                     // Dump the response into an ASCII string.
                     std::string responseAsString = inFullResponseString.str();
@@ -605,12 +788,17 @@ bool MultithreadedTraceAnalyzerLayer::WriteTraceAndMetadataFiles(const std::stri
                     std::wstring wideString;
                     wideString.assign(responseAsString.begin(), responseAsString.end());
                     gtStringResponse.appendFormattedString(L"%s", wideString.c_str());
-                    traceResponseFile.writeString(gtStringResponse);
+                    bTraceFileWritten = traceResponseFile.writeString(gtStringResponse);
                     traceResponseFile.close();
                 }
-                else
+
+                if (bTraceFileWritten == false)
                 {
+                    // Don't leave behind metadata that points at a missing or partial trace.
                     Log(logERROR, "Failed to write trace response to file: '%s'\n", fullTraceResponseFilepathGTString.asASCIICharArray());
+                    metadataFile.close();
+                    metadataFile.deleteFile();
+                    return false;
                 }
 
                 // Write the filename for the associated trace response that was just collected.
@@ -628,14 +816,8 @@ bool MultithreadedTraceAnalyzerLayer::WriteTraceAndMetadataFiles(const std::stri
                 // @TODO: When we have a framebuffer image system working, assign the path-to-image here.
                 metadata.mPathToFrameBufferImage = "UNKNOWNPATH";
 
-                ModernAPILayerManager* layerManager = GetInterceptor()->GetParentLayerManager();
-
-                FrameInfo frameInfo;
-
-                layerManager->GetFrameInfo(frameInfo);
-
-                // Populate the metadata structure with the values stored in the LayerManager.
-                metadata.mFrameInfo = frameInfo;
+                // Populate the metadata structure with the values captured from the LayerManager.
+                metadata.mFrameInfo = inFrameInfo;
                 metadata.mFrameIndex = frameIndex;
                 metadata.mArchitecture = moduleArchitecture;
 
@@ -681,6 +863,26 @@ bool MultithreadedTraceAnalyzerLayer::WriteTraceAndMetadataFiles(const std::stri
 bool MultithreadedTraceAnalyzerLayer::LoadTraceFile(const std::string& inTraceFilepath, gtASCIIString& outTraceFileContents)
 {
     bool bReadSuccessful = false;
+
+    // Binary traces are mapped in place, and converted back to the text response that clients expect.
+    std::string binaryTraceSuffix = std::string(".") + s_BinaryTraceExtension;
+
+    if (inTraceFilepath.size() > binaryTraceSuffix.size() &&
+        inTraceFilepath.compare(inTraceFilepath.size() - binaryTraceSuffix.size(), binaryTraceSuffix.size(), binaryTraceSuffix) == 0)
+    {
+        BinaryTraceReader traceReader;
+
+        if (traceReader.Open(inTraceFilepath.c_str()))
+        {
+            std::string traceText;
+            traceReader.ConvertToText(traceText);
+            outTraceFileContents = traceText.c_str();
+            bReadSuccessful = true;
+        }
+
+        return bReadSuccessful;
+    }
+
     gtString traceFilepath;
     traceFilepath.fromASCIIString(inTraceFilepath.c_str());
     osFile traceFile(traceFilepath);
@@ -702,24 +904,44 @@ bool MultithreadedTraceAnalyzerLayer::LoadTraceFile(const std::string& inTraceFi
 }
 
 //--------------------------------------------------------------------------
-/// Clear and destroy all of the traced thread data.
+/// Clear all of the traced thread data. The per-thread buffers are kept so their memory can be reused.
 //--------------------------------------------------------------------------
 void MultithreadedTraceAnalyzerLayer::ClearCPUThreadTraceData()
 {
-    if (!mThreadTraces.empty())
-    {
-        ScopeLock threadTraceLock(&mTraceMutex);
+    ScopeLock threadTraceLock(&mTraceMutex);
+
+    // Rewinding each thread's arena invalidates all of the APIEntries it holds.
+    unsigned int numThreads = mThreadTraces.GetNumThreads();
 
-        // Kill all thread trace buffers so we can start over on the next frame, or just to shut the layer down.
-        std::map<DWORD, ThreadTraceData*>::iterator threadIter;
+    for (unsigned int threadIndex = 0; threadIndex < numThreads; ++threadIndex)
+    {
+        DWORD threadId = 0;
+        ThreadTraceData* traceData = mThreadTraces.GetThreadData(threadIndex, threadId);
 
-        for (threadIter = mThreadTraces.begin(); threadIter != mThreadTraces.end(); ++threadIter)
+        if (traceData != NULL)
         {
-            ThreadTraceData* traceData = threadIter->second;
-            SAFE_DELETE(traceData);
+            ScopeLock entryLock(&traceData->mEntryLock);
+            traceData->Clear();
         }
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Destroy all of the traced thread data. The registry still refers to the destroyed instances,
+/// so this may only be used when the layer is shutting down.
+//--------------------------------------------------------------------------
+void MultithreadedTraceAnalyzerLayer::DestroyCPUThreadTraceData()
+{
+    ScopeLock threadTraceLock(&mTraceMutex);
 
-        mThreadTraces.clear();
+    // Kill all thread trace buffers to shut the layer down.
+    unsigned int numThreads = mThreadTraces.GetNumThreads();
+
+    for (unsigned int threadIndex = 0; threadIndex < numThreads; ++threadIndex)
+    {
+        DWORD threadId = 0;
+        ThreadTraceData* traceData = mThreadTraces.GetThreadData(threadIndex, threadId);
+        SAFE_DELETE(traceData);
     }
 }
 
@@ -727,10 +949,13 @@ void MultithreadedTraceAnalyzerLayer::ClearCPUThreadTraceData()
 /// Handle what happens when a Linked Trace is requested. We can either:
 /// 1. Return the trace response as normal.
 /// 2. Cache the response to disk, and generate a "trace metadata" file used to retrieve the trace later.
+/// The response is stored in the job, to be sent from the render thread.
 /// \param inFullResponseString The response string built by tracing the application.
-/// \param inbSaveResponseToFile A switch used to determine which response method to use.
+/// \param ioJob The traced frame's response job. Its mbSaveToFile switch determines which response method to use.
+/// \param ioBinaryTrace The binary form of the trace to save instead of the response string, or NULL.
+/// \param inAPITraceOffset Where the API Trace text goes in the response string.
 //--------------------------------------------------------------------------
-void MultithreadedTraceAnalyzerLayer::HandleLinkedTraceResponse(std::stringstream& inFullResponseString, bool inbSaveResponseToFile)
+void MultithreadedTraceAnalyzerLayer::HandleLinkedTraceResponse(std::stringstream& inFullResponseString, TraceResponseJob& ioJob, BinaryTraceWriter* ioBinaryTrace, size_t inAPITraceOffset)
 {
     // If we're building for use with CodeXL, insert extra metadata into the response before returning.
 #if defined(CODEXL_GRAPHICS)
@@ -794,29 +1019,42 @@ void MultithreadedTraceAnalyzerLayer::HandleLinkedTraceResponse(std::stringstrea
     // Write the header and response chunks into the final response.
     inFullResponseString << headerString;
     inFullResponseString << responseString;
+
+    inAPITraceOffset += headerString.size();
 #endif
 
+    if (ioBinaryTrace != NULL)
+    {
+        // The binary trace holds the calls, and the rest of the response is stored around them,
+        // so that converting the binary trace back to text gives exactly this response.
+        std::string responseString = inFullResponseString.str();
+        ioBinaryTrace->SetSurroundingText(responseString.substr(0, inAPITraceOffset), responseString.substr(inAPITraceOffset));
+    }
+
     // Check if we want to cache the response to disk, or return it as-is.
-    if (inbSaveResponseToFile)
+    if (ioJob.mbSaveToFile)
     {
         std::string metadataXMLString;
-        bool bWriteMetadataSuccessful = WriteTraceAndMetadataFiles(inFullResponseString, metadataXMLString);
+        bool bWriteMetadataSuccessful = WriteTraceAndMetadataFiles(inFullResponseString, metadataXMLString, ioJob.mFrameIndex, ioJob.mFrameInfo, ioBinaryTrace);
         if (bWriteMetadataSuccessful)
         {
             // Send a response back to the client indicating which trace metadata file was written to disk.
-            mCmdLinkedTraceWithSave.Send(metadataXMLString.c_str());
+            ioJob.mResponse = metadataXMLString;
         }
         else
         {
             Log(logERROR, "Failed to write trace metadata XML.\n");
-            mCmdLinkedTraceWithSave.Send("Failed");
+            ioJob.mResponse = "Failed";
         }
+
+        ioJob.mResponseCommand = &mCmdLinkedTraceWithSave;
     }
     else
     {
         // Return the normal trace response string.
         // Send a response containing the API and GPU trace text.
-        mCmdLinkedTrace.Send(std::string(inFullResponseString.str()).c_str());
+        ioJob.mResponse = inFullResponseString.str();
+        ioJob.mResponseCommand = &mCmdLinkedTrace;
     }
 }
 
@@ -827,67 +1065,489 @@ void MultithreadedTraceAnalyzerLayer::HandleLinkedTraceResponse(std::stringstrea
 //--------------------------------------------------------------------------
 std::string MultithreadedTraceAnalyzerLayer::GetAPITraceTXT()
 {
-    // A switch to determine at the last moment whether or not we should send our generated response back to the client.
-    bool bWriteResponseString = false;
+    APITraceBuilder traceBuilder(mThreadTraces, mFramestartTime);
 
-    // Concatenate all of the logged call lines into a single string that we can send to the client.
-    std::stringstream traceString;
-    std::map<DWORD, ThreadTraceData*>::iterator traceIter;
+#if !defined(CODEXL_GRAPHICS)
 
-    for (traceIter = mThreadTraces.begin(); traceIter != mThreadTraces.end(); ++traceIter)
+    // Every response line includes its ThreadId, so the calls from all threads can be interleaved into one stream.
+    // CodeXL expects a separate section for each thread, so it always gets the per-thread layout.
+    if (mCmdMergeAPITrace.GetValue())
     {
-        ThreadTraceData* currentTrace = traceIter->second;
-        const TimingLog& currentTimer = currentTrace->mAPICallTimer;
-        GPS_TIMESTAMP timeFrequency = currentTimer.GetTimeFrequency();
-        const GPS_TIMESTAMP frameStartTime = mFramestartTime;
-        size_t numEntries = currentTrace->mLoggedCallVector.size();
+        return traceBuilder.GetMergedAPITraceTXT();
+    }
 
-        // When using the updated trace format, include a preamble section for each traced thread.
-#if defined(CODEXL_GRAPHICS)
-        // Write the trace type, API, ThreadID, and count of APIs traced.
-        traceString << "//==API Trace==" << std::endl;
-        traceString << "//API=" << GetAPIString() << std::endl;
-        traceString << "//ThreadID=" << traceIter->first << std::endl;
-        traceString << "//ThreadAPICount=" << numEntries << std::endl;
 #endif
 
-        for (size_t entryIndex = 0; entryIndex < numEntries; ++entryIndex)
+    return traceBuilder.GetPerThreadAPITraceTXT(GetAPIString());
+}
+
+//--------------------------------------------------------------------------
+/// Build the response for the frame described by mTraceResponseJob. Used as the entry point for
+/// the trace response worker thread, which builds the API Trace while the render thread collects
+/// the GPU Trace, then assembles and saves the response without holding up the next frame.
+//--------------------------------------------------------------------------
+void MultithreadedTraceAnalyzerLayer::BuildTraceResponse()
+{
+    TraceResponseJob& job = *mTraceResponseJob;
+
+    std::string apiTraceResponseString;
+    BinaryTraceWriter binaryTraceWriter;
+
+    if (job.mbAPITrace)
+    {
+        if (job.mbBinaryTrace)
+        {
+            BuildBinaryAPITrace(binaryTraceWriter, job.mFrameIndex);
+        }
+        else
         {
-            // Get each logged call by index.
-            const CallsTiming& callTiming = currentTimer.GetTimingByIndex(entryIndex);
+            apiTraceResponseString = GetAPITraceTXT();
+        }
+    }
+
+    // Wait for the render thread to finish collecting the GPU Trace.
+    std::string gpuTraceResponseString = job.mGPUTraceResponse.get();
+
+    std::stringstream fullResponseString;
+
+    // Where the API Trace text goes in the response. A binary trace is rebuilt by putting its calls here.
+    size_t apiTraceOffset = 0;
+
+    if (job.mbAPITrace)
+    {
+#if !defined(CODEXL_GRAPHICS)
+
+        // In Linked trace mode, insert a separator indicating the split between response types.
+        if (job.mbLinkedTrace)
+        {
+            fullResponseString << "//Type:API" << std::endl;
+        }
+
+#endif
+        apiTraceOffset = static_cast<size_t>(fullResponseString.tellp());
+        fullResponseString << apiTraceResponseString.c_str() << std::endl;
+    }
+
+    if (job.mbGPUTrace)
+    {
+#if !defined(CODEXL_GRAPHICS)
+
+        // In Linked trace mode, insert a separator indicating the split between response types.
+        if (job.mbLinkedTrace)
+        {
+            fullResponseString << "//Type:GPU" << std::endl;
+        }
+
+#endif
+        fullResponseString << gpuTraceResponseString.c_str() << std::endl;
+    }
 
+    if (job.mbAutotrace)
+    {
+        // The response is stored internally, and the client will pick it up later through the AutoCapture command.
+        job.mResponse = fullResponseString.str();
+    }
+    else if (job.mbLinkedTrace)
+    {
+        HandleLinkedTraceResponse(fullResponseString, job, job.mbBinaryTrace ? &binaryTraceWriter : NULL, apiTraceOffset);
+    }
+    else if (job.mbAPITrace)
+    {
+        job.mResponse = apiTraceResponseString;
+        job.mResponseCommand = &m_apiTraceTXT;
+    }
+    else if (job.mbGPUTrace)
+    {
+        job.mResponse = gpuTraceResponseString;
+        job.mResponseCommand = &m_cmdGPUTrace;
+    }
+
+    mTraceResponseJob->mbReady = true;
+}
+
+//--------------------------------------------------------------------------
+/// Send the response built by the trace response worker, once it has finished.
+/// Must be called from the render thread, since that's where the trace commands are handled.
+/// \param inbWait If true, wait for the worker to finish. Otherwise return immediately if it's still busy.
+/// \returns True if there's no trace response being built anymore.
+//--------------------------------------------------------------------------
+bool MultithreadedTraceAnalyzerLayer::FinishTraceResponse(bool inbWait)
+{
+    if (mTraceResponseJob->mWorker.joinable())
+    {
+        if ((inbWait == false) && (mTraceResponseJob->mbReady == false))
+        {
+            return false;
+        }
+
+        mTraceResponseJob->mWorker.join();
+    }
+
+    if (mTraceResponseJob->mbReady)
+    {
+        mTraceResponseJob->mbReady = false;
+
+        if (mTraceResponseJob->mbAutotrace)
+        {
+            // Don't send the response back through a command yet.
+            // The client will know to pick it up through a special AutoCapture command.
+            mCachedTraceResponse.swap(mTraceResponseJob->mResponse);
+            mbWaitingForAutocaptureClient = true;
+        }
+        else if (mTraceResponseJob->mResponseCommand != NULL)
+        {
+            mTraceResponseJob->mResponseCommand->Send(mTraceResponseJob->mResponse.c_str());
+        }
+
+        mTraceResponseJob->mResponse.clear();
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------
+/// Add all of the logged API calls to a binary trace, with one section per traced thread.
+/// \param outTraceWriter The binary trace writer to add the calls to.
+/// \param inFrameIndex The index of the traced frame.
+//--------------------------------------------------------------------------
+void MultithreadedTraceAnalyzerLayer::BuildBinaryAPITrace(BinaryTraceWriter& outTraceWriter, unsigned int inFrameIndex)
+{
+    APITraceBuilder traceBuilder(mThreadTraces, mFramestartTime);
+    unsigned int numThreads = mThreadTraces.GetNumThreads();
+
+    // The sections are always per-thread. Merging only changes the order of the text that's rebuilt from them.
+    // CodeXL expects a separate section for each thread, so its traces are never merged.
+#if !defined(CODEXL_GRAPHICS)
+    outTraceWriter.SetMerged(mCmdMergeAPITrace.GetValue());
+#endif
+    outTraceWriter.SetAPIName(GetAPIString());
+
+    for (unsigned int threadIndex = 0; threadIndex < numThreads; ++threadIndex)
+    {
+        DWORD threadId = 0;
+        const ThreadTraceData* currentTrace = mThreadTraces.GetThreadData(threadIndex, threadId);
+
+        if (currentTrace == NULL || currentTrace->mLoggedCallVector.empty())
+        {
+            continue;
+        }
+
+        GPS_TIMESTAMP timeFrequency = currentTrace->mAPICallTimer.GetTimeFrequency();
+        size_t numEntries = currentTrace->mLoggedCallVector.size();
+
+        outTraceWriter.BeginSection(inFrameIndex, threadId);
+
+        for (size_t entryIndex = 0; entryIndex < numEntries; ++entryIndex)
+        {
             double deltaStartTime, deltaEndTime;
-            bool conversionResults = currentTimer.ConvertTimestampToDoubles(callTiming.m_startTime,
-                                                                            callTiming.m_endTime,
-                                                                            deltaStartTime,
-                                                                            deltaEndTime,
-                                                                            frameStartTime,
-                                                                            &timeFrequency);
-
-            // We should always be able to convert from GPS_TIMESTAMPs to doubles.
-            PsAssert(conversionResults == true);
-            (void)conversionResults;
-
-            const APIEntry* callEntry = currentTrace->mLoggedCallVector[entryIndex];
-
-            // This exists as a sanity check. If a duration stretches past this point, we can be pretty sure something is messed up.
-            // This signal value is basically random, with the goal of it being large enough to catch any obvious duration errors.
-            if (deltaEndTime > 8000000000.0f)
+            traceBuilder.GetCallTimes(currentTrace, entryIndex, timeFrequency, deltaStartTime, deltaEndTime);
+
+            currentTrace->mLoggedCallVector[entryIndex]->AppendBinaryTraceCall(outTraceWriter, deltaStartTime, deltaEndTime);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Record a traced call into the calling thread's flight recorder ring.
+/// \param inFunctionId The FuncId for the API function that was called.
+/// \param inInterface The interface that the call was made through.
+/// \param inReturnValue The return value for the API call, or FUNCTION_RETURNS_VOID if there is none.
+//--------------------------------------------------------------------------
+void MultithreadedTraceAnalyzerLayer::RecordFlightCall(FuncId inFunctionId, void* inInterface, INT64 inReturnValue)
+{
+    ThreadTraceData* currentThreadData = FindOrCreateThreadData(osGetCurrentThreadId());
+
+    FlightRecorderCall newCall;
+    newCall.mFrameIndex = mFlightRecorderFrameIndex;
+    newCall.mFunctionId = inFunctionId;
+    newCall.mInterface = inInterface;
+    newCall.mReturnValue = inReturnValue;
+    newCall.mStartTime = currentThreadData->m_startTime;
+    newCall.mEndTime = currentThreadData->mAPICallTimer.GetRaw();
+
+    currentThreadData->mFlightRecorder.Record(newCall);
+}
+
+//--------------------------------------------------------------------------
+/// Start recording a new frame into the flight recorder.
+//--------------------------------------------------------------------------
+void MultithreadedTraceAnalyzerLayer::BeginFlightRecorderFrame()
+{
+    // Every call needs to go through PreCall/PostCall so that it can be recorded.
+    // The flight recorder doesn't keep the call arguments, so the wrappers can skip formatting them.
+    InterceptorBase* interceptor = GetInterceptor();
+    interceptor->SetFormatArguments(false);
+    interceptor->SetCollectTrace(true);
+
+    mFlightRecorderFrameIndex++;
+
+    FlightRecorderFrame& currentFrame = mFlightRecorderFrames[mFlightRecorderFrameIndex % s_MaxFlightRecorderFrames];
+    currentFrame.mFrameIndex = mFlightRecorderFrameIndex;
+    currentFrame.mStartTime = mFramestartTimer.GetRaw();
+    currentFrame.mCPUFrameDuration = 0.0f;
+
+    mbFlightRecording = true;
+}
+
+//--------------------------------------------------------------------------
+/// Finish recording a frame into the flight recorder. Dumps the recorded frames if
+/// the frame took longer than the configured threshold. A run of slow frames is only
+/// dumped once, and dumps are at least s_MinFlightRecorderDumpIntervalMs apart.
+//--------------------------------------------------------------------------
+void MultithreadedTraceAnalyzerLayer::EndFlightRecorderFrame()
+{
+    ModernAPILayerManager* layerManager = GetInterceptor()->GetParentLayerManager();
+    float frameDuration = layerManager->GetCPUFrameDuration();
+
+    FlightRecorderFrame& currentFrame = mFlightRecorderFrames[mFlightRecorderFrameIndex % s_MaxFlightRecorderFrames];
+    currentFrame.mCPUFrameDuration = frameDuration;
+
+    float thresholdMilliseconds = SG_GET_FLOAT(OptionFlightRecorderThreshold);
+    FlightRecorderDumpJob* dumpJob = mFlightRecorderDumpJob;
+
+    if (thresholdMilliseconds <= 0.0f || frameDuration <= thresholdMilliseconds)
+    {
+        // The hitch is over, so the next one is dumped.
+        dumpJob->mbArmed = true;
+        return;
+    }
+
+    if (dumpJob->mbArmed == false)
+    {
+        // This run of slow frames has already been dumped.
+        return;
+    }
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    if (dumpJob->mbDumpTaken && (now - dumpJob->mLastDumpTime) < std::chrono::milliseconds(s_MinFlightRecorderDumpIntervalMs))
+    {
+        // Too soon after the last dump. Stay armed, so this hitch is dumped if it's still going once the interval has passed.
+        return;
+    }
+
+    if (dumpJob->mWorker.joinable())
+    {
+        if (dumpJob->mbDone == false)
+        {
+            // The last dump is still being saved.
+            return;
+        }
+
+        dumpJob->mWorker.join();
+    }
+
+    dumpJob->mbArmed = false;
+    dumpJob->mbDumpTaken = true;
+    dumpJob->mLastDumpTime = now;
+    dumpJob->mbDone = false;
+
+    // The rings are overwritten as the application carries on, so the calls are copied out here. Formatting and
+    // saving them is left to the worker, so the frame that went over the threshold isn't made any longer.
+    CopyFlightRecorderCalls(dumpJob->mSnapshot);
+    dumpJob->mFrameIndex = mFlightRecorderFrameIndex;
+    dumpJob->mFrameDuration = frameDuration;
+    dumpJob->mThresholdMilliseconds = thresholdMilliseconds;
+    layerManager->GetFrameInfo(dumpJob->mFrameInfo);
+
+    unsigned int frameCount = layerManager->GetFrameCount();
+
+    dumpJob->mWorker = std::thread([this, dumpJob, frameCount]()
+    {
+        std::stringstream dump;
+        dump << FormatFlightRecorderTXT(dumpJob->mSnapshot) << std::endl;
+
+        // Write the recorded frames to disk in the same way as a saved Linked Trace, so the hitch can be examined later.
+        std::string metadataXMLString;
+
+        if (WriteTraceAndMetadataFiles(dump, metadataXMLString, frameCount, dumpJob->mFrameInfo))
+        {
+            Log(logMESSAGE, "Frame %u took %f ms, exceeding the flight recorder threshold of %f ms. Recorded frames were saved: %s\n",
+                dumpJob->mFrameIndex, dumpJob->mFrameDuration, dumpJob->mThresholdMilliseconds, metadataXMLString.c_str());
+        }
+        else
+        {
+            Log(logERROR, "Failed to save the flight recorder contents for frame %u.\n", dumpJob->mFrameIndex);
+        }
+
+        dumpJob->mbDone = true;
+    });
+}
+
+//--------------------------------------------------------------------------
+/// Build a text dump of the calls from the frames held in the flight recorder.
+/// \returns A line-delimited, ASCII-encoded, version of the flight recorder contents.
+//--------------------------------------------------------------------------
+std::string MultithreadedTraceAnalyzerLayer::GetFlightRecorderTXT()
+{
+    FlightRecorderSnapshot snapshot;
+    CopyFlightRecorderCalls(snapshot);
+
+    return FormatFlightRecorderTXT(snapshot);
+}
+
+//--------------------------------------------------------------------------
+/// Copy the calls from the frames held in the flight recorder out of every thread's ring.
+/// \param outSnapshot The copied frames and calls. Its vectors are reused, so a snapshot
+/// that's copied into repeatedly only allocates when it needs to grow.
+//--------------------------------------------------------------------------
+void MultithreadedTraceAnalyzerLayer::CopyFlightRecorderCalls(FlightRecorderSnapshot& outSnapshot)
+{
+    outSnapshot.mFrames.clear();
+    outSnapshot.mCalls.clear();
+    outSnapshot.mRequestedFrameCount = 0;
+    outSnapshot.mLastFrameIndex = mFlightRecorderFrameIndex;
+    outSnapshot.mFirstFrameIndex = mFlightRecorderFrameIndex + 1;
+
+    unsigned int numFrames = SG_GET_UINT(OptionFlightRecorderFrames);
+
+    if (numFrames > s_MaxFlightRecorderFrames)
+    {
+        numFrames = s_MaxFlightRecorderFrames;
+    }
+
+    if (numFrames > mFlightRecorderFrameIndex)
+    {
+        numFrames = mFlightRecorderFrameIndex;
+    }
+
+    if (numFrames == 0)
+    {
+        return;
+    }
+
+    outSnapshot.mRequestedFrameCount = numFrames;
+    unsigned int firstFrameIndex = mFlightRecorderFrameIndex - numFrames + 1;
+
+    // A thread's ring may have wrapped partway through one of the requested frames. That frame and every frame
+    // before it are missing some of the thread's calls, so only the frames after it are kept.
+    unsigned int numThreads = mThreadTraces.GetNumThreads();
+
+    for (unsigned int threadIndex = 0; threadIndex < numThreads; ++threadIndex)
+    {
+        DWORD threadId = 0;
+        const ThreadTraceData* currentTrace = mThreadTraces.GetThreadData(threadIndex, threadId);
+
+        if (currentTrace == NULL)
+        {
+            continue;
+        }
+
+        const FlightRecorderRing& flightRecorder = currentTrace->mFlightRecorder;
+
+        // Only the most recent calls are still held in the ring.
+        unsigned int numRecorded = flightRecorder.GetNumRecorded();
+        unsigned int firstRecordIndex = (numRecorded > s_FlightRecorderCallsPerThread) ? (numRecorded - s_FlightRecorderCallsPerThread) : 0;
+
+        // Set when calls before the next one read were lost, either to the ring wrapping or to being overwritten while they were copied.
+        bool bCallsLost = (firstRecordIndex > 0);
+
+        for (unsigned int recordIndex = firstRecordIndex; recordIndex < numRecorded; ++recordIndex)
+        {
+            FlightRecorderSnapshot::CopiedCall copiedCall;
+
+            if (!flightRecorder.ReadCall(recordIndex, copiedCall.mCall))
             {
-                const char* functionName = callEntry->GetAPIName();
-                Log(logWARNING, "The duration for APIEntry '%s' with index '%d' is suspicious. Tracing the application may have hung, producing inflated results.\n", functionName, entryIndex);
+                bCallsLost = true;
+                continue;
             }
 
-            callEntry->AppendAPITraceLine(traceString, deltaStartTime, deltaEndTime);
+            if (bCallsLost)
+            {
+                // The lost calls were made in this call's frame or earlier.
+                bCallsLost = false;
+
+                if (copiedCall.mCall.mFrameIndex >= firstFrameIndex)
+                {
+                    firstFrameIndex = copiedCall.mCall.mFrameIndex + 1;
+                }
+            }
+
+            if (copiedCall.mCall.mFrameIndex >= firstFrameIndex)
+            {
+                copiedCall.mThreadId = threadId;
+                outSnapshot.mCalls.push_back(copiedCall);
+            }
+        }
+
+        if (bCallsLost)
+        {
+            firstFrameIndex = mFlightRecorderFrameIndex + 1;
         }
+    }
 
-        bWriteResponseString = true;
+    outSnapshot.mFirstFrameIndex = firstFrameIndex;
+
+    // The frame records are overwritten as new frames begin, so they're copied along with the calls.
+    for (unsigned int frameIndex = firstFrameIndex; frameIndex <= mFlightRecorderFrameIndex; ++frameIndex)
+    {
+        outSnapshot.mFrames.push_back(mFlightRecorderFrames[frameIndex % s_MaxFlightRecorderFrames]);
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Build a text dump of the calls copied out of the flight recorder. Only reads the snapshot,
+/// so it can be called from any thread.
+/// \param inSnapshot The frames and calls copied by CopyFlightRecorderCalls.
+/// \returns A line-delimited, ASCII-encoded, version of the flight recorder contents.
+//--------------------------------------------------------------------------
+std::string MultithreadedTraceAnalyzerLayer::FormatFlightRecorderTXT(const FlightRecorderSnapshot& inSnapshot)
+{
+    if (inSnapshot.mRequestedFrameCount == 0)
+    {
+        return "NODATA";
     }
 
-    // If for some reason we failed to write a valid response string, reply with a known failure signal so the client handles it properly.
-    if (!bWriteResponseString)
+    // The number of requested frames for which every thread's calls are still held.
+    const unsigned int numFrames = (unsigned int)inSnapshot.mFrames.size();
+
+    std::stringstream traceString;
+    traceString << "//==Flight Recorder==" << std::endl;
+    traceString << "//API=" << GetAPIString() << std::endl;
+    traceString << "//RequestedFrameCount=" << inSnapshot.mRequestedFrameCount << std::endl;
+    traceString << "//FrameCount=" << numFrames << std::endl;
+
+    if (numFrames == 0)
     {
-        traceString << "NODATA";
+        return traceString.str();
+    }
+
+    const GPS_TIMESTAMP firstFrameStartTime = inSnapshot.mFrames[0].mStartTime;
+
+    for (unsigned int frameIndex = 0; frameIndex < numFrames; ++frameIndex)
+    {
+        const FlightRecorderFrame& frame = inSnapshot.mFrames[frameIndex];
+        traceString << "//Frame=" << frame.mFrameIndex << " CPUFrameDuration=" << std::fixed << frame.mCPUFrameDuration << std::endl;
+    }
+
+    // Only used to convert the timestamps, which doesn't depend on any thread's log.
+    TimingLog timestampConverter;
+    GPS_TIMESTAMP timeFrequency = timestampConverter.GetTimeFrequency();
+
+    // Each recorded call follows a specific format:
+    // ThreadId FrameIndex InterfacePtr FunctionName = ReturnValue StartTime EndTime
+    for (size_t callIndex = 0; callIndex < inSnapshot.mCalls.size(); ++callIndex)
+    {
+        const FlightRecorderSnapshot::CopiedCall& copiedCall = inSnapshot.mCalls[callIndex];
+        const FlightRecorderCall& recordedCall = copiedCall.mCall;
+
+        // A thread's calls were copied before a later thread moved the first frame on.
+        if (recordedCall.mFrameIndex < inSnapshot.mFirstFrameIndex)
+        {
+            continue;
+        }
+
+        double deltaStartTime, deltaEndTime;
+        timestampConverter.ConvertTimestampToDoubles(recordedCall.mStartTime, recordedCall.mEndTime, deltaStartTime, deltaEndTime, firstFrameStartTime, &timeFrequency);
+
+        traceString << copiedCall.mThreadId << " "
+                    << recordedCall.mFrameIndex << " "
+                    << recordedCall.mInterface << " "
+                    << GetFunctionNameFromId(recordedCall.mFunctionId) << " = "
+                    << recordedCall.mReturnValue << " "
+                    << std::fixed << deltaStartTime << " "
+                    << std::fixed << deltaEndTime
+                    << std::endl;
     }
 
     return traceString.str();
@@ -931,11 +1591,16 @@ uint32 MultithreadedTraceAnalyzerLayer::GetNumTracedAPICalls()
     uint32 totalAPICalls = 0;
 
     // Step through each ThreadTraceData and add up the total number of API calls.
-    ThreadIdToTraceData::iterator threadDataIter;
-    for (threadDataIter = mThreadTraces.begin(); threadDataIter != mThreadTraces.end(); ++threadDataIter)
+    unsigned int numThreads = mThreadTraces.GetNumThreads();
+    for (unsigned int threadIndex = 0; threadIndex < numThreads; ++threadIndex)
     {
-        ThreadTraceData* traceData = threadDataIter->second;
-        totalAPICalls += static_cast<uint32>(traceData->mLoggedCallVector.size());
+        DWORD threadId = 0;
+        ThreadTraceData* traceData = mThreadTraces.GetThreadData(threadIndex, threadId);
+
+        if (traceData != NULL)
+        {
+            totalAPICalls += static_cast<uint32>(traceData->mLoggedCallVector.size());
+        }
     }
 
     return totalAPICalls;
@@ -950,10 +1615,16 @@ uint32 MultithreadedTraceAnalyzerLayer::GetNumTracedDrawCalls()
     uint32 totalDrawCalls = 0;
 
     // Step through each ThreadTraceData and add up the total number of API calls.
-    ThreadIdToTraceData::iterator threadDataIter;
-    for (threadDataIter = mThreadTraces.begin(); threadDataIter != mThreadTraces.end(); ++threadDataIter)
+    unsigned int numThreads = mThreadTraces.GetNumThreads();
+    for (unsigned int threadIndex = 0; threadIndex < numThreads; ++threadIndex)
     {
-        ThreadTraceData* traceData = threadDataIter->second;
+        DWORD threadId = 0;
+        ThreadTraceData* traceData = mThreadTraces.GetThreadData(threadIndex, threadId);
+
+        if (traceData == NULL)
+        {
+            continue;
+        }
 
         size_t numCalls = traceData->mLoggedCallVector.size();
         for (size_t callIndex = 0; callIndex < numCalls; ++callIndex)
@@ -1020,36 +1691,31 @@ bool MultithreadedTraceAnalyzerLayer::OnDestroy(CREATION_TYPE inType, void* pInP
 //--------------------------------------------------------------------------
 void MultithreadedTraceAnalyzerLayer::Clear()
 {
+    // The trace response worker reads the trace buffers, so it has to finish first.
+    FinishTraceResponse(true);
+
     ClearCPUThreadTraceData();
 
-    // We've just killed all the APIEntries above, so our profiling results list is invalid. Clear it as well.
+    // We've just discarded all the APIEntries above, so our profiling results list is invalid. Clear it as well.
     ClearProfilingResults();
 }
 
 //--------------------------------------------------------------------------
 /// Find an existing ThreadTraceData instance to drop things into, or create a new one and insert into the map.
 /// Each thread will receive its own ThreadTraceData instance to log to, allowing multithreaded collection.
-/// \param inThreadId The Id of a thread invoking API calls.
+/// \param inThreadId The Id of the calling thread. Must be the thread that's invoking the API call.
 /// \returns A polymorphic ThreadTraceData instance for the thread to log to without any locking.
 //--------------------------------------------------------------------------
 ThreadTraceData* MultithreadedTraceAnalyzerLayer::FindOrCreateThreadData(DWORD inThreadId)
 {
-    // We don't need to lock yet. map::find is threadsafe.
-    ThreadTraceData* resultTraceData = NULL;
-    ThreadIdToTraceData::iterator traceIter = mThreadTraces.find(inThreadId);
+    // Each thread caches its own instance in thread-local storage, so no lookup or lock is needed here.
+    ThreadTraceData* resultTraceData = mThreadTraces.GetCurrentThreadData();
 
-    if (traceIter != mThreadTraces.end())
+    if (resultTraceData == NULL)
     {
-        resultTraceData = traceIter->second;
-    }
-    else
-    {
-        // We need to lock here- we're going to insert a new instance into our thread trace map.
-        ScopeLock mapInsertionLock(&mTraceMutex);
-
-        // Insert the new ThreadData struct into the map to hold them all.
+        // This is the first call traced on this thread. The registry is safe to append to without locking.
         resultTraceData = CreateThreadTraceDataInstance();
-        mThreadTraces[inThreadId] = resultTraceData;
+        mThreadTraces.Register(inThreadId, resultTraceData);
     }
 
     return resultTraceData;
@@ -10,7 +10,12 @@
 
 #include "../Common/ModernAPILayerManager.h"
 #include "../Common/TraceAnalyzer.h"
-#include "../Common/OSwrappers.h"
+#include "../Common/OSWrappers.h"
+#include "../Common/PackedAPIArguments.h"
+#include "../Common/ArenaAllocator.h"
+#include "../Common/ThreadTraceRegistry.h"
+#include "../Common/FlightRecorder.h"
+#include "../Common/BinaryTraceFile.h"
 #include <map>
 
 static const uint64 s_DummyTimestampValue = 666;
@@ -25,6 +30,8 @@ typedef std::map<FuncId, std::string> FuncIdToNamestringMap;
 
 //--------------------------------------------------------------------------
 /// The APIEntry structure is used to track all calls that are traced at runtime.
+/// APIEntry instances are constructed within a ThreadTraceData's arena, and are
+/// discarded without running their destructors. They must not own any resources.
 //--------------------------------------------------------------------------
 class APIEntry
 {
@@ -32,13 +39,28 @@ public:
     //--------------------------------------------------------------------------
     /// Constructor used to initialize members of new CallData instances.
     /// \param inThreadId The thread Id that the call was invoked from.
-    /// \param inArguments A string containing the arguments of the invoked call.
+    /// \param inArguments A string containing the arguments of the invoked call. Must outlive the APIEntry.
     //--------------------------------------------------------------------------
-    APIEntry(DWORD inThreadId, FuncId inFuncId, const std::string& inArguments)
+    APIEntry(DWORD inThreadId, FuncId inFuncId, const char* inArguments)
     : mThreadId(inThreadId)
+    , mParameters(inArguments)
+    , mPackedArguments(NULL)
+    , mFunctionId(inFuncId)
+    {
+    }
+
+    //--------------------------------------------------------------------------
+    /// Constructor used when the call arguments were captured in binary form.
+    /// The arguments are only converted to text when the trace response is built.
+    /// \param inThreadId The thread Id that the call was invoked from.
+    /// \param inPackedArguments The packed arguments of the invoked call. Must outlive the APIEntry.
+    //--------------------------------------------------------------------------
+    APIEntry(DWORD inThreadId, FuncId inFuncId, const PackedAPIArguments* inPackedArguments)
+    : mThreadId(inThreadId)
+    , mParameters(NULL)
+    , mPackedArguments(inPackedArguments)
     , mFunctionId(inFuncId)
     {
-        mParameters = inArguments.c_str();
     }
 
     //--------------------------------------------------------------------------
@@ -59,12 +81,37 @@ public:
     //--------------------------------------------------------------------------
     virtual void AppendAPITraceLine(std::stringstream& ioTraceResponse, double inStartTime, double inEndTime) const = 0;
 
+    //--------------------------------------------------------------------------
+    /// Add this APIEntry's information to a binary trace. Holds the same fields as the API Trace response line.
+    /// \param ioTraceWriter The binary trace writer to add the call to.
+    /// \param inStartTime The start time for the API call.
+    /// \param inEndTime The end time for the API call.
+    //--------------------------------------------------------------------------
+    virtual void AppendBinaryTraceCall(BinaryTraceWriter& ioTraceWriter, double inStartTime, double inEndTime) const = 0;
+
     //--------------------------------------------------------------------------
     /// Check if this logged APIEntry is a Draw call.
     /// \returns True if the API is a draw call. False if it's not.
     //--------------------------------------------------------------------------
     virtual bool IsDrawCall() const = 0;
 
+    //--------------------------------------------------------------------------
+    /// Retrieve the call parameters as text. Packed arguments are formatted here,
+    /// so this should only be called while building a trace response.
+    /// \param outParameters The string that the call parameters will be written to.
+    //--------------------------------------------------------------------------
+    void GetParameterString(gtASCIIString& outParameters) const
+    {
+        if (mPackedArguments == NULL)
+        {
+            outParameters = (mParameters != NULL) ? mParameters : "";
+        }
+        else
+        {
+            mPackedArguments->ToString(outParameters);
+        }
+    }
+
     //--------------------------------------------------------------------------
     /// The ID of the thread that the call was invoked/logged in.
     //--------------------------------------------------------------------------
@@ -72,8 +119,15 @@ public:
 
     //--------------------------------------------------------------------------
     /// A string with the call parameters. Each API call is printed with its own format string.
+    /// The text is stored in the owning ThreadTraceData's arena.
     //--------------------------------------------------------------------------
-    gtASCIIString mParameters;
+    const char* mParameters;
+
+    //--------------------------------------------------------------------------
+    /// The call parameters in binary form. Used instead of mParameters when not NULL.
+    /// The packed values are stored in the owning ThreadTraceData's arena.
+    //--------------------------------------------------------------------------
+    const PackedAPIArguments* mPackedArguments;
 
     //--------------------------------------------------------------------------
     /// An instance of the FuncId enum. Will be converted to a string before seen in the client.
@@ -124,21 +178,45 @@ public:
         mLoggedCallVector.push_back(inNewEntry);
     }
 
+    //--------------------------------------------------------------------------
+    /// Allocate storage for a new APIEntry from this thread's arena.
+    /// \param inEntrySize The size of the APIEntry subclass that will be constructed.
+    /// \returns Memory for the caller to construct the APIEntry into with placement new.
+    //--------------------------------------------------------------------------
+    void* AllocateEntryMemory(size_t inEntrySize)
+    {
+        return mEntryArena.Allocate(inEntrySize, sizeof(UINT64));
+    }
+
+    //--------------------------------------------------------------------------
+    /// Copy a call's parameter string into this thread's arena.
+    /// \param inParameters The stringified call parameters.
+    /// \returns A copy of the string that stays valid until the next Clear.
+    //--------------------------------------------------------------------------
+    const char* CopyParameterString(const char* inParameters)
+    {
+        return mEntryArena.CopyString(inParameters);
+    }
+
+    //--------------------------------------------------------------------------
+    /// Copy a call's packed arguments into this thread's arena. Only the packed values are kept.
+    /// \param inPackedArguments The packed call parameters.
+    /// \returns A copy of the packed arguments that stays valid until the next Clear.
+    //--------------------------------------------------------------------------
+    const PackedAPIArguments* CopyPackedArguments(const PackedAPIArguments& inPackedArguments)
+    {
+        return inPackedArguments.CopyTo(mEntryArena.Allocate(inPackedArguments.GetPackedSize(), sizeof(UINT64)));
+    }
+
     //--------------------------------------------------------------------------
     /// Clear all logged data in the thread's collection buffer.
+    /// All APIEntries live in the arena, so they are discarded by rewinding it.
     //--------------------------------------------------------------------------
     void Clear()
     {
-        // Invalidate all entries from the previous run.
-        for (size_t callIndex = 0; callIndex < mLoggedCallVector.size(); ++callIndex)
-        {
-            // This instance isn't needed anymore, so destroy it and reclaim pool memory.
-            APIEntry* thisEntry = mLoggedCallVector[callIndex];
-            SAFE_DELETE(thisEntry);
-        }
-
         mLoggedCallVector.clear();
         mAPICallTimer.Clear();
+        mEntryArena.Reset();
     }
 
     //--------------------------------------------------------------------------
@@ -155,6 +233,24 @@ public:
     /// Keep a list of InvocationData structure instances to keep track of CPU calls.
     //--------------------------------------------------------------------------
     std::vector<APIEntry*> mLoggedCallVector;
+
+    //--------------------------------------------------------------------------
+    /// The arena that holds this thread's APIEntry instances and parameter strings.
+    //--------------------------------------------------------------------------
+    ArenaAllocator mEntryArena;
+
+    //--------------------------------------------------------------------------
+    /// Serializes the owning thread logging into this instance with other threads clearing
+    /// or searching it. Each thread has its own lock, so it's only contended while a trace
+    /// is being cleared or read.
+    //--------------------------------------------------------------------------
+    mutex mEntryLock;
+
+    //--------------------------------------------------------------------------
+    /// The most recent calls made by this thread while the flight recorder is active.
+    /// Unlike the logged calls above, these are kept across frames.
+    //--------------------------------------------------------------------------
+    FlightRecorderRing mFlightRecorder;
 };
 
 //--------------------------------------------------------------------------
@@ -218,10 +314,11 @@ public:
     osModuleArchitecture mArchitecture;
 };
 
-//--------------------------------------------------------------------------
-/// A map used to associate a ThreadId with the structure that all the thread's results are stored in.
-//--------------------------------------------------------------------------
-typedef std::map<DWORD, ThreadTraceData*> ThreadIdToTraceData;
+/// Forward declare this, since it holds the trace response worker thread and is only used by the implementation.
+struct TraceResponseJob;
+
+/// Forward declare this, since it holds the flight recorder dump worker thread and is only used by the implementation.
+struct FlightRecorderDumpJob;
 
 //--------------------------------------------------------------------------
 /// Collects API Trace in a multi-threaded manner by mapping each submission
@@ -315,6 +412,20 @@ public:
     //--------------------------------------------------------------------------
     uint32 GetNumTracedAPICalls();
 
+    //--------------------------------------------------------------------------
+    /// Check if the flight recorder is collecting calls during the current frame.
+    /// \returns True if traced calls should be passed to RecordFlightCall instead of being logged as APIEntries.
+    //--------------------------------------------------------------------------
+    bool IsFlightRecording() const { return mbFlightRecording; }
+
+    //--------------------------------------------------------------------------
+    /// Record a traced call into the calling thread's flight recorder ring.
+    /// \param inFunctionId The FuncId for the API function that was called.
+    /// \param inInterface The interface that the call was made through.
+    /// \param inReturnValue The return value for the API call, or FUNCTION_RETURNS_VOID if there is none.
+    //--------------------------------------------------------------------------
+    void RecordFlightCall(FuncId inFunctionId, void* inInterface, INT64 inReturnValue);
+
     //--------------------------------------------------------------------------
     /// Retrieve the number of Draw calls that occurred within a traced frame.
     /// \returns The number of Draw calls that occurred within a traced frame.
@@ -371,23 +482,90 @@ protected:
     virtual string GetDerivedSettings() { return ""; }
 
     //--------------------------------------------------------------------------
-    /// Clear and destroy all ThreadTraceData instances.
+    /// Clear the logged calls in all ThreadTraceData instances. The instances and
+    /// their arenas are kept, so that the next traced frame can reuse them.
     //--------------------------------------------------------------------------
     void ClearCPUThreadTraceData();
 
+    //--------------------------------------------------------------------------
+    /// Destroy all ThreadTraceData instances.
+    //--------------------------------------------------------------------------
+    void DestroyCPUThreadTraceData();
+
     //--------------------------------------------------------------------------
     /// Handle what happens when a Linked Trace is requested. We can either:
     /// 1. Return the trace response as normal.
     /// 2. Cache the response to disk, and generate a "trace metadata" file used
     /// to retrieve the trace later.
+    /// The response is stored in the job, to be sent from the render thread.
     /// \param inFullResponseString The response string built by tracing the application.
-    /// \param inbSaveResponseToFile A switch used to determine which response method to use.
+    /// \param ioJob The traced frame's response job. Its mbSaveToFile switch determines which response method to use.
+    /// \param ioBinaryTrace The binary form of the trace to save instead of the response string, or NULL.
+    /// \param inAPITraceOffset Where the API Trace text goes in the response string.
+    //--------------------------------------------------------------------------
+    void HandleLinkedTraceResponse(std::stringstream& inFullResponseString, TraceResponseJob& ioJob, BinaryTraceWriter* ioBinaryTrace, size_t inAPITraceOffset);
+
+    //--------------------------------------------------------------------------
+    /// Build the response for the frame described by mTraceResponseJob. Used as the entry point for
+    /// the trace response worker thread, which builds the API Trace while the render thread collects
+    /// the GPU Trace, then assembles and saves the response without holding up the next frame.
+    //--------------------------------------------------------------------------
+    void BuildTraceResponse();
+
+    //--------------------------------------------------------------------------
+    /// Send the response built by the trace response worker, once it has finished.
+    /// Must be called from the render thread, since that's where the trace commands are handled.
+    /// \param inbWait If true, wait for the worker to finish. Otherwise return immediately if it's still busy.
+    /// \returns True if there's no trace response being built anymore.
+    //--------------------------------------------------------------------------
+    bool FinishTraceResponse(bool inbWait);
+
+    //--------------------------------------------------------------------------
+    /// Add all of the logged API calls to a binary trace, with one section per traced thread.
+    /// \param outTraceWriter The binary trace writer to add the calls to.
+    /// \param inFrameIndex The index of the traced frame.
     //--------------------------------------------------------------------------
-    void HandleLinkedTraceResponse(std::stringstream& inFullResponseString, bool inbSaveResponseToFile);
+    void BuildBinaryAPITrace(BinaryTraceWriter& outTraceWriter, unsigned int inFrameIndex);
+
+    //--------------------------------------------------------------------------
+    /// Start recording a new frame into the flight recorder.
+    //--------------------------------------------------------------------------
+    void BeginFlightRecorderFrame();
+
+    //--------------------------------------------------------------------------
+    /// Finish recording a frame into the flight recorder. Dumps the recorded frames if
+    /// the frame took longer than the configured threshold. A run of slow frames is only
+    /// dumped once, and dumps are at least s_MinFlightRecorderDumpIntervalMs apart.
+    //--------------------------------------------------------------------------
+    void EndFlightRecorderFrame();
+
+    //--------------------------------------------------------------------------
+    /// Build a text dump of the calls from the frames held in the flight recorder.
+    /// Only the frames for which every thread's calls are still held are dumped, and
+    /// the FrameCount line gives their number, which may be less than was requested.
+    /// \returns A line-delimited, ASCII-encoded, version of the flight recorder contents.
+    //--------------------------------------------------------------------------
+    std::string GetFlightRecorderTXT();
+
+    //--------------------------------------------------------------------------
+    /// Copy the calls from the frames held in the flight recorder out of every thread's ring.
+    /// Only the frames for which every thread's calls are still held are copied.
+    /// \param outSnapshot The copied frames and calls.
+    //--------------------------------------------------------------------------
+    void CopyFlightRecorderCalls(FlightRecorderSnapshot& outSnapshot);
+
+    //--------------------------------------------------------------------------
+    /// Build a text dump of the calls copied out of the flight recorder, with a FrameCount
+    /// line giving the number of frames copied, which may be less than was requested.
+    /// Only reads the snapshot, so it can be called from any thread.
+    /// \param inSnapshot The frames and calls copied by CopyFlightRecorderCalls.
+    /// \returns A line-delimited, ASCII-encoded, version of the flight recorder contents.
+    //--------------------------------------------------------------------------
+    std::string FormatFlightRecorderTXT(const FlightRecorderSnapshot& inSnapshot);
 
     //--------------------------------------------------------------------------
     /// Find thread-private trace data to dump logged calls into.
-    /// \param inThreadId A ThreadId used to lookup or create a corresponding ThreadTraceData instance.
+    /// \param inThreadId The Id of the calling thread, used when a new ThreadTraceData instance is registered.
     /// \returns A new or existing ThreadTraceData instance for use with a specific thread.
     //--------------------------------------------------------------------------
     ThreadTraceData* FindOrCreateThreadData(DWORD inThreadId);
@@ -404,9 +582,12 @@ protected:
     /// Write a trace's metadata file and return the contenst through the out-param.
     /// \param inFullResponseString The full response string for a collected linked trace request.
     /// \param outMetadataXML The XML metadata string to return to the client.
+    /// \param inFrameIndex The index of the traced frame.
+    /// \param inFrameInfo The frame info for the traced frame.
+    /// \param inBinaryTrace The binary form of the trace. When provided, it is written instead of the response string.
     /// \returns True if writing the metadata file was succesful.
     //--------------------------------------------------------------------------
-    bool WriteTraceAndMetadataFiles(const std::stringstream& inFullResponseString, std::string& outMetadataXML);
+    bool WriteTraceAndMetadataFiles(const std::stringstream& inFullResponseString, std::string& outMetadataXML, unsigned int inFrameIndex, const FrameInfo& inFrameInfo, const BinaryTraceWriter* inBinaryTrace = NULL);
 
     //--------------------------------------------------------------------------
     /// Load a trace file from disk when given a valid path.
@@ -438,6 +619,21 @@ protected:
     //--------------------------------------------------------------------------
     CommandResponse mCmdAutoCaptureCachedTrace;
 
+    //--------------------------------------------------------------------------
+    /// A CommandResponse used to retrieve the frames currently held by the flight recorder.
+    //--------------------------------------------------------------------------
+    CommandResponse mCmdFlightRecorderDump;
+
+    //--------------------------------------------------------------------------
+    /// A setting to interleave the API Trace calls from all threads by start time. Defaults to OptionMergeAPITrace.
+    //--------------------------------------------------------------------------
+    BoolCommandResponse mCmdMergeAPITrace;
+
+    //--------------------------------------------------------------------------
+    /// A setting to build trace responses on a worker thread. Defaults to OptionAPITraceWorkerThread.
+    //--------------------------------------------------------------------------
+    BoolCommandResponse mCmdAPITraceWorkerThread;
+
     //--------------------------------------------------------------------------
     /// A flag to indicate if the GPU Trace has already been collected.
     //--------------------------------------------------------------------------
@@ -459,12 +655,13 @@ protected:
     FuncIdToNamestringMap mFunctionIndexToNameString;
 
     //--------------------------------------------------------------------------
-    /// A map of ThreadID -> TraceData, used to buffer logged API calls for each thread.
+    /// The registry of per-thread TraceData, used to buffer logged API calls for each thread.
     //--------------------------------------------------------------------------
-    ThreadIdToTraceData mThreadTraces;
+    ThreadTraceRegistry mThreadTraces;
 
     //--------------------------------------------------------------------------
-    /// Mutex used in cases where the mThreadTraces map can potentially change.
+    /// Mutex used to serialize clearing and searching the mThreadTraces buffers with each other.
+    /// Logging only takes the calling thread's own ThreadTraceData::mEntryLock.
     //--------------------------------------------------------------------------
     mutex mTraceMutex;
 
@@ -489,6 +686,38 @@ protected:
     //--------------------------------------------------------------------------
     bool mbWaitingForAutocaptureClient;
 
+    //--------------------------------------------------------------------------
+    /// A flag to indicate if the flight recorder is collecting calls during the frame.
+    //--------------------------------------------------------------------------
+    bool mbFlightRecording;
+
+    //--------------------------------------------------------------------------
+    /// The index of the frame being recorded by the flight recorder. Incremented at the start of each recorded frame.
+    //--------------------------------------------------------------------------
+    unsigned int mFlightRecorderFrameIndex;
+
+    //--------------------------------------------------------------------------
+    /// The start time and duration of the most recent frames recorded by the flight recorder.
+    //--------------------------------------------------------------------------
+    FlightRecorderFrame mFlightRecorderFrames[s_MaxFlightRecorderFrames];
+
+    //--------------------------------------------------------------------------
+    /// A flag to indicate if a trace was started for the current frame in BeginFrame.
+    //--------------------------------------------------------------------------
+    bool mbTracingFrame;
+
+    //--------------------------------------------------------------------------
+    /// The response being built for the most recently traced frame, and the worker thread building it.
+    /// No new trace is started until the worker has finished. A trace requested by the client
+    /// before then is answered with a busy error, and AutoTrace waits for the worker.
+    //--------------------------------------------------------------------------
+    TraceResponseJob* mTraceResponseJob;
+
+    //--------------------------------------------------------------------------
+    /// The most recent automatic flight recorder dump, which is saved to disk on a worker thread.
+    //--------------------------------------------------------------------------
+    FlightRecorderDumpJob* mFlightRecorderDumpJob;
+
 };
 
 #endif // MULTITHREADEDTRACEANALYZERLAYER_H
@@ -0,0 +1,1042 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Services many HTTP connections from a single thread using epoll,
+///         keeping connections alive between requests.
+//==============================================================================
+
+#ifdef _LINUX
+
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <strings.h>
+#include <unistd.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include "NetConnectionManager.h"
+#include "Logger.h"
+
+/// The epoll data for the listening socket. Connection IDs start after this and s_WakeID.
+static const unsigned int s_ListenID = 0;
+
+/// The epoll data for the eventfd that wakes Poll.
+static const unsigned int s_WakeID = 1;
+
+/// The most events handled by a single call to Poll.
+static const int s_MaxEventsPerPoll = 64;
+
+/// The largest request body that will be accepted. Connections that send a larger body are closed.
+static const size_t s_MaxRequestBodySize = 64 * 1024 * 1024;
+
+/// Response pieces smaller than this are copied, rather than queued by reference, so
+/// that headers and other small pieces don't make the sender wait for the network.
+static const size_t s_MaxCopiedSegmentSize = 16 * 1024;
+
+/// The most pieces of response data gathered into a single send.
+static const int s_MaxSendVectors = 64;
+
+//--------------------------------------------------------------------------
+/// Lets a call to SendResponseData wait for the data it queued by reference.
+//--------------------------------------------------------------------------
+struct NetSendCompletion
+{
+    NetSendCompletion()
+        : mNumPending(0)
+        , mbDropped(false)
+    {
+        pthread_mutex_init(&mLock, NULL);
+        pthread_cond_init(&mSignal, NULL);
+    }
+
+    ~NetSendCompletion()
+    {
+        pthread_cond_destroy(&mSignal);
+        pthread_mutex_destroy(&mLock);
+    }
+
+    /// Protects the rest of the completion.
+    pthread_mutex_t mLock;
+
+    /// Signaled each time one of the segments is sent or dropped.
+    pthread_cond_t mSignal;
+
+    /// The number of segments that haven't been sent or dropped yet.
+    unsigned int mNumPending;
+
+    /// True if any of the segments were dropped because the connection closed.
+    bool mbDropped;
+};
+
+//--------------------------------------------------------------------------
+/// Find the value of a header field in an HTTP request header.
+/// \param inHeader The request header.
+/// \param inName The name of the field to find. Field names are case-insensitive.
+/// \param outValue The value of the field, without surrounding whitespace.
+/// \returns True if the field was found, false if it wasn't.
+//--------------------------------------------------------------------------
+static bool FindHeaderField(const std::string& inHeader, const char* inName, std::string& outValue)
+{
+    size_t nameLength = strlen(inName);
+
+    // skip the request line
+    size_t lineStart = inHeader.find("\r\n");
+
+    while (lineStart != std::string::npos)
+    {
+        lineStart += 2;
+        size_t lineEnd = inHeader.find("\r\n", lineStart);
+
+        if (lineEnd == std::string::npos)
+        {
+            break;
+        }
+
+        if ((lineEnd - lineStart) > nameLength &&
+            inHeader[lineStart + nameLength] == ':' &&
+            strncasecmp(inHeader.c_str() + lineStart, inName, nameLength) == 0)
+        {
+            size_t valueStart = inHeader.find_first_not_of(" \t", lineStart + nameLength + 1);
+            size_t valueEnd = inHeader.find_last_not_of(" \t", lineEnd - 1);
+
+            if (valueStart == std::string::npos || valueStart >= lineEnd)
+            {
+                outValue.clear();
+            }
+            else
+            {
+                outValue = inHeader.substr(valueStart, valueEnd + 1 - valueStart);
+            }
+
+            return true;
+        }
+
+        lineStart = lineEnd;
+    }
+
+    return false;
+}
+
+//--------------------------------------------------------------------------
+/// Retrieve the reason phrase for an HTTP status code.
+/// \param inStatusCode The status code.
+/// \returns The reason phrase, which is empty for unusual codes.
+//--------------------------------------------------------------------------
+static const char* GetReasonPhrase(int inStatusCode)
+{
+    switch (inStatusCode)
+    {
+        case 200: return "OK";
+        case 301: return "Moved Permanently";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 500: return "Internal Server Error";
+        default:  return "";
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Constructor.
+/// \param inHandler The handler that is given each request.
+//--------------------------------------------------------------------------
+NetConnectionManager::NetConnectionManager(INetRequestHandler* inHandler)
+    : mHandler(inHandler)
+    , mListenSocket(NULL)
+    , mEpollFD(-1)
+    , mWakeFD(-1)
+    , mNextConnectionID(s_WakeID + 1)
+    , mbPollThreadKnown(false)
+{
+    mEpollFD = epoll_create1(EPOLL_CLOEXEC);
+
+    if (mEpollFD == -1)
+    {
+        Log(logERROR, "NetConnectionManager: Failed to create epoll instance. Error %d\n", errno);
+        return;
+    }
+
+    mWakeFD = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    if (mWakeFD == -1)
+    {
+        Log(logERROR, "NetConnectionManager: Failed to create eventfd. Error %d\n", errno);
+        return;
+    }
+
+    epoll_event wakeEvent;
+    wakeEvent.events = EPOLLIN;
+    wakeEvent.data.u64 = 0;
+    wakeEvent.data.u32 = s_WakeID;
+
+    if (epoll_ctl(mEpollFD, EPOLL_CTL_ADD, mWakeFD, &wakeEvent) == -1)
+    {
+        Log(logERROR, "NetConnectionManager: Failed to watch eventfd. Error %d\n", errno);
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Destructor. Closes every connection, and the listening socket.
+//--------------------------------------------------------------------------
+NetConnectionManager::~NetConnectionManager()
+{
+    ScopeLock lock(&mConnectionsLock);
+
+    while (mConnections.empty() == false)
+    {
+        CloseConnection(mConnections.begin()->first);
+    }
+
+    if (mListenSocket != NULL)
+    {
+        mListenSocket->close();
+        mListenSocket = NULL;
+    }
+
+    if (mWakeFD != -1)
+    {
+        ::close(mWakeFD);
+    }
+
+    if (mEpollFD != -1)
+    {
+        ::close(mEpollFD);
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Start accepting connections on the given port.
+/// \param inPort The port to listen on.
+/// \returns True if the port is being listened on, false if there was an error.
+//--------------------------------------------------------------------------
+bool NetConnectionManager::Listen(u_short inPort)
+{
+    if (mEpollFD == -1 || mWakeFD == -1 || mListenSocket != NULL)
+    {
+        return false;
+    }
+
+    mListenSocket = NetSocket::Create();
+
+    if (mListenSocket == NULL)
+    {
+        Log(logERROR, "NetConnectionManager: Failed to create listening socket. Error %d\n", NetSocket::LastError());
+        return false;
+    }
+
+    if (mListenSocket->Bind(inPort) == false ||
+        mListenSocket->Listen() == false ||
+        mListenSocket->SetNonBlocking(true) == false)
+    {
+        Log(logERROR, "NetConnectionManager: Failed to listen on port %u. Error %d\n", inPort, NetSocket::LastError());
+        mListenSocket->close();
+        mListenSocket = NULL;
+        return false;
+    }
+
+    epoll_event listenEvent;
+    listenEvent.events = EPOLLIN;
+    listenEvent.data.u64 = 0;
+    listenEvent.data.u32 = s_ListenID;
+
+    if (epoll_ctl(mEpollFD, EPOLL_CTL_ADD, mListenSocket->GetSocketDescriptor(), &listenEvent) == -1)
+    {
+        Log(logERROR, "NetConnectionManager: Failed to watch listening socket. Error %d\n", errno);
+        mListenSocket->close();
+        mListenSocket = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------
+/// Wait for activity on any connection, and service it. Must always be called from the same thread.
+/// \param inTimeoutMs The longest time to wait for activity, in milliseconds. -1 waits indefinitely.
+/// \returns False if there was an error waiting, true otherwise.
+//--------------------------------------------------------------------------
+bool NetConnectionManager::Poll(int inTimeoutMs)
+{
+    if (mbPollThreadKnown == false)
+    {
+        // sendfile has no MSG_NOSIGNAL, so keep a client that disconnects from raising SIGPIPE
+        sigset_t pipeSignal;
+        sigemptyset(&pipeSignal);
+        sigaddset(&pipeSignal, SIGPIPE);
+        pthread_sigmask(SIG_BLOCK, &pipeSignal, NULL);
+
+        ScopeLock lock(&mConnectionsLock);
+        mPollThread = pthread_self();
+        mbPollThreadKnown = true;
+    }
+
+    epoll_event events[s_MaxEventsPerPoll];
+    int numEvents = epoll_wait(mEpollFD, events, s_MaxEventsPerPoll, inTimeoutMs);
+
+    if (numEvents == -1)
+    {
+        if (errno == EINTR)
+        {
+            return true;
+        }
+
+        Log(logERROR, "NetConnectionManager: epoll_wait failed. Error %d\n", errno);
+        return false;
+    }
+
+    std::vector<NetRequest> requests;
+
+    {
+        ScopeLock lock(&mConnectionsLock);
+
+        for (int i = 0; i < numEvents; i++)
+        {
+            unsigned int id = events[i].data.u32;
+
+            if (id == s_ListenID)
+            {
+                AcceptConnections();
+            }
+            else if (id == s_WakeID)
+            {
+                // Just clear the eventfd. The connections to write are in mConnectionsToWrite.
+                uint64_t wakeCount = 0;
+
+                if (read(mWakeFD, &wakeCount, sizeof(wakeCount)) == -1 && errno != EAGAIN)
+                {
+                    Log(logERROR, "NetConnectionManager: Failed to read eventfd. Error %d\n", errno);
+                }
+            }
+            else if ((events[i].events & (EPOLLERR | EPOLLHUP)) != 0)
+            {
+                CloseConnection(id);
+            }
+            else
+            {
+                if ((events[i].events & (EPOLLIN | EPOLLRDHUP)) != 0)
+                {
+                    ReadConnection(id, requests);
+                }
+
+                if ((events[i].events & EPOLLOUT) != 0 && mConnections.find(id) != mConnections.end())
+                {
+                    mConnectionsToWrite.insert(id);
+                }
+            }
+        }
+    }
+
+    // Keep going until no more requests are waiting. Responses sent by the handler, and
+    // requests that were waiting for room in a connection's pipeline, are dealt with here
+    // rather than waiting for the next Poll.
+    for (;;)
+    {
+        for (std::vector<NetRequest>::const_iterator iter = requests.begin(); iter != requests.end(); ++iter)
+        {
+            mHandler->OnRequest(*this, *iter);
+        }
+
+        requests.clear();
+
+        ScopeLock lock(&mConnectionsLock);
+
+        std::set<unsigned int> connectionsToWrite;
+        connectionsToWrite.swap(mConnectionsToWrite);
+
+        for (std::set<unsigned int>::const_iterator iter = connectionsToWrite.begin(); iter != connectionsToWrite.end(); ++iter)
+        {
+            WriteConnection(*iter, requests);
+        }
+
+        if (requests.empty())
+        {
+            break;
+        }
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------
+/// Queue the response to a request. May be called from any thread.
+/// \param inRequest The request being responded to.
+/// \param inStatusCode The HTTP status code of the response.
+/// \param inMimeType The content type of the response.
+/// \param inData The response body.
+/// \param inSize The number of bytes in the response body.
+/// \returns True if the response was queued, false if the connection has been closed.
+//--------------------------------------------------------------------------
+bool NetConnectionManager::SendResponse(const NetRequest& inRequest, int inStatusCode, const char* inMimeType, const char* inData, size_t inSize)
+{
+    char header[512];
+    int headerSize = snprintf(header, sizeof(header), "HTTP/1.1 %d %s\r\n"
+                              "Content-Type: %s\r\n"
+                              "Content-Length: %zu\r\n"
+                              "Connection: %s\r\n"
+                              "\r\n",
+                              inStatusCode, GetReasonPhrase(inStatusCode),
+                              inMimeType,
+                              inSize,
+                              inRequest.mbKeepAlive ? "keep-alive" : "close");
+
+    if (headerSize < 0 || (size_t)headerSize >= sizeof(header))
+    {
+        Log(logERROR, "NetConnectionManager: The response header for content type '%s' is too large.\n", inMimeType);
+        return false;
+    }
+
+    NetSocket::SendBuffer buffers[] = { { header, (size_t)headerSize }, { inData, inSize } };
+    return SendResponseData(inRequest, buffers, sizeof(buffers) / sizeof(buffers[0]), NULL, 0, true);
+}
+
+//--------------------------------------------------------------------------
+/// Queue part of the response to a request, including its header, which the
+/// caller formats. The response to the next request on the connection isn't
+/// sent until this one is finished. Larger pieces and the file are sent by
+/// reference, and this waits until they have been, unless it is called on the
+/// polling thread. May be called from any thread.
+/// \param inRequest The request being responded to.
+/// \param inBuffers The pieces of data to queue, one after the other.
+/// \param inNumBuffers The number of pieces.
+/// \param inFile A file whose contents follow the pieces, sent from its start, or NULL.
+/// \param inFileSize The number of bytes of inFile to send.
+/// \param inbFinished True if this is the last part of the response.
+/// \returns True if the data was queued, false if the connection has been closed or the response was already finished.
+//--------------------------------------------------------------------------
+bool NetConnectionManager::SendResponseData(const NetRequest& inRequest, const NetSocket::SendBuffer* inBuffers, unsigned int inNumBuffers, FILE* inFile, size_t inFileSize, bool inbFinished)
+{
+    NetSendCompletion completion;
+    std::string fileCopy;
+
+    {
+        ScopeLock lock(&mConnectionsLock);
+
+        std::map<unsigned int, Connection*>::iterator connectionIter = mConnections.find(inRequest.mConnectionID);
+
+        // the connection may have been closed, or the request already answered
+        if (connectionIter == mConnections.end() ||
+            inRequest.mSequence - connectionIter->second->mNextResponseSequence >= s_MaxPipelinedRequests)
+        {
+            return false;
+        }
+
+        std::map<unsigned int, QueuedResponse>& queuedResponses = connectionIter->second->mQueuedResponses;
+        std::map<unsigned int, QueuedResponse>::iterator responseIter = queuedResponses.find(inRequest.mSequence);
+
+        if (responseIter == queuedResponses.end())
+        {
+            responseIter = queuedResponses.insert(std::make_pair(inRequest.mSequence, QueuedResponse())).first;
+            responseIter->second.mbFinished = false;
+            responseIter->second.mbCloseConnection = false;
+        }
+        else if (responseIter->second.mbFinished)
+        {
+            return false;
+        }
+
+        // the polling thread sends the data, so it can't wait for it to be sent
+        bool bCopyAll = (mbPollThreadKnown && pthread_equal(pthread_self(), mPollThread) != 0);
+
+        if (bCopyAll && inFile != NULL && inFileSize > 0)
+        {
+            fileCopy.resize(inFileSize);
+
+            if (pread(fileno(inFile), &fileCopy[0], inFileSize, 0) != (ssize_t)inFileSize)
+            {
+                Log(logERROR, "NetConnectionManager: Failed to read a response file. Error %d\n", errno);
+                return false;
+            }
+        }
+
+        std::deque<OutboundSegment>& segments = responseIter->second.mSegments;
+
+        for (unsigned int i = 0; i < inNumBuffers; i++)
+        {
+            if (inBuffers[i].size == 0)
+            {
+                continue;
+            }
+
+            if (bCopyAll || inBuffers[i].size < s_MaxCopiedSegmentSize)
+            {
+                // add small pieces to the previous copy, so they go out together
+                if (segments.empty() || segments.back().mData != NULL || segments.back().mFileDescriptor != -1)
+                {
+                    OutboundSegment segment;
+                    segment.mData = NULL;
+                    segment.mFileDescriptor = -1;
+                    segment.mFileOffset = 0;
+                    segment.mSize = 0;
+                    segment.mSent = 0;
+                    segment.mCompletion = NULL;
+                    segments.push_back(segment);
+                }
+
+                segments.back().mCopy.append((const char*)inBuffers[i].pData, inBuffers[i].size);
+                segments.back().mSize = segments.back().mCopy.size();
+            }
+            else
+            {
+                OutboundSegment segment;
+                segment.mData = (const char*)inBuffers[i].pData;
+                segment.mFileDescriptor = -1;
+                segment.mFileOffset = 0;
+                segment.mSize = inBuffers[i].size;
+                segment.mSent = 0;
+                segment.mCompletion = &completion;
+                segments.push_back(segment);
+
+                completion.mNumPending++;
+            }
+        }
+
+        if (inFile != NULL && inFileSize > 0)
+        {
+            OutboundSegment segment;
+            segment.mData = NULL;
+            segment.mFileDescriptor = -1;
+            segment.mFileOffset = 0;
+            segment.mSize = inFileSize;
+            segment.mSent = 0;
+            segment.mCompletion = NULL;
+
+            if (bCopyAll)
+            {
+                segment.mCopy.swap(fileCopy);
+            }
+            else
+            {
+                segment.mFileDescriptor = fileno(inFile);
+                segment.mCompletion = &completion;
+                completion.mNumPending++;
+            }
+
+            segments.push_back(segment);
+        }
+
+        responseIter->second.mbFinished = inbFinished;
+        responseIter->second.mbCloseConnection = (inRequest.mbKeepAlive == false);
+
+        mConnectionsToWrite.insert(inRequest.mConnectionID);
+    }
+
+    // wake Poll, in case this was called on another thread
+    uint64_t wakeCount = 1;
+
+    if (write(mWakeFD, &wakeCount, sizeof(wakeCount)) == -1 && errno != EAGAIN)
+    {
+        Log(logERROR, "NetConnectionManager: Failed to write eventfd. Error %d\n", errno);
+    }
+
+    // the data that isn't copied has to stay valid until it has been sent
+    pthread_mutex_lock(&completion.mLock);
+
+    while (completion.mNumPending > 0)
+    {
+        pthread_cond_wait(&completion.mSignal, &completion.mLock);
+    }
+
+    bool bSent = (completion.mbDropped == false);
+    pthread_mutex_unlock(&completion.mLock);
+
+    return bSent;
+}
+
+//--------------------------------------------------------------------------
+/// Retrieve the number of connections that are currently open.
+/// \returns The number of open connections.
+//--------------------------------------------------------------------------
+unsigned int NetConnectionManager::GetNumConnections() const
+{
+    ScopeLock lock(&mConnectionsLock);
+    return (unsigned int)mConnections.size();
+}
+
+//--------------------------------------------------------------------------
+/// Accept every pending connection on the listening socket.
+//--------------------------------------------------------------------------
+void NetConnectionManager::AcceptConnections()
+{
+    // The listening socket is non-blocking, so this stops once there are no more pending connections.
+    NetSocket* clientSocket = NULL;
+
+    while ((clientSocket = mListenSocket->Accept(NULL, NULL)) != NULL)
+    {
+        if (clientSocket->SetNonBlocking(true) == false)
+        {
+            Log(logERROR, "NetConnectionManager: Failed to make connection non-blocking. Error %d\n", NetSocket::LastError());
+            clientSocket->close();
+            continue;
+        }
+
+        // Responses are written in one piece, so don't let Nagle's algorithm hold back the end of them.
+        int noDelay = 1;
+        setsockopt(clientSocket->GetSocketDescriptor(), IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+        unsigned int id = mNextConnectionID++;
+
+        Connection* connection = new Connection;
+        connection->mSocket = clientSocket;
+        connection->mHeaderSearchOffset = 0;
+        connection->mNextRequestSequence = 0;
+        connection->mNextResponseSequence = 0;
+        connection->mbCloseWhenAnswered = false;
+        connection->mbPeerClosed = false;
+        connection->mWatchedEvents = EPOLLIN | EPOLLRDHUP;
+
+        epoll_event connectionEvent;
+        connectionEvent.events = connection->mWatchedEvents;
+        connectionEvent.data.u64 = 0;
+        connectionEvent.data.u32 = id;
+
+        if (epoll_ctl(mEpollFD, EPOLL_CTL_ADD, clientSocket->GetSocketDescriptor(), &connectionEvent) == -1)
+        {
+            Log(logERROR, "NetConnectionManager: Failed to watch connection. Error %d\n", errno);
+            clientSocket->close();
+            delete connection;
+            continue;
+        }
+
+        mConnections[id] = connection;
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Receive all available data on a connection, and split it into requests.
+/// \param inConnectionID The connection to read.
+/// \param outRequests The complete requests that were received.
+//--------------------------------------------------------------------------
+void NetConnectionManager::ReadConnection(unsigned int inConnectionID, std::vector<NetRequest>& outRequests)
+{
+    std::map<unsigned int, Connection*>::iterator connectionIter = mConnections.find(inConnectionID);
+
+    if (connectionIter == mConnections.end())
+    {
+        return;
+    }
+
+    Connection& connection = *connectionIter->second;
+    osSocketDescriptor socket = connection.mSocket->GetSocketDescriptor();
+
+    char receiveBuffer[64 * 1024];
+
+    for (;;)
+    {
+        ssize_t numReceived = recv(socket, receiveBuffer, sizeof(receiveBuffer), 0);
+
+        if (numReceived > 0)
+        {
+            connection.mReceived.append(receiveBuffer, numReceived);
+        }
+        else if (numReceived == 0)
+        {
+            // The client won't send any more requests, but may still be waiting for responses.
+            connection.mbPeerClosed = true;
+            break;
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            break;
+        }
+        else if (errno != EINTR)
+        {
+            CloseConnection(inConnectionID);
+            return;
+        }
+    }
+
+    if (ParseRequests(inConnectionID, connection, outRequests) == false)
+    {
+        CloseConnection(inConnectionID);
+        return;
+    }
+
+    if (CloseConnectionIfFinished(inConnectionID, connection) == false)
+    {
+        UpdateWatchedEvents(inConnectionID, connection);
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Split as many complete requests as possible off the data received on a connection.
+/// \param inConnectionID The ID of the connection.
+/// \param ioConnection The connection.
+/// \param outRequests The complete requests that were found.
+/// \returns False if the data is not valid HTTP and the connection should be closed, true otherwise.
+//--------------------------------------------------------------------------
+bool NetConnectionManager::ParseRequests(unsigned int inConnectionID, Connection& ioConnection, std::vector<NetRequest>& outRequests)
+{
+    // Requests after one that closes the connection are ignored. Requests past the
+    // pipeline limit are left until earlier ones have been answered.
+    while (ioConnection.mbCloseWhenAnswered == false)
+    {
+        if (ioConnection.mNextRequestSequence - ioConnection.mNextResponseSequence >= s_MaxPipelinedRequests)
+        {
+            break;
+        }
+
+        // Only search the data that arrived since the last search, plus enough to catch a terminator split between reads.
+        size_t headerEnd = ioConnection.mReceived.find("\r\n\r\n", ioConnection.mHeaderSearchOffset);
+
+        if (headerEnd == std::string::npos)
+        {
+            if (ioConnection.mReceived.size() > s_MaxRequestHeaderSize)
+            {
+                Log(logWARNING, "NetConnectionManager: Closing connection that sent a header larger than %u bytes.\n", (unsigned int)s_MaxRequestHeaderSize);
+                return false;
+            }
+
+            ioConnection.mHeaderSearchOffset = (ioConnection.mReceived.size() > 3) ? ioConnection.mReceived.size() - 3 : 0;
+            break;
+        }
+
+        size_t headerSize = headerEnd + 4;
+
+        if (headerSize > s_MaxRequestHeaderSize)
+        {
+            Log(logWARNING, "NetConnectionManager: Closing connection that sent a header larger than %u bytes.\n", (unsigned int)s_MaxRequestHeaderSize);
+            return false;
+        }
+
+        NetRequest request;
+        request.mConnectionID = inConnectionID;
+        request.mHeader.assign(ioConnection.mReceived, 0, headerSize);
+
+        std::string fieldValue;
+        size_t bodySize = 0;
+
+        if (FindHeaderField(request.mHeader, "Content-Length", fieldValue))
+        {
+            char* pEnd = NULL;
+            unsigned long long contentLength = strtoull(fieldValue.c_str(), &pEnd, 10);
+
+            if (pEnd == fieldValue.c_str() || contentLength > s_MaxRequestBodySize)
+            {
+                Log(logWARNING, "NetConnectionManager: Closing connection that sent an invalid Content-Length '%s'.\n", fieldValue.c_str());
+                return false;
+            }
+
+            bodySize = (size_t)contentLength;
+        }
+
+        if (ioConnection.mReceived.size() < headerSize + bodySize)
+        {
+            // The header is complete, but the body isn't. Don't search the header again.
+            ioConnection.mHeaderSearchOffset = headerEnd;
+            break;
+        }
+
+        request.mBody.assign(ioConnection.mReceived, headerSize, bodySize);
+
+        // HTTP/1.1 connections stay open unless the client says otherwise. Earlier versions close unless the client asks for keep-alive.
+        size_t requestLineEnd = request.mHeader.find("\r\n");
+        bool bIsHTTP11 = (request.mHeader.rfind("HTTP/1.1", requestLineEnd) != std::string::npos);
+
+        if (FindHeaderField(request.mHeader, "Connection", fieldValue))
+        {
+            request.mbKeepAlive = bIsHTTP11 ? (strcasecmp(fieldValue.c_str(), "close") != 0) : (strcasecmp(fieldValue.c_str(), "keep-alive") == 0);
+        }
+        else
+        {
+            request.mbKeepAlive = bIsHTTP11;
+        }
+
+        request.mSequence = ioConnection.mNextRequestSequence++;
+
+        ioConnection.mReceived.erase(0, headerSize + bodySize);
+        ioConnection.mHeaderSearchOffset = 0;
+
+        if (request.mbKeepAlive == false)
+        {
+            ioConnection.mbCloseWhenAnswered = true;
+        }
+
+        outRequests.push_back(request);
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------
+/// Send as much queued response data on a connection as the socket will take.
+/// \param inConnectionID The connection to write.
+/// \param outRequests Pipelined requests that can be handled now that responses have been sent.
+//--------------------------------------------------------------------------
+void NetConnectionManager::WriteConnection(unsigned int inConnectionID, std::vector<NetRequest>& outRequests)
+{
+    std::map<unsigned int, Connection*>::iterator connectionIter = mConnections.find(inConnectionID);
+
+    if (connectionIter == mConnections.end())
+    {
+        return;
+    }
+
+    Connection& connection = *connectionIter->second;
+
+    // Move queued responses to the outbound queue, but only in the order the requests arrived.
+    std::map<unsigned int, QueuedResponse>::iterator responseIter;
+
+    while ((responseIter = connection.mQueuedResponses.find(connection.mNextResponseSequence)) != connection.mQueuedResponses.end())
+    {
+        QueuedResponse& response = responseIter->second;
+
+        connection.mOutbound.insert(connection.mOutbound.end(), response.mSegments.begin(), response.mSegments.end());
+        response.mSegments.clear();
+
+        if (response.mbFinished == false)
+        {
+            // the rest of this response hasn't been queued yet
+            break;
+        }
+
+        connection.mNextResponseSequence++;
+
+        if (response.mbCloseConnection)
+        {
+            // Nothing can follow this response, so drop any requests that were pipelined after it.
+            DropResponses(connection.mQueuedResponses);
+            connection.mNextRequestSequence = connection.mNextResponseSequence;
+            connection.mbCloseWhenAnswered = true;
+            break;
+        }
+
+        connection.mQueuedResponses.erase(responseIter);
+    }
+
+    osSocketDescriptor socket = connection.mSocket->GetSocketDescriptor();
+
+    while (connection.mOutbound.empty() == false)
+    {
+        OutboundSegment& front = connection.mOutbound.front();
+        ssize_t numSent = 0;
+
+        if (front.mFileDescriptor != -1)
+        {
+            off_t offset = front.mFileOffset + (off_t)front.mSent;
+            numSent = sendfile(socket, front.mFileDescriptor, &offset, front.mSize - front.mSent);
+
+            if (numSent == 0)
+            {
+                Log(logERROR, "NetConnectionManager: A response file is shorter than its Content-Length.\n");
+                CloseConnection(inConnectionID);
+                return;
+            }
+        }
+        else
+        {
+            // Gather the pieces up to the next file into a single send.
+            iovec vectors[s_MaxSendVectors];
+            int numVectors = 0;
+            std::deque<OutboundSegment>::const_iterator iter = connection.mOutbound.begin();
+
+            for (; iter != connection.mOutbound.end() && iter->mFileDescriptor == -1 && numVectors < s_MaxSendVectors; ++iter)
+            {
+                const char* data = (iter->mData != NULL) ? iter->mData : iter->mCopy.data();
+                vectors[numVectors].iov_base = (void*)(data + iter->mSent);
+                vectors[numVectors].iov_len = iter->mSize - iter->mSent;
+                numVectors++;
+            }
+
+            msghdr message = {};
+            message.msg_iov = vectors;
+            message.msg_iovlen = numVectors;
+
+            // Let a header go out in the same packets as the start of the file that follows it.
+            bool bFileFollows = (iter != connection.mOutbound.end() && iter->mFileDescriptor != -1);
+            numSent = sendmsg(socket, &message, MSG_NOSIGNAL | (bFileFollows ? MSG_MORE : 0));
+        }
+
+        if (numSent >= 0)
+        {
+            ConsumeOutbound(connection, (size_t)numSent);
+        }
+        else if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            break;
+        }
+        else if (errno != EINTR)
+        {
+            CloseConnection(inConnectionID);
+            return;
+        }
+    }
+
+    // Requests that were held back by the pipeline limit may now be handled.
+    if (ParseRequests(inConnectionID, connection, outRequests) == false)
+    {
+        CloseConnection(inConnectionID);
+        return;
+    }
+
+    if (CloseConnectionIfFinished(inConnectionID, connection) == false)
+    {
+        UpdateWatchedEvents(inConnectionID, connection);
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Remove data that was sent from the front of a connection's outbound queue.
+/// \param ioConnection The connection.
+/// \param inNumSent The number of bytes that were sent.
+//--------------------------------------------------------------------------
+void NetConnectionManager::ConsumeOutbound(Connection& ioConnection, size_t inNumSent)
+{
+    // Empty segments are never queued, so every segment is removed by the send that finishes it.
+    while (inNumSent > 0)
+    {
+        OutboundSegment& front = ioConnection.mOutbound.front();
+        size_t numConsumed = (inNumSent < front.mSize - front.mSent) ? inNumSent : front.mSize - front.mSent;
+
+        front.mSent += numConsumed;
+        inNumSent -= numConsumed;
+
+        if (front.mSent < front.mSize)
+        {
+            break;
+        }
+
+        CompleteSegment(front, false);
+        ioConnection.mOutbound.pop_front();
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Tell the sender of a segment that isn't copied that it has been sent or dropped.
+/// \param inSegment The segment.
+/// \param inbDropped True if the segment was dropped rather than sent.
+//--------------------------------------------------------------------------
+void NetConnectionManager::CompleteSegment(const OutboundSegment& inSegment, bool inbDropped)
+{
+    NetSendCompletion* completion = inSegment.mCompletion;
+
+    if (completion != NULL)
+    {
+        pthread_mutex_lock(&completion->mLock);
+
+        completion->mNumPending--;
+        completion->mbDropped |= inbDropped;
+
+        // Signal while the lock is held, since the sender may destroy the completion as soon as it sees this.
+        pthread_cond_signal(&completion->mSignal);
+        pthread_mutex_unlock(&completion->mLock);
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Forget segments that will never be sent, telling their senders.
+/// \param ioSegments The segments to drop.
+//--------------------------------------------------------------------------
+void NetConnectionManager::DropSegments(std::deque<OutboundSegment>& ioSegments)
+{
+    for (std::deque<OutboundSegment>::const_iterator iter = ioSegments.begin(); iter != ioSegments.end(); ++iter)
+    {
+        CompleteSegment(*iter, true);
+    }
+
+    ioSegments.clear();
+}
+
+//--------------------------------------------------------------------------
+/// Forget responses that will never be sent, telling their senders.
+/// \param ioResponses The responses to drop.
+//--------------------------------------------------------------------------
+void NetConnectionManager::DropResponses(std::map<unsigned int, QueuedResponse>& ioResponses)
+{
+    for (std::map<unsigned int, QueuedResponse>::iterator iter = ioResponses.begin(); iter != ioResponses.end(); ++iter)
+    {
+        DropSegments(iter->second.mSegments);
+    }
+
+    ioResponses.clear();
+}
+
+//--------------------------------------------------------------------------
+/// Close a connection if every request on it has been answered and no more will arrive.
+/// \param inConnectionID The ID of the connection.
+/// \param inConnection The connection.
+/// \returns True if the connection was closed.
+//--------------------------------------------------------------------------
+bool NetConnectionManager::CloseConnectionIfFinished(unsigned int inConnectionID, const Connection& inConnection)
+{
+    if ((inConnection.mbCloseWhenAnswered || inConnection.mbPeerClosed) &&
+        inConnection.mNextResponseSequence == inConnection.mNextRequestSequence &&
+        inConnection.mOutbound.empty())
+    {
+        CloseConnection(inConnectionID);
+        return true;
+    }
+
+    return false;
+}
+
+//--------------------------------------------------------------------------
+/// Stop watching a connection, close its socket, and forget it.
+/// \param inConnectionID The connection to close.
+//--------------------------------------------------------------------------
+void NetConnectionManager::CloseConnection(unsigned int inConnectionID)
+{
+    std::map<unsigned int, Connection*>::iterator connectionIter = mConnections.find(inConnectionID);
+
+    if (connectionIter == mConnections.end())
+    {
+        return;
+    }
+
+    Connection* connection = connectionIter->second;
+
+    epoll_ctl(mEpollFD, EPOLL_CTL_DEL, connection->mSocket->GetSocketDescriptor(), NULL);
+    connection->mSocket->close();
+
+    DropSegments(connection->mOutbound);
+    DropResponses(connection->mQueuedResponses);
+
+    delete connection;
+    mConnections.erase(connectionIter);
+    mConnectionsToWrite.erase(inConnectionID);
+}
+
+//--------------------------------------------------------------------------
+/// Make epoll watch a connection for the events that it is currently able to handle.
+/// \param inConnectionID The connection.
+/// \param ioConnection The connection's state.
+//--------------------------------------------------------------------------
+void NetConnectionManager::UpdateWatchedEvents(unsigned int inConnectionID, Connection& ioConnection)
+{
+    unsigned int events = 0;
+
+    // Epoll is level-triggered, so stop watching for input that won't be read yet.
+    if (ioConnection.mbPeerClosed == false &&
+        ioConnection.mbCloseWhenAnswered == false &&
+        ioConnection.mNextRequestSequence - ioConnection.mNextResponseSequence < s_MaxPipelinedRequests)
+    {
+        events |= EPOLLIN | EPOLLRDHUP;
+    }
+
+    if (ioConnection.mOutbound.empty() == false)
+    {
+        events |= EPOLLOUT;
+    }
+
+    if (events != ioConnection.mWatchedEvents)
+    {
+        epoll_event connectionEvent;
+        connectionEvent.events = events;
+        connectionEvent.data.u64 = 0;
+        connectionEvent.data.u32 = inConnectionID;
+
+        if (epoll_ctl(mEpollFD, EPOLL_CTL_MOD, ioConnection.mSocket->GetSocketDescriptor(), &connectionEvent) == -1)
+        {
+            Log(logERROR, "NetConnectionManager: Failed to change the events watched on a connection. Error %d\n", errno);
+        }
+
+        ioConnection.mWatchedEvents = events;
+    }
+}
+
+#endif // _LINUX
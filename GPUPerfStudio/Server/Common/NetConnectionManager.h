@@ -0,0 +1,366 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Services many HTTP connections from a single thread using epoll,
+///         keeping connections alive between requests.
+//==============================================================================
+
+#ifndef NETCONNECTIONMANAGER_H
+#define NETCONNECTIONMANAGER_H
+
+#ifdef _LINUX
+
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include <stdio.h>
+#include <sys/types.h>
+#include "NetSocket.h"
+#include "mymutex.h"
+
+class NetConnectionManager;
+struct NetSendCompletion;
+
+//--------------------------------------------------------------------------
+/// The most requests that may be waiting for a response on one connection.
+/// Pipelined requests beyond this are left unread until responses are sent.
+//--------------------------------------------------------------------------
+static const unsigned int s_MaxPipelinedRequests = 32;
+
+//--------------------------------------------------------------------------
+/// The largest HTTP request header that will be accepted. Connections that
+/// send a larger header are closed.
+//--------------------------------------------------------------------------
+static const size_t s_MaxRequestHeaderSize = 8192;
+
+//--------------------------------------------------------------------------
+/// A complete HTTP request received by the NetConnectionManager.
+//--------------------------------------------------------------------------
+struct NetRequest
+{
+    /// Identifies the connection that the request was received on.
+    unsigned int mConnectionID;
+
+    /// The position of this request among the requests received on its connection.
+    unsigned int mSequence;
+
+    /// The request line and header fields, including the blank line that ends the header.
+    std::string mHeader;
+
+    /// The request body, as given by the Content-Length header field.
+    std::string mBody;
+
+    /// True if the connection should be kept open after the response to this request.
+    bool mbKeepAlive;
+};
+
+//--------------------------------------------------------------------------
+/// Implemented by whatever processes the requests that the
+/// NetConnectionManager receives.
+//--------------------------------------------------------------------------
+class INetRequestHandler
+{
+public:
+    virtual ~INetRequestHandler() {}
+
+    //--------------------------------------------------------------------------
+    /// Called on the polling thread for each request, in the order the requests
+    /// were received. The response may be sent from within this call, or later
+    /// from any thread, by calling NetConnectionManager::SendResponse.
+    /// \param inManager The manager that received the request.
+    /// \param inRequest The request.
+    //--------------------------------------------------------------------------
+    virtual void OnRequest(NetConnectionManager& inManager, const NetRequest& inRequest) = 0;
+};
+
+//--------------------------------------------------------------------------
+/// NetConnectionManager accepts connections on a listening NetSocket and
+/// services all of them from the thread that calls Poll. Sockets are
+/// non-blocking and watched with epoll. Each connection may stay open for
+/// many requests (HTTP/1.1 keep-alive), and may send several requests before
+/// the first response (pipelining). Responses are queued per connection and
+/// always sent in the order the requests were received, however they are
+/// completed.
+//--------------------------------------------------------------------------
+class NetConnectionManager
+{
+public:
+    //--------------------------------------------------------------------------
+    /// Constructor.
+    /// \param inHandler The handler that is given each request.
+    //--------------------------------------------------------------------------
+    NetConnectionManager(INetRequestHandler* inHandler);
+
+    //--------------------------------------------------------------------------
+    /// Destructor. Closes every connection, and the listening socket.
+    //--------------------------------------------------------------------------
+    ~NetConnectionManager();
+
+    //--------------------------------------------------------------------------
+    /// Start accepting connections on the given port.
+    /// \param inPort The port to listen on.
+    /// \returns True if the port is being listened on, false if there was an error.
+    //--------------------------------------------------------------------------
+    bool Listen(u_short inPort);
+
+    //--------------------------------------------------------------------------
+    /// Wait for activity on any connection, and service it. Must always be called from the same thread.
+    /// \param inTimeoutMs The longest time to wait for activity, in milliseconds. -1 waits indefinitely.
+    /// \returns False if there was an error waiting, true otherwise.
+    //--------------------------------------------------------------------------
+    bool Poll(int inTimeoutMs);
+
+    //--------------------------------------------------------------------------
+    /// Queue the response to a request. May be called from any thread.
+    /// \param inRequest The request being responded to.
+    /// \param inStatusCode The HTTP status code of the response.
+    /// \param inMimeType The content type of the response.
+    /// \param inData The response body.
+    /// \param inSize The number of bytes in the response body.
+    /// \returns True if the response was queued, false if the connection has been closed.
+    //--------------------------------------------------------------------------
+    bool SendResponse(const NetRequest& inRequest, int inStatusCode, const char* inMimeType, const char* inData, size_t inSize);
+
+    //--------------------------------------------------------------------------
+    /// Queue part of the response to a request, including its header, which the
+    /// caller formats. A response may be queued in several parts, such as the
+    /// parts of a streaming response. The response to the next request on the
+    /// connection isn't sent until this one is finished. If inRequest.mbKeepAlive
+    /// is false, the connection is closed once the response has been sent, and
+    /// any requests that were pipelined after it are dropped. May be called from any thread.
+    ///
+    /// Small pieces are copied. Larger pieces and the file are queued by reference
+    /// and sent straight from the caller's memory, and the file with sendfile, so
+    /// when there are any, this waits until they have been sent or the connection
+    /// has been closed. Everything passed in only needs to stay valid for the call.
+    /// On the polling thread, which can't wait for itself, everything is copied.
+    /// \param inRequest The request being responded to.
+    /// \param inBuffers The pieces of data to queue, one after the other.
+    /// \param inNumBuffers The number of pieces.
+    /// \param inFile A file whose contents follow the pieces, sent from its start, or NULL.
+    /// \param inFileSize The number of bytes of inFile to send.
+    /// \param inbFinished True if this is the last part of the response.
+    /// \returns True if the data was queued, false if the connection has been closed or the response was already finished.
+    //--------------------------------------------------------------------------
+    bool SendResponseData(const NetRequest& inRequest, const NetSocket::SendBuffer* inBuffers, unsigned int inNumBuffers, FILE* inFile, size_t inFileSize, bool inbFinished);
+
+    //--------------------------------------------------------------------------
+    /// Retrieve the number of connections that are currently open.
+    /// \returns The number of open connections.
+    //--------------------------------------------------------------------------
+    unsigned int GetNumConnections() const;
+
+private:
+    //--------------------------------------------------------------------------
+    /// A piece of response data: a copy, memory owned by the caller, or part of a file.
+    //--------------------------------------------------------------------------
+    struct OutboundSegment
+    {
+        /// The data, if it was copied.
+        std::string mCopy;
+
+        /// The caller's data, if it is queued by reference, otherwise NULL.
+        const char* mData;
+
+        /// The file to send the data from with sendfile, or -1.
+        int mFileDescriptor;
+
+        /// Where in the file the data starts.
+        off_t mFileOffset;
+
+        /// The number of bytes of data.
+        size_t mSize;
+
+        /// How many bytes have already been sent.
+        size_t mSent;
+
+        /// Told when data that isn't copied has been sent or dropped, otherwise NULL.
+        NetSendCompletion* mCompletion;
+    };
+
+    //--------------------------------------------------------------------------
+    /// A response that has been queued, at least in part.
+    //--------------------------------------------------------------------------
+    struct QueuedResponse
+    {
+        /// Response data that hasn't been moved to the outbound queue yet.
+        std::deque<OutboundSegment> mSegments;
+
+        /// True once the last part of the response has been queued.
+        bool mbFinished;
+
+        /// True if the connection should be closed once the response has been sent.
+        bool mbCloseConnection;
+    };
+
+    //--------------------------------------------------------------------------
+    /// The state of one client connection.
+    //--------------------------------------------------------------------------
+    struct Connection
+    {
+        /// The connection's socket.
+        NetSocket* mSocket;
+
+        /// Data received that hasn't been parsed into a request yet.
+        std::string mReceived;
+
+        /// How far into mReceived the end of the header has been searched for.
+        size_t mHeaderSearchOffset;
+
+        /// The sequence number to give the next request.
+        unsigned int mNextRequestSequence;
+
+        /// The sequence number of the next response to send.
+        unsigned int mNextResponseSequence;
+
+        /// Responses that can't be sent until the responses to earlier requests are,
+        /// and the parts of the current response that haven't been sent yet.
+        std::map<unsigned int, QueuedResponse> mQueuedResponses;
+
+        /// Response data waiting to be sent.
+        std::deque<OutboundSegment> mOutbound;
+
+        /// True once a request has asked for the connection to be closed after its response.
+        bool mbCloseWhenAnswered;
+
+        /// True once the client has stopped sending.
+        bool mbPeerClosed;
+
+        /// The events that epoll is currently watching the socket for.
+        unsigned int mWatchedEvents;
+    };
+
+    //--------------------------------------------------------------------------
+    /// Accept every pending connection on the listening socket.
+    //--------------------------------------------------------------------------
+    void AcceptConnections();
+
+    //--------------------------------------------------------------------------
+    /// Receive all available data on a connection, and split it into requests.
+    /// \param inConnectionID The connection to read.
+    /// \param outRequests The complete requests that were received.
+    //--------------------------------------------------------------------------
+    void ReadConnection(unsigned int inConnectionID, std::vector<NetRequest>& outRequests);
+
+    //--------------------------------------------------------------------------
+    /// Split as many complete requests as possible off the data received on a connection.
+    /// \param inConnectionID The ID of the connection.
+    /// \param ioConnection The connection.
+    /// \param outRequests The complete requests that were found.
+    /// \returns False if the data is not valid HTTP and the connection should be closed, true otherwise.
+    //--------------------------------------------------------------------------
+    bool ParseRequests(unsigned int inConnectionID, Connection& ioConnection, std::vector<NetRequest>& outRequests);
+
+    //--------------------------------------------------------------------------
+    /// Send as much queued response data on a connection as the socket will take.
+    /// \param inConnectionID The connection to write.
+    /// \param outRequests Pipelined requests that can be handled now that responses have been sent.
+    //--------------------------------------------------------------------------
+    void WriteConnection(unsigned int inConnectionID, std::vector<NetRequest>& outRequests);
+
+    //--------------------------------------------------------------------------
+    /// Close a connection if every request on it has been answered and no more will arrive.
+    /// \param inConnectionID The ID of the connection.
+    /// \param inConnection The connection.
+    /// \returns True if the connection was closed.
+    //--------------------------------------------------------------------------
+    bool CloseConnectionIfFinished(unsigned int inConnectionID, const Connection& inConnection);
+
+    //--------------------------------------------------------------------------
+    /// Remove data that was sent from the front of a connection's outbound queue.
+    /// \param ioConnection The connection.
+    /// \param inNumSent The number of bytes that were sent.
+    //--------------------------------------------------------------------------
+    void ConsumeOutbound(Connection& ioConnection, size_t inNumSent);
+
+    //--------------------------------------------------------------------------
+    /// Tell the sender of a segment that isn't copied that it has been sent or dropped.
+    /// \param inSegment The segment.
+    /// \param inbDropped True if the segment was dropped rather than sent.
+    //--------------------------------------------------------------------------
+    void CompleteSegment(const OutboundSegment& inSegment, bool inbDropped);
+
+    //--------------------------------------------------------------------------
+    /// Forget segments that will never be sent, telling their senders.
+    /// \param ioSegments The segments to drop.
+    //--------------------------------------------------------------------------
+    void DropSegments(std::deque<OutboundSegment>& ioSegments);
+
+    //--------------------------------------------------------------------------
+    /// Forget responses that will never be sent, telling their senders.
+    /// \param ioResponses The responses to drop.
+    //--------------------------------------------------------------------------
+    void DropResponses(std::map<unsigned int, QueuedResponse>& ioResponses);
+
+    //--------------------------------------------------------------------------
+    /// Stop watching a connection, close its socket, and forget it.
+    /// \param inConnectionID The connection to close.
+    //--------------------------------------------------------------------------
+    void CloseConnection(unsigned int inConnectionID);
+
+    //--------------------------------------------------------------------------
+    /// Make epoll watch a connection for the events that it is currently able to handle.
+    /// \param inConnectionID The connection.
+    /// \param ioConnection The connection's state.
+    //--------------------------------------------------------------------------
+    void UpdateWatchedEvents(unsigned int inConnectionID, Connection& ioConnection);
+
+    //--------------------------------------------------------------------------
+    /// The handler that is given each request.
+    //--------------------------------------------------------------------------
+    INetRequestHandler* mHandler;
+
+    //--------------------------------------------------------------------------
+    /// The socket that connections are accepted on.
+    //--------------------------------------------------------------------------
+    NetSocket* mListenSocket;
+
+    //--------------------------------------------------------------------------
+    /// The epoll instance that watches every socket.
+    //--------------------------------------------------------------------------
+    int mEpollFD;
+
+    //--------------------------------------------------------------------------
+    /// An eventfd that wakes Poll when a response is queued from another thread.
+    //--------------------------------------------------------------------------
+    int mWakeFD;
+
+    //--------------------------------------------------------------------------
+    /// The ID to give the next connection. IDs aren't reused, so a late response
+    /// can't be sent on a different connection than its request came from.
+    //--------------------------------------------------------------------------
+    unsigned int mNextConnectionID;
+
+    //--------------------------------------------------------------------------
+    /// Every open connection, by ID.
+    //--------------------------------------------------------------------------
+    std::map<unsigned int, Connection*> mConnections;
+
+    //--------------------------------------------------------------------------
+    /// Connections that have had responses queued since they were last written.
+    //--------------------------------------------------------------------------
+    std::set<unsigned int> mConnectionsToWrite;
+
+    //--------------------------------------------------------------------------
+    /// The thread that calls Poll, which must not wait for its own sends.
+    //--------------------------------------------------------------------------
+    pthread_t mPollThread;
+
+    //--------------------------------------------------------------------------
+    /// True once Poll has been called, and mPollThread is set.
+    //--------------------------------------------------------------------------
+    bool mbPollThreadKnown;
+
+    //--------------------------------------------------------------------------
+    /// Protects the connections, since responses may be queued from any thread.
+    //--------------------------------------------------------------------------
+    mutable mutex mConnectionsLock;
+};
+
+#endif // _LINUX
+
+#endif // NETCONNECTIONMANAGER_H
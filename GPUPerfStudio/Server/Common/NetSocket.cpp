@@ -10,6 +10,11 @@
 
 #ifdef _LINUX
     #include <unistd.h>
+    #include <fcntl.h>
+    #include <errno.h>
+    #include <sys/sendfile.h>
+    #include <sys/socket.h>
+    #include <sys/uio.h>
 #endif
 
 #include "NetSocket.h"
@@ -19,6 +24,12 @@
 // Timeout for select operation, in milliseconds
 static const int SELECT_TIMEOUT = 5000;
 
+// Maximum number of buffers passed to a single gather send
+static const int MAX_BUFFERS_PER_SEND = 64;
+
+// Size of the buffer used to send a file where sendfile isn't available
+static const gtSize_t FILE_SEND_BUFFER_SIZE = 64 * 1024;
+
 /// Total number of live sockets in the process
 int NetSocket::m_TotalLiveSockets = 0;
 
@@ -407,6 +418,192 @@ bool NetSocket::Send(const void* buf, int len)
     return retVal;
 }
 
+//-----------------------------------------------------------------------------
+/// Send several buffers, one after the other, using gather sends
+/// \param buffers the buffers to send
+/// \param numBuffers the number of buffers
+/// \param moreToFollow true if more data will be sent straight after these
+/// buffers, so the OS can hold back a partial packet
+/// returns true if all of the data was sent, false if there was a socket error
+//-----------------------------------------------------------------------------
+bool NetSocket::SendVector(const SendBuffer* buffers, int numBuffers, bool moreToFollow)
+{
+    // the buffer currently being sent, and how much of it has already gone
+    int current = 0;
+    gtSize_t currentOffset = 0;
+
+    while (current < numBuffers)
+    {
+        if (currentOffset == buffers[current].size)
+        {
+            current++;
+            currentOffset = 0;
+            continue;
+        }
+
+        // Get the socket status before trying to write to it.
+        if (Select(false) == false)
+        {
+            return false;
+        }
+
+        int count = numBuffers - current;
+
+        if (count > MAX_BUFFERS_PER_SEND)
+        {
+            count = MAX_BUFFERS_PER_SEND;
+        }
+
+        gtSize_t sent = 0;
+
+#if defined _WIN32
+        WSABUF wsaBuffers[MAX_BUFFERS_PER_SEND];
+
+        for (int i = 0; i < count; i++)
+        {
+            wsaBuffers[i].buf = (char*)buffers[current + i].pData;
+            wsaBuffers[i].len = (ULONG)buffers[current + i].size;
+        }
+
+        wsaBuffers[0].buf += currentOffset;
+        wsaBuffers[0].len -= (ULONG)currentOffset;
+
+        DWORD bytesSent = 0;
+
+        if (::WSASend(m_socket, wsaBuffers, count, &bytesSent, 0, NULL, NULL) == SOCKET_ERROR)
+        {
+            return false;
+        }
+
+        sent = bytesSent;
+
+#elif defined _LINUX
+        struct iovec ioBuffers[MAX_BUFFERS_PER_SEND];
+
+        for (int i = 0; i < count; i++)
+        {
+            ioBuffers[i].iov_base = (void*)buffers[current + i].pData;
+            ioBuffers[i].iov_len = buffers[current + i].size;
+        }
+
+        ioBuffers[0].iov_base = (char*)ioBuffers[0].iov_base + currentOffset;
+        ioBuffers[0].iov_len -= currentOffset;
+
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = ioBuffers;
+        message.msg_iovlen = count;
+
+        // MSG_MORE corks the socket, so a header and its data share packets
+        int flags = MSG_NOSIGNAL;
+
+        if (moreToFollow || (current + count) < numBuffers)
+        {
+            flags |= MSG_MORE;
+        }
+
+        ssize_t s = ::sendmsg(m_socket, &message, flags);
+
+        if (s == SOCKET_ERROR)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            return false;
+        }
+
+        sent = (gtSize_t)s;
+#endif
+
+        m_TotalBytesSent += sent;
+
+        // move past whatever was sent; the send may have stopped part way through a buffer
+        while (sent > 0)
+        {
+            gtSize_t remaining = buffers[current].size - currentOffset;
+
+            if (sent >= remaining)
+            {
+                sent -= remaining;
+                current++;
+                currentOffset = 0;
+            }
+            else
+            {
+                currentOffset += sent;
+                sent = 0;
+            }
+        }
+    }
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+/// Send the start of a file
+/// \param file the file to send, which must have been opened for reading
+/// \param size the number of bytes to send from the start of the file
+/// returns true if all of the data was sent, false if there was an error
+//-----------------------------------------------------------------------------
+bool NetSocket::SendFile(FILE* file, gtSize_t size)
+{
+#if defined _LINUX
+    // sendfile copies straight from the page cache to the socket
+    int fileDescriptor = fileno(file);
+    off_t offset = 0;
+
+    while ((gtSize_t)offset < size)
+    {
+        if (Select(false) == false)
+        {
+            return false;
+        }
+
+        ssize_t s = ::sendfile(m_socket, fileDescriptor, &offset, size - (gtSize_t)offset);
+
+        if (s == SOCKET_ERROR)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            return false;
+        }
+
+        if (s == 0)
+        {
+            // the file is shorter than expected
+            return false;
+        }
+
+        m_TotalBytesSent += s;
+    }
+
+    return true;
+#else
+    // read and send the file a block at a time, so it never needs to all be in memory
+    char* fileBuffer = new char[FILE_SEND_BUFFER_SIZE];
+    bool retVal = (fseek(file, 0, SEEK_SET) == 0);
+    gtSize_t totalSent = 0;
+
+    while (retVal == true && totalSent < size)
+    {
+        gtSize_t toRead = (size - totalSent < FILE_SEND_BUFFER_SIZE) ? size - totalSent : FILE_SEND_BUFFER_SIZE;
+        gtSize_t numRead = fread(fileBuffer, 1, toRead, file);
+
+        SendBuffer buffer = { fileBuffer, numRead };
+        retVal = (numRead > 0) && SendVector(&buffer, 1);
+        totalSent += numRead;
+    }
+
+    delete [] fileBuffer;
+    return retVal;
+#endif
+}
+
 //-----------------------------------------------------------------------------
 /// Connect to an open socket.
 //-----------------------------------------------------------------------------
@@ -435,6 +632,29 @@ bool NetSocket::Connect(osPortAddress& portAddress)
     return retVal;
 }
 
+//-----------------------------------------------------------------------------
+/// Sets whether operations on the socket wait for it to be ready.
+/// \param nonBlocking true if operations should return immediately
+/// returns true if the mode was set, false if there was a socket error
+//-----------------------------------------------------------------------------
+bool NetSocket::SetNonBlocking(bool nonBlocking)
+{
+#if defined (_WIN32)
+    u_long mode = nonBlocking ? 1 : 0;
+    return (::ioctlsocket(m_socket, FIONBIO, &mode) != SOCKET_ERROR);
+#elif defined (_LINUX)
+    int flags = ::fcntl(m_socket, F_GETFL, 0);
+
+    if (flags == -1)
+    {
+        return false;
+    }
+
+    flags = nonBlocking ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK);
+    return (::fcntl(m_socket, F_SETFL, flags) != -1);
+#endif
+}
+
 //-----------------------------------------------------------------------------
 /// Construct information required to duplicate the socket into another
 /// process.
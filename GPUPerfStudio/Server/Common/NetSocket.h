@@ -38,6 +38,13 @@ public:
     typedef int                DuplicationInfo;
 #endif
 
+    /// A piece of data to be sent by SendVector
+    struct SendBuffer
+    {
+        const void* pData;  ///< the data to send
+        gtSize_t    size;   ///< the number of bytes pointed to by pData
+    };
+
     static NetSocket* Create();
     static NetSocket* CreateFromDuplicate(DuplicationInfo* pDup);
     static int LastError();
@@ -60,9 +67,25 @@ public:
     /// Send data to target
     bool Send(const void* buf, int len);
 
+    /// Send several buffers to target, one after the other, with as few
+    /// system calls as possible. Set moreToFollow if more data will be sent
+    /// straight afterwards, so it can go out in the same packets.
+    bool SendVector(const SendBuffer* buffers, int numBuffers, bool moreToFollow = false);
+
+    /// Send the first size bytes of an open file to target. Where the OS
+    /// supports it, the data is sent without being copied through user space
+    bool SendFile(FILE* file, gtSize_t size);
+
     /// Connect to an open socket
     bool Connect(osPortAddress& portAddress);
 
+    /// Set whether Accept, Receive and Send on the socket return immediately
+    /// rather than waiting for it to be ready
+    bool SetNonBlocking(bool nonBlocking);
+
+    /// Returns the OS-level socket, so it can be watched along with others
+    osSocketDescriptor GetSocketDescriptor() const { return m_socket; }
+
     /// Builds data structure suitable for sending to target process
     /// pid such that it can inherit the socket
     int DuplicateToPID(unsigned long pid, void* pDst);
@@ -19,6 +19,8 @@
 //--------------------------------------------------------------------------
 ObjectDatabaseProcessor::ObjectDatabaseProcessor()
     : mSelectedObject(NULL)
+    , mObjectTreeGeneration(0)
+    , mbObjectTreeCached(false)
 {
     // Add each command as a child of "this" CommandProcessor, and set each to not autoreply.
     // We need to do this so that we can detect which Command is active, read the client arguments,
@@ -313,18 +315,28 @@ void ObjectDatabaseProcessor::UpdateSelectedObject()
 //--------------------------------------------------------------------------
 void ObjectDatabaseProcessor::BuildObjectTreeResponse(gtASCIIString& outObjectTreeXml)
 {
-    // Separate all of the objects into categories based on the object type.
     WrappedObjectDatabase* objectDatabase = GetObjectDatabase();
+    ObjectTreeIndex& objectTreeIndex = objectDatabase->GetObjectTreeIndex();
+
+    // If no objects have been created or destroyed since the last request, the previous response is still valid.
+    unsigned int treeGeneration = objectTreeIndex.GetGeneration();
+
+    if (mbObjectTreeCached && (treeGeneration == mObjectTreeGeneration))
+    {
+        outObjectTreeXml = mObjectTreeXml;
+        return;
+    }
 
     // Find the device wrappers first- they are the roots of our treeview.
     int deviceType = GetDeviceType();
     WrappedInstanceVector deviceWrappers;
     objectDatabase->GetObjectsByType((eObjectType)deviceType, deviceWrappers);
 
+    gtASCIIString devicesXml;
+
     // Find the object instances created under each device to create a tree.
     for (size_t deviceIndex = 0; deviceIndex < deviceWrappers.size(); ++deviceIndex)
     {
-        // Get the device's application handle from the wrapper. Look for objects with a handle to the parent device.
         IInstanceBase* deviceInstance = deviceWrappers[deviceIndex];
 
         // Don't bother building an object tree for a device that's been destroyed.
@@ -333,70 +345,20 @@ void ObjectDatabaseProcessor::BuildObjectTreeResponse(gtASCIIString& outObjectTr
             gtASCIIString applicationHandleString;
             deviceInstance->PrintFormattedApplicationHandle(applicationHandleString);
 
-            // The object XML for each active device will be appended into a long string here.
+            // The index keeps each device's children grouped by type, and only serializes instances it hasn't seen before.
             gtASCIIString deviceObjectXml = "";
-
-            // Look for objects of all types besides "Device". We'll handle those last.
-            int firstObjectType = GetFirstObjectType();
-            int lastObjectType = GetLastObjectType();
-
-            for (int objectType = firstObjectType; objectType < lastObjectType; objectType++)
-            {
-                // Step through each type of object and store the results in vectors.
-                eObjectType currentType = (eObjectType)objectType;
-
-                if (currentType == GetDeviceType())
-                {
-                    // Skip devices. They're the highest level node in the hierarchy. We're only looking for device children.
-                    continue;
-                }
-
-                // We need to empty out the list of objects with the current type so that objects from the 0th device don't get added in.
-                WrappedInstanceVector objectsOfType;
-                objectDatabase->GetObjectsByType(currentType, objectsOfType);
-
-                // There's at least a single instance of this type within the object database. Serialize the object to the tree.
-                if (!objectsOfType.empty())
-                {
-                    // Objects of the same type will be sorted into similar groups, and then divided based on parent device.
-                    gtASCIIString instancesString = "";
-                    size_t numInstances = objectsOfType.size();
-                    const char* objectTypeAsString = objectsOfType[0]->GetTypeAsString();
-
-                    for (size_t instanceIndex = 0; instanceIndex < numInstances; ++instanceIndex)
-                    {
-                        IInstanceBase* objectInstance = objectsOfType[instanceIndex];
-
-                        // Check to see if the object's parent device matches the one we're building the tree for.
-                        if (objectInstance->GetParentDeviceHandle() == deviceInstance->GetApplicationHandle())
-                        {
-                            gtASCIIString objectHandleString;
-                            objectInstance->PrintFormattedApplicationHandle(objectHandleString);
-                            instancesString.append(objectHandleString);
-
-                            if (objectInstance->IsDestroyed())
-                            {
-                                // Append a "|d" to indicate that this object instance was deleted during the frame.
-                                instancesString.append("|d");
-                            }
-
-                            if ((instanceIndex + 1) < numInstances)
-                            {
-                                instancesString.append(",");
-                            }
-                        }
-                    }
-
-                    deviceObjectXml += XML(objectTypeAsString, instancesString.asCharArray());
-                }
-            }
+            objectTreeIndex.AppendDeviceObjectXML(deviceInstance->GetApplicationHandle(), deviceType, deviceObjectXml);
 
             // Surround all of the subobjects in an object element.
             gtASCIIString deviceAddressAttributeString;
             deviceAddressAttributeString.appendFormattedString("handle='%s'", applicationHandleString.asCharArray());
-            outObjectTreeXml += XMLAttrib("Device", deviceAddressAttributeString.asCharArray(), deviceObjectXml.asCharArray());
+            devicesXml += XMLAttrib("Device", deviceAddressAttributeString.asCharArray(), deviceObjectXml.asCharArray());
         }
     }
 
-    outObjectTreeXml = XML("Objects", outObjectTreeXml.asCharArray());
-}
\ No newline at end of file
+    mObjectTreeXml = XML("Objects", devicesXml.asCharArray());
+    mObjectTreeGeneration = treeGeneration;
+    mbObjectTreeCached = true;
+
+    outObjectTreeXml = mObjectTreeXml;
+}
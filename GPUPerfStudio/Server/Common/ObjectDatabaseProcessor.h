@@ -93,6 +93,21 @@ protected:
     IInstanceBase* mSelectedObject;
 
 private:
+    //--------------------------------------------------------------------------
+    /// The most recent object tree response. Reused until an object is created or destroyed.
+    //--------------------------------------------------------------------------
+    gtASCIIString mObjectTreeXml;
+
+    //--------------------------------------------------------------------------
+    /// The object tree index generation that mObjectTreeXml was built from.
+    //--------------------------------------------------------------------------
+    unsigned int mObjectTreeGeneration;
+
+    //--------------------------------------------------------------------------
+    /// True once mObjectTreeXml has been built.
+    //--------------------------------------------------------------------------
+    bool mbObjectTreeCached;
+
     //--------------------------------------------------------------------------
     /// Respond to object selection change commands.
     //--------------------------------------------------------------------------
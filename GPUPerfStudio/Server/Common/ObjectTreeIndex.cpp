@@ -0,0 +1,184 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  An index of wrapped object instances, grouped by parent device and
+///         object type, used to build the object tree without scanning the
+///         whole object database.
+//==============================================================================
+
+#include "ObjectTreeIndex.h"
+#include "IInstanceBase.h"
+
+//--------------------------------------------------------------------------
+/// Constructor.
+//--------------------------------------------------------------------------
+ObjectTreeIndex::ObjectTreeIndex()
+    : mGeneration(0)
+{
+}
+
+//--------------------------------------------------------------------------
+/// Destructor. The index does not own the instances that are added to it.
+//--------------------------------------------------------------------------
+ObjectTreeIndex::~ObjectTreeIndex()
+{
+}
+
+//--------------------------------------------------------------------------
+/// Add a new instance to the index. The instance's parent device must already be set.
+/// \param inInstance The instance to add.
+//--------------------------------------------------------------------------
+void ObjectTreeIndex::Add(IInstanceBase* inInstance)
+{
+    ScopeLock indexLock(&mIndexLock);
+
+    TypeToInstanceListMap& deviceLists = mDeviceInstanceLists[inInstance->GetParentDeviceHandle()];
+    TypeToInstanceListMap::iterator listIter = deviceLists.find(inInstance->GetObjectType());
+
+    if (listIter == deviceLists.end())
+    {
+        InstanceList newList;
+        newList.mFirstInstance = inInstance;
+        newList.mLastInstance = inInstance;
+        newList.mLastSerializedInstance = NULL;
+        deviceLists[inInstance->GetObjectType()] = newList;
+    }
+    else
+    {
+        InstanceList& instanceList = listIter->second;
+        instanceList.mLastInstance->SetNextInstanceOfType(inInstance);
+        instanceList.mLastInstance = inInstance;
+    }
+
+    mGeneration++;
+}
+
+//--------------------------------------------------------------------------
+/// Flag an instance as destroyed, and invalidate the cached handle string that includes it.
+/// \param inInstance The instance that was destroyed.
+//--------------------------------------------------------------------------
+void ObjectTreeIndex::OnInstanceDestroyed(IInstanceBase* inInstance)
+{
+    ScopeLock indexLock(&mIndexLock);
+
+    inInstance->FlagAsDestroyed();
+
+    DeviceToInstanceListsMap::iterator deviceIter = mDeviceInstanceLists.find(inInstance->GetParentDeviceHandle());
+
+    if (deviceIter != mDeviceInstanceLists.end())
+    {
+        TypeToInstanceListMap::iterator listIter = deviceIter->second.find(inInstance->GetObjectType());
+
+        if (listIter != deviceIter->second.end())
+        {
+            // The instance's handle is already in the string without its "destroyed" marker, so start over.
+            listIter->second.mLastSerializedInstance = NULL;
+            listIter->second.mSerializedHandles = "";
+        }
+    }
+
+    mGeneration++;
+}
+
+//--------------------------------------------------------------------------
+/// Retrieve all instances of a given type, across all devices.
+/// \param inObjectType The type of instance to retrieve.
+/// \param outInstances The vector that the instances are appended to.
+/// \param inbOnlyCurrentObjects True to skip instances that have been destroyed.
+//--------------------------------------------------------------------------
+void ObjectTreeIndex::GetInstancesOfType(int inObjectType, std::vector<IInstanceBase*>& outInstances, bool inbOnlyCurrentObjects) const
+{
+    ScopeLock indexLock(&mIndexLock);
+
+    DeviceToInstanceListsMap::const_iterator deviceIter;
+
+    for (deviceIter = mDeviceInstanceLists.begin(); deviceIter != mDeviceInstanceLists.end(); ++deviceIter)
+    {
+        TypeToInstanceListMap::const_iterator listIter = deviceIter->second.find(inObjectType);
+
+        if (listIter != deviceIter->second.end())
+        {
+            for (IInstanceBase* instance = listIter->second.mFirstInstance; instance != NULL; instance = instance->GetNextInstanceOfType())
+            {
+                // If we only care about currently-active objects, don't include it if it has already been destroyed.
+                if (!inbOnlyCurrentObjects || !instance->IsDestroyed())
+                {
+                    outInstances.push_back(instance);
+                }
+            }
+        }
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Append the XML for every instance created under a device, grouped by type.
+/// \param inDeviceHandle The application handle of the parent device.
+/// \param inDeviceType The device object type. Devices aren't included as children.
+/// \param outDeviceObjectXml The string that the XML is appended to.
+//--------------------------------------------------------------------------
+void ObjectTreeIndex::AppendDeviceObjectXML(void* inDeviceHandle, int inDeviceType, gtASCIIString& outDeviceObjectXml)
+{
+    ScopeLock indexLock(&mIndexLock);
+
+    DeviceToInstanceListsMap::iterator deviceIter = mDeviceInstanceLists.find(inDeviceHandle);
+
+    if (deviceIter != mDeviceInstanceLists.end())
+    {
+        // The lists are sorted by type, so the types are written in the same order as the type enumeration.
+        TypeToInstanceListMap::iterator listIter;
+
+        for (listIter = deviceIter->second.begin(); listIter != deviceIter->second.end(); ++listIter)
+        {
+            // Skip devices. They're the highest level node in the hierarchy. We're only looking for device children.
+            if (listIter->first == inDeviceType)
+            {
+                continue;
+            }
+
+            InstanceList& instanceList = listIter->second;
+            SerializeNewInstances(instanceList);
+
+            outDeviceObjectXml += XML(instanceList.mFirstInstance->GetTypeAsString(), instanceList.mSerializedHandles.asCharArray());
+        }
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Retrieve a counter that changes every time an instance is added or destroyed.
+/// \returns The current generation of the index.
+//--------------------------------------------------------------------------
+unsigned int ObjectTreeIndex::GetGeneration() const
+{
+    ScopeLock indexLock(&mIndexLock);
+    return mGeneration;
+}
+
+//--------------------------------------------------------------------------
+/// Bring a list's cached handle string up to date by serializing any instances added since it was last used.
+/// \param ioInstanceList The list to update.
+//--------------------------------------------------------------------------
+void ObjectTreeIndex::SerializeNewInstances(InstanceList& ioInstanceList)
+{
+    IInstanceBase* instance = (ioInstanceList.mLastSerializedInstance != NULL) ? ioInstanceList.mLastSerializedInstance->GetNextInstanceOfType() : ioInstanceList.mFirstInstance;
+
+    for (; instance != NULL; instance = instance->GetNextInstanceOfType())
+    {
+        if (ioInstanceList.mLastSerializedInstance != NULL)
+        {
+            ioInstanceList.mSerializedHandles.append(",");
+        }
+
+        gtASCIIString objectHandleString;
+        instance->PrintFormattedApplicationHandle(objectHandleString);
+        ioInstanceList.mSerializedHandles.append(objectHandleString);
+
+        if (instance->IsDestroyed())
+        {
+            // Append a "|d" to indicate that this object instance was deleted during the frame.
+            ioInstanceList.mSerializedHandles.append("|d");
+        }
+
+        ioInstanceList.mLastSerializedInstance = instance;
+    }
+}
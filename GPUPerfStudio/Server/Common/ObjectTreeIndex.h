@@ -0,0 +1,125 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  An index of wrapped object instances, grouped by parent device and
+///         object type, used to build the object tree without scanning the
+///         whole object database.
+//==============================================================================
+
+#ifndef OBJECTTREEINDEX_H
+#define OBJECTTREEINDEX_H
+
+#include <map>
+#include <vector>
+#include "mymutex.h"
+#include "xml.h"
+
+class IInstanceBase;
+
+//--------------------------------------------------------------------------
+/// ObjectTreeIndex keeps an intrusive list of the instances created under each
+/// (parent device, object type) pair, in creation order. Each list also caches the
+/// handle string that it contributes to the object tree. New instances are appended
+/// to the cached string the next time it's requested, and a list's string is only
+/// rebuilt when one of its instances is destroyed. All methods are threadsafe.
+//--------------------------------------------------------------------------
+class ObjectTreeIndex
+{
+public:
+    //--------------------------------------------------------------------------
+    /// Constructor.
+    //--------------------------------------------------------------------------
+    ObjectTreeIndex();
+
+    //--------------------------------------------------------------------------
+    /// Destructor. The index does not own the instances that are added to it.
+    //--------------------------------------------------------------------------
+    ~ObjectTreeIndex();
+
+    //--------------------------------------------------------------------------
+    /// Add a new instance to the index. The instance's parent device must already be set.
+    /// \param inInstance The instance to add.
+    //--------------------------------------------------------------------------
+    void Add(IInstanceBase* inInstance);
+
+    //--------------------------------------------------------------------------
+    /// Flag an instance as destroyed, and invalidate the cached handle string that includes it.
+    /// \param inInstance The instance that was destroyed.
+    //--------------------------------------------------------------------------
+    void OnInstanceDestroyed(IInstanceBase* inInstance);
+
+    //--------------------------------------------------------------------------
+    /// Retrieve all instances of a given type, across all devices.
+    /// \param inObjectType The type of instance to retrieve.
+    /// \param outInstances The vector that the instances are appended to.
+    /// \param inbOnlyCurrentObjects True to skip instances that have been destroyed.
+    //--------------------------------------------------------------------------
+    void GetInstancesOfType(int inObjectType, std::vector<IInstanceBase*>& outInstances, bool inbOnlyCurrentObjects) const;
+
+    //--------------------------------------------------------------------------
+    /// Append the XML for every instance created under a device, grouped by type.
+    /// \param inDeviceHandle The application handle of the parent device.
+    /// \param inDeviceType The device object type. Devices aren't included as children.
+    /// \param outDeviceObjectXml The string that the XML is appended to.
+    //--------------------------------------------------------------------------
+    void AppendDeviceObjectXML(void* inDeviceHandle, int inDeviceType, gtASCIIString& outDeviceObjectXml);
+
+    //--------------------------------------------------------------------------
+    /// Retrieve a counter that changes every time an instance is added or destroyed.
+    /// \returns The current generation of the index.
+    //--------------------------------------------------------------------------
+    unsigned int GetGeneration() const;
+
+private:
+    //--------------------------------------------------------------------------
+    /// The instances of one type created under one device.
+    //--------------------------------------------------------------------------
+    struct InstanceList
+    {
+        /// The first instance in the list.
+        IInstanceBase* mFirstInstance;
+
+        /// The last instance in the list. New instances are linked after it.
+        IInstanceBase* mLastInstance;
+
+        /// The last instance that has been serialized into mSerializedHandles, or NULL if none have.
+        IInstanceBase* mLastSerializedInstance;
+
+        /// A comma-separated string of formatted instance handles.
+        gtASCIIString mSerializedHandles;
+    };
+
+    //--------------------------------------------------------------------------
+    /// A map of object type to the list of instances with that type.
+    //--------------------------------------------------------------------------
+    typedef std::map<int, InstanceList> TypeToInstanceListMap;
+
+    //--------------------------------------------------------------------------
+    /// A map of parent device handle to the instance lists of that device.
+    //--------------------------------------------------------------------------
+    typedef std::map<void*, TypeToInstanceListMap> DeviceToInstanceListsMap;
+
+    //--------------------------------------------------------------------------
+    /// Bring a list's cached handle string up to date by serializing any instances added since it was last used.
+    /// \param ioInstanceList The list to update.
+    //--------------------------------------------------------------------------
+    static void SerializeNewInstances(InstanceList& ioInstanceList);
+
+    //--------------------------------------------------------------------------
+    /// The instance lists for each parent device.
+    //--------------------------------------------------------------------------
+    DeviceToInstanceListsMap mDeviceInstanceLists;
+
+    //--------------------------------------------------------------------------
+    /// Incremented each time an instance is added or destroyed.
+    //--------------------------------------------------------------------------
+    unsigned int mGeneration;
+
+    //--------------------------------------------------------------------------
+    /// Lock the index whenever it's read or modified.
+    //--------------------------------------------------------------------------
+    mutable mutex mIndexLock;
+};
+
+#endif // OBJECTTREEINDEX_H
@@ -0,0 +1,136 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  A compact, binary capture of API call arguments that is only
+///         converted to text when a trace response is built.
+//==============================================================================
+
+#include "PackedAPIArguments.h"
+
+//--------------------------------------------------------------------------
+/// The size of the scratch buffer used to format a single conversion specifier.
+//--------------------------------------------------------------------------
+static const unsigned int s_ConversionBufferSize = 128;
+
+//--------------------------------------------------------------------------
+/// Convert the packed arguments into the same text the format string would produce with sprintf.
+/// Each conversion specifier in the format string consumes one packed value. The value is
+/// passed back through sprintf_s with the original specifier, so the output matches eager formatting.
+/// \param outArguments The string that the formatted arguments will be appended to.
+//--------------------------------------------------------------------------
+void PackedAPIArguments::ToString(gtASCIIString& outArguments) const
+{
+    if (mFormat == NULL)
+    {
+        return;
+    }
+
+    unsigned int argumentIndex = 0;
+    const char* pCurrent = mFormat;
+
+    while (*pCurrent != '\0')
+    {
+        if (*pCurrent != '%')
+        {
+            // Copy the literal text up to the next conversion specifier in one go.
+            const char* pNextSpecifier = strchr(pCurrent, '%');
+            int literalLength = (pNextSpecifier != NULL) ? static_cast<int>(pNextSpecifier - pCurrent) : static_cast<int>(strlen(pCurrent));
+            outArguments.append(pCurrent, literalLength);
+            pCurrent += literalLength;
+            continue;
+        }
+
+        if (pCurrent[1] == '%')
+        {
+            outArguments.append('%');
+            pCurrent += 2;
+            continue;
+        }
+
+        // Find the end of the conversion specifier, and check if it requests a 64-bit integer.
+        const char* pSpecifierStart = pCurrent++;
+        bool b64BitInteger = false;
+
+        while (*pCurrent != '\0' && strchr("diouxXcpfFeEgGaAsS", *pCurrent) == NULL)
+        {
+            if ((pCurrent[0] == 'l' && pCurrent[1] == 'l') || (pCurrent[0] == 'I' && pCurrent[1] == '6'))
+            {
+                b64BitInteger = true;
+            }
+            else if (pCurrent[0] == 'I' && pCurrent[1] != '3' && pCurrent[1] != '6')
+            {
+                // "%Iu" is a size_t, which matches the pointer width.
+                b64BitInteger = (sizeof(size_t) == sizeof(UINT64));
+            }
+
+            ++pCurrent;
+        }
+
+        if (*pCurrent == '\0' || argumentIndex >= mNumArguments)
+        {
+            // A malformed format, or more specifiers than packed values. Emit the rest verbatim.
+            outArguments.append(pSpecifierStart);
+            break;
+        }
+
+        const char conversion = *pCurrent++;
+
+        char specifier[32];
+        size_t specifierLength = static_cast<size_t>(pCurrent - pSpecifierStart);
+
+        if (specifierLength >= sizeof(specifier))
+        {
+            outArguments.append(pSpecifierStart);
+            break;
+        }
+
+        memcpy(specifier, pSpecifierStart, specifierLength);
+        specifier[specifierLength] = '\0';
+
+        const UINT64 rawValue = mArguments[argumentIndex++];
+        char conversionBuffer[s_ConversionBufferSize];
+
+        switch (conversion)
+        {
+            case 'p':
+                sprintf_s(conversionBuffer, s_ConversionBufferSize, specifier, reinterpret_cast<void*>(static_cast<size_t>(rawValue)));
+                break;
+
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+            {
+                double floatValue = 0.0;
+                memcpy(&floatValue, &rawValue, sizeof(double));
+                sprintf_s(conversionBuffer, s_ConversionBufferSize, specifier, floatValue);
+                break;
+            }
+
+            case 's':
+            case 'S':
+                // Strings can't be packed, because the memory they point to won't survive until the response is built.
+                sprintf_s(conversionBuffer, s_ConversionBufferSize, "<string>");
+                break;
+
+            default:
+                if (b64BitInteger)
+                {
+                    sprintf_s(conversionBuffer, s_ConversionBufferSize, specifier, rawValue);
+                }
+                else
+                {
+                    sprintf_s(conversionBuffer, s_ConversionBufferSize, specifier, static_cast<unsigned int>(rawValue));
+                }
+
+                break;
+        }
+
+        outArguments.append(conversionBuffer);
+    }
+}
@@ -0,0 +1,162 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  A compact, binary capture of API call arguments that is only
+///         converted to text when a trace response is built.
+//==============================================================================
+
+#ifndef PACKEDAPIARGUMENTS_H
+#define PACKEDAPIARGUMENTS_H
+
+#include <stddef.h>
+#include "misc.h"
+
+//--------------------------------------------------------------------------
+/// The maximum number of arguments that can be captured by a single PackedAPIArguments instance.
+//--------------------------------------------------------------------------
+static const unsigned int s_MaxPackedArguments = 12;
+
+//--------------------------------------------------------------------------
+/// PackedAPIArguments stores the raw values of a traced call's arguments along
+/// with the printf-style format string that was used to describe them. Packing only
+/// copies a handful of 64-bit values on the application thread. The text version is
+/// produced later by ToString, when the trace response is being built.
+/// Only POD values (integers, enums, floats and pointers/handles) may be packed. The
+/// format string must have static storage duration, because only the pointer is kept.
+/// Instances are built on the stack at full size, then stored with CopyTo, which only
+/// keeps the values that were actually packed.
+//--------------------------------------------------------------------------
+class PackedAPIArguments
+{
+public:
+    //--------------------------------------------------------------------------
+    /// Default constructor creates an empty instance with no format string.
+    //--------------------------------------------------------------------------
+    PackedAPIArguments()
+        : mFormat(NULL)
+        , mNumArguments(0)
+    {
+    }
+
+    //--------------------------------------------------------------------------
+    /// Pack a set of arguments described by a format string.
+    /// \param inFormat A string literal containing a printf-style format for the arguments.
+    /// \param inArguments The raw argument values to capture.
+    //--------------------------------------------------------------------------
+    template <typename... ArgTypes>
+    explicit PackedAPIArguments(const char* inFormat, ArgTypes... inArguments)
+        : mFormat(inFormat)
+        , mNumArguments(0)
+    {
+        static_assert(sizeof...(ArgTypes) <= s_MaxPackedArguments, "Too many arguments to pack. Increase s_MaxPackedArguments.");
+        Pack(inArguments...);
+    }
+
+    //--------------------------------------------------------------------------
+    /// Check if this instance holds a packed set of arguments.
+    /// \returns True if no arguments were packed into this instance.
+    //--------------------------------------------------------------------------
+    bool IsEmpty() const { return (mFormat == NULL); }
+
+    //--------------------------------------------------------------------------
+    /// Convert the packed arguments into the same text the format string would produce with sprintf.
+    /// \param outArguments The string that the formatted arguments will be appended to.
+    //--------------------------------------------------------------------------
+    void ToString(gtASCIIString& outArguments) const;
+
+    //--------------------------------------------------------------------------
+    /// Retrieve the number of bytes needed to store this instance with CopyTo.
+    /// \returns The size of the instance up to and including the last packed value.
+    //--------------------------------------------------------------------------
+    size_t GetPackedSize() const
+    {
+        return offsetof(PackedAPIArguments, mArguments) + (mNumArguments * sizeof(UINT64));
+    }
+
+    //--------------------------------------------------------------------------
+    /// Copy this instance into storage that only has room for the packed values.
+    /// The copy must only be read through the returned pointer, and must not be copied by value.
+    /// \param outMemory At least GetPackedSize() bytes, aligned for a UINT64.
+    /// \returns The copy, which lives in outMemory.
+    //--------------------------------------------------------------------------
+    const PackedAPIArguments* CopyTo(void* outMemory) const
+    {
+        memcpy(outMemory, this, GetPackedSize());
+        return static_cast<const PackedAPIArguments*>(outMemory);
+    }
+
+private:
+    //--------------------------------------------------------------------------
+    /// End of the argument recursion.
+    //--------------------------------------------------------------------------
+    void Pack() {}
+
+    //--------------------------------------------------------------------------
+    /// Pack the first argument and recurse into the rest.
+    /// \param inFirst The next argument to pack.
+    /// \param inRest The remaining arguments.
+    //--------------------------------------------------------------------------
+    template <typename FirstType, typename... RestTypes>
+    void Pack(FirstType inFirst, RestTypes... inRest)
+    {
+        PackArgument(inFirst);
+        Pack(inRest...);
+    }
+
+    //--------------------------------------------------------------------------
+    /// Pack a pointer or handle argument.
+    /// \param inPointer The pointer value to store.
+    //--------------------------------------------------------------------------
+    template <typename PointeeType>
+    void PackArgument(PointeeType* inPointer)
+    {
+        mArguments[mNumArguments++] = static_cast<UINT64>(reinterpret_cast<size_t>(inPointer));
+    }
+
+    //--------------------------------------------------------------------------
+    /// Pack a floating point argument. Stored with double precision, since varargs promote floats.
+    /// \param inValue The floating point value to store.
+    //--------------------------------------------------------------------------
+    void PackArgument(double inValue)
+    {
+        memcpy(&mArguments[mNumArguments++], &inValue, sizeof(double));
+    }
+
+    //--------------------------------------------------------------------------
+    /// Pack a single precision floating point argument.
+    /// \param inValue The floating point value to store.
+    //--------------------------------------------------------------------------
+    void PackArgument(float inValue)
+    {
+        PackArgument(static_cast<double>(inValue));
+    }
+
+    //--------------------------------------------------------------------------
+    /// Pack an integer or enumeration argument. Signed values are sign-extended.
+    /// \param inValue The integral value to store.
+    //--------------------------------------------------------------------------
+    template <typename ValueType>
+    void PackArgument(ValueType inValue)
+    {
+        mArguments[mNumArguments++] = static_cast<UINT64>(inValue);
+    }
+
+    //--------------------------------------------------------------------------
+    /// The printf-style format string describing the packed arguments.
+    //--------------------------------------------------------------------------
+    const char* mFormat;
+
+    //--------------------------------------------------------------------------
+    /// The number of valid values in mArguments.
+    //--------------------------------------------------------------------------
+    unsigned int mNumArguments;
+
+    //--------------------------------------------------------------------------
+    /// The raw argument values, each widened to 64 bits. Must be the last member,
+    /// since copies made by CopyTo are truncated after the last packed value.
+    //--------------------------------------------------------------------------
+    UINT64 mArguments[s_MaxPackedArguments];
+};
+
+#endif // PACKEDAPIARGUMENTS_H
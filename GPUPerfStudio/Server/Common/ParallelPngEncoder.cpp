@@ -0,0 +1,668 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Encodes RGBA images as PNG, filtering and compressing bands of
+///         rows on several threads at once.
+//==============================================================================
+
+#include <stdlib.h>
+#include <string.h>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include "ParallelPngEncoder.h"
+#include "Logger.h"
+
+/// The number of bytes in each pixel of an RGBA image.
+static const unsigned int s_PngBytesPerPixel = 4;
+
+/// The size of the deflate window. Each band is primed with this much of the previous band.
+static const unsigned int s_PngWindowSize = 32 * 1024;
+
+/// The signature at the start of every PNG file.
+static const unsigned char s_PngSignature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+/// The PNG row filter types.
+enum PngFilter
+{
+    PNG_FILTER_NONE = 0,
+    PNG_FILTER_SUB = 1,
+    PNG_FILTER_UP = 2,
+    PNG_FILTER_AVERAGE = 3,
+    PNG_FILTER_PAETH = 4,
+    PNG_FILTER_COUNT
+};
+
+/// The filters tried on each row by the default preset. Sub suits smooth rendered images,
+/// and Paeth suits everything else, so together they get close to trying all five.
+static const PngFilter s_DefaultPresetFilters[] = { PNG_FILTER_SUB, PNG_FILTER_PAETH };
+
+/// The filters tried on each row by the max preset.
+static const PngFilter s_MaxPresetFilters[] = { PNG_FILTER_NONE, PNG_FILTER_SUB, PNG_FILTER_UP, PNG_FILTER_AVERAGE, PNG_FILTER_PAETH };
+
+//--------------------------------------------------------------------------
+/// The threads that every ParallelPngEncoder shares its bands with. Threads are
+/// started the first time they're needed, then wait for the next image. The pool
+/// is never destroyed, since joining threads while the server is being unloaded
+/// can deadlock.
+//--------------------------------------------------------------------------
+class PngWorkerPool
+{
+public:
+    //--------------------------------------------------------------------------
+    /// Retrieve the pool, creating it on first use.
+    /// \returns The pool.
+    //--------------------------------------------------------------------------
+    static PngWorkerPool& Instance()
+    {
+        static PngWorkerPool* s_pPool = new PngWorkerPool();
+        return *s_pPool;
+    }
+
+    //--------------------------------------------------------------------------
+    /// Run a task on the calling thread and on up to inNumHelpers pool threads at once,
+    /// and wait for every copy to finish. The task must share out its own work, since
+    /// a helper may start after the others have finished it all. If another encoder is
+    /// using the pool, the task only runs on the calling thread.
+    /// \param inTask The task to run.
+    /// \param inNumHelpers The most pool threads to run the task on.
+    //--------------------------------------------------------------------------
+    void Run(const std::function<void()>& inTask, unsigned int inNumHelpers)
+    {
+        std::unique_lock<std::mutex> jobLock(mJobMutex, std::try_to_lock);
+
+        if (jobLock.owns_lock() == false)
+        {
+            inTask();
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+
+            while (mNumThreads < inNumHelpers)
+            {
+                try
+                {
+                    std::thread(&PngWorkerPool::WorkerLoop, this).detach();
+                    mNumThreads++;
+                }
+                catch (std::system_error&)
+                {
+                    // The threads that did start, and the calling thread, will share the work.
+                    break;
+                }
+            }
+
+            mpTask = &inTask;
+            mNumWanted = (inNumHelpers < mNumThreads) ? inNumHelpers : mNumThreads;
+        }
+
+        mWakeCondition.notify_all();
+
+        inTask();
+
+        // The calling thread only finishes once all the work has been taken, so helpers that haven't started aren't needed.
+        std::unique_lock<std::mutex> lock(mMutex);
+        mNumWanted = 0;
+        mDoneCondition.wait(lock, [this]() { return mNumRunning == 0; });
+        mpTask = NULL;
+    }
+
+private:
+    //--------------------------------------------------------------------------
+    /// Constructor.
+    //--------------------------------------------------------------------------
+    PngWorkerPool()
+        : mpTask(NULL)
+        , mNumThreads(0)
+        , mNumWanted(0)
+        , mNumRunning(0)
+    {
+    }
+
+    //--------------------------------------------------------------------------
+    /// The loop run by each pool thread.
+    //--------------------------------------------------------------------------
+    void WorkerLoop()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        for (;;)
+        {
+            mWakeCondition.wait(lock, [this]() { return mNumWanted > 0; });
+
+            mNumWanted--;
+            mNumRunning++;
+            const std::function<void()>* pTask = mpTask;
+
+            lock.unlock();
+            (*pTask)();
+            lock.lock();
+
+            if (--mNumRunning == 0)
+            {
+                mDoneCondition.notify_all();
+            }
+        }
+    }
+
+    /// Held by the encoder that's using the pool.
+    std::mutex mJobMutex;
+
+    /// Guards the members below.
+    std::mutex mMutex;
+
+    /// Wakes the pool threads when there's a task to run.
+    std::condition_variable mWakeCondition;
+
+    /// Wakes the encoder when the last pool thread finishes its task.
+    std::condition_variable mDoneCondition;
+
+    /// The task being run.
+    const std::function<void()>* mpTask;
+
+    /// The number of pool threads that have been started.
+    unsigned int mNumThreads;
+
+    /// The number of pool threads that should still start running the task.
+    unsigned int mNumWanted;
+
+    /// The number of pool threads running the task.
+    unsigned int mNumRunning;
+};
+
+//--------------------------------------------------------------------------
+/// Write a 32 bit value in the big endian order that PNG uses.
+/// \param outBytes The 4 bytes to write to.
+/// \param inValue The value.
+//--------------------------------------------------------------------------
+static void WriteUInt32BE(unsigned char* outBytes, unsigned long inValue)
+{
+    outBytes[0] = (unsigned char)(inValue >> 24);
+    outBytes[1] = (unsigned char)(inValue >> 16);
+    outBytes[2] = (unsigned char)(inValue >> 8);
+    outBytes[3] = (unsigned char)inValue;
+}
+
+//--------------------------------------------------------------------------
+/// Append a complete chunk to a PNG file.
+/// \param ioPng The PNG file data.
+/// \param inType The 4 character chunk type.
+/// \param inData The chunk's data.
+/// \param inSize The number of bytes of data.
+//--------------------------------------------------------------------------
+static void AppendChunk(std::vector<unsigned char>& ioPng, const char* inType, const unsigned char* inData, unsigned int inSize)
+{
+    size_t start = ioPng.size();
+    ioPng.resize(start + 12 + inSize);
+
+    unsigned char* pChunk = &ioPng[start];
+    WriteUInt32BE(pChunk, inSize);
+    memcpy(pChunk + 4, inType, 4);
+
+    if (inSize > 0)
+    {
+        memcpy(pChunk + 8, inData, inSize);
+    }
+
+    // The CRC covers the type and the data, but not the length.
+    WriteUInt32BE(pChunk + 8 + inSize, crc32(crc32(0, Z_NULL, 0), pChunk + 4, 4 + inSize));
+}
+
+//--------------------------------------------------------------------------
+/// The Paeth predictor from the PNG specification.
+/// \param a The byte to the left.
+/// \param b The byte above.
+/// \param c The byte above and to the left.
+/// \returns Whichever of a, b and c is closest to a + b - c.
+//--------------------------------------------------------------------------
+static inline unsigned char PaethPredictor(int a, int b, int c)
+{
+    int pa = abs(b - c);
+    int pb = abs(a - c);
+    int pc = abs(a + b - c - c);
+
+    if (pa <= pb && pa <= pc)
+    {
+        return (unsigned char)a;
+    }
+
+    return (unsigned char)((pb <= pc) ? b : c);
+}
+
+//--------------------------------------------------------------------------
+/// Filter one row of the image.
+/// \param inFilter The filter type to apply.
+/// \param inRow The row's pixels.
+/// \param inPrevRow The pixels of the row above, which are all zero for the top row.
+/// \param inSize The number of bytes in the row.
+/// \param outFiltered Receives the filtered row, without the filter type byte.
+//--------------------------------------------------------------------------
+static void FilterRow(PngFilter inFilter, const unsigned char* inRow, const unsigned char* inPrevRow, size_t inSize, unsigned char* outFiltered)
+{
+    const size_t bpp = s_PngBytesPerPixel;
+    size_t i = 0;
+
+    switch (inFilter)
+    {
+        case PNG_FILTER_NONE:
+            memcpy(outFiltered, inRow, inSize);
+            break;
+
+        case PNG_FILTER_SUB:
+            memcpy(outFiltered, inRow, bpp);
+
+            for (i = bpp; i < inSize; i++)
+            {
+                outFiltered[i] = (unsigned char)(inRow[i] - inRow[i - bpp]);
+            }
+
+            break;
+
+        case PNG_FILTER_UP:
+            for (i = 0; i < inSize; i++)
+            {
+                outFiltered[i] = (unsigned char)(inRow[i] - inPrevRow[i]);
+            }
+
+            break;
+
+        case PNG_FILTER_AVERAGE:
+            for (i = 0; i < bpp; i++)
+            {
+                outFiltered[i] = (unsigned char)(inRow[i] - (inPrevRow[i] >> 1));
+            }
+
+            for (i = bpp; i < inSize; i++)
+            {
+                outFiltered[i] = (unsigned char)(inRow[i] - ((inRow[i - bpp] + inPrevRow[i]) >> 1));
+            }
+
+            break;
+
+        case PNG_FILTER_PAETH:
+            for (i = 0; i < bpp; i++)
+            {
+                outFiltered[i] = (unsigned char)(inRow[i] - inPrevRow[i]);
+            }
+
+            for (i = bpp; i < inSize; i++)
+            {
+                outFiltered[i] = (unsigned char)(inRow[i] - PaethPredictor(inRow[i - bpp], inPrevRow[i], inPrevRow[i - bpp]));
+            }
+
+            break;
+
+        default:
+            break;
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Estimate how well a filtered row will compress, as recommended by the PNG
+/// specification: the sum of the bytes, taken as signed differences.
+/// \param inFiltered The filtered row.
+/// \param inSize The number of bytes in the row.
+/// \returns The estimate. Lower is better.
+//--------------------------------------------------------------------------
+static size_t SumOfAbsoluteDifferences(const unsigned char* inFiltered, size_t inSize)
+{
+    size_t sum = 0;
+
+    for (size_t i = 0; i < inSize; i++)
+    {
+        sum += (size_t)abs((signed char)inFiltered[i]);
+    }
+
+    return sum;
+}
+
+//--------------------------------------------------------------------------
+/// Constructor.
+/// \param inPreset Whether to favor encoding time or image size.
+/// \param inMaxThreads The most threads to encode with, including the calling
+/// thread. 0 uses one thread for each processor.
+//--------------------------------------------------------------------------
+ParallelPngEncoder::ParallelPngEncoder(PngCompressionPreset inPreset, unsigned int inMaxThreads)
+    : mPreset(inPreset)
+    , mMaxThreads(inMaxThreads)
+    , mPixels(NULL)
+    , mRowPitch(0)
+    , mRowSize(0)
+    , mNextBand(0)
+{
+    if (mMaxThreads == 0)
+    {
+        mMaxThreads = std::thread::hardware_concurrency();
+    }
+
+    if (mMaxThreads == 0)
+    {
+        mMaxThreads = 1;
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Encode an image.
+/// \param inPixels The top row of the image, with 4 bytes per pixel in RGBA order.
+/// \param inWidth The width of the image in pixels.
+/// \param inHeight The height of the image in pixels.
+/// \param inRowPitch The distance in bytes from the start of one row to the start
+/// of the row below. A negative pitch reads an image that is stored bottom row first.
+/// \param outPng Receives the PNG file data.
+/// \returns True if the image was encoded, false if there was an error.
+//--------------------------------------------------------------------------
+bool ParallelPngEncoder::Encode(const unsigned char* inPixels, unsigned int inWidth, unsigned int inHeight, int inRowPitch, std::vector<unsigned char>& outPng)
+{
+    if (inPixels == NULL || inWidth == 0 || inHeight == 0 || inWidth > 0x7FFFFFFF || inHeight > 0x7FFFFFFF)
+    {
+        Log(logERROR, "Can't encode a %u x %u PNG image\n", inWidth, inHeight);
+        return false;
+    }
+
+    mPixels = inPixels;
+    mRowPitch = inRowPitch;
+    mRowSize = (size_t)inWidth * s_PngBytesPerPixel;
+    mFiltered.resize((mRowSize + 1) * inHeight);
+
+    // Split the image into bands of whole rows.
+    unsigned int rowsPerBand = (unsigned int)((s_MinPngBandSize + mRowSize - 1) / mRowSize);
+    unsigned int numBands = (inHeight + rowsPerBand - 1) / rowsPerBand;
+
+    mBands.resize(numBands);
+
+    for (unsigned int i = 0; i < numBands; i++)
+    {
+        mBands[i].mFirstRow = i * rowsPerBand;
+        mBands[i].mNumRows = ((inHeight - mBands[i].mFirstRow) < rowsPerBand) ? (inHeight - mBands[i].mFirstRow) : rowsPerBand;
+        mBands[i].mChunk.clear();
+        mBands[i].mAdler = adler32(0, Z_NULL, 0);
+        mBands[i].mbSucceeded = false;
+    }
+
+    ProcessBands((numBands < mMaxThreads) ? numBands : mMaxThreads);
+
+    // Join the bands into a single zlib stream, spread over the IDAT chunks.
+    unsigned char header[13];
+    WriteUInt32BE(header, inWidth);
+    WriteUInt32BE(header + 4, inHeight);
+    header[8] = 8;      // bits per channel
+    header[9] = 6;      // RGBA
+    header[10] = 0;     // deflate
+    header[11] = 0;     // adaptive filtering
+    header[12] = 0;     // not interlaced
+
+    outPng.assign(s_PngSignature, s_PngSignature + sizeof(s_PngSignature));
+    AppendChunk(outPng, "IHDR", header, sizeof(header));
+
+    uLong adler = adler32(0, Z_NULL, 0);
+
+    for (unsigned int i = 0; i < numBands; i++)
+    {
+        if (mBands[i].mbSucceeded == false)
+        {
+            outPng.clear();
+            return false;
+        }
+
+        adler = adler32_combine(adler, mBands[i].mAdler, (z_off_t)((mRowSize + 1) * mBands[i].mNumRows));
+        outPng.insert(outPng.end(), mBands[i].mChunk.begin(), mBands[i].mChunk.end());
+    }
+
+    // The checksum of the whole stream is only known once every band is done, so it gets its own chunk.
+    unsigned char trailer[4];
+    WriteUInt32BE(trailer, adler);
+    AppendChunk(outPng, "IDAT", trailer, sizeof(trailer));
+    AppendChunk(outPng, "IEND", NULL, 0);
+
+    mPixels = NULL;
+    mBands.clear();
+
+    return true;
+}
+
+//--------------------------------------------------------------------------
+/// Filter and then compress every band, spreading the bands across the threads.
+/// \param inNumThreads The number of threads to use, including the calling thread.
+//--------------------------------------------------------------------------
+void ParallelPngEncoder::ProcessBands(unsigned int inNumThreads)
+{
+    // Compressing a band needs the end of the previous band to be filtered
+    // already, so every band is filtered before any are compressed.
+    for (int pass = 0; pass < 2; pass++)
+    {
+        bool bCompress = (pass == 1);
+        mNextBand = 0;
+
+        std::function<void()> task = [this, bCompress]() { BandWorker(bCompress); };
+
+        if (inNumThreads > 1)
+        {
+            PngWorkerPool::Instance().Run(task, inNumThreads - 1);
+        }
+        else
+        {
+            task();
+        }
+    }
+}
+
+//--------------------------------------------------------------------------
+/// The loop run by each thread for one pass over the bands.
+/// \param inbCompress False to filter the bands, true to compress them.
+//--------------------------------------------------------------------------
+void ParallelPngEncoder::BandWorker(bool inbCompress)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+
+    if (inbCompress)
+    {
+        // Negative window bits write raw deflate data, since the bands are joined into one zlib stream.
+        // Run-length matching is much quicker than a full search, and loses little on filtered image data.
+        int level = Z_BEST_SPEED;
+        int memLevel = 8;
+        int strategy = Z_RLE;
+
+        if (mPreset == PNG_COMPRESSION_DEFAULT)
+        {
+            level = 6;
+            strategy = Z_DEFAULT_STRATEGY;
+        }
+        else if (mPreset == PNG_COMPRESSION_MAX)
+        {
+            level = Z_BEST_COMPRESSION;
+            memLevel = 9;
+            strategy = Z_DEFAULT_STRATEGY;
+        }
+
+        int status = deflateInit2(&stream, level, Z_DEFLATED, -15, memLevel, strategy);
+
+        if (status != Z_OK)
+        {
+            // The bands this thread would have taken are left to the other threads.
+            Log(logERROR, "Failed to initialize PNG compression: error %d\n", status);
+            return;
+        }
+    }
+
+    for (unsigned int band = mNextBand++; band < mBands.size(); band = mNextBand++)
+    {
+        if (inbCompress)
+        {
+            CompressBand(band, stream);
+        }
+        else
+        {
+            FilterBand(band);
+        }
+    }
+
+    if (inbCompress)
+    {
+        deflateEnd(&stream);
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Filter every row in a band into mFiltered.
+/// \param inBandIndex The band to filter.
+//--------------------------------------------------------------------------
+void ParallelPngEncoder::FilterBand(unsigned int inBandIndex)
+{
+    const Band& band = mBands[inBandIndex];
+
+    std::vector<unsigned char> zeroRow;
+    std::vector<unsigned char> trialRow;
+
+    // The fast preset always uses one filter. The others try several on each row.
+    const PngFilter* pTrialFilters = NULL;
+    size_t numTrialFilters = 0;
+
+    if (mPreset == PNG_COMPRESSION_DEFAULT)
+    {
+        pTrialFilters = s_DefaultPresetFilters;
+        numTrialFilters = sizeof(s_DefaultPresetFilters) / sizeof(s_DefaultPresetFilters[0]);
+    }
+    else if (mPreset == PNG_COMPRESSION_MAX)
+    {
+        pTrialFilters = s_MaxPresetFilters;
+        numTrialFilters = sizeof(s_MaxPresetFilters) / sizeof(s_MaxPresetFilters[0]);
+    }
+
+    if (numTrialFilters > 0)
+    {
+        trialRow.resize(mRowSize);
+    }
+
+    for (unsigned int row = band.mFirstRow; row < band.mFirstRow + band.mNumRows; row++)
+    {
+        const unsigned char* pRow = GetSourceRow(row);
+        const unsigned char* pPrevRow = NULL;
+
+        if (row > 0)
+        {
+            pPrevRow = GetSourceRow(row - 1);
+        }
+        else
+        {
+            zeroRow.resize(mRowSize, 0);
+            pPrevRow = &zeroRow[0];
+        }
+
+        unsigned char* pOut = &mFiltered[row * (mRowSize + 1)];
+
+        if (numTrialFilters > 0)
+        {
+            // Try each filter, and keep the one that is likely to compress best.
+            size_t bestSum = 0;
+
+            for (size_t filterIndex = 0; filterIndex < numTrialFilters; filterIndex++)
+            {
+                PngFilter filter = pTrialFilters[filterIndex];
+                FilterRow(filter, pRow, pPrevRow, mRowSize, &trialRow[0]);
+                size_t sum = SumOfAbsoluteDifferences(&trialRow[0], mRowSize);
+
+                if (filterIndex == 0 || sum < bestSum)
+                {
+                    bestSum = sum;
+                    pOut[0] = (unsigned char)filter;
+                    memcpy(pOut + 1, &trialRow[0], mRowSize);
+                }
+            }
+        }
+        else
+        {
+            // Rendered images are mostly smooth, so predicting each pixel from its left neighbor is cheap and effective.
+            pOut[0] = PNG_FILTER_SUB;
+            FilterRow(PNG_FILTER_SUB, pRow, pPrevRow, mRowSize, pOut + 1);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Compress a band of filtered rows into an IDAT chunk.
+/// \param inBandIndex The band to compress.
+/// \param ioStream The calling thread's deflate stream.
+//--------------------------------------------------------------------------
+void ParallelPngEncoder::CompressBand(unsigned int inBandIndex, z_stream& ioStream)
+{
+    Band& band = mBands[inBandIndex];
+
+    size_t start = band.mFirstRow * (mRowSize + 1);
+    size_t size = band.mNumRows * (mRowSize + 1);
+    bool bLastBand = (inBandIndex == mBands.size() - 1);
+
+    if (deflateReset(&ioStream) != Z_OK)
+    {
+        Log(logERROR, "Failed to reset PNG compression\n");
+        return;
+    }
+
+    // Let this band refer back to the end of the previous band, as it could if the image was compressed in one piece.
+    if (start > 0)
+    {
+        size_t dictionarySize = (start < s_PngWindowSize) ? start : s_PngWindowSize;
+        deflateSetDictionary(&ioStream, &mFiltered[start - dictionarySize], (uInt)dictionarySize);
+    }
+
+    // The chunk starts with its length and type. The first band also starts the zlib stream.
+    size_t headerSize = (inBandIndex == 0) ? 10 : 8;
+    band.mChunk.resize(headerSize + deflateBound(&ioStream, (uLong)size) + 16);
+
+    if (inBandIndex == 0)
+    {
+        // 32K window, deflate, and the compression level, with the check bits that make the header a multiple of 31.
+        band.mChunk[8] = 0x78;
+        band.mChunk[9] = (mPreset == PNG_COMPRESSION_MAX) ? 0xDA : ((mPreset == PNG_COMPRESSION_DEFAULT) ? 0x9C : 0x01);
+    }
+
+    ioStream.next_in = &mFiltered[start];
+    ioStream.avail_in = (uInt)size;
+
+    // Every band but the last ends on a byte boundary without ending the stream, so the next band can follow it.
+    int flush = bLastBand ? Z_FINISH : Z_SYNC_FLUSH;
+    size_t used = headerSize;
+
+    for (;;)
+    {
+        if (used == band.mChunk.size())
+        {
+            band.mChunk.resize(band.mChunk.size() * 2);
+        }
+
+        ioStream.next_out = &band.mChunk[used];
+        ioStream.avail_out = (uInt)(band.mChunk.size() - used);
+
+        int status = deflate(&ioStream, flush);
+
+        used = band.mChunk.size() - ioStream.avail_out;
+
+        // A sync flush is complete once deflate stops short of filling the output.
+        if (status == Z_STREAM_END || (flush == Z_SYNC_FLUSH && ioStream.avail_out > 0 && (status == Z_OK || status == Z_BUF_ERROR)))
+        {
+            break;
+        }
+
+        if (status != Z_OK && status != Z_BUF_ERROR)
+        {
+            Log(logERROR, "PNG compression failed with error %d\n", status);
+            return;
+        }
+    }
+
+    band.mAdler = adler32(adler32(0, Z_NULL, 0), &mFiltered[start], (uInt)size);
+
+    // Finish the chunk with its length and CRC.
+    size_t dataSize = used - 8;
+    band.mChunk.resize(used + 4);
+    WriteUInt32BE(&band.mChunk[0], (unsigned long)dataSize);
+    memcpy(&band.mChunk[4], "IDAT", 4);
+    WriteUInt32BE(&band.mChunk[used], crc32(crc32(0, Z_NULL, 0), &band.mChunk[4], (uInt)(dataSize + 4)));
+
+    band.mbSucceeded = true;
+}
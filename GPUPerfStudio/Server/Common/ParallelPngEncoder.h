@@ -0,0 +1,170 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Encodes RGBA images as PNG, filtering and compressing bands of
+///         rows on several threads at once.
+//==============================================================================
+
+#ifndef PARALLELPNGENCODER_H
+#define PARALLELPNGENCODER_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+#include "zlib.h"
+
+//--------------------------------------------------------------------------
+/// The balance between encoding time and image size.
+//--------------------------------------------------------------------------
+enum PngCompressionPreset
+{
+    /// Encode as quickly as possible, for images that are streamed to the client.
+    PNG_COMPRESSION_FAST,
+
+    /// A good size in a bounded time, for images that are saved. Each row picks
+    /// the better of the Sub and Paeth filters, and is compressed at zlib level 6.
+    PNG_COMPRESSION_DEFAULT,
+
+    /// Make the image as small as possible, trying every filter on each row at the
+    /// best zlib level. Several times slower than the default, so only used on request.
+    PNG_COMPRESSION_MAX
+};
+
+//--------------------------------------------------------------------------
+/// The smallest number of bytes of image data in each band. Smaller bands
+/// spread the work more evenly over the threads, but compress slightly worse.
+//--------------------------------------------------------------------------
+static const size_t s_MinPngBandSize = 256 * 1024;
+
+//--------------------------------------------------------------------------
+/// ParallelPngEncoder writes 8 bit per channel RGBA images as PNG. The image
+/// is split into bands of rows. Each band is filtered, then compressed as its
+/// own raw deflate stream on whichever thread is free. Each band's stream is
+/// primed with the end of the previous band, so little compression is lost.
+/// Every band except the last ends with a sync flush, so the streams can be
+/// joined into a single zlib stream. Each band is written as its own IDAT chunk.
+///
+/// An encoder may be used by one thread at a time. The bands are shared with
+/// worker threads that are started the first time they're needed, and kept for
+/// the life of the process, so encoding an image doesn't start any threads.
+//--------------------------------------------------------------------------
+class ParallelPngEncoder
+{
+public:
+    //--------------------------------------------------------------------------
+    /// Constructor.
+    /// \param inPreset Whether to favor encoding time or image size.
+    /// \param inMaxThreads The most threads to encode with, including the calling
+    /// thread. 0 uses one thread for each processor.
+    //--------------------------------------------------------------------------
+    ParallelPngEncoder(PngCompressionPreset inPreset, unsigned int inMaxThreads = 0);
+
+    //--------------------------------------------------------------------------
+    /// Encode an image.
+    /// \param inPixels The top row of the image, with 4 bytes per pixel in RGBA order.
+    /// \param inWidth The width of the image in pixels.
+    /// \param inHeight The height of the image in pixels.
+    /// \param inRowPitch The distance in bytes from the start of one row to the start
+    /// of the row below. A negative pitch reads an image that is stored bottom row first.
+    /// \param outPng Receives the PNG file data.
+    /// \returns True if the image was encoded, false if there was an error.
+    //--------------------------------------------------------------------------
+    bool Encode(const unsigned char* inPixels, unsigned int inWidth, unsigned int inHeight, int inRowPitch, std::vector<unsigned char>& outPng);
+
+private:
+    //--------------------------------------------------------------------------
+    /// The encoded form of one band of rows.
+    //--------------------------------------------------------------------------
+    struct Band
+    {
+        /// The first row in the band.
+        unsigned int mFirstRow;
+
+        /// The number of rows in the band.
+        unsigned int mNumRows;
+
+        /// The band's complete IDAT chunk, including its length, type and CRC.
+        std::vector<unsigned char> mChunk;
+
+        /// The Adler-32 checksum of the band's filtered data.
+        uLong mAdler;
+
+        /// True if the band was compressed successfully.
+        bool mbSucceeded;
+    };
+
+    //--------------------------------------------------------------------------
+    /// Filter every row in a band into mFiltered.
+    /// \param inBandIndex The band to filter.
+    //--------------------------------------------------------------------------
+    void FilterBand(unsigned int inBandIndex);
+
+    //--------------------------------------------------------------------------
+    /// Compress a band of filtered rows into an IDAT chunk.
+    /// \param inBandIndex The band to compress.
+    /// \param ioStream The calling thread's deflate stream.
+    //--------------------------------------------------------------------------
+    void CompressBand(unsigned int inBandIndex, z_stream& ioStream);
+
+    //--------------------------------------------------------------------------
+    /// Filter and then compress every band, spreading the bands across the threads.
+    /// \param inNumThreads The number of threads to use, including the calling thread.
+    //--------------------------------------------------------------------------
+    void ProcessBands(unsigned int inNumThreads);
+
+    //--------------------------------------------------------------------------
+    /// The loop run by each thread for one pass over the bands.
+    /// \param inbCompress False to filter the bands, true to compress them.
+    //--------------------------------------------------------------------------
+    void BandWorker(bool inbCompress);
+
+    //--------------------------------------------------------------------------
+    /// Retrieve the address of a row of the source image.
+    /// \param inRow The row.
+    /// \returns The row's pixels.
+    //--------------------------------------------------------------------------
+    const unsigned char* GetSourceRow(unsigned int inRow) const { return mPixels + (ptrdiff_t)inRow * mRowPitch; }
+
+    //--------------------------------------------------------------------------
+    /// Whether to favor encoding time or image size.
+    //--------------------------------------------------------------------------
+    PngCompressionPreset mPreset;
+
+    //--------------------------------------------------------------------------
+    /// The most threads to encode with.
+    //--------------------------------------------------------------------------
+    unsigned int mMaxThreads;
+
+    //--------------------------------------------------------------------------
+    /// The image being encoded.
+    //--------------------------------------------------------------------------
+    const unsigned char* mPixels;
+
+    //--------------------------------------------------------------------------
+    /// The distance in bytes between the rows of the image being encoded.
+    //--------------------------------------------------------------------------
+    int mRowPitch;
+
+    //--------------------------------------------------------------------------
+    /// The number of bytes in one row of the image being encoded.
+    //--------------------------------------------------------------------------
+    size_t mRowSize;
+
+    //--------------------------------------------------------------------------
+    /// The filtered image. Each row is its filter type byte followed by the filtered row.
+    //--------------------------------------------------------------------------
+    std::vector<unsigned char> mFiltered;
+
+    //--------------------------------------------------------------------------
+    /// The bands of the image being encoded.
+    //--------------------------------------------------------------------------
+    std::vector<Band> mBands;
+
+    //--------------------------------------------------------------------------
+    /// The next band for a thread to take in the current pass.
+    //--------------------------------------------------------------------------
+    std::atomic<unsigned int> mNextBand;
+};
+
+#endif // PARALLELPNGENCODER_H
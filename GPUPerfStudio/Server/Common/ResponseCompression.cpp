@@ -0,0 +1,165 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Decides which HTTP responses are compressed, and compresses them
+///         with the content encoding that the client accepts.
+//==============================================================================
+
+#include <string.h>
+#include "ResponseCompression.h"
+#include "Compressor.h"
+#include "HTTPRequest.h"
+#include "misc.h"
+#include "mymutex.h"
+
+#ifdef USE_GZIP
+// compressors that are not currently in use, one list for each format, so
+// that each response reuses an initialized compressor rather than setting
+// up zlib again; sends can come from several threads, so each takes its
+// own compressor from the list while it is compressing
+static std::vector< Compressor* > g_idleCompressors[ 2 ];
+static mutex s_compressorMutex;
+#endif
+
+//-----------------------------------------------------------------------------
+/// Decides whether a response should be sent compressed. Only text based
+/// responses that are large enough to benefit are compressed, and only if the
+/// client accepts a compressed response and compression support is built in.
+/// \param uAcceptedEncodings the HTTP_CONTENT_ENCODING flags the client accepts
+/// \param mime the mime type of the response
+/// \param dwSize the size of the response
+/// \return true if the response should be compressed; false otherwise
+//-----------------------------------------------------------------------------
+bool ShouldCompressResponse(unsigned int uAcceptedEncodings, const char* mime, unsigned long dwSize)
+{
+#ifdef USE_GZIP
+
+    if ((uAcceptedEncodings & (HTTP_ENCODING_GZIP | HTTP_ENCODING_DEFLATE)) == 0 ||
+        dwSize < s_dwMinCompressedResponseSize ||
+        mime == NULL)
+    {
+        return false;
+    }
+
+    // images and binary data are usually compressed already
+    return (strncmp(mime, "text/", 5) == 0 ||
+            strstr(mime, "xml") != NULL ||
+            strstr(mime, "json") != NULL ||
+            strstr(mime, "javascript") != NULL);
+#else
+    PS_UNREFERENCED_PARAMETER(uAcceptedEncodings);
+    PS_UNREFERENCED_PARAMETER(mime);
+    PS_UNREFERENCED_PARAMETER(dwSize);
+    return false;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+/// Compresses a complete response, if it should be, using gzip if the client
+/// accepts it and deflate otherwise. If the compressed response is smaller,
+/// the Content-Encoding header line for it is added to the end of pHeader.
+/// \param uAcceptedEncodings the HTTP_CONTENT_ENCODING flags the client accepts
+/// \param mime the mime type of the response
+/// \param pSegments the pieces of the response
+/// \param uNumSegments the number of pieces
+/// \param dwSize the total size of the pieces
+/// \param compressed receives the compressed response
+/// \param pHeader the response's header, which the Content-Encoding line is added to
+/// \param dwHeaderSize the size of the buffer pointed to by pHeader
+/// \return true if the compressed response should be sent; false if the
+///   response should be sent as it is
+//-----------------------------------------------------------------------------
+bool CompressResponse(unsigned int uAcceptedEncodings, const char* mime, const NetSocket::SendBuffer* pSegments, unsigned int uNumSegments, unsigned long dwSize,
+                      std::vector< unsigned char >& compressed, char* pHeader, unsigned long dwHeaderSize)
+{
+#ifdef USE_GZIP
+
+    if (ShouldCompressResponse(uAcceptedEncodings, mime, dwSize) == false)
+    {
+        return false;
+    }
+
+    Compressor::Format format = Compressor::FORMAT_DEFLATE;
+    const char* pEncoding = "deflate";
+
+    if ((uAcceptedEncodings & HTTP_ENCODING_GZIP) != 0)
+    {
+        format = Compressor::FORMAT_GZIP;
+        pEncoding = "gzip";
+    }
+
+    Compressor* pCompressor = NULL;
+
+    {
+        ScopeLock lock(s_compressorMutex);
+
+        if (g_idleCompressors[ format ].empty() == false)
+        {
+            pCompressor = g_idleCompressors[ format ].back();
+            g_idleCompressors[ format ].pop_back();
+        }
+    }
+
+    if (pCompressor == NULL)
+    {
+        pCompressor = new Compressor(format);
+    }
+
+    bool bResult = pCompressor->Begin(dwSize, compressed);
+
+    for (unsigned int i = 0; i < uNumSegments && bResult; i++)
+    {
+        bResult = pCompressor->Append(pSegments[i].pData, pSegments[i].size, compressed);
+    }
+
+    bResult = bResult && pCompressor->Finish(compressed);
+
+    {
+        ScopeLock lock(s_compressorMutex);
+        g_idleCompressors[ format ].push_back(pCompressor);
+    }
+
+    // data that doesn't compress is sent as it is
+    if (bResult == false || compressed.size() >= dwSize)
+    {
+        return false;
+    }
+
+    size_t headerLen = strlen(pHeader);
+    sprintf_s(pHeader + headerLen, dwHeaderSize - headerLen, "Content-Encoding: %s\r\n", pEncoding);
+
+    return true;
+#else
+    PS_UNREFERENCED_PARAMETER(uAcceptedEncodings);
+    PS_UNREFERENCED_PARAMETER(mime);
+    PS_UNREFERENCED_PARAMETER(pSegments);
+    PS_UNREFERENCED_PARAMETER(uNumSegments);
+    PS_UNREFERENCED_PARAMETER(dwSize);
+    PS_UNREFERENCED_PARAMETER(compressed);
+    PS_UNREFERENCED_PARAMETER(pHeader);
+    PS_UNREFERENCED_PARAMETER(dwHeaderSize);
+    return false;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+/// Frees the compressors that CompressResponse keeps for reuse.
+//-----------------------------------------------------------------------------
+void DeleteIdleCompressors()
+{
+#ifdef USE_GZIP
+    ScopeLock lock(s_compressorMutex);
+
+    for (unsigned int i = 0; i < sizeof(g_idleCompressors) / sizeof(g_idleCompressors[ 0 ]); i++)
+    {
+        for (std::vector< Compressor* >::iterator iter = g_idleCompressors[ i ].begin(); iter != g_idleCompressors[ i ].end(); ++iter)
+        {
+            delete *iter;
+        }
+
+        g_idleCompressors[ i ].clear();
+    }
+
+#endif
+}
@@ -0,0 +1,56 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Decides which HTTP responses are compressed, and compresses them
+///         with the content encoding that the client accepts.
+//==============================================================================
+
+#ifndef RESPONSE_COMPRESSION_H
+#define RESPONSE_COMPRESSION_H
+
+#include <vector>
+#include "NetSocket.h"
+
+//-----------------------------------------------------------------------------
+/// Responses smaller than this are sent uncompressed, since compressing them
+/// would save less time than it takes.
+//-----------------------------------------------------------------------------
+static const unsigned long s_dwMinCompressedResponseSize = 1024;
+
+//-----------------------------------------------------------------------------
+/// Decides whether a response should be sent compressed. Only text based
+/// responses that are large enough to benefit are compressed, and only if the
+/// client accepts a compressed response and compression support is built in.
+/// \param uAcceptedEncodings the HTTP_CONTENT_ENCODING flags the client accepts
+/// \param mime the mime type of the response
+/// \param dwSize the size of the response
+/// \return true if the response should be compressed; false otherwise
+//-----------------------------------------------------------------------------
+bool ShouldCompressResponse(unsigned int uAcceptedEncodings, const char* mime, unsigned long dwSize);
+
+//-----------------------------------------------------------------------------
+/// Compresses a complete response, if it should be, using gzip if the client
+/// accepts it and deflate otherwise. If the compressed response is smaller,
+/// the Content-Encoding header line for it is added to the end of pHeader.
+/// Several threads may compress responses at the same time.
+/// \param uAcceptedEncodings the HTTP_CONTENT_ENCODING flags the client accepts
+/// \param mime the mime type of the response
+/// \param pSegments the pieces of the response
+/// \param uNumSegments the number of pieces
+/// \param dwSize the total size of the pieces
+/// \param compressed receives the compressed response
+/// \param pHeader the response's header, which the Content-Encoding line is added to
+/// \param dwHeaderSize the size of the buffer pointed to by pHeader
+/// \return true if the compressed response should be sent; false if the
+///   response should be sent as it is
+//-----------------------------------------------------------------------------
+bool CompressResponse(unsigned int uAcceptedEncodings, const char* mime, const NetSocket::SendBuffer* pSegments, unsigned int uNumSegments, unsigned long dwSize,
+                      std::vector< unsigned char >& compressed, char* pHeader, unsigned long dwHeaderSize);
+
+//-----------------------------------------------------------------------------
+/// Frees the compressors that CompressResponse keeps for reuse.
+//-----------------------------------------------------------------------------
+void DeleteIdleCompressors();
+
+#endif // RESPONSE_COMPRESSION_H
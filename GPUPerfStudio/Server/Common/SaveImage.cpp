@@ -16,10 +16,8 @@
 #pragma warning( pop ) 
 #elif defined (_LINUX)
     #include <stdio.h>
+    #include <setjmp.h>
     #include "WinDefs.h"
-    #include "png.h"
-
-    using namespace GPS;
 
     #define XMD_H       // INT32 etc already defined
     //extern "C"
@@ -29,10 +27,13 @@
     #include "jpegint.h"
     //}
 
+    using namespace GPS;
+
     static const int IMAGE_QUALITY = 90;        // quality of output image (100 best, 0 worst)
     static const int MIN_IMAGE_DIMENSION = 64;  // minimum dimension of image for space allocation
 
 #endif
+#include <vector>
 #include "SaveImage.h"
 #include "Logger.h"
 
@@ -253,60 +254,6 @@ static bool _RGBtoJpeg(unsigned char* pDIB, int iWidth, int iHeight, UINT32* ulS
 
     return (EncodeBitmap(DestBmp, L"image/jpeg", ulSize, pData));
 }
-
-static bool _RGBAtoPNG(unsigned char* pDIB, int iWidth, int iHeight, UINT32* ulSize, unsigned char** pData)
-{
-    if (pDIB == NULL || ulSize == NULL || pData == NULL)
-    {
-        return false;
-    }
-
-    // Create the dest image
-    Bitmap DestBmp(iWidth, iHeight, PixelFormat32bppARGB);
-    Rect rect1(0, 0, iWidth, iHeight);
-
-    BitmapData bitmapData;
-    memset(&bitmapData, 0, sizeof(bitmapData));
-    DestBmp.LockBits(
-        &rect1,
-        ImageLockModeRead,
-        PixelFormat32bppARGB,
-        &bitmapData);
-
-    int nStride1 = bitmapData.Stride;
-
-    if (nStride1 < 0)
-    {
-        nStride1 = -nStride1;
-    }
-
-    char* pDestData = (char*)bitmapData.Scan0;
-
-    // copy the data, inverting the image top->bottom, and RGBA -> BGRA
-    unsigned char* pSrcData = NULL;
-
-    for (UINT row = bitmapData.Height - 1; row > 0 ; --row)
-    {
-        pSrcData = &(pDIB[row * bitmapData.Stride]);
-
-        for (UINT col = 0; col < bitmapData.Width; ++col)
-        {
-            char cRed = *pSrcData++;
-            char cGreen = *pSrcData++;
-            char cBlue = *pSrcData++;
-            char cAlpha = *pSrcData++;
-
-            *pDestData++ = cBlue;
-            *pDestData++ = cGreen;
-            *pDestData++ = cRed;
-            *pDestData++ = cAlpha;
-        }
-    }
-
-    DestBmp.UnlockBits(&bitmapData);
-
-    return (EncodeBitmap(DestBmp, L"image/png", ulSize, pData));
-}
 #endif // def WIN32
 
 ////////////////////////////////////////////////////////////////////////////////////
@@ -401,30 +348,6 @@ typedef struct
 
 typedef my_mem_destination_mgr* my_mem_dest_ptr;
 
-struct State
-{
-    unsigned char* m_WriteBuffer;
-    unsigned long  m_Size;
-};
-
-static  void    pngWriteData(png_structp png_ptr, png_bytep data, png_size_t length)
-{
-    if (png_ptr == NULL)
-    {
-        return;
-    }
-
-    State*   state = (State*)(png_get_io_ptr(png_ptr));
-    unsigned char*   ptr = state->m_WriteBuffer;
-    ptr += state->m_Size;
-    memcpy(ptr, data, length);
-    state->m_Size += length;
-}
-
-static  void    pngFlush(__attribute__((unused)) png_structp png_ptr)
-{
-}
-
 /*
 // Invert the image top to bottom
 static  void    FlipImage(unsigned char* pImageData, int width, int height)
@@ -530,121 +453,51 @@ static  bool    _RGBtoJpeg(unsigned char* pImageData, int width, int height, UIN
     return true;
 }
 
-static   bool    _RGBAtoPNG(unsigned char* pImageData, int width, int height, UINT32* outSize, unsigned char** outBuffer)
-{
-    static State state;
-    GPS::png_structp png_ptr;
-    png_infop info_ptr;
-    static const int bytes_per_pixel = 4;
-
-    // initialize stuff
-    png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
-
-    if (!png_ptr)
-    {
-        Log(logERROR, "[write_png_file] png_create_write_struct failed");
-        return false;
-    }
-
-    info_ptr = png_create_info_struct(png_ptr);
+#endif   // _WIN32
 
-    if (!info_ptr)
+////////////////////////////////////////////////////////////////////////////////////
+/// Converts an RGBA 8-bit per channel texture into a PNG image, using several threads
+////////////////////////////////////////////////////////////////////////////////////
+static bool _RGBAtoPNG(unsigned char* pImageData, int width, int height, UINT32* outSize, unsigned char** outBuffer, PngCompressionPreset ePreset)
+{
+    if (pImageData == NULL || width <= 0 || height <= 0 || outSize == NULL || outBuffer == NULL)
     {
-        png_destroy_write_struct(&png_ptr, NULL);
-        Log(logERROR, "[write_png_file] png_create_info_struct failed");
         return false;
     }
 
-    if (setjmp(png_jmpbuf(png_ptr)))
-    {
-        png_destroy_write_struct(&png_ptr, &info_ptr);
-        Log(logERROR, "[write_png_file] Error during init_io");
-        return false;
-    }
+    int rowPitch = width * 4;
+    unsigned char* pTopRow = pImageData;
 
-    // allocate enough memory for the resultant image. Ensure very small images
-    // have more than enough memory; sometimes the compressed image is larger
-    // than the source image leading to buffer overruns
-    int minWidth = std::max(MIN_IMAGE_DIMENSION, width);
-    int minHeight = std::max(MIN_IMAGE_DIMENSION, height);
-    state.m_WriteBuffer = (unsigned char*)malloc(minWidth * minHeight * bytes_per_pixel);
-    state.m_Size = 0;
+#ifdef _WIN32
+    // The image data is stored bottom row first
+    pTopRow = pImageData + (height - 1) * rowPitch;
+    rowPitch = -rowPitch;
+#endif
 
-    // set the write function to write to a buffer rather than a file
-    png_set_write_fn(png_ptr, &state, pngWriteData, pngFlush);
+    ParallelPngEncoder encoder(ePreset);
+    std::vector<unsigned char> pngData;
 
-    // write header
-    if (setjmp(png_jmpbuf(png_ptr)))
+    if (encoder.Encode(pTopRow, (unsigned int)width, (unsigned int)height, rowPitch, pngData) == false)
     {
-        png_destroy_write_struct(&png_ptr, &info_ptr);
-        Log(logERROR, "[write_png_file] Error during writing header");
+        Log(logERROR, "Failed to encode a %d x %d PNG image\n", width, height);
         return false;
     }
 
-    png_set_IHDR(png_ptr, info_ptr, width, height,
-                 8, PNG_COLOR_TYPE_RGB_ALPHA, PNG_INTERLACE_NONE,
-                 PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
-
-    png_write_info(png_ptr, info_ptr);
+    unsigned char* outBuff = (unsigned char*)malloc(pngData.size());
 
-    // write bytes
-    if (setjmp(png_jmpbuf(png_ptr)))
+    if (outBuff == NULL)
     {
-        png_destroy_write_struct(&png_ptr, &info_ptr);
-        Log(logERROR, "[write_png_file] Error during writing bytes");
         return false;
     }
 
-    //   FlipImage( pImageData, width, height );
+    memcpy(outBuff, &pngData[0], pngData.size());
 
-    png_bytepp row_pointers = new png_bytep[height];
-
-    int maxHeight = PNG_UINT_32_MAX / png_sizeof(png_bytep);
-
-    if (height > maxHeight)
-    {
-        Log(logERROR, "Image is too tall to process in memory");
-    }
-
-    for (int k = 0; k < height; k++)
-    {
-        row_pointers[k] = pImageData + k * width * bytes_per_pixel;
-    }
-
-    png_write_image(png_ptr, row_pointers);
-
-    //   FlipImage( pImageData, width, height);
-
-    // end write
-    if (setjmp(png_jmpbuf(png_ptr)))
-    {
-        png_destroy_write_struct(&png_ptr, &info_ptr);
-        Log(logERROR, "[write_png_file] Error during end of write");
-        return false;
-    }
-
-    png_write_end(png_ptr, info_ptr);
-
-    png_destroy_write_struct(&png_ptr, &info_ptr);
-
-    // cleanup heap allocation
-    delete [] row_pointers;
-
-    // Allocate a buffer the size of the jpg image and copy the data to it
-    // There's no way of knowing how much space will be needed until the
-    // image has been compressed
-    unsigned char* outBuff = (unsigned char*)malloc(state.m_Size);
-    memcpy(outBuff, state.m_WriteBuffer, state.m_Size);
-    free(state.m_WriteBuffer);
-
-    *outSize = state.m_Size;
+    *outSize = (UINT32)pngData.size();
     *outBuffer = outBuff;
 
     return true;
 }
 
-#endif   // _WIN32
-
 bool RGBtoJpeg(unsigned char* pDIB, int iWidth, int iHeight, UINT32* ulSize, unsigned char** pData)
 {
 #ifdef _WIN32
@@ -662,21 +515,9 @@ bool RGBtoJpeg(unsigned char* pDIB, int iWidth, int iHeight, UINT32* ulSize, uns
     return res;
 }
 
-bool RGBAtoPNG(unsigned char* pDIB, int iWidth, int iHeight, UINT32* ulSize, unsigned char** pData)
+bool RGBAtoPNG(unsigned char* pDIB, int iWidth, int iHeight, UINT32* ulSize, unsigned char** pData, PngCompressionPreset ePreset)
 {
-#ifdef _WIN32
-    GdiplusStartupInput gdiplusStartupInput;
-    ULONG_PTR gdiplusToken;
-    GdiplusStartup(&gdiplusToken, &gdiplusStartupInput, NULL);
-
-    bool res = _RGBAtoPNG(pDIB, iWidth, iHeight, ulSize, pData);
-
-    GdiplusShutdown(gdiplusToken);
-#else
-    bool res = _RGBAtoPNG(pDIB, iWidth, iHeight, ulSize, pData);
-#endif
-
-    return res;
+    return _RGBAtoPNG(pDIB, iWidth, iHeight, ulSize, pData, ePreset);
 }
 
 bool RGBAtoBMP(unsigned char* pImageData, int iWidth, int iHeight, UINT32* pulSize, unsigned char** ppOutData)
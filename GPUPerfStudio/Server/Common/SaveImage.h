@@ -9,6 +9,7 @@
 #define SAVEIMAGE_H
 
 #include <string>
+#include "ParallelPngEncoder.h"
 using std::string;
 
 enum OGL_IMAGE_FILE_FORMAT
@@ -48,9 +49,11 @@ bool RGBAtoBMP(unsigned char* pImageData, int iWidth, int iHeight, UINT32* pulSi
 /// \param iWidth width of the texture
 /// \param iHeight height of the texture
 /// \param[out] pulSize will contain the number of byte in the output texture
-/// \param[out] ppOutData will contain the BMP image data
+/// \param[out] ppOutData will contain the PNG image data
+/// \param ePreset PNG_COMPRESSION_DEFAULT for images that are saved; PNG_COMPRESSION_FAST for images that are only streamed to the client.
+/// PNG_COMPRESSION_MAX makes slightly smaller images, but takes several times as long.
 /// \return true if the data could be converted correctly; false otherwise
-bool RGBAtoPNG(unsigned char* pImageData, int iWidth, int iHeight, UINT32* pulSize, unsigned char** ppOutData);
+bool RGBAtoPNG(unsigned char* pImageData, int iWidth, int iHeight, UINT32* pulSize, unsigned char** ppOutData, PngCompressionPreset ePreset = PNG_COMPRESSION_DEFAULT);
 
 #if defined (_WIN32)
 #pragma comment( lib, "gdiplus.lib" )
@@ -0,0 +1,318 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  A sharded, open-addressing hash table that maps pointers to pointers.
+///         Lookups never take a lock.
+//==============================================================================
+
+#ifndef SHARDEDPOINTERMAP_H
+#define SHARDEDPOINTERMAP_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include "mymutex.h"
+
+//--------------------------------------------------------------------------
+/// The number of independently-locked shards within each ShardedPointerMap. Must be a power of two.
+//--------------------------------------------------------------------------
+static const unsigned int s_PointerMapShardCount = 16;
+
+//--------------------------------------------------------------------------
+/// The number of slots that each shard's table starts out with. Must be a power of two.
+//--------------------------------------------------------------------------
+static const size_t s_PointerMapInitialShardCapacity = 64;
+
+//--------------------------------------------------------------------------
+/// ShardedPointerMap associates pointer keys with pointer values. Keys are spread across
+/// a fixed number of shards, and each shard is a linear-probing hash table.
+/// Find never takes a lock, so it's safe to call from any thread at any time. Insert only
+/// locks the shard that the key belongs to. When a shard's table grows, the new table is
+/// published atomically, and the old one is kept alive until the map is destroyed so that
+/// a concurrent Find can finish reading it. Since a table is only replaced once it's half
+/// full, the retired tables never add up to more than the size of the current one.
+/// Entries can't be removed. A NULL key can't be inserted, since NULL marks an empty slot.
+//--------------------------------------------------------------------------
+template <typename KeyType, typename ValueType>
+class ShardedPointerMap
+{
+public:
+    //--------------------------------------------------------------------------
+    /// Constructor allocates the initial table for each shard.
+    //--------------------------------------------------------------------------
+    ShardedPointerMap()
+    {
+        for (unsigned int shardIndex = 0; shardIndex < s_PointerMapShardCount; ++shardIndex)
+        {
+            mShards[shardIndex].mTable.store(new ShardTable(s_PointerMapInitialShardCapacity, NULL), std::memory_order_relaxed);
+            mShards[shardIndex].mCount = 0;
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// Destructor releases each shard's table, along with the tables it replaced.
+    //--------------------------------------------------------------------------
+    ~ShardedPointerMap()
+    {
+        for (unsigned int shardIndex = 0; shardIndex < s_PointerMapShardCount; ++shardIndex)
+        {
+            ShardTable* table = mShards[shardIndex].mTable.load(std::memory_order_relaxed);
+
+            while (table != NULL)
+            {
+                ShardTable* previousTable = table->mPreviousTable;
+                delete table;
+                table = previousTable;
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// Find the value associated with a key. Doesn't lock, and may run concurrently with Insert.
+    /// \param inKey The key to look up.
+    /// \returns The value associated with the key, or NULL if the key isn't in the map.
+    //--------------------------------------------------------------------------
+    ValueType Find(KeyType inKey) const
+    {
+        const size_t hash = HashKey(inKey);
+        const ShardTable* table = mShards[hash & (s_PointerMapShardCount - 1)].mTable.load(std::memory_order_acquire);
+        const size_t mask = table->mCapacity - 1;
+
+        // Tables are never more than half full, so the probe always reaches an empty slot.
+        for (size_t slotIndex = (hash >> 4) & mask;; slotIndex = (slotIndex + 1) & mask)
+        {
+            const TableSlot& slot = table->mSlots[slotIndex];
+            KeyType slotKey = slot.mKey.load(std::memory_order_acquire);
+
+            if (slotKey == inKey)
+            {
+                return slot.mValue.load(std::memory_order_acquire);
+            }
+            else if (slotKey == NULL)
+            {
+                return NULL;
+            }
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// Associate a value with a key, replacing any value that the key already has.
+    /// \param inKey The key to insert. Must not be NULL.
+    /// \param inValue The value to associate with the key.
+    //--------------------------------------------------------------------------
+    void Insert(KeyType inKey, ValueType inValue)
+    {
+        if (inKey == NULL)
+        {
+            return;
+        }
+
+        const size_t hash = HashKey(inKey);
+        MapShard& shard = mShards[hash & (s_PointerMapShardCount - 1)];
+
+        ScopeLock shardLock(&shard.mLock);
+
+        ShardTable* table = shard.mTable.load(std::memory_order_relaxed);
+        TableSlot* slot = FindSlot(table, inKey, hash);
+
+        if (slot->mKey.load(std::memory_order_relaxed) == inKey)
+        {
+            slot->mValue.store(inValue, std::memory_order_release);
+            return;
+        }
+
+        if ((shard.mCount + 1) * 2 > table->mCapacity)
+        {
+            table = Grow(shard, table);
+            slot = FindSlot(table, inKey, hash);
+        }
+
+        // Publish the key last, so a reader that finds the key also finds its value.
+        slot->mValue.store(inValue, std::memory_order_relaxed);
+        slot->mKey.store(inKey, std::memory_order_release);
+        shard.mCount++;
+    }
+
+    //--------------------------------------------------------------------------
+    /// Invoke a function on every entry in the map. Each shard is locked while it's visited,
+    /// so the visitor must not insert into the map.
+    /// \param inVisitor A function or functor taking (KeyType, ValueType).
+    //--------------------------------------------------------------------------
+    template <typename VisitorType>
+    void ForEach(VisitorType inVisitor) const
+    {
+        for (unsigned int shardIndex = 0; shardIndex < s_PointerMapShardCount; ++shardIndex)
+        {
+            const MapShard& shard = mShards[shardIndex];
+
+            ScopeLock shardLock(&shard.mLock);
+
+            const ShardTable* table = shard.mTable.load(std::memory_order_relaxed);
+
+            for (size_t slotIndex = 0; slotIndex < table->mCapacity; ++slotIndex)
+            {
+                KeyType slotKey = table->mSlots[slotIndex].mKey.load(std::memory_order_relaxed);
+
+                if (slotKey != NULL)
+                {
+                    inVisitor(slotKey, table->mSlots[slotIndex].mValue.load(std::memory_order_relaxed));
+                }
+            }
+        }
+    }
+
+private:
+    //--------------------------------------------------------------------------
+    /// Disable copying, since the map owns its tables.
+    //--------------------------------------------------------------------------
+    ShardedPointerMap(const ShardedPointerMap&);
+
+    //--------------------------------------------------------------------------
+    /// Disable assignment, since the map owns its tables.
+    //--------------------------------------------------------------------------
+    ShardedPointerMap& operator=(const ShardedPointerMap&);
+
+    //--------------------------------------------------------------------------
+    /// A single slot within a shard's table. A NULL key marks an empty slot.
+    //--------------------------------------------------------------------------
+    struct TableSlot
+    {
+        //--------------------------------------------------------------------------
+        /// Constructor marks the slot as empty.
+        //--------------------------------------------------------------------------
+        TableSlot() : mKey(NULL), mValue(NULL) { }
+
+        /// The slot's key.
+        std::atomic<KeyType> mKey;
+
+        /// The value associated with the key.
+        std::atomic<ValueType> mValue;
+    };
+
+    //--------------------------------------------------------------------------
+    /// A shard's table of slots, along with the smaller table that it replaced.
+    //--------------------------------------------------------------------------
+    struct ShardTable
+    {
+        //--------------------------------------------------------------------------
+        /// Constructor allocates the table's slots.
+        /// \param inCapacity The number of slots in the table. Must be a power of two.
+        /// \param inPreviousTable The table that this one replaces, or NULL.
+        //--------------------------------------------------------------------------
+        ShardTable(size_t inCapacity, ShardTable* inPreviousTable)
+            : mCapacity(inCapacity)
+            , mSlots(new TableSlot[inCapacity])
+            , mPreviousTable(inPreviousTable)
+        {
+        }
+
+        //--------------------------------------------------------------------------
+        /// Destructor releases the table's slots.
+        //--------------------------------------------------------------------------
+        ~ShardTable()
+        {
+            delete[] mSlots;
+        }
+
+        /// The number of slots in the table.
+        size_t mCapacity;
+
+        /// The table's slots.
+        TableSlot* mSlots;
+
+        /// The table that this one replaced. Kept until the map is destroyed, since a reader may still be using it.
+        ShardTable* mPreviousTable;
+    };
+
+    //--------------------------------------------------------------------------
+    /// A single shard of the map.
+    //--------------------------------------------------------------------------
+    struct MapShard
+    {
+        /// Locked when inserting into the shard, or visiting its entries.
+        mutable mutex mLock;
+
+        /// The shard's current table.
+        std::atomic<ShardTable*> mTable;
+
+        /// The number of entries in the shard. Only accessed while mLock is held.
+        size_t mCount;
+    };
+
+    //--------------------------------------------------------------------------
+    /// Hash a pointer key. Allocations are aligned, so the low bits of a pointer carry
+    /// very little information. Mix all of the bits together before they're used.
+    /// \param inKey The key to hash.
+    /// \returns The key's hash.
+    //--------------------------------------------------------------------------
+    static size_t HashKey(KeyType inKey)
+    {
+        uint64_t bits = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(inKey));
+        bits ^= bits >> 33;
+        bits *= 0xff51afd7ed558ccdULL;
+        bits ^= bits >> 33;
+        return static_cast<size_t>(bits);
+    }
+
+    //--------------------------------------------------------------------------
+    /// Find the slot holding a key, or the empty slot where the key should be inserted.
+    /// Must be called with the shard's lock held.
+    /// \param inTable The table to search.
+    /// \param inKey The key to search for.
+    /// \param inHash The hash of the key.
+    /// \returns The slot holding the key, or the first empty slot in the key's probe sequence.
+    //--------------------------------------------------------------------------
+    static TableSlot* FindSlot(ShardTable* inTable, KeyType inKey, size_t inHash)
+    {
+        const size_t mask = inTable->mCapacity - 1;
+        size_t slotIndex = (inHash >> 4) & mask;
+
+        for (;;)
+        {
+            KeyType slotKey = inTable->mSlots[slotIndex].mKey.load(std::memory_order_relaxed);
+
+            if (slotKey == inKey || slotKey == NULL)
+            {
+                return &inTable->mSlots[slotIndex];
+            }
+
+            slotIndex = (slotIndex + 1) & mask;
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// Replace a shard's table with one twice the size. Must be called with the shard's lock held.
+    /// \param ioShard The shard to grow.
+    /// \param inTable The shard's current table.
+    /// \returns The shard's new table.
+    //--------------------------------------------------------------------------
+    static ShardTable* Grow(MapShard& ioShard, ShardTable* inTable)
+    {
+        ShardTable* newTable = new ShardTable(inTable->mCapacity * 2, inTable);
+
+        for (size_t slotIndex = 0; slotIndex < inTable->mCapacity; ++slotIndex)
+        {
+            KeyType slotKey = inTable->mSlots[slotIndex].mKey.load(std::memory_order_relaxed);
+
+            if (slotKey != NULL)
+            {
+                TableSlot* newSlot = FindSlot(newTable, slotKey, HashKey(slotKey));
+                newSlot->mKey.store(slotKey, std::memory_order_relaxed);
+                newSlot->mValue.store(inTable->mSlots[slotIndex].mValue.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+        }
+
+        // Readers that load the new table see all of the entries copied into it.
+        ioShard.mTable.store(newTable, std::memory_order_release);
+
+        return newTable;
+    }
+
+    //--------------------------------------------------------------------------
+    /// The map's shards.
+    //--------------------------------------------------------------------------
+    MapShard mShards[s_PointerMapShardCount];
+};
+
+#endif // SHARDEDPOINTERMAP_H
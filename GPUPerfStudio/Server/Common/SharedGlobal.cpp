@@ -10,12 +10,19 @@
 #elif defined (_LINUX)
     #include "WinDefs.h"
 #endif
+#include <thread>
 #include <AMDTOSWrappers/Include/osSystemError.h>
 #include "SharedGlobal.h"
 #include "Logger.h"
 
 const char* SHARED_MEMORY_NAME = "PerfStudioSharedGlobals";
 
+/// The number of times a snapshot refresh checks for a write to finish before it starts yielding the thread.
+static const unsigned int s_SnapshotSpinCount = 64;
+
+/// The number of attempts a snapshot refresh makes before it falls back to the previous snapshot.
+static const unsigned int s_SnapshotMaxAttempts = 1024;
+
 //-----------------------------------------------------------------------------
 /// Provides access to the single instance of this class in the process. If the
 /// class does not exist, it will initialize it and log any errors that occur.
@@ -67,9 +74,12 @@ bool SharedGlobal::SetPath(size_t offset, const char* path)
 
     if (Lock())
     {
+        BeginWrite();
         strcpy_s(&((char*)m_MapFile->Get())[offset], PS_MAX_PATH, path);
+        EndWrite();
 
         Unlock();
+        RefreshSnapshot();
         return (true);
     }
 
@@ -123,6 +133,12 @@ SharedGlobal::SharedGlobal()
     m_bInitialized = false;
 
     memset(&m_Shadow, 0, sizeof(PsSharedGlobal));
+    memset(&m_Snapshot, 0, sizeof(PsSharedGlobal));
+
+    // The shared generation is never odd once a write is finished, so the first read always takes a snapshot.
+    m_SnapshotSequence = 0;
+    m_SnapshotGeneration = 1;
+    m_StalledGeneration = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -130,6 +146,7 @@ SharedGlobal::SharedGlobal()
 //-----------------------------------------------------------------------------
 SharedGlobal::~SharedGlobal()
 {
+    g_pSharedOptionsGeneration.store(NULL, std::memory_order_relaxed);
     delete m_MapFile;
 
     delete m_Mutex;
@@ -159,9 +176,89 @@ bool SharedGlobal::Initialize()
     }
 
     m_bInitialized = true;
+
+    // _RefreshCachedLogLevel compares this against the generation of the cached log level, so it sees changes made by other processes.
+    g_pSharedOptionsGeneration.store(&GetSharedGeneration(), std::memory_order_relaxed);
     return (true);
 }
 
+//-----------------------------------------------------------------------------
+/// Copy the global shared memory region into this process' snapshot. A copy that a write
+/// from any process overlapped is discarded and retaken, so the snapshot is always consistent.
+/// Writes only copy a single value, but a descheduled writer, or one that died mid-write,
+/// could hold up the copy indefinitely. So the wait is bounded: after s_SnapshotSpinCount
+/// attempts the thread yields between attempts, and after s_SnapshotMaxAttempts the previous
+/// snapshot is kept. The write that was waited on is recorded in m_StalledGeneration, so
+/// readers keep using the previous snapshot until it finishes instead of waiting on it again.
+/// Does nothing if another thread has already brought the snapshot up to date.
+//-----------------------------------------------------------------------------
+void SharedGlobal::RefreshSnapshot(void)
+{
+    PsAssert(this != NULL);
+    PsAssert(m_MapFile != NULL);
+
+    m_SnapshotMutex.lock();
+
+    std::atomic<uint32>& sharedGeneration = GetSharedGeneration();
+
+    for (unsigned int attempt = 0; attempt < s_SnapshotMaxAttempts; attempt++)
+    {
+        uint32 generationBefore = sharedGeneration.load(std::memory_order_acquire);
+
+        if ((generationBefore & 1) != 0)
+        {
+            if (generationBefore == m_StalledGeneration.load(std::memory_order_relaxed))
+            {
+                // Already gave up waiting for this write.
+                break;
+            }
+
+            if ((attempt + 1) == s_SnapshotMaxAttempts)
+            {
+                m_StalledGeneration.store(generationBefore, std::memory_order_relaxed);
+            }
+            else if (attempt >= s_SnapshotSpinCount)
+            {
+                std::this_thread::yield();
+            }
+
+            continue;
+        }
+
+        if (m_SnapshotGeneration.load(std::memory_order_relaxed) == generationBefore)
+        {
+            break;
+        }
+
+        // Copy into a local block first, so that a torn copy never replaces the previous snapshot.
+        memcpy(&m_RefreshBlock, m_MapFile->Get(), sizeof(PsSharedGlobal));
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        if (sharedGeneration.load(std::memory_order_relaxed) != generationBefore)
+        {
+            continue;
+        }
+
+        uint32 sequence = m_SnapshotSequence.load(std::memory_order_relaxed);
+        m_SnapshotSequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        memcpy(&m_Snapshot, &m_RefreshBlock, sizeof(PsSharedGlobal));
+
+        m_SnapshotGeneration.store(generationBefore, std::memory_order_relaxed);
+        m_SnapshotSequence.store(sequence + 2, std::memory_order_release);
+        break;
+    }
+
+    // The snapshot is consistent, and only changes while m_SnapshotMutex is held. If the refresh gave up on
+    // a stalled write, cache the level at that write's generation, so _RefreshCachedLogLevel doesn't retry the refresh.
+    uint32 currentGeneration = sharedGeneration.load(std::memory_order_relaxed);
+    uint32 cachedGeneration = (currentGeneration == m_StalledGeneration.load(std::memory_order_relaxed)) ? currentGeneration : m_SnapshotGeneration.load(std::memory_order_relaxed);
+    _SetCachedLogLevel(m_Snapshot.OptionLogLevel, cachedGeneration);
+
+    m_SnapshotMutex.unlock();
+}
+
 //-----------------------------------------------------------------------------
 /// Lock global shared memory region for exclusive access.
 /// \return true if the shared memory could be locked; false otherwise
@@ -9,6 +9,7 @@
 #define GPS_SHAREDGLOBAL_H
 
 #include <stddef.h>
+#include <atomic>
 #include "Logger.h"
 #include "defines.h"
 #include "SharedMemory.h"
@@ -55,7 +56,10 @@ struct PsSharedGlobal
     uint32 OptionLayerFlag;             ///< Allows a GPS developer to turn on or off certain layers in a Plugin
     uint32 OptionStatsDuration;         ///< Sets the target millisecond duration for which to collect frame statistics.
     uint32 OptionStatsTrigger;          ///< Customize the trigger (any valid Virtual-Key Code) used to start collection of frame statistics.
+    uint32 OptionFlightRecorderFrames;  ///< DX12 Only: The number of recent frames kept by the flight recorder. Zero disables the flight recorder.
+    uint32 OptionKeepAlivePort;         ///< Linux Only: The port that the plugin accepts keep-alive connections on itself, instead of through the web server. Zero disables it.
     float OptionSpeed;                  ///< Overrides the default speed setting in the TimeControlLayer
+    float OptionFlightRecorderThreshold;///< DX12 Only: Dump the flight recorder when a frame's CPU duration exceeds this many milliseconds. Zero disables the automatic dump.
     bool OptionBreak;                   ///< Allows a GPS developer to attach to the 3D app as it is being launched (immediately after MicroDLL is injected)
     bool OptionNoLogfile;               ///< Disables generation of a log file
     bool OptionRealPause;               ///< Forces RealPause on in the TimeControlLayer
@@ -69,6 +73,9 @@ struct PsSharedGlobal
     bool OptionFlattenCommandLists;     ///< Duplicate of client setting for autocapture
     bool OptionLiquidVR;                ///< Enable when launching a LiquidVR application with PerfStudio. This delays the interception of the Device and DeviceContext until after LVR has wrapped them.
     bool OptionCollectFrameStats;       ///< Enable the collection of frame statistics with a keypress.
+    bool OptionMergeAPITrace;           ///< DX12 Only: Interleave the API Trace calls from all threads by start time, instead of one block per thread.
+    bool OptionAPITraceWorkerThread;    ///< DX12 Only: Build the API Trace response on a worker thread while the GPU Trace is collected.
+    bool OptionBinaryTraceFile;         ///< DX12 Only: Save linked traces in the indexed binary container instead of as text.
 #ifdef _WIN32
     bool SteamInjected;                 ///< Was Steam used to launch the application, and was it injected with MicroDLL
 #endif
@@ -76,10 +83,13 @@ struct PsSharedGlobal
     bool OptionManualDllReplacement;    ///< Use manual DLL replacement; hooking and micro dll not used
     uint32 OptionMdoMode;               ///< How MDO is being used
     uint8 BuildFlags;                   ///< Build flags (internal, 32 or 64 bit etc)
+    uint32 Generation;                  ///< Incremented before and after every write, so it's odd while a write is in progress. Only accessed through SharedGlobal.
 };
 
 /// Manages a shared memory that used by both the main server and the 3D application processes. Provides
 /// accessors to the data members which also handle locking and unlocking of the shared memory.
+/// Values are read from a per-process snapshot of the shared memory instead, so that reads don't need to
+/// lock. The snapshot is only copied again once the shared generation shows that a value has been written.
 class SharedGlobal
 {
 public:
@@ -108,14 +118,32 @@ public:
         PsAssert(m_MapFile != NULL);
         PsAssert(m_MapFile->Get() != NULL);
 
-        if (Lock())
+        uint32 sharedGeneration = GetSharedGeneration().load(std::memory_order_acquire);
+
+        // Retake the snapshot if a value has been written since it was copied. If a refresh already gave up
+        // waiting for the write that's in progress, keep reading the previous snapshot instead of waiting again.
+        if ((((sharedGeneration & 1) != 0) || (m_SnapshotGeneration.load(std::memory_order_relaxed) != sharedGeneration)) &&
+            (m_StalledGeneration.load(std::memory_order_relaxed) != sharedGeneration))
         {
-            T val = *(T*) & ((char*)m_MapFile->Get())[offset];
-            Unlock();
-            return (val);
+            RefreshSnapshot();
         }
 
-        return (0);
+        // The snapshot is always consistent, so only a copy that's in progress in this process needs to be waited for.
+        for (;;)
+        {
+            uint32 sequenceBefore = m_SnapshotSequence.load(std::memory_order_acquire);
+
+            if ((sequenceBefore & 1) == 0)
+            {
+                T val = *(T*) & ((char*)&m_Snapshot)[offset];
+                std::atomic_thread_fence(std::memory_order_acquire);
+
+                if (m_SnapshotSequence.load(std::memory_order_relaxed) == sequenceBefore)
+                {
+                    return (val);
+                }
+            }
+        }
     }
 
     //-----------------------------------------------------------------------------
@@ -135,9 +163,14 @@ public:
 
         if (Lock())
         {
+            BeginWrite();
             *(T*)&((char*)m_MapFile->Get())[offset] = value;
+            EndWrite();
 
             Unlock();
+
+            // Pick up the new value straight away, so that values cached from the snapshot are current.
+            RefreshSnapshot();
             return (true);
         }
 
@@ -146,6 +179,32 @@ public:
 
 private:
 
+    /// Retrieve the write generation stored in the shared memory
+    /// \return the shared generation counter
+    std::atomic<uint32>& GetSharedGeneration(void)
+    {
+        static_assert(sizeof(std::atomic<uint32>) == sizeof(uint32), "The shared generation must have the same layout as a uint32");
+        return *(std::atomic<uint32>*) & ((char*)m_MapFile->Get())[offsetof(struct PsSharedGlobal, Generation)];
+    }
+
+    /// Mark the start of a write to the shared memory, so readers in every process retake their snapshot.
+    /// Must be called with exclusive access granted.
+    void BeginWrite(void)
+    {
+        GetSharedGeneration().fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    /// Mark the end of a write to the shared memory. Must be called with exclusive access granted.
+    void EndWrite(void)
+    {
+        GetSharedGeneration().fetch_add(1, std::memory_order_release);
+    }
+
+    /// Copy the shared memory into this process' snapshot, unless the snapshot is already up to date.
+    /// Gives up after a bounded number of attempts, and leaves the previous snapshot in place.
+    void RefreshSnapshot(void);
+
     /// request exclusive access to global memory region
     /// \return true on success; false on failure
     bool Lock(void);
@@ -171,6 +230,13 @@ private:
     ///< this should only be accessed after exclusive access granted.
     struct PsSharedGlobal m_Shadow;     ///< Shadow copy of global memory (not all fields updated - check
     ///< implementation of each accessor function)
+
+    struct PsSharedGlobal m_Snapshot;   ///< Per-process copy of the whole global memory, read by GetValue without locking.
+    std::atomic<uint32> m_SnapshotSequence;   ///< Incremented before and after m_Snapshot is copied. Odd while a copy is in progress.
+    std::atomic<uint32> m_SnapshotGeneration; ///< The shared generation that m_Snapshot was copied from.
+    struct PsSharedGlobal m_RefreshBlock;     ///< Scratch copy of the global memory, checked for overlapping writes before it's published.
+    std::atomic<uint32> m_StalledGeneration;  ///< An odd shared generation that a refresh gave up waiting on, or 0.
+    osMutex m_SnapshotMutex;            ///< Serializes threads in this process that refresh m_Snapshot.
 };
 
 #endif // GPS_SHAREDGLOBAL_H
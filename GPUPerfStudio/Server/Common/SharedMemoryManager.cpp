@@ -34,6 +34,13 @@
 ///    ( must be <= the first DWORD, and is always smaller than the size of the shared memory)
 #define BUFFER_HEADER_SIZE (DWORD_SIZE * 2)
 
+/// in a lock-free ring, chunks are padded to a whole number of DWORDs, so that every buffer header is aligned
+#define ALIGN_TO_DWORD( bytes ) (((bytes) + DWORD_SIZE - 1) & ~(DWORD_SIZE - 1))
+
+/// written in place of a buffer's total size in a lock-free ring to tell the
+/// reader that the writer has wrapped around to the start of the pool
+#define SM_WRAP_MARKER 0xFFFFFFFF
+
 static std::map< gtASCIIString, SharedMemoryManager* >* g_sharedMemoryMap = NULL;
 
 // Named mutex for shared memory map; one per process
@@ -42,6 +49,28 @@ static NamedMutex*  g_MapMutex = NULL;
 // define this value to the name of the shared memory that you want to debug
 //#define DEBUG_SHARED_MEM "PLUGINS_TO_GPS"
 
+//-----------------------------------------------------------------------------
+/// Only available internal to this file; builds the name of the underlying
+/// shared memory. A lock-free ring's name includes the ring version, so that
+/// neither the web server nor a process built with a different version can
+/// open it; otherwise the name is used as it is.
+///
+/// \param strName name of the shared memory
+/// \param bLockFreeRing true if the shared memory is a lock-free ring
+/// \param strMapFileName receives the name of the underlying shared memory
+//-----------------------------------------------------------------------------
+static void GetMapFileName(const char* strName, bool bLockFreeRing, char (&strMapFileName)[ PS_MAX_PATH ])
+{
+    if (bLockFreeRing)
+    {
+        sprintf_s(strMapFileName, PS_MAX_PATH, "%s_ring_v%u", strName, s_SMRingVersion);
+    }
+    else
+    {
+        sprintf_s(strMapFileName, PS_MAX_PATH, "%s", strName);
+    }
+}
+
 //-----------------------------------------------------------------------------
 /// Only available internal to this file; used to create a mutex to ensure that
 /// the shared memory map is not accessed by two threads at the same time. This
@@ -176,10 +205,11 @@ bool smExists(const char* strName)
 /// \param strName name of the shared memory to create
 /// \param dwMaxNumElements max number of elements that can fit in the memory
 /// \param dwElementSize size of a single element in bytes
+/// \param bLockFreeRing true to use the lock-free ring layout
 ///
 /// \return true if the shared memory could be created or opened; false otherwise
 //=============================================================================
-bool smCreate(const char* strName, unsigned long dwMaxNumElements, unsigned long dwElementSize)
+bool smCreate(const char* strName, unsigned long dwMaxNumElements, unsigned long dwElementSize, bool bLockFreeRing)
 {
     PsAssert(strName != NULL);
     PsAssert(dwMaxNumElements > 0);
@@ -222,7 +252,7 @@ bool smCreate(const char* strName, unsigned long dwMaxNumElements, unsigned long
     }
 
     // try to create the memory
-    if (pSM->Create(strName, dwMaxNumElements, dwElementSize) == false)
+    if (pSM->Create(strName, dwMaxNumElements, dwElementSize, bLockFreeRing) == false)
     {
         // could not create it
         Log(logERROR, "smCreate( %s, %lu, %lu ) failed because of error: %d\n", strName, dwMaxNumElements, dwElementSize, osGetLastSystemError());
@@ -242,10 +272,11 @@ bool smCreate(const char* strName, unsigned long dwMaxNumElements, unsigned long
 /// Opens the named shared memory
 ///
 /// \param strName name of the shared memory to open
+/// \param bLockFreeRing true if the memory was created as a lock-free ring
 ///
 /// \return true if the shared memory could be opened; false otherwise
 //=============================================================================
-bool smOpen(const char* strName)
+bool smOpen(const char* strName, bool bLockFreeRing)
 {
     PsAssert(strName != NULL);
 
@@ -280,7 +311,7 @@ bool smOpen(const char* strName)
     }
 
     // try to open the memory
-    if (pSM->Open(strName) == false)
+    if (pSM->Open(strName, bLockFreeRing) == false)
     {
         // could not open it
         Log(logERROR, "smOpen failed because \"%s\" is not the name of created shared memory.\n", strName);
@@ -382,6 +413,77 @@ bool smPut(const char* strName, void* in, unsigned long dwNumBytes)
     return pSM->Put(in, dwNumBytes);
 }
 
+//=============================================================================
+/// Puts a buffer made of several pieces into the shared memory for access in
+/// a FIFO manner, without putting the pieces together first
+///
+/// \param strName name of the shared memory to put data in
+/// \param pSegments the pieces of the buffer, in order
+/// \param uNumSegments the number of pieces
+///
+/// \return true if the data could be put in the shared memory; false otherwise
+//=============================================================================
+bool smPutSegments(const char* strName, const SMSegment* pSegments, unsigned int uNumSegments)
+{
+    PsAssert(strName != NULL);
+    SharedMemoryManager* pSM = GetSM(strName);
+
+    if (pSM == NULL)
+    {
+        Log(logERROR, "%s failed because '%s' is not the name of an opened shared memory.\n", __FUNCTION__, strName);
+        return false;
+    }
+
+    return pSM->PutSegments(pSegments, uNumSegments);
+}
+
+//=============================================================================
+/// Reserves a contiguous region in the named shared memory that a buffer can
+/// be serialized into directly. Must be followed by smCommitPut.
+///
+/// \param strName name of the shared memory to reserve space in
+/// \param dwNumBytes the largest number of bytes that will be written
+///
+/// \return pointer to the reserved region; NULL if no contiguous region is
+///   currently available, in which case smPut should be used instead
+//=============================================================================
+void* smReservePut(const char* strName, unsigned long dwNumBytes)
+{
+    PsAssert(strName != NULL);
+    SharedMemoryManager* pSM = GetSM(strName);
+
+    if (pSM == NULL)
+    {
+        Log(logERROR, "%s failed because '%s' is not the name of an opened shared memory.\n", __FUNCTION__, strName);
+        return NULL;
+    }
+
+    return pSM->ReservePut(dwNumBytes);
+}
+
+//=============================================================================
+/// Makes a buffer written into the region returned by smReservePut available
+/// for access in a FIFO manner
+///
+/// \param strName name of the shared memory that the region was reserved in
+/// \param dwNumBytes number of bytes that were written into the region
+///
+/// \return true if the buffer was committed; false otherwise
+//=============================================================================
+bool smCommitPut(const char* strName, unsigned long dwNumBytes)
+{
+    PsAssert(strName != NULL);
+    SharedMemoryManager* pSM = GetSM(strName);
+
+    if (pSM == NULL)
+    {
+        Log(logERROR, "%s failed because '%s' is not the name of an opened shared memory.\n", __FUNCTION__, strName);
+        return false;
+    }
+
+    return pSM->CommitPut(dwNumBytes);
+}
+
 //=============================================================================
 /// Copies the next buffer in the named shared memory to the specified location.
 /// If either of the last two parameters are NULL (or 0), this function will
@@ -539,6 +641,28 @@ void smUnlockGet(const char* strName)
 }
 
 
+//-----------------------------------------------------------------------------
+/// Only available internal to this file; checks that a shared memory that is
+/// opened as a lock-free ring was created as one, by a process with the same
+/// ring version.
+///
+/// \param pMemory the start of the shared memory
+/// \param strName name of the shared memory
+///
+/// \return true if the memory has a matching ring header; false otherwise
+//-----------------------------------------------------------------------------
+static bool CheckRingHeader(const void* pMemory, const char* strName)
+{
+    const SMRingHeader* pRingHeader = (const SMRingHeader*) pMemory;
+
+    if (pRingHeader->dwMagic != s_SMRingMagic || pRingHeader->dwVersion != s_SMRingVersion)
+    {
+        Log(logERROR, "Shared memory %s was not created as a lock-free ring with version %u.\n", strName, s_SMRingVersion);
+        return false;
+    }
+
+    return true;
+}
 
 //=============================================================================
 ///
@@ -552,7 +676,11 @@ void smUnlockGet(const char* strName)
 //=============================================================================
 SharedMemoryManager::SharedMemoryManager()
     : m_pHeader(NULL),
-      m_pPool(NULL)
+      m_pRingHeader(NULL),
+      m_bLockFreeRing(false),
+      m_pPool(NULL),
+      m_pReservedLocation(NULL),
+      m_dwReservedSize(0)
 {
     memset(m_strName, 0, PS_MAX_PATH);
     m_pMapFile = new SharedMemory();
@@ -584,12 +712,14 @@ SharedMemoryManager::~SharedMemoryManager()
 ///   the shared memory (ignored if shared memory already exists)
 /// \param dwElementSize size in bytes of a single element (ignored if shared
 ///   memory already exists)
+/// \param bLockFreeRing true to use the lock-free ring layout
 ///
 /// \return true if memory could be created or opened; false otherwise
 //--------------------------------------------------------------------------
-bool SharedMemoryManager::Create(const char* strName, unsigned long dwMaxNumElements, unsigned long dwElementSize)
+bool SharedMemoryManager::Create(const char* strName, unsigned long dwMaxNumElements, unsigned long dwElementSize, bool bLockFreeRing)
 {
     sprintf_s(m_strName, PS_MAX_PATH, "%s", strName);
+    m_bLockFreeRing = bLockFreeRing;
 
     // Several things are needed to support the shared memory
     // 1) Read Mutex
@@ -609,7 +739,7 @@ bool SharedMemoryManager::Create(const char* strName, unsigned long dwMaxNumElem
     //    Without a "View of the Mapped File", it is useless
     // 6) View of the Mapped File
     //    This gives our process a pointer to the File Mapping so that we can put data in it
-    //    Note: We place a header (m_pHeader) at the start of this view to keep track of read/write offsets and the current size
+    //    Note: We place a header (m_pHeader) at the start of this view to keep track of read/write offsets
     //          In order for this to work properly across processes, offsets from the start of the view are used in the header
     //          instead of pointers. Since each process has it's own view of the memory, the addresses for one process are
     //          different from addresses in the other process, so pointers are invalid. Instead, the pointers / addresses are
@@ -687,13 +817,14 @@ bool SharedMemoryManager::Create(const char* strName, unsigned long dwMaxNumElem
     }
 
     // create File Mapping
-    gtUInt32 dwTotalSize = sizeof(SMHeader) +
+    gtUInt32 dwTotalSize = (m_bLockFreeRing ? sizeof(SMRingHeader) : sizeof(SMHeader)) +
                            (dwMaxNumElements * dwElementSize) +
                            (dwMaxNumElements * BUFFER_HEADER_SIZE);
 
     //   Log(logMESSAGE, "Calling SharedMemory::Create '%s', %d\n", m_strName, dwTotalSize);
 
-    SharedMemory::MemStatus  status = m_pMapFile->OpenOrCreate(dwTotalSize, m_strName);
+    GetMapFileName(m_strName, m_bLockFreeRing, strTmp);
+    SharedMemory::MemStatus  status = m_pMapFile->OpenOrCreate(dwTotalSize, strTmp);
 
     if (SharedMemory::ERROR_CREATE == status)
     {
@@ -731,21 +862,49 @@ bool SharedMemoryManager::Create(const char* strName, unsigned long dwMaxNumElem
     {
         //      Log(logMESSAGE, "InitMem called\n");
 
-        // write header at top of shared memory
-        SMHeader smHeader;
-        smHeader.dwCurrSize = 0;
-        smHeader.dwStart = sizeof(SMHeader);   // beginning is offset by the header size
-        smHeader.dwEnd = dwTotalSize;
-        smHeader.dwReadOffset = 0;
-        smHeader.dwWriteOffset = 0;
-
-        memcpy_s(pMemory, dwTotalSize, &smHeader, sizeof(SMHeader));
+        if (m_bLockFreeRing)
+        {
+            // write header at top of shared memory; the offsets are set by Reset below
+            SMRingHeader* pRingHeader = (SMRingHeader*) pMemory;
+            pRingHeader->dwMagic = s_SMRingMagic;
+            pRingHeader->dwVersion = s_SMRingVersion;
+            pRingHeader->dwStart = sizeof(SMRingHeader);   // beginning is offset by the header size
+            pRingHeader->dwEnd = dwTotalSize;
+        }
+        else
+        {
+            // write header at top of shared memory
+            SMHeader smHeader;
+            smHeader.dwCurrSize = 0;
+            smHeader.dwStart = sizeof(SMHeader);   // beginning is offset by the header size
+            smHeader.dwEnd = dwTotalSize;
+            smHeader.dwReadOffset = 0;
+            smHeader.dwWriteOffset = 0;
+
+            memcpy_s(pMemory, dwTotalSize, &smHeader, sizeof(SMHeader));
+        }
+    }
+    else if (m_bLockFreeRing && CheckRingHeader(pMemory, m_strName) == false)
+    {
+        m_pSMMutex->Unlock();
+        m_pReadMutex->Unlock();
+        m_pWriteMutex->Unlock();
+        Close();
+        return false;
     }
 
     // make header point to start of shared memory
-    m_pHeader = (SMHeader*) pMemory;
-    PsAssert(m_pHeader != NULL);
-    m_pPool = (char*) pMemory + m_pHeader->dwStart;
+    if (m_bLockFreeRing)
+    {
+        m_pRingHeader = (SMRingHeader*) pMemory;
+        m_pPool = (char*) pMemory + m_pRingHeader->dwStart;
+    }
+    else
+    {
+        m_pHeader = (SMHeader*) pMemory;
+        m_pPool = (char*) pMemory + m_pHeader->dwStart;
+    }
+
     PsAssert(m_pPool != NULL);
 
     // clear the shared memory
@@ -755,8 +914,8 @@ bool SharedMemoryManager::Create(const char* strName, unsigned long dwMaxNumElem
 
     if (strcmp(m_strName, DEBUG_SHARED_MEM) == 0)
     {
-        Log(logMESSAGE, "--------> SM max size     is %lu (Create)\n", m_pHeader->dwEnd - m_pHeader->dwStart);
-        Log(logMESSAGE, "--------> SM current size is %lu (Create)\n", m_pHeader->dwCurrSize);
+        Log(logMESSAGE, "--------> SM max size     is %lu (Create)\n", GetPoolSize());
+        Log(logMESSAGE, "--------> SM current size is %lu (Create)\n", GetSize());
     }
 
 #endif
@@ -780,11 +939,21 @@ void SharedMemoryManager::Reset()
         Log(logERROR, "Error occurred while waiting :%d\n", osGetLastSystemError());
     }
 
-    m_pHeader->dwCurrSize = 0;
-    m_pHeader->dwReadOffset = 0;
-    m_pHeader->dwWriteOffset = 0;
+    if (m_bLockFreeRing)
+    {
+        m_pRingHeader->dwReadOffset.store(0, std::memory_order_relaxed);
+        m_pRingHeader->dwWriteOffset.store(0, std::memory_order_relaxed);
+
+        memset(m_pPool, '\0', m_pRingHeader->dwEnd - m_pRingHeader->dwStart);
+    }
+    else
+    {
+        m_pHeader->dwCurrSize = 0;
+        m_pHeader->dwReadOffset = 0;
+        m_pHeader->dwWriteOffset = 0;
 
-    memset(m_pPool, '\0', m_pHeader->dwEnd - m_pHeader->dwStart);
+        memset(m_pPool, '\0', m_pHeader->dwEnd - m_pHeader->dwStart);
+    }
 
     m_pSMMutex->Unlock();
 }
@@ -793,12 +962,14 @@ void SharedMemoryManager::Reset()
 /// tries to open an existing shared memory
 ///
 /// \param strName name of the shared memory to open
+/// \param bLockFreeRing true if the memory was created as a lock-free ring
 ///
 /// \return true if the shared memory could be opened; false otherwise
 //--------------------------------------------------------------------------
-bool SharedMemoryManager::Open(const char* strName)
+bool SharedMemoryManager::Open(const char* strName, bool bLockFreeRing)
 {
     sprintf_s(m_strName, PS_MAX_PATH, "%s", strName);
+    m_bLockFreeRing = bLockFreeRing;
 
     char strTmp[ PS_MAX_PATH ];
 
@@ -896,7 +1067,8 @@ bool SharedMemoryManager::Open(const char* strName)
     //   Log(logMESSAGE, "Calling SharedMemory::Open '%s'\n", m_strName);
 
     // open shared mem
-    SharedMemory::MemStatus  status = m_pMapFile->Open(m_strName);
+    GetMapFileName(m_strName, m_bLockFreeRing, strTmp);
+    SharedMemory::MemStatus  status = m_pMapFile->Open(strTmp);
 
     if (SharedMemory::ERROR_OPEN == status)
     {
@@ -920,10 +1092,28 @@ bool SharedMemoryManager::Open(const char* strName)
 
     void* pMemory = m_pMapFile->Get();
 
+    // a ring's name already includes its version, but check the header too in case the memory was created by a mismatched build
+    if (m_bLockFreeRing && CheckRingHeader(pMemory, m_strName) == false)
+    {
+        m_pSMMutex->Unlock();
+        m_pReadMutex->Unlock();
+        m_pWriteMutex->Unlock();
+        Close();
+        return false;
+    }
+
     // make header point to start of shared memory
-    m_pHeader = (SMHeader*) pMemory;
-    PsAssert(m_pHeader != NULL);
-    m_pPool = (char*) pMemory + m_pHeader->dwStart;
+    if (m_bLockFreeRing)
+    {
+        m_pRingHeader = (SMRingHeader*) pMemory;
+        m_pPool = (char*) pMemory + m_pRingHeader->dwStart;
+    }
+    else
+    {
+        m_pHeader = (SMHeader*) pMemory;
+        m_pPool = (char*) pMemory + m_pHeader->dwStart;
+    }
+
     PsAssert(m_pPool != NULL);
 
     //   Log(logMESSAGE, "Opened Shared Memory - %s\n", m_strName);
@@ -948,6 +1138,7 @@ void SharedMemoryManager::Close()
     m_pMapFile->Close();
     m_pPool = NULL;
     m_pHeader = NULL;
+    m_pRingHeader = NULL;
 }
 
 //--------------------------------------------------------------------------
@@ -960,6 +1151,34 @@ void SharedMemoryManager::Close()
 //--------------------------------------------------------------------------
 bool SharedMemoryManager::Put(void* pIn, unsigned long dwNumBytes)
 {
+    SMSegment segment = { pIn, dwNumBytes };
+    return PutSegments(&segment, 1);
+}
+
+//--------------------------------------------------------------------------
+/// Puts a buffer made of several pieces in the shared memory queue. The
+/// pieces are copied straight into the chunks of the buffer, as the reader
+/// frees up space, so they don't need to be put together first.
+///
+/// \param pSegments the pieces of the buffer, in order
+/// \param uNumSegments the number of pieces
+///
+/// \return true if data could be added; false otherwise
+//--------------------------------------------------------------------------
+bool SharedMemoryManager::PutSegments(const SMSegment* pSegments, unsigned int uNumSegments)
+{
+    gtUInt32 dwNumBytes = 0;
+
+    for (unsigned int i = 0; i < uNumSegments; i++)
+    {
+        if (pSegments[i].pData == NULL && pSegments[i].dwNumBytes > 0)
+        {
+            return false;
+        }
+
+        dwNumBytes += (gtUInt32)pSegments[i].dwNumBytes;
+    }
+
 #ifdef DEBUG_SHARED_MEM
 
     if (strcmp(m_strName, DEBUG_SHARED_MEM) == 0)
@@ -969,39 +1188,27 @@ bool SharedMemoryManager::Put(void* pIn, unsigned long dwNumBytes)
 
 #endif //DEBUG_SHARED_MEM
 
-    if (pIn == NULL || dwNumBytes == 0)
+    if (dwNumBytes == 0)
     {
         return false;
     }
 
     void* pPtr = NULL;      //<-- points to location in shared memory that we are writing to
-    void* pOrig = pIn;      //<-- increments along input buffer as chunks are written into SM
     unsigned long dwChunkSize = 0;
 
-    unsigned long dwBytesWritten = 0;
+    unsigned int uSegment = 0;          //<-- the piece that is being copied into SM
+    unsigned long dwSegmentOffset = 0;  //<-- the number of bytes of that piece already copied
+
+    gtUInt32 dwBytesWritten = 0;
 
     while (dwBytesWritten < dwNumBytes)
     {
-        // Make sure we are allowed to write
-        if (false == m_pChunkRead->Wait())
-        {
-            Log(logERROR, "Error occurred while waiting for chunk written. Error %lu\n", osGetLastSystemError());
-            return false;
-        }
-
-        if (false == m_pSMMutex->Lock())
+        // wait until there is room for at least part of the remaining data
+        if (WaitForPutLocation(dwNumBytes - dwBytesWritten, false, pPtr, dwChunkSize) == false)
         {
-            Log(logERROR, "Error occurred while waiting for sm mutex. Error %lu\n", osGetLastSystemError());
             return false;
         }
 
-        if (FindPutLocation(dwNumBytes - dwBytesWritten, pPtr, dwChunkSize) == false)
-        {
-            // this just continues, because it should be able to find a put location after more data has been read
-            m_pSMMutex->Unlock();
-            continue;
-        }
-
 #ifdef DEBUG_SHARED_MEM
 
         if (strcmp(m_strName, DEBUG_SHARED_MEM) == 0)
@@ -1010,59 +1217,155 @@ bool SharedMemoryManager::Put(void* pIn, unsigned long dwNumBytes)
         }
 
 #endif //DEBUG_SHARED_MEM
+        void* pHeader = pPtr;
+        gtUInt32 dwStoredChunkSize = (gtUInt32)dwChunkSize;
+
         // write total buffer size
         memcpy_s(pPtr, DWORD_SIZE, &dwNumBytes, DWORD_SIZE);
         MOVEPTR(pPtr, DWORD_SIZE);
 
         // write chunk size
-        memcpy_s(pPtr, DWORD_SIZE, &dwChunkSize, DWORD_SIZE);
+        memcpy_s(pPtr, DWORD_SIZE, &dwStoredChunkSize, DWORD_SIZE);
         MOVEPTR(pPtr, DWORD_SIZE);
 
-        // copy chunk of original input data into SM
-        memcpy_s(pPtr, dwChunkSize, pOrig, dwChunkSize);
-        MOVEPTR(pOrig, dwChunkSize);
+        // copy the next dwChunkSize bytes of the pieces into SM; a chunk may end partway through a piece
+        unsigned long dwChunkRemaining = dwChunkSize;
+
+        while (dwChunkRemaining > 0)
+        {
+            unsigned long dwCopySize = std::min(pSegments[uSegment].dwNumBytes - dwSegmentOffset, dwChunkRemaining);
+
+            memcpy_s(pPtr, dwCopySize, (const char*)pSegments[uSegment].pData + dwSegmentOffset, dwCopySize);
+            MOVEPTR(pPtr, dwCopySize);
+
+            dwSegmentOffset += dwCopySize;
+            dwChunkRemaining -= dwCopySize;
+
+            if (dwSegmentOffset == pSegments[uSegment].dwNumBytes)
+            {
+                uSegment++;
+                dwSegmentOffset = 0;
+            }
+        }
 
         // increment the number of written bytes by the size of the chunk we just wrote
-        dwBytesWritten += dwChunkSize;
+        dwBytesWritten += dwStoredChunkSize;
+
+        PublishPut(pHeader, dwChunkSize, dwNumBytes - dwBytesWritten);
+    }
+
+    return true;
+}
 
-        if (false == m_pChunkWritten->Signal())
+//--------------------------------------------------------------------------
+/// Reserves a contiguous region in the shared memory queue, so that a
+/// buffer can be serialized directly into the shared memory rather than
+/// built elsewhere and copied in. The region is only visible to the reader
+/// once CommitPut is called, and the shared memory stays locked until then.
+/// A lock-free ring waits for the reader to free up enough space instead.
+///
+/// \param dwNumBytes the largest number of bytes that will be written
+///
+/// \return pointer to the reserved region; NULL if there is currently no
+///   contiguous region large enough (or, for a lock-free ring, if the buffer
+///   could never fit in one), in which case Put should be used instead
+//--------------------------------------------------------------------------
+void* SharedMemoryManager::ReservePut(unsigned long dwNumBytes)
+{
+    if (dwNumBytes == 0)
+    {
+        return NULL;
+    }
+
+    if (m_pReservedLocation != NULL)
+    {
+        Log(logERROR, "ReservePut called on shared memory %s before the previous reservation was committed.\n", m_strName);
+        return NULL;
+    }
+
+    void* pPtr = NULL;
+    unsigned long dwChunkSize = 0;
+
+    if (m_bLockFreeRing)
+    {
+        // the write offset has to stay behind the read offset, so one DWORD of the pool is never used
+        if (dwNumBytes > GetPoolSize() - BUFFER_HEADER_SIZE - DWORD_SIZE)
         {
-            // return true since we were able to put the data in, we just weren't able to signal it to be read
-            Log(logERROR, "SetEvent on chunk_written failed. Error %lu\n", osGetLastSystemError());
+            return NULL;
         }
 
-        // if there is still data to write, reset the chunkRead event so that reading the data can happen
-        // note we could also make sure that there isn't enough room for the rest of the data, this would allow us to
-        // 'wrap around' if needed and continue writing
-        if (m_pHeader->dwEnd - m_pHeader->dwStart - m_pHeader->dwCurrSize < dwNumBytes - dwBytesWritten + BUFFER_HEADER_SIZE)   //dwBytesWritten < dwNumBytes )
+        if (WaitForPutLocation(dwNumBytes, true, pPtr, dwChunkSize) == false)
         {
-            m_pChunkRead->Reset();
+            return NULL;
         }
-
-        // do some housekeeping on the header values
-        m_pHeader->dwCurrSize += (dwChunkSize + BUFFER_HEADER_SIZE);
-        m_pHeader->dwWriteOffset += (dwChunkSize + BUFFER_HEADER_SIZE);
-
-        if (m_pHeader->dwWriteOffset >= m_pHeader->dwEnd - m_pHeader->dwStart)
+    }
+    else
+    {
+        // Unlike Put, don't wait for the reader here. If there isn't room for the
+        // whole buffer in one chunk, the caller falls back to Put, which will wait.
+        if (false == m_pSMMutex->Lock())
         {
-            m_pHeader->dwWriteOffset = 0;
+            Log(logERROR, "Error occurred while waiting for sm mutex. Error %lu\n", osGetLastSystemError());
+            return NULL;
         }
 
-#ifdef DEBUG_SHARED_MEM
-
-        if (strcmp(m_strName, DEBUG_SHARED_MEM) == 0)
+        if (FindPutLocation(dwNumBytes, pPtr, dwChunkSize) == false || dwChunkSize < dwNumBytes)
         {
-            Log(logMESSAGE, "put-----> SM current size is %lu \t(+%lu)\n", m_pHeader->dwCurrSize, dwChunkSize + BUFFER_HEADER_SIZE);
-            Log(logMESSAGE, "put-----> SM read offset  is %lu \n", m_pHeader->dwReadOffset);
-            Log(logMESSAGE, "put-----> SM write offset is %lu \n", m_pHeader->dwWriteOffset);
+            m_pSMMutex->Unlock();
+            return NULL;
         }
+    }
 
-#endif
+    // the buffer header is written by CommitPut, once the actual size is known
+    m_pReservedLocation = (char*)pPtr;
+    m_dwReservedSize = dwNumBytes;
 
-        m_pSMMutex->Unlock();
+    return m_pReservedLocation + BUFFER_HEADER_SIZE;
+}
+
+//--------------------------------------------------------------------------
+/// Makes the buffer written into the region returned by ReservePut
+/// available to the reader, and unlocks the shared memory.
+///
+/// \param dwNumBytes number of bytes that were actually written; must not
+///   be more than the number of bytes that were reserved
+///
+/// \return true if the buffer was committed; false otherwise
+//--------------------------------------------------------------------------
+bool SharedMemoryManager::CommitPut(unsigned long dwNumBytes)
+{
+    if (m_pReservedLocation == NULL)
+    {
+        Log(logERROR, "CommitPut called on shared memory %s without a reservation.\n", m_strName);
+        return false;
     }
 
-    return true;
+    PsAssert(dwNumBytes <= m_dwReservedSize);
+
+    bool bCommitted = (dwNumBytes > 0 && dwNumBytes <= m_dwReservedSize);
+
+    if (bCommitted)
+    {
+        // the whole buffer is a single chunk, so the total size and chunk size are the same
+        memcpy_s(m_pReservedLocation, DWORD_SIZE, &dwNumBytes, DWORD_SIZE);
+        memcpy_s(m_pReservedLocation + DWORD_SIZE, DWORD_SIZE, &dwNumBytes, DWORD_SIZE);
+
+        PublishPut(m_pReservedLocation, dwNumBytes, 0);
+    }
+    else
+    {
+        Log(logERROR, "Unable to commit %lu bytes to shared memory %s; only %lu bytes were reserved.\n", dwNumBytes, m_strName, m_dwReservedSize);
+
+        if (m_bLockFreeRing == false)
+        {
+            m_pSMMutex->Unlock();
+        }
+    }
+
+    m_pReservedLocation = NULL;
+    m_dwReservedSize = 0;
+
+    return bCommitted;
 }
 
 //--------------------------------------------------------------------------
@@ -1095,27 +1398,10 @@ gtUInt32 SharedMemoryManager::Get(void* pOut, unsigned long dwBufferSize)
     while (dwBytesRead < dwExpectedTotalSize || bFirstPass)
     {
         // wait for a chunk to be written
-        if (false == m_pChunkWritten->Wait())
-        {
-            Log(logERROR, "Error occurred while waiting for chunk written:%d\n", osGetLastSystemError());
-            return dwBytesRead;
-        }
-
-        if (false == m_pSMMutex->Lock())
-        {
-            Log(logERROR, "Error occurred while waiting for sm mutex. Error %lu\n", osGetLastSystemError());
-            m_pChunkWritten->Reset();
-            return dwBytesRead;
-        }
-
-        char* ptr = (char*) FindGetLocation();
+        char* ptr = (char*) WaitForGetLocation();
 
         if (ptr == NULL)
         {
-            // since chunkWritten was signaled, there should definitely be data to get
-            Log(logERROR, "Unable to find get location. Error %lu\n", osGetLastSystemError());
-            m_pChunkWritten->Reset();
-            m_pSMMutex->Unlock();
             return dwBytesRead;
         }
 
@@ -1128,8 +1414,7 @@ gtUInt32 SharedMemoryManager::Get(void* pOut, unsigned long dwBufferSize)
             if (dwExpectedTotalSize > dwBufferSize)
             {
                 Log(logERROR, "First pass: buffer (%lu bytes) not large enough to hold next message (%lu bytes).\n", dwBufferSize, dwExpectedTotalSize);
-                m_pChunkWritten->Reset();
-                m_pSMMutex->Unlock();
+                ReleaseGetLocation();
                 return 0;
             }
 
@@ -1145,8 +1430,7 @@ gtUInt32 SharedMemoryManager::Get(void* pOut, unsigned long dwBufferSize)
         {
             // log the error and break, so that the already read data is returned and we don't interfere with the next response
             Log(logERROR, "Response reading for buffer of size %lu started reading for another buffer of size %lu\n", dwExpectedTotalSize, dwTotalBufferSize);
-            m_pChunkWritten->Reset();
-            m_pSMMutex->Unlock();
+            ReleaseGetLocation();
             break;
         }
 
@@ -1157,6 +1441,7 @@ gtUInt32 SharedMemoryManager::Get(void* pOut, unsigned long dwBufferSize)
         // read the size of the next chunk and add it to the number of bytes read
         // this better be less then the total size of the buffer
         gtUInt32 dwChunkSize = ((gtUInt32*) ptr)[ 0 ];
+        gtUInt32 dwStoredChunkSize = dwChunkSize;
 
         // NOTE: if this happens, it is a very bad situation, means something else is wrong in the system
         // the steps here are to try to correct it.
@@ -1179,61 +1464,12 @@ gtUInt32 SharedMemoryManager::Get(void* pOut, unsigned long dwBufferSize)
         // move the copy pointer down the buffer
         MOVEPTR(pCopy, dwChunkSize);
 
-        // do housekeeping on the header data
-        m_pHeader->dwCurrSize -= (dwChunkSize + BUFFER_HEADER_SIZE);
-        m_pHeader->dwReadOffset += (dwChunkSize + BUFFER_HEADER_SIZE);
+        // free the whole chunk, as it was written, so the writer can reuse the space
+        PublishGet(dwStoredChunkSize);
+    } // end while buffer isn't full
 
-        // check for a wrapped ReadOffset
-        if (m_pHeader->dwReadOffset >= m_pHeader->dwEnd - m_pHeader->dwStart)
-        {
-            m_pHeader->dwReadOffset = 0;
-        }
-
-#ifdef DEBUG_SHARED_MEM
-
-        if (strcmp(m_strName, DEBUG_SHARED_MEM) == 0)
-        {
-            Log(logMESSAGE, "get-----> SM current size is %lu\t(-%lu)\n", m_pHeader->dwCurrSize, (dwChunkSize + BUFFER_HEADER_SIZE));
-            Log(logMESSAGE, "get-----> SM read offset  is %lu\n", m_pHeader->dwReadOffset);
-            Log(logMESSAGE, "get-----> SM write offset is %lu\n", m_pHeader->dwWriteOffset);
-        }
-
-#endif
-
-        if (m_pHeader->dwCurrSize == 0)
-        {
-            // in this case, we could also reset the header information back to the beginning to
-            // reduce the cases where we have to "wrap around"
-            m_pChunkWritten->Reset();
-            //#ifdef DEBUG_SHARED_MEM
-            //if ( strcmp(m_strName, DEBUG_SHARED_MEM) == 0 )
-            //{
-            //   Log( logMESSAGE, "get-----> Reset chunk_written\n" );
-            //}
-            //#endif
-        }
-
-        // set that we've read the chunk, so another can be written if needed
-        if (false == m_pChunkRead->Signal())
-        {
-            // return true since we were able to get the data, we just weren't able to signal more to be written
-            Log(logERROR, "SetEvent on chunk_read failed. Error %lu\n", osGetLastSystemError());
-        }
-
-#ifdef DEBUG_SHARED_MEM
-
-        if (strcmp(m_strName, DEBUG_SHARED_MEM) == 0)
-        {
-            Log(logMESSAGE, "get-----> Set chunk_read\n");
-        }
-
-#endif
-
-        m_pSMMutex->Unlock();
-    } // end while buffer isn't full
-
-    return dwBytesRead;
-}
+    return dwBytesRead;
+}
 
 
 gtUInt32 SharedMemoryManager::Peek(void* pOut, unsigned long dwBufferSize)
@@ -1244,114 +1480,40 @@ gtUInt32 SharedMemoryManager::Peek(void* pOut, unsigned long dwBufferSize)
         return 0;
     }
 
-    void* pCopy = pOut;     //<-- this pointer will increment along the buffer as chunks are copied
-    gtUInt32 dwBytesRead = 0;
+    // wait for a chunk to be written
+    char* ptr = (char*) WaitForGetLocation();
 
-    bool bFirstPass = true;
+    if (ptr == NULL)
+    {
+        return 0;
+    }
 
     // the expected total size is written at the top of each chunk, followed by the size of the chunk.
-    // we'll use the first "total size" value as the expected total size of the entire buffer
-    gtUInt32 dwExpectedTotalSize = 0;
+    gtUInt32 dwExpectedTotalSize = ((gtUInt32*) ptr)[ 0 ];
 
-    if (dwBytesRead < dwExpectedTotalSize || bFirstPass)
+    // if the expected total size is greater than the supplied buffer, log an error and return.
+    // since this means there was a problem with our system, I'm purposefully not filling the buffer with "as much data as we could"
+    if (dwExpectedTotalSize > dwBufferSize)
     {
-        // wait for a chunk to be written
-        if (false == m_pChunkWritten->Wait())
-        {
-            Log(logERROR, "Error occurred while waiting for chunk written:%d\n", osGetLastSystemError());
-            return dwBytesRead;
-        }
-
-        if (false == m_pSMMutex->Lock())
-        {
-            Log(logERROR, "Error occurred while waiting for sm mutex. Error %lu\n", osGetLastSystemError());
-            m_pChunkWritten->Reset();
-            return dwBytesRead;
-        }
-
-        char* ptr = (char*) FindGetLocation();
-
-        if (ptr == NULL)
-        {
-            // since chunkWritten was signaled, there should definitely be data to get
-            Log(logERROR, "Unable to find get location. Error %lu\n", osGetLastSystemError());
-            m_pChunkWritten->Reset();
-            m_pSMMutex->Unlock();
-            return dwBytesRead;
-        }
-
-        if (bFirstPass)
-        {
-            dwExpectedTotalSize = ((gtUInt32*) ptr)[ 0 ];
-
-            // if the expected total size is greater than the supplied buffer, log an error and return.
-            // since this means there was a problem with our system, I'm purposefully not filling the buffer with "as much data as we could"
-            if (dwExpectedTotalSize > dwBufferSize)
-            {
-                Log(logERROR, "First pass: buffer (%lu bytes) not large enough to hold next message (%lu bytes).\n", dwBufferSize, dwExpectedTotalSize);
-                m_pChunkWritten->Reset();
-                m_pSMMutex->Unlock();
-                return 0;
-            }
-
-            bFirstPass = false;
-        }
-
-        // the first value in the total size of the message
-        // this should be the same as when we read it the first time (dwExpectedTotalSize)
-        gtUInt32 dwTotalBufferSize = ((gtUInt32*) ptr)[ 0 ];
-
-        // store the expected total size as a check to make sure we are still reading for the same response
-        if (dwTotalBufferSize != dwExpectedTotalSize)
-        {
-            // log the error and break, so that the already read data is returned and we don't interfere with the next response
-            Log(logERROR, "Response reading for buffer of size %lu started reading for another buffer of size %lu\n", dwExpectedTotalSize, dwTotalBufferSize);
-            m_pChunkWritten->Reset();
-            m_pSMMutex->Unlock();
-            return dwBytesRead;
-        }
-
-        // the buffer size is valid compared to the expected size
-        // so now we can move past that data.
-        MOVEPTR(ptr, DWORD_SIZE);
-
-        // read the size of the next chunk and add it to the number of bytes read
-        // this better be less then the total size of the buffer
-        gtUInt32 dwChunkSize = ((gtUInt32*) ptr)[ 0 ];
-
-        // NOTE: if this happens, it is a very bad situation, means something else is wrong in the system
-        // the steps here are to try to correct it.
-        if (dwBytesRead + dwChunkSize > dwExpectedTotalSize)
-        {
-            Log(logASSERT, "Num bytes read (%lu) > Expected size (%lu)\n", dwBytesRead + dwChunkSize, dwExpectedTotalSize);
-            PsAssert(!(dwBytesRead + dwChunkSize > dwExpectedTotalSize));
-            dwChunkSize = min(dwExpectedTotalSize - dwBytesRead, dwChunkSize);
-        }
+        Log(logERROR, "First pass: buffer (%lu bytes) not large enough to hold next message (%lu bytes).\n", dwBufferSize, dwExpectedTotalSize);
+        ReleaseGetLocation();
+        return 0;
+    }
 
-        // move past the chunk size
-        MOVEPTR(ptr, DWORD_SIZE);
+    // move past the total size
+    MOVEPTR(ptr, DWORD_SIZE);
 
-        // copy the data from the shared memory into the input buffer,
-        // copy into the current location based on chunk sizes
-        memcpy_s(pCopy, dwBufferSize, ptr, dwChunkSize);
+    // only the first chunk is copied, since the data stays in the shared memory
+    gtUInt32 dwChunkSize = min(((gtUInt32*) ptr)[ 0 ], dwExpectedTotalSize);
 
-        dwBytesRead += dwChunkSize;
+    // move past the chunk size
+    MOVEPTR(ptr, DWORD_SIZE);
 
-#ifdef DEBUG_SHARED_MEM
+    memcpy_s(pOut, dwBufferSize, ptr, dwChunkSize);
 
-        if (strcmp(m_strName, DEBUG_SHARED_MEM) == 0)
-        {
-            Log(logMESSAGE, "get-----> SM current size is %lu\t(-%lu)\n", m_pHeader->dwCurrSize, (dwChunkSize + BUFFER_HEADER_SIZE));
-            Log(logMESSAGE, "get-----> SM read offset  is %lu\n", m_pHeader->dwReadOffset);
-            Log(logMESSAGE, "get-----> SM write offset is %lu\n", m_pHeader->dwWriteOffset);
-        }
+    ReleaseGetLocation();
 
-#endif
-
-        m_pSMMutex->Unlock();
-    } // end while buffer isn't full
-
-    return dwBytesRead;
+    return dwChunkSize;
 }
 
 
@@ -1363,6 +1525,20 @@ gtUInt32 SharedMemoryManager::Peek(void* pOut, unsigned long dwBufferSize)
 //--------------------------------------------------------------------------
 gtUInt32 SharedMemoryManager::GetNextBufferSize()
 {
+    if (m_bLockFreeRing)
+    {
+        PsAssert(m_pRingHeader);
+
+        char* ptr = (char*) FindRingGetLocation();
+
+        if (ptr == NULL)
+        {
+            return 0;
+        }
+
+        return ((gtUInt32*) ptr)[ 0 ];
+    }
+
     if (false == m_pSMMutex->Lock())
     {
         Log(logERROR, "Error occurred while waiting for sm mutex. Error %lu\n", osGetLastSystemError());
@@ -1401,8 +1577,23 @@ gtUInt32 SharedMemoryManager::GetNextBufferSize()
 //--------------------------------------------------------------------------
 gtUInt32 SharedMemoryManager::GetSize()
 {
-    PsAssert(m_pHeader);
-    return m_pHeader->dwCurrSize;
+    if (m_bLockFreeRing == false)
+    {
+        PsAssert(m_pHeader);
+        return m_pHeader->dwCurrSize;
+    }
+
+    PsAssert(m_pRingHeader);
+
+    gtUInt32 dwReadOffset = m_pRingHeader->dwReadOffset.load(std::memory_order_acquire);
+    gtUInt32 dwWriteOffset = m_pRingHeader->dwWriteOffset.load(std::memory_order_acquire);
+
+    if (dwWriteOffset >= dwReadOffset)
+    {
+        return dwWriteOffset - dwReadOffset;
+    }
+
+    return GetPoolSize() - dwReadOffset + dwWriteOffset;
 }
 
 //=============================================================================
@@ -1432,10 +1623,26 @@ bool SharedMemoryManager::LockPut(unsigned long dwNumBytes, unsigned long dwNumB
         return false;
     }
 
+    // a lock-free ring's Put waits for the reader to free up space, so there is no need to check for room
+    if (m_bLockFreeRing)
+    {
+        return true;
+    }
+
+    if (false == m_pSMMutex->Lock())
+    {
+        Log(logERROR, "Error occurred while waiting for sm mutex. Error %lu\n", osGetLastSystemError());
+        UnlockPut();
+        return false;
+    }
+
     void* pPtr = NULL;
     unsigned long dwTmp = 0;
+    bool bFoundLocation = FindPutLocation(dwNumBytes + (BUFFER_HEADER_SIZE * dwNumBuffers), pPtr, dwTmp);
+
+    m_pSMMutex->Unlock();
 
-    if (!FindPutLocation(dwNumBytes + (BUFFER_HEADER_SIZE * dwNumBuffers), pPtr, dwTmp))
+    if (!bFoundLocation)
     {
         UnlockPut();
         return false;
@@ -1480,11 +1687,11 @@ void SharedMemoryManager::UnlockGet()
 
 //--------------------------------------------------------------------------
 /// Tries to find a valid location to store dwNumBytes in the shared memory.
-/// \pre LockPut has been called successfully
+/// \pre LockPut has been called successfully and the sm mutex is locked
 /// \param dwNumBytes the number of bytes that need to be put into the
 ///    shared memory
-/// \param rpPutLocation
-/// \param rdwChunkSize
+/// \param rpPutLocation the location of the chunk's buffer header
+/// \param rdwChunkSize the number of bytes that fit in the chunk
 /// \return true if a large enough location is found; false otherwise
 //--------------------------------------------------------------------------
 bool SharedMemoryManager::FindPutLocation(unsigned long dwNumBytes, void*& rpPutLocation, unsigned long& rdwChunkSize)
@@ -1504,19 +1711,12 @@ bool SharedMemoryManager::FindPutLocation(unsigned long dwNumBytes, void*& rpPut
 
     unsigned long dwMaxSize = m_pHeader->dwEnd - m_pHeader->dwStart;
 
-    if (dwMaxSize - m_pHeader->dwCurrSize <= BUFFER_HEADER_SIZE)
-    {
-        // there isn't even enough room for the header information
-        Log(logWARNING, "Shared memory %s doesn't have enough room for header information. Hopefully some reads will happen and free up some more space, then try again.\n", m_strName);
-        Log(logWARNING, "Max size is %lu, current size is %lu, buffer header size is %lu\t(put)\n", dwMaxSize, m_pHeader->dwCurrSize, BUFFER_HEADER_SIZE);
-        return false;
-    }
-
-    // make sure the write offset isn't at or near the end
-    if (m_pHeader->dwWriteOffset + BUFFER_HEADER_SIZE >= m_pHeader->dwEnd)
+    // make sure the write offset isn't at or near the end of the pool; the
+    // write offset is relative to the start of the pool, so compare it with the pool size.
+    // this is done before checking for room, since the skipped space isn't available
+    if (m_pHeader->dwWriteOffset + BUFFER_HEADER_SIZE >= dwMaxSize)
     {
         // it is too close to even write the header in, wrap it around
-
         // set this value to NULL to indicate to the reader that the offsets have wrapped
         *(m_pPool + m_pHeader->dwWriteOffset) = '\0';
 
@@ -1524,6 +1724,7 @@ bool SharedMemoryManager::FindPutLocation(unsigned long dwNumBytes, void*& rpPut
         // consider this as available space
         gtUInt32 dwSkippedSpace = dwMaxSize - m_pHeader->dwWriteOffset;
         m_pHeader->dwCurrSize += dwSkippedSpace;
+
 #ifdef DEBUG_SHARED_MEM
 
         if (strcmp(m_strName, DEBUG_SHARED_MEM) == 0)
@@ -1537,6 +1738,14 @@ bool SharedMemoryManager::FindPutLocation(unsigned long dwNumBytes, void*& rpPut
         m_pHeader->dwWriteOffset = 0;
     }
 
+    if (dwMaxSize - m_pHeader->dwCurrSize <= BUFFER_HEADER_SIZE)
+    {
+        // there isn't even enough room for the header information
+        Log(logWARNING, "Shared memory %s doesn't have enough room for header information. Hopefully some reads will happen and free up some more space, then try again.\n", m_strName);
+        Log(logWARNING, "Max size is %lu, current size is %lu, buffer header size is %lu\t(put)\n", dwMaxSize, m_pHeader->dwCurrSize, BUFFER_HEADER_SIZE);
+        return false;
+    }
+
     // if the reading offset is higher than the writing offset,
     // that means that the writing has looped around, but reading has not
     // make sure we don't write over the unread data
@@ -1556,9 +1765,214 @@ bool SharedMemoryManager::FindPutLocation(unsigned long dwNumBytes, void*& rpPut
     }
 }
 
+//--------------------------------------------------------------------------
+/// Tries to find a valid location to store dwNumBytes in a lock-free ring.
+/// Chunks are never split at the end of the pool; if there isn't enough room
+/// before the end, a wrap marker is published so the reader continues at the
+/// start of the pool, and the writer continues there once the reader has
+/// freed up space.
+/// \pre LockPut has been called successfully
+/// \param dwNumBytes the number of bytes that need to be put into the
+///    shared memory
+/// \param bWholeBuffer true if all dwNumBytes must fit in one chunk; false
+///    if a smaller chunk will do
+/// \param rpPutLocation the location of the chunk's buffer header
+/// \param rdwChunkSize the number of bytes that fit in the chunk
+/// \return true if a large enough location is found; false otherwise
+//--------------------------------------------------------------------------
+bool SharedMemoryManager::FindRingPutLocation(unsigned long dwNumBytes, bool bWholeBuffer, void*& rpPutLocation, unsigned long& rdwChunkSize)
+{
+    PsAssert(m_pRingHeader != NULL);
+    PsAssert(m_pPool != NULL);
+
+    if (m_pRingHeader == NULL || m_pPool == NULL)
+    {
+        return false;
+    }
+
+    // the read offset is loaded with acquire, so the reader is done with the space behind it
+    gtUInt32 dwReadOffset = m_pRingHeader->dwReadOffset.load(std::memory_order_acquire);
+    gtUInt32 dwWriteOffset = m_pRingHeader->dwWriteOffset.load(std::memory_order_relaxed);
+    gtUInt32 dwMinSpace = BUFFER_HEADER_SIZE + ALIGN_TO_DWORD(bWholeBuffer ? dwNumBytes : 1);
+    gtUInt32 dwSpace = 0;
+
+    if (dwWriteOffset >= dwReadOffset)
+    {
+        // the space runs to the end of the pool; if the reader is at the start,
+        // stop short of it, so that a full memory doesn't look empty
+        dwSpace = GetPoolSize() - dwWriteOffset - ((dwReadOffset == 0) ? DWORD_SIZE : 0);
+
+        if (dwSpace < dwMinSpace)
+        {
+            if (dwReadOffset == 0)
+            {
+                // wait for the reader to move on before wrapping around
+                return false;
+            }
+
+            // there isn't enough room before the end of the pool, so tell the reader to wrap around
+            gtUInt32 dwWrapMarker = SM_WRAP_MARKER;
+            memcpy_s(m_pPool + dwWriteOffset, DWORD_SIZE, &dwWrapMarker, DWORD_SIZE);
+
+            dwWriteOffset = 0;
+            m_pRingHeader->dwWriteOffset.store(dwWriteOffset, std::memory_order_release);
+
+            if (false == m_pChunkWritten->Signal())
+            {
+                Log(logERROR, "SetEvent on chunk_written failed. Error %lu\n", osGetLastSystemError());
+            }
+        }
+    }
+
+    if (dwWriteOffset < dwReadOffset)
+    {
+        // stop short of the read offset, so that a full memory doesn't look empty
+        dwSpace = dwReadOffset - dwWriteOffset - DWORD_SIZE;
+    }
+
+    if (dwSpace < dwMinSpace)
+    {
+        return false;
+    }
+
+    rpPutLocation = m_pPool + dwWriteOffset;
+    rdwChunkSize = std::min<unsigned long>(dwSpace - BUFFER_HEADER_SIZE, dwNumBytes);
+    return true;
+}
+
+//--------------------------------------------------------------------------
+/// Finds a location to store dwNumBytes in the shared memory, waiting for
+/// the reader to free up space if there isn't any. Unless the memory is a
+/// lock-free ring, the sm mutex stays locked until PublishPut is called.
+/// \pre LockPut has been called successfully
+/// \param dwNumBytes the number of bytes that need to be put into the
+///    shared memory
+/// \param bWholeBuffer true if all dwNumBytes must fit in one chunk; only
+///    a lock-free ring can wait for that
+/// \param rpPutLocation the location of the chunk's buffer header
+/// \param rdwChunkSize the number of bytes that fit in the chunk
+/// \return true if a location was found; false if there was an error waiting
+//--------------------------------------------------------------------------
+bool SharedMemoryManager::WaitForPutLocation(unsigned long dwNumBytes, bool bWholeBuffer, void*& rpPutLocation, unsigned long& rdwChunkSize)
+{
+    if (m_bLockFreeRing == false)
+    {
+        PsAssert(bWholeBuffer == false);
+
+        for (;;)
+        {
+            // Make sure we are allowed to write
+            if (false == m_pChunkRead->Wait())
+            {
+                Log(logERROR, "Error occurred while waiting for chunk read. Error %lu\n", osGetLastSystemError());
+                return false;
+            }
+
+            if (false == m_pSMMutex->Lock())
+            {
+                Log(logERROR, "Error occurred while waiting for sm mutex. Error %lu\n", osGetLastSystemError());
+                return false;
+            }
+
+            if (FindPutLocation(dwNumBytes, rpPutLocation, rdwChunkSize) == true)
+            {
+                return true;
+            }
+
+            // this just continues, because it should be able to find a put location after more data has been read
+            m_pSMMutex->Unlock();
+        }
+    }
+
+    while (FindRingPutLocation(dwNumBytes, bWholeBuffer, rpPutLocation, rdwChunkSize) == false)
+    {
+        // reset the event before checking again, so that a chunk read in between isn't missed
+        m_pChunkRead->Reset();
+
+        if (FindRingPutLocation(dwNumBytes, bWholeBuffer, rpPutLocation, rdwChunkSize) == true)
+        {
+            break;
+        }
+
+        if (false == m_pChunkRead->Wait())
+        {
+            Log(logERROR, "Error occurred while waiting for chunk read. Error %lu\n", osGetLastSystemError());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------
+/// Makes a chunk that was written at a location returned by
+/// WaitForPutLocation or ReservePut available to the reader, by moving the
+/// write offset past it, and unlocks the sm mutex.
+/// \param pPutLocation the location of the chunk's buffer header
+/// \param dwChunkSize the number of bytes in the chunk
+/// \param dwBytesLeft the number of bytes of the buffer that still need to
+///    be put after this chunk
+//--------------------------------------------------------------------------
+void SharedMemoryManager::PublishPut(void* pPutLocation, unsigned long dwChunkSize, unsigned long dwBytesLeft)
+{
+    if (m_bLockFreeRing)
+    {
+        // chunks start on a DWORD boundary, so the next buffer header is aligned
+        gtUInt32 dwWriteOffset = (gtUInt32)((char*)pPutLocation - m_pPool) + BUFFER_HEADER_SIZE + ALIGN_TO_DWORD(dwChunkSize);
+
+        if (dwWriteOffset >= GetPoolSize())
+        {
+            dwWriteOffset = 0;
+        }
+
+        // the write offset is stored with release, so the reader sees the chunk once it sees the new offset
+        m_pRingHeader->dwWriteOffset.store(dwWriteOffset, std::memory_order_release);
+    }
+    else
+    {
+        PsAssert((char*)pPutLocation == m_pPool + m_pHeader->dwWriteOffset);
+
+        // do some housekeeping on the header values
+        m_pHeader->dwCurrSize += (dwChunkSize + BUFFER_HEADER_SIZE);
+        m_pHeader->dwWriteOffset += (dwChunkSize + BUFFER_HEADER_SIZE);
+
+        if (m_pHeader->dwWriteOffset >= m_pHeader->dwEnd - m_pHeader->dwStart)
+        {
+            m_pHeader->dwWriteOffset = 0;
+        }
+
+        // if there isn't room for the rest of the data, reset the chunkRead event
+        // so that the next chunk waits for the reader to free up some space
+        if (m_pHeader->dwEnd - m_pHeader->dwStart - m_pHeader->dwCurrSize < dwBytesLeft + BUFFER_HEADER_SIZE)
+        {
+            m_pChunkRead->Reset();
+        }
+    }
+
+#ifdef DEBUG_SHARED_MEM
+
+    if (strcmp(m_strName, DEBUG_SHARED_MEM) == 0)
+    {
+        Log(logMESSAGE, "put-----> SM current size is %lu \t(+%lu)\n", GetSize(), dwChunkSize + BUFFER_HEADER_SIZE);
+    }
+
+#endif
+
+    if (false == m_pChunkWritten->Signal())
+    {
+        // the data was put in, it just wasn't signaled to be read
+        Log(logERROR, "SetEvent on chunk_written failed. Error %lu\n", osGetLastSystemError());
+    }
+
+    if (m_bLockFreeRing == false)
+    {
+        m_pSMMutex->Unlock();
+    }
+}
+
 //--------------------------------------------------------------------------
 /// Returns the memory address from which the next Get should be performed.
-/// \pre LockGet has been called successfully
+/// \pre LockGet has been called successfully and the sm mutex is locked
 /// \return NULL if there is no data to read; a valid address otherwise.
 //--------------------------------------------------------------------------
 void* SharedMemoryManager::FindGetLocation()
@@ -1601,3 +2015,197 @@ void* SharedMemoryManager::FindGetLocation()
     // we should now be in a valid place to read
     return m_pPool + m_pHeader->dwReadOffset;
 }
+
+//--------------------------------------------------------------------------
+/// Returns the memory address in a lock-free ring from which the next Get
+/// should be performed.
+/// \pre LockGet has been called successfully
+/// \return NULL if there is no data to read; a valid address otherwise.
+//--------------------------------------------------------------------------
+void* SharedMemoryManager::FindRingGetLocation()
+{
+    PsAssert(m_pRingHeader != NULL);
+    PsAssert(m_pPool != NULL);
+
+    // the write offset is loaded with acquire, so the chunks behind it are complete
+    gtUInt32 dwWriteOffset = m_pRingHeader->dwWriteOffset.load(std::memory_order_acquire);
+    gtUInt32 dwReadOffset = m_pRingHeader->dwReadOffset.load(std::memory_order_relaxed);
+
+    // make sure there is data to read
+    if (dwReadOffset == dwWriteOffset)
+    {
+        return NULL;
+    }
+
+    // check to see if the writer wrapped around to the start of the pool here
+    if (*((gtUInt32*)(m_pPool + dwReadOffset)) == SM_WRAP_MARKER)
+    {
+        dwReadOffset = 0;
+        m_pRingHeader->dwReadOffset.store(dwReadOffset, std::memory_order_release);
+
+        // the skipped space is free again
+        if (false == m_pChunkRead->Signal())
+        {
+            Log(logERROR, "SetEvent on chunk_read failed. Error %lu\n", osGetLastSystemError());
+        }
+
+        if (dwReadOffset == dwWriteOffset)
+        {
+            return NULL;
+        }
+    }
+
+    // we should now be in a valid place to read
+    return m_pPool + dwReadOffset;
+}
+
+//--------------------------------------------------------------------------
+/// Returns the memory address from which the next Get should be performed,
+/// waiting for the writer if there is no data to read. Unless the memory
+/// is a lock-free ring, the sm mutex stays locked until PublishGet or
+/// ReleaseGetLocation is called.
+/// \pre LockGet has been called successfully
+/// \return NULL if there was an error waiting; a valid address otherwise.
+//--------------------------------------------------------------------------
+void* SharedMemoryManager::WaitForGetLocation()
+{
+    if (m_bLockFreeRing == false)
+    {
+        // wait for a chunk to be written
+        if (false == m_pChunkWritten->Wait())
+        {
+            Log(logERROR, "Error occurred while waiting for chunk written:%d\n", osGetLastSystemError());
+            return NULL;
+        }
+
+        if (false == m_pSMMutex->Lock())
+        {
+            Log(logERROR, "Error occurred while waiting for sm mutex. Error %lu\n", osGetLastSystemError());
+            m_pChunkWritten->Reset();
+            return NULL;
+        }
+
+        void* pLocation = FindGetLocation();
+
+        if (pLocation == NULL)
+        {
+            // since chunkWritten was signaled, there should definitely be data to get
+            Log(logERROR, "Unable to find get location. Error %lu\n", osGetLastSystemError());
+            m_pChunkWritten->Reset();
+            m_pSMMutex->Unlock();
+        }
+
+        return pLocation;
+    }
+
+    void* pLocation = FindRingGetLocation();
+
+    while (pLocation == NULL)
+    {
+        // reset the event before checking again, so that a chunk written in between isn't missed
+        m_pChunkWritten->Reset();
+
+        pLocation = FindRingGetLocation();
+
+        if (pLocation != NULL)
+        {
+            break;
+        }
+
+        if (false == m_pChunkWritten->Wait())
+        {
+            Log(logERROR, "Error occurred while waiting for chunk written:%d\n", osGetLastSystemError());
+            return NULL;
+        }
+
+        pLocation = FindRingGetLocation();
+    }
+
+    return pLocation;
+}
+
+//--------------------------------------------------------------------------
+/// Frees the chunk at the location returned by WaitForGetLocation, by
+/// moving the read offset past it, and unlocks the sm mutex.
+/// \param dwChunkSize the number of bytes in the chunk, as it was written
+//--------------------------------------------------------------------------
+void SharedMemoryManager::PublishGet(gtUInt32 dwChunkSize)
+{
+    if (m_bLockFreeRing)
+    {
+        gtUInt32 dwReadOffset = m_pRingHeader->dwReadOffset.load(std::memory_order_relaxed) + BUFFER_HEADER_SIZE + ALIGN_TO_DWORD(dwChunkSize);
+
+        if (dwReadOffset >= GetPoolSize())
+        {
+            dwReadOffset = 0;
+        }
+
+        // the read offset is stored with release, so the writer only reuses the space once the chunk has been copied out
+        m_pRingHeader->dwReadOffset.store(dwReadOffset, std::memory_order_release);
+    }
+    else
+    {
+        // do housekeeping on the header data
+        m_pHeader->dwCurrSize -= (dwChunkSize + BUFFER_HEADER_SIZE);
+        m_pHeader->dwReadOffset += (dwChunkSize + BUFFER_HEADER_SIZE);
+
+        // check for a wrapped ReadOffset
+        if (m_pHeader->dwReadOffset >= m_pHeader->dwEnd - m_pHeader->dwStart)
+        {
+            m_pHeader->dwReadOffset = 0;
+        }
+
+        if (m_pHeader->dwCurrSize == 0)
+        {
+            // in this case, we could also reset the header information back to the beginning to
+            // reduce the cases where we have to "wrap around"
+            m_pChunkWritten->Reset();
+        }
+    }
+
+#ifdef DEBUG_SHARED_MEM
+
+    if (strcmp(m_strName, DEBUG_SHARED_MEM) == 0)
+    {
+        Log(logMESSAGE, "get-----> SM current size is %lu\t(-%lu)\n", GetSize(), (dwChunkSize + BUFFER_HEADER_SIZE));
+    }
+
+#endif
+
+    // set that we've read the chunk, so another can be written if needed
+    if (false == m_pChunkRead->Signal())
+    {
+        // the data was read, we just weren't able to signal more to be written
+        Log(logERROR, "SetEvent on chunk_read failed. Error %lu\n", osGetLastSystemError());
+    }
+
+    if (m_bLockFreeRing == false)
+    {
+        m_pSMMutex->Unlock();
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Unlocks the sm mutex after WaitForGetLocation, leaving the chunk in place.
+//--------------------------------------------------------------------------
+void SharedMemoryManager::ReleaseGetLocation()
+{
+    if (m_bLockFreeRing == false)
+    {
+        m_pSMMutex->Unlock();
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Returns the number of bytes in the pool that are used for buffers.
+//--------------------------------------------------------------------------
+gtUInt32 SharedMemoryManager::GetPoolSize()
+{
+    if (m_bLockFreeRing == false)
+    {
+        return m_pHeader->dwEnd - m_pHeader->dwStart;
+    }
+
+    // chunks are DWORD aligned, so any bytes after the last whole DWORD are never used
+    return (m_pRingHeader->dwEnd - m_pRingHeader->dwStart) & ~(gtUInt32)(DWORD_SIZE - 1);
+}
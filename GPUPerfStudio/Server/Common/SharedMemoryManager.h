@@ -8,6 +8,7 @@
 #ifndef GPS_SHAREDMEMORYMANAGER_INCLUDE
 #define GPS_SHAREDMEMORYMANAGER_INCLUDE
 
+#include <atomic>
 #include <AMDTBaseTools/Include/gtDefinitions.h>
 #include "defines.h"
 #include "CommonTypes.h"
@@ -36,6 +37,50 @@ struct SMHeader
     uint32 dwWriteOffset; ///< offset to the write position from the start of the pool
 };
 
+//-----------------------------------------------------------------------------
+/// Identifies a shared memory that uses the lock-free ring layout.
+//-----------------------------------------------------------------------------
+static const uint32 s_SMRingMagic = 0x534D5047;   // "GPMS"
+
+//-----------------------------------------------------------------------------
+/// The version of SMRingHeader and of the buffer format in a lock-free ring.
+/// It must be changed whenever either of them changes. The version is part of
+/// the name of the underlying shared memory, so a process built with a
+/// different version fails to open the ring rather than misreading it.
+//-----------------------------------------------------------------------------
+static const uint32 s_SMRingVersion = 1;
+
+//=============================================================================
+/// SMRingHeader struct
+/// The header of a shared memory that is created or opened as a lock-free
+/// ring, in place of SMHeader. Only processes that both ask for the ring can
+/// use it, so it is never used for memory that is shared with the web server.
+/// There is one writer and one reader at a time (see LockPut and LockGet), and
+/// each of them only ever changes its own offset, so the offsets are atomics
+/// rather than being protected by a mutex. The memory is empty when the two
+/// offsets are equal; the writer never lets its offset catch up with the read
+/// offset from behind.
+//=============================================================================
+struct SMRingHeader
+{
+    uint32 dwMagic;                       ///< s_SMRingMagic
+    uint32 dwVersion;                     ///< s_SMRingVersion of the process that created the memory
+    uint32 dwStart;                       ///< offset to the start of the memory pool
+    uint32 dwEnd;                         ///< offset to the end of the memory pool
+    std::atomic<uint32> dwReadOffset;     ///< offset to the read position from the start of the pool; only changed by the reader
+    std::atomic<uint32> dwWriteOffset;    ///< offset to the write position from the start of the pool; only changed by the writer
+};
+
+//=============================================================================
+/// SMSegment struct
+/// One piece of a buffer that is put into the shared memory with PutSegments.
+//=============================================================================
+struct SMSegment
+{
+    const void*   pData;                  ///< the piece's data
+    unsigned long dwNumBytes;             ///< number of bytes pointed to by pData
+};
+
 //=============================================================================
 /// SharedMemoryManager class
 /// This class provides all the functionality for putting and getting data
@@ -55,19 +100,22 @@ public:
     ///   the shared memory (ignored if shared memory already exists)
     /// \param dwElementSize size in bytes of a single element (ignored if shared
     ///   memory already exists)
+    /// \param bLockFreeRing true to use the lock-free ring layout, which every
+    ///   process that opens the memory must also ask for
     ///
     /// \return true if memory could be created or opened; false otherwise
     //--------------------------------------------------------------------------
-    bool Create(const char* strName, unsigned long dwMaxNumElements, unsigned long dwElementSize);
+    bool Create(const char* strName, unsigned long dwMaxNumElements, unsigned long dwElementSize, bool bLockFreeRing);
 
     //--------------------------------------------------------------------------
     /// tries to open an existing shared memory
     ///
     /// \param strName name of the shared memory to open
+    /// \param bLockFreeRing true if the memory was created as a lock-free ring
     ///
     /// \return true if the shared memory could be opened; false otherwise
     //--------------------------------------------------------------------------
-    bool Open(const char* strName);
+    bool Open(const char* strName, bool bLockFreeRing);
 
     //--------------------------------------------------------------------------
     /// Closes the shared memory and releases all handles
@@ -84,6 +132,45 @@ public:
     //--------------------------------------------------------------------------
     bool Put(void* pIn, unsigned long dwNumBytes);
 
+    //--------------------------------------------------------------------------
+    /// Puts a buffer made of several pieces in the shared memory queue. The
+    /// pieces are copied straight into the chunks of the buffer, as the reader
+    /// frees up space, so they don't need to be put together first.
+    ///
+    /// \param pSegments the pieces of the buffer, in order
+    /// \param uNumSegments the number of pieces
+    ///
+    /// \return true if data could be added; false otherwise
+    //--------------------------------------------------------------------------
+    bool PutSegments(const SMSegment* pSegments, unsigned int uNumSegments);
+
+    //--------------------------------------------------------------------------
+    /// Reserves a contiguous region in the shared memory queue, so that a
+    /// buffer can be serialized directly into the shared memory rather than
+    /// built elsewhere and copied in. The region is only visible to the reader
+    /// once CommitPut is called, and the shared memory stays locked until then.
+    /// A lock-free ring waits for the reader to free up enough space instead.
+    /// \pre LockPut has been called successfully
+    ///
+    /// \param dwNumBytes the largest number of bytes that will be written
+    ///
+    /// \return pointer to the reserved region; NULL if there is currently no
+    ///   contiguous region large enough (or, for a lock-free ring, if the buffer
+    ///   could never fit in one), in which case Put should be used instead
+    //--------------------------------------------------------------------------
+    void* ReservePut(unsigned long dwNumBytes);
+
+    //--------------------------------------------------------------------------
+    /// Makes the buffer written into the region returned by ReservePut
+    /// available to the reader, and unlocks the shared memory.
+    ///
+    /// \param dwNumBytes number of bytes that were actually written; must not
+    ///   be more than the number of bytes that were reserved
+    ///
+    /// \return true if the buffer was committed; false otherwise
+    //--------------------------------------------------------------------------
+    bool CommitPut(unsigned long dwNumBytes);
+
     //--------------------------------------------------------------------------
     /// Gets data from the shared memory queue.
     ///
@@ -154,22 +241,96 @@ private:
 
     //--------------------------------------------------------------------------
     /// Tries to find a valid location to store dwNumBytes in the shared memory.
-    /// \pre LockPut has been called successfully
+    /// \pre LockPut has been called successfully and the sm mutex is locked
     /// \param dwNumBytes the number of bytes that need to be put into the
     /// shared memory
-    /// \param rpPutLocation
-    /// \param rdwChunkSize
+    /// \param rpPutLocation the location of the chunk's buffer header
+    /// \param rdwChunkSize the number of bytes that fit in the chunk
     /// \return true if a large enough location is found; false otherwise
     //--------------------------------------------------------------------------
     bool FindPutLocation(unsigned long dwNumBytes, void*& rpPutLocation, unsigned long& rdwChunkSize);
 
+    //--------------------------------------------------------------------------
+    /// Tries to find a valid location to store dwNumBytes in a lock-free ring.
+    /// \pre LockPut has been called successfully
+    /// \param dwNumBytes the number of bytes that need to be put into the
+    /// shared memory
+    /// \param bWholeBuffer true if all dwNumBytes must fit in one chunk; false
+    /// if a smaller chunk will do
+    /// \param rpPutLocation the location of the chunk's buffer header
+    /// \param rdwChunkSize the number of bytes that fit in the chunk
+    /// \return true if a large enough location is found; false otherwise
+    //--------------------------------------------------------------------------
+    bool FindRingPutLocation(unsigned long dwNumBytes, bool bWholeBuffer, void*& rpPutLocation, unsigned long& rdwChunkSize);
+
+    //--------------------------------------------------------------------------
+    /// Finds a location to store dwNumBytes in the shared memory, waiting for
+    /// the reader to free up space if there isn't any. Unless the memory is a
+    /// lock-free ring, the sm mutex stays locked until PublishPut is called.
+    /// \pre LockPut has been called successfully
+    /// \param dwNumBytes the number of bytes that need to be put into the
+    /// shared memory
+    /// \param bWholeBuffer true if all dwNumBytes must fit in one chunk; only
+    /// a lock-free ring can wait for that
+    /// \param rpPutLocation the location of the chunk's buffer header
+    /// \param rdwChunkSize the number of bytes that fit in the chunk
+    /// \return true if a location was found; false if there was an error waiting
+    //--------------------------------------------------------------------------
+    bool WaitForPutLocation(unsigned long dwNumBytes, bool bWholeBuffer, void*& rpPutLocation, unsigned long& rdwChunkSize);
+
+    //--------------------------------------------------------------------------
+    /// Makes a chunk that was written at a location returned by
+    /// WaitForPutLocation or ReservePut available to the reader, by moving the
+    /// write offset past it, and unlocks the sm mutex.
+    /// \param pPutLocation the location of the chunk's buffer header
+    /// \param dwChunkSize the number of bytes in the chunk
+    /// \param dwBytesLeft the number of bytes of the buffer that still need to
+    /// be put after this chunk
+    //--------------------------------------------------------------------------
+    void PublishPut(void* pPutLocation, unsigned long dwChunkSize, unsigned long dwBytesLeft);
+
     //--------------------------------------------------------------------------
     /// Returns the memory address from which the next Get should be performed.
-    /// \pre LockGet has been called successfully
+    /// \pre LockGet has been called successfully and the sm mutex is locked
     /// \return NULL if there is no data to read; a valid address otherwise.
     //--------------------------------------------------------------------------
     void* FindGetLocation();
 
+    //--------------------------------------------------------------------------
+    /// Returns the memory address in a lock-free ring from which the next Get
+    /// should be performed.
+    /// \pre LockGet has been called successfully
+    /// \return NULL if there is no data to read; a valid address otherwise.
+    //--------------------------------------------------------------------------
+    void* FindRingGetLocation();
+
+    //--------------------------------------------------------------------------
+    /// Returns the memory address from which the next Get should be performed,
+    /// waiting for the writer if there is no data to read. Unless the memory
+    /// is a lock-free ring, the sm mutex stays locked until PublishGet or
+    /// ReleaseGetLocation is called.
+    /// \pre LockGet has been called successfully
+    /// \return NULL if there was an error waiting; a valid address otherwise.
+    //--------------------------------------------------------------------------
+    void* WaitForGetLocation();
+
+    //--------------------------------------------------------------------------
+    /// Frees the chunk at the location returned by WaitForGetLocation, by
+    /// moving the read offset past it, and unlocks the sm mutex.
+    /// \param dwChunkSize the number of bytes in the chunk, as it was written
+    //--------------------------------------------------------------------------
+    void PublishGet(gtUInt32 dwChunkSize);
+
+    //--------------------------------------------------------------------------
+    /// Unlocks the sm mutex after WaitForGetLocation, leaving the chunk in place.
+    //--------------------------------------------------------------------------
+    void ReleaseGetLocation();
+
+    //--------------------------------------------------------------------------
+    /// Returns the number of bytes in the pool that are used for buffers.
+    //--------------------------------------------------------------------------
+    gtUInt32 GetPoolSize();
+
 private:
     SharedMemory* m_pMapFile;          ///< Shared memory wrapper
     NamedMutex*   m_pSMMutex;          ///< the mutex to the mapped file
@@ -177,9 +338,13 @@ private:
     NamedMutex*   m_pWriteMutex;       ///< the mutex for writing
     NamedEvent*   m_pChunkRead;        ///< Event to signal reading is not occuring
     NamedEvent*   m_pChunkWritten;     ///< Event to signal writing is not occuring
-    SMHeader*     m_pHeader;           ///< pointer to header struct in the shared memory
+    SMHeader*     m_pHeader;           ///< pointer to header struct in the shared memory; NULL for a lock-free ring
+    SMRingHeader* m_pRingHeader;       ///< pointer to header struct in a lock-free ring; NULL otherwise
+    bool          m_bLockFreeRing;     ///< true if the shared memory is a lock-free ring
     char* m_pPool;                     ///< pointer to pool within the shared memory
     char  m_strName[ PS_MAX_PATH ];    ///< name of the shared memory
+    char* m_pReservedLocation;         ///< region returned by ReservePut that hasn't been committed yet
+    unsigned long m_dwReservedSize;    ///< number of bytes reserved by ReservePut
 };
 
 //=============================================================================
@@ -202,10 +367,13 @@ bool smExists(const char* strName);
 /// \param strName name of the shared memory to create
 /// \param dwMaxNumElements max number of elements that can fit in the memory
 /// \param dwElementSize size of a single element in bytes
+/// \param bLockFreeRing true to use the lock-free ring layout, which every
+///   process that opens the memory must also ask for. Memory that is shared
+///   with the web server must keep the default layout.
 ///
 /// \return true if the shared memory could be created or opened; false otherwise
 //-----------------------------------------------------------------------------
-bool smCreate(const char* strName, unsigned long dwMaxNumElements, unsigned long dwElementSize);
+bool smCreate(const char* strName, unsigned long dwMaxNumElements, unsigned long dwElementSize, bool bLockFreeRing = false);
 
 //-----------------------------------------------------------------------------
 /// Resets the named shared memory
@@ -225,10 +393,11 @@ void smClose(const char* strName);
 /// Opens the named shared memory for this process. Does not lock the shared memory.
 ///
 /// \param strName name of the shared memory to open
+/// \param bLockFreeRing true if the memory was created as a lock-free ring
 ///
 /// \return true if the shared memory could be opened; false otherwise
 //-----------------------------------------------------------------------------
-bool smOpen(const char* strName);
+bool smOpen(const char* strName, bool bLockFreeRing = false);
 
 //-----------------------------------------------------------------------------
 /// Puts data into the shared memory for access in a FIFO manner
@@ -241,6 +410,42 @@ bool smOpen(const char* strName);
 //-----------------------------------------------------------------------------
 bool smPut(const char* strName, void* pIn, unsigned long dwNumBytes);
 
+//-----------------------------------------------------------------------------
+/// Puts a buffer made of several pieces into the shared memory for access in
+/// a FIFO manner, without putting the pieces together first
+///
+/// \param strName name of the shared memory to put data in
+/// \param pSegments the pieces of the buffer, in order
+/// \param uNumSegments the number of pieces
+///
+/// \return true if the data could be put in the shared memory; false otherwise
+//-----------------------------------------------------------------------------
+bool smPutSegments(const char* strName, const SMSegment* pSegments, unsigned int uNumSegments);
+
+//-----------------------------------------------------------------------------
+/// Reserves a contiguous region in the named shared memory that a buffer can
+/// be serialized into directly. Must be followed by smCommitPut.
+/// \pre smLockPut has been called successfully
+///
+/// \param strName name of the shared memory to reserve space in
+/// \param dwNumBytes the largest number of bytes that will be written
+///
+/// \return pointer to the reserved region; NULL if no contiguous region is
+///   currently available, in which case smPut should be used instead
+//-----------------------------------------------------------------------------
+void* smReservePut(const char* strName, unsigned long dwNumBytes);
+
+//-----------------------------------------------------------------------------
+/// Makes a buffer written into the region returned by smReservePut available
+/// for access in a FIFO manner
+///
+/// \param strName name of the shared memory that the region was reserved in
+/// \param dwNumBytes number of bytes that were written into the region
+///
+/// \return true if the buffer was committed; false otherwise
+//-----------------------------------------------------------------------------
+bool smCommitPut(const char* strName, unsigned long dwNumBytes);
+
 //-----------------------------------------------------------------------------
 /// Copies the next buffer in the named shared memory to the specified location.
 /// If either of the last two parameters are NULL (or 0), this function will
@@ -0,0 +1,312 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Benchmark for building the API Trace response at the end of a traced
+///         frame. Threads log calls into their own ThreadTraceData the way the
+///         layer's LogAPICall does, then the response is built with the real
+///         APITraceBuilder. Measures the time to build the per-thread and the
+///         merged response text, and how long the render thread is held up in
+///         EndFrame when the response is built inline, and when it's built on a
+///         worker thread while the render thread collects the GPU Trace. Checks
+///         that the merged response has every call, in start time order.
+///
+///         Built on Linux against the real APITraceBuilder and ThreadTraceRegistry:
+///         g++ -std=c++11 -O2 -D_LINUX -DLINUX -DNDEBUG -DGDT_PUBLIC -I.. -I../Linux
+///             -I../../../../CommonProjects -I../../../../Common/Lib/Ext/tinyxml/2.6.2
+///             APITraceResponseBenchmark.cpp ../APITraceBuilder.cpp ../ThreadTraceRegistry.cpp
+///             ../BinaryTraceFile.cpp ../Linux/SafeCRT.cpp
+///             ../../../../CommonProjects/AMDTOSWrappers/src/linux/osThreadLocalData.cpp
+///             -lpthread
+//==============================================================================
+
+#if defined (_LINUX)
+    #include "WinDefs.h"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../APITraceBuilder.h"
+#include "../MultithreadedTraceAnalyzerLayer.h"
+
+// Stand-ins for the parts of Logger.cpp that the API Trace builder uses.
+bool _SetupLog(const bool, const char*, const char*, int, const char*) { return false; }
+void _Log(enum LogType, const char* fmt, ...) { va_list args; va_start(args, fmt); vfprintf(stderr, fmt, args); va_end(args); }
+std::atomic<int> g_CachedLogLevel(logERROR);
+
+// Stand-in for AMDTBaseTools.
+extern "C" void gtTriggerAssertonFailureHandler(const char*, const char*, int, const wchar_t*) { }
+
+// Stand-ins for the parts of Linux/timerLinux.cpp that TimingLog uses. That file also
+// replaces the process's time functions, so it's left out. Same clock, without the hooks.
+Timer::Timer() { m_iFreq = 1000000000; Reset(); }
+void Timer::Reset() { m_iStartTime = GetRaw(); }
+GPS_TIMESTAMP Timer::GetRaw() { struct timespec ts; clock_gettime(CLOCK_REALTIME, &ts); return (GPS_TIMESTAMP)(ts.tv_sec * 1000000000LL) + ts.tv_nsec; }
+
+//--------------------------------------------------------------------------
+/// The number of threads that log calls during the traced frame.
+//--------------------------------------------------------------------------
+static const unsigned int s_NumThreads = 16;
+
+//--------------------------------------------------------------------------
+/// The total number of calls logged during the traced frame.
+//--------------------------------------------------------------------------
+static const unsigned int s_NumCalls = 60000;
+
+//--------------------------------------------------------------------------
+/// How long the render thread stands in for collecting the GPU Trace results.
+//--------------------------------------------------------------------------
+static const unsigned int s_GPUTraceMs = 5;
+
+//--------------------------------------------------------------------------
+/// The number of traced frames to time for each measurement.
+//--------------------------------------------------------------------------
+static const unsigned int s_NumFrames = 20;
+
+//--------------------------------------------------------------------------
+/// A logged call, formatted the way the DX12 server's calls are.
+//--------------------------------------------------------------------------
+class BenchmarkAPIEntry : public APIEntry
+{
+public:
+    //--------------------------------------------------------------------------
+    /// Constructor.
+    /// \param inThreadId The thread that made the call.
+    /// \param inArguments The formatted call arguments.
+    //--------------------------------------------------------------------------
+    BenchmarkAPIEntry(DWORD inThreadId, const char* inArguments)
+        : APIEntry(inThreadId, (FuncId)0, inArguments)
+    {
+    }
+
+    //--------------------------------------------------------------------------
+    /// Return the name of the call.
+    //--------------------------------------------------------------------------
+    virtual const char* GetAPIName() const
+    {
+        return "DrawIndexedInstanced";
+    }
+
+    //--------------------------------------------------------------------------
+    /// Append the call's line to the API Trace text, the way the DX12 server does.
+    //--------------------------------------------------------------------------
+    virtual void AppendAPITraceLine(std::stringstream& ioTraceResponse, double inStartTime, double inEndTime) const
+    {
+        FormatAPITraceLine(ioTraceResponse, mThreadId, 0, mFunctionId, "0x0000000012345678", "ID3D12GraphicsCommandList_DrawIndexedInstanced",
+                           mParameters, "void", inStartTime, inEndTime, 0);
+    }
+
+    //--------------------------------------------------------------------------
+    /// Only the text response is benchmarked.
+    //--------------------------------------------------------------------------
+    virtual void AppendBinaryTraceCall(BinaryTraceWriter& ioTraceWriter, double inStartTime, double inEndTime) const
+    {
+        PS_UNREFERENCED_PARAMETER(ioTraceWriter);
+        PS_UNREFERENCED_PARAMETER(inStartTime);
+        PS_UNREFERENCED_PARAMETER(inEndTime);
+    }
+
+    //--------------------------------------------------------------------------
+    /// The call is a draw.
+    //--------------------------------------------------------------------------
+    virtual bool IsDrawCall() const
+    {
+        return true;
+    }
+};
+
+//--------------------------------------------------------------------------
+/// Log the traced frame's calls from s_NumThreads threads at once, each into its own
+/// ThreadTraceData, the way the layer's LogAPICall does.
+//--------------------------------------------------------------------------
+static void LogFrame(ThreadTraceRegistry& ioThreadTraces, std::vector<ThreadTraceData*>& outThreadData)
+{
+    outThreadData.resize(s_NumThreads);
+
+    for (unsigned int threadIndex = 0; threadIndex < s_NumThreads; ++threadIndex)
+    {
+        outThreadData[threadIndex] = new ThreadTraceData();
+    }
+
+    std::vector<std::thread> threads;
+
+    for (unsigned int threadIndex = 0; threadIndex < s_NumThreads; ++threadIndex)
+    {
+        threads.push_back(std::thread([&, threadIndex]()
+        {
+            ThreadTraceData* threadData = outThreadData[threadIndex];
+            DWORD threadId = 1000 + threadIndex;
+            ioThreadTraces.Register(threadId, threadData);
+
+            Timer callTimer;
+
+            for (unsigned int callIndex = 0; callIndex < s_NumCalls / s_NumThreads; ++callIndex)
+            {
+                GPS_TIMESTAMP startTime = callTimer.GetRaw();
+
+                void* entryMemory = threadData->AllocateEntryMemory(sizeof(BenchmarkAPIEntry));
+                APIEntry* entry = new(entryMemory) BenchmarkAPIEntry(threadId, threadData->CopyParameterString("36, 1, 0, 0, 0"));
+
+                // Stand in for the call itself, so the threads' calls interleave.
+                for (volatile unsigned int spin = 0; spin < (callIndex * 7919 + threadIndex * 104729) % 500; ++spin)
+                {
+                }
+
+                threadData->AddAPIEntry(startTime, entry);
+            }
+        }));
+    }
+
+    for (unsigned int threadIndex = 0; threadIndex < s_NumThreads; ++threadIndex)
+    {
+        threads[threadIndex].join();
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Check that the merged response has as many calls as the per-thread one, in start time order.
+//--------------------------------------------------------------------------
+static bool CheckMergedResponse(const std::string& inPerThreadResponse, const std::string& inMergedResponse)
+{
+    std::istringstream mergedLines(inMergedResponse);
+    std::string line;
+    size_t numLines = 0;
+    double previousStartTime = -1.0;
+
+    while (std::getline(mergedLines, line))
+    {
+        // ThreadId Interface_FunctionName(Parameters) = ReturnValue StartTime EndTime SampleId
+        std::istringstream fields(line.substr(line.find(") = ") + 4));
+        std::string returnValue;
+        double startTime = 0.0;
+        fields >> returnValue >> startTime;
+
+        if (startTime < previousStartTime)
+        {
+            printf("error: merged call %u starts before the call written ahead of it\n", (unsigned int)numLines);
+            return false;
+        }
+
+        previousStartTime = startTime;
+        numLines++;
+    }
+
+    size_t numPerThreadLines = std::count(inPerThreadResponse.begin(), inPerThreadResponse.end(), '\n');
+
+    if (numLines != s_NumCalls || numPerThreadLines != s_NumCalls)
+    {
+        printf("error: %u merged calls and %u per-thread calls, expected %u\n", (unsigned int)numLines, (unsigned int)numPerThreadLines, s_NumCalls);
+        return false;
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------
+/// The time from a start point, in milliseconds.
+//--------------------------------------------------------------------------
+static double MillisecondsSince(const std::chrono::high_resolution_clock::time_point& inStart)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - inStart).count();
+}
+
+//--------------------------------------------------------------------------
+/// Return the median of a set of timings.
+//--------------------------------------------------------------------------
+static double Median(std::vector<double> inTimings)
+{
+    std::sort(inTimings.begin(), inTimings.end());
+    return inTimings[inTimings.size() / 2];
+}
+
+//--------------------------------------------------------------------------
+/// Time building the response text, in milliseconds.
+//--------------------------------------------------------------------------
+static double TimeResponseBuild(const APITraceBuilder& inTraceBuilder, bool inbMerged)
+{
+    std::vector<double> timings;
+
+    for (unsigned int frame = 0; frame < s_NumFrames; ++frame)
+    {
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        std::string response = inbMerged ? inTraceBuilder.GetMergedAPITraceTXT() : inTraceBuilder.GetPerThreadAPITraceTXT("DX12");
+        timings.push_back(MillisecondsSince(start));
+    }
+
+    return Median(timings);
+}
+
+//--------------------------------------------------------------------------
+/// Time how long the render thread is held up at the end of a traced frame, in milliseconds.
+//--------------------------------------------------------------------------
+static double TimeEndFrame(const APITraceBuilder& inTraceBuilder, bool inbUseWorkerThread)
+{
+    std::vector<double> timings;
+    std::string apiTraceResponse;
+
+    for (unsigned int frame = 0; frame < s_NumFrames; ++frame)
+    {
+        std::thread worker;
+
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+        if (inbUseWorkerThread)
+        {
+            worker = std::thread([&]() { apiTraceResponse = inTraceBuilder.GetMergedAPITraceTXT(); });
+        }
+        else
+        {
+            apiTraceResponse = inTraceBuilder.GetMergedAPITraceTXT();
+        }
+
+        // Collect the GPU Trace.
+        std::this_thread::sleep_for(std::chrono::milliseconds(s_GPUTraceMs));
+
+        timings.push_back(MillisecondsSince(start));
+
+        // The next trace can't start until the worker is done. That isn't part of the traced frame.
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+
+    return Median(timings);
+}
+
+int main()
+{
+    Timer frameTimer;
+    GPS_TIMESTAMP frameStartTime = frameTimer.GetRaw();
+
+    ThreadTraceRegistry threadTraces;
+    std::vector<ThreadTraceData*> threadData;
+    LogFrame(threadTraces, threadData);
+
+    APITraceBuilder traceBuilder(threadTraces, frameStartTime);
+
+    printf("%u threads, %u calls, %ums GPU Trace collection\n", s_NumThreads, s_NumCalls, s_GPUTraceMs);
+    printf("%-36s %8.2f ms\n", "build per-thread response", TimeResponseBuild(traceBuilder, false));
+    printf("%-36s %8.2f ms\n", "build merged response", TimeResponseBuild(traceBuilder, true));
+    printf("%-36s %8.2f ms\n", "EndFrame, response built inline", TimeEndFrame(traceBuilder, false));
+    printf("%-36s %8.2f ms\n", "EndFrame, response built on worker", TimeEndFrame(traceBuilder, true));
+
+    bool bPassed = CheckMergedResponse(traceBuilder.GetPerThreadAPITraceTXT("DX12"), traceBuilder.GetMergedAPITraceTXT());
+
+    for (unsigned int threadIndex = 0; threadIndex < s_NumThreads; ++threadIndex)
+    {
+        delete threadData[threadIndex];
+    }
+
+    return bPassed ? 0 : 1;
+}
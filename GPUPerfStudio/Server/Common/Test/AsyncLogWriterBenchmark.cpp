@@ -0,0 +1,269 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Benchmark for the AsyncLogWriter. N threads each log M messages,
+///         once the way _logWrite used to, with the log mutex held while the
+///         log file is opened, appended to and closed for every message, and
+///         once through AsyncLogWriter::Write. Reports messages per second,
+///         the 99th percentile time of a logging call and the number of
+///         messages dropped because a ring was full, then the same for
+///         synchronous (logERROR) messages, which are written before Write
+///         returns. Checks that every message that wasn't dropped reached the
+///         log file after AsyncLogWriter::Shutdown, that the rings of exited
+///         threads were reused by the threads of later runs, and that a
+///         synchronous message returns when the log file can't be opened.
+///
+///         Built on Linux against the real AsyncLogWriter. The logger's file
+///         name and inter-process mutex are stood in for below:
+///         g++ -std=c++11 -O2 -D_LINUX -DLINUX -DNDEBUG -DGDT_PUBLIC -I.. -I../Linux
+///             -I../../../../CommonProjects AsyncLogWriterBenchmark.cpp
+///             ../AsyncLogWriter.cpp ../Linux/SafeCRT.cpp -lpthread
+//==============================================================================
+
+#if defined (_LINUX)
+    #include "WinDefs.h"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <AMDTOSWrappers/Include/osThread.h>
+#include "../AsyncLogWriter.h"
+#include "../Logger.h"
+
+//--------------------------------------------------------------------------
+/// The number of threads that log.
+//--------------------------------------------------------------------------
+static const unsigned int s_NumThreads = 4;
+
+//--------------------------------------------------------------------------
+/// The number of messages each thread logs in a run.
+//--------------------------------------------------------------------------
+static const unsigned int s_MessagesPerThread = 20000;
+
+//--------------------------------------------------------------------------
+/// The number of synchronous messages each thread logs.
+//--------------------------------------------------------------------------
+static const unsigned int s_SyncMessagesPerThread = 500;
+
+//--------------------------------------------------------------------------
+/// The log file written by the benchmark.
+//--------------------------------------------------------------------------
+static const char* s_LogFilename = "AsyncLogWriterBenchmark.log";
+
+//--------------------------------------------------------------------------
+/// Stands in for the inter-process log mutex.
+//--------------------------------------------------------------------------
+static std::mutex s_LogFileMutex;
+
+//--------------------------------------------------------------------------
+/// A log file that can't be opened, since its directory doesn't exist.
+//--------------------------------------------------------------------------
+static const char* s_UnwritableLogFilename = "AsyncLogWriterBenchmark.missing/AsyncLogWriterBenchmark.log";
+
+//--------------------------------------------------------------------------
+/// True to hand the writer the log file that can't be opened.
+//--------------------------------------------------------------------------
+static std::atomic<bool> s_bUseUnwritableLogFile(false);
+
+// Stand-ins for the parts of Logger.cpp that AsyncLogWriter uses.
+const char* GetLogFilename(void) { return s_bUseUnwritableLogFile ? s_UnwritableLogFilename : s_LogFilename; }
+bool LogMutexLock(void) { s_LogFileMutex.lock(); return true; }
+void LogMutexUnlock(void) { s_LogFileMutex.unlock(); }
+bool _SetupLog(const bool, const char*, const char*, int, const char*) { return false; }
+void _Log(enum LogType, const char* fmt, ...) { va_list args; va_start(args, fmt); vfprintf(stderr, fmt, args); va_end(args); }
+std::atomic<int> g_CachedLogLevel(logDEBUG);
+
+// Stand-in for AMDTOSWrappers.
+osThreadId osGetCurrentThreadId() { return (osThreadId)pthread_self(); }
+
+//--------------------------------------------------------------------------
+/// Log a message the way _logWrite used to, opening the log file for every message.
+//--------------------------------------------------------------------------
+static void WriteMessageToLogFile(const char* inMessage)
+{
+    if (LogMutexLock())
+    {
+        FILE* f = fopen(s_LogFilename, "a+");
+
+        if (f != NULL)
+        {
+            fwrite(inMessage, 1, strlen(inMessage), f);
+            fclose(f);
+        }
+
+        LogMutexUnlock();
+    }
+}
+
+//--------------------------------------------------------------------------
+/// The results of one run.
+//--------------------------------------------------------------------------
+struct RunResult
+{
+    /// Messages logged per second, across all threads.
+    double mMessagesPerSecond;
+
+    /// The 99th percentile time of a logging call, in microseconds.
+    double mP99Us;
+
+    /// The number of messages dropped because a ring was full.
+    unsigned int mNumDropped;
+};
+
+//--------------------------------------------------------------------------
+/// The ways a message can be logged.
+//--------------------------------------------------------------------------
+enum LogMethod
+{
+    LOG_DIRECT_TO_FILE,
+    LOG_ASYNC,
+    LOG_ASYNC_SYNCHRONOUS,
+};
+
+//--------------------------------------------------------------------------
+/// Log inNumMessages messages on each of s_NumThreads threads, timing every call.
+//--------------------------------------------------------------------------
+static RunResult RunBenchmark(LogMethod inMethod, unsigned int inNumMessages)
+{
+    std::vector<std::thread> threads;
+    std::vector< std::vector<double> > callTimes(s_NumThreads);
+    unsigned int numDroppedBefore = AsyncLogWriter::Instance()->GetNumDroppedMessages();
+
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+    for (unsigned int threadIndex = 0; threadIndex < s_NumThreads; threadIndex++)
+    {
+        threads.push_back(std::thread([&, threadIndex]()
+        {
+            std::vector<double>& threadCallTimes = callTimes[threadIndex];
+            threadCallTimes.reserve(inNumMessages);
+
+            for (unsigned int messageIndex = 0; messageIndex < inNumMessages; messageIndex++)
+            {
+                char message[256];
+                snprintf(message, sizeof(message), "Thread %u: ID3D12GraphicsCommandList::DrawIndexedInstanced(36, 1, 0, 0, 0) call %u\n", threadIndex, messageIndex);
+
+                std::chrono::high_resolution_clock::time_point callStart = std::chrono::high_resolution_clock::now();
+
+                if (inMethod == LOG_DIRECT_TO_FILE)
+                {
+                    WriteMessageToLogFile(message);
+                }
+                else
+                {
+                    AsyncLogWriter::Instance()->Write(message, inMethod == LOG_ASYNC_SYNCHRONOUS);
+                }
+
+                threadCallTimes.push_back(std::chrono::duration<double, std::micro>(std::chrono::high_resolution_clock::now() - callStart).count());
+            }
+        }));
+    }
+
+    for (unsigned int threadIndex = 0; threadIndex < s_NumThreads; threadIndex++)
+    {
+        threads[threadIndex].join();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    std::vector<double> allCallTimes;
+
+    for (unsigned int threadIndex = 0; threadIndex < s_NumThreads; threadIndex++)
+    {
+        allCallTimes.insert(allCallTimes.end(), callTimes[threadIndex].begin(), callTimes[threadIndex].end());
+    }
+
+    std::sort(allCallTimes.begin(), allCallTimes.end());
+
+    RunResult result;
+    result.mMessagesPerSecond = allCallTimes.size() / seconds;
+    result.mP99Us = allCallTimes[(allCallTimes.size() * 99) / 100];
+    result.mNumDropped = AsyncLogWriter::Instance()->GetNumDroppedMessages() - numDroppedBefore;
+    return result;
+}
+
+//--------------------------------------------------------------------------
+/// Count the logged messages in the log file, skipping the writer's notes about dropped messages.
+//--------------------------------------------------------------------------
+static unsigned int CountLoggedMessages()
+{
+    unsigned int numMessages = 0;
+    FILE* f = fopen(s_LogFilename, "r");
+
+    if (f != NULL)
+    {
+        char line[512];
+
+        while (fgets(line, sizeof(line), f) != NULL)
+        {
+            numMessages += (strncmp(line, "Thread ", 7) == 0) ? 1 : 0;
+        }
+
+        fclose(f);
+    }
+
+    return numMessages;
+}
+
+//--------------------------------------------------------------------------
+/// Print the results of one run.
+//--------------------------------------------------------------------------
+static void PrintResult(const char* inName, const RunResult& inResult)
+{
+    printf("%-36s %14.0f %12.2f %10u\n", inName, inResult.mMessagesPerSecond, inResult.mP99Us, inResult.mNumDropped);
+}
+
+int main()
+{
+    printf("%u hardware threads, %u logging threads\n", std::thread::hardware_concurrency(), s_NumThreads);
+    printf("%-36s %14s %12s %10s\n", "", "msgs/s", "p99 us", "dropped");
+
+    remove(s_LogFilename);
+
+    RunResult result = RunBenchmark(LOG_DIRECT_TO_FILE, s_MessagesPerThread);
+    PrintResult("open, append, close per message", result);
+
+    remove(s_LogFilename);
+
+    result = RunBenchmark(LOG_ASYNC, s_MessagesPerThread);
+    PrintResult("AsyncLogWriter", result);
+
+    // Every thread of the last run has exited, so the next drain frees their rings for the next run.
+    AsyncLogWriter::Instance()->Flush();
+
+    result = RunBenchmark(LOG_ASYNC_SYNCHRONOUS, s_SyncMessagesPerThread);
+    PrintResult("AsyncLogWriter, synchronous", result);
+
+    AsyncLogWriter::Instance()->Flush();
+
+    unsigned int numRings = AsyncLogWriter::Instance()->GetNumRings();
+    printf("%u rings for %u threads\n", numRings, s_NumThreads * 2);
+
+    // The failure to open the file is reported, and the message dropped, without waiting on the writer.
+    s_bUseUnwritableLogFile = true;
+    AsyncLogWriter::Instance()->Write("Written while the log file can't be opened\n", true);
+    s_bUseUnwritableLogFile = false;
+
+    AsyncLogWriter::Instance()->Shutdown(false);
+
+    unsigned int numLogged = s_NumThreads * (s_MessagesPerThread + s_SyncMessagesPerThread);
+    unsigned int numDropped = AsyncLogWriter::Instance()->GetNumDroppedMessages();
+    unsigned int numWritten = CountLoggedMessages();
+
+    printf("%u messages logged, %u dropped, %u in the log file\n", numLogged, numDropped, numWritten);
+
+    remove(s_LogFilename);
+
+    return ((numWritten == (numLogged - numDropped)) && (numRings <= s_NumThreads)) ? 0 : 1;
+}
@@ -0,0 +1,180 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Benchmark for BufferDelta, the way the map delta optimization uses
+///         it when an app unmaps a buffer. Changes are made to a copy of a
+///         buffer in a sparse, a dense and a clustered pattern, and the delta
+///         is calculated with each block scanner that the CPU supports:
+///         AVX2, SSE2 and the portable one. Reports the scan rate for each,
+///         checks that applying the delta to the original buffer reproduces
+///         the changed one, and checks that every scanner stores the same
+///         ranges by applying each delta to a buffer of filler bytes.
+///
+///         Built on Linux against the real BufferDelta:
+///         g++ -std=c++11 -O2 -D_LINUX -DLINUX -DNDEBUG -DGDT_PUBLIC -I.. -I../Linux
+///             -I../../../../CommonProjects BufferDeltaBenchmark.cpp ../BufferDelta.cpp
+//==============================================================================
+
+#if defined (_LINUX)
+    #include "WinDefs.h"
+#endif
+
+#include <chrono>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../BufferDelta.h"
+
+//--------------------------------------------------------------------------
+/// The size of the buffers. Not a multiple of the block size, so the tail is scanned too.
+//--------------------------------------------------------------------------
+static const size_t s_BufferSize = 16 * 1024 * 1024 + 37;
+
+//--------------------------------------------------------------------------
+/// The number of times each delta is calculated for timing.
+//--------------------------------------------------------------------------
+static const unsigned int s_NumRepeats = 20;
+
+//--------------------------------------------------------------------------
+/// The patterns that the changes are made in.
+//--------------------------------------------------------------------------
+enum ChangePattern
+{
+    PATTERN_SPARSE,     ///< 4 bytes in every 4 KB, like a few constants updated per page
+    PATTERN_DENSE,      ///< 3 bytes of every 4, like vertex data being rewritten
+    PATTERN_CLUSTERED,  ///< a run of 512 bytes in every 64 KB, like a few sub-allocations updated
+    PATTERN_COUNT,
+};
+
+//--------------------------------------------------------------------------
+/// The names of the patterns.
+//--------------------------------------------------------------------------
+static const char* s_PatternNames[PATTERN_COUNT] = { "sparse", "dense", "clustered" };
+
+//--------------------------------------------------------------------------
+/// The scanners to compare, and their names.
+//--------------------------------------------------------------------------
+static const BufferDeltaScanner s_Scanners[] = { BUFFER_DELTA_SCANNER_AVX2, BUFFER_DELTA_SCANNER_SSE2, BUFFER_DELTA_SCANNER_PORTABLE };
+static const char* s_ScannerNames[] = { "AVX2", "SSE2", "portable" };
+
+//--------------------------------------------------------------------------
+/// Change the bytes of a buffer in the given pattern.
+/// \param ioBuffer The buffer to change.
+/// \param inPattern The pattern to change the bytes in.
+//--------------------------------------------------------------------------
+static void MakeChanges(std::vector<char>& ioBuffer, ChangePattern inPattern)
+{
+    for (size_t i = 0; i < ioBuffer.size(); i++)
+    {
+        bool bChange = false;
+
+        switch (inPattern)
+        {
+            case PATTERN_SPARSE:
+            {
+                bChange = (i % 4096) >= 1000 && (i % 4096) < 1004;
+                break;
+            }
+
+            case PATTERN_DENSE:
+            {
+                bChange = (i % 4) != 3;
+                break;
+            }
+
+            case PATTERN_CLUSTERED:
+            {
+                bChange = (i % 65536) >= 20000 && (i % 65536) < 20512;
+                break;
+            }
+
+            default:
+                break;
+        }
+
+        if (bChange)
+        {
+            ioBuffer[i] = (char)~ioBuffer[i];
+        }
+    }
+
+    // always change the very last byte, which is in the partial block at the end
+    ioBuffer[ioBuffer.size() - 1] = (char)~ioBuffer[ioBuffer.size() - 1];
+}
+
+int main()
+{
+    std::vector<char> baseBuffer(s_BufferSize);
+
+    for (size_t i = 0; i < s_BufferSize; i++)
+    {
+        baseBuffer[i] = (char)((i * 2654435761u) >> 13);
+    }
+
+    printf("%u MB buffers\n", (unsigned int)(s_BufferSize / (1024 * 1024)));
+    printf("%-10s %-10s %12s %8s %16s\n", "pattern", "scanner", "GB/s", "applied", "same as first");
+
+    int result = 0;
+
+    for (int pattern = 0; pattern < PATTERN_COUNT; pattern++)
+    {
+        std::vector<char> diffBuffer(baseBuffer);
+        MakeChanges(diffBuffer, (ChangePattern)pattern);
+
+        // the first scanner's delta applied to filler bytes, which shows exactly which ranges it stored
+        std::vector<char> firstRanges;
+
+        for (unsigned int scannerIndex = 0; scannerIndex < sizeof(s_Scanners) / sizeof(s_Scanners[0]); scannerIndex++)
+        {
+            if (BufferDelta::SetScanner(s_Scanners[scannerIndex]) == false)
+            {
+                printf("%-10s %-10s %12s\n", s_PatternNames[pattern], s_ScannerNames[scannerIndex], "unsupported");
+                continue;
+            }
+
+            // one delta is reused, the way the map optimization keeps one per resource
+            BufferDelta delta;
+            delta.CalculateDelta(&baseBuffer[0], &diffBuffer[0], s_BufferSize);
+
+            std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+            for (unsigned int repeat = 0; repeat < s_NumRepeats; repeat++)
+            {
+                delta.CalculateDelta(&baseBuffer[0], &diffBuffer[0], s_BufferSize);
+            }
+
+            double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+            // applying the delta to the original buffer must give back the changed buffer
+            std::vector<char> appliedBuffer(baseBuffer);
+            delta.ApplyDelta(&appliedBuffer[0]);
+            bool bApplied = (memcmp(&appliedBuffer[0], &diffBuffer[0], s_BufferSize) == 0);
+
+            // every scanner must store the same ranges
+            std::vector<char> ranges(s_BufferSize, (char)0x5A);
+            delta.ApplyDelta(&ranges[0]);
+
+            if (firstRanges.empty())
+            {
+                firstRanges.swap(ranges);
+            }
+
+            bool bSameRanges = firstRanges.empty() || ranges.empty() || (memcmp(&firstRanges[0], &ranges[0], s_BufferSize) == 0);
+
+            printf("%-10s %-10s %12.2f %8s %16s\n", s_PatternNames[pattern], s_ScannerNames[scannerIndex],
+                   (double)s_BufferSize * s_NumRepeats / seconds / (1024.0 * 1024.0 * 1024.0), bApplied ? "ok" : "FAILED", bSameRanges ? "ok" : "FAILED");
+
+            if (bApplied == false || bSameRanges == false)
+            {
+                result = 1;
+            }
+        }
+    }
+
+    BufferDelta::SetScanner(BUFFER_DELTA_SCANNER_BEST);
+
+    return result;
+}
@@ -0,0 +1,307 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Tests for MapDeltaOptimization's POSIX page guards, driven by a test
+///         resource whose driver memory is a plain buffer. Each map is written
+///         through the guarded reflection memory by several threads at once, so
+///         the dirty pages are recorded by the real SIGSEGV handler. Every map is
+///         then played back and compared with what was written, with both delta
+///         storage modes, and once with more pages recorded than the resource
+///         holds. Returns non-zero if any check fails.
+///
+///         Built on Linux against the real MDO sources:
+///         g++ -std=c++11 -O2 -D_LINUX -DLINUX -DNDEBUG -DGDT_PUBLIC -I.. -I../Linux
+///             -I../../../../CommonProjects MapDeltaOptimizationTest.cpp
+///             ../MapDeltaOptimization/mdoAddressIndex.cpp ../MapDeltaOptimization/mdoManager.cpp
+///             ../MapDeltaOptimization/mdoResource.cpp ../MapDeltaOptimization/mdoResourceCache.cpp
+///             ../MapDeltaOptimization/mdoStats.cpp ../MapDeltaOptimization/mdoUtil.cpp
+///             ../MapDeltaOptimization/mdoVersionedStorage.cpp ../Linux/SafeCRT.cpp -lpthread
+//==============================================================================
+
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <string.h>
+
+#include "../MapDeltaOptimization/mdoManager.h"
+#include "../MapDeltaOptimization/mdoResource.h"
+#include "../MapDeltaOptimization/mdoResourceCache.h"
+
+//--------------------------------------------------------------------------
+/// The size of the test resource. Not a whole number of pages, so the last page is partly used.
+//--------------------------------------------------------------------------
+static const UINT32 s_ResourceSize = (256 * 1024) + 1000;
+
+//--------------------------------------------------------------------------
+/// The number of maps captured and played back in each run.
+//--------------------------------------------------------------------------
+static const unsigned int s_NumMaps = 40;
+
+//--------------------------------------------------------------------------
+/// The number of threads that write into each map.
+//--------------------------------------------------------------------------
+static const unsigned int s_NumWriterThreads = 4;
+
+//--------------------------------------------------------------------------
+/// The number of writes each thread makes into each map.
+//--------------------------------------------------------------------------
+static const unsigned int s_WritesPerThread = 64;
+
+//--------------------------------------------------------------------------
+/// The handle of the test resource.
+//--------------------------------------------------------------------------
+static const UINT64 s_ResHandle = 1;
+
+//--------------------------------------------------------------------------
+/// The number of checks that failed.
+//--------------------------------------------------------------------------
+static unsigned int s_NumFailures = 0;
+
+//--------------------------------------------------------------------------
+/// True once the test is playing back the captured maps.
+//--------------------------------------------------------------------------
+static bool s_bPlayback = false;
+
+// Stand-in for the part of Linux/OSWrappers.cpp that MdoUtil uses.
+void OutputDebugString(const char* lpOutputString) { fputs(lpOutputString, stderr); }
+
+//--------------------------------------------------------------------------
+/// Report a failed check, without stopping the test.
+//--------------------------------------------------------------------------
+#define CHECK(condition)                                                        \
+    if (!(condition))                                                           \
+    {                                                                           \
+        printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #condition);  \
+        s_NumFailures++;                                                        \
+    }
+
+//--------------------------------------------------------------------------
+/// A resource whose driver memory is a plain buffer.
+//--------------------------------------------------------------------------
+class TestMdoResource : public MdoResource
+{
+public:
+    //--------------------------------------------------------------------------
+    /// Constructor.
+    //--------------------------------------------------------------------------
+    TestMdoResource(void* pDevice, UINT64 resHandle, const MdoConfig& mdoConfig)
+        : mDriverMem(s_ResourceSize, 0)
+    {
+        m_createInfo.resHandle = resHandle;
+        m_createInfo.pDevice = pDevice;
+        m_createInfo.mdoConfig = mdoConfig;
+        m_size = s_ResourceSize;
+
+        NewReflectionData();
+    }
+
+    virtual bool Map(const MdoResMapInfo& mapInfo, void** pMappedPtr)
+    {
+        UNREFERENCED_PARAMETER(mapInfo);
+        *pMappedPtr = &mDriverMem[0];
+        return true;
+    }
+
+    virtual bool Unmap() { return true; }
+    virtual bool RunMdoCaptureWork() { return (s_bPlayback == false); }
+    virtual bool RunMdoPlaybackWork() { return s_bPlayback; }
+
+    //--------------------------------------------------------------------------
+    /// Return the memory the played back maps are written to.
+    //--------------------------------------------------------------------------
+    unsigned char* GetDriverMem() { return &mDriverMem[0]; }
+
+    //--------------------------------------------------------------------------
+    /// Return the dirty pages tracked for the map being captured.
+    //--------------------------------------------------------------------------
+    const DataChunks& GetCaptureDirtyPages() { return m_mapData[m_captureMapId].dirtyPages; }
+
+private:
+    /// Stands in for the memory the driver maps.
+    std::vector<unsigned char> mDriverMem;
+};
+
+//--------------------------------------------------------------------------
+/// A resource cache that makes TestMdoResources.
+//--------------------------------------------------------------------------
+class TestMdoResourceCache : public MdoResourceCache
+{
+public:
+    //--------------------------------------------------------------------------
+    /// Constructor.
+    //--------------------------------------------------------------------------
+    explicit TestMdoResourceCache(const MdoConfig& mdoConfig) { Init(mdoConfig); }
+
+protected:
+    virtual MdoResource* RegisterResource(void* pDevice, UINT64 resHandle)
+    {
+        TestMdoResource* pResource = new TestMdoResource(pDevice, resHandle, m_mdoConfig);
+        m_resourceList[resHandle] = pResource;
+        return pResource;
+    }
+};
+
+//--------------------------------------------------------------------------
+/// A manager that uses a TestMdoResourceCache.
+//--------------------------------------------------------------------------
+class TestMdoManager : public MdoManager
+{
+public:
+    //--------------------------------------------------------------------------
+    /// Constructor.
+    //--------------------------------------------------------------------------
+    TestMdoManager() : mbInitialized(false) { }
+
+    //--------------------------------------------------------------------------
+    /// Install the signal handler and make the resource cache.
+    //--------------------------------------------------------------------------
+    bool Start(const MdoConfig& mdoConfig)
+    {
+        mbInitialized = Init(mdoConfig);
+        return mbInitialized;
+    }
+
+    virtual MdoResourceCache* CreateResourceCache(const MdoConfig& mdoConfig)
+    {
+        return new TestMdoResourceCache(mdoConfig);
+    }
+
+private:
+    /// True if Init succeeded.
+    bool mbInitialized;
+};
+
+//--------------------------------------------------------------------------
+/// A small deterministic random number generator, so every writer thread has its own.
+//--------------------------------------------------------------------------
+static unsigned int NextRandom(unsigned int& ioSeed)
+{
+    ioSeed = (ioSeed * 1103515245u) + 12345u;
+    return ioSeed >> 8;
+}
+
+//--------------------------------------------------------------------------
+/// Write random bytes into a thread's share of the mapped memory.
+//--------------------------------------------------------------------------
+static void WriteShare(unsigned char* pMapped, unsigned int inThreadIndex, unsigned int inSeed)
+{
+    const UINT32 shareSize = s_ResourceSize / s_NumWriterThreads;
+    const UINT32 shareBegin = shareSize * inThreadIndex;
+    const UINT32 shareEnd = (inThreadIndex == s_NumWriterThreads - 1) ? s_ResourceSize : shareBegin + shareSize;
+    unsigned int seed = inSeed;
+
+    for (unsigned int i = 0; i < s_WritesPerThread; i++)
+    {
+        const UINT32 offset = shareBegin + (NextRandom(seed) % (shareEnd - shareBegin));
+        const UINT32 length = 1 + (NextRandom(seed) % 64);
+
+        for (UINT32 byte = offset; (byte < offset + length) && (byte < shareEnd); byte++)
+        {
+            pMapped[byte] = (unsigned char)NextRandom(seed);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Capture s_NumMaps maps, each written by several threads through the guarded
+/// memory, then play them back and check each one matches what was written.
+/// \param inDeltaStorage The delta storage mode to test.
+/// \param inbOverflow Record more pages than the resource holds in every map, so it's treated as fully dirty.
+//--------------------------------------------------------------------------
+static void RunCaptureAndPlayback(MdoDeltaStorage inDeltaStorage, bool inbOverflow)
+{
+    MdoConfig mdoConfig = {};
+    mdoConfig.deltaStorage = inDeltaStorage;
+
+    // Never deleted, since the signal handler keeps using the last manager that was started
+    TestMdoManager* pManager = new TestMdoManager();
+    CHECK(pManager->Start(mdoConfig));
+
+    int device = 0;
+    std::vector<std::vector<unsigned char> > writtenMaps(s_NumMaps);
+    TestMdoResource* pResource = nullptr;
+    const UINT32 pageSize = MdoUtil::GetPageSize();
+
+    s_bPlayback = false;
+
+    for (unsigned int mapIndex = 0; mapIndex < s_NumMaps; mapIndex++)
+    {
+        MdoResMapInfo mapInfo = {};
+        mapInfo.resHandle = s_ResHandle;
+
+        // Stands in for the pointer the driver's map returned
+        void* pMapped = &device;
+        CHECK(pManager->Capture_PostResourceMap(&device, mapInfo, &pMapped));
+
+        pResource = static_cast<TestMdoResource*>(MdoResourceCache::Instance()->GetMdoResource(s_ResHandle, nullptr, false));
+        CHECK(pResource != nullptr);
+
+        if (pResource == nullptr)
+        {
+            return;
+        }
+
+        CHECK(pMapped == pResource->GetReflectionData()->pNewData);
+
+        if (inbOverflow)
+        {
+            DataChunk page = { 0, pageSize, nullptr };
+
+            for (UINT32 i = 0; i < (s_ResourceSize / pageSize) + 8; i++)
+            {
+                pResource->RecordDirtyPage(page);
+            }
+        }
+
+        std::vector<std::thread> writers;
+
+        for (unsigned int threadIndex = 0; threadIndex < s_NumWriterThreads; threadIndex++)
+        {
+            writers.push_back(std::thread(WriteShare, (unsigned char*)pMapped, threadIndex, (mapIndex * 977) + threadIndex));
+        }
+
+        for (unsigned int threadIndex = 0; threadIndex < writers.size(); threadIndex++)
+        {
+            writers[threadIndex].join();
+        }
+
+        writtenMaps[mapIndex].assign((unsigned char*)pMapped, (unsigned char*)pMapped + s_ResourceSize);
+
+        CHECK(pManager->Capture_PreResourceUnmap(s_ResHandle));
+
+        // Each write that landed on a guarded page recorded it, or the whole resource is dirty
+        const DataChunks& dirtyPages = pResource->GetCaptureDirtyPages();
+        CHECK(dirtyPages.empty() == false);
+
+        if (inbOverflow)
+        {
+            CHECK((dirtyPages.size() == 1) && (dirtyPages[0].offset == 0) && (dirtyPages[0].size == s_ResourceSize));
+        }
+        else
+        {
+            CHECK(dirtyPages.size() <= (s_ResourceSize / pageSize) + 2);
+        }
+    }
+
+    s_bPlayback = true;
+
+    for (unsigned int mapIndex = 0; mapIndex < s_NumMaps; mapIndex++)
+    {
+        memset(pResource->GetDriverMem(), 0xcd, s_ResourceSize);
+
+        CHECK(pManager->Playback_PostResourceMap(s_ResHandle));
+        CHECK(memcmp(pResource->GetDriverMem(), &writtenMaps[mapIndex][0], s_ResourceSize) == 0);
+    }
+}
+
+int main()
+{
+    RunCaptureAndPlayback(MDO_DELTA_STORAGE_PER_MAP, false);
+    RunCaptureAndPlayback(MDO_DELTA_STORAGE_PER_BYTE, false);
+    RunCaptureAndPlayback(MDO_DELTA_STORAGE_PER_MAP, true);
+
+    printf("%u checks failed\n", s_NumFailures);
+
+    return (s_NumFailures == 0) ? 0 : 1;
+}
@@ -0,0 +1,593 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Load generator for the NetConnectionManager. N client threads each
+///         send M requests to a NetConnectionManager that is polled on its own
+///         thread and answers every request with a small XML response. The
+///         requests are sent once the way the web server used to be talked
+///         to, with a new connection for every request, then over one
+///         keep-alive connection per client, one request at a time, and then
+///         pipelined several requests deep. Reports requests per second and
+///         the most connections that were open at once, for a few clients and
+///         for hundreds of them, and checks that every response arrives intact
+///         and in order. Then 1 MB responses are sent from another thread, the
+///         way the server sends them, either from memory or from a file, which
+///         the manager queues by reference and sends with sendfile, and
+///         a client that disconnects before its responses are sent checks that
+///         the sending thread isn't left waiting.
+///
+///         Built on Linux against the real NetConnectionManager and NetSocket.
+///         The logger and the AMDTOSWrappers functions they use are stood in
+///         for below:
+///         g++ -std=c++11 -O2 -D_LINUX -DLINUX -DNDEBUG -DGDT_PUBLIC -I.. -I../Linux
+///             -I../../../../CommonProjects NetConnectionManagerLoadBenchmark.cpp
+///             ../NetConnectionManager.cpp ../NetSocket.cpp ../Linux/SafeCRT.cpp -lpthread
+//==============================================================================
+
+#if defined (_LINUX)
+    #include "WinDefs.h"
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <string>
+#include <thread>
+#include <vector>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+#include <AMDTOSWrappers/Include/osSystemError.h>
+#include <AMDTOSWrappers/Include/osTime.h>
+#include <AMDTOSWrappers/Include/osPortAddress.h>
+#include "../Logger.h"
+#include "../NetConnectionManager.h"
+
+//--------------------------------------------------------------------------
+/// The first port that the benchmark tries to listen on.
+//--------------------------------------------------------------------------
+static const u_short s_FirstPort = 28760;
+
+//--------------------------------------------------------------------------
+/// How long the polling thread waits for activity before it checks whether it should stop.
+//--------------------------------------------------------------------------
+static const int s_PollTimeoutMs = 50;
+
+//--------------------------------------------------------------------------
+/// The response to every request; about the size of a small XML command response.
+//--------------------------------------------------------------------------
+static const char* s_ResponseBody = "<?xml version='1.0' encoding='UTF-8' standalone='yes' ?>"
+                                    "<XML src='/12345/DX12/FrameDebugger/DrawCall/Index.xml'>42</XML>";
+
+//--------------------------------------------------------------------------
+/// The size of the large responses, which are well over the size that is copied.
+//--------------------------------------------------------------------------
+static const size_t s_LargeResponseSize = 1024 * 1024;
+
+//--------------------------------------------------------------------------
+/// The body of every large response.
+//--------------------------------------------------------------------------
+static std::string s_LargeResponseBody;
+
+// Stand-ins for the parts of Logger.cpp that NetConnectionManager and NetSocket use.
+bool _SetupLog(const bool, const char*, const char*, int, const char*) { return false; }
+void _Log(enum LogType, const char* fmt, ...) { va_list args; va_start(args, fmt); vfprintf(stderr, fmt, args); va_end(args); }
+std::atomic<int> g_CachedLogLevel(logERROR);
+
+// Stand-ins for AMDTOSWrappers and AMDTBaseTools.
+osSystemErrorCode osGetLastSystemError() { return errno; }
+void osTimeValFromMilliseconds(long milliseconds, struct timeval& timeVal) { timeVal.tv_sec = milliseconds / 1000; timeVal.tv_usec = (milliseconds % 1000) * 1000; }
+bool osPortAddress::asSockaddr(sockaddr_in&, bool) const { return false; }
+extern "C" void gtTriggerAssertonFailureHandler(const char*, const char*, int, const wchar_t*) { }
+
+//--------------------------------------------------------------------------
+/// Answers small requests straight away, from the polling thread, passes
+/// requests for large responses to a responder thread, and keeps track of
+/// the most connections that were open at once.
+//--------------------------------------------------------------------------
+class BenchmarkRequestHandler : public INetRequestHandler
+{
+public:
+    BenchmarkRequestHandler() : mMaxConnections(0) {}
+
+    virtual void OnRequest(NetConnectionManager& inManager, const NetRequest& inRequest)
+    {
+        if (inRequest.mHeader.find("/Large") != std::string::npos)
+        {
+            ScopeLock lock(mLargeRequestsLock);
+            mLargeRequests.push_back(inRequest);
+            return;
+        }
+
+        inManager.SendResponse(inRequest, 200, "text/xml", s_ResponseBody, strlen(s_ResponseBody));
+
+        unsigned int numConnections = inManager.GetNumConnections();
+
+        if (numConnections > mMaxConnections.load(std::memory_order_relaxed))
+        {
+            mMaxConnections.store(numConnections, std::memory_order_relaxed);
+        }
+    }
+
+    /// The most connections that were open when a request was handled.
+    std::atomic<unsigned int> mMaxConnections;
+
+    /// Requests for large responses, waiting for the responder thread.
+    std::deque<NetRequest> mLargeRequests;
+
+    /// Protects mLargeRequests.
+    mutex mLargeRequestsLock;
+};
+
+//--------------------------------------------------------------------------
+/// Answer requests for large responses until told to stop, from memory or
+/// from a file, depending on the request. Runs on its own thread, as the
+/// server's responses do.
+/// \param outNumAnswered Counts the requests that have been answered.
+//--------------------------------------------------------------------------
+static void RunResponder(NetConnectionManager& inManager, BenchmarkRequestHandler& inHandler, FILE* inFile, std::atomic<bool>& inbStop, std::atomic<unsigned int>& outNumAnswered)
+{
+    for (;;)
+    {
+        NetRequest request;
+        bool bHaveRequest = false;
+
+        {
+            ScopeLock lock(inHandler.mLargeRequestsLock);
+
+            if (inHandler.mLargeRequests.empty() == false)
+            {
+                request = inHandler.mLargeRequests.front();
+                inHandler.mLargeRequests.pop_front();
+                bHaveRequest = true;
+            }
+        }
+
+        if (bHaveRequest == false)
+        {
+            if (inbStop.load())
+            {
+                return;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            continue;
+        }
+
+        char header[256];
+        int headerSize = snprintf(header, sizeof(header), "HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\nContent-Length: %zu\r\n\r\n", s_LargeResponseSize);
+
+        if (request.mHeader.find("/LargeFile") != std::string::npos)
+        {
+            NetSocket::SendBuffer buffer = { header, (size_t)headerSize };
+            inManager.SendResponseData(request, &buffer, 1, inFile, s_LargeResponseSize, true);
+        }
+        else
+        {
+            // the body is a separate piece, large enough to be queued by reference
+            NetSocket::SendBuffer buffers[] = { { header, (size_t)headerSize }, { s_LargeResponseBody.data(), s_LargeResponseBody.size() } };
+            inManager.SendResponseData(request, buffers, 2, NULL, 0, true);
+        }
+
+        outNumAnswered++;
+    }
+}
+
+//--------------------------------------------------------------------------
+/// The ways the clients can send their requests.
+//--------------------------------------------------------------------------
+enum ClientMethod
+{
+    CLIENT_CONNECTION_PER_REQUEST,
+    CLIENT_KEEP_ALIVE,
+    CLIENT_PIPELINED,
+};
+
+//--------------------------------------------------------------------------
+/// How many requests a pipelining client sends before it reads the responses.
+//--------------------------------------------------------------------------
+static const unsigned int s_PipelineDepth = 16;
+
+//--------------------------------------------------------------------------
+/// Open a connection to the benchmark's server.
+/// \returns The socket, or -1 if it couldn't connect.
+//--------------------------------------------------------------------------
+static int ConnectToServer(u_short inPort)
+{
+    int socketFD = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (socketFD == -1)
+    {
+        return -1;
+    }
+
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(inPort);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    if (connect(socketFD, (sockaddr*)&address, sizeof(address)) == -1)
+    {
+        close(socketFD);
+        return -1;
+    }
+
+    int noDelay = 1;
+    setsockopt(socketFD, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+    return socketFD;
+}
+
+//--------------------------------------------------------------------------
+/// Send all of a string on a socket.
+/// \returns True if it was all sent.
+//--------------------------------------------------------------------------
+static bool SendAll(int inSocket, const std::string& inData)
+{
+    size_t offset = 0;
+
+    while (offset < inData.size())
+    {
+        ssize_t numSent = send(inSocket, inData.data() + offset, inData.size() - offset, MSG_NOSIGNAL);
+
+        if (numSent <= 0 && errno != EINTR)
+        {
+            return false;
+        }
+
+        offset += (numSent > 0) ? numSent : 0;
+    }
+
+    return true;
+}
+
+//--------------------------------------------------------------------------
+/// Read one response from a connection, keeping anything received after it.
+/// \param inSocket The connection.
+/// \param ioReceived Data that has been received but not read yet.
+/// \returns True if a complete response with the expected body was read.
+//--------------------------------------------------------------------------
+static bool ReadResponse(int inSocket, std::string& ioReceived, const std::string& inExpectedBody)
+{
+    size_t bodySize = inExpectedBody.size();
+
+    for (;;)
+    {
+        size_t headerEnd = ioReceived.find("\r\n\r\n");
+
+        if (headerEnd != std::string::npos && ioReceived.size() >= headerEnd + 4 + bodySize)
+        {
+            bool bIntact = (ioReceived.compare(0, 15, "HTTP/1.1 200 OK") == 0) &&
+                           (ioReceived.compare(headerEnd + 4, bodySize, inExpectedBody) == 0);
+
+            ioReceived.erase(0, headerEnd + 4 + bodySize);
+            return bIntact;
+        }
+
+        char buffer[64 * 1024];
+        ssize_t numReceived = recv(inSocket, buffer, sizeof(buffer), 0);
+
+        if (numReceived > 0)
+        {
+            ioReceived.append(buffer, numReceived);
+        }
+        else if (numReceived == 0 || errno != EINTR)
+        {
+            return false;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Send inNumRequests requests the given way, and read their responses.
+/// \returns The number of responses that arrived intact.
+//--------------------------------------------------------------------------
+static unsigned int RunClient(ClientMethod inMethod, u_short inPort, unsigned int inNumRequests)
+{
+    const std::string keepAliveRequest = "GET /12345/DX12/FrameDebugger/DrawCall/Index.xml HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n";
+    const std::string closeRequest = "GET /12345/DX12/FrameDebugger/DrawCall/Index.xml HTTP/1.1\r\nHost: 127.0.0.1\r\nConnection: close\r\n\r\n";
+    const std::string expectedBody = s_ResponseBody;
+    unsigned int numIntact = 0;
+    std::string received;
+
+    if (inMethod == CLIENT_CONNECTION_PER_REQUEST)
+    {
+        for (unsigned int requestIndex = 0; requestIndex < inNumRequests; requestIndex++)
+        {
+            int socketFD = ConnectToServer(inPort);
+
+            if (socketFD == -1)
+            {
+                continue;
+            }
+
+            received.clear();
+
+            if (SendAll(socketFD, closeRequest) && ReadResponse(socketFD, received, expectedBody))
+            {
+                numIntact++;
+            }
+
+            close(socketFD);
+        }
+
+        return numIntact;
+    }
+
+    int socketFD = ConnectToServer(inPort);
+
+    if (socketFD == -1)
+    {
+        return 0;
+    }
+
+    unsigned int depth = (inMethod == CLIENT_PIPELINED) ? s_PipelineDepth : 1;
+    std::string requests;
+
+    for (unsigned int i = 0; i < depth; i++)
+    {
+        requests += keepAliveRequest;
+    }
+
+    for (unsigned int requestIndex = 0; requestIndex < inNumRequests; requestIndex += depth)
+    {
+        if (SendAll(socketFD, requests) == false)
+        {
+            break;
+        }
+
+        for (unsigned int i = 0; i < depth; i++)
+        {
+            numIntact += ReadResponse(socketFD, received, expectedBody) ? 1 : 0;
+        }
+    }
+
+    close(socketFD);
+    return numIntact;
+}
+
+//--------------------------------------------------------------------------
+/// Request inNumRequests large responses over one keep-alive connection, a
+/// few at a time, and read them.
+/// \param inPort The server's port.
+/// \param inbFromFile True to request responses that are sent from a file.
+/// \param inNumRequests The number of responses to request.
+/// \returns The number of responses that arrived intact.
+//--------------------------------------------------------------------------
+static unsigned int RunLargeClient(u_short inPort, bool inbFromFile, unsigned int inNumRequests)
+{
+    const std::string request = inbFromFile ? "GET /LargeFile HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n" : "GET /LargeMemory HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n";
+    const unsigned int depth = 4;
+    unsigned int numIntact = 0;
+    std::string received;
+
+    int socketFD = ConnectToServer(inPort);
+
+    if (socketFD == -1)
+    {
+        return 0;
+    }
+
+    for (unsigned int requestIndex = 0; requestIndex < inNumRequests; requestIndex += depth)
+    {
+        std::string requests;
+
+        for (unsigned int i = 0; i < depth; i++)
+        {
+            requests += request;
+        }
+
+        if (SendAll(socketFD, requests) == false)
+        {
+            break;
+        }
+
+        for (unsigned int i = 0; i < depth; i++)
+        {
+            numIntact += ReadResponse(socketFD, received, s_LargeResponseBody) ? 1 : 0;
+        }
+    }
+
+    close(socketFD);
+    return numIntact;
+}
+
+//--------------------------------------------------------------------------
+/// The results of one run.
+//--------------------------------------------------------------------------
+struct RunResult
+{
+    /// Requests answered per second, across all clients.
+    double mRequestsPerSecond;
+
+    /// The number of responses that didn't arrive intact.
+    unsigned int mNumFailed;
+};
+
+//--------------------------------------------------------------------------
+/// Run inNumClients clients at once, each sending inRequestsPerClient requests.
+//--------------------------------------------------------------------------
+static RunResult RunBenchmark(ClientMethod inMethod, u_short inPort, unsigned int inNumClients, unsigned int inRequestsPerClient)
+{
+    std::vector<std::thread> clients;
+    std::atomic<unsigned int> numIntact(0);
+
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+    for (unsigned int clientIndex = 0; clientIndex < inNumClients; clientIndex++)
+    {
+        clients.push_back(std::thread([&]()
+        {
+            numIntact += RunClient(inMethod, inPort, inRequestsPerClient);
+        }));
+    }
+
+    for (unsigned int clientIndex = 0; clientIndex < inNumClients; clientIndex++)
+    {
+        clients[clientIndex].join();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    RunResult result;
+    result.mRequestsPerSecond = numIntact.load() / seconds;
+    result.mNumFailed = (inNumClients * inRequestsPerClient) - numIntact.load();
+    return result;
+}
+
+int main()
+{
+    BenchmarkRequestHandler handler;
+    NetConnectionManager manager(&handler);
+    u_short port = s_FirstPort;
+
+    while (manager.Listen(port) == false)
+    {
+        if (++port == s_FirstPort + 16)
+        {
+            printf("error: couldn't listen on any port from %u\n", s_FirstPort);
+            return 1;
+        }
+    }
+
+    for (size_t i = 0; i < s_LargeResponseSize; i++)
+    {
+        s_LargeResponseBody += (char)('a' + (i * 7919) % 26);
+    }
+
+    FILE* largeResponseFile = tmpfile();
+
+    if (largeResponseFile == NULL || fwrite(s_LargeResponseBody.data(), 1, s_LargeResponseSize, largeResponseFile) != s_LargeResponseSize || fflush(largeResponseFile) != 0)
+    {
+        printf("error: couldn't write the large response file\n");
+        return 1;
+    }
+
+    std::atomic<bool> bStop(false);
+    std::thread poller([&]()
+    {
+        while (bStop.load() == false && manager.Poll(s_PollTimeoutMs))
+        {
+        }
+    });
+
+    std::atomic<unsigned int> numLargeAnswered(0);
+    std::thread responder([&]()
+    {
+        RunResponder(manager, handler, largeResponseFile, bStop, numLargeAnswered);
+    });
+
+    printf("%u hardware threads, listening on port %u\n", std::thread::hardware_concurrency(), port);
+    printf("%-32s %8s %14s %16s %8s\n", "", "clients", "requests/s", "max connections", "failed");
+
+    static const unsigned int s_NumClients[] = { 4, 256 };
+    static const unsigned int s_RequestsPerClient[] = { 4096, 256 };
+    static const char* s_MethodNames[] = { "connection per request", "keep-alive", "keep-alive, pipelined 16 deep" };
+    int result = 0;
+
+    for (unsigned int clientsIndex = 0; clientsIndex < sizeof(s_NumClients) / sizeof(s_NumClients[0]); clientsIndex++)
+    {
+        for (int method = CLIENT_CONNECTION_PER_REQUEST; method <= CLIENT_PIPELINED; method++)
+        {
+            handler.mMaxConnections.store(0);
+
+            RunResult runResult = RunBenchmark((ClientMethod)method, port, s_NumClients[clientsIndex], s_RequestsPerClient[clientsIndex]);
+
+            printf("%-32s %8u %14.0f %16u %8u\n", s_MethodNames[method], s_NumClients[clientsIndex], runResult.mRequestsPerSecond,
+                   handler.mMaxConnections.load(), runResult.mNumFailed);
+
+            if (runResult.mNumFailed > 0)
+            {
+                result = 1;
+            }
+        }
+    }
+
+    printf("\n%-32s %8s %14s %16s %8s\n", "1 MB responses", "clients", "MB/s", "", "failed");
+
+    static const unsigned int s_NumLargeClients = 4;
+    static const unsigned int s_LargeRequestsPerClient = 64;
+    static const char* s_SourceNames[] = { "from memory, by reference", "from a file, with sendfile" };
+
+    for (int source = 0; source < 2; source++)
+    {
+        std::vector<std::thread> clients;
+        std::atomic<unsigned int> numIntact(0);
+
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+        for (unsigned int clientIndex = 0; clientIndex < s_NumLargeClients; clientIndex++)
+        {
+            clients.push_back(std::thread([&]()
+            {
+                numIntact += RunLargeClient(port, source == 1, s_LargeRequestsPerClient);
+            }));
+        }
+
+        for (unsigned int clientIndex = 0; clientIndex < s_NumLargeClients; clientIndex++)
+        {
+            clients[clientIndex].join();
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        unsigned int numFailed = (s_NumLargeClients * s_LargeRequestsPerClient) - numIntact.load();
+
+        printf("%-32s %8u %14.0f %16s %8u\n", s_SourceNames[source], s_NumLargeClients, numIntact.load() * (s_LargeResponseSize / (1024.0 * 1024.0)) / seconds, "", numFailed);
+
+        if (numFailed > 0)
+        {
+            result = 1;
+        }
+    }
+
+    // A client that goes away before reading its responses mustn't leave the responder waiting.
+    unsigned int numAnsweredBefore = numLargeAnswered.load();
+    int abandonedSocket = ConnectToServer(port);
+    static const unsigned int s_NumAbandonedRequests = 8;
+
+    if (abandonedSocket != -1)
+    {
+        std::string requests;
+
+        for (unsigned int i = 0; i < s_NumAbandonedRequests; i++)
+        {
+            requests += "GET /LargeMemory HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n";
+        }
+
+        SendAll(abandonedSocket, requests);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        close(abandonedSocket);
+    }
+
+    // Every abandoned request should be answered, or given up on, promptly.
+    for (int waitMs = 0; waitMs < 5000 && numLargeAnswered.load() - numAnsweredBefore < s_NumAbandonedRequests; waitMs += 10)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    bool bAbandonedAnswered = (abandonedSocket != -1) && (numLargeAnswered.load() - numAnsweredBefore == s_NumAbandonedRequests);
+
+    bStop.store(true);
+    responder.join();
+    poller.join();
+    fclose(largeResponseFile);
+
+    printf("%-32s %s\n", "client disconnected mid-response", bAbandonedAnswered ? "responder released" : "FAILED");
+
+    if (bAbandonedAnswered == false)
+    {
+        result = 1;
+    }
+
+    return result;
+}
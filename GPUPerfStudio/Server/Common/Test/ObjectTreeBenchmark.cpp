@@ -0,0 +1,331 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Benchmark for building the object tree response. Compares the old
+///         build, which scanned the whole object database once for every
+///         device and type, against the per-device, per-type lists kept by
+///         ObjectTreeIndex. Measures a build from scratch, and a rebuild after
+///         a handful of objects were created, where the index only formats
+///         the new instances.
+///
+///         Built on Linux against the real ObjectTreeIndex, IInstanceBase and
+///         XML helpers:
+///         g++ -std=c++11 -O2 -D_LINUX -DLINUX -DNDEBUG -DGDT_PUBLIC -I.. -I../Linux
+///             -I../../../../CommonProjects ObjectTreeBenchmark.cpp ../ObjectTreeIndex.cpp
+///             ../xml.cpp ../../../../CommonProjects/AMDTBaseTools/src/gtASCIIString.cpp
+//==============================================================================
+
+#if defined (_LINUX)
+    #include "WinDefs.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../IInstanceBase.h"
+#include "../ObjectTreeIndex.h"
+
+// Stand-in for the part of misc.cpp that the XML helpers use.
+gtASCIIString FormatText(const char* fmt, ...)
+{
+    char str[10240];
+    va_list arg_ptr;
+
+    va_start(arg_ptr, fmt);
+    vsnprintf(str, sizeof(str), fmt, arg_ptr);
+    va_end(arg_ptr);
+
+    return str;
+}
+
+// Stand-in for AMDTBaseTools.
+extern "C" void gtTriggerAssertonFailureHandler(const char*, const char*, int, const wchar_t*) { }
+
+//--------------------------------------------------------------------------
+/// The number of devices that objects are created under.
+//--------------------------------------------------------------------------
+static const unsigned int s_NumDevices = 2;
+
+//--------------------------------------------------------------------------
+/// The number of object types, including the device type.
+//--------------------------------------------------------------------------
+static const int s_NumTypes = 24;
+
+//--------------------------------------------------------------------------
+/// The number of objects in the database when the tree is first built.
+//--------------------------------------------------------------------------
+static const unsigned int s_NumObjects = 100000;
+
+//--------------------------------------------------------------------------
+/// The number of objects created between two requests for the tree.
+//--------------------------------------------------------------------------
+static const unsigned int s_NumNewObjects = 100;
+
+//--------------------------------------------------------------------------
+/// The number of builds to time for each measurement.
+//--------------------------------------------------------------------------
+static const unsigned int s_NumBuilds = 5;
+
+//--------------------------------------------------------------------------
+/// The device type. Devices are the roots of the tree, not children.
+//--------------------------------------------------------------------------
+static const int s_DeviceType = 0;
+
+//--------------------------------------------------------------------------
+/// A wrapped object in the object database. Only the parts of IInstanceBase
+/// that the object tree uses do any work.
+//--------------------------------------------------------------------------
+class BenchmarkInstance : public IInstanceBase
+{
+public:
+    //--------------------------------------------------------------------------
+    /// Constructor.
+    /// \param inType The object's type.
+    /// \param inParentDevice The application handle of the device that created the object.
+    //--------------------------------------------------------------------------
+    BenchmarkInstance(int inType, void* inParentDevice)
+        : mType(inType)
+        , mParentDevice(inParentDevice)
+    {
+        snprintf(mTypeName, sizeof(mTypeName), "ObjectType%d", inType);
+    }
+
+    virtual eObjectType GetObjectType() const { return (eObjectType)mType; }
+
+    virtual const char* GetTypeAsString() const { return mTypeName; }
+
+    virtual void* GetParentDeviceHandle() const { return mParentDevice; }
+
+    virtual void* GetApplicationHandle() const { return (void*)this; }
+
+    virtual void PrintFormattedApplicationHandle(gtASCIIString& outHandleString) const
+    {
+        outHandleString.appendFormattedString("0x%p", GetApplicationHandle());
+    }
+
+    virtual void AppendCreateInfoXML(gtASCIIString& outCreateInfoXML) const { (void)outCreateInfoXML; }
+
+    virtual bool AppendTagDataXML(gtASCIIString& outTagDataString) const { (void)outTagDataString; return false; }
+
+private:
+    /// The object's type.
+    int mType;
+
+    /// The application handle of the device that created the object.
+    void* mParentDevice;
+
+    /// The name of the object's type.
+    char mTypeName[32];
+};
+
+//--------------------------------------------------------------------------
+/// Append an instance's handle, the way the object database processor did.
+//--------------------------------------------------------------------------
+static void AppendHandle(const IInstanceBase* inInstance, gtASCIIString& ioString)
+{
+    gtASCIIString handleString;
+    inInstance->PrintFormattedApplicationHandle(handleString);
+    ioString.append(handleString);
+
+    if (inInstance->IsDestroyed())
+    {
+        ioString.append("|d");
+    }
+}
+
+//--------------------------------------------------------------------------
+/// The old build: for each device and type, collect every object of that type from the
+/// whole database, then keep the ones created under the device.
+//--------------------------------------------------------------------------
+static gtASCIIString BuildByScanning(const std::vector<IInstanceBase*>& inDatabase, const std::vector<IInstanceBase*>& inDevices)
+{
+    gtASCIIString devicesXml;
+
+    for (size_t deviceIndex = 0; deviceIndex < inDevices.size(); ++deviceIndex)
+    {
+        gtASCIIString deviceObjectXml;
+
+        for (int objectType = 0; objectType < s_NumTypes; ++objectType)
+        {
+            if (objectType == s_DeviceType)
+            {
+                continue;
+            }
+
+            // GetObjectsByType
+            std::vector<IInstanceBase*> objectsOfType;
+
+            for (size_t objectIndex = 0; objectIndex < inDatabase.size(); ++objectIndex)
+            {
+                if (inDatabase[objectIndex]->GetObjectType() == objectType)
+                {
+                    objectsOfType.push_back(inDatabase[objectIndex]);
+                }
+            }
+
+            if (objectsOfType.empty() == false)
+            {
+                gtASCIIString instancesString;
+
+                for (size_t instanceIndex = 0; instanceIndex < objectsOfType.size(); ++instanceIndex)
+                {
+                    if (objectsOfType[instanceIndex]->GetParentDeviceHandle() == inDevices[deviceIndex]->GetApplicationHandle())
+                    {
+                        if (instancesString.isEmpty() == false)
+                        {
+                            instancesString.append(",");
+                        }
+
+                        AppendHandle(objectsOfType[instanceIndex], instancesString);
+                    }
+                }
+
+                deviceObjectXml += XML(objectsOfType[0]->GetTypeAsString(), instancesString.asCharArray());
+            }
+        }
+
+        devicesXml += XML("Device", deviceObjectXml.asCharArray());
+    }
+
+    return XML("Objects", devicesXml.asCharArray());
+}
+
+//--------------------------------------------------------------------------
+/// Build the tree from the index, the way the object database processor does.
+//--------------------------------------------------------------------------
+static gtASCIIString BuildFromIndex(ObjectTreeIndex& inIndex, const std::vector<IInstanceBase*>& inDevices)
+{
+    gtASCIIString devicesXml;
+
+    for (size_t deviceIndex = 0; deviceIndex < inDevices.size(); ++deviceIndex)
+    {
+        gtASCIIString deviceObjectXml;
+        inIndex.AppendDeviceObjectXML(inDevices[deviceIndex]->GetApplicationHandle(), s_DeviceType, deviceObjectXml);
+        devicesXml += XML("Device", deviceObjectXml.asCharArray());
+    }
+
+    return XML("Objects", devicesXml.asCharArray());
+}
+
+//--------------------------------------------------------------------------
+/// Create an object of a random type under a random device.
+//--------------------------------------------------------------------------
+static IInstanceBase* CreateObject(const std::vector<IInstanceBase*>& inDevices)
+{
+    IInstanceBase* instance = new BenchmarkInstance(1 + (rand() % (s_NumTypes - 1)), inDevices[rand() % inDevices.size()]->GetApplicationHandle());
+
+    if ((rand() % 50) == 0)
+    {
+        instance->FlagAsDestroyed();
+    }
+
+    return instance;
+}
+
+//--------------------------------------------------------------------------
+/// The time from a start point, in milliseconds.
+//--------------------------------------------------------------------------
+static double MillisecondsSince(const std::chrono::high_resolution_clock::time_point& inStart)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - inStart).count();
+}
+
+//--------------------------------------------------------------------------
+/// Return the median of a set of timings.
+//--------------------------------------------------------------------------
+static double Median(std::vector<double> inTimings)
+{
+    std::sort(inTimings.begin(), inTimings.end());
+    return inTimings[inTimings.size() / 2];
+}
+
+int main()
+{
+    srand(1);
+
+    std::vector<IInstanceBase*> database;
+    std::vector<IInstanceBase*> devices;
+
+    for (unsigned int deviceIndex = 0; deviceIndex < s_NumDevices; ++deviceIndex)
+    {
+        IInstanceBase* device = new BenchmarkInstance(s_DeviceType, NULL);
+
+        devices.push_back(device);
+        database.push_back(device);
+    }
+
+    for (unsigned int objectIndex = 0; objectIndex < s_NumObjects; ++objectIndex)
+    {
+        database.push_back(CreateObject(devices));
+    }
+
+    std::vector<double> scanTimings;
+    std::vector<double> indexFirstTimings;
+    std::vector<double> indexRebuildTimings;
+
+    for (unsigned int build = 0; build < s_NumBuilds; ++build)
+    {
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+        gtASCIIString scannedTree = BuildByScanning(database, devices);
+        scanTimings.push_back(MillisecondsSince(start));
+
+        // Each build starts from a new index, so unlink the lists made by the last one.
+        ObjectTreeIndex index;
+
+        for (size_t objectIndex = 0; objectIndex < database.size(); ++objectIndex)
+        {
+            database[objectIndex]->SetNextInstanceOfType(NULL);
+        }
+
+        for (size_t objectIndex = 0; objectIndex < database.size(); ++objectIndex)
+        {
+            index.Add(database[objectIndex]);
+        }
+
+        start = std::chrono::high_resolution_clock::now();
+        gtASCIIString indexedTree = BuildFromIndex(index, devices);
+        indexFirstTimings.push_back(MillisecondsSince(start));
+
+        if (indexedTree != scannedTree)
+        {
+            printf("error: the indexed tree doesn't match the scanned tree\n");
+            return 1;
+        }
+
+        // Create a few objects, as an application would between two requests for the tree.
+        for (unsigned int newObjectIndex = 0; newObjectIndex < s_NumNewObjects; ++newObjectIndex)
+        {
+            IInstanceBase* instance = CreateObject(devices);
+            database.push_back(instance);
+            index.Add(instance);
+        }
+
+        start = std::chrono::high_resolution_clock::now();
+        indexedTree = BuildFromIndex(index, devices);
+        indexRebuildTimings.push_back(MillisecondsSince(start));
+
+        if (indexedTree != BuildByScanning(database, devices))
+        {
+            printf("error: the rebuilt tree doesn't match the scanned tree\n");
+            return 1;
+        }
+    }
+
+    printf("%u devices, %d types, %u objects, %u created between requests\n", s_NumDevices, s_NumTypes, s_NumObjects, s_NumNewObjects);
+    printf("%-36s %8.2f ms\n", "scan the database per device, type", Median(scanTimings));
+    printf("%-36s %8.2f ms\n", "index, first build", Median(indexFirstTimings));
+    printf("%-36s %8.2f ms\n", "index, rebuild after new objects", Median(indexRebuildTimings));
+
+    for (size_t objectIndex = 0; objectIndex < database.size(); ++objectIndex)
+    {
+        delete database[objectIndex];
+    }
+
+    return 0;
+}
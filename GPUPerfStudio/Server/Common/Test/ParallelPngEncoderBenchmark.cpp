@@ -0,0 +1,215 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Benchmark for the ParallelPngEncoder. Encodes a 1080p and a 4K
+///         RGBA image, once with libpng's default settings on one thread, the
+///         way RGBAtoPNG used to, and then with the ParallelPngEncoder's fast,
+///         default and max presets, on one thread and on one thread per processor.
+///         A new encoder is made for every run, the way the save paths do, so the
+///         times include handing the bands to the shared worker threads.
+///         Reports the encoding time, megapixels per second and the size of
+///         the image, and checks that every image decodes to the original pixels.
+///
+///         Built on Linux against the real ParallelPngEncoder and the system
+///         libpng and zlib:
+///         g++ -std=c++11 -O2 -D_LINUX -DLINUX -DNDEBUG -DGDT_PUBLIC -I.. -I../Linux
+///             -I../../../../CommonProjects ParallelPngEncoderBenchmark.cpp
+///             ../ParallelPngEncoder.cpp -lpng -lz -lpthread
+//==============================================================================
+
+#if defined (_LINUX)
+    #include "WinDefs.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <png.h>
+
+#include "../Logger.h"
+#include "../ParallelPngEncoder.h"
+
+//--------------------------------------------------------------------------
+/// The number of times each image is encoded. The fastest time is reported.
+//--------------------------------------------------------------------------
+static const unsigned int s_NumRuns = 3;
+
+// Stand-ins for the parts of Logger.cpp that ParallelPngEncoder uses.
+bool _SetupLog(const bool, const char*, const char*, int, const char*) { return false; }
+void _Log(enum LogType, const char* fmt, ...) { va_list args; va_start(args, fmt); vfprintf(stderr, fmt, args); va_end(args); }
+std::atomic<int> g_CachedLogLevel(logERROR);
+
+//--------------------------------------------------------------------------
+/// Fill an image with something that compresses like a rendered frame:
+/// smooth gradients, flat areas and a little noise, all deterministic.
+//--------------------------------------------------------------------------
+static void MakeImage(unsigned int inWidth, unsigned int inHeight, std::vector<unsigned char>& outPixels)
+{
+    outPixels.resize((size_t)inWidth * inHeight * 4);
+    unsigned int noise = 12345;
+
+    for (unsigned int y = 0; y < inHeight; y++)
+    {
+        unsigned char* pRow = &outPixels[(size_t)y * inWidth * 4];
+
+        for (unsigned int x = 0; x < inWidth; x++)
+        {
+            noise = noise * 1103515245 + 12345;
+            unsigned char grain = (unsigned char)((noise >> 16) & 7);
+            bool bFlat = ((x / 128) + (y / 128)) % 3 == 0;
+
+            pRow[x * 4 + 0] = bFlat ? 40 : (unsigned char)((x * 255) / inWidth + grain);
+            pRow[x * 4 + 1] = bFlat ? 90 : (unsigned char)((y * 255) / inHeight + grain);
+            pRow[x * 4 + 2] = bFlat ? 160 : (unsigned char)(((x + y) / 8) & 0xff);
+            pRow[x * 4 + 3] = 255;
+        }
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Appends libpng's output to a vector.
+//--------------------------------------------------------------------------
+static void WritePngData(png_structp pPng, png_bytep pData, png_size_t size)
+{
+    std::vector<unsigned char>* pOut = (std::vector<unsigned char>*)png_get_io_ptr(pPng);
+    pOut->insert(pOut->end(), pData, pData + size);
+}
+
+//--------------------------------------------------------------------------
+/// Encode an image with libpng's default settings on the calling thread.
+//--------------------------------------------------------------------------
+static bool EncodeWithLibpng(const std::vector<unsigned char>& inPixels, unsigned int inWidth, unsigned int inHeight, std::vector<unsigned char>& outPng)
+{
+    png_structp pPng = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+    png_infop pInfo = (pPng != NULL) ? png_create_info_struct(pPng) : NULL;
+
+    if (pInfo == NULL)
+    {
+        png_destroy_write_struct(&pPng, NULL);
+        return false;
+    }
+
+    if (setjmp(png_jmpbuf(pPng)))
+    {
+        png_destroy_write_struct(&pPng, &pInfo);
+        return false;
+    }
+
+    outPng.clear();
+    png_set_write_fn(pPng, &outPng, WritePngData, NULL);
+    png_set_IHDR(pPng, pInfo, inWidth, inHeight, 8, PNG_COLOR_TYPE_RGB_ALPHA, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+    png_write_info(pPng, pInfo);
+
+    for (unsigned int y = 0; y < inHeight; y++)
+    {
+        png_write_row(pPng, (png_const_bytep)&inPixels[(size_t)y * inWidth * 4]);
+    }
+
+    png_write_end(pPng, pInfo);
+    png_destroy_write_struct(&pPng, &pInfo);
+    return true;
+}
+
+//--------------------------------------------------------------------------
+/// Decode a PNG and check that it holds exactly the original pixels.
+//--------------------------------------------------------------------------
+static bool DecodesToOriginal(const std::vector<unsigned char>& inPng, const std::vector<unsigned char>& inPixels, unsigned int inWidth, unsigned int inHeight)
+{
+    png_image image;
+    memset(&image, 0, sizeof(image));
+    image.version = PNG_IMAGE_VERSION;
+
+    if (png_image_begin_read_from_memory(&image, &inPng[0], inPng.size()) == 0)
+    {
+        return false;
+    }
+
+    image.format = PNG_FORMAT_RGBA;
+    std::vector<unsigned char> decoded(PNG_IMAGE_SIZE(image));
+
+    if (png_image_finish_read(&image, NULL, &decoded[0], 0, NULL) == 0)
+    {
+        return false;
+    }
+
+    return (image.width == inWidth) && (image.height == inHeight) && (decoded == inPixels);
+}
+
+//--------------------------------------------------------------------------
+/// Encode an image s_NumRuns times, print the fastest time and the size,
+/// and check the output. Returns false if the image didn't encode or decode.
+//--------------------------------------------------------------------------
+static bool RunBenchmark(const char* inName, const std::vector<unsigned char>& inPixels, unsigned int inWidth, unsigned int inHeight,
+                         bool inbLibpng, PngCompressionPreset inPreset, unsigned int inNumThreads)
+{
+    std::vector<unsigned char> png;
+    double bestSeconds = 0.0;
+    bool bEncoded = true;
+
+    for (unsigned int run = 0; run < s_NumRuns; run++)
+    {
+        std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+        if (inbLibpng)
+        {
+            bEncoded = EncodeWithLibpng(inPixels, inWidth, inHeight, png) && bEncoded;
+        }
+        else
+        {
+            ParallelPngEncoder encoder(inPreset, inNumThreads);
+            bEncoded = encoder.Encode(&inPixels[0], inWidth, inHeight, (int)(inWidth * 4), png) && bEncoded;
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+        bestSeconds = (run == 0) ? seconds : std::min(bestSeconds, seconds);
+    }
+
+    bool bIntact = bEncoded && DecodesToOriginal(png, inPixels, inWidth, inHeight);
+
+    printf("%-32s %10.1f %10.1f %12.2f %s\n", inName, bestSeconds * 1000.0, ((double)inWidth * inHeight) / (bestSeconds * 1000000.0),
+           png.size() / (1024.0 * 1024.0), bIntact ? "" : "error: the image doesn't decode to the original pixels");
+
+    return bIntact;
+}
+
+int main()
+{
+    unsigned int numProcessors = std::max(std::thread::hardware_concurrency(), 1u);
+
+    printf("%u hardware threads, best of %u runs\n", numProcessors, s_NumRuns);
+
+    static const unsigned int s_Widths[] = { 1920, 3840 };
+    static const unsigned int s_Heights[] = { 1080, 2160 };
+    int result = 0;
+
+    for (unsigned int sizeIndex = 0; sizeIndex < sizeof(s_Widths) / sizeof(s_Widths[0]); sizeIndex++)
+    {
+        unsigned int width = s_Widths[sizeIndex];
+        unsigned int height = s_Heights[sizeIndex];
+        std::vector<unsigned char> pixels;
+        MakeImage(width, height, pixels);
+
+        printf("\n%u x %u\n", width, height);
+        printf("%-32s %10s %10s %12s\n", "", "ms", "Mpixels/s", "MB");
+
+        bool bIntact = RunBenchmark("libpng, 1 thread", pixels, width, height, true, PNG_COMPRESSION_FAST, 1);
+        bIntact = RunBenchmark("fast, 1 thread", pixels, width, height, false, PNG_COMPRESSION_FAST, 1) && bIntact;
+        bIntact = RunBenchmark("fast, 1 thread per processor", pixels, width, height, false, PNG_COMPRESSION_FAST, numProcessors) && bIntact;
+        bIntact = RunBenchmark("default, 1 thread", pixels, width, height, false, PNG_COMPRESSION_DEFAULT, 1) && bIntact;
+        bIntact = RunBenchmark("default, 1 thread per processor", pixels, width, height, false, PNG_COMPRESSION_DEFAULT, numProcessors) && bIntact;
+        bIntact = RunBenchmark("max, 1 thread", pixels, width, height, false, PNG_COMPRESSION_MAX, 1) && bIntact;
+        bIntact = RunBenchmark("max, 1 thread per processor", pixels, width, height, false, PNG_COMPRESSION_MAX, numProcessors) && bIntact;
+
+        if (bIntact == false)
+        {
+            result = 1;
+        }
+    }
+
+    return result;
+}
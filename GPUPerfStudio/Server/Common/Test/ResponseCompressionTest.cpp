@@ -0,0 +1,303 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Tests for the compression of HTTP responses. Responses made of
+///         several pieces are compressed with each content encoding, then
+///         inflated back with zlib and compared with the original, and the
+///         Content-Encoding line added to the header is checked. Also checks
+///         which responses ShouldCompressResponse leaves uncompressed, and
+///         compresses responses from several threads at once, the way the
+///         keep-alive connections send them. Returns non-zero if any check fails.
+///
+///         Built on Linux against the real ResponseCompression and Compressor:
+///         g++ -std=c++11 -O2 -D_LINUX -DLINUX -DNDEBUG -DGDT_PUBLIC -DUSE_GZIP -I.. -I../Linux
+///             -I../../../../CommonProjects ResponseCompressionTest.cpp
+///             ../ResponseCompression.cpp ../Compressor.cpp ../Linux/SafeCRT.cpp -lz -lpthread
+//==============================================================================
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <zlib.h>
+
+#include "../HTTPRequest.h"
+#include "../Logger.h"
+#include "../ResponseCompression.h"
+
+//--------------------------------------------------------------------------
+/// The size of the buffer the header is written into, as in SendHeaderAndData.
+//--------------------------------------------------------------------------
+static const unsigned long s_HeaderSize = 1024;
+
+//--------------------------------------------------------------------------
+/// The header that CompressResponse adds the Content-Encoding line to.
+//--------------------------------------------------------------------------
+static const char* s_Header = "HTTP/1.1 200 OK\r\n";
+
+//--------------------------------------------------------------------------
+/// The number of threads that compress responses at the same time, and the
+/// number of responses each of them compresses.
+//--------------------------------------------------------------------------
+static const unsigned int s_NumCompressingThreads = 4;
+static const unsigned int s_ResponsesPerThread = 50;
+
+//--------------------------------------------------------------------------
+/// The number of checks that failed, from any thread.
+//--------------------------------------------------------------------------
+static std::atomic<unsigned int> s_NumFailures(0);
+
+// Stand-ins for the parts of Logger.cpp that Compressor uses.
+bool _SetupLog(const bool, const char*, const char*, int, const char*) { return false; }
+void _Log(enum LogType, const char* fmt, ...) { va_list args; va_start(args, fmt); vfprintf(stderr, fmt, args); va_end(args); }
+std::atomic<int> g_CachedLogLevel(logERROR);
+
+//--------------------------------------------------------------------------
+/// Report a failed check, without stopping the test.
+//--------------------------------------------------------------------------
+#define CHECK(condition)                                                        \
+    if (!(condition))                                                           \
+    {                                                                           \
+        printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #condition);  \
+        s_NumFailures++;                                                        \
+    }
+
+//--------------------------------------------------------------------------
+/// Make an XML response of roughly inSize bytes, made of repeated elements
+/// like the ones the server sends, so it compresses well.
+//--------------------------------------------------------------------------
+static std::string MakeXMLResponse(size_t inSize)
+{
+    std::string response = "<XML src='/12345/DX12/FrameDebugger/DrawCall.xml'>";
+    char element[128];
+
+    for (unsigned int i = 0; response.size() < inSize; i++)
+    {
+        sprintf(element, "<DrawCall index='%u' vertices='%u' instances='1'/>", i, (i * 37) % 1000);
+        response += element;
+    }
+
+    response.resize(inSize);
+    return response;
+}
+
+//--------------------------------------------------------------------------
+/// Make inSize bytes that don't compress.
+//--------------------------------------------------------------------------
+static std::string MakeRandomData(size_t inSize)
+{
+    std::string data(inSize, '\0');
+    unsigned int seed = 12345;
+
+    for (size_t i = 0; i < inSize; i++)
+    {
+        seed = (seed * 1103515245u) + 12345u;
+        data[i] = (char)(seed >> 16);
+    }
+
+    return data;
+}
+
+//--------------------------------------------------------------------------
+/// Split a response into pieces of different sizes, the way CommandResponse
+/// sends the header, the URL, the data and the closing tag separately.
+//--------------------------------------------------------------------------
+static std::vector< NetSocket::SendBuffer > SplitIntoSegments(const std::string& inResponse)
+{
+    std::vector< NetSocket::SendBuffer > segments;
+    size_t offset = 0;
+    size_t pieceSize = 7;
+
+    while (offset < inResponse.size())
+    {
+        NetSocket::SendBuffer segment;
+        segment.pData = inResponse.data() + offset;
+        segment.size = std::min(pieceSize, inResponse.size() - offset);
+        segments.push_back(segment);
+
+        offset += segment.size;
+        pieceSize = (pieceSize * 3) + 1;
+    }
+
+    return segments;
+}
+
+//--------------------------------------------------------------------------
+/// Inflate a gzip or zlib stream, telling them apart by their headers.
+/// \return true if the whole stream was inflated.
+//--------------------------------------------------------------------------
+static bool Inflate(const std::vector< unsigned char >& inCompressed, std::string& outInflated)
+{
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+
+    if (inflateInit2(&stream, 15 + 32) != Z_OK)
+    {
+        return false;
+    }
+
+    stream.next_in = (Bytef*)&inCompressed[0];
+    stream.avail_in = (uInt)inCompressed.size();
+
+    int result = Z_OK;
+    char buffer[16 * 1024];
+    outInflated.clear();
+
+    while (result == Z_OK)
+    {
+        stream.next_out = (Bytef*)buffer;
+        stream.avail_out = sizeof(buffer);
+        result = inflate(&stream, Z_NO_FLUSH);
+        outInflated.append(buffer, sizeof(buffer) - stream.avail_out);
+    }
+
+    inflateEnd(&stream);
+
+    return (result == Z_STREAM_END && stream.avail_in == 0);
+}
+
+//--------------------------------------------------------------------------
+/// Compress a response and check that it inflates back to the original, and
+/// that the header says how it was encoded.
+/// \param inAcceptedEncodings The HTTP_CONTENT_ENCODING flags the client accepts.
+/// \param inExpectedEncoding The name of the content encoding that should be used.
+/// \param inResponse The response to compress.
+//--------------------------------------------------------------------------
+static void CheckRoundTrip(unsigned int inAcceptedEncodings, const char* inExpectedEncoding, const std::string& inResponse)
+{
+    std::vector< NetSocket::SendBuffer > segments = SplitIntoSegments(inResponse);
+    std::vector< unsigned char > compressed;
+    char header[s_HeaderSize];
+    strcpy(header, s_Header);
+
+    bool bCompressed = CompressResponse(inAcceptedEncodings, "text/xml", &segments[0], (unsigned int)segments.size(), (unsigned long)inResponse.size(),
+                                        compressed, header, s_HeaderSize);
+    CHECK(bCompressed);
+
+    if (bCompressed == false)
+    {
+        return;
+    }
+
+    CHECK(compressed.size() < inResponse.size());
+
+    std::string expectedHeader = std::string(s_Header) + "Content-Encoding: " + inExpectedEncoding + "\r\n";
+    CHECK(expectedHeader == header);
+
+    // gzip streams start with 0x1f 0x8b, zlib streams with a compression method of 8
+    if (strcmp(inExpectedEncoding, "gzip") == 0)
+    {
+        CHECK(compressed[0] == 0x1f && compressed[1] == 0x8b);
+    }
+    else
+    {
+        CHECK((compressed[0] & 0x0f) == 8);
+    }
+
+    std::string inflated;
+    CHECK(Inflate(compressed, inflated));
+    CHECK(inflated == inResponse);
+}
+
+//--------------------------------------------------------------------------
+/// Check a response that shouldn't be compressed is left alone.
+//--------------------------------------------------------------------------
+static void CheckNotCompressed(unsigned int inAcceptedEncodings, const char* inMime, const std::string& inResponse)
+{
+    std::vector< NetSocket::SendBuffer > segments = SplitIntoSegments(inResponse);
+    std::vector< unsigned char > compressed;
+    char header[s_HeaderSize];
+    strcpy(header, s_Header);
+
+    CHECK(CompressResponse(inAcceptedEncodings, inMime, &segments[0], (unsigned int)segments.size(), (unsigned long)inResponse.size(),
+                           compressed, header, s_HeaderSize) == false);
+    CHECK(strcmp(header, s_Header) == 0);
+}
+
+//--------------------------------------------------------------------------
+/// Check which responses ShouldCompressResponse decides to compress.
+//--------------------------------------------------------------------------
+static void CheckThresholds()
+{
+    const unsigned int both = HTTP_ENCODING_GZIP | HTTP_ENCODING_DEFLATE;
+
+    CHECK(ShouldCompressResponse(both, "text/xml", s_dwMinCompressedResponseSize - 1) == false);
+    CHECK(ShouldCompressResponse(both, "text/xml", s_dwMinCompressedResponseSize));
+    CHECK(ShouldCompressResponse(HTTP_ENCODING_GZIP, "text/plain", 64 * 1024));
+    CHECK(ShouldCompressResponse(HTTP_ENCODING_DEFLATE, "application/xml", 64 * 1024));
+    CHECK(ShouldCompressResponse(both, "application/json", 64 * 1024));
+    CHECK(ShouldCompressResponse(both, "application/javascript", 64 * 1024));
+
+    // the client has to accept a compressed response
+    CHECK(ShouldCompressResponse(0, "text/xml", 64 * 1024) == false);
+
+    // images and binary data are left alone
+    CHECK(ShouldCompressResponse(both, "image/png", 64 * 1024) == false);
+    CHECK(ShouldCompressResponse(both, "application/octet-stream", 64 * 1024) == false);
+    CHECK(ShouldCompressResponse(both, NULL, 64 * 1024) == false);
+}
+
+//--------------------------------------------------------------------------
+/// Compress responses of different sizes from one thread, each with its own
+/// encodings, and check them all.
+//--------------------------------------------------------------------------
+static void CompressFromThread(unsigned int inThreadIndex)
+{
+    for (unsigned int i = 0; i < s_ResponsesPerThread; i++)
+    {
+        std::string response = MakeXMLResponse(s_dwMinCompressedResponseSize + (((inThreadIndex * s_ResponsesPerThread) + i) * 997));
+
+        if ((i + inThreadIndex) % 2 == 0)
+        {
+            CheckRoundTrip(HTTP_ENCODING_GZIP | HTTP_ENCODING_DEFLATE, "gzip", response);
+        }
+        else
+        {
+            CheckRoundTrip(HTTP_ENCODING_DEFLATE, "deflate", response);
+        }
+    }
+}
+
+int main()
+{
+    CheckThresholds();
+
+    // gzip is preferred when the client accepts both
+    CheckRoundTrip(HTTP_ENCODING_GZIP | HTTP_ENCODING_DEFLATE, "gzip", MakeXMLResponse(s_dwMinCompressedResponseSize));
+    CheckRoundTrip(HTTP_ENCODING_GZIP, "gzip", MakeXMLResponse(256 * 1024));
+    CheckRoundTrip(HTTP_ENCODING_DEFLATE, "deflate", MakeXMLResponse(256 * 1024));
+
+    // the compressors are reused, so compress a small response after a large one
+    CheckRoundTrip(HTTP_ENCODING_GZIP, "gzip", MakeXMLResponse(2000));
+    CheckRoundTrip(HTTP_ENCODING_DEFLATE, "deflate", MakeXMLResponse(2000));
+
+    CheckNotCompressed(HTTP_ENCODING_GZIP, "text/xml", MakeXMLResponse(s_dwMinCompressedResponseSize - 1));
+    CheckNotCompressed(0, "text/xml", MakeXMLResponse(64 * 1024));
+    CheckNotCompressed(HTTP_ENCODING_GZIP, "image/png", MakeXMLResponse(64 * 1024));
+
+    // data that doesn't get smaller is sent as it is
+    CheckNotCompressed(HTTP_ENCODING_GZIP, "text/plain", MakeRandomData(64 * 1024));
+
+    std::vector< std::thread > threads;
+
+    for (unsigned int threadIndex = 0; threadIndex < s_NumCompressingThreads; threadIndex++)
+    {
+        threads.push_back(std::thread(CompressFromThread, threadIndex));
+    }
+
+    for (unsigned int threadIndex = 0; threadIndex < threads.size(); threadIndex++)
+    {
+        threads[threadIndex].join();
+    }
+
+    DeleteIdleCompressors();
+
+    printf("%u checks failed\n", s_NumFailures.load());
+
+    return (s_NumFailures == 0) ? 0 : 1;
+}
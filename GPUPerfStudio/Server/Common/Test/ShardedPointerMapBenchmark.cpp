@@ -0,0 +1,207 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Benchmark for the ShardedPointerMap that indexes wrapped DX12 objects.
+///         Measures insert throughput while the map is filled, then lookup
+///         throughput on N threads while one more thread keeps inserting, the
+///         way WrappedObject and GetMetadataObject run while new objects are
+///         wrapped. Each is run once on the ShardedPointerMap and once on a
+///         std::map under one global lock, which is how the database used to
+///         index its objects.
+///
+///         Built on Linux against the headers in Common:
+///         g++ -std=c++11 -O2 -D_LINUX -I.. -I../Linux
+///             ShardedPointerMapBenchmark.cpp -lpthread
+//==============================================================================
+
+#if defined (_LINUX)
+    #include "WinDefs.h"
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../ShardedPointerMap.h"
+#include "../mymutex.h"
+
+//--------------------------------------------------------------------------
+/// The number of objects in the map when lookups are timed.
+//--------------------------------------------------------------------------
+static const unsigned int s_NumObjects = 200000;
+
+//--------------------------------------------------------------------------
+/// The number of lookups each reader thread makes.
+//--------------------------------------------------------------------------
+static const unsigned int s_LookupsPerThread = 2000000;
+
+//--------------------------------------------------------------------------
+/// Stands in for a wrapped object. Only its address is used, as the key.
+//--------------------------------------------------------------------------
+struct FakeObject
+{
+    /// Padding, so objects are spaced like small heap allocations.
+    char mData[48];
+};
+
+//--------------------------------------------------------------------------
+/// The old index: a std::map, locked for every insert and lookup.
+//--------------------------------------------------------------------------
+class LockedMapIndex
+{
+public:
+    //--------------------------------------------------------------------------
+    /// Add an object to the index.
+    //--------------------------------------------------------------------------
+    void Insert(void* inKey, void* inValue)
+    {
+        ScopeLock lock(&mLock);
+        mMap[inKey] = inValue;
+    }
+
+    //--------------------------------------------------------------------------
+    /// Find an object in the index.
+    //--------------------------------------------------------------------------
+    void* Find(void* inKey)
+    {
+        ScopeLock lock(&mLock);
+        std::map<void*, void*>::iterator it = mMap.find(inKey);
+        return (it != mMap.end()) ? it->second : NULL;
+    }
+
+private:
+    /// Guards mMap.
+    mutex mLock;
+
+    /// The indexed objects.
+    std::map<void*, void*> mMap;
+};
+
+//--------------------------------------------------------------------------
+/// The current index.
+//--------------------------------------------------------------------------
+typedef ShardedPointerMap<void*, void*> ShardedIndex;
+
+//--------------------------------------------------------------------------
+/// The time from a start point, in seconds.
+//--------------------------------------------------------------------------
+static double SecondsSince(const std::chrono::high_resolution_clock::time_point& inStart)
+{
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - inStart).count();
+}
+
+//--------------------------------------------------------------------------
+/// Fill an index with the first s_NumObjects objects, and return the inserts per second.
+//--------------------------------------------------------------------------
+template <typename IndexType>
+static double FillIndex(IndexType& ioIndex, std::vector<FakeObject>& inObjects)
+{
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+    for (unsigned int objectIndex = 0; objectIndex < s_NumObjects; objectIndex++)
+    {
+        ioIndex.Insert(&inObjects[objectIndex], &inObjects[objectIndex]);
+    }
+
+    return s_NumObjects / SecondsSince(start);
+}
+
+//--------------------------------------------------------------------------
+/// Look up random objects on inNumThreads threads while one more thread inserts the rest of
+/// the objects, and return the lookups per second across all readers.
+//--------------------------------------------------------------------------
+template <typename IndexType>
+static double RunLookups(IndexType& ioIndex, std::vector<FakeObject>& inObjects, unsigned int inNumThreads)
+{
+    std::vector<std::thread> readers;
+    std::atomic<bool> bReadersDone(false);
+    std::atomic<unsigned int> numMisses(0);
+
+    std::thread writer([&]()
+    {
+        for (size_t objectIndex = s_NumObjects; objectIndex < inObjects.size() && bReadersDone == false; objectIndex++)
+        {
+            ioIndex.Insert(&inObjects[objectIndex], &inObjects[objectIndex]);
+        }
+    });
+
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+    for (unsigned int threadIndex = 0; threadIndex < inNumThreads; threadIndex++)
+    {
+        readers.push_back(std::thread([&, threadIndex]()
+        {
+            unsigned int seed = threadIndex * 7919 + 1;
+            unsigned int misses = 0;
+
+            for (unsigned int lookup = 0; lookup < s_LookupsPerThread; lookup++)
+            {
+                seed = (seed * 1664525u) + 1013904223u;
+                void* key = &inObjects[seed % s_NumObjects];
+
+                if (ioIndex.Find(key) != key)
+                {
+                    misses++;
+                }
+            }
+
+            numMisses += misses;
+        }));
+    }
+
+    for (unsigned int threadIndex = 0; threadIndex < inNumThreads; threadIndex++)
+    {
+        readers[threadIndex].join();
+    }
+
+    double seconds = SecondsSince(start);
+
+    bReadersDone = true;
+    writer.join();
+
+    if (numMisses != 0)
+    {
+        printf("error: %u lookups missed\n", numMisses.load());
+    }
+
+    return (static_cast<double>(inNumThreads) * s_LookupsPerThread) / seconds;
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int maxThreads = (argc > 1) ? static_cast<unsigned int>(atoi(argv[1])) : 8;
+
+    // Twice as many objects as are filled up front, so the writer thread has plenty left to insert.
+    std::vector<FakeObject> objects(s_NumObjects * 2);
+
+    printf("%u hardware threads, %u objects\n", std::thread::hardware_concurrency(), s_NumObjects);
+
+    LockedMapIndex lockedMap;
+    ShardedIndex shardedMap;
+
+    printf("%-28s %12.2f Minsert/s\n", "insert, locked std::map", FillIndex(lockedMap, objects) / 1000000.0);
+    printf("%-28s %12.2f Minsert/s\n", "insert, ShardedPointerMap", FillIndex(shardedMap, objects) / 1000000.0);
+
+    printf("%8s %20s %20s\n", "readers", "std::map Mlookup/s", "sharded Mlookup/s");
+
+    for (unsigned int numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+    {
+        // Each run starts from the filled maps, so the writer always has objects left to insert.
+        LockedMapIndex runLockedMap;
+        ShardedIndex runShardedMap;
+        FillIndex(runLockedMap, objects);
+        FillIndex(runShardedMap, objects);
+
+        double lockedRate = RunLookups(runLockedMap, objects, numThreads);
+        double shardedRate = RunLookups(runShardedMap, objects, numThreads);
+
+        printf("%8u %20.2f %20.2f\n", numThreads, lockedRate / 1000000.0, shardedRate / 1000000.0);
+    }
+
+    return 0;
+}
@@ -0,0 +1,236 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Microbenchmark for reading SharedGlobal values through the
+///         per-process snapshot. Measures reads per second with no writes,
+///         and with a writer updating a value in a loop. Then a writer stalls
+///         in the middle of a write, the way a descheduled or crashed process
+///         would, and checks that SharedGlobal::RefreshSnapshot gives up on it:
+///         the first read is only held up for a bounded time and returns the
+///         previous value, the next read doesn't wait again, and the new value
+///         is read once the write finishes.
+///
+///         The stalled writer maps the shared globals a second time, the way
+///         another process would. Built on Linux against the real SharedGlobal:
+///         g++ -std=c++11 -O2 -D_LINUX -DLINUX -DNDEBUG -DGDT_PUBLIC -I.. -I../Linux
+///             -I../../../../CommonProjects -I../../../../CommonProjects/AMDTOSWrappers/src
+///             SharedGlobalSnapshotBenchmark.cpp ../SharedGlobal.cpp ../SharedMemory.cpp ../Linux/SafeCRT.cpp
+///             ../../../../CommonProjects/AMDTOSWrappers/src/common/osMutex.cpp
+///             ../../../../CommonProjects/AMDTOSWrappers/src/linux/osMutexImpl.cpp
+///             -lpthread -lrt
+//==============================================================================
+
+#if defined (_LINUX)
+    #include "WinDefs.h"
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+#include <AMDTOSWrappers/Include/osSystemError.h>
+#include "../SharedGlobal.h"
+
+// The name of the shared globals' mapping, from SharedGlobal.cpp.
+extern const char* SHARED_MEMORY_NAME;
+
+// Stand-ins for the parts of Logger.cpp that SharedGlobal uses.
+bool _SetupLog(const bool, const char*, const char*, int, const char*) { return false; }
+void _Log(enum LogType, const char* fmt, ...) { va_list args; va_start(args, fmt); vfprintf(stderr, fmt, args); va_end(args); }
+void _SetCachedLogLevel(int, unsigned int) { }
+std::atomic<int> g_CachedLogLevel(logERROR);
+std::atomic<std::atomic<unsigned int>*> g_pSharedOptionsGeneration(NULL);
+
+// Stand-ins for AMDTOSWrappers and AMDTBaseTools.
+osSystemErrorCode osGetLastSystemError() { return errno; }
+extern "C" void gtTriggerAssertonFailureHandler(const char*, const char*, int, const wchar_t*) { }
+
+//--------------------------------------------------------------------------
+/// The number of reads timed in each throughput measurement.
+//--------------------------------------------------------------------------
+static const unsigned int s_NumReads = 20000000;
+
+//--------------------------------------------------------------------------
+/// How long the stalled writer stays in the middle of its write.
+//--------------------------------------------------------------------------
+static const unsigned int s_StallMs = 200;
+
+//--------------------------------------------------------------------------
+/// The shared globals, mapped a second time, so the benchmark can write to them
+/// the way another process would.
+//--------------------------------------------------------------------------
+class OtherProcessWriter
+{
+public:
+    //--------------------------------------------------------------------------
+    /// Map the shared globals. SharedGlobal::Instance must have created them.
+    /// \returns True if the shared globals were mapped.
+    //--------------------------------------------------------------------------
+    bool Open()
+    {
+        return (mMapping.Open(SHARED_MEMORY_NAME) == SharedMemory::SUCCESS);
+    }
+
+    //--------------------------------------------------------------------------
+    /// Start a write, the way SharedGlobal::BeginWrite does, and change a value without finishing the write.
+    /// \param inValue The new value.
+    //--------------------------------------------------------------------------
+    void BeginWrite(uint32 inValue)
+    {
+        GetGeneration().fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        GetShared()->OptionStatsDuration = inValue;
+    }
+
+    //--------------------------------------------------------------------------
+    /// Finish the write, the way SharedGlobal::EndWrite does.
+    //--------------------------------------------------------------------------
+    void EndWrite()
+    {
+        GetGeneration().fetch_add(1, std::memory_order_release);
+    }
+
+private:
+    //--------------------------------------------------------------------------
+    /// Return the mapped shared globals.
+    //--------------------------------------------------------------------------
+    PsSharedGlobal* GetShared()
+    {
+        return (PsSharedGlobal*)mMapping.Get();
+    }
+
+    //--------------------------------------------------------------------------
+    /// Return the write generation of the mapped shared globals.
+    //--------------------------------------------------------------------------
+    std::atomic<uint32>& GetGeneration()
+    {
+        return *(std::atomic<uint32>*)&GetShared()->Generation;
+    }
+
+    /// The second mapping of the shared globals.
+    SharedMemory mMapping;
+};
+
+//--------------------------------------------------------------------------
+/// The time from a start point, in seconds.
+//--------------------------------------------------------------------------
+static double SecondsSince(const std::chrono::high_resolution_clock::time_point& inStart)
+{
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - inStart).count();
+}
+
+//--------------------------------------------------------------------------
+/// Return the reads per second, optionally with a thread writing the value in a loop.
+//--------------------------------------------------------------------------
+static double TimeReads(bool inbWithWriter)
+{
+    std::atomic<bool> bDone(false);
+    std::thread writer;
+
+    if (inbWithWriter)
+    {
+        writer = std::thread([&]()
+        {
+            for (unsigned int value = 0; bDone == false; value++)
+            {
+                SG_SET_UINT(OptionStatsDuration, value);
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        });
+    }
+
+    unsigned int checksum = 0;
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+    for (unsigned int readIndex = 0; readIndex < s_NumReads; readIndex++)
+    {
+        checksum += SG_GET_UINT(OptionStatsDuration);
+    }
+
+    double seconds = SecondsSince(start);
+
+    bDone = true;
+
+    if (writer.joinable())
+    {
+        writer.join();
+    }
+
+    return (checksum == 0xffffffff) ? 0.0 : (s_NumReads / seconds);
+}
+
+int main()
+{
+    if (SharedGlobal::Instance() == NULL)
+    {
+        printf("error: the shared globals couldn't be created\n");
+        return 1;
+    }
+
+    // The shared globals outlive this process, so put back the value that's changed.
+    uint32 originalValue = SG_GET_UINT(OptionStatsDuration);
+
+    printf("%-40s %10.1f Mread/s\n", "reads, no writes", TimeReads(false) / 1000000.0);
+    printf("%-40s %10.1f Mread/s\n", "reads, a write every 100us", TimeReads(true) / 1000000.0);
+
+    OtherProcessWriter otherProcess;
+
+    if (otherProcess.Open() == false)
+    {
+        printf("error: the shared globals couldn't be mapped a second time\n");
+        return 1;
+    }
+
+    SG_SET_UINT(OptionStatsDuration, 1);
+
+    std::atomic<bool> bStalled(false);
+
+    // The other process starts a write, then stalls for s_StallMs before finishing it.
+    std::thread writer([&]()
+    {
+        otherProcess.BeginWrite(2);
+        bStalled = true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(s_StallMs));
+        otherProcess.EndWrite();
+    });
+
+    while (bStalled == false)
+    {
+        std::this_thread::yield();
+    }
+
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+    uint32 firstValue = SG_GET_UINT(OptionStatsDuration);
+    double firstReadMs = SecondsSince(start) * 1000.0;
+
+    start = std::chrono::high_resolution_clock::now();
+    uint32 secondValue = SG_GET_UINT(OptionStatsDuration);
+    double secondReadMs = SecondsSince(start) * 1000.0;
+
+    writer.join();
+
+    uint32 finishedValue = SG_GET_UINT(OptionStatsDuration);
+
+    printf("writer stalled for %ums mid-write:\n", s_StallMs);
+    printf("%-40s %10.3f ms, value %u\n", "  first read", firstReadMs, firstValue);
+    printf("%-40s %10.3f ms, value %u\n", "  second read", secondReadMs, secondValue);
+    printf("%-40s %10s    value %u\n", "  after the write finished", "", finishedValue);
+
+    SG_SET_UINT(OptionStatsDuration, originalValue);
+
+    // Reads during the stall must give up on the write and return the previous value, without waiting out the stall.
+    bool bPassed = (firstValue == 1) && (secondValue == 1) && (finishedValue == 2) &&
+                   (firstReadMs < s_StallMs / 2.0) && (secondReadMs < s_StallMs / 2.0);
+
+    if (bPassed == false)
+    {
+        printf("error: a read during the stalled write waited for it, or returned the wrong value\n");
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,306 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Benchmark for putting responses into shared memory. One thread
+///         puts N responses, each made of the pieces that CommandResponse
+///         sends for an XML response, while another thread gets them, the way
+///         the web server does. The responses are put once the old way, put
+///         together in a string and then copied in with smPut, and once
+///         serialized straight into a region returned by smReservePut, or, for
+///         a response too large for one region, put in chunks copied straight
+///         from the pieces by smPutSegments.
+///         Each way is run against the default layout, which the web server
+///         reads, and against the opt-in lock-free ring.
+///         Reports responses and megabytes per second for a small and a large
+///         response, and checks that every response arrives intact.
+///
+///         Built on Linux against the real SharedMemoryManager, NamedMutex and
+///         SharedMemory. NamedEvent doesn't build against current boost, so it
+///         is stood in for below by an in-process manual-reset event:
+///         g++ -std=c++11 -O2 -D_LINUX -DLINUX -DNDEBUG -DGDT_PUBLIC -I.. -I../Linux
+///             -I../../../../CommonProjects SharedMemoryRingBenchmark.cpp
+///             ../SharedMemoryManager.cpp ../NamedMutex.cpp ../SharedMemory.cpp
+///             ../Linux/SafeCRT.cpp ../../../../CommonProjects/AMDTBaseTools/src/gtASCIIString.cpp
+///             -lpthread -lrt
+//==============================================================================
+
+#if defined (_LINUX)
+    #include "WinDefs.h"
+#endif
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <errno.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <AMDTOSWrappers/Include/osSystemError.h>
+#include "../Logger.h"
+#include "../NamedEvent.h"
+#include "../SharedMemoryManager.h"
+
+//--------------------------------------------------------------------------
+/// The names of the shared memories used by the benchmark, with the default
+/// layout and as a lock-free ring.
+//--------------------------------------------------------------------------
+static const char* s_SharedMemoryNames[] = { "SharedMemoryBenchmark", "SharedMemoryRingBenchmark" };
+
+//--------------------------------------------------------------------------
+/// The number of elements and element size the shared memory is created with.
+//--------------------------------------------------------------------------
+static const unsigned long s_NumElements = 64;
+static const unsigned long s_ElementSize = 16 * 1024;
+
+//--------------------------------------------------------------------------
+/// Stands in for the web server's URL of the request.
+//--------------------------------------------------------------------------
+static const char* s_URL = "/12345/DX12/FrameDebugger/DrawCall/RenderTarget.xml";
+
+//--------------------------------------------------------------------------
+/// Stands in for XMLHeader().
+//--------------------------------------------------------------------------
+static const char* s_XMLHeader = "<?xml version='1.0' encoding='UTF-8' standalone='yes' ?>";
+
+// Stand-ins for the parts of Logger.cpp that SharedMemoryManager uses.
+bool _SetupLog(const bool, const char*, const char*, int, const char*) { return false; }
+void _Log(enum LogType, const char* fmt, ...) { va_list args; va_start(args, fmt); vfprintf(stderr, fmt, args); va_end(args); }
+std::atomic<int> g_CachedLogLevel(logERROR);
+
+// Stand-ins for AMDTOSWrappers and AMDTBaseTools.
+osSystemErrorCode osGetLastSystemError() { return errno; }
+extern "C" void gtTriggerAssertonFailureHandler(const char*, const char*, int, const wchar_t*) { }
+
+//--------------------------------------------------------------------------
+/// Stands in for the platform implementation of NamedEvent: a manual-reset
+/// event, which is enough since both threads use the same SharedMemoryManager.
+/// Uses pthreads, since misc.h makes std::mutex ambiguous.
+//--------------------------------------------------------------------------
+class NamedEventImpl
+{
+public:
+    /// Protects mbSignaled.
+    pthread_mutex_t mMutex;
+
+    /// Woken when the event is signaled.
+    pthread_cond_t mSignaled;
+
+    /// True while the event is signaled.
+    bool mbSignaled;
+};
+
+NamedEvent::NamedEvent() : m_pImpl(new NamedEventImpl())
+{
+    pthread_mutex_init(&m_pImpl->mMutex, NULL);
+    pthread_cond_init(&m_pImpl->mSignaled, NULL);
+    m_pImpl->mbSignaled = false;
+}
+
+NamedEvent::~NamedEvent()
+{
+    pthread_cond_destroy(&m_pImpl->mSignaled);
+    pthread_mutex_destroy(&m_pImpl->mMutex);
+    delete m_pImpl;
+}
+
+bool NamedEvent::Create(const char*, bool signaled) { m_pImpl->mbSignaled = signaled; return true; }
+bool NamedEvent::Open(const char*, bool) { return true; }
+bool NamedEvent::IsSignaled() { return m_pImpl->mbSignaled; }
+void NamedEvent::Close() { }
+
+void NamedEvent::Reset()
+{
+    pthread_mutex_lock(&m_pImpl->mMutex);
+    m_pImpl->mbSignaled = false;
+    pthread_mutex_unlock(&m_pImpl->mMutex);
+}
+
+bool NamedEvent::Wait()
+{
+    pthread_mutex_lock(&m_pImpl->mMutex);
+
+    while (m_pImpl->mbSignaled == false)
+    {
+        pthread_cond_wait(&m_pImpl->mSignaled, &m_pImpl->mMutex);
+    }
+
+    pthread_mutex_unlock(&m_pImpl->mMutex);
+    return true;
+}
+
+bool NamedEvent::Signal()
+{
+    pthread_mutex_lock(&m_pImpl->mMutex);
+    m_pImpl->mbSignaled = true;
+    pthread_cond_broadcast(&m_pImpl->mSignaled);
+    pthread_mutex_unlock(&m_pImpl->mMutex);
+    return true;
+}
+
+//--------------------------------------------------------------------------
+/// The ways a response can be put into the shared memory.
+//--------------------------------------------------------------------------
+enum PutMethod
+{
+    PUT_COPY,
+    PUT_SERIALIZE_IN_PLACE,
+};
+
+//--------------------------------------------------------------------------
+/// Put one XML response, made of the pieces that CommandResponse::Send sends.
+//--------------------------------------------------------------------------
+static bool PutResponse(const char* inSharedMemoryName, PutMethod inMethod, const std::string& inData)
+{
+    const char* segments[] = { s_XMLHeader, "<XML src='", s_URL, "'>", inData.c_str(), "</XML>" };
+    const unsigned int numSegments = sizeof(segments) / sizeof(segments[0]);
+    size_t segmentSizes[numSegments];
+    unsigned long responseSize = 0;
+
+    for (unsigned int i = 0; i < numSegments; i++)
+    {
+        segmentSizes[i] = strlen(segments[i]);
+        responseSize += (unsigned long)segmentSizes[i];
+    }
+
+    if (inMethod == PUT_SERIALIZE_IN_PLACE)
+    {
+        char* reserved = (char*)smReservePut(inSharedMemoryName, responseSize);
+
+        if (reserved != NULL)
+        {
+            for (unsigned int i = 0; i < numSegments; i++)
+            {
+                memcpy(reserved, segments[i], segmentSizes[i]);
+                reserved += segmentSizes[i];
+            }
+
+            return smCommitPut(inSharedMemoryName, responseSize);
+        }
+
+        // no region is free for the whole response, so it's put in chunks, each copied straight from the pieces
+        SMSegment smSegments[numSegments];
+
+        for (unsigned int i = 0; i < numSegments; i++)
+        {
+            smSegments[i].pData = segments[i];
+            smSegments[i].dwNumBytes = (unsigned long)segmentSizes[i];
+        }
+
+        return smPutSegments(inSharedMemoryName, smSegments, numSegments);
+    }
+
+    // the old way: put the pieces together, then copy them into the shared memory
+    std::string response;
+
+    for (unsigned int i = 0; i < numSegments; i++)
+    {
+        response.append(segments[i], segmentSizes[i]);
+    }
+
+    return smPut(inSharedMemoryName, (void*)response.data(), responseSize);
+}
+
+//--------------------------------------------------------------------------
+/// Put and get inNumResponses responses with inDataSize bytes of data each,
+/// and return the responses per second; 0 if a response didn't arrive intact.
+//--------------------------------------------------------------------------
+static double RunBenchmark(const char* inSharedMemoryName, PutMethod inMethod, size_t inDataSize, unsigned int inNumResponses)
+{
+    std::string data(inDataSize, 'x');
+
+    for (size_t i = 0; i < inDataSize; i++)
+    {
+        data[i] = (char)('a' + (i % 26));
+    }
+
+    std::string expected = std::string(s_XMLHeader) + "<XML src='" + s_URL + "'>" + data + "</XML>";
+    bool bIntact = true;
+
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+    // the reader, as in the web server
+    std::thread reader([&]()
+    {
+        std::vector<char> buffer(expected.size());
+
+        smLockGet(inSharedMemoryName);
+
+        for (unsigned int responseIndex = 0; responseIndex < inNumResponses; responseIndex++)
+        {
+            gtUInt32 size = smGet(inSharedMemoryName, &buffer[0], (unsigned long)buffer.size());
+
+            if (size != expected.size() || memcmp(&buffer[0], expected.data(), size) != 0)
+            {
+                bIntact = false;
+            }
+        }
+
+        smUnlockGet(inSharedMemoryName);
+    });
+
+    for (unsigned int responseIndex = 0; responseIndex < inNumResponses; responseIndex++)
+    {
+        // the default layout refuses the lock while there isn't room for a buffer header
+        while (smLockPut(inSharedMemoryName, (unsigned long)expected.size(), 1) == false)
+        {
+            std::this_thread::yield();
+        }
+
+        PutResponse(inSharedMemoryName, inMethod, data);
+        smUnlockPut(inSharedMemoryName);
+    }
+
+    reader.join();
+
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    return bIntact ? (inNumResponses / seconds) : 0.0;
+}
+
+int main()
+{
+    if (smCreate(s_SharedMemoryNames[0], s_NumElements, s_ElementSize) == false ||
+        smCreate(s_SharedMemoryNames[1], s_NumElements, s_ElementSize, true) == false)
+    {
+        printf("error: couldn't create the shared memory\n");
+        return 1;
+    }
+
+    printf("%u hardware threads, %lu KB shared memory\n", std::thread::hardware_concurrency(), (s_NumElements * s_ElementSize) / 1024);
+    printf("%-14s %-32s %12s %14s %10s\n", "", "", "data bytes", "responses/s", "MB/s");
+
+    static const size_t s_DataSizes[] = { 256, 64 * 1024, 2 * 1024 * 1024 };
+    static const unsigned int s_NumResponses[] = { 200000, 10000, 200 };
+    static const char* s_LayoutNames[] = { "default", "lock-free ring" };
+    static const char* s_MethodNames[] = { "put together, then smPut", "smReservePut, or smPutSegments" };
+    int result = 0;
+
+    for (unsigned int sizeIndex = 0; sizeIndex < sizeof(s_DataSizes) / sizeof(s_DataSizes[0]); sizeIndex++)
+    {
+        for (unsigned int layout = 0; layout < sizeof(s_SharedMemoryNames) / sizeof(s_SharedMemoryNames[0]); layout++)
+        {
+            for (int method = PUT_COPY; method <= PUT_SERIALIZE_IN_PLACE; method++)
+            {
+                double responsesPerSecond = RunBenchmark(s_SharedMemoryNames[layout], (PutMethod)method, s_DataSizes[sizeIndex], s_NumResponses[sizeIndex]);
+
+                if (responsesPerSecond == 0.0)
+                {
+                    printf("error: a response didn't arrive intact\n");
+                    result = 1;
+                }
+
+                printf("%-14s %-32s %12u %14.0f %10.1f\n", s_LayoutNames[layout], s_MethodNames[method], (unsigned int)s_DataSizes[sizeIndex], responsesPerSecond,
+                       (responsesPerSecond * s_DataSizes[sizeIndex]) / (1024.0 * 1024.0));
+            }
+        }
+    }
+
+    smClose(s_SharedMemoryNames[0]);
+    smClose(s_SharedMemoryNames[1]);
+
+    return result;
+}
@@ -0,0 +1,270 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Stress benchmark for the ThreadTraceRegistry. N threads each log M
+///         calls the way DX12TraceAnalyzerLayer::LogAPICall does, once through
+///         the registry and each thread's own lock, and once through a std::map
+///         lookup under one global lock, which is how calls used to be logged.
+///         A frame thread clears every thread's buffer while they log.
+///
+///         Built on Linux against the AMDTOSWrappers and AMDTBaseTools libraries:
+///         g++ -std=c++11 -O2 -D_LINUX -I.. -I../Linux -I../../../../CommonProjects
+///             ThreadTraceRegistryBenchmark.cpp ../ThreadTraceRegistry.cpp
+///             -lAMDTOSWrappers -lAMDTBaseTools -lpthread
+//==============================================================================
+
+#if defined (_LINUX)
+    #include "WinDefs.h"
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <thread>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../ArenaAllocator.h"
+#include "../ThreadTraceRegistry.h"
+#include "../mymutex.h"
+
+//--------------------------------------------------------------------------
+/// The number of calls each thread logs.
+//--------------------------------------------------------------------------
+static const unsigned int s_CallsPerThread = 1000000;
+
+//--------------------------------------------------------------------------
+/// The interval between the frame thread clearing every thread's buffer.
+//--------------------------------------------------------------------------
+static const unsigned int s_FrameIntervalMs = 16;
+
+//--------------------------------------------------------------------------
+/// The size of the entry logged for each call. Roughly the size of a DX12APIEntry.
+//--------------------------------------------------------------------------
+static const size_t s_EntrySize = 64;
+
+//--------------------------------------------------------------------------
+/// Stands in for ThreadTraceData: an arena of entries, the list of logged entries and the thread's lock.
+//--------------------------------------------------------------------------
+class ThreadTraceData
+{
+public:
+    //--------------------------------------------------------------------------
+    /// Log a call into this thread's buffer.
+    //--------------------------------------------------------------------------
+    void LogCall()
+    {
+        mLoggedCallVector.push_back(mEntryArena.Allocate(s_EntrySize, sizeof(UINT64)));
+    }
+
+    //--------------------------------------------------------------------------
+    /// Discard all logged calls.
+    //--------------------------------------------------------------------------
+    void Clear()
+    {
+        mLoggedCallVector.clear();
+        mEntryArena.Reset();
+    }
+
+    /// The logged entries.
+    std::vector<void*> mLoggedCallVector;
+
+    /// The memory the entries are allocated from.
+    ArenaAllocator mEntryArena;
+
+    /// Serializes logging with clearing.
+    mutex mEntryLock;
+};
+
+//--------------------------------------------------------------------------
+/// The way calls used to be logged: every call looks up its thread in a map under one global lock.
+//--------------------------------------------------------------------------
+class GlobalLockLogger
+{
+public:
+    //--------------------------------------------------------------------------
+    /// Destructor frees each thread's buffer.
+    //--------------------------------------------------------------------------
+    ~GlobalLockLogger()
+    {
+        for (std::map<DWORD, ThreadTraceData*>::iterator it = mThreadTraces.begin(); it != mThreadTraces.end(); ++it)
+        {
+            delete it->second;
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// Log a call from the calling thread.
+    //--------------------------------------------------------------------------
+    void LogCall(DWORD inThreadId)
+    {
+        ScopeLock traceLock(&mTraceMutex);
+
+        std::map<DWORD, ThreadTraceData*>::iterator it = mThreadTraces.find(inThreadId);
+        ThreadTraceData* threadData = NULL;
+
+        if (it == mThreadTraces.end())
+        {
+            threadData = new ThreadTraceData();
+            mThreadTraces[inThreadId] = threadData;
+        }
+        else
+        {
+            threadData = it->second;
+        }
+
+        threadData->LogCall();
+    }
+
+    //--------------------------------------------------------------------------
+    /// Clear every thread's buffer, as happens at the start of each traced frame.
+    //--------------------------------------------------------------------------
+    void ClearAll()
+    {
+        ScopeLock traceLock(&mTraceMutex);
+
+        for (std::map<DWORD, ThreadTraceData*>::iterator it = mThreadTraces.begin(); it != mThreadTraces.end(); ++it)
+        {
+            it->second->Clear();
+        }
+    }
+
+private:
+    /// Each thread's buffer.
+    std::map<DWORD, ThreadTraceData*> mThreadTraces;
+
+    /// The global lock taken by every call.
+    mutex mTraceMutex;
+};
+
+//--------------------------------------------------------------------------
+/// The way calls are logged now: each thread finds its buffer through the registry and only takes its own lock.
+//--------------------------------------------------------------------------
+class RegistryLogger
+{
+public:
+    //--------------------------------------------------------------------------
+    /// Destructor frees each thread's buffer.
+    //--------------------------------------------------------------------------
+    ~RegistryLogger()
+    {
+        unsigned int numThreads = mThreadTraces.GetNumThreads();
+
+        for (unsigned int threadIndex = 0; threadIndex < numThreads; ++threadIndex)
+        {
+            DWORD threadId = 0;
+            delete mThreadTraces.GetThreadData(threadIndex, threadId);
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    /// Log a call from the calling thread.
+    //--------------------------------------------------------------------------
+    void LogCall(DWORD inThreadId)
+    {
+        ThreadTraceData* threadData = mThreadTraces.GetCurrentThreadData();
+
+        if (threadData == NULL)
+        {
+            threadData = new ThreadTraceData();
+            mThreadTraces.Register(inThreadId, threadData);
+        }
+
+        ScopeLock entryLock(&threadData->mEntryLock);
+        threadData->LogCall();
+    }
+
+    //--------------------------------------------------------------------------
+    /// Clear every thread's buffer, as happens at the start of each traced frame.
+    //--------------------------------------------------------------------------
+    void ClearAll()
+    {
+        unsigned int numThreads = mThreadTraces.GetNumThreads();
+
+        for (unsigned int threadIndex = 0; threadIndex < numThreads; ++threadIndex)
+        {
+            DWORD threadId = 0;
+            ThreadTraceData* threadData = mThreadTraces.GetThreadData(threadIndex, threadId);
+
+            if (threadData != NULL)
+            {
+                ScopeLock entryLock(&threadData->mEntryLock);
+                threadData->Clear();
+            }
+        }
+    }
+
+private:
+    /// Each thread's buffer.
+    ThreadTraceRegistry mThreadTraces;
+};
+
+//--------------------------------------------------------------------------
+/// Run N logging threads and a frame thread against a logger.
+/// \param inNumThreads The number of logging threads.
+/// \returns The number of calls logged per second across all threads.
+//--------------------------------------------------------------------------
+template <typename LoggerType>
+static double RunBenchmark(unsigned int inNumThreads)
+{
+    LoggerType logger;
+    std::atomic<bool> bLogging(true);
+
+    std::thread frameThread([&]()
+    {
+        while (bLogging.load())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(s_FrameIntervalMs));
+            logger.ClearAll();
+        }
+    });
+
+    std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> loggingThreads;
+
+    for (unsigned int threadIndex = 0; threadIndex < inNumThreads; ++threadIndex)
+    {
+        loggingThreads.push_back(std::thread([&logger, threadIndex]()
+        {
+            for (unsigned int callIndex = 0; callIndex < s_CallsPerThread; ++callIndex)
+            {
+                logger.LogCall(threadIndex + 1);
+            }
+        }));
+    }
+
+    for (unsigned int threadIndex = 0; threadIndex < inNumThreads; ++threadIndex)
+    {
+        loggingThreads[threadIndex].join();
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - startTime;
+
+    bLogging.store(false);
+    frameThread.join();
+
+    return (static_cast<double>(inNumThreads) * s_CallsPerThread) / elapsed.count();
+}
+
+//--------------------------------------------------------------------------
+/// Print calls per second for each thread count, for both loggers.
+/// An optional argument gives the largest thread count to run.
+//--------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+    unsigned int maxThreads = (argc > 1) ? static_cast<unsigned int>(atoi(argv[1])) : 16;
+
+    printf("%8s %20s %20s\n", "threads", "global lock Mcall/s", "registry Mcall/s");
+
+    for (unsigned int numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+    {
+        double globalLockRate = RunBenchmark<GlobalLockLogger>(numThreads);
+        double registryRate = RunBenchmark<RegistryLogger>(numThreads);
+
+        printf("%8u %20.1f %20.1f\n", numThreads, globalLockRate / 1000000.0, registryRate / 1000000.0);
+    }
+
+    return 0;
+}
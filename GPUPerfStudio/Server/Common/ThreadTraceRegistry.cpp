@@ -0,0 +1,157 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  A lock-free, append-only registry of the per-thread trace buffers.
+//==============================================================================
+
+#include "ThreadTraceRegistry.h"
+#include "misc.h"
+#include <AMDTOSWrappers/Include/osThreadLocalData.h>
+
+//--------------------------------------------------------------------------
+/// Constructor marks all of the block's slots as empty.
+//--------------------------------------------------------------------------
+ThreadTraceRegistry::RegistryBlock::RegistryBlock()
+{
+    for (unsigned int slotIndex = 0; slotIndex < s_ThreadsPerRegistryBlock; ++slotIndex)
+    {
+        mSlots[slotIndex].mThreadId = 0;
+        mSlots[slotIndex].mThreadData.store(NULL, std::memory_order_relaxed);
+    }
+
+    mNextBlock.store(NULL, std::memory_order_relaxed);
+}
+
+//--------------------------------------------------------------------------
+/// Constructor allocates the thread-local storage used to cache each thread's instance.
+//--------------------------------------------------------------------------
+ThreadTraceRegistry::ThreadTraceRegistry()
+    : mNumSlots(0)
+    , mThreadDataTLS(0)
+{
+    if (!osAllocateThreadsLocalData(mThreadDataTLS))
+    {
+        Log(logERROR, "Failed to allocate thread-local storage for the thread trace registry.\n");
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Destructor releases the registry's slots and thread-local storage.
+//--------------------------------------------------------------------------
+ThreadTraceRegistry::~ThreadTraceRegistry()
+{
+    RegistryBlock* currentBlock = mFirstBlock.mNextBlock.load(std::memory_order_acquire);
+
+    while (currentBlock != NULL)
+    {
+        RegistryBlock* nextBlock = currentBlock->mNextBlock.load(std::memory_order_acquire);
+        SAFE_DELETE(currentBlock);
+        currentBlock = nextBlock;
+    }
+
+    osFreeThreadsLocalData(mThreadDataTLS);
+}
+
+//--------------------------------------------------------------------------
+/// Retrieve the ThreadTraceData instance registered by the calling thread.
+/// \returns The calling thread's instance, or NULL if the thread hasn't registered one yet.
+//--------------------------------------------------------------------------
+ThreadTraceData* ThreadTraceRegistry::GetCurrentThreadData() const
+{
+    return static_cast<ThreadTraceData*>(osGetCurrentThreadLocalData(mThreadDataTLS));
+}
+
+//--------------------------------------------------------------------------
+/// Register a ThreadTraceData instance for the calling thread. Safe to call from multiple threads at once.
+/// \param inThreadId The Id of the calling thread.
+/// \param inThreadData The instance that the calling thread will log to.
+//--------------------------------------------------------------------------
+void ThreadTraceRegistry::Register(DWORD inThreadId, ThreadTraceData* inThreadData)
+{
+    // Claim a slot. Readers will see it as empty until the ThreadTraceData pointer is published below.
+    unsigned int slotIndex = mNumSlots.fetch_add(1, std::memory_order_acq_rel);
+    RegistryBlock* slotBlock = FindOrCreateBlock(slotIndex);
+
+    RegistrySlot& newSlot = slotBlock->mSlots[slotIndex % s_ThreadsPerRegistryBlock];
+    newSlot.mThreadId = inThreadId;
+    newSlot.mThreadData.store(inThreadData, std::memory_order_release);
+
+    osSetCurrentThreadLocalData(mThreadDataTLS, inThreadData);
+}
+
+//--------------------------------------------------------------------------
+/// Retrieve a registered ThreadTraceData instance.
+/// \param inSlotIndex The index of the slot to retrieve. Must be less than GetNumThreads().
+/// \param outThreadId The Id of the thread that registered the instance.
+/// \returns The instance in the given slot, or NULL if the registering thread hasn't finished filling it in.
+//--------------------------------------------------------------------------
+ThreadTraceData* ThreadTraceRegistry::GetThreadData(unsigned int inSlotIndex, DWORD& outThreadId) const
+{
+    ThreadTraceData* resultThreadData = NULL;
+    const RegistryBlock* slotBlock = FindBlock(inSlotIndex);
+
+    if (slotBlock != NULL)
+    {
+        const RegistrySlot& slot = slotBlock->mSlots[inSlotIndex % s_ThreadsPerRegistryBlock];
+        resultThreadData = slot.mThreadData.load(std::memory_order_acquire);
+
+        if (resultThreadData != NULL)
+        {
+            outThreadId = slot.mThreadId;
+        }
+    }
+
+    return resultThreadData;
+}
+
+//--------------------------------------------------------------------------
+/// Find the block that holds a slot.
+/// \param inSlotIndex The index of the slot to find the block for.
+/// \returns The block that holds the slot, or NULL if the block hasn't been appended yet.
+//--------------------------------------------------------------------------
+const ThreadTraceRegistry::RegistryBlock* ThreadTraceRegistry::FindBlock(unsigned int inSlotIndex) const
+{
+    const RegistryBlock* currentBlock = &mFirstBlock;
+
+    for (unsigned int blockIndex = inSlotIndex / s_ThreadsPerRegistryBlock; blockIndex > 0 && currentBlock != NULL; --blockIndex)
+    {
+        currentBlock = currentBlock->mNextBlock.load(std::memory_order_acquire);
+    }
+
+    return currentBlock;
+}
+
+//--------------------------------------------------------------------------
+/// Find the block that holds a slot, appending new blocks to the registry until it exists.
+/// \param inSlotIndex The index of the slot to find the block for.
+/// \returns The block that holds the slot.
+//--------------------------------------------------------------------------
+ThreadTraceRegistry::RegistryBlock* ThreadTraceRegistry::FindOrCreateBlock(unsigned int inSlotIndex)
+{
+    RegistryBlock* currentBlock = &mFirstBlock;
+
+    for (unsigned int blockIndex = inSlotIndex / s_ThreadsPerRegistryBlock; blockIndex > 0; --blockIndex)
+    {
+        RegistryBlock* nextBlock = currentBlock->mNextBlock.load(std::memory_order_acquire);
+
+        if (nextBlock == NULL)
+        {
+            // Try to append a new block. If another thread beat us to it, use theirs instead.
+            RegistryBlock* newBlock = new RegistryBlock();
+
+            if (currentBlock->mNextBlock.compare_exchange_strong(nextBlock, newBlock, std::memory_order_acq_rel))
+            {
+                nextBlock = newBlock;
+            }
+            else
+            {
+                SAFE_DELETE(newBlock);
+            }
+        }
+
+        currentBlock = nextBlock;
+    }
+
+    return currentBlock;
+}
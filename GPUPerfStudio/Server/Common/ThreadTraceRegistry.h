@@ -0,0 +1,144 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  A lock-free, append-only registry of the per-thread trace buffers.
+//==============================================================================
+
+#ifndef THREADTRACEREGISTRY_H
+#define THREADTRACEREGISTRY_H
+
+#if defined (_LINUX)
+    #include "WinDefs.h"
+#endif
+
+#include <atomic>
+#include <AMDTOSWrappers/Include/osOSDefinitions.h>
+
+class ThreadTraceData;
+
+//--------------------------------------------------------------------------
+/// The number of thread slots allocated at a time within the ThreadTraceRegistry.
+//--------------------------------------------------------------------------
+static const unsigned int s_ThreadsPerRegistryBlock = 64;
+
+//--------------------------------------------------------------------------
+/// ThreadTraceRegistry keeps track of the ThreadTraceData instance that each traced
+/// thread logs into. Each thread caches its own instance in thread-local storage, so
+/// finding it never requires a lookup or a lock. The registry itself is an append-only
+/// list of slots that can be registered into from any number of threads at once, and
+/// can be walked while new threads are being registered.
+/// The registry does not own the ThreadTraceData instances that are registered into it.
+//--------------------------------------------------------------------------
+class ThreadTraceRegistry
+{
+public:
+    //--------------------------------------------------------------------------
+    /// Constructor allocates the thread-local storage used to cache each thread's instance.
+    //--------------------------------------------------------------------------
+    ThreadTraceRegistry();
+
+    //--------------------------------------------------------------------------
+    /// Destructor releases the registry's slots and thread-local storage.
+    //--------------------------------------------------------------------------
+    ~ThreadTraceRegistry();
+
+    //--------------------------------------------------------------------------
+    /// Retrieve the ThreadTraceData instance registered by the calling thread.
+    /// \returns The calling thread's instance, or NULL if the thread hasn't registered one yet.
+    //--------------------------------------------------------------------------
+    ThreadTraceData* GetCurrentThreadData() const;
+
+    //--------------------------------------------------------------------------
+    /// Register a ThreadTraceData instance for the calling thread. Safe to call from multiple threads at once.
+    /// \param inThreadId The Id of the calling thread.
+    /// \param inThreadData The instance that the calling thread will log to.
+    //--------------------------------------------------------------------------
+    void Register(DWORD inThreadId, ThreadTraceData* inThreadData);
+
+    //--------------------------------------------------------------------------
+    /// Retrieve the number of slots that have been claimed in the registry.
+    /// \returns The number of slots that can be passed to GetThreadData.
+    //--------------------------------------------------------------------------
+    unsigned int GetNumThreads() const { return mNumSlots.load(std::memory_order_acquire); }
+
+    //--------------------------------------------------------------------------
+    /// Retrieve a registered ThreadTraceData instance.
+    /// \param inSlotIndex The index of the slot to retrieve. Must be less than GetNumThreads().
+    /// \param outThreadId The Id of the thread that registered the instance.
+    /// \returns The instance in the given slot, or NULL if the registering thread hasn't finished filling it in.
+    //--------------------------------------------------------------------------
+    ThreadTraceData* GetThreadData(unsigned int inSlotIndex, DWORD& outThreadId) const;
+
+private:
+    //--------------------------------------------------------------------------
+    /// Disable copying, since the registry owns its slots.
+    //--------------------------------------------------------------------------
+    ThreadTraceRegistry(const ThreadTraceRegistry&);
+
+    //--------------------------------------------------------------------------
+    /// Disable assignment, since the registry owns its slots.
+    //--------------------------------------------------------------------------
+    ThreadTraceRegistry& operator=(const ThreadTraceRegistry&);
+
+    //--------------------------------------------------------------------------
+    /// A single registered thread. The ThreadTraceData pointer is published last, so a
+    /// non-NULL pointer means the thread Id is valid too.
+    //--------------------------------------------------------------------------
+    struct RegistrySlot
+    {
+        /// The Id of the thread that registered this slot.
+        DWORD mThreadId;
+
+        /// The instance that the thread logs to.
+        std::atomic<ThreadTraceData*> mThreadData;
+    };
+
+    //--------------------------------------------------------------------------
+    /// A fixed-size group of slots. Blocks are linked together and are never freed until the registry is destroyed.
+    //--------------------------------------------------------------------------
+    struct RegistryBlock
+    {
+        //--------------------------------------------------------------------------
+        /// Constructor marks all of the block's slots as empty.
+        //--------------------------------------------------------------------------
+        RegistryBlock();
+
+        /// The slots within this block.
+        RegistrySlot mSlots[s_ThreadsPerRegistryBlock];
+
+        /// The next block in the registry, or NULL if this is the last one.
+        std::atomic<RegistryBlock*> mNextBlock;
+    };
+
+    //--------------------------------------------------------------------------
+    /// Find the block that holds a slot.
+    /// \param inSlotIndex The index of the slot to find the block for.
+    /// \returns The block that holds the slot, or NULL if the block hasn't been appended yet.
+    //--------------------------------------------------------------------------
+    const RegistryBlock* FindBlock(unsigned int inSlotIndex) const;
+
+    //--------------------------------------------------------------------------
+    /// Find the block that holds a slot, appending new blocks to the registry until it exists.
+    /// \param inSlotIndex The index of the slot to find the block for.
+    /// \returns The block that holds the slot.
+    //--------------------------------------------------------------------------
+    RegistryBlock* FindOrCreateBlock(unsigned int inSlotIndex);
+
+    //--------------------------------------------------------------------------
+    /// The first block of slots. Enough for most applications, so that no further blocks are needed.
+    //--------------------------------------------------------------------------
+    RegistryBlock mFirstBlock;
+
+    //--------------------------------------------------------------------------
+    /// The number of slots claimed by registering threads.
+    //--------------------------------------------------------------------------
+    std::atomic<unsigned int> mNumSlots;
+
+    //--------------------------------------------------------------------------
+    /// The thread-local storage used to cache each thread's ThreadTraceData instance.
+    //--------------------------------------------------------------------------
+    osTheadLocalDataHandle mThreadDataTLS;
+};
+
+#endif // THREADTRACEREGISTRY_H
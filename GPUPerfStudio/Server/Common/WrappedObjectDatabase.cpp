@@ -18,4 +18,13 @@ WrappedObjectDatabase::WrappedObjectDatabase()
 //////////////////////////////////////////////////////////////////////////
 WrappedObjectDatabase::~WrappedObjectDatabase()
 {
-}
\ No newline at end of file
+}
+
+//--------------------------------------------------------------------------
+/// Flag an object instance as destroyed, and let the object tree index know about it.
+/// \param inDestroyedInstance The wrapped instance of the object that was destroyed.
+//--------------------------------------------------------------------------
+void WrappedObjectDatabase::OnInstanceDestroyed(IInstanceBase* inDestroyedInstance)
+{
+    mObjectTreeIndex.OnInstanceDestroyed(inDestroyedInstance);
+}
@@ -10,6 +10,7 @@
 
 #include <map>
 #include "../Common/misc.h" // For mutex
+#include "ObjectTreeIndex.h"
 
 #define CASE(res, enumCase) case enumCase: res = #enumCase; break;
 
@@ -68,6 +69,18 @@ public:
     //--------------------------------------------------------------------------
     inline void TrackObjectLifetime(bool inbTrackingObjects) {mbTrackingInstances = inbTrackingObjects; }
 
+    //--------------------------------------------------------------------------
+    /// Flag an object instance as destroyed, and let the object tree index know about it.
+    /// \param inDestroyedInstance The wrapped instance of the object that was destroyed.
+    //--------------------------------------------------------------------------
+    void OnInstanceDestroyed(IInstanceBase* inDestroyedInstance);
+
+    //--------------------------------------------------------------------------
+    /// Retrieve the index of object instances grouped by parent device and type.
+    /// \returns The object tree index for this database.
+    //--------------------------------------------------------------------------
+    inline ObjectTreeIndex& GetObjectTreeIndex() { return mObjectTreeIndex; }
+
 protected:
     //--------------------------------------------------------------------------
     /// Lock the object map whenever we add or remove an object.
@@ -89,6 +102,11 @@ protected:
     /// instances that use the same handle over the history of the application run.
     //--------------------------------------------------------------------------
     WrappedInstanceVector mAllObjectInstances;
+
+    //--------------------------------------------------------------------------
+    /// Every instance added to the database, grouped by parent device and type.
+    //--------------------------------------------------------------------------
+    ObjectTreeIndex mObjectTreeIndex;
 };
 
 #endif // WRAPPEDOBJECTDATABASE_H
@@ -618,6 +618,7 @@ public:
     virtual ~InterceptorBase() {}
     virtual void SetCollectTrace(bool inbCollectTrace) = 0;
     virtual void SetProfilingEnabled(bool inbProfilingEnabled) = 0;
+    virtual void SetFormatArguments(bool inbFormatArguments) = 0;
     virtual ModernAPILayerManager* GetParentLayerManager() = 0;
 };
 
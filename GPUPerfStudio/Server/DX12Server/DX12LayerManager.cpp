@@ -325,16 +325,15 @@ void DX12LayerManager::GetFrameInfo(FrameInfo& outFrameInfo)
 //--------------------------------------------------------------------------
 /// Entrypoint for the DX12Server plugin. Short rundown:
 /// On DLL_PROCESS_ATTACH, initialize the DX12LayerManager.
-/// On DLL_PROCESS_DETACH, kill and destroy the DX12LayerManager.
+/// On DLL_PROCESS_DETACH, kill and destroy the DX12LayerManager, then flush and stop the logger.
 /// \param hModule The module associated with this invocation of *this* DllMain.
 /// \param dwReason The reason that this function is being invoked.
-/// \param pReserved Reserved mystery pointer.
+/// \param pReserved For DLL_PROCESS_DETACH, non-NULL if the process is terminating rather than unloading the DLL.
 /// \returns See http://msdn.microsoft.com/en-us/library/windows/desktop/ms682583(v=vs.85).aspx to understand this.
 //--------------------------------------------------------------------------
 BOOL APIENTRY DllMain(HINSTANCE hModule, DWORD dwReason, VOID* pReserved)
 {
     UNREFERENCED_PARAMETER(hModule);
-    UNREFERENCED_PARAMETER(pReserved);
 
     Log(logTRACE, "DX12Server2's DllMain hit with reason '%d'\n", dwReason);
 
@@ -370,6 +369,11 @@ BOOL APIENTRY DllMain(HINSTANCE hModule, DWORD dwReason, VOID* pReserved)
             {
                 Log(logERROR, "DX12Server shutdown: The DX12LayerManager was not initialized.\n");
             }
+
+            // Stop the background log writer last, so everything logged during shutdown reaches the logfile.
+            // When the process is terminating, the writer thread has already been killed.
+            LogFooter();
+            LogShutdown(pReserved != NULL);
         }
         break;
     }
@@ -36,8 +36,63 @@ const char* DX12APIEntry::GetAPIName() const
 //--------------------------------------------------------------------------
 void DX12APIEntry::AppendAPITraceLine(std::stringstream& ioTraceResponse, double inStartTime, double inEndTime) const
 {
+    std::string interfaceString;
+    std::string functionNameString;
+    gtASCIIString parameterString;
     gtASCIIString returnValueString;
-    DX12Util::PrintReturnValue(mReturnValue, returnValueString);
+    GetTraceLineStrings(interfaceString, functionNameString, parameterString, returnValueString);
+
+    FormatAPITraceLine(ioTraceResponse,
+                       mThreadId,
+                       DX12TraceAnalyzerLayer::Instance()->GetAPIGroupFromAPI(mFunctionId),
+                       mFunctionId,
+                       interfaceString.c_str(),
+                       functionNameString.c_str(),
+                       parameterString.asCharArray(),
+                       returnValueString.asCharArray(),
+                       inStartTime,
+                       inEndTime,
+                       mSampleId);
+}
+
+//--------------------------------------------------------------------------
+/// Add a DX12 call to a binary trace. The strings match the ones written by AppendAPITraceLine.
+/// \param ioTraceWriter The binary trace writer to add the call to.
+/// \param inStartTime The start time for the API call.
+/// \param inEndTime The end time for the API call.
+//--------------------------------------------------------------------------
+void DX12APIEntry::AppendBinaryTraceCall(BinaryTraceWriter& ioTraceWriter, double inStartTime, double inEndTime) const
+{
+    std::string interfaceString;
+    std::string functionNameString;
+    gtASCIIString parameterString;
+    gtASCIIString returnValueString;
+    GetTraceLineStrings(interfaceString, functionNameString, parameterString, returnValueString);
+
+    ioTraceWriter.AddCall(DX12TraceAnalyzerLayer::Instance()->GetAPIGroupFromAPI(mFunctionId),
+                          mFunctionId,
+                          interfaceString.c_str(),
+                          functionNameString.c_str(),
+                          parameterString.asCharArray(),
+                          returnValueString.asCharArray(),
+                          inStartTime,
+                          inEndTime,
+                          mSampleId);
+}
+
+//--------------------------------------------------------------------------
+/// Build the text fields of this call's API Trace response line.
+/// \param outInterface The interface handle.
+/// \param outFunctionName The "Interface_FunctionName" string.
+/// \param outParameters The call's parameters.
+/// \param outReturnValue The call's return value.
+//--------------------------------------------------------------------------
+void DX12APIEntry::GetTraceLineStrings(std::string& outInterface, std::string& outFunctionName, gtASCIIString& outParameters, gtASCIIString& outReturnValue) const
+{
+    DX12Util::PrintReturnValue(mReturnValue, outReturnValue);
+
+    // Packed arguments are converted to text here, while the response is being built.
+    GetParameterString(outParameters);
 
     // Use the database processor to get a pointer to the object database.
     DX12ObjectDatabaseProcessor* databaseProcessor = DX12ObjectDatabaseProcessor::Instance();
@@ -46,39 +101,14 @@ void DX12APIEntry::AppendAPITraceLine(std::stringstream& ioTraceResponse, double
     // Use the object database to retrieve wrapper info for the given interface.
     IDX12InstanceBase* wrapperInfo = objectDatabase->GetMetadataObject(mWrapperInterface);
 
-#if defined(CODEXL_GRAPHICS)
-    // Below is an API Trace response that "CodeXL Graphics" understands how to parse.
-
-    // APIType APIFunctionId InterfacePtr D3D12Interface_FunctionName(Parameters) = ReturnValue StartMillisecond EndMillisecond SampleId
-    ioTraceResponse
-            << DX12TraceAnalyzerLayer::Instance()->GetAPIGroupFromAPI(mFunctionId) << " "
-            << mFunctionId << " "
-            << "0x" << wrapperInfo->GetApplicationHandle() << " "
-            << wrapperInfo->GetTypeAsString() << "_"
-            << GetAPIName()
-            << "(" << mParameters.asCharArray() << ") = "
-            << returnValueString.asCharArray()
-            << " " << std::fixed << inStartTime    // We don't want this number to get converted to scientific noation. Used std::fixed.
-            << " " << std::fixed << inEndTime
-            << " " << mSampleId
-            << std::endl;  // Finish the string with a newline to play nice with the next logged call.
-#else
-    // Below is an API Trace response that GPUPerfStudio understands how to parse.
-
-    // Each logged call follows a specific format as it's inserted into a response string. This format is mirrored in client code:
-    // ThreadId Interface_FunctionName(Parameters) = ReturnValue StartTime EndTime SampleId
-    ioTraceResponse
-            << mThreadId << " "
-            << "0x" << wrapperInfo->GetApplicationHandle() << " "
-            << wrapperInfo->GetTypeAsString() << "_"
-            << GetAPIName()
-            << "(" << mParameters.asCharArray() << ") = "
-            << returnValueString.asCharArray()
-            << " " << std::fixed << inStartTime    // We don't want this number to get converted to scientific noation. Used std::fixed.
-            << " " << std::fixed << inEndTime
-            << " " << mSampleId
-            << std::endl;  // Finish the string with a newline to play nice with the next logged call.
-#endif
+    // Format the handle and name through a stream, so they're written the way the response has always written them.
+    std::stringstream interfaceString;
+    interfaceString << "0x" << wrapperInfo->GetApplicationHandle();
+    outInterface = interfaceString.str();
+
+    std::stringstream functionNameString;
+    functionNameString << wrapperInfo->GetTypeAsString() << "_" << GetAPIName();
+    outFunctionName = functionNameString.str();
 }
 
 //--------------------------------------------------------------------------
@@ -328,7 +358,9 @@ std::string DX12TraceAnalyzerLayer::GetGPUTraceTXT()
 
             // Convert the functionID and return values from integers into full strings that we can use in the response.
             const char* functionName = GetFunctionNameFromId(entry->mFunctionId);
-            const char* parameters = entry->mParameters.asCharArray();
+            gtASCIIString parameterString;
+            entry->GetParameterString(parameterString);
+            const char* parameters = parameterString.asCharArray();
 
             // If we're using the new response format, we write each line a little differently.
 #if defined(CODEXL_GRAPHICS)
@@ -376,6 +408,9 @@ std::string DX12TraceAnalyzerLayer::GetGPUTraceTXT()
 
 #else
 
+    // Command lists are only retired during ExecuteCommandLists. Wait for any that are still in flight, and store their results.
+    static_cast<DX12Interceptor*>(GetInterceptor())->CollectPendingProfilerResults();
+
     // During QueueSubmit we stored ProfilerResults in mEntriesWithProfilingResults. Form a response using it here.
     if (!mEntriesWithProfilingResults.empty())
     {
@@ -417,7 +452,9 @@ std::string DX12TraceAnalyzerLayer::GetGPUTraceTXT()
 
                 // Convert the functionID and return values from integers into full strings that we can use in the response.
                 const char* pFunctionName = GetFunctionNameFromId(pResultEntry->mFunctionId);
-                const char* pParameters = pResultEntry->mParameters.asCharArray();
+                gtASCIIString parameterString;
+                pResultEntry->GetParameterString(parameterString);
+                const char* pParameters = parameterString.asCharArray();
 
                 gtASCIIString returnValueString;
                 DX12Util::PrintReturnValue(pResultEntry->mReturnValue, returnValueString);
@@ -479,6 +516,8 @@ std::string DX12TraceAnalyzerLayer::GetGPUTraceTXT()
 //--------------------------------------------------------------------------
 void DX12TraceAnalyzerLayer::StoreProfilerResult(DX12APIEntry* inEntry)
 {
+    // Profiled calls complete on every thread that records command lists.
+    ScopeLock resultsLock(&mProfilingResultsMutex);
     mSampleIdToEntry[inEntry->mSampleId] = inEntry;
 }
 
@@ -510,10 +549,48 @@ InterceptorBase* DX12TraceAnalyzerLayer::GetInterceptor()
 //--------------------------------------------------------------------------
 DX12APIEntry* DX12TraceAnalyzerLayer::LogAPICall(IUnknown* inWrappedInterface, FuncId inFunctionId, const char* inArguments, INT64 inReturnValue)
 {
-    ScopeLock logAPICallLock(&mTraceMutex);
+    // Create a new entry for this traced API call within the thread's arena, and add it to the list for the current thread.
+    // Only this thread's own lock is taken, so threads never wait on each other to log.
+    ThreadTraceData* currentThreadData = GetCurrentThreadTraceData(inFunctionId);
+    ScopeLock entryLock(&currentThreadData->mEntryLock);
+    void* entryMemory = currentThreadData->AllocateEntryMemory(sizeof(DX12APIEntry));
+    const char* argumentsCopy = currentThreadData->CopyParameterString(inArguments);
+
+    DX12APIEntry* newEntry = new(entryMemory) DX12APIEntry(osGetCurrentThreadId(), inWrappedInterface, inFunctionId, argumentsCopy, inReturnValue);
+    currentThreadData->AddAPIEntry(currentThreadData->m_startTime, newEntry);
+
+    return newEntry;
+}
+
+//--------------------------------------------------------------------------
+/// Log a DX12 API call whose arguments were captured in binary form. The arguments
+/// won't be converted to text until the trace response is built.
+/// \param inInterface The interface wrapper being used to invoke the API call.
+/// \param inFunctionId The FuncId for the API function that's being logged.
+/// \param inPackedArguments The packed API call arguments for the function that's being logged.
+/// \param inReturnValue The return value for the API call, or FUNCTION_RETURNS_VOID if there is none.
+/// \returns The newly-created DX12APIEntry instance used to track the info for this API call.
+//--------------------------------------------------------------------------
+DX12APIEntry* DX12TraceAnalyzerLayer::LogAPICall(IUnknown* inWrappedInterface, FuncId inFunctionId, const PackedAPIArguments& inPackedArguments, INT64 inReturnValue)
+{
+    ThreadTraceData* currentThreadData = GetCurrentThreadTraceData(inFunctionId);
+    ScopeLock entryLock(&currentThreadData->mEntryLock);
+    void* entryMemory = currentThreadData->AllocateEntryMemory(sizeof(DX12APIEntry));
+    const PackedAPIArguments* packedArgumentsCopy = currentThreadData->CopyPackedArguments(inPackedArguments);
+
+    DX12APIEntry* newEntry = new(entryMemory) DX12APIEntry(osGetCurrentThreadId(), inWrappedInterface, inFunctionId, packedArgumentsCopy, inReturnValue);
+    currentThreadData->AddAPIEntry(currentThreadData->m_startTime, newEntry);
 
-    (void)inReturnValue;
+    return newEntry;
+}
 
+//--------------------------------------------------------------------------
+/// Find the trace buffer for the calling thread.
+/// \param inFunctionId The FuncId for the API function that's about to be logged.
+/// \returns The ThreadTraceData instance that the calling thread's API calls are logged into.
+//--------------------------------------------------------------------------
+ThreadTraceData* DX12TraceAnalyzerLayer::GetCurrentThreadTraceData(FuncId inFunctionId)
+{
     DWORD threadId = osGetCurrentThreadId();
     ThreadTraceData* currentThreadData = FindOrCreateThreadData(threadId);
 
@@ -523,11 +600,7 @@ DX12APIEntry* DX12TraceAnalyzerLayer::LogAPICall(IUnknown* inWrappedInterface, F
         Log(logERROR, "There was a problem setting the start time for API call '%s' on Thread with Id '%d'.\n", functionNameString, threadId);
     }
 
-    // Create a new entry for this traced API call, and add it to the list for the current thread.
-    DX12APIEntry* newEntry = new DX12APIEntry(threadId, inWrappedInterface, inFunctionId, inArguments, inReturnValue);
-    currentThreadData->AddAPIEntry(currentThreadData->m_startTime, newEntry);
-
-    return newEntry;
+    return currentThreadData;
 }
 
 //--------------------------------------------------------------------------
@@ -966,6 +1039,9 @@ SampleIdToProfilerResultMap* DX12TraceAnalyzerLayer::FindOrCreateProfilerResults
 //--------------------------------------------------------------------------
 void DX12TraceAnalyzerLayer::StoreProfilerResults(GPS_ID3D12CommandQueue* pWrappedQueue, const std::vector<ProfilerResult>& inProfilerResults)
 {
+    // Results can now be harvested from more than one submitting thread.
+    ScopeLock resultsLock(&mProfilingResultsMutex);
+
     SampleIdToProfilerResultMap* pResultMap = FindOrCreateProfilerResultsMap(pWrappedQueue);
     PsAssert(pResultMap != NULL);
 
@@ -1142,11 +1218,20 @@ DX12APIEntry* DX12TraceAnalyzerLayer::FindInvocationBySampleId(UINT64 inSampleId
     DX12APIEntry* pSearchResult = NULL;
 
     // Look within each traced thread for the given SampleId.
-    std::map<DWORD, ThreadTraceData*>::const_iterator traceIter;
+    unsigned int numThreads = mThreadTraces.GetNumThreads();
 
-    for (traceIter = mThreadTraces.begin(); traceIter != mThreadTraces.end(); ++traceIter)
+    for (unsigned int threadIndex = 0; threadIndex < numThreads; ++threadIndex)
     {
-        DX12ThreadTraceData* pThreadTrace = static_cast<DX12ThreadTraceData*>(traceIter->second);
+        DWORD threadId = 0;
+        DX12ThreadTraceData* pThreadTrace = static_cast<DX12ThreadTraceData*>(mThreadTraces.GetThreadData(threadIndex, threadId));
+
+        if (pThreadTrace == NULL)
+        {
+            continue;
+        }
+
+        // The thread may still be logging calls while its profiler results are collected.
+        ScopeLock entryLock(&pThreadTrace->mEntryLock);
         pSearchResult = pThreadTrace->FindInvocationBySampleId(inSampleId);
 
         if (pSearchResult != NULL)
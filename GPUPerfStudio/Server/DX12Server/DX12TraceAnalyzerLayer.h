@@ -42,6 +42,7 @@ typedef std::map<GPS_ID3D12CommandQueue*, SampleIdToProfilerResultMap*> QueueWra
 
 //--------------------------------------------------------------------------
 /// The DX12APIEntry class is used to track all DX12 API calls that are traced at runtime.
+/// Instances live in a ThreadTraceData arena, so this class must remain trivially destructible.
 //--------------------------------------------------------------------------
 class DX12APIEntry : public APIEntry
 {
@@ -49,9 +50,9 @@ public:
     //--------------------------------------------------------------------------
     /// Constructor used to initialize members of new DX12APIEntry instances.
     /// \param inThreadId The thread Id that the call was invoked from.
-    /// \param inArguments The arguments used in the invocation of the API function.
+    /// \param inArguments The arguments used in the invocation of the API function. Must outlive the entry.
     //--------------------------------------------------------------------------
-    DX12APIEntry(DWORD inThreadId, IUnknown* inInterfaceWrapper, FuncId inFunctionId, const std::string& inArguments, INT64 inReturnValue)
+    DX12APIEntry(DWORD inThreadId, IUnknown* inInterfaceWrapper, FuncId inFunctionId, const char* inArguments, INT64 inReturnValue)
         : APIEntry(inThreadId, inFunctionId, inArguments)
         , mWrapperInterface(inInterfaceWrapper)
         , mReturnValue(inReturnValue)
@@ -61,6 +62,21 @@ public:
     {
     }
 
+    //--------------------------------------------------------------------------
+    /// Constructor used to initialize a DX12APIEntry with arguments captured in binary form.
+    /// \param inThreadId The thread Id that the call was invoked from.
+    /// \param inPackedArguments The packed arguments used in the invocation of the API function. Must outlive the entry.
+    //--------------------------------------------------------------------------
+    DX12APIEntry(DWORD inThreadId, IUnknown* inInterfaceWrapper, FuncId inFunctionId, const PackedAPIArguments* inPackedArguments, INT64 inReturnValue)
+        : APIEntry(inThreadId, inFunctionId, inPackedArguments)
+        , mWrapperInterface(inInterfaceWrapper)
+        , mReturnValue(inReturnValue)
+        , mSampleId(0)
+        , preBottomTimestamp(0)
+        , postBottomTimestamp(0)
+    {
+    }
+
     //--------------------------------------------------------------------------
     /// Virtual destructor since this is a derived class.
     //--------------------------------------------------------------------------
@@ -80,6 +96,23 @@ public:
     //--------------------------------------------------------------------------
     virtual void AppendAPITraceLine(std::stringstream& ioTraceResponse, double inStartTime, double inEndTime) const;
 
+    //--------------------------------------------------------------------------
+    /// Add this APIEntry's information to a binary trace.
+    /// \param ioTraceWriter The binary trace writer to add the call to.
+    /// \param inStartTime The start time for the API call.
+    /// \param inEndTime The end time for the API call.
+    //--------------------------------------------------------------------------
+    virtual void AppendBinaryTraceCall(BinaryTraceWriter& ioTraceWriter, double inStartTime, double inEndTime) const;
+
+    //--------------------------------------------------------------------------
+    /// Build the text fields of this call's API Trace response line.
+    /// \param outInterface The interface handle.
+    /// \param outFunctionName The "Interface_FunctionName" string.
+    /// \param outParameters The call's parameters.
+    /// \param outReturnValue The call's return value.
+    //--------------------------------------------------------------------------
+    void GetTraceLineStrings(std::string& outInterface, std::string& outFunctionName, gtASCIIString& outParameters, gtASCIIString& outReturnValue) const;
+
     //--------------------------------------------------------------------------
     /// Check if this logged APIEntry is a Draw call.
     /// \returns True if the API is a draw call. False if it's not.
@@ -281,6 +314,16 @@ public:
     //--------------------------------------------------------------------------
     DX12APIEntry* LogAPICall(IUnknown* inWrappedInterface, FuncId inFunctionId, const char* inArguments, INT64 inReturnValue);
 
+    //--------------------------------------------------------------------------
+    /// Log a DX12 API call whose arguments were captured in binary form.
+    /// \param inInterface The interface wrapper being used to invoke the API call.
+    /// \param inFunctionId The FuncId for the API function that's being logged.
+    /// \param inPackedArguments The packed API call arguments for the function that's being logged.
+    /// \param inReturnValue The return value for the API call, or FUNCTION_RETURNS_VOID if there is none.
+    /// \returns The newly-created DX12APIEntry instance used to track the info for this API call.
+    //--------------------------------------------------------------------------
+    DX12APIEntry* LogAPICall(IUnknown* inWrappedInterface, FuncId inFunctionId, const PackedAPIArguments& inPackedArguments, INT64 inReturnValue);
+
     //--------------------------------------------------------------------------
     /// Associate a set of CommandLists with the CommandQueue that they'll be executed through.
     /// \param inCommandQueueWrapper A CommandQueue instance used to execute CommandLists.
@@ -316,6 +359,13 @@ protected:
     virtual ThreadTraceData* CreateThreadTraceDataInstance();
 
 private:
+    //--------------------------------------------------------------------------
+    /// Find the trace buffer for the calling thread.
+    /// \param inFunctionId The FuncId for the API function that's about to be logged.
+    /// \returns The ThreadTraceData instance that the calling thread's API calls are logged into.
+    //--------------------------------------------------------------------------
+    ThreadTraceData* GetCurrentThreadTraceData(FuncId inFunctionId);
+
     //--------------------------------------------------------------------------
     /// Initialize the set of functions that are able to be profiled.
     //--------------------------------------------------------------------------
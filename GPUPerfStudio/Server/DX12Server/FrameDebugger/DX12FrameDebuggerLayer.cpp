@@ -51,7 +51,7 @@ void DX12FrameDebuggerLayer::EndFrame()
     {
         unsigned char* imageData = NULL;
         unsigned int numBytes = 0;
-        bool bCaptureSuccessful = CaptureBackBuffer(1280, 720, &imageData, &numBytes);
+        bool bCaptureSuccessful = CaptureBackBuffer(1280, 720, &imageData, &numBytes, PNG_COMPRESSION_DEFAULT);
         if (bCaptureSuccessful)
         {
             // Construct a decent filename to write the image out to for testing.
@@ -101,9 +101,10 @@ void DX12FrameDebuggerLayer::OnSwapchainCreated(void* inSwapchain, void* inDevic
 /// \param inHeight The requested height of the captured backbuffer image.
 /// \param ioBackBufferPngData A pointer to the byte array of PNG-encoded image data.
 /// \param outNumBytes The total number of bytes in the array of encoded image data.
+/// \param inPreset PNG_COMPRESSION_FAST if the image is only sent to the client, PNG_COMPRESSION_DEFAULT if it is saved.
 /// \returns True if the back buffer image was captured successfully. False if it failed.
 //--------------------------------------------------------------------------
-bool DX12FrameDebuggerLayer::CaptureBackBuffer(unsigned int inWidth, unsigned int inHeight, unsigned char** ioBackBufferPngData, unsigned int* outNumBytes)
+bool DX12FrameDebuggerLayer::CaptureBackBuffer(unsigned int inWidth, unsigned int inHeight, unsigned char** ioBackBufferPngData, unsigned int* outNumBytes, PngCompressionPreset inPreset)
 {
     bool bCaptureSuccessful = false;
 
@@ -140,7 +141,7 @@ bool DX12FrameDebuggerLayer::CaptureBackBuffer(unsigned int inWidth, unsigned in
                         if (captureResult == S_OK)
                         {
                             // Convert the captured image's pixel data into a PNG byte array.
-                            bCaptureSuccessful = DX12ImageRenderer::CpuImageToPng(&capturedImage, ioBackBufferPngData, outNumBytes);
+                            bCaptureSuccessful = DX12ImageRenderer::CpuImageToPng(&capturedImage, ioBackBufferPngData, outNumBytes, "", inPreset);
                         }
                         else
                         {
@@ -190,7 +191,7 @@ bool DX12FrameDebuggerLayer::HandleBackBufferRequest(PictureCommandResponse& inI
     unsigned char* backBufferImageData = NULL;
     unsigned int numImageBytes = 0;
 
-    bool bCaptureSuccessful = CaptureBackBuffer(imageWidth, imageHeight, &backBufferImageData, &numImageBytes);
+    bool bCaptureSuccessful = CaptureBackBuffer(imageWidth, imageHeight, &backBufferImageData, &numImageBytes, PNG_COMPRESSION_FAST);
     if (bCaptureSuccessful)
     {
         // Send the image back as a chunk of response data.
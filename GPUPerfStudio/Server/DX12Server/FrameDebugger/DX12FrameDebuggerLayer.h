@@ -12,6 +12,7 @@
 #include "../../Common/ILayer.h"
 #include "../../Common/CommandProcessor.h"
 #include "../../Common/TSingleton.h"
+#include "../../Common/ParallelPngEncoder.h"
 #include <unordered_map>
 
 struct IDXGISwapChain;
@@ -82,9 +83,10 @@ private:
     /// \param inHeight The requested height of the captured backbuffer image.
     /// \param ioBackBufferPngData A pointer to the byte array of PNG-encoded image data.
     /// \param outNumBytes The total number of bytes in the array of encoded image data.
+    /// \param inPreset PNG_COMPRESSION_FAST if the image is only sent to the client, PNG_COMPRESSION_DEFAULT if it is saved.
     /// \returns True if the back buffer image was captured successfully. False if it failed.
     //--------------------------------------------------------------------------
-    bool CaptureBackBuffer(unsigned int inWidth, unsigned int inHeight, unsigned char** ioBackBufferPngData, unsigned int* outNumBytes);
+    bool CaptureBackBuffer(unsigned int inWidth, unsigned int inHeight, unsigned char** ioBackBufferPngData, unsigned int* outNumBytes, PngCompressionPreset inPreset);
 
     //--------------------------------------------------------------------------
     /// Handle an incoming image request by sending the image data as a response.
@@ -35,6 +35,27 @@ static const uint64 FIRST_SAMPLE_ID = 0;
 //--------------------------------------------------------------------------
 static DeviceToProfilerMap sDeviceToProfilerMap;
 
+//--------------------------------------------------------------------------
+/// Tracks the sample that a thread has begun for a profiled call, between its PreCall and PostCall.
+//--------------------------------------------------------------------------
+struct ActiveSampleInfo
+{
+    /// The SampleId assigned to the sample.
+    gpa_uint32 mSampleId;
+
+    /// Was a sample started in PreCall? If not, there's nothing to end in PostCall.
+    bool mbSampleActive;
+
+    /// Was BeginSample successful? If so, we can call EndSample.
+    bool mbBeginSampleSuccessful;
+};
+
+//--------------------------------------------------------------------------
+/// Each thread's active sample. A profiled call is begun and ended on the same thread,
+/// so threads recording different command lists never need to share this.
+//--------------------------------------------------------------------------
+__declspec(thread) static ActiveSampleInfo sActiveSample;
+
 //--------------------------------------------------------------------------
 /// Get a device's DX12CmdListProfiler instance.
 /// \param inWrappedInterface Our wrapped object.
@@ -48,7 +69,9 @@ DX12CmdListProfiler* GetProfiler(IUnknown* inWrappedInterface)
     pWrappedGraphicsCommandList->GetDevice(__uuidof(*pDevice), reinterpret_cast<void**>(&pDevice));
     ID3D12Device* pRealDevice = dynamic_cast<GPS_ID3D12DeviceCustom*>(pDevice)->mRealDevice;
 
-    DX12CmdListProfiler* pProfilerInstance = sDeviceToProfilerMap[pRealDevice];
+    // Use find, since this may be called from many threads at once and must not insert into the map.
+    DeviceToProfilerMap::iterator profilerIter = sDeviceToProfilerMap.find(pRealDevice);
+    DX12CmdListProfiler* pProfilerInstance = (profilerIter != sDeviceToProfilerMap.end()) ? profilerIter->second : NULL;
     PsAssert(pProfilerInstance != NULL);
 
     return pProfilerInstance;
@@ -181,6 +204,7 @@ HRESULT WINAPI Mine_D3D12CreateRootSignatureDeserializer(
 DX12Interceptor::DX12Interceptor()
     : mbCollectApiTrace(false)
     , mbProfilerEnabled(false)
+    , mbFormatArguments(true)
     , mSampleIndex(FIRST_SAMPLE_ID)
     , mRealD3D12(NULL)
 {
@@ -268,31 +292,13 @@ bool DX12Interceptor::Shutdown()
     return true;
 }
 
-//--------------------------------------------------------------------------
-/// Given a ThreadID, reserve the next available SampleId for the call that's about to happen in the thread.
-/// \param inThreadId The Id of the thread where the profiled function is about to be invoked.
-/// \returns A new unique Sample Id to be used in profiling with GPA.
-//--------------------------------------------------------------------------
-gpa_uint32 DX12Interceptor::SetNextSampleId(DWORD inThreadId)
-{
-    gpa_uint32 nextId = GetNextSampleId();
-
-    SampleInfo& sampleInfo = mSampleIdMap[inThreadId];
-    sampleInfo.mSampleId = nextId;
-    sampleInfo.mbBeginSampleSuccessful = false;
-
-    return nextId;
-}
-
 //--------------------------------------------------------------------------
 /// Retrieve the next available unique Sample Id.
 /// \returns A unique Sample Id to be used with GPA.
 //--------------------------------------------------------------------------
 gpa_uint32 DX12Interceptor::GetNextSampleId()
 {
-    ScopeLock sampleLock(&mUniqueSampleIdMutex);
-    mSampleIndex++;
-    return mSampleIndex;
+    return mSampleIndex.fetch_add(1, std::memory_order_relaxed) + 1;
 }
 
 //--------------------------------------------------------------------------
@@ -300,12 +306,10 @@ gpa_uint32 DX12Interceptor::GetNextSampleId()
 //--------------------------------------------------------------------------
 void DX12Interceptor::ResetSampleIdCounter()
 {
-    // Probably don't need to lock, but doesn't hurt.
-    ScopeLock sampleLock(&mUniqueSampleIdMutex);
-    mSampleIndex = FIRST_SAMPLE_ID;
-    mSampleIdMap.clear();
+    mSampleIndex.store(FIRST_SAMPLE_ID, std::memory_order_relaxed);
 
     // Clear the count of samples per command list when starting a new frame.
+    ScopeLock gpaLock(&mGPAPrePostMatcherMutex);
     mSamplesPerCommandList.clear();
 }
 
@@ -324,45 +328,42 @@ void DX12Interceptor::PreCall(IUnknown* inWrappedInterface, FuncId inFunctionId)
     // Check if we intend to collect GPU time, and set up GPA to do all the work.
     if (ShouldCollectGPUTime() && traceAnalyzerLayer->ShouldProfileFunction(inFunctionId))
     {
-        // Don't let new sampling begin until this sample is finished with a call to EndSample.
-        LockGPA();
-
         // The only inWrappedInterfaces that get to this point are wrapped ID3D12GraphicsCommandList interfaces.
         // Cast to the wrapper type, and then pass in the real runtime interface.
         GPS_ID3D12GraphicsCommandList* pWrappedGraphicsCommandList = static_cast<GPS_ID3D12GraphicsCommandList*>(inWrappedInterface);
+
+        // Get the next sample ID to use for this call. Associate this thread with the sample ID.
+        sActiveSample.mSampleId = GetNextSampleId();
+        sActiveSample.mbSampleActive = true;
+        sActiveSample.mbBeginSampleSuccessful = false;
 #if USE_GPA_PROFILING
         if (pWrappedGraphicsCommandList != NULL)
         {
-            // Count the number of samples that have been collected using this commandlist.
-            CommandListToSampleCountMap::iterator sampleCountIter = mSamplesPerCommandList.find(pWrappedGraphicsCommandList);
-            if (sampleCountIter == mSamplesPerCommandList.end())
-            {
-                mSamplesPerCommandList[pWrappedGraphicsCommandList] = 1;
-            }
-            else
+            GPA_Status beginStatus = GPA_STATUS_OK;
+
             {
-                // Increment the per-commandlist count and compare to the max.
-                gpa_uint32& count = sampleCountIter->second;
-                count++;
-            }
+                // GPA begins the sample in whichever context is selected, so the lock only has to cover selecting
+                // this thread's context and beginning the sample. It isn't held across the real call, so other
+                // threads can record their own command lists meanwhile.
+                ScopeLock gpaLock(&mGPAPrePostMatcherMutex);
 
-            SampleInfo& sampleInfo = mSampleIdMap[threadId];
+                // Count the number of samples that have been collected using this commandlist.
+                mSamplesPerCommandList[pWrappedGraphicsCommandList]++;
 
-            // Get the next sample ID to use for this call. Associate this thread with the sample ID.
-            gpa_uint32 sampleId = SetNextSampleId(threadId);
-            SwitchGPAContext(pWrappedGraphicsCommandList->mRealGraphicsCommandList);
+                SwitchGPAContext(pWrappedGraphicsCommandList->mRealGraphicsCommandList);
 
-            sampleInfo.mSampleId = sampleId;
+                beginStatus = mGPALoader.GPA_BeginSample(sActiveSample.mSampleId);
 
-            GPA_Status beginStatus = mGPALoader.GPA_BeginSample(sampleId);
+                // The command lists' sample lists are read under the same lock when results are gathered.
+                if (beginStatus == GPA_STATUS_OK)
+                {
+                    traceAnalyzerLayer->AddSampleToCommandList(pWrappedGraphicsCommandList->mRealGraphicsCommandList, sActiveSample.mSampleId);
+                }
+            }
 
-            sampleInfo.mbBeginSampleSuccessful = (beginStatus == GPA_STATUS_OK);
+            sActiveSample.mbBeginSampleSuccessful = (beginStatus == GPA_STATUS_OK);
 
-            if (beginStatus == GPA_STATUS_OK)
-            {
-                traceAnalyzerLayer->AddSampleToCommandList(pWrappedGraphicsCommandList->mRealGraphicsCommandList, sampleId);
-            }
-            else
+            if (beginStatus != GPA_STATUS_OK)
             {
                 Log(logERROR, "Failed to begin sampling for current entry.\n");
             }
@@ -373,17 +374,14 @@ void DX12Interceptor::PreCall(IUnknown* inWrappedInterface, FuncId inFunctionId)
         }
 
 #else
-        ID3D12Device* pDevice = nullptr;
-        pWrappedGraphicsCommandList->GetDevice(__uuidof(*pDevice), reinterpret_cast<void**>(&pDevice));
-
-        ID3D12Device* pRealDevice = dynamic_cast<GPS_ID3D12DeviceCustom*>(pDevice)->mRealDevice;
+        DX12CmdListProfiler* pProfilerInstance = GetProfiler(inWrappedInterface);
 
-        DX12CmdListProfiler* pProfilerInstance = sDeviceToProfilerMap[pRealDevice];
-        PsAssert(pProfilerInstance != NULL);
+        ProfilerMeasurementId measurementId = ConstructMeasurementInfo(inFunctionId, sActiveSample.mSampleId, pWrappedGraphicsCommandList->mRealGraphicsCommandList);
 
-        ProfilerMeasurementId measurementId = ConstructMeasurementInfo(inFunctionId, SetNextSampleId(threadId), pWrappedGraphicsCommandList->mRealGraphicsCommandList);
+        // The profiler keeps its measurements per command list, so this doesn't block other recording threads.
+        ProfilerResultCode beginResult = pProfilerInstance->BeginCmdMeasurement(pWrappedGraphicsCommandList->mRealGraphicsCommandList, &measurementId);
 
-        pProfilerInstance->BeginCmdMeasurement(pWrappedGraphicsCommandList->mRealGraphicsCommandList, &measurementId);
+        sActiveSample.mbBeginSampleSuccessful = (beginResult == PROFILER_SUCCESS);
 #endif
 
     }
@@ -404,6 +402,57 @@ void DX12Interceptor::PreCall(IUnknown* inWrappedInterface, FuncId inFunctionId)
 /// \param inReturnValue The return value for the function. If void, use FUNCTION_RETURNS_VOID.
 //--------------------------------------------------------------------------
 void DX12Interceptor::PostCall(IUnknown* inWrappedInterface, FuncId inFunctionId, const char* inArgumentString, INT64 inReturnValue)
+{
+    DX12TraceAnalyzerLayer* pTraceAnalyzerLayer = DX12TraceAnalyzerLayer::Instance();
+
+    if (pTraceAnalyzerLayer->IsFlightRecording())
+    {
+        // The flight recorder only keeps the call and its timing, so there's no APIEntry to build.
+        pTraceAnalyzerLayer->RecordFlightCall(inFunctionId, inWrappedInterface, inReturnValue);
+
+        // Profiling may have been enabled along with the flight recorder, so end any sample that PreCall began.
+        AbandonActiveSample(inWrappedInterface);
+    }
+    else
+    {
+        DX12APIEntry* pNewEntry = pTraceAnalyzerLayer->LogAPICall(inWrappedInterface, inFunctionId, inArgumentString, inReturnValue);
+        CompleteProfiledCall(inWrappedInterface, inFunctionId, pNewEntry);
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Responsible for the post-call instrumentation of DX12 API calls whose arguments were packed in binary form.
+/// \param inWrapperInstance An instance of a wrapped DX12 interface.
+/// \param inFunctionId The function ID for the call being traced.
+/// \param inPackedArguments The raw call arguments. These are converted to text when the trace response is built.
+/// \param inReturnValue The return value for the function. If void, use FUNCTION_RETURNS_VOID.
+//--------------------------------------------------------------------------
+void DX12Interceptor::PostCall(IUnknown* inWrappedInterface, FuncId inFunctionId, const PackedAPIArguments& inPackedArguments, INT64 inReturnValue)
+{
+    DX12TraceAnalyzerLayer* pTraceAnalyzerLayer = DX12TraceAnalyzerLayer::Instance();
+
+    if (pTraceAnalyzerLayer->IsFlightRecording())
+    {
+        // The flight recorder only keeps the call and its timing, so there's no APIEntry to build.
+        pTraceAnalyzerLayer->RecordFlightCall(inFunctionId, inWrappedInterface, inReturnValue);
+
+        // Profiling may have been enabled along with the flight recorder, so end any sample that PreCall began.
+        AbandonActiveSample(inWrappedInterface);
+    }
+    else
+    {
+        DX12APIEntry* pNewEntry = pTraceAnalyzerLayer->LogAPICall(inWrappedInterface, inFunctionId, inPackedArguments, inReturnValue);
+        CompleteProfiledCall(inWrappedInterface, inFunctionId, pNewEntry);
+    }
+}
+
+//--------------------------------------------------------------------------
+/// End GPU profiling for a traced call, and associate the profiler sample with the new APIEntry.
+/// \param inWrapperInstance An instance of a wrapped DX12 interface.
+/// \param inFunctionId The function ID for the call being traced.
+/// \param pNewEntry The APIEntry that was just logged for the call.
+//--------------------------------------------------------------------------
+void DX12Interceptor::CompleteProfiledCall(IUnknown* inWrappedInterface, FuncId inFunctionId, DX12APIEntry* pNewEntry)
 {
     osThreadId threadId = osGetCurrentThreadId();
 
@@ -411,28 +460,24 @@ void DX12Interceptor::PostCall(IUnknown* inWrappedInterface, FuncId inFunctionId
     const char* funcName = pTraceAnalyzerLayer->GetFunctionNameFromId(inFunctionId);
     Log(logTRACE, "Thread %d\t Postcall: %s\n", threadId, funcName);
 
-    DX12APIEntry* pNewEntry = pTraceAnalyzerLayer->LogAPICall(inWrappedInterface, inFunctionId, inArgumentString, inReturnValue);
-
     // Wait and gather results
     if (ShouldCollectGPUTime() && pTraceAnalyzerLayer->ShouldProfileFunction(inFunctionId))
     {
 
 #if USE_GPA_PROFILING
         // Determine which SampleID is associated with this call and insert it into the DX12APIEntry.
-        ThreadIdToSampleIdMap::iterator threadSampleIter = mSampleIdMap.find(threadId);
-
-        if (threadSampleIter != mSampleIdMap.end())
+        if (sActiveSample.mbSampleActive)
         {
-            SampleInfo& sampleInfo = threadSampleIter->second;
+            sActiveSample.mbSampleActive = false;
 
             // We can call EndSample, begin BeginSample was called successfully.
-            if (sampleInfo.mbBeginSampleSuccessful)
+            if (sActiveSample.mbBeginSampleSuccessful)
             {
-                GPA_Status endSampleStatus = mGPALoader.GPA_EndSample();
+                GPA_Status endSampleStatus = EndGPASample(inWrappedInterface);
 
                 if (endSampleStatus == GPA_STATUS_OK)
                 {
-                    pNewEntry->mSampleId = sampleInfo.mSampleId;
+                    pNewEntry->mSampleId = sActiveSample.mSampleId;
 
                     pTraceAnalyzerLayer->StoreProfilerResult(pNewEntry);
                     Log(logTRACE, "BeginSample with Id '%u'.\n", pNewEntry->mSampleId);
@@ -456,26 +501,27 @@ void DX12Interceptor::PostCall(IUnknown* inWrappedInterface, FuncId inFunctionId
         GPS_ID3D12GraphicsCommandList* pWrappedGraphicsCommandList = static_cast<GPS_ID3D12GraphicsCommandList*>(inWrappedInterface);
 
         // Determine which SampleID is associated with this call and insert it into the DX12APIEntry.
-        ThreadIdToSampleIdMap::iterator threadSampleIter = mSampleIdMap.find(threadId);
-
-        if (threadSampleIter != mSampleIdMap.end())
+        if (sActiveSample.mbSampleActive)
         {
-            SampleInfo& sampleInfo = threadSampleIter->second;
+            sActiveSample.mbSampleActive = false;
 
-            DX12CmdListProfiler* pProfilerInstance = GetProfiler(inWrappedInterface);
-            pProfilerInstance->EndCmdMeasurement(pWrappedGraphicsCommandList->mRealGraphicsCommandList);
+            if (sActiveSample.mbBeginSampleSuccessful)
+            {
+                DX12CmdListProfiler* pProfilerInstance = GetProfiler(inWrappedInterface);
+                pProfilerInstance->EndCmdMeasurement(pWrappedGraphicsCommandList->mRealGraphicsCommandList);
 
-            pNewEntry->mSampleId = sampleInfo.mSampleId;
-            pTraceAnalyzerLayer->StoreProfilerResult(pNewEntry);
+                pNewEntry->mSampleId = sActiveSample.mSampleId;
+                pTraceAnalyzerLayer->StoreProfilerResult(pNewEntry);
+            }
         }
 #endif
-
-        // The pass's sample has just ended. Other threads are free to acquire the lock in PreCall above.
-        UnlockGPA();
     }
     else
     {
         Log(logTRACE, "Did not profile '%s'.\n", funcName);
+
+        // Profiling may have been disabled after PreCall began a sample.
+        AbandonActiveSample(inWrappedInterface);
     }
 }
 
@@ -489,17 +535,48 @@ void DX12Interceptor::GatherProfilerResults(IUnknown* inWrappedInterface, UINT N
 {
     DX12CmdListProfiler* pProfilerInstance = GetProfiler(inWrappedInterface);
 
-    DX12TraceAnalyzerLayer* pTraceAnalyzerLayer = DX12TraceAnalyzerLayer::Instance();
-
     for (UINT i = 0; i < NumCommandLists; i++)
     {
-        std::vector<ProfilerResult> results;
-
         GPS_ID3D12GraphicsCommandList* pWrappedGraphicsCommandList = static_cast<GPS_ID3D12GraphicsCommandList*>(ppCommandLists[i]);
 
-        pProfilerInstance->GetCmdListResults(pWrappedGraphicsCommandList->mRealGraphicsCommandList, static_cast<ID3D12CommandQueue*>(inWrappedInterface), results);
+        pProfilerInstance->RetireCmdList(pWrappedGraphicsCommandList->mRealGraphicsCommandList, static_cast<ID3D12CommandQueue*>(inWrappedInterface));
+    }
 
-        pTraceAnalyzerLayer->StoreProfilerResults(static_cast<GPS_ID3D12CommandQueue*>(inWrappedInterface), results);
+    // Pick up anything the GPU has already finished, without waiting on the work that was just submitted.
+    StoreHarvestedResults(pProfilerInstance, false);
+}
+
+//--------------------------------------------------------------------------
+/// Wait for the GPU to finish all profiled work, and store the results of every command list still pending.
+//--------------------------------------------------------------------------
+void DX12Interceptor::CollectPendingProfilerResults()
+{
+    for (DeviceToProfilerMap::iterator profilerIter = sDeviceToProfilerMap.begin(); profilerIter != sDeviceToProfilerMap.end(); ++profilerIter)
+    {
+        if (profilerIter->second != nullptr)
+        {
+            StoreHarvestedResults(profilerIter->second, true);
+        }
+    }
+}
+
+//--------------------------------------------------------------------------
+/// Harvest the finished results from a profiler, and store them with the queue they were executed on.
+/// \param inProfiler The profiler to harvest results from.
+/// \param inWaitForGPU True to wait for all of the profiler's retired command lists to finish.
+//--------------------------------------------------------------------------
+void DX12Interceptor::StoreHarvestedResults(DX12CmdListProfiler* inProfiler, bool inWaitForGPU)
+{
+    ProfilerQueueResults results;
+
+    inProfiler->HarvestResults(inWaitForGPU, results);
+
+    DX12TraceAnalyzerLayer* pTraceAnalyzerLayer = DX12TraceAnalyzerLayer::Instance();
+
+    for (ProfilerQueueResults::iterator queueIter = results.begin(); queueIter != results.end(); ++queueIter)
+    {
+        // The profiler is handed the wrapped queue when command lists are retired.
+        pTraceAnalyzerLayer->StoreProfilerResults(static_cast<GPS_ID3D12CommandQueue*>(queueIter->first), queueIter->second);
     }
 }
 
@@ -521,6 +598,53 @@ void DX12Interceptor::SwitchGPAContext(ID3D12GraphicsCommandList* inCurrentConte
     }
 }
 
+//--------------------------------------------------------------------------
+/// End the sample that PreCall began on this thread without storing a result for it.
+/// Used when no APIEntry is built for the call, or when profiling was disabled during the call.
+/// \param inWrappedInterface The interface responsible for the profiled call.
+//--------------------------------------------------------------------------
+void DX12Interceptor::AbandonActiveSample(IUnknown* inWrappedInterface)
+{
+    if (sActiveSample.mbSampleActive == false)
+    {
+        return;
+    }
+
+    sActiveSample.mbSampleActive = false;
+
+#if USE_GPA_PROFILING
+    if (sActiveSample.mbBeginSampleSuccessful)
+    {
+        EndGPASample(inWrappedInterface);
+    }
+
+#else
+    if (sActiveSample.mbBeginSampleSuccessful)
+    {
+        GPS_ID3D12GraphicsCommandList* pWrappedGraphicsCommandList = static_cast<GPS_ID3D12GraphicsCommandList*>(inWrappedInterface);
+        GetProfiler(inWrappedInterface)->EndCmdMeasurement(pWrappedGraphicsCommandList->mRealGraphicsCommandList);
+    }
+#endif
+}
+
+//--------------------------------------------------------------------------
+/// End the GPA sample that PreCall began in a command list. Another thread may have selected
+/// its own command list since then, so this command list is selected again first.
+/// \param inWrappedInterface The wrapped command list the sample was begun in.
+/// 
+eturns The status returned by GPA_EndSample.
+//--------------------------------------------------------------------------
+GPA_Status DX12Interceptor::EndGPASample(IUnknown* inWrappedInterface)
+{
+    GPS_ID3D12GraphicsCommandList* pWrappedGraphicsCommandList = static_cast<GPS_ID3D12GraphicsCommandList*>(inWrappedInterface);
+
+    ScopeLock gpaLock(&mGPAPrePostMatcherMutex);
+
+    SwitchGPAContext(pWrappedGraphicsCommandList->mRealGraphicsCommandList);
+
+    return mGPALoader.GPA_EndSample();
+}
+
 //--------------------------------------------------------------------------
 /// Lock GPA access mutex
 //--------------------------------------------------------------------------
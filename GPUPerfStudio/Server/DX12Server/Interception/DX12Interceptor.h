@@ -10,12 +10,15 @@
 #define DX12INTERCEPTOR_H
 
 #include "DX12Defines.h"
+#include <atomic>
 #include <GPUPerfAPI.h>
 #include "GPUPerfAPILoader.h"
 #include "Profiling/DX12CmdListProfiler.h"
 
 class IDX12InstanceBase;
 class GPS_ID3D12GraphicsCommandList;
+class DX12APIEntry;
+class PackedAPIArguments;
 
 //--------------------------------------------------------------------------
 /// A map of ID3D12Device to the associated CommandListProfiler.
@@ -51,6 +54,12 @@ public:
     //--------------------------------------------------------------------------
     virtual void SetProfilingEnabled(bool inbProfilingEnabled) { mbProfilerEnabled = inbProfilingEnabled; }
 
+    //--------------------------------------------------------------------------
+    /// Set the internal flag that determines if traced calls format their arguments as text.
+    /// \param inbFormatArguments The flag used to enable or disable argument formatting.
+    //--------------------------------------------------------------------------
+    virtual void SetFormatArguments(bool inbFormatArguments) { mbFormatArguments = inbFormatArguments; }
+
     //--------------------------------------------------------------------------
     /// Retrieve a pointer to the LayerManager that owns this InterceptorBase instance.
     /// \returns A pointer to the DX12LayerManager.
@@ -112,6 +121,16 @@ public:
     //--------------------------------------------------------------------------
     void PostCall(IUnknown* inWrappedInterface, FuncId inFunctionId, const char* inArgumentString, INT64 inReturnValue = FUNCTION_RETURNS_VOID);
 
+    //--------------------------------------------------------------------------
+    /// Handler used after the real runtime implementation of an API call has been invoked.
+    /// The arguments are kept in binary form, and converted to text when the trace response is built.
+    /// \param inWrappedInterface The interface pointer used to invoke the API call.
+    /// \param inFunctionId The FuncId corresponding to the API call being traced.
+    /// \param inPackedArguments The packed call invocation arguments.
+    /// \param inReturnValue The return value result of the real runtime call.
+    //--------------------------------------------------------------------------
+    void PostCall(IUnknown* inWrappedInterface, FuncId inFunctionId, const PackedAPIArguments& inPackedArguments, INT64 inReturnValue = FUNCTION_RETURNS_VOID);
+
     //--------------------------------------------------------------------------
     /// Gather profiler results.
     /// \param inWrappedInterface The interface responsible for the profiled call.
@@ -120,6 +139,11 @@ public:
     //--------------------------------------------------------------------------
     void GatherProfilerResults(IUnknown* inWrappedInterface, UINT NumCommandLists, ID3D12CommandList* const* ppCommandLists);
 
+    //--------------------------------------------------------------------------
+    /// Wait for the GPU to finish all profiled work, and store the results of every command list still pending.
+    //--------------------------------------------------------------------------
+    void CollectPendingProfilerResults();
+
     //--------------------------------------------------------------------------
     /// A function used to check if a function should be logged in the API Trace.
     /// \returns True if the function should be logged in the API Trace.
@@ -132,6 +156,13 @@ public:
     //--------------------------------------------------------------------------
     inline bool ShouldCollectGPUTime() const { return mbProfilerEnabled; }
 
+    //--------------------------------------------------------------------------
+    /// A function used to check if traced calls need to format their arguments as text before PostCall.
+    /// The flight recorder only keeps the call and its timing, so it turns this off.
+    /// \returns True if the call arguments should be formatted.
+    //--------------------------------------------------------------------------
+    inline bool ShouldFormatArguments() const { return mbFormatArguments; }
+
     //--------------------------------------------------------------------------
     /// A GPA logging callback used to output GPA messages to the GPS log.
     /// \param messageType The type of message being logged.
@@ -151,6 +182,19 @@ public:
     //--------------------------------------------------------------------------
     void SwitchGPAContext(ID3D12GraphicsCommandList* inCurrentContext);
 
+    //--------------------------------------------------------------------------
+    /// End the sample that PreCall began on this thread without storing a result for it.
+    /// \param inWrappedInterface The interface responsible for the profiled call.
+    //--------------------------------------------------------------------------
+    void AbandonActiveSample(IUnknown* inWrappedInterface);
+
+    //--------------------------------------------------------------------------
+    /// End the GPA sample that PreCall began in a command list.
+    /// \param inWrappedInterface The wrapped command list the sample was begun in.
+    /// \returns The status returned by GPA_EndSample.
+    //--------------------------------------------------------------------------
+    GPA_Status EndGPASample(IUnknown* inWrappedInterface);
+
     //--------------------------------------------------------------------------
     /// Lock GPA access mutex
     //--------------------------------------------------------------------------
@@ -196,56 +240,35 @@ public:
 
 private:
     //--------------------------------------------------------------------------
-    /// Set the active profiler SampleId for the given thread ID.
-    // \param inThreadId The CPU thread ID responsible for invoking the sampled API call.
-    // \returns A new SampleId.
-    //--------------------------------------------------------------------------
-    gpa_uint32 SetNextSampleId(DWORD inThreadId);
-
-    //--------------------------------------------------------------------------
-    /// Generate the next globally-unique SampleId.
-    /// \returns A new SampleId that can be used to profile a GPU command.
-    //--------------------------------------------------------------------------
-    gpa_uint32 GetNextSampleId();
-
-    //--------------------------------------------------------------------------
-    /// A small helper structure to track Begin/End Sample calls per thread.
+    /// End GPU profiling for a traced call, and associate the profiler sample with the new APIEntry.
+    /// \param inWrappedInterface The interface pointer used to invoke the API call.
+    /// \param inFunctionId The FuncId corresponding to the API call being traced.
+    /// \param pNewEntry The APIEntry that was just logged for the call.
     //--------------------------------------------------------------------------
-    struct SampleInfo
-    {
-        //--------------------------------------------------------------------------
-        /// The SampleId assigned to the GPA sample.
-        //--------------------------------------------------------------------------
-        gpa_uint32 mSampleId;
-
-        //--------------------------------------------------------------------------
-        /// Was BeginSample successful? If so, we can call EndSample.
-        //--------------------------------------------------------------------------
-        bool mbBeginSampleSuccessful;
-    };
+    void CompleteProfiledCall(IUnknown* inWrappedInterface, FuncId inFunctionId, DX12APIEntry* pNewEntry);
 
     //--------------------------------------------------------------------------
-    /// A map used to associate a ThreadId with a SampleInfo structure.
+    /// Harvest the finished results from a profiler, and store them with the queue they were executed on.
+    /// \param inProfiler The profiler to harvest results from.
+    /// \param inWaitForGPU True to wait for all of the profiler's retired command lists to finish.
     //--------------------------------------------------------------------------
-    typedef std::map<DWORD, SampleInfo> ThreadIdToSampleIdMap;
+    void StoreHarvestedResults(DX12CmdListProfiler* inProfiler, bool inWaitForGPU);
 
     //--------------------------------------------------------------------------
-    /// An association of CPU ThreadId to a SampleInfo structure.
+    /// Generate the next globally-unique SampleId.
+    /// \returns A new SampleId that can be used to profile a GPU command.
     //--------------------------------------------------------------------------
-    ThreadIdToSampleIdMap mSampleIdMap;
+    gpa_uint32 GetNextSampleId();
 
     //--------------------------------------------------------------------------
     /// A globally unique SampleId counter.
     //--------------------------------------------------------------------------
-    gpa_uint32 mSampleIndex;
-
-    //--------------------------------------------------------------------------
-    /// A mutex used to lock the SampleId generator.
-    //--------------------------------------------------------------------------
-    mutex mUniqueSampleIdMutex;
+    std::atomic<gpa_uint32> mSampleIndex;
 
     //--------------------------------------------------------------------------
     /// A mutex used to lock usage of GPA when switching contexts between threads.
+    /// Held while a context is selected and a sample is begun or ended in it, but not across the
+    /// real call, since GPA keeps each context's open sample separately.
     //--------------------------------------------------------------------------
     mutex mGPAPrePostMatcherMutex;
 
@@ -256,6 +279,7 @@ private:
 
     //--------------------------------------------------------------------------
     /// A map that associates a CommandList with a count of GPA samples gathered through the list.
+    /// Only accessed while mGPAPrePostMatcherMutex is held.
     //--------------------------------------------------------------------------
     CommandListToSampleCountMap mSamplesPerCommandList;
 
@@ -274,6 +298,11 @@ private:
     //--------------------------------------------------------------------------
     bool mbProfilerEnabled;
 
+    //--------------------------------------------------------------------------
+    /// A flag used to track if traced calls should format their arguments as text.
+    //--------------------------------------------------------------------------
+    bool mbFormatArguments;
+
     //--------------------------------------------------------------------------
     /// Handle to real D3D12.dll module, when operating in DLL_REPLACEMENT mode.
     //--------------------------------------------------------------------------
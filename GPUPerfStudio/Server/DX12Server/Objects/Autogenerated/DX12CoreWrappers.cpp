@@ -3,6 +3,11 @@
 /// \author AMD Developer Tools Team
 /// \file
 /// \brief  THIS CODE WAS AUTOGENERATED BY PASSTHROUGHGENERATOR ON 05/15/15
+/// \note   Wrappers whose arguments are all POD values were updated by hand to pass
+///         PackedAPIArguments to PostCall instead of a formatted string. PassthroughGenerator
+///         must be updated to emit the same code before this file is regenerated.
+///         The string formatting in the other wrappers is skipped while the flight
+///         recorder is the only thing tracing, since it doesn't keep the arguments.
 //==============================================================================
 
 #include "DX12CoreWrappers.h"
@@ -15,6 +20,7 @@
 #include "../DX12CustomWrappers.h"
 #include "../DX12CreateInfoStructs.h"
 #include "../DXCommonSource/StringifyDxgiFormatEnums.h"
+#include "../Common/PackedAPIArguments.h"
 
 #define ARGUMENTS_BUFFER_SIZE 8192
 
@@ -33,9 +39,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Object::QueryInterface(REFIID riid, void** p
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        }
+
         interceptor->PreCall(this, FuncId_IUnknown_QueryInterface);
         result = mRealObject->QueryInterface(riid, ppvObject);
         interceptor->PostCall(this, FuncId_IUnknown_QueryInterface, argumentsBuffer, result);
@@ -64,12 +76,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12Object::AddRef()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_AddRef);
         result = mRealObject->AddRef();
-        interceptor->PostCall(this, FuncId_IUnknown_AddRef, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_AddRef, packedArguments, result);
     }
     else
     {
@@ -87,12 +97,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12Object::Release()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_Release);
         result = mRealObject->Release();
-        interceptor->PostCall(this, FuncId_IUnknown_Release, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_Release, packedArguments, result);
     }
     else
     {
@@ -106,7 +114,7 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12Object::Release()
 
         if (objectMetadata != NULL)
         {
-            objectMetadata->FlagAsDestroyed();
+            objectDatabase->OnInstanceDestroyed(objectMetadata);
         }
     }
 
@@ -122,8 +130,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Object::GetPrivateData(REFGUID guid, UINT* p
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_GetPrivateData);
         result = mRealObject->GetPrivateData(guid, pDataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_GetPrivateData, argumentsBuffer, result);
@@ -145,8 +158,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Object::SetPrivateData(REFGUID guid, UINT Da
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateData);
         result = mRealObject->SetPrivateData(guid, DataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateData, argumentsBuffer, result);
@@ -168,8 +186,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Object::SetPrivateDataInterface(REFGUID guid
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateDataInterface);
         result = mRealObject->SetPrivateDataInterface(guid, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateDataInterface, argumentsBuffer, result);
@@ -191,8 +214,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Object::SetName(LPCWSTR Name)
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetName);
         result = mRealObject->SetName(Name);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetName, argumentsBuffer, result);
@@ -221,9 +249,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12DeviceChild::QueryInterface(REFIID riid, voi
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        }
+
         interceptor->PreCall(this, FuncId_IUnknown_QueryInterface);
         result = mRealDeviceChild->QueryInterface(riid, ppvObject);
         interceptor->PostCall(this, FuncId_IUnknown_QueryInterface, argumentsBuffer, result);
@@ -252,12 +286,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12DeviceChild::AddRef()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_AddRef);
         result = mRealDeviceChild->AddRef();
-        interceptor->PostCall(this, FuncId_IUnknown_AddRef, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_AddRef, packedArguments, result);
     }
     else
     {
@@ -275,12 +307,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12DeviceChild::Release()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_Release);
         result = mRealDeviceChild->Release();
-        interceptor->PostCall(this, FuncId_IUnknown_Release, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_Release, packedArguments, result);
     }
     else
     {
@@ -294,7 +324,7 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12DeviceChild::Release()
 
         if (objectMetadata != NULL)
         {
-            objectMetadata->FlagAsDestroyed();
+            objectDatabase->OnInstanceDestroyed(objectMetadata);
         }
     }
 
@@ -310,8 +340,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12DeviceChild::GetPrivateData(REFGUID guid, UI
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_GetPrivateData);
         result = mRealDeviceChild->GetPrivateData(guid, pDataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_GetPrivateData, argumentsBuffer, result);
@@ -333,8 +368,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12DeviceChild::SetPrivateData(REFGUID guid, UI
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateData);
         result = mRealDeviceChild->SetPrivateData(guid, DataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateData, argumentsBuffer, result);
@@ -356,8 +396,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12DeviceChild::SetPrivateDataInterface(REFGUID
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateDataInterface);
         result = mRealDeviceChild->SetPrivateDataInterface(guid, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateDataInterface, argumentsBuffer, result);
@@ -379,8 +424,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12DeviceChild::SetName(LPCWSTR Name)
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetName);
         result = mRealDeviceChild->SetName(Name);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetName, argumentsBuffer, result);
@@ -402,9 +452,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12DeviceChild::GetDevice(REFIID riid, void** p
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12DeviceChild_GetDevice);
         result = mRealDeviceChild->GetDevice(riid, ppvDevice);
         interceptor->PostCall(this, FuncId_ID3D12DeviceChild_GetDevice, argumentsBuffer, result);
@@ -439,9 +495,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12RootSignature::QueryInterface(REFIID riid, v
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        }
+
         interceptor->PreCall(this, FuncId_IUnknown_QueryInterface);
         result = mRealRootSignature->QueryInterface(riid, ppvObject);
         interceptor->PostCall(this, FuncId_IUnknown_QueryInterface, argumentsBuffer, result);
@@ -470,12 +532,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12RootSignature::AddRef()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_AddRef);
         result = mRealRootSignature->AddRef();
-        interceptor->PostCall(this, FuncId_IUnknown_AddRef, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_AddRef, packedArguments, result);
     }
     else
     {
@@ -493,12 +553,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12RootSignature::Release()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_Release);
         result = mRealRootSignature->Release();
-        interceptor->PostCall(this, FuncId_IUnknown_Release, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_Release, packedArguments, result);
     }
     else
     {
@@ -512,7 +570,7 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12RootSignature::Release()
 
         if (objectMetadata != NULL)
         {
-            objectMetadata->FlagAsDestroyed();
+            objectDatabase->OnInstanceDestroyed(objectMetadata);
         }
     }
 
@@ -528,8 +586,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12RootSignature::GetPrivateData(REFGUID guid,
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_GetPrivateData);
         result = mRealRootSignature->GetPrivateData(guid, pDataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_GetPrivateData, argumentsBuffer, result);
@@ -551,8 +614,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12RootSignature::SetPrivateData(REFGUID guid,
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateData);
         result = mRealRootSignature->SetPrivateData(guid, DataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateData, argumentsBuffer, result);
@@ -574,8 +642,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12RootSignature::SetPrivateDataInterface(REFGU
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateDataInterface);
         result = mRealRootSignature->SetPrivateDataInterface(guid, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateDataInterface, argumentsBuffer, result);
@@ -597,8 +670,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12RootSignature::SetName(LPCWSTR Name)
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetName);
         result = mRealRootSignature->SetName(Name);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetName, argumentsBuffer, result);
@@ -620,9 +698,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12RootSignature::GetDevice(REFIID riid, void**
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12DeviceChild_GetDevice);
         result = mRealRootSignature->GetDevice(riid, ppvDevice);
         interceptor->PostCall(this, FuncId_ID3D12DeviceChild_GetDevice, argumentsBuffer, result);
@@ -655,9 +739,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12RootSignatureDeserializer::QueryInterface(RE
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        }
+
         interceptor->PreCall(this, FuncId_IUnknown_QueryInterface);
         result = mRealRootSignatureDeserializer->QueryInterface(riid, ppvObject);
         interceptor->PostCall(this, FuncId_IUnknown_QueryInterface, argumentsBuffer, result);
@@ -686,12 +776,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12RootSignatureDeserializer::AddRef()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_AddRef);
         result = mRealRootSignatureDeserializer->AddRef();
-        interceptor->PostCall(this, FuncId_IUnknown_AddRef, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_AddRef, packedArguments, result);
     }
     else
     {
@@ -709,12 +797,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12RootSignatureDeserializer::Release()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_Release);
         result = mRealRootSignatureDeserializer->Release();
-        interceptor->PostCall(this, FuncId_IUnknown_Release, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_Release, packedArguments, result);
     }
     else
     {
@@ -728,7 +814,7 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12RootSignatureDeserializer::Release()
 
         if (objectMetadata != NULL)
         {
-            objectMetadata->FlagAsDestroyed();
+            objectDatabase->OnInstanceDestroyed(objectMetadata);
         }
     }
 
@@ -750,9 +836,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Pageable::QueryInterface(REFIID riid, void**
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        }
+
         interceptor->PreCall(this, FuncId_IUnknown_QueryInterface);
         result = mRealPageable->QueryInterface(riid, ppvObject);
         interceptor->PostCall(this, FuncId_IUnknown_QueryInterface, argumentsBuffer, result);
@@ -781,12 +873,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12Pageable::AddRef()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_AddRef);
         result = mRealPageable->AddRef();
-        interceptor->PostCall(this, FuncId_IUnknown_AddRef, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_AddRef, packedArguments, result);
     }
     else
     {
@@ -804,12 +894,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12Pageable::Release()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_Release);
         result = mRealPageable->Release();
-        interceptor->PostCall(this, FuncId_IUnknown_Release, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_Release, packedArguments, result);
     }
     else
     {
@@ -823,7 +911,7 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12Pageable::Release()
 
         if (objectMetadata != NULL)
         {
-            objectMetadata->FlagAsDestroyed();
+            objectDatabase->OnInstanceDestroyed(objectMetadata);
         }
     }
 
@@ -839,8 +927,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Pageable::GetPrivateData(REFGUID guid, UINT*
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_GetPrivateData);
         result = mRealPageable->GetPrivateData(guid, pDataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_GetPrivateData, argumentsBuffer, result);
@@ -862,8 +955,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Pageable::SetPrivateData(REFGUID guid, UINT
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateData);
         result = mRealPageable->SetPrivateData(guid, DataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateData, argumentsBuffer, result);
@@ -885,8 +983,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Pageable::SetPrivateDataInterface(REFGUID gu
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateDataInterface);
         result = mRealPageable->SetPrivateDataInterface(guid, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateDataInterface, argumentsBuffer, result);
@@ -908,8 +1011,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Pageable::SetName(LPCWSTR Name)
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetName);
         result = mRealPageable->SetName(Name);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetName, argumentsBuffer, result);
@@ -931,9 +1039,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Pageable::GetDevice(REFIID riid, void** ppvD
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12DeviceChild_GetDevice);
         result = mRealPageable->GetDevice(riid, ppvDevice);
         interceptor->PostCall(this, FuncId_ID3D12DeviceChild_GetDevice, argumentsBuffer, result);
@@ -966,9 +1080,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Heap::QueryInterface(REFIID riid, void** ppv
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        }
+
         interceptor->PreCall(this, FuncId_IUnknown_QueryInterface);
         result = mRealHeap->QueryInterface(riid, ppvObject);
         interceptor->PostCall(this, FuncId_IUnknown_QueryInterface, argumentsBuffer, result);
@@ -997,12 +1117,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12Heap::AddRef()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_AddRef);
         result = mRealHeap->AddRef();
-        interceptor->PostCall(this, FuncId_IUnknown_AddRef, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_AddRef, packedArguments, result);
     }
     else
     {
@@ -1020,12 +1138,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12Heap::Release()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_Release);
         result = mRealHeap->Release();
-        interceptor->PostCall(this, FuncId_IUnknown_Release, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_Release, packedArguments, result);
     }
     else
     {
@@ -1039,7 +1155,7 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12Heap::Release()
 
         if (objectMetadata != NULL)
         {
-            objectMetadata->FlagAsDestroyed();
+            objectDatabase->OnInstanceDestroyed(objectMetadata);
         }
     }
 
@@ -1055,8 +1171,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Heap::GetPrivateData(REFGUID guid, UINT* pDa
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_GetPrivateData);
         result = mRealHeap->GetPrivateData(guid, pDataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_GetPrivateData, argumentsBuffer, result);
@@ -1078,8 +1199,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Heap::SetPrivateData(REFGUID guid, UINT Data
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateData);
         result = mRealHeap->SetPrivateData(guid, DataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateData, argumentsBuffer, result);
@@ -1101,8 +1227,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Heap::SetPrivateDataInterface(REFGUID guid,
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateDataInterface);
         result = mRealHeap->SetPrivateDataInterface(guid, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateDataInterface, argumentsBuffer, result);
@@ -1124,8 +1255,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Heap::SetName(LPCWSTR Name)
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetName);
         result = mRealHeap->SetName(Name);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetName, argumentsBuffer, result);
@@ -1147,9 +1283,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Heap::GetDevice(REFIID riid, void** ppvDevic
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12DeviceChild_GetDevice);
         result = mRealHeap->GetDevice(riid, ppvDevice);
         interceptor->PostCall(this, FuncId_ID3D12DeviceChild_GetDevice, argumentsBuffer, result);
@@ -1176,12 +1318,10 @@ D3D12_HEAP_DESC STDMETHODCALLTYPE GPS_ID3D12Heap::GetDesc()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_ID3D12Heap_GetDesc);
         result = mRealHeap->GetDesc();
-        interceptor->PostCall(this, FuncId_ID3D12Heap_GetDesc, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12Heap_GetDesc, packedArguments);
     }
     else
     {
@@ -1205,9 +1345,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Resource::QueryInterface(REFIID riid, void**
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        }
+
         interceptor->PreCall(this, FuncId_IUnknown_QueryInterface);
         result = mRealResource->QueryInterface(riid, ppvObject);
         interceptor->PostCall(this, FuncId_IUnknown_QueryInterface, argumentsBuffer, result);
@@ -1236,12 +1382,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12Resource::AddRef()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_AddRef);
         result = mRealResource->AddRef();
-        interceptor->PostCall(this, FuncId_IUnknown_AddRef, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_AddRef, packedArguments, result);
     }
     else
     {
@@ -1259,12 +1403,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12Resource::Release()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_Release);
         result = mRealResource->Release();
-        interceptor->PostCall(this, FuncId_IUnknown_Release, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_Release, packedArguments, result);
     }
     else
     {
@@ -1278,7 +1420,7 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12Resource::Release()
 
         if (objectMetadata != NULL)
         {
-            objectMetadata->FlagAsDestroyed();
+            objectDatabase->OnInstanceDestroyed(objectMetadata);
         }
     }
 
@@ -1294,8 +1436,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Resource::GetPrivateData(REFGUID guid, UINT*
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_GetPrivateData);
         result = mRealResource->GetPrivateData(guid, pDataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_GetPrivateData, argumentsBuffer, result);
@@ -1317,8 +1464,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Resource::SetPrivateData(REFGUID guid, UINT
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateData);
         result = mRealResource->SetPrivateData(guid, DataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateData, argumentsBuffer, result);
@@ -1340,8 +1492,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Resource::SetPrivateDataInterface(REFGUID gu
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateDataInterface);
         result = mRealResource->SetPrivateDataInterface(guid, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateDataInterface, argumentsBuffer, result);
@@ -1363,8 +1520,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Resource::SetName(LPCWSTR Name)
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetName);
         result = mRealResource->SetName(Name);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetName, argumentsBuffer, result);
@@ -1386,9 +1548,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Resource::GetDevice(REFIID riid, void** ppvD
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12DeviceChild_GetDevice);
         result = mRealResource->GetDevice(riid, ppvDevice);
         interceptor->PostCall(this, FuncId_ID3D12DeviceChild_GetDevice, argumentsBuffer, result);
@@ -1415,12 +1583,10 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Resource::Map(UINT Subresource, const D3D12_
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, 0x%p, 0x%p", Subresource, pReadRange, ppData);
+        PackedAPIArguments packedArguments("%u, 0x%p, 0x%p", Subresource, pReadRange, ppData);
         interceptor->PreCall(this, FuncId_ID3D12Resource_Map);
         result = mRealResource->Map(Subresource, pReadRange, ppData);
-        interceptor->PostCall(this, FuncId_ID3D12Resource_Map, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_ID3D12Resource_Map, packedArguments, result);
     }
     else
     {
@@ -1436,12 +1602,10 @@ void STDMETHODCALLTYPE GPS_ID3D12Resource::Unmap(UINT Subresource, const D3D12_R
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, 0x%p", Subresource, pWrittenRange);
+        PackedAPIArguments packedArguments("%u, 0x%p", Subresource, pWrittenRange);
         interceptor->PreCall(this, FuncId_ID3D12Resource_Unmap);
         mRealResource->Unmap(Subresource, pWrittenRange);
-        interceptor->PostCall(this, FuncId_ID3D12Resource_Unmap, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12Resource_Unmap, packedArguments);
     }
     else
     {
@@ -1457,12 +1621,10 @@ D3D12_RESOURCE_DESC STDMETHODCALLTYPE GPS_ID3D12Resource::GetDesc()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_ID3D12Resource_GetDesc);
         result = mRealResource->GetDesc();
-        interceptor->PostCall(this, FuncId_ID3D12Resource_GetDesc, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12Resource_GetDesc, packedArguments);
     }
     else
     {
@@ -1480,12 +1642,10 @@ D3D12_GPU_VIRTUAL_ADDRESS STDMETHODCALLTYPE GPS_ID3D12Resource::GetGPUVirtualAdd
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_ID3D12Resource_GetGPUVirtualAddress);
         result = mRealResource->GetGPUVirtualAddress();
-        interceptor->PostCall(this, FuncId_ID3D12Resource_GetGPUVirtualAddress, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_ID3D12Resource_GetGPUVirtualAddress, packedArguments, result);
     }
     else
     {
@@ -1503,12 +1663,10 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Resource::WriteToSubresource(UINT DstSubreso
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, 0x%p, 0x%p, %u, %u", DstSubresource, pDstBox, pSrcData, SrcRowPitch, SrcDepthPitch);
+        PackedAPIArguments packedArguments("%u, 0x%p, 0x%p, %u, %u", DstSubresource, pDstBox, pSrcData, SrcRowPitch, SrcDepthPitch);
         interceptor->PreCall(this, FuncId_ID3D12Resource_WriteToSubresource);
         result = mRealResource->WriteToSubresource(DstSubresource, pDstBox, pSrcData, SrcRowPitch, SrcDepthPitch);
-        interceptor->PostCall(this, FuncId_ID3D12Resource_WriteToSubresource, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_ID3D12Resource_WriteToSubresource, packedArguments, result);
     }
     else
     {
@@ -1526,12 +1684,10 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Resource::ReadFromSubresource(void* pDstData
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, %u, %u, %u, 0x%p", pDstData, DstRowPitch, DstDepthPitch, SrcSubresource, pSrcBox);
+        PackedAPIArguments packedArguments("0x%p, %u, %u, %u, 0x%p", pDstData, DstRowPitch, DstDepthPitch, SrcSubresource, pSrcBox);
         interceptor->PreCall(this, FuncId_ID3D12Resource_ReadFromSubresource);
         result = mRealResource->ReadFromSubresource(pDstData, DstRowPitch, DstDepthPitch, SrcSubresource, pSrcBox);
-        interceptor->PostCall(this, FuncId_ID3D12Resource_ReadFromSubresource, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_ID3D12Resource_ReadFromSubresource, packedArguments, result);
     }
     else
     {
@@ -1549,12 +1705,10 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Resource::GetHeapProperties(D3D12_HEAP_PROPE
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, %u", pHeapProperties, *pHeapFlags);
+        PackedAPIArguments packedArguments("0x%p, %u", pHeapProperties, *pHeapFlags);
         interceptor->PreCall(this, FuncId_ID3D12Resource_GetHeapProperties);
         result = mRealResource->GetHeapProperties(pHeapProperties, pHeapFlags);
-        interceptor->PostCall(this, FuncId_ID3D12Resource_GetHeapProperties, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_ID3D12Resource_GetHeapProperties, packedArguments, result);
     }
     else
     {
@@ -1578,9 +1732,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandAllocator::QueryInterface(REFIID riid
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        }
+
         interceptor->PreCall(this, FuncId_IUnknown_QueryInterface);
         result = mRealCommandAllocator->QueryInterface(riid, ppvObject);
         interceptor->PostCall(this, FuncId_IUnknown_QueryInterface, argumentsBuffer, result);
@@ -1609,12 +1769,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12CommandAllocator::AddRef()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_AddRef);
         result = mRealCommandAllocator->AddRef();
-        interceptor->PostCall(this, FuncId_IUnknown_AddRef, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_AddRef, packedArguments, result);
     }
     else
     {
@@ -1632,12 +1790,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12CommandAllocator::Release()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_Release);
         result = mRealCommandAllocator->Release();
-        interceptor->PostCall(this, FuncId_IUnknown_Release, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_Release, packedArguments, result);
     }
     else
     {
@@ -1651,7 +1807,7 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12CommandAllocator::Release()
 
         if (objectMetadata != NULL)
         {
-            objectMetadata->FlagAsDestroyed();
+            objectDatabase->OnInstanceDestroyed(objectMetadata);
         }
     }
 
@@ -1667,8 +1823,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandAllocator::GetPrivateData(REFGUID gui
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_GetPrivateData);
         result = mRealCommandAllocator->GetPrivateData(guid, pDataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_GetPrivateData, argumentsBuffer, result);
@@ -1690,8 +1851,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandAllocator::SetPrivateData(REFGUID gui
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateData);
         result = mRealCommandAllocator->SetPrivateData(guid, DataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateData, argumentsBuffer, result);
@@ -1713,8 +1879,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandAllocator::SetPrivateDataInterface(RE
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateDataInterface);
         result = mRealCommandAllocator->SetPrivateDataInterface(guid, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateDataInterface, argumentsBuffer, result);
@@ -1736,8 +1907,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandAllocator::SetName(LPCWSTR Name)
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetName);
         result = mRealCommandAllocator->SetName(Name);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetName, argumentsBuffer, result);
@@ -1759,9 +1935,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandAllocator::GetDevice(REFIID riid, voi
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12DeviceChild_GetDevice);
         result = mRealCommandAllocator->GetDevice(riid, ppvDevice);
         interceptor->PostCall(this, FuncId_ID3D12DeviceChild_GetDevice, argumentsBuffer, result);
@@ -1788,12 +1970,10 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandAllocator::Reset()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_ID3D12CommandAllocator_Reset);
         result = mRealCommandAllocator->Reset();
-        interceptor->PostCall(this, FuncId_ID3D12CommandAllocator_Reset, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_ID3D12CommandAllocator_Reset, packedArguments, result);
     }
     else
     {
@@ -1817,9 +1997,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Fence::QueryInterface(REFIID riid, void** pp
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        }
+
         interceptor->PreCall(this, FuncId_IUnknown_QueryInterface);
         result = mRealFence->QueryInterface(riid, ppvObject);
         interceptor->PostCall(this, FuncId_IUnknown_QueryInterface, argumentsBuffer, result);
@@ -1848,12 +2034,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12Fence::AddRef()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_AddRef);
         result = mRealFence->AddRef();
-        interceptor->PostCall(this, FuncId_IUnknown_AddRef, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_AddRef, packedArguments, result);
     }
     else
     {
@@ -1871,12 +2055,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12Fence::Release()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_Release);
         result = mRealFence->Release();
-        interceptor->PostCall(this, FuncId_IUnknown_Release, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_Release, packedArguments, result);
     }
     else
     {
@@ -1890,7 +2072,7 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12Fence::Release()
 
         if (objectMetadata != NULL)
         {
-            objectMetadata->FlagAsDestroyed();
+            objectDatabase->OnInstanceDestroyed(objectMetadata);
         }
     }
 
@@ -1906,8 +2088,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Fence::GetPrivateData(REFGUID guid, UINT* pD
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_GetPrivateData);
         result = mRealFence->GetPrivateData(guid, pDataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_GetPrivateData, argumentsBuffer, result);
@@ -1929,8 +2116,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Fence::SetPrivateData(REFGUID guid, UINT Dat
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateData);
         result = mRealFence->SetPrivateData(guid, DataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateData, argumentsBuffer, result);
@@ -1952,8 +2144,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Fence::SetPrivateDataInterface(REFGUID guid,
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateDataInterface);
         result = mRealFence->SetPrivateDataInterface(guid, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateDataInterface, argumentsBuffer, result);
@@ -1975,8 +2172,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Fence::SetName(LPCWSTR Name)
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetName);
         result = mRealFence->SetName(Name);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetName, argumentsBuffer, result);
@@ -1998,9 +2200,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Fence::GetDevice(REFIID riid, void** ppvDevi
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12DeviceChild_GetDevice);
         result = mRealFence->GetDevice(riid, ppvDevice);
         interceptor->PostCall(this, FuncId_ID3D12DeviceChild_GetDevice, argumentsBuffer, result);
@@ -2027,12 +2235,10 @@ UINT64 STDMETHODCALLTYPE GPS_ID3D12Fence::GetCompletedValue()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_ID3D12Fence_GetCompletedValue);
         result = mRealFence->GetCompletedValue();
-        interceptor->PostCall(this, FuncId_ID3D12Fence_GetCompletedValue, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_ID3D12Fence_GetCompletedValue, packedArguments, result);
     }
     else
     {
@@ -2050,12 +2256,10 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Fence::SetEventOnCompletion(UINT64 Value, HA
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%llu, 0x%p", Value, hEvent);
+        PackedAPIArguments packedArguments("%llu, 0x%p", Value, hEvent);
         interceptor->PreCall(this, FuncId_ID3D12Fence_SetEventOnCompletion);
         result = mRealFence->SetEventOnCompletion(Value, hEvent);
-        interceptor->PostCall(this, FuncId_ID3D12Fence_SetEventOnCompletion, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_ID3D12Fence_SetEventOnCompletion, packedArguments, result);
     }
     else
     {
@@ -2073,12 +2277,10 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Fence::Signal(UINT64 Value)
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%llu", Value);
+        PackedAPIArguments packedArguments("%llu", Value);
         interceptor->PreCall(this, FuncId_ID3D12Fence_Signal);
         result = mRealFence->Signal(Value);
-        interceptor->PostCall(this, FuncId_ID3D12Fence_Signal, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_ID3D12Fence_Signal, packedArguments, result);
     }
     else
     {
@@ -2102,9 +2304,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12PipelineState::QueryInterface(REFIID riid, v
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        }
+
         interceptor->PreCall(this, FuncId_IUnknown_QueryInterface);
         result = mRealPipelineState->QueryInterface(riid, ppvObject);
         interceptor->PostCall(this, FuncId_IUnknown_QueryInterface, argumentsBuffer, result);
@@ -2133,12 +2341,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12PipelineState::AddRef()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_AddRef);
         result = mRealPipelineState->AddRef();
-        interceptor->PostCall(this, FuncId_IUnknown_AddRef, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_AddRef, packedArguments, result);
     }
     else
     {
@@ -2156,12 +2362,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12PipelineState::Release()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_Release);
         result = mRealPipelineState->Release();
-        interceptor->PostCall(this, FuncId_IUnknown_Release, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_Release, packedArguments, result);
     }
     else
     {
@@ -2175,7 +2379,7 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12PipelineState::Release()
 
         if (objectMetadata != NULL)
         {
-            objectMetadata->FlagAsDestroyed();
+            objectDatabase->OnInstanceDestroyed(objectMetadata);
         }
     }
 
@@ -2191,8 +2395,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12PipelineState::GetPrivateData(REFGUID guid,
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_GetPrivateData);
         result = mRealPipelineState->GetPrivateData(guid, pDataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_GetPrivateData, argumentsBuffer, result);
@@ -2214,8 +2423,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12PipelineState::SetPrivateData(REFGUID guid,
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateData);
         result = mRealPipelineState->SetPrivateData(guid, DataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateData, argumentsBuffer, result);
@@ -2237,8 +2451,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12PipelineState::SetPrivateDataInterface(REFGU
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateDataInterface);
         result = mRealPipelineState->SetPrivateDataInterface(guid, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateDataInterface, argumentsBuffer, result);
@@ -2260,8 +2479,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12PipelineState::SetName(LPCWSTR Name)
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetName);
         result = mRealPipelineState->SetName(Name);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetName, argumentsBuffer, result);
@@ -2283,9 +2507,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12PipelineState::GetDevice(REFIID riid, void**
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12DeviceChild_GetDevice);
         result = mRealPipelineState->GetDevice(riid, ppvDevice);
         interceptor->PostCall(this, FuncId_ID3D12DeviceChild_GetDevice, argumentsBuffer, result);
@@ -2312,12 +2542,10 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12PipelineState::GetCachedBlob(ID3DBlob** ppBl
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p", ppBlob);
+        PackedAPIArguments packedArguments("0x%p", ppBlob);
         interceptor->PreCall(this, FuncId_ID3D12PipelineState_GetCachedBlob);
         result = mRealPipelineState->GetCachedBlob(ppBlob);
-        interceptor->PostCall(this, FuncId_ID3D12PipelineState_GetCachedBlob, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_ID3D12PipelineState_GetCachedBlob, packedArguments, result);
     }
     else
     {
@@ -2341,9 +2569,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12DescriptorHeap::QueryInterface(REFIID riid,
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        }
+
         interceptor->PreCall(this, FuncId_IUnknown_QueryInterface);
         result = mRealDescriptorHeap->QueryInterface(riid, ppvObject);
         interceptor->PostCall(this, FuncId_IUnknown_QueryInterface, argumentsBuffer, result);
@@ -2372,12 +2606,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12DescriptorHeap::AddRef()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_AddRef);
         result = mRealDescriptorHeap->AddRef();
-        interceptor->PostCall(this, FuncId_IUnknown_AddRef, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_AddRef, packedArguments, result);
     }
     else
     {
@@ -2395,12 +2627,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12DescriptorHeap::Release()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_Release);
         result = mRealDescriptorHeap->Release();
-        interceptor->PostCall(this, FuncId_IUnknown_Release, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_Release, packedArguments, result);
     }
     else
     {
@@ -2414,7 +2644,7 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12DescriptorHeap::Release()
 
         if (objectMetadata != NULL)
         {
-            objectMetadata->FlagAsDestroyed();
+            objectDatabase->OnInstanceDestroyed(objectMetadata);
         }
     }
 
@@ -2430,10 +2660,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12DescriptorHeap::GetPrivateData(REFGUID guid,
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
-        interceptor->PreCall(this, FuncId_ID3D12Object_GetPrivateData);
-        result = mRealDescriptorHeap->GetPrivateData(guid, pDataSize, pData);
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
+        }
+
+        interceptor->PreCall(this, FuncId_ID3D12Object_GetPrivateData);
+        result = mRealDescriptorHeap->GetPrivateData(guid, pDataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_GetPrivateData, argumentsBuffer, result);
     }
     else
@@ -2453,8 +2688,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12DescriptorHeap::SetPrivateData(REFGUID guid,
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateData);
         result = mRealDescriptorHeap->SetPrivateData(guid, DataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateData, argumentsBuffer, result);
@@ -2476,8 +2716,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12DescriptorHeap::SetPrivateDataInterface(REFG
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateDataInterface);
         result = mRealDescriptorHeap->SetPrivateDataInterface(guid, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateDataInterface, argumentsBuffer, result);
@@ -2499,8 +2744,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12DescriptorHeap::SetName(LPCWSTR Name)
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetName);
         result = mRealDescriptorHeap->SetName(Name);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetName, argumentsBuffer, result);
@@ -2522,9 +2772,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12DescriptorHeap::GetDevice(REFIID riid, void*
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12DeviceChild_GetDevice);
         result = mRealDescriptorHeap->GetDevice(riid, ppvDevice);
         interceptor->PostCall(this, FuncId_ID3D12DeviceChild_GetDevice, argumentsBuffer, result);
@@ -2551,12 +2807,10 @@ D3D12_DESCRIPTOR_HEAP_DESC STDMETHODCALLTYPE GPS_ID3D12DescriptorHeap::GetDesc()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_ID3D12DescriptorHeap_GetDesc);
         result = mRealDescriptorHeap->GetDesc();
-        interceptor->PostCall(this, FuncId_ID3D12DescriptorHeap_GetDesc, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12DescriptorHeap_GetDesc, packedArguments);
     }
     else
     {
@@ -2574,12 +2828,10 @@ D3D12_CPU_DESCRIPTOR_HANDLE STDMETHODCALLTYPE GPS_ID3D12DescriptorHeap::GetCPUDe
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart);
         result = mRealDescriptorHeap->GetCPUDescriptorHandleForHeapStart();
-        interceptor->PostCall(this, FuncId_ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12DescriptorHeap_GetCPUDescriptorHandleForHeapStart, packedArguments);
     }
     else
     {
@@ -2597,12 +2849,10 @@ D3D12_GPU_DESCRIPTOR_HANDLE STDMETHODCALLTYPE GPS_ID3D12DescriptorHeap::GetGPUDe
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_ID3D12DescriptorHeap_GetGPUDescriptorHandleForHeapStart);
         result = mRealDescriptorHeap->GetGPUDescriptorHandleForHeapStart();
-        interceptor->PostCall(this, FuncId_ID3D12DescriptorHeap_GetGPUDescriptorHandleForHeapStart, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12DescriptorHeap_GetGPUDescriptorHandleForHeapStart, packedArguments);
     }
     else
     {
@@ -2626,9 +2876,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12QueryHeap::QueryInterface(REFIID riid, void*
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        }
+
         interceptor->PreCall(this, FuncId_IUnknown_QueryInterface);
         result = mRealQueryHeap->QueryInterface(riid, ppvObject);
         interceptor->PostCall(this, FuncId_IUnknown_QueryInterface, argumentsBuffer, result);
@@ -2657,12 +2913,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12QueryHeap::AddRef()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_AddRef);
         result = mRealQueryHeap->AddRef();
-        interceptor->PostCall(this, FuncId_IUnknown_AddRef, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_AddRef, packedArguments, result);
     }
     else
     {
@@ -2680,12 +2934,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12QueryHeap::Release()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_Release);
         result = mRealQueryHeap->Release();
-        interceptor->PostCall(this, FuncId_IUnknown_Release, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_Release, packedArguments, result);
     }
     else
     {
@@ -2699,7 +2951,7 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12QueryHeap::Release()
 
         if (objectMetadata != NULL)
         {
-            objectMetadata->FlagAsDestroyed();
+            objectDatabase->OnInstanceDestroyed(objectMetadata);
         }
     }
 
@@ -2715,8 +2967,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12QueryHeap::GetPrivateData(REFGUID guid, UINT
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_GetPrivateData);
         result = mRealQueryHeap->GetPrivateData(guid, pDataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_GetPrivateData, argumentsBuffer, result);
@@ -2738,8 +2995,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12QueryHeap::SetPrivateData(REFGUID guid, UINT
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateData);
         result = mRealQueryHeap->SetPrivateData(guid, DataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateData, argumentsBuffer, result);
@@ -2761,8 +3023,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12QueryHeap::SetPrivateDataInterface(REFGUID g
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateDataInterface);
         result = mRealQueryHeap->SetPrivateDataInterface(guid, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateDataInterface, argumentsBuffer, result);
@@ -2784,8 +3051,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12QueryHeap::SetName(LPCWSTR Name)
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetName);
         result = mRealQueryHeap->SetName(Name);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetName, argumentsBuffer, result);
@@ -2807,9 +3079,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12QueryHeap::GetDevice(REFIID riid, void** ppv
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12DeviceChild_GetDevice);
         result = mRealQueryHeap->GetDevice(riid, ppvDevice);
         interceptor->PostCall(this, FuncId_ID3D12DeviceChild_GetDevice, argumentsBuffer, result);
@@ -2842,9 +3120,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandSignature::QueryInterface(REFIID riid
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        }
+
         interceptor->PreCall(this, FuncId_IUnknown_QueryInterface);
         result = mRealCommandSignature->QueryInterface(riid, ppvObject);
         interceptor->PostCall(this, FuncId_IUnknown_QueryInterface, argumentsBuffer, result);
@@ -2873,12 +3157,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12CommandSignature::AddRef()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_AddRef);
         result = mRealCommandSignature->AddRef();
-        interceptor->PostCall(this, FuncId_IUnknown_AddRef, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_AddRef, packedArguments, result);
     }
     else
     {
@@ -2896,12 +3178,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12CommandSignature::Release()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_Release);
         result = mRealCommandSignature->Release();
-        interceptor->PostCall(this, FuncId_IUnknown_Release, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_Release, packedArguments, result);
     }
     else
     {
@@ -2915,7 +3195,7 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12CommandSignature::Release()
 
         if (objectMetadata != NULL)
         {
-            objectMetadata->FlagAsDestroyed();
+            objectDatabase->OnInstanceDestroyed(objectMetadata);
         }
     }
 
@@ -2931,8 +3211,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandSignature::GetPrivateData(REFGUID gui
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_GetPrivateData);
         result = mRealCommandSignature->GetPrivateData(guid, pDataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_GetPrivateData, argumentsBuffer, result);
@@ -2954,8 +3239,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandSignature::SetPrivateData(REFGUID gui
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateData);
         result = mRealCommandSignature->SetPrivateData(guid, DataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateData, argumentsBuffer, result);
@@ -2977,8 +3267,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandSignature::SetPrivateDataInterface(RE
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateDataInterface);
         result = mRealCommandSignature->SetPrivateDataInterface(guid, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateDataInterface, argumentsBuffer, result);
@@ -3000,8 +3295,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandSignature::SetName(LPCWSTR Name)
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetName);
         result = mRealCommandSignature->SetName(Name);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetName, argumentsBuffer, result);
@@ -3023,9 +3323,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandSignature::GetDevice(REFIID riid, voi
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12DeviceChild_GetDevice);
         result = mRealCommandSignature->GetDevice(riid, ppvDevice);
         interceptor->PostCall(this, FuncId_ID3D12DeviceChild_GetDevice, argumentsBuffer, result);
@@ -3058,9 +3364,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandList::QueryInterface(REFIID riid, voi
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        }
+
         interceptor->PreCall(this, FuncId_IUnknown_QueryInterface);
         result = mRealCommandList->QueryInterface(riid, ppvObject);
         interceptor->PostCall(this, FuncId_IUnknown_QueryInterface, argumentsBuffer, result);
@@ -3089,12 +3401,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12CommandList::AddRef()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_AddRef);
         result = mRealCommandList->AddRef();
-        interceptor->PostCall(this, FuncId_IUnknown_AddRef, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_AddRef, packedArguments, result);
     }
     else
     {
@@ -3112,12 +3422,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12CommandList::Release()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_Release);
         result = mRealCommandList->Release();
-        interceptor->PostCall(this, FuncId_IUnknown_Release, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_Release, packedArguments, result);
     }
     else
     {
@@ -3131,7 +3439,7 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12CommandList::Release()
 
         if (objectMetadata != NULL)
         {
-            objectMetadata->FlagAsDestroyed();
+            objectDatabase->OnInstanceDestroyed(objectMetadata);
         }
     }
 
@@ -3147,8 +3455,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandList::GetPrivateData(REFGUID guid, UI
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_GetPrivateData);
         result = mRealCommandList->GetPrivateData(guid, pDataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_GetPrivateData, argumentsBuffer, result);
@@ -3170,8 +3483,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandList::SetPrivateData(REFGUID guid, UI
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateData);
         result = mRealCommandList->SetPrivateData(guid, DataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateData, argumentsBuffer, result);
@@ -3193,8 +3511,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandList::SetPrivateDataInterface(REFGUID
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateDataInterface);
         result = mRealCommandList->SetPrivateDataInterface(guid, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateDataInterface, argumentsBuffer, result);
@@ -3216,8 +3539,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandList::SetName(LPCWSTR Name)
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetName);
         result = mRealCommandList->SetName(Name);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetName, argumentsBuffer, result);
@@ -3239,9 +3567,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandList::GetDevice(REFIID riid, void** p
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12DeviceChild_GetDevice);
         result = mRealCommandList->GetDevice(riid, ppvDevice);
         interceptor->PostCall(this, FuncId_ID3D12DeviceChild_GetDevice, argumentsBuffer, result);
@@ -3268,12 +3602,10 @@ D3D12_COMMAND_LIST_TYPE STDMETHODCALLTYPE GPS_ID3D12CommandList::GetType()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_ID3D12CommandList_GetType);
         result = mRealCommandList->GetType();
-        interceptor->PostCall(this, FuncId_ID3D12CommandList_GetType, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_ID3D12CommandList_GetType, packedArguments, result);
     }
     else
     {
@@ -3297,9 +3629,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::QueryInterface(REFIID r
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        }
+
         interceptor->PreCall(this, FuncId_IUnknown_QueryInterface);
         result = mRealGraphicsCommandList->QueryInterface(riid, ppvObject);
         interceptor->PostCall(this, FuncId_IUnknown_QueryInterface, argumentsBuffer, result);
@@ -3328,12 +3666,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::AddRef()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_AddRef);
         result = mRealGraphicsCommandList->AddRef();
-        interceptor->PostCall(this, FuncId_IUnknown_AddRef, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_AddRef, packedArguments, result);
     }
     else
     {
@@ -3351,12 +3687,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::Release()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_Release);
         result = mRealGraphicsCommandList->Release();
-        interceptor->PostCall(this, FuncId_IUnknown_Release, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_Release, packedArguments, result);
     }
     else
     {
@@ -3370,7 +3704,7 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::Release()
 
         if (objectMetadata != NULL)
         {
-            objectMetadata->FlagAsDestroyed();
+            objectDatabase->OnInstanceDestroyed(objectMetadata);
         }
     }
 
@@ -3386,8 +3720,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::GetPrivateData(REFGUID
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_GetPrivateData);
         result = mRealGraphicsCommandList->GetPrivateData(guid, pDataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_GetPrivateData, argumentsBuffer, result);
@@ -3409,8 +3748,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::SetPrivateData(REFGUID
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateData);
         result = mRealGraphicsCommandList->SetPrivateData(guid, DataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateData, argumentsBuffer, result);
@@ -3432,8 +3776,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::SetPrivateDataInterface
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateDataInterface);
         result = mRealGraphicsCommandList->SetPrivateDataInterface(guid, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateDataInterface, argumentsBuffer, result);
@@ -3455,8 +3804,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::SetName(LPCWSTR Name)
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetName);
         result = mRealGraphicsCommandList->SetName(Name);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetName, argumentsBuffer, result);
@@ -3478,9 +3832,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::GetDevice(REFIID riid,
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12DeviceChild_GetDevice);
         result = mRealGraphicsCommandList->GetDevice(riid, ppvDevice);
         interceptor->PostCall(this, FuncId_ID3D12DeviceChild_GetDevice, argumentsBuffer, result);
@@ -3507,12 +3867,10 @@ D3D12_COMMAND_LIST_TYPE STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::GetType
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_ID3D12CommandList_GetType);
         result = mRealGraphicsCommandList->GetType();
-        interceptor->PostCall(this, FuncId_ID3D12CommandList_GetType, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_ID3D12CommandList_GetType, packedArguments, result);
     }
     else
     {
@@ -3530,12 +3888,10 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::Close()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_Close);
         result = mRealGraphicsCommandList->Close();
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_Close, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_Close, packedArguments, result);
     }
     else
     {
@@ -3557,12 +3913,10 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::Reset(ID3D12CommandAllo
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, +0x%p", pAllocator, pInitialState);
+        PackedAPIArguments packedArguments("+0x%p, +0x%p", pAllocator, pInitialState);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_Reset);
         result = mRealGraphicsCommandList->Reset(pAllocatorUnwrapped, pInitialStateUnwrapped);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_Reset, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_Reset, packedArguments, result);
     }
     else
     {
@@ -3581,12 +3935,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::ClearState(ID3D12PipelineS
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p", pPipelineState);
+        PackedAPIArguments packedArguments("+0x%p", pPipelineState);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_ClearState);
         mRealGraphicsCommandList->ClearState(pPipelineStateUnwrapped);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_ClearState, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_ClearState, packedArguments);
     }
     else
     {
@@ -3600,12 +3952,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::DrawInstanced(UINT VertexC
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %u, %u, %u", VertexCountPerInstance, InstanceCount, StartVertexLocation, StartInstanceLocation);
+        PackedAPIArguments packedArguments("%u, %u, %u, %u", VertexCountPerInstance, InstanceCount, StartVertexLocation, StartInstanceLocation);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_DrawInstanced);
         mRealGraphicsCommandList->DrawInstanced(VertexCountPerInstance, InstanceCount, StartVertexLocation, StartInstanceLocation);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_DrawInstanced, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_DrawInstanced, packedArguments);
     }
     else
     {
@@ -3619,12 +3969,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::DrawIndexedInstanced(UINT
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %u, %u, %d, %u", IndexCountPerInstance, InstanceCount, StartIndexLocation, BaseVertexLocation, StartInstanceLocation);
+        PackedAPIArguments packedArguments("%u, %u, %u, %d, %u", IndexCountPerInstance, InstanceCount, StartIndexLocation, BaseVertexLocation, StartInstanceLocation);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_DrawIndexedInstanced);
         mRealGraphicsCommandList->DrawIndexedInstanced(IndexCountPerInstance, InstanceCount, StartIndexLocation, BaseVertexLocation, StartInstanceLocation);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_DrawIndexedInstanced, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_DrawIndexedInstanced, packedArguments);
     }
     else
     {
@@ -3638,12 +3986,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::Dispatch(UINT ThreadGroupC
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %u, %u", ThreadGroupCountX, ThreadGroupCountY, ThreadGroupCountZ);
+        PackedAPIArguments packedArguments("%u, %u, %u", ThreadGroupCountX, ThreadGroupCountY, ThreadGroupCountZ);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_Dispatch);
         mRealGraphicsCommandList->Dispatch(ThreadGroupCountX, ThreadGroupCountY, ThreadGroupCountZ);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_Dispatch, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_Dispatch, packedArguments);
     }
     else
     {
@@ -3662,12 +4008,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::CopyBufferRegion(ID3D12Res
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, %llu, +0x%p, %llu, %llu", pDstBuffer, DstOffset, pSrcBuffer, SrcOffset, NumBytes);
+        PackedAPIArguments packedArguments("+0x%p, %llu, +0x%p, %llu, %llu", pDstBuffer, DstOffset, pSrcBuffer, SrcOffset, NumBytes);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_CopyBufferRegion);
         mRealGraphicsCommandList->CopyBufferRegion(pDstBufferUnwrapped, DstOffset, pSrcBufferUnwrapped, SrcOffset, NumBytes);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_CopyBufferRegion, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_CopyBufferRegion, packedArguments);
     }
     else
     {
@@ -3686,12 +4030,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::CopyTextureRegion(const D3
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, %u, %u, %u, 0x%p, 0x%p", pDst, DstX, DstY, DstZ, pSrc, pSrcBox);
+        PackedAPIArguments packedArguments("0x%p, %u, %u, %u, 0x%p, 0x%p", pDst, DstX, DstY, DstZ, pSrc, pSrcBox);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_CopyTextureRegion);
         mRealGraphicsCommandList->CopyTextureRegion(&pDstUnwrapped, DstX, DstY, DstZ, &pSrcUnwrapped, pSrcBox);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_CopyTextureRegion, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_CopyTextureRegion, packedArguments);
     }
     else
     {
@@ -3710,12 +4052,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::CopyResource(ID3D12Resourc
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, +0x%p", pDstResource, pSrcResource);
+        PackedAPIArguments packedArguments("+0x%p, +0x%p", pDstResource, pSrcResource);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_CopyResource);
         mRealGraphicsCommandList->CopyResource(pDstResourceUnwrapped, pSrcResourceUnwrapped);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_CopyResource, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_CopyResource, packedArguments);
     }
     else
     {
@@ -3734,12 +4074,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::CopyTiles(ID3D12Resource*
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, 0x%p, 0x%p, +0x%p, %llu, %u", pTiledResource, pTileRegionStartCoordinate, pTileRegionSize, pBuffer, BufferStartOffsetInBytes, Flags);
+        PackedAPIArguments packedArguments("+0x%p, 0x%p, 0x%p, +0x%p, %llu, %u", pTiledResource, pTileRegionStartCoordinate, pTileRegionSize, pBuffer, BufferStartOffsetInBytes, Flags);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_CopyTiles);
         mRealGraphicsCommandList->CopyTiles(pTiledResourceUnwrapped, pTileRegionStartCoordinate, pTileRegionSize, pBufferUnwrapped, BufferStartOffsetInBytes, Flags);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_CopyTiles, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_CopyTiles, packedArguments);
     }
     else
     {
@@ -3759,9 +4097,14 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::ResolveSubresource(ID3D12R
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString dxgiFormat = Stringify_DXGI_FORMAT(Format);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, %u, +0x%p, %u, %s", pDstResource, DstSubresource, pSrcResource, SrcSubresource, dxgiFormat.asCharArray());
+        }
 
-        gtASCIIString dxgiFormat = Stringify_DXGI_FORMAT(Format);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, %u, +0x%p, %u, %s", pDstResource, DstSubresource, pSrcResource, SrcSubresource, dxgiFormat.asCharArray());
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_ResolveSubresource);
         mRealGraphicsCommandList->ResolveSubresource(pDstResourceUnwrapped, DstSubresource, pSrcResourceUnwrapped, SrcSubresource, Format);
         interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_ResolveSubresource, argumentsBuffer);
@@ -3779,8 +4122,13 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::IASetPrimitiveTopology(D3D
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s", DX12CustomSerializers::WritePrimitiveTopology(PrimitiveTopology));
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s", DX12CustomSerializers::WritePrimitiveTopology(PrimitiveTopology));
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_IASetPrimitiveTopology);
         mRealGraphicsCommandList->IASetPrimitiveTopology(PrimitiveTopology);
         interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_IASetPrimitiveTopology, argumentsBuffer);
@@ -3797,12 +4145,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::RSSetViewports(UINT NumVie
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, 0x%p", NumViewports, pViewports);
+        PackedAPIArguments packedArguments("%u, 0x%p", NumViewports, pViewports);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_RSSetViewports);
         mRealGraphicsCommandList->RSSetViewports(NumViewports, pViewports);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_RSSetViewports, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_RSSetViewports, packedArguments);
     }
     else
     {
@@ -3816,12 +4162,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::RSSetScissorRects(UINT Num
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, 0x%p", NumRects, pRects);
+        PackedAPIArguments packedArguments("%u, 0x%p", NumRects, pRects);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_RSSetScissorRects);
         mRealGraphicsCommandList->RSSetScissorRects(NumRects, pRects);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_RSSetScissorRects, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_RSSetScissorRects, packedArguments);
     }
     else
     {
@@ -3836,8 +4180,13 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::OMSetBlendFactor(const FLO
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s", PrintArrayWithFormatter(4, BlendFactor, "%f").c_str());
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s", PrintArrayWithFormatter(4, BlendFactor, "%f").c_str());
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_OMSetBlendFactor);
         mRealGraphicsCommandList->OMSetBlendFactor(BlendFactor);
         interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_OMSetBlendFactor, argumentsBuffer);
@@ -3854,12 +4203,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::OMSetStencilRef(UINT Stenc
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u", StencilRef);
+        PackedAPIArguments packedArguments("%u", StencilRef);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_OMSetStencilRef);
         mRealGraphicsCommandList->OMSetStencilRef(StencilRef);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_OMSetStencilRef, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_OMSetStencilRef, packedArguments);
     }
     else
     {
@@ -3876,12 +4223,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::SetPipelineState(ID3D12Pip
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p", pPipelineState);
+        PackedAPIArguments packedArguments("+0x%p", pPipelineState);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_SetPipelineState);
         mRealGraphicsCommandList->SetPipelineState(pPipelineStateUnwrapped);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetPipelineState, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetPipelineState, packedArguments);
     }
     else
     {
@@ -3907,12 +4252,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::ResourceBarrier(UINT NumBa
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, 0x%p", NumBarriers, pBarriers);
+        PackedAPIArguments packedArguments("%u, 0x%p", NumBarriers, pBarriers);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_ResourceBarrier);
         mRealGraphicsCommandList->ResourceBarrier(NumBarriers, descs);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_ResourceBarrier, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_ResourceBarrier, packedArguments);
     }
     else
     {
@@ -3931,12 +4274,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::ExecuteBundle(ID3D12Graphi
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p", pCommandList);
+        PackedAPIArguments packedArguments("+0x%p", pCommandList);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_ExecuteBundle);
         mRealGraphicsCommandList->ExecuteBundle(pCommandListUnwrapped);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_ExecuteBundle, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_ExecuteBundle, packedArguments);
     }
     else
     {
@@ -3963,8 +4304,13 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::SetDescriptorHeaps(UINT Nu
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %s", NumDescriptorHeaps, PrintArrayWithFormatter(NumDescriptorHeaps, ppDescriptorHeaps, "+0x%p").c_str());
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %s", NumDescriptorHeaps, PrintArrayWithFormatter(NumDescriptorHeaps, ppDescriptorHeaps, "+0x%p").c_str());
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_SetDescriptorHeaps);
         mRealGraphicsCommandList->SetDescriptorHeaps(NumDescriptorHeaps, pDescriptorHeapsUnwrapped);
         interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetDescriptorHeaps, argumentsBuffer);
@@ -3986,12 +4332,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::SetComputeRootSignature(ID
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p", pRootSignature);
+        PackedAPIArguments packedArguments("+0x%p", pRootSignature);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_SetComputeRootSignature);
         mRealGraphicsCommandList->SetComputeRootSignature(pRootSignatureUnwrapped);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetComputeRootSignature, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetComputeRootSignature, packedArguments);
     }
     else
     {
@@ -4008,12 +4352,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::SetGraphicsRootSignature(I
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p", pRootSignature);
+        PackedAPIArguments packedArguments("+0x%p", pRootSignature);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_SetGraphicsRootSignature);
         mRealGraphicsCommandList->SetGraphicsRootSignature(pRootSignatureUnwrapped);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetGraphicsRootSignature, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetGraphicsRootSignature, packedArguments);
     }
     else
     {
@@ -4027,12 +4369,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::SetComputeRootDescriptorTa
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, 0x%p", RootParameterIndex, (void*)BaseDescriptor.ptr);
+        PackedAPIArguments packedArguments("%u, 0x%p", RootParameterIndex, (void*)BaseDescriptor.ptr);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_SetComputeRootDescriptorTable);
         mRealGraphicsCommandList->SetComputeRootDescriptorTable(RootParameterIndex, BaseDescriptor);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetComputeRootDescriptorTable, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetComputeRootDescriptorTable, packedArguments);
     }
     else
     {
@@ -4046,12 +4386,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::SetGraphicsRootDescriptorT
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, 0x%p", RootParameterIndex, (void*)BaseDescriptor.ptr);
+        PackedAPIArguments packedArguments("%u, 0x%p", RootParameterIndex, (void*)BaseDescriptor.ptr);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_SetGraphicsRootDescriptorTable);
         mRealGraphicsCommandList->SetGraphicsRootDescriptorTable(RootParameterIndex, BaseDescriptor);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetGraphicsRootDescriptorTable, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetGraphicsRootDescriptorTable, packedArguments);
     }
     else
     {
@@ -4065,12 +4403,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::SetComputeRoot32BitConstan
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %u, %u", RootParameterIndex, SrcData, DestOffsetIn32BitValues);
+        PackedAPIArguments packedArguments("%u, %u, %u", RootParameterIndex, SrcData, DestOffsetIn32BitValues);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_SetComputeRoot32BitConstant);
         mRealGraphicsCommandList->SetComputeRoot32BitConstant(RootParameterIndex, SrcData, DestOffsetIn32BitValues);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetComputeRoot32BitConstant, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetComputeRoot32BitConstant, packedArguments);
     }
     else
     {
@@ -4084,12 +4420,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::SetGraphicsRoot32BitConsta
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %u, %u", RootParameterIndex, SrcData, DestOffsetIn32BitValues);
+        PackedAPIArguments packedArguments("%u, %u, %u", RootParameterIndex, SrcData, DestOffsetIn32BitValues);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_SetGraphicsRoot32BitConstant);
         mRealGraphicsCommandList->SetGraphicsRoot32BitConstant(RootParameterIndex, SrcData, DestOffsetIn32BitValues);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetGraphicsRoot32BitConstant, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetGraphicsRoot32BitConstant, packedArguments);
     }
     else
     {
@@ -4103,12 +4437,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::SetComputeRoot32BitConstan
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %u, 0x%p, %u", RootParameterIndex, Num32BitValuesToSet, pSrcData, DestOffsetIn32BitValues);
+        PackedAPIArguments packedArguments("%u, %u, 0x%p, %u", RootParameterIndex, Num32BitValuesToSet, pSrcData, DestOffsetIn32BitValues);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_SetComputeRoot32BitConstants);
         mRealGraphicsCommandList->SetComputeRoot32BitConstants(RootParameterIndex, Num32BitValuesToSet, pSrcData, DestOffsetIn32BitValues);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetComputeRoot32BitConstants, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetComputeRoot32BitConstants, packedArguments);
     }
     else
     {
@@ -4122,12 +4454,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::SetGraphicsRoot32BitConsta
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %u, 0x%p, %u", RootParameterIndex, Num32BitValuesToSet, pSrcData, DestOffsetIn32BitValues);
+        PackedAPIArguments packedArguments("%u, %u, 0x%p, %u", RootParameterIndex, Num32BitValuesToSet, pSrcData, DestOffsetIn32BitValues);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_SetGraphicsRoot32BitConstants);
         mRealGraphicsCommandList->SetGraphicsRoot32BitConstants(RootParameterIndex, Num32BitValuesToSet, pSrcData, DestOffsetIn32BitValues);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetGraphicsRoot32BitConstants, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetGraphicsRoot32BitConstants, packedArguments);
     }
     else
     {
@@ -4141,12 +4471,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::SetComputeRootConstantBuff
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %llu", RootParameterIndex, BufferLocation);
+        PackedAPIArguments packedArguments("%u, %llu", RootParameterIndex, BufferLocation);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_SetComputeRootConstantBufferView);
         mRealGraphicsCommandList->SetComputeRootConstantBufferView(RootParameterIndex, BufferLocation);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetComputeRootConstantBufferView, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetComputeRootConstantBufferView, packedArguments);
     }
     else
     {
@@ -4160,12 +4488,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::SetGraphicsRootConstantBuf
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %llu", RootParameterIndex, BufferLocation);
+        PackedAPIArguments packedArguments("%u, %llu", RootParameterIndex, BufferLocation);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_SetGraphicsRootConstantBufferView);
         mRealGraphicsCommandList->SetGraphicsRootConstantBufferView(RootParameterIndex, BufferLocation);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetGraphicsRootConstantBufferView, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetGraphicsRootConstantBufferView, packedArguments);
     }
     else
     {
@@ -4179,12 +4505,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::SetComputeRootShaderResour
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %llu", RootParameterIndex, BufferLocation);
+        PackedAPIArguments packedArguments("%u, %llu", RootParameterIndex, BufferLocation);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_SetComputeRootShaderResourceView);
         mRealGraphicsCommandList->SetComputeRootShaderResourceView(RootParameterIndex, BufferLocation);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetComputeRootShaderResourceView, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetComputeRootShaderResourceView, packedArguments);
     }
     else
     {
@@ -4198,12 +4522,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::SetGraphicsRootShaderResou
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %llu", RootParameterIndex, BufferLocation);
+        PackedAPIArguments packedArguments("%u, %llu", RootParameterIndex, BufferLocation);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_SetGraphicsRootShaderResourceView);
         mRealGraphicsCommandList->SetGraphicsRootShaderResourceView(RootParameterIndex, BufferLocation);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetGraphicsRootShaderResourceView, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetGraphicsRootShaderResourceView, packedArguments);
     }
     else
     {
@@ -4217,12 +4539,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::SetComputeRootUnorderedAcc
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %llu", RootParameterIndex, BufferLocation);
+        PackedAPIArguments packedArguments("%u, %llu", RootParameterIndex, BufferLocation);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_SetComputeRootUnorderedAccessView);
         mRealGraphicsCommandList->SetComputeRootUnorderedAccessView(RootParameterIndex, BufferLocation);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetComputeRootUnorderedAccessView, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetComputeRootUnorderedAccessView, packedArguments);
     }
     else
     {
@@ -4236,12 +4556,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::SetGraphicsRootUnorderedAc
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %llu", RootParameterIndex, BufferLocation);
+        PackedAPIArguments packedArguments("%u, %llu", RootParameterIndex, BufferLocation);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_SetGraphicsRootUnorderedAccessView);
         mRealGraphicsCommandList->SetGraphicsRootUnorderedAccessView(RootParameterIndex, BufferLocation);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetGraphicsRootUnorderedAccessView, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetGraphicsRootUnorderedAccessView, packedArguments);
     }
     else
     {
@@ -4255,12 +4573,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::IASetIndexBuffer(const D3D
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p", pView);
+        PackedAPIArguments packedArguments("0x%p", pView);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_IASetIndexBuffer);
         mRealGraphicsCommandList->IASetIndexBuffer(pView);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_IASetIndexBuffer, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_IASetIndexBuffer, packedArguments);
     }
     else
     {
@@ -4274,12 +4590,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::IASetVertexBuffers(UINT St
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %u, 0x%p", StartSlot, NumViews, pViews);
+        PackedAPIArguments packedArguments("%u, %u, 0x%p", StartSlot, NumViews, pViews);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_IASetVertexBuffers);
         mRealGraphicsCommandList->IASetVertexBuffers(StartSlot, NumViews, pViews);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_IASetVertexBuffers, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_IASetVertexBuffers, packedArguments);
     }
     else
     {
@@ -4293,12 +4607,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::SOSetTargets(UINT StartSlo
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %u, 0x%p", StartSlot, NumViews, pViews);
+        PackedAPIArguments packedArguments("%u, %u, 0x%p", StartSlot, NumViews, pViews);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_SOSetTargets);
         mRealGraphicsCommandList->SOSetTargets(StartSlot, NumViews, pViews);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SOSetTargets, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SOSetTargets, packedArguments);
     }
     else
     {
@@ -4313,8 +4625,13 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::OMSetRenderTargets(UINT Nu
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, 0x%p, %s, 0x%p", NumRenderTargetDescriptors, pRenderTargetDescriptors, DX12Util::PrintBool(RTsSingleHandleToDescriptorRange), pDepthStencilDescriptor);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, 0x%p, %s, 0x%p", NumRenderTargetDescriptors, pRenderTargetDescriptors, DX12Util::PrintBool(RTsSingleHandleToDescriptorRange), pDepthStencilDescriptor);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_OMSetRenderTargets);
         mRealGraphicsCommandList->OMSetRenderTargets(NumRenderTargetDescriptors, pRenderTargetDescriptors, RTsSingleHandleToDescriptorRange, pDepthStencilDescriptor);
         interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_OMSetRenderTargets, argumentsBuffer);
@@ -4331,12 +4648,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::ClearDepthStencilView(D3D1
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, %u, %f, %hhu, %u, 0x%p", (void*)DepthStencilView.ptr, ClearFlags, Depth, Stencil, NumRects, pRects);
+        PackedAPIArguments packedArguments("0x%p, %u, %f, %hhu, %u, 0x%p", (void*)DepthStencilView.ptr, ClearFlags, Depth, Stencil, NumRects, pRects);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_ClearDepthStencilView);
         mRealGraphicsCommandList->ClearDepthStencilView(DepthStencilView, ClearFlags, Depth, Stencil, NumRects, pRects);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_ClearDepthStencilView, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_ClearDepthStencilView, packedArguments);
     }
     else
     {
@@ -4351,8 +4666,13 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::ClearRenderTargetView(D3D1
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, %s, %u, 0x%p", (void*)RenderTargetView.ptr, PrintArrayWithFormatter(4, ColorRGBA, "%f").c_str(), NumRects, pRects);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, %s, %u, 0x%p", (void*)RenderTargetView.ptr, PrintArrayWithFormatter(4, ColorRGBA, "%f").c_str(), NumRects, pRects);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_ClearRenderTargetView);
         mRealGraphicsCommandList->ClearRenderTargetView(RenderTargetView, ColorRGBA, NumRects, pRects);
         interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_ClearRenderTargetView, argumentsBuffer);
@@ -4373,8 +4693,13 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::ClearUnorderedAccessViewUi
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, 0x%p, +0x%p, %s, %u, 0x%p", (void*)ViewGPUHandleInCurrentHeap.ptr, (void*)ViewCPUHandle.ptr, pResource, PrintArrayWithFormatter(4, Values, "%u").c_str(), NumRects, pRects);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, 0x%p, +0x%p, %s, %u, 0x%p", (void*)ViewGPUHandleInCurrentHeap.ptr, (void*)ViewCPUHandle.ptr, pResource, PrintArrayWithFormatter(4, Values, "%u").c_str(), NumRects, pRects);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_ClearUnorderedAccessViewUint);
         mRealGraphicsCommandList->ClearUnorderedAccessViewUint(ViewGPUHandleInCurrentHeap, ViewCPUHandle, pResourceUnwrapped, Values, NumRects, pRects);
         interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_ClearUnorderedAccessViewUint, argumentsBuffer);
@@ -4395,8 +4720,13 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::ClearUnorderedAccessViewFl
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, 0x%p, +0x%p, %s, %u, 0x%p", (void*)ViewGPUHandleInCurrentHeap.ptr, (void*)ViewCPUHandle.ptr, pResource, PrintArrayWithFormatter(4, Values, "%f").c_str(), NumRects, pRects);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, 0x%p, +0x%p, %s, %u, 0x%p", (void*)ViewGPUHandleInCurrentHeap.ptr, (void*)ViewCPUHandle.ptr, pResource, PrintArrayWithFormatter(4, Values, "%f").c_str(), NumRects, pRects);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_ClearUnorderedAccessViewFloat);
         mRealGraphicsCommandList->ClearUnorderedAccessViewFloat(ViewGPUHandleInCurrentHeap, ViewCPUHandle, pResourceUnwrapped, Values, NumRects, pRects);
         interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_ClearUnorderedAccessViewFloat, argumentsBuffer);
@@ -4416,12 +4746,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::DiscardResource(ID3D12Reso
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, 0x%p", pResource, pRegion);
+        PackedAPIArguments packedArguments("+0x%p, 0x%p", pResource, pRegion);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_DiscardResource);
         mRealGraphicsCommandList->DiscardResource(pResourceUnwrapped, pRegion);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_DiscardResource, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_DiscardResource, packedArguments);
     }
     else
     {
@@ -4439,8 +4767,13 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::BeginQuery(ID3D12QueryHeap
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, %s, %u", pQueryHeap, DX12CoreSerializers::WriteQueryTypeEnumAsString(Type), Index);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, %s, %u", pQueryHeap, DX12CoreSerializers::WriteQueryTypeEnumAsString(Type), Index);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_BeginQuery);
         mRealGraphicsCommandList->BeginQuery(pQueryHeapUnwrapped, Type, Index);
         interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_BeginQuery, argumentsBuffer);
@@ -4461,8 +4794,13 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::EndQuery(ID3D12QueryHeap*
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, %s, %u", pQueryHeap, DX12CoreSerializers::WriteQueryTypeEnumAsString(Type), Index);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, %s, %u", pQueryHeap, DX12CoreSerializers::WriteQueryTypeEnumAsString(Type), Index);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_EndQuery);
         mRealGraphicsCommandList->EndQuery(pQueryHeapUnwrapped, Type, Index);
         interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_EndQuery, argumentsBuffer);
@@ -4485,8 +4823,13 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::ResolveQueryData(ID3D12Que
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, %s, %u, %u, +0x%p, %llu", pQueryHeap, DX12CoreSerializers::WriteQueryTypeEnumAsString(Type), StartIndex, NumQueries, pDestinationBuffer, AlignedDestinationBufferOffset);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, %s, %u, %u, +0x%p, %llu", pQueryHeap, DX12CoreSerializers::WriteQueryTypeEnumAsString(Type), StartIndex, NumQueries, pDestinationBuffer, AlignedDestinationBufferOffset);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_ResolveQueryData);
         mRealGraphicsCommandList->ResolveQueryData(pQueryHeapUnwrapped, Type, StartIndex, NumQueries, pDestinationBufferUnwrapped, AlignedDestinationBufferOffset);
         interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_ResolveQueryData, argumentsBuffer);
@@ -4507,8 +4850,13 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::SetPredication(ID3D12Resou
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, %llu, %s", pBuffer, AlignedBufferOffset, DX12CoreSerializers::WritePredicationOpEnumAsString(Operation));
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, %llu, %s", pBuffer, AlignedBufferOffset, DX12CoreSerializers::WritePredicationOpEnumAsString(Operation));
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_SetPredication);
         mRealGraphicsCommandList->SetPredication(pBufferUnwrapped, AlignedBufferOffset, Operation);
         interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetPredication, argumentsBuffer);
@@ -4525,12 +4873,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::SetMarker(UINT Metadata, c
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, 0x%p, %u", Metadata, pData, Size);
+        PackedAPIArguments packedArguments("%u, 0x%p, %u", Metadata, pData, Size);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_SetMarker);
         mRealGraphicsCommandList->SetMarker(Metadata, pData, Size);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetMarker, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_SetMarker, packedArguments);
     }
     else
     {
@@ -4545,7 +4891,12 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::BeginEvent(UINT Metadata,
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %ls, %u", Metadata, static_cast<const wchar_t*>(pData), Size);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %ls, %u", Metadata, static_cast<const wchar_t*>(pData), Size);
+        }
 
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_BeginEvent);
         mRealGraphicsCommandList->BeginEvent(Metadata, pData, Size);
@@ -4563,12 +4914,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::EndEvent()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_EndEvent);
         mRealGraphicsCommandList->EndEvent();
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_EndEvent, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_EndEvent, packedArguments);
     }
     else
     {
@@ -4590,12 +4939,10 @@ void STDMETHODCALLTYPE GPS_ID3D12GraphicsCommandList::ExecuteIndirect(ID3D12Comm
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, %u, +0x%p, %llu, +0x%p, %llu", pCommandSignature, MaxCommandCount, pArgumentBuffer, ArgumentBufferOffset, pCountBuffer, CountBufferOffset);
+        PackedAPIArguments packedArguments("+0x%p, %u, +0x%p, %llu, +0x%p, %llu", pCommandSignature, MaxCommandCount, pArgumentBuffer, ArgumentBufferOffset, pCountBuffer, CountBufferOffset);
         interceptor->PreCall(this, FuncId_ID3D12GraphicsCommandList_ExecuteIndirect);
         mRealGraphicsCommandList->ExecuteIndirect(pCommandSignatureUnwrapped, MaxCommandCount, pArgumentBufferUnwrapped, ArgumentBufferOffset, pCountBufferUnwrapped, CountBufferOffset);
-        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_ExecuteIndirect, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12GraphicsCommandList_ExecuteIndirect, packedArguments);
     }
     else
     {
@@ -4617,10 +4964,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandQueue::QueryInterface(REFIID riid, vo
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        }
 
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
         interceptor->PreCall(this, FuncId_IUnknown_QueryInterface);
         result = mRealCommandQueue->QueryInterface(riid, ppvObject);
         interceptor->PostCall(this, FuncId_IUnknown_QueryInterface, argumentsBuffer, result);
@@ -4649,12 +5001,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12CommandQueue::AddRef()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_AddRef);
         result = mRealCommandQueue->AddRef();
-        interceptor->PostCall(this, FuncId_IUnknown_AddRef, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_AddRef, packedArguments, result);
     }
     else
     {
@@ -4672,12 +5022,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12CommandQueue::Release()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_Release);
         result = mRealCommandQueue->Release();
-        interceptor->PostCall(this, FuncId_IUnknown_Release, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_Release, packedArguments, result);
     }
     else
     {
@@ -4691,7 +5039,7 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12CommandQueue::Release()
 
         if (objectMetadata != NULL)
         {
-            objectMetadata->FlagAsDestroyed();
+            objectDatabase->OnInstanceDestroyed(objectMetadata);
         }
     }
 
@@ -4707,8 +5055,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandQueue::GetPrivateData(REFGUID guid, U
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_GetPrivateData);
         result = mRealCommandQueue->GetPrivateData(guid, pDataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_GetPrivateData, argumentsBuffer, result);
@@ -4730,8 +5083,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandQueue::SetPrivateData(REFGUID guid, U
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateData);
         result = mRealCommandQueue->SetPrivateData(guid, DataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateData, argumentsBuffer, result);
@@ -4753,8 +5111,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandQueue::SetPrivateDataInterface(REFGUI
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateDataInterface);
         result = mRealCommandQueue->SetPrivateDataInterface(guid, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateDataInterface, argumentsBuffer, result);
@@ -4776,8 +5139,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandQueue::SetName(LPCWSTR Name)
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetName);
         result = mRealCommandQueue->SetName(Name);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetName, argumentsBuffer, result);
@@ -4799,9 +5167,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandQueue::GetDevice(REFIID riid, void**
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvDevice);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12DeviceChild_GetDevice);
         result = mRealCommandQueue->GetDevice(riid, ppvDevice);
         interceptor->PostCall(this, FuncId_ID3D12DeviceChild_GetDevice, argumentsBuffer, result);
@@ -4831,12 +5205,10 @@ void STDMETHODCALLTYPE GPS_ID3D12CommandQueue::UpdateTileMappings(ID3D12Resource
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, %u, 0x%p, 0x%p, +0x%p, %u, 0x%p, %u, %u, %u", pResource, NumResourceRegions, pResourceRegionStartCoordinates, pResourceRegionSizes, pHeap, NumRanges, pRangeFlags, *pHeapRangeStartOffsets, *pRangeTileCounts, Flags);
+        PackedAPIArguments packedArguments("+0x%p, %u, 0x%p, 0x%p, +0x%p, %u, 0x%p, %u, %u, %u", pResource, NumResourceRegions, pResourceRegionStartCoordinates, pResourceRegionSizes, pHeap, NumRanges, pRangeFlags, *pHeapRangeStartOffsets, *pRangeTileCounts, Flags);
         interceptor->PreCall(this, FuncId_ID3D12CommandQueue_UpdateTileMappings);
         mRealCommandQueue->UpdateTileMappings(pResourceUnwrapped, NumResourceRegions, pResourceRegionStartCoordinates, pResourceRegionSizes, pHeapUnwrapped, NumRanges, pRangeFlags, pHeapRangeStartOffsets, pRangeTileCounts, Flags);
-        interceptor->PostCall(this, FuncId_ID3D12CommandQueue_UpdateTileMappings, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12CommandQueue_UpdateTileMappings, packedArguments);
     }
     else
     {
@@ -4855,12 +5227,10 @@ void STDMETHODCALLTYPE GPS_ID3D12CommandQueue::CopyTileMappings(ID3D12Resource*
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, 0x%p, +0x%p, 0x%p, 0x%p, %u", pDstResource, pDstRegionStartCoordinate, pSrcResource, pSrcRegionStartCoordinate, pRegionSize, Flags);
+        PackedAPIArguments packedArguments("+0x%p, 0x%p, +0x%p, 0x%p, 0x%p, %u", pDstResource, pDstRegionStartCoordinate, pSrcResource, pSrcRegionStartCoordinate, pRegionSize, Flags);
         interceptor->PreCall(this, FuncId_ID3D12CommandQueue_CopyTileMappings);
         mRealCommandQueue->CopyTileMappings(pDstResourceUnwrapped, pDstRegionStartCoordinate, pSrcResourceUnwrapped, pSrcRegionStartCoordinate, pRegionSize, Flags);
-        interceptor->PostCall(this, FuncId_ID3D12CommandQueue_CopyTileMappings, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12CommandQueue_CopyTileMappings, packedArguments);
     }
     else
     {
@@ -4887,8 +5257,13 @@ void STDMETHODCALLTYPE GPS_ID3D12CommandQueue::ExecuteCommandLists(UINT NumComma
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %s", NumCommandLists, PrintArrayWithFormatter(NumCommandLists, ppCommandLists, "0x%p").c_str());
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %s", NumCommandLists, PrintArrayWithFormatter(NumCommandLists, ppCommandLists, "0x%p").c_str());
         interceptor->PreCall(this, FuncId_ID3D12CommandQueue_ExecuteCommandLists);
         mRealCommandQueue->ExecuteCommandLists(NumCommandLists, ppCommandListsCopy);
         interceptor->PostCall(this, FuncId_ID3D12CommandQueue_ExecuteCommandLists, argumentsBuffer);
@@ -4907,12 +5282,10 @@ void STDMETHODCALLTYPE GPS_ID3D12CommandQueue::SetMarker(UINT Metadata, const vo
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, 0x%p, %u", Metadata, pData, Size);
+        PackedAPIArguments packedArguments("%u, 0x%p, %u", Metadata, pData, Size);
         interceptor->PreCall(this, FuncId_ID3D12CommandQueue_SetMarker);
         mRealCommandQueue->SetMarker(Metadata, pData, Size);
-        interceptor->PostCall(this, FuncId_ID3D12CommandQueue_SetMarker, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12CommandQueue_SetMarker, packedArguments);
     }
     else
     {
@@ -4927,8 +5300,13 @@ void STDMETHODCALLTYPE GPS_ID3D12CommandQueue::BeginEvent(UINT Metadata, const v
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %ls, %u", Metadata, static_cast<const wchar_t*>(pData), Size);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %ls, %u", Metadata, static_cast<const wchar_t*>(pData), Size);
         interceptor->PreCall(this, FuncId_ID3D12CommandQueue_BeginEvent);
         mRealCommandQueue->BeginEvent(Metadata, pData, Size);
         interceptor->PostCall(this, FuncId_ID3D12CommandQueue_BeginEvent, argumentsBuffer);
@@ -4945,12 +5323,10 @@ void STDMETHODCALLTYPE GPS_ID3D12CommandQueue::EndEvent()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_ID3D12CommandQueue_EndEvent);
         mRealCommandQueue->EndEvent();
-        interceptor->PostCall(this, FuncId_ID3D12CommandQueue_EndEvent, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12CommandQueue_EndEvent, packedArguments);
     }
     else
     {
@@ -4968,12 +5344,10 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandQueue::Signal(ID3D12Fence* pFence, UI
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, %llu", pFence, Value);
+        PackedAPIArguments packedArguments("+0x%p, %llu", pFence, Value);
         interceptor->PreCall(this, FuncId_ID3D12CommandQueue_Signal);
         result = mRealCommandQueue->Signal(pFenceUnwrapped, Value);
-        interceptor->PostCall(this, FuncId_ID3D12CommandQueue_Signal, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_ID3D12CommandQueue_Signal, packedArguments, result);
     }
     else
     {
@@ -4993,12 +5367,10 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandQueue::Wait(ID3D12Fence* pFence, UINT
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, %llu", pFence, Value);
+        PackedAPIArguments packedArguments("+0x%p, %llu", pFence, Value);
         interceptor->PreCall(this, FuncId_ID3D12CommandQueue_Wait);
         result = mRealCommandQueue->Wait(pFenceUnwrapped, Value);
-        interceptor->PostCall(this, FuncId_ID3D12CommandQueue_Wait, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_ID3D12CommandQueue_Wait, packedArguments, result);
     }
     else
     {
@@ -5016,12 +5388,10 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandQueue::GetTimestampFrequency(UINT64*
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%llu", *pFrequency);
+        PackedAPIArguments packedArguments("%llu", *pFrequency);
         interceptor->PreCall(this, FuncId_ID3D12CommandQueue_GetTimestampFrequency);
         result = mRealCommandQueue->GetTimestampFrequency(pFrequency);
-        interceptor->PostCall(this, FuncId_ID3D12CommandQueue_GetTimestampFrequency, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_ID3D12CommandQueue_GetTimestampFrequency, packedArguments, result);
     }
     else
     {
@@ -5039,12 +5409,10 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12CommandQueue::GetClockCalibration(UINT64* pG
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%llu, %llu", *pGpuTimestamp, *pCpuTimestamp);
+        PackedAPIArguments packedArguments("%llu, %llu", *pGpuTimestamp, *pCpuTimestamp);
         interceptor->PreCall(this, FuncId_ID3D12CommandQueue_GetClockCalibration);
         result = mRealCommandQueue->GetClockCalibration(pGpuTimestamp, pCpuTimestamp);
-        interceptor->PostCall(this, FuncId_ID3D12CommandQueue_GetClockCalibration, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_ID3D12CommandQueue_GetClockCalibration, packedArguments, result);
     }
     else
     {
@@ -5062,12 +5430,10 @@ D3D12_COMMAND_QUEUE_DESC STDMETHODCALLTYPE GPS_ID3D12CommandQueue::GetDesc()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_ID3D12CommandQueue_GetDesc);
         result = mRealCommandQueue->GetDesc();
-        interceptor->PostCall(this, FuncId_ID3D12CommandQueue_GetDesc, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12CommandQueue_GetDesc, packedArguments);
     }
     else
     {
@@ -5091,9 +5457,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::QueryInterface(REFIID riid, void** p
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p", refiidString.asCharArray(), ppvObject);
+        }
+
         interceptor->PreCall(this, FuncId_IUnknown_QueryInterface);
         result = mRealDevice->QueryInterface(riid, ppvObject);
         interceptor->PostCall(this, FuncId_IUnknown_QueryInterface, argumentsBuffer, result);
@@ -5122,12 +5494,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12Device::AddRef()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_AddRef);
         result = mRealDevice->AddRef();
-        interceptor->PostCall(this, FuncId_IUnknown_AddRef, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_AddRef, packedArguments, result);
     }
     else
     {
@@ -5145,12 +5515,10 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12Device::Release()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_IUnknown_Release);
         result = mRealDevice->Release();
-        interceptor->PostCall(this, FuncId_IUnknown_Release, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_IUnknown_Release, packedArguments, result);
     }
     else
     {
@@ -5164,7 +5532,7 @@ ULONG STDMETHODCALLTYPE GPS_ID3D12Device::Release()
 
         if (objectMetadata != NULL)
         {
-            objectMetadata->FlagAsDestroyed();
+            objectDatabase->OnInstanceDestroyed(objectMetadata);
         }
 
         objectDatabase->OnDeviceDestroyed(objectMetadata);
@@ -5182,8 +5550,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::GetPrivateData(REFGUID guid, UINT* p
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), *pDataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_GetPrivateData);
         result = mRealDevice->GetPrivateData(guid, pDataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_GetPrivateData, argumentsBuffer, result);
@@ -5205,8 +5578,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::SetPrivateData(REFGUID guid, UINT Da
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %u, 0x%p", DX12Util::PrintGUID(guid), DataSize, pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateData);
         result = mRealDevice->SetPrivateData(guid, DataSize, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateData, argumentsBuffer, result);
@@ -5228,8 +5606,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::SetPrivateDataInterface(REFGUID guid
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, +0x%p", DX12Util::PrintGUID(guid), pData);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetPrivateDataInterface);
         result = mRealDevice->SetPrivateDataInterface(guid, pData);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetPrivateDataInterface, argumentsBuffer, result);
@@ -5251,8 +5634,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::SetName(LPCWSTR Name)
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls", Name);
         interceptor->PreCall(this, FuncId_ID3D12Object_SetName);
         result = mRealDevice->SetName(Name);
         interceptor->PostCall(this, FuncId_ID3D12Object_SetName, argumentsBuffer, result);
@@ -5273,12 +5661,10 @@ UINT STDMETHODCALLTYPE GPS_ID3D12Device::GetNodeCount()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_ID3D12Device_GetNodeCount);
         result = mRealDevice->GetNodeCount();
-        interceptor->PostCall(this, FuncId_ID3D12Device_GetNodeCount, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_ID3D12Device_GetNodeCount, packedArguments, result);
     }
     else
     {
@@ -5297,9 +5683,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::CreateCommandQueue(const D3D12_COMMA
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, %s, 0x%p", pDesc, refiidString.asCharArray(), ppCommandQueue);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, %s, 0x%p", pDesc, refiidString.asCharArray(), ppCommandQueue);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12Device_CreateCommandQueue);
         result = mRealDevice->CreateCommandQueue(pDesc, riid, ppCommandQueue);
         interceptor->PostCall(this, FuncId_ID3D12Device_CreateCommandQueue, argumentsBuffer, result);
@@ -5330,9 +5722,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::CreateCommandAllocator(D3D12_COMMAND
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %s, 0x%p", DX12CoreSerializers::WriteCommandListTypeEnumAsString(type), refiidString.asCharArray(), ppCommandAllocator);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, %s, 0x%p", DX12CoreSerializers::WriteCommandListTypeEnumAsString(type), refiidString.asCharArray(), ppCommandAllocator);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12Device_CreateCommandAllocator);
         result = mRealDevice->CreateCommandAllocator(type, riid, ppCommandAllocator);
         interceptor->PostCall(this, FuncId_ID3D12Device_CreateCommandAllocator, argumentsBuffer, result);
@@ -5365,9 +5763,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::CreateGraphicsPipelineState(const D3
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, %s, 0x%p", pDesc, refiidString.asCharArray(), ppPipelineState);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, %s, 0x%p", pDesc, refiidString.asCharArray(), ppPipelineState);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12Device_CreateGraphicsPipelineState);
         result = mRealDevice->CreateGraphicsPipelineState(&pDescUnwrapped, riid, ppPipelineState);
         interceptor->PostCall(this, FuncId_ID3D12Device_CreateGraphicsPipelineState, argumentsBuffer, result);
@@ -5397,9 +5801,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::CreateComputePipelineState(const D3D
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, %s, 0x%p", pDesc, refiidString.asCharArray(), ppPipelineState);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, %s, 0x%p", pDesc, refiidString.asCharArray(), ppPipelineState);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12Device_CreateComputePipelineState);
         result = mRealDevice->CreateComputePipelineState(&pDescUnwrapped, riid, ppPipelineState);
         interceptor->PostCall(this, FuncId_ID3D12Device_CreateComputePipelineState, argumentsBuffer, result);
@@ -5431,9 +5841,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::CreateCommandList(UINT nodeMask, D3D
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %s, +0x%p, +0x%p, %s, 0x%p", nodeMask, DX12CoreSerializers::WriteCommandListTypeEnumAsString(type), pCommandAllocator, pInitialState, refiidString.asCharArray(), ppCommandList);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %s, +0x%p, +0x%p, %s, 0x%p", nodeMask, DX12CoreSerializers::WriteCommandListTypeEnumAsString(type), pCommandAllocator, pInitialState, refiidString.asCharArray(), ppCommandList);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12Device_CreateCommandList);
         result = mRealDevice->CreateCommandList(nodeMask, type, pCommandAllocatorUnwrapped, pInitialStateUnwrapped, riid, ppCommandList);
         interceptor->PostCall(this, FuncId_ID3D12Device_CreateCommandList, argumentsBuffer, result);
@@ -5469,8 +5885,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::CheckFeatureSupport(D3D12_FEATURE Fe
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p, %u", DX12CoreSerializers::WriteFeatureEnumAsString(Feature), pFeatureSupportData, FeatureSupportDataSize);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s, 0x%p, %u", DX12CoreSerializers::WriteFeatureEnumAsString(Feature), pFeatureSupportData, FeatureSupportDataSize);
         interceptor->PreCall(this, FuncId_ID3D12Device_CheckFeatureSupport);
         result = mRealDevice->CheckFeatureSupport(Feature, pFeatureSupportData, FeatureSupportDataSize);
         interceptor->PostCall(this, FuncId_ID3D12Device_CheckFeatureSupport, argumentsBuffer, result);
@@ -5492,9 +5913,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::CreateDescriptorHeap(const D3D12_DES
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, %s, 0x%p", pDescriptorHeapDesc, refiidString.asCharArray(), ppvHeap);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, %s, 0x%p", pDescriptorHeapDesc, refiidString.asCharArray(), ppvHeap);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12Device_CreateDescriptorHeap);
         result = mRealDevice->CreateDescriptorHeap(pDescriptorHeapDesc, riid, ppvHeap);
         interceptor->PostCall(this, FuncId_ID3D12Device_CreateDescriptorHeap, argumentsBuffer, result);
@@ -5525,8 +5952,13 @@ UINT STDMETHODCALLTYPE GPS_ID3D12Device::GetDescriptorHandleIncrementSize(D3D12_
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s", DX12CoreSerializers::WriteDescriptorHeapTypeEnumAsString(DescriptorHeapType));
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s", DX12CoreSerializers::WriteDescriptorHeapTypeEnumAsString(DescriptorHeapType));
         interceptor->PreCall(this, FuncId_ID3D12Device_GetDescriptorHandleIncrementSize);
         result = mRealDevice->GetDescriptorHandleIncrementSize(DescriptorHeapType);
         interceptor->PostCall(this, FuncId_ID3D12Device_GetDescriptorHandleIncrementSize, argumentsBuffer, result);
@@ -5548,9 +5980,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::CreateRootSignature(UINT nodeMask, c
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, 0x%p, %Iu, %s, 0x%p", nodeMask, pBlobWithRootSignature, blobLengthInBytes, refiidString.asCharArray(), ppvRootSignature);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, 0x%p, %Iu, %s, 0x%p", nodeMask, pBlobWithRootSignature, blobLengthInBytes, refiidString.asCharArray(), ppvRootSignature);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12Device_CreateRootSignature);
         result = mRealDevice->CreateRootSignature(nodeMask, pBlobWithRootSignature, blobLengthInBytes, riid, ppvRootSignature);
         interceptor->PostCall(this, FuncId_ID3D12Device_CreateRootSignature, argumentsBuffer, result);
@@ -5578,12 +6016,10 @@ void STDMETHODCALLTYPE GPS_ID3D12Device::CreateConstantBufferView(const D3D12_CO
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, 0x%p", pDesc, (void*)DestDescriptor.ptr);
+        PackedAPIArguments packedArguments("0x%p, 0x%p", pDesc, (void*)DestDescriptor.ptr);
         interceptor->PreCall(this, FuncId_ID3D12Device_CreateConstantBufferView);
         mRealDevice->CreateConstantBufferView(pDesc, DestDescriptor);
-        interceptor->PostCall(this, FuncId_ID3D12Device_CreateConstantBufferView, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12Device_CreateConstantBufferView, packedArguments);
     }
     else
     {
@@ -5600,12 +6036,10 @@ void STDMETHODCALLTYPE GPS_ID3D12Device::CreateShaderResourceView(ID3D12Resource
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, 0x%p, 0x%p", pResource, pDesc, (void*)DestDescriptor.ptr);
+        PackedAPIArguments packedArguments("+0x%p, 0x%p, 0x%p", pResource, pDesc, (void*)DestDescriptor.ptr);
         interceptor->PreCall(this, FuncId_ID3D12Device_CreateShaderResourceView);
         mRealDevice->CreateShaderResourceView(pResourceUnwrapped, pDesc, DestDescriptor);
-        interceptor->PostCall(this, FuncId_ID3D12Device_CreateShaderResourceView, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12Device_CreateShaderResourceView, packedArguments);
     }
     else
     {
@@ -5624,12 +6058,10 @@ void STDMETHODCALLTYPE GPS_ID3D12Device::CreateUnorderedAccessView(ID3D12Resourc
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, +0x%p, 0x%p, 0x%p", pResource, pCounterResource, pDesc, (void*)DestDescriptor.ptr);
+        PackedAPIArguments packedArguments("+0x%p, +0x%p, 0x%p, 0x%p", pResource, pCounterResource, pDesc, (void*)DestDescriptor.ptr);
         interceptor->PreCall(this, FuncId_ID3D12Device_CreateUnorderedAccessView);
         mRealDevice->CreateUnorderedAccessView(pResourceUnwrapped, pCounterResourceUnwrapped, pDesc, DestDescriptor);
-        interceptor->PostCall(this, FuncId_ID3D12Device_CreateUnorderedAccessView, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12Device_CreateUnorderedAccessView, packedArguments);
     }
     else
     {
@@ -5646,12 +6078,10 @@ void STDMETHODCALLTYPE GPS_ID3D12Device::CreateRenderTargetView(ID3D12Resource*
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, 0x%p, 0x%p", pResource, pDesc, (void*)DestDescriptor.ptr);
+        PackedAPIArguments packedArguments("+0x%p, 0x%p, 0x%p", pResource, pDesc, (void*)DestDescriptor.ptr);
         interceptor->PreCall(this, FuncId_ID3D12Device_CreateRenderTargetView);
         mRealDevice->CreateRenderTargetView(pResourceUnwrapped, pDesc, DestDescriptor);
-        interceptor->PostCall(this, FuncId_ID3D12Device_CreateRenderTargetView, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12Device_CreateRenderTargetView, packedArguments);
     }
     else
     {
@@ -5668,12 +6098,10 @@ void STDMETHODCALLTYPE GPS_ID3D12Device::CreateDepthStencilView(ID3D12Resource*
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, 0x%p, 0x%p", pResource, pDesc, (void*)DestDescriptor.ptr);
+        PackedAPIArguments packedArguments("+0x%p, 0x%p, 0x%p", pResource, pDesc, (void*)DestDescriptor.ptr);
         interceptor->PreCall(this, FuncId_ID3D12Device_CreateDepthStencilView);
         mRealDevice->CreateDepthStencilView(pResourceUnwrapped, pDesc, DestDescriptor);
-        interceptor->PostCall(this, FuncId_ID3D12Device_CreateDepthStencilView, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12Device_CreateDepthStencilView, packedArguments);
     }
     else
     {
@@ -5687,12 +6115,10 @@ void STDMETHODCALLTYPE GPS_ID3D12Device::CreateSampler(const D3D12_SAMPLER_DESC*
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, 0x%p", pDesc, (void*)DestDescriptor.ptr);
+        PackedAPIArguments packedArguments("0x%p, 0x%p", pDesc, (void*)DestDescriptor.ptr);
         interceptor->PreCall(this, FuncId_ID3D12Device_CreateSampler);
         mRealDevice->CreateSampler(pDesc, DestDescriptor);
-        interceptor->PostCall(this, FuncId_ID3D12Device_CreateSampler, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12Device_CreateSampler, packedArguments);
     }
     else
     {
@@ -5707,34 +6133,38 @@ void STDMETHODCALLTYPE GPS_ID3D12Device::CopyDescriptors(UINT NumDestDescriptorR
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
 
-        // Build a string with the array of destination ranges if there are any.
-        gtASCIIString destRangesString;
-
-        if (NumDestDescriptorRanges > 0)
+        if (interceptor->ShouldFormatArguments())
         {
-            destRangesString.appendFormattedString(PrintArrayWithFormatter(NumDestDescriptorRanges, pDestDescriptorRangeStarts, "0x%p").c_str(), ", %s");
-        }
+            // Build a string with the array of destination ranges if there are any.
+            gtASCIIString destRangesString;
 
-        if (pDestDescriptorRangeSizes != NULL)
-        {
-            destRangesString.appendFormattedString(PrintArrayWithFormatter(NumDestDescriptorRanges, pDestDescriptorRangeSizes, "%u").c_str(), ", %s");
-        }
+            if (NumDestDescriptorRanges > 0)
+            {
+                destRangesString.appendFormattedString(PrintArrayWithFormatter(NumDestDescriptorRanges, pDestDescriptorRangeStarts, "0x%p").c_str(), ", %s");
+            }
 
-        // Build a string with the array of source ranges if there are any.
-        gtASCIIString srcRangesString;
+            if (pDestDescriptorRangeSizes != NULL)
+            {
+                destRangesString.appendFormattedString(PrintArrayWithFormatter(NumDestDescriptorRanges, pDestDescriptorRangeSizes, "%u").c_str(), ", %s");
+            }
 
-        if (NumSrcDescriptorRanges > 0)
-        {
-            srcRangesString.appendFormattedString(PrintArrayWithFormatter(NumSrcDescriptorRanges, pSrcDescriptorRangeStarts, "0x%p").c_str(), ", %s");
-        }
+            // Build a string with the array of source ranges if there are any.
+            gtASCIIString srcRangesString;
 
-        if (pSrcDescriptorRangeSizes != NULL)
-        {
-            srcRangesString.appendFormattedString(PrintArrayWithFormatter(NumSrcDescriptorRanges, pSrcDescriptorRangeSizes, "%u").c_str(), ", %s");
-        }
+            if (NumSrcDescriptorRanges > 0)
+            {
+                srcRangesString.appendFormattedString(PrintArrayWithFormatter(NumSrcDescriptorRanges, pSrcDescriptorRangeStarts, "0x%p").c_str(), ", %s");
+            }
+
+            if (pSrcDescriptorRangeSizes != NULL)
+            {
+                srcRangesString.appendFormattedString(PrintArrayWithFormatter(NumSrcDescriptorRanges, pSrcDescriptorRangeSizes, "%u").c_str(), ", %s");
+            }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %s, %u, %s, %s", NumDestDescriptorRanges, destRangesString.asCharArray(), NumSrcDescriptorRanges, srcRangesString.asCharArray(), DX12CoreSerializers::WriteDescriptorHeapTypeEnumAsString(DescriptorHeapsType));
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %s, %u, %s, %s", NumDestDescriptorRanges, destRangesString.asCharArray(), NumSrcDescriptorRanges, srcRangesString.asCharArray(), DX12CoreSerializers::WriteDescriptorHeapTypeEnumAsString(DescriptorHeapsType));
+        }
 
         interceptor->PreCall(this, FuncId_ID3D12Device_CopyDescriptors);
         mRealDevice->CopyDescriptors(NumDestDescriptorRanges, pDestDescriptorRangeStarts, pDestDescriptorRangeSizes, NumSrcDescriptorRanges, pSrcDescriptorRangeStarts, pSrcDescriptorRangeSizes, DescriptorHeapsType);
@@ -5753,8 +6183,13 @@ void STDMETHODCALLTYPE GPS_ID3D12Device::CopyDescriptorsSimple(UINT NumDescripto
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, 0x%p, 0x%p, %s", NumDescriptors, (void*)DestDescriptorRangeStart.ptr, (void*)SrcDescriptorRangeStart.ptr, DX12CoreSerializers::WriteDescriptorHeapTypeEnumAsString(DescriptorHeapsType));
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, 0x%p, 0x%p, %s", NumDescriptors, (void*)DestDescriptorRangeStart.ptr, (void*)SrcDescriptorRangeStart.ptr, DX12CoreSerializers::WriteDescriptorHeapTypeEnumAsString(DescriptorHeapsType));
         interceptor->PreCall(this, FuncId_ID3D12Device_CopyDescriptorsSimple);
         mRealDevice->CopyDescriptorsSimple(NumDescriptors, DestDescriptorRangeStart, SrcDescriptorRangeStart, DescriptorHeapsType);
         interceptor->PostCall(this, FuncId_ID3D12Device_CopyDescriptorsSimple, argumentsBuffer);
@@ -5773,12 +6208,10 @@ D3D12_RESOURCE_ALLOCATION_INFO STDMETHODCALLTYPE GPS_ID3D12Device::GetResourceAl
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %u, 0x%p", visibleMask, numResourceDescs, pResourceDescs);
+        PackedAPIArguments packedArguments("%u, %u, 0x%p", visibleMask, numResourceDescs, pResourceDescs);
         interceptor->PreCall(this, FuncId_ID3D12Device_GetResourceAllocationInfo);
         result = mRealDevice->GetResourceAllocationInfo(visibleMask, numResourceDescs, pResourceDescs);
-        interceptor->PostCall(this, FuncId_ID3D12Device_GetResourceAllocationInfo, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12Device_GetResourceAllocationInfo, packedArguments);
     }
     else
     {
@@ -5797,8 +6230,13 @@ D3D12_HEAP_PROPERTIES STDMETHODCALLTYPE GPS_ID3D12Device::GetCustomHeapPropertie
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %s", nodeMask, DX12CoreSerializers::WriteHeapTypeEnumAsString(heapType));
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %s", nodeMask, DX12CoreSerializers::WriteHeapTypeEnumAsString(heapType));
         interceptor->PreCall(this, FuncId_ID3D12Device_GetCustomHeapProperties);
         result = mRealDevice->GetCustomHeapProperties(nodeMask, heapType);
         interceptor->PostCall(this, FuncId_ID3D12Device_GetCustomHeapProperties, argumentsBuffer);
@@ -5820,9 +6258,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::CreateCommittedResource(const D3D12_
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString riidResourceString;
-        DX12Util::PrintREFIID(riidResource, riidResourceString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, %u, 0x%p, %s, 0x%p, %s, 0x%p", pHeapProperties, HeapFlags, pResourceDesc, DX12CoreSerializers::WriteResourceStatesEnumAsString(InitialResourceState), pOptimizedClearValue, riidResourceString.asCharArray(), ppvResource);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString riidResourceString;
+            DX12Util::PrintREFIID(riidResource, riidResourceString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, %u, 0x%p, %s, 0x%p, %s, 0x%p", pHeapProperties, HeapFlags, pResourceDesc, DX12CoreSerializers::WriteResourceStatesEnumAsString(InitialResourceState), pOptimizedClearValue, riidResourceString.asCharArray(), ppvResource);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12Device_CreateCommittedResource);
         result = mRealDevice->CreateCommittedResource(pHeapProperties, HeapFlags, pResourceDesc, InitialResourceState, pOptimizedClearValue, riidResource, ppvResource);
         interceptor->PostCall(this, FuncId_ID3D12Device_CreateCommittedResource, argumentsBuffer, result);
@@ -5853,9 +6297,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::CreateHeap(const D3D12_HEAP_DESC* pD
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, %s, 0x%p", pDesc, refiidString.asCharArray(), ppvHeap);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, %s, 0x%p", pDesc, refiidString.asCharArray(), ppvHeap);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12Device_CreateHeap);
         result = mRealDevice->CreateHeap(pDesc, riid, ppvHeap);
         interceptor->PostCall(this, FuncId_ID3D12Device_CreateHeap, argumentsBuffer, result);
@@ -5888,9 +6338,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::CreatePlacedResource(ID3D12Heap* pHe
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, %llu, 0x%p, %s, 0x%p, %s, 0x%p", pHeap, HeapOffset, pDesc, DX12CoreSerializers::WriteResourceStatesEnumAsString(InitialState), pOptimizedClearValue, refiidString.asCharArray(), ppvResource);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, %llu, 0x%p, %s, 0x%p, %s, 0x%p", pHeap, HeapOffset, pDesc, DX12CoreSerializers::WriteResourceStatesEnumAsString(InitialState), pOptimizedClearValue, refiidString.asCharArray(), ppvResource);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12Device_CreatePlacedResource);
         result = mRealDevice->CreatePlacedResource(pHeapUnwrapped, HeapOffset, pDesc, InitialState, pOptimizedClearValue, riid, ppvResource);
         interceptor->PostCall(this, FuncId_ID3D12Device_CreatePlacedResource, argumentsBuffer, result);
@@ -5921,9 +6377,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::CreateReservedResource(const D3D12_R
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, %s, 0x%p, %s, 0x%p", pDesc, DX12CoreSerializers::WriteResourceStatesEnumAsString(InitialState), pOptimizedClearValue, refiidString.asCharArray(), ppvResource);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, %s, 0x%p, %s, 0x%p", pDesc, DX12CoreSerializers::WriteResourceStatesEnumAsString(InitialState), pOptimizedClearValue, refiidString.asCharArray(), ppvResource);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12Device_CreateReservedResource);
         result = mRealDevice->CreateReservedResource(pDesc, InitialState, pOptimizedClearValue, riid, ppvResource);
         interceptor->PostCall(this, FuncId_ID3D12Device_CreateReservedResource, argumentsBuffer, result);
@@ -5956,8 +6418,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::CreateSharedHandle(ID3D12DeviceChild
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, 0x%p, %u, %ls, 0x%p", pObject, pAttributes, Access, Name, pHandle);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, 0x%p, %u, %ls, 0x%p", pObject, pAttributes, Access, Name, pHandle);
         interceptor->PreCall(this, FuncId_ID3D12Device_CreateSharedHandle);
         result = mRealDevice->CreateSharedHandle(pObjectUnwrapped, pAttributes, Access, Name, pHandle);
         interceptor->PostCall(this, FuncId_ID3D12Device_CreateSharedHandle, argumentsBuffer, result);
@@ -5979,9 +6446,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::OpenSharedHandle(HANDLE NTHandle, RE
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, %s, 0x%p", NTHandle, refiidString.asCharArray(), ppvObj);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, %s, 0x%p", NTHandle, refiidString.asCharArray(), ppvObj);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12Device_OpenSharedHandle);
         result = mRealDevice->OpenSharedHandle(NTHandle, riid, ppvObj);
         interceptor->PostCall(this, FuncId_ID3D12Device_OpenSharedHandle, argumentsBuffer, result);
@@ -6003,8 +6476,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::OpenSharedHandleByName(LPCWSTR Name,
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls, %u, 0x%p", Name, Access, pNTHandle);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%ls, %u, 0x%p", Name, Access, pNTHandle);
         interceptor->PreCall(this, FuncId_ID3D12Device_OpenSharedHandleByName);
         result = mRealDevice->OpenSharedHandleByName(Name, Access, pNTHandle);
         interceptor->PostCall(this, FuncId_ID3D12Device_OpenSharedHandleByName, argumentsBuffer, result);
@@ -6038,8 +6516,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::MakeResident(UINT NumObjects, ID3D12
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %s", NumObjects, PrintArrayWithFormatter(NumObjects, ppObjects, "0x%p").c_str());
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %s", NumObjects, PrintArrayWithFormatter(NumObjects, ppObjects, "0x%p").c_str());
         interceptor->PreCall(this, FuncId_ID3D12Device_MakeResident);
         result = mRealDevice->MakeResident(NumObjects, ppObjectsUnwrapped);
         interceptor->PostCall(this, FuncId_ID3D12Device_MakeResident, argumentsBuffer, result);
@@ -6075,8 +6558,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::Evict(UINT NumObjects, ID3D12Pageabl
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %s", NumObjects, PrintArrayWithFormatter(NumObjects, ppObjects, "0x%p").c_str());
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%u, %s", NumObjects, PrintArrayWithFormatter(NumObjects, ppObjects, "0x%p").c_str());
         interceptor->PreCall(this, FuncId_ID3D12Device_Evict);
         result = mRealDevice->Evict(NumObjects, ppObjectsUnwrapped);
         interceptor->PostCall(this, FuncId_ID3D12Device_Evict, argumentsBuffer, result);
@@ -6100,9 +6588,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::CreateFence(UINT64 InitialValue, D3D
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%llu, %u, %s, 0x%p", InitialValue, Flags, refiidString.asCharArray(), ppFence);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%llu, %u, %s, 0x%p", InitialValue, Flags, refiidString.asCharArray(), ppFence);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12Device_CreateFence);
         result = mRealDevice->CreateFence(InitialValue, Flags, riid, ppFence);
         interceptor->PostCall(this, FuncId_ID3D12Device_CreateFence, argumentsBuffer, result);
@@ -6132,12 +6626,10 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::GetDeviceRemovedReason()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_ID3D12Device_GetDeviceRemovedReason);
         result = mRealDevice->GetDeviceRemovedReason();
-        interceptor->PostCall(this, FuncId_ID3D12Device_GetDeviceRemovedReason, argumentsBuffer, result);
+        interceptor->PostCall(this, FuncId_ID3D12Device_GetDeviceRemovedReason, packedArguments, result);
     }
     else
     {
@@ -6154,11 +6646,17 @@ void STDMETHODCALLTYPE GPS_ID3D12Device::GetCopyableFootprints(const D3D12_RESOU
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        UINT numRows = pNumRows != NULL ? *pNumRows : 0;
-        UINT64 rowSizeInBytes = pRowSizeInBytes != NULL ? *pRowSizeInBytes : 0;
-        UINT64 totalBytes = pTotalBytes != NULL ? *pTotalBytes : 0;
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            UINT numRows = pNumRows != NULL ? *pNumRows : 0;
+            UINT64 rowSizeInBytes = pRowSizeInBytes != NULL ? *pRowSizeInBytes : 0;
+            UINT64 totalBytes = pTotalBytes != NULL ? *pTotalBytes : 0;
+
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, %u, %u, %llu, 0x%p, %u, %llu, %llu", pResourceDesc, FirstSubresource, NumSubresources, BaseOffset, pLayouts, numRows, rowSizeInBytes, totalBytes);
+        }
 
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, %u, %u, %llu, 0x%p, %u, %llu, %llu", pResourceDesc, FirstSubresource, NumSubresources, BaseOffset, pLayouts, numRows, rowSizeInBytes, totalBytes);
         interceptor->PreCall(this, FuncId_ID3D12Device_GetCopyableFootprints);
         mRealDevice->GetCopyableFootprints(pResourceDesc, FirstSubresource, NumSubresources, BaseOffset, pLayouts, pNumRows, pRowSizeInBytes, pTotalBytes);
         interceptor->PostCall(this, FuncId_ID3D12Device_GetCopyableFootprints, argumentsBuffer);
@@ -6178,9 +6676,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::CreateQueryHeap(const D3D12_QUERY_HE
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, %s, 0x%p", pDesc, refiidString.asCharArray(), ppvHeap);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, %s, 0x%p", pDesc, refiidString.asCharArray(), ppvHeap);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12Device_CreateQueryHeap);
         result = mRealDevice->CreateQueryHeap(pDesc, riid, ppvHeap);
         interceptor->PostCall(this, FuncId_ID3D12Device_CreateQueryHeap, argumentsBuffer, result);
@@ -6211,7 +6715,13 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::SetStablePowerState(BOOL Enable)
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s", Enable?"TRUE":"FALSE");
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "%s", Enable?"TRUE":"FALSE");
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12Device_SetStablePowerState);
         result = mRealDevice->SetStablePowerState(Enable);
         interceptor->PostCall(this, FuncId_ID3D12Device_SetStablePowerState, argumentsBuffer, result);
@@ -6235,9 +6745,15 @@ HRESULT STDMETHODCALLTYPE GPS_ID3D12Device::CreateCommandSignature(const D3D12_C
     if (interceptor->ShouldCollectTrace())
     {
         char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-        gtASCIIString refiidString;
-        DX12Util::PrintREFIID(riid, refiidString);
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, +0x%p, %s, 0x%p", pDesc, pRootSignature, refiidString.asCharArray(), ppvCommandSignature);
+        argumentsBuffer[0] = '\0';
+
+        if (interceptor->ShouldFormatArguments())
+        {
+            gtASCIIString refiidString;
+            DX12Util::PrintREFIID(riid, refiidString);
+            sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "0x%p, +0x%p, %s, 0x%p", pDesc, pRootSignature, refiidString.asCharArray(), ppvCommandSignature);
+        }
+
         interceptor->PreCall(this, FuncId_ID3D12Device_CreateCommandSignature);
         result = mRealDevice->CreateCommandSignature(pDesc, pRootSignatureUnwrapped, riid, ppvCommandSignature);
         interceptor->PostCall(this, FuncId_ID3D12Device_CreateCommandSignature, argumentsBuffer, result);
@@ -6268,12 +6784,10 @@ void STDMETHODCALLTYPE GPS_ID3D12Device::GetResourceTiling(ID3D12Resource* pTile
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "+0x%p, %u, 0x%p, 0x%p, %u, %u, 0x%p", pTiledResource, *pNumTilesForEntireResource, pPackedMipDesc, pStandardTileShapeForNonPackedMips, *pNumSubresourceTilings, FirstSubresourceTilingToGet, pSubresourceTilingsForNonPackedMips);
+        PackedAPIArguments packedArguments("+0x%p, %u, 0x%p, 0x%p, %u, %u, 0x%p", pTiledResource, *pNumTilesForEntireResource, pPackedMipDesc, pStandardTileShapeForNonPackedMips, *pNumSubresourceTilings, FirstSubresourceTilingToGet, pSubresourceTilingsForNonPackedMips);
         interceptor->PreCall(this, FuncId_ID3D12Device_GetResourceTiling);
         mRealDevice->GetResourceTiling(pTiledResourceUnwrapped, pNumTilesForEntireResource, pPackedMipDesc, pStandardTileShapeForNonPackedMips, pNumSubresourceTilings, FirstSubresourceTilingToGet, pSubresourceTilingsForNonPackedMips);
-        interceptor->PostCall(this, FuncId_ID3D12Device_GetResourceTiling, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12Device_GetResourceTiling, packedArguments);
     }
     else
     {
@@ -6289,12 +6803,10 @@ LUID STDMETHODCALLTYPE GPS_ID3D12Device::GetAdapterLuid()
 
     if (interceptor->ShouldCollectTrace())
     {
-        char argumentsBuffer[ARGUMENTS_BUFFER_SIZE];
-
-        sprintf_s(argumentsBuffer, ARGUMENTS_BUFFER_SIZE, "");
+        PackedAPIArguments packedArguments("");
         interceptor->PreCall(this, FuncId_ID3D12Device_GetAdapterLuid);
         result = mRealDevice->GetAdapterLuid();
-        interceptor->PostCall(this, FuncId_ID3D12Device_GetAdapterLuid, argumentsBuffer);
+        interceptor->PostCall(this, FuncId_ID3D12Device_GetAdapterLuid, packedArguments);
     }
     else
     {
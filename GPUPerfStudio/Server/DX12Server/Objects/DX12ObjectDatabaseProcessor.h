@@ -40,8 +40,8 @@ bool GenericWrapObject(GPS_ID3D12Device* inParentDevice, T** ppReal, eObjectType
 
     // Create a new "Wrapper metadata object" to store all information about the wrapper.
     IDX12InstanceBase* objectData = new IDX12InstanceBase(static_cast<IUnknown*>(*ppReal), static_cast<IUnknown*>(pWrapper), inObjectType, inCreateInfo);
-    objectDatabase->Add(objectData);
     objectData->SetParentDeviceHandle(inParentDevice);
+    objectDatabase->Add(objectData);
 
     // Reassign the outgoing pointer to our wrapped instance instead of the runtime instance. This allows us to hook all interface calls.
     *ppReal = pWrapper;
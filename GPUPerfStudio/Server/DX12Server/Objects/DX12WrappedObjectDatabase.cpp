@@ -33,25 +33,8 @@ DX12WrappedObjectDatabase::~DX12WrappedObjectDatabase()
 //--------------------------------------------------------------------------
 void DX12WrappedObjectDatabase::GetObjectsByType(eObjectType inObjectType, WrappedInstanceVector& outObjectInstancesOfGivenType, bool inbOnlyCurrentObjects) const
 {
-    // Loop through everything in the object database and look for specific types of objects.
-    DXInterfaceToWrapperMetadata::const_iterator wrapperIter;
-    DXInterfaceToWrapperMetadata::const_iterator endIter = mWrapperInstanceToWrapperMetadata.end();
-
-    for (wrapperIter = mWrapperInstanceToWrapperMetadata.begin(); wrapperIter != endIter; ++wrapperIter)
-    {
-        IDX12InstanceBase* wrapperMetadata = wrapperIter->second;
-
-        if (wrapperMetadata->GetObjectType() == inObjectType)
-        {
-            // If we only care about currently-active objects, don't include it if it has already been destroyed.
-            if (inbOnlyCurrentObjects && wrapperMetadata->IsDestroyed())
-            {
-                continue;
-            }
-
-            outObjectInstancesOfGivenType.push_back(wrapperMetadata);
-        }
-    }
+    // The object tree index already keeps each type's instances together, so there's no need to scan the whole database.
+    mObjectTreeIndex.GetInstancesOfType(inObjectType, outObjectInstancesOfGivenType, inbOnlyCurrentObjects);
 }
 
 //--------------------------------------------------------------------------
@@ -64,26 +47,15 @@ IInstanceBase* DX12WrappedObjectDatabase::GetWrappedInstance(void* inInstanceHan
     // Look in the wrapped object database for the incoming pointer.
     IUnknown* wrappedInstance = (IUnknown*)inInstanceHandle;
 
-    DXInterfaceToWrapperMetadata::const_iterator interfaceIter = mRealInstanceToWrapperMetadata.find(wrappedInstance);
-    DXInterfaceToWrapperMetadata::const_iterator endIter = mRealInstanceToWrapperMetadata.end();
+    IDX12InstanceBase* wrapperMetadata = mRealInstanceToWrapperMetadata.Find(wrappedInstance);
 
-    if (interfaceIter != endIter)
-    {
-        return interfaceIter->second;
-    }
-    else
+    if (wrapperMetadata == NULL)
     {
         // Is the incoming pointer already a wrapped pointer? If so, just return the metadata object.
-        DXInterfaceToWrapperMetadata::const_iterator wrapperInterfaceIter = mWrapperInstanceToWrapperMetadata.find(wrappedInstance);
-        DXInterfaceToWrapperMetadata::const_iterator wrappersEnditer = mWrapperInstanceToWrapperMetadata.end();
-
-        if (wrapperInterfaceIter != wrappersEnditer)
-        {
-            return wrapperInterfaceIter->second;
-        }
+        wrapperMetadata = mWrapperInstanceToWrapperMetadata.Find(wrappedInstance);
     }
 
-    return NULL;
+    return wrapperMetadata;
 }
 
 //--------------------------------------------------------------------------
@@ -108,12 +80,11 @@ bool DX12WrappedObjectDatabase::AttemptUnwrap(IUnknown** ioPossiblyWrapperInstan
     IUnknown* possibleReal = *ioPossiblyWrapperInstance;
 
     // Is the incoming pointer a wrapped DX12 interface? Check the wrapper map to find out.
-    DXInterfaceToWrapperMetadata::const_iterator wrapperIter = mWrapperInstanceToWrapperMetadata.find(possibleReal);
+    IDX12InstanceBase* wrapperMetadata = mWrapperInstanceToWrapperMetadata.Find(possibleReal);
 
-    if (wrapperIter != mWrapperInstanceToWrapperMetadata.end())
+    if (wrapperMetadata != NULL)
     {
         // The incoming pointer was a GPS_ID3D12 wrapped interface. Unwrap it here and send it back out.
-        IDX12InstanceBase* wrapperMetadata = wrapperIter->second;
         *ioPossiblyWrapperInstance = static_cast<IUnknown*>(wrapperMetadata->GetRuntimeInstance());
         bUnwrappedInstance = true;
     }
@@ -131,12 +102,16 @@ bool DX12WrappedObjectDatabase::AttemptUnwrap(IUnknown** ioPossiblyWrapperInstan
 //--------------------------------------------------------------------------
 void DX12WrappedObjectDatabase::Add(IDX12InstanceBase* inWrapperMetadata)
 {
-    ScopeLock mutex(&mCurrentObjectsMapLock);
     IUnknown* wrapperHandle = static_cast<IUnknown*>(inWrapperMetadata->GetApplicationHandle());
     IUnknown* runtimeInstance = inWrapperMetadata->GetRuntimeInstance();
 
-    mWrapperInstanceToWrapperMetadata[wrapperHandle] = inWrapperMetadata;
-    mRealInstanceToWrapperMetadata[runtimeInstance] = inWrapperMetadata;
+    // Each map locks only the shard being inserted into. Add the wrapper first, so that
+    // anything found through the real instance can always be found through its wrapper.
+    mWrapperInstanceToWrapperMetadata.Insert(wrapperHandle, inWrapperMetadata);
+    mRealInstanceToWrapperMetadata.Insert(runtimeInstance, inWrapperMetadata);
+
+    // The parent device must already be set, since the index groups instances by device.
+    mObjectTreeIndex.Add(inWrapperMetadata);
 }
 
 //--------------------------------------------------------------------------
@@ -146,16 +121,7 @@ void DX12WrappedObjectDatabase::Add(IDX12InstanceBase* inWrapperMetadata)
 //--------------------------------------------------------------------------
 IDX12InstanceBase* DX12WrappedObjectDatabase::GetMetadataObject(IUnknown* inWrapperInstance)
 {
-    IDX12InstanceBase* resultInstance = NULL;
-
-    DXInterfaceToWrapperMetadata::const_iterator objectIter = mWrapperInstanceToWrapperMetadata.find(inWrapperInstance);
-
-    if (objectIter != mWrapperInstanceToWrapperMetadata.end())
-    {
-        resultInstance = objectIter->second;
-    }
-
-    return resultInstance;
+    return mWrapperInstanceToWrapperMetadata.Find(inWrapperInstance);
 }
 
 //--------------------------------------------------------------------------
@@ -166,21 +132,18 @@ IDX12InstanceBase* DX12WrappedObjectDatabase::GetMetadataObject(IUnknown* inWrap
 //--------------------------------------------------------------------------
 bool DX12WrappedObjectDatabase::WrappedObject(IUnknown** ioInstance) const
 {
-    ScopeLock dbLock(&mCurrentObjectsMapLock);
-
     IUnknown* pReal = *ioInstance;
 
-    // Check if object has been wrapped
-    DXInterfaceToWrapperMetadata::const_iterator objectIter = mRealInstanceToWrapperMetadata.find(pReal);
+    // Check if object has been wrapped. This doesn't need a lock, since it happens on every wrap check.
+    IDX12InstanceBase* wrapperMetaData = mRealInstanceToWrapperMetadata.Find(pReal);
 
-    if (objectIter == mRealInstanceToWrapperMetadata.end())
+    if (wrapperMetaData == NULL)
     {
         return false;
     }
     else
     {
         // The object already has a wrapper instance in the database. Return the GPS_ID3D12[Something] wrapper instance.
-        IDX12InstanceBase* wrapperMetaData = static_cast<IDX12InstanceBase*>(objectIter->second);
         *ioInstance = (IUnknown*)wrapperMetaData->GetApplicationHandle();
         return true;
     }
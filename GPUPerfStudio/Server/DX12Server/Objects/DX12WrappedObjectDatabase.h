@@ -9,8 +9,8 @@
 #ifndef DX12WRAPPEDOBJECTDATABASE_H
 #define DX12WRAPPEDOBJECTDATABASE_H
 
-#include <map>
 #include "../../Common/WrappedObjectDatabase.h"
+#include "../../Common/ShardedPointerMap.h"
 
 class IInstanceBase;
 class IDX12InstanceBase;
@@ -82,18 +82,19 @@ public:
 private:
     //--------------------------------------------------------------------------
     /// A map used to associate an application's D3D12 interface with a
-    /// IDXInstanceBase metadata object.
+    /// IDXInstanceBase metadata object. Lookups don't lock, since they happen for
+    /// every traced call.
     //--------------------------------------------------------------------------
-    typedef std::map<IUnknown*, IDX12InstanceBase*> DXInterfaceToWrapperMetadata;
+    typedef ShardedPointerMap<IUnknown*, IDX12InstanceBase*> DXInterfaceToWrapperMetadata;
 
     //--------------------------------------------------------------------------
-    /// Maintain an std::map object database. The keys are DX12 interface pointers,
+    /// Maintain an object database. The keys are DX12 interface pointers,
     /// with values set to their corresponding wrapper instance.
     //--------------------------------------------------------------------------
     DXInterfaceToWrapperMetadata mRealInstanceToWrapperMetadata;
 
     //--------------------------------------------------------------------------
-    /// Maintain an std::map wrapper database. The keys are wrapper class instances,
+    /// Maintain a wrapper database. The keys are wrapper class instances,
     /// and the values are their corresponding DX12 wrapped interfaces.
     //--------------------------------------------------------------------------
     DXInterfaceToWrapperMetadata mWrapperInstanceToWrapperMetadata;
@@ -48,9 +48,7 @@ DX12CmdListProfiler* DX12CmdListProfiler::Create(
 */
 DX12CmdListProfiler::DX12CmdListProfiler(ID3D12Device* pDevice)
     :
-    m_pDevice(pDevice),
-    m_nextFenceValue(1),
-    m_lastCompletedFenceValue(0)
+    m_pDevice(pDevice)
 {
 }
 
@@ -75,24 +73,12 @@ HRESULT DX12CmdListProfiler::Init(
     {
         if (pConfig->measurementsPerGroup > 0)
         {
-            result = m_pDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_pFence));
+            // Fences are created for each queue, when it first submits a measured command list
+            result = pDevice->SetStablePowerState(true);
 
             if (result == S_OK)
             {
-                m_pFence->SetName(L"DX12CmdListProfiler::m_pFence");
-                m_pFence->Signal(0);
-
-                m_fenceEvent = CreateEvent(nullptr, false, false, nullptr);
-
-                if (m_fenceEvent != INVALID_HANDLE_VALUE)
-                {
-                    result = pDevice->SetStablePowerState(true);
-
-                    if (result == S_OK)
-                    {
-                        memcpy(&m_config, pConfig, sizeof(DX12CmdListProfilerConfig));
-                    }
-                }
+                memcpy(&m_config, pConfig, sizeof(DX12CmdListProfilerConfig));
             }
         }
     }
@@ -110,22 +96,33 @@ HRESULT DX12CmdListProfiler::Init(
 */
 DX12CmdListProfiler::~DX12CmdListProfiler()
 {
-    DX12ProfilerCriticalSection lock(m_cs);
+    DX12ProfilerScopedLock lock(m_cs);
 
-    for (CmdListDataMap::iterator iterator = m_cmdListMap.begin();
-         iterator != m_cmdListMap.end();
-         iterator++)
+    m_cmdListMap.ForEach([this](ProfilerCmdListData& cmdListData)
     {
         HRESULT result = E_FAIL;
 
-        result = ReleaseProfilerData(iterator->second);
+        result = ReleaseProfilerData(cmdListData);
 
         PROFILER_ASSERT(result == S_OK);
-    }
+        UNREFERENCED_PARAMETER(result);
+    });
 
-    CloseHandle(m_fenceEvent);
+    for (QueueDataMap::iterator iterator = m_queueData.begin();
+         iterator != m_queueData.end();
+         iterator++)
+    {
+        // The GPU may still be writing to retired command lists, so wait for them before releasing
+        iterator->second.pScheduler->Harvest(true, [this](ProfilerPendingCmdList& pending)
+        {
+            HRESULT result = ReleaseProfilerData(pending.cmdListData);
+            PROFILER_ASSERT(result == S_OK);
+            UNREFERENCED_PARAMETER(result);
+        });
 
-    m_pFence->Release();
+        delete iterator->second.pScheduler;
+        delete iterator->second.pQueueFence;
+    }
 }
 
 /**
@@ -140,21 +137,14 @@ ProfilerResultCode DX12CmdListProfiler::BeginCmdMeasurement(
     ID3D12GraphicsCommandList*   pCmdList,  ///< [in] Handle to cmd buf being measured
     const ProfilerMeasurementId* pIdInfo)   ///< [in] Pointer to measurement id data
 {
-    DX12ProfilerCriticalSection lock(m_cs);
-
     PROFILER_ASSERT(pCmdList != nullptr);
     PROFILER_ASSERT(pIdInfo != nullptr);
 
     ProfilerResultCode profilerResultCode = PROFILER_FAIL;
 
-    // If command list has not yet been measured, allocate memory objects for it
-    if (IsCmdListBeingMeasured(pCmdList) == false)
-    {
-        ProfilerCmdListData newCmdListData = {};
-        m_cmdListMap[pCmdList] = newCmdListData;
-    }
-
-    ProfilerCmdListData& cmdListData = m_cmdListMap[pCmdList];
+    // If command list has not yet been measured, allocate memory objects for it.
+    // Only the thread recording this command list uses its data, so no lock is held from here
+    ProfilerCmdListData& cmdListData = m_cmdListMap.FindOrAdd(pCmdList);
 
     PROFILER_ASSERT(cmdListData.state != PROFILER_STATE_STARTED);
 
@@ -213,15 +203,15 @@ ProfilerResultCode DX12CmdListProfiler::BeginCmdMeasurement(
 ProfilerResultCode DX12CmdListProfiler::EndCmdMeasurement(
     ID3D12GraphicsCommandList* pCmdList) ///< [in] Handle to cmd buf being measured
 {
-    DX12ProfilerCriticalSection lock(m_cs);
-
     PROFILER_ASSERT(pCmdList != nullptr);
 
     ProfilerResultCode profilerResultCode = PROFILER_FAIL;
 
-    if (IsCmdListBeingMeasured(pCmdList) == true)
+    ProfilerCmdListData* pCmdListData = m_cmdListMap.Find(pCmdList);
+
+    if (pCmdListData != nullptr)
     {
-        ProfilerCmdListData& cmdListData = m_cmdListMap[pCmdList];
+        ProfilerCmdListData& cmdListData = *pCmdListData;
 
         PROFILER_ASSERT(cmdListData.state == PROFILER_STATE_STARTED);
 
@@ -278,139 +268,243 @@ ProfilerResultCode DX12CmdListProfiler::EndCmdMeasurement(
 
 /**
 ***************************************************************************************************
-*   DX12CmdListProfiler::GetCmdListResults
+*   DX12CmdListProfiler::RetireCmdList
 *
 *   @brief
 *       We assume this will be called immediately after a command list has been submitted.
+*       The queue's fence is signaled, and the command list's queries are held until the GPU
+*       reaches that signal. This never waits on the GPU.
 *
 *   @return
-*       A vector containing performance information for a given function.
+*       PROFILER_SUCCESS if the command list was retired.
 ***************************************************************************************************
 */
-ProfilerResultCode DX12CmdListProfiler::GetCmdListResults(
-    ID3D12GraphicsCommandList*   pCmdList,       ///< [in]  Handle to cmd buf being measured
-    ID3D12CommandQueue*          pCmdQueue,      ///< [in]  Handle to cmd queue
-    std::vector<ProfilerResult>& results)        ///< [out] Vector with profiler results
+ProfilerResultCode DX12CmdListProfiler::RetireCmdList(
+    ID3D12GraphicsCommandList* pCmdList,  ///< [in] Handle to cmd buf being measured
+    ID3D12CommandQueue*        pCmdQueue) ///< [in] Handle to cmd queue it was submitted to
 {
-    DX12ProfilerCriticalSection lock(m_cs);
+    DX12ProfilerScopedLock lock(m_cs);
 
     PROFILER_ASSERT(pCmdList != nullptr);
     PROFILER_ASSERT(pCmdQueue != nullptr);
 
-    // Signal the next fence value (with the GPU)
-    pCmdQueue->Signal(m_pFence, m_nextFenceValue);
+    ProfilerResultCode profilerResultCode = PROFILER_FAIL;
 
-    WaitForFence(m_nextFenceValue++);
+    const bool measured = m_cmdListMap.RemoveIf(pCmdList, [&](ProfilerCmdListData& cmdListData)
+    {
+        ProfilerQueueData* pQueueData = GetQueueData(pCmdQueue);
 
-    ProfilerResultCode profilerResultCode = PROFILER_SUCCESS;
+        if (pQueueData != nullptr)
+        {
+            ProfilerPendingCmdList pending = {};
+            pending.pCmdList = pCmdList;
+            pending.cmdListData = cmdListData;
+            pending.cmdListData.pActiveMeasurementGroup = nullptr;
 
-    HRESULT result = E_FAIL;
+            if (pQueueData->pScheduler->Retire(pending) == true)
+            {
+                profilerResultCode = PROFILER_SUCCESS;
+            }
+        }
+
+        // The app can now reset and record the command list again while its results are pending
+        return (profilerResultCode == PROFILER_SUCCESS);
+    });
 
-    if (IsCmdListBeingMeasured(pCmdList) == true)
+    if (measured == false)
     {
-        ProfilerCmdListData& cmdListData = m_cmdListMap[pCmdList];
+        profilerResultCode = PROFILER_THIS_CMD_LIST_WAS_NOT_MEASURED;
+    }
 
-        const UINT64 queueFrequency = GetQueueFrequency(pCmdQueue);
+    return profilerResultCode;
+}
 
-        // Loop through all measurements for this command list
-        for (UINT i = 0; i < cmdListData.measurementGroups.size(); i++)
-        {
-            ProfilerMeasurementGroup& currGroup = cmdListData.measurementGroups[i];
+/**
+***************************************************************************************************
+*   DX12CmdListProfiler::HarvestResults
+*
+*   @brief
+*       Collect results from every retired command list that the GPU has finished executing.
+*       When waitForGpu is true, this blocks until all retired command lists have finished.
+*
+*   @return
+*       PROFILER_SUCCESS. Results are added to the vector of the queue they were submitted to.
+***************************************************************************************************
+*/
+ProfilerResultCode DX12CmdListProfiler::HarvestResults(
+    bool                  waitForGpu, ///< [in]  Wait for the GPU to finish all retired command lists
+    ProfilerQueueResults& results)    ///< [out] Profiler results for each queue
+{
+    DX12ProfilerScopedLock lock(m_cs);
 
-            ProfilerInterval* pTimestampData = nullptr;
-            D3D12_QUERY_DATA_PIPELINE_STATISTICS* pPipelineStatsData = nullptr;
+    for (QueueDataMap::iterator queueIter = m_queueData.begin();
+         queueIter != m_queueData.end();
+         queueIter++)
+    {
+        ProfilerResultScheduler<ProfilerPendingCmdList>* pScheduler = queueIter->second.pScheduler;
 
-            if (m_config.measurementTypeFlags & PROFILER_MEASUREMENT_TYPE_TIMESTAMPS)
-            {
-                D3D12_RANGE mapRange = {};
-                mapRange.Begin = 0;
-                mapRange.End   = m_config.measurementsPerGroup * sizeof(ProfilerInterval);
-                result = currGroup.pTimestampBuffer->Map(0, &mapRange, reinterpret_cast<void**>(&pTimestampData));
-            }
+        if (pScheduler->GetNumPending() > 0)
+        {
+            ID3D12CommandQueue* pCmdQueue = queueIter->first;
+            const UINT64 queueFrequency = GetQueueFrequency(pCmdQueue);
+            std::vector<ProfilerResult>& queueResults = results[pCmdQueue];
 
-            if (m_config.measurementTypeFlags & PROFILER_MEASUREMENT_TYPE_PIPE_STATS)
+            pScheduler->Harvest(waitForGpu, [&](ProfilerPendingCmdList& pending)
             {
-                D3D12_RANGE mapRange = {};
-                mapRange.Begin = 0;
-                mapRange.End   = m_config.measurementsPerGroup * sizeof(D3D12_QUERY_DATA_PIPELINE_STATISTICS);
-                result = currGroup.pPipeStatsBuffer->Map(0, &mapRange, reinterpret_cast<void**>(&pPipelineStatsData));
-            }
+                ReadCmdListResults(pending.cmdListData, queueFrequency, queueResults);
+
+                // We're done profiling this command list, so free up used resources
+                HRESULT result = ReleaseProfilerData(pending.cmdListData);
+                PROFILER_ASSERT(result == S_OK);
+                UNREFERENCED_PARAMETER(result);
+            });
+        }
+    }
+
+    return PROFILER_SUCCESS;
+}
+
+/**
+***************************************************************************************************
+*   DX12CmdListProfiler::ReadCmdListResults
+*
+*   @brief
+*       Read back the query results of a command list that the GPU has finished executing.
+***************************************************************************************************
+*/
+void DX12CmdListProfiler::ReadCmdListResults(
+    ProfilerCmdListData&         cmdListData,    ///< [in]  The command list's measurement groups
+    UINT64                       queueFrequency, ///< [in]  Timestamp frequency of the queue it executed on
+    std::vector<ProfilerResult>& results)        ///< [out] Vector with profiler results
+{
+    HRESULT result = E_FAIL;
+
+    // Loop through all measurements for this command list
+    for (UINT i = 0; i < cmdListData.measurementGroups.size(); i++)
+    {
+        ProfilerMeasurementGroup& currGroup = cmdListData.measurementGroups[i];
 
-            // Report no results
-            if (m_config.measurementTypeFlags == PROFILER_MEASUREMENT_TYPE_NONE)
+        ProfilerInterval* pTimestampData = nullptr;
+        D3D12_QUERY_DATA_PIPELINE_STATISTICS* pPipelineStatsData = nullptr;
+
+        if ((m_config.measurementTypeFlags & PROFILER_MEASUREMENT_TYPE_TIMESTAMPS) && (currGroup.pTimestampBuffer != nullptr))
+        {
+            D3D12_RANGE mapRange = {};
+            mapRange.Begin = 0;
+            mapRange.End   = m_config.measurementsPerGroup * sizeof(ProfilerInterval);
+            result = currGroup.pTimestampBuffer->Map(0, &mapRange, reinterpret_cast<void**>(&pTimestampData));
+        }
+
+        if ((m_config.measurementTypeFlags & PROFILER_MEASUREMENT_TYPE_PIPE_STATS) && (currGroup.pPipeStatsBuffer != nullptr))
+        {
+            D3D12_RANGE mapRange = {};
+            mapRange.Begin = 0;
+            mapRange.End   = m_config.measurementsPerGroup * sizeof(D3D12_QUERY_DATA_PIPELINE_STATISTICS);
+            result = currGroup.pPipeStatsBuffer->Map(0, &mapRange, reinterpret_cast<void**>(&pPipelineStatsData));
+        }
+
+        // Report no results
+        if (m_config.measurementTypeFlags == PROFILER_MEASUREMENT_TYPE_NONE)
+        {
+            for (UINT j = 0; j < currGroup.groupMeasurementCount; j++)
             {
-                for (UINT j = 0; j < currGroup.groupMeasurementCount; j++)
-                {
-                    ProfilerResult profilerResult = {};
-                    results.push_back(profilerResult);
-                }
+                ProfilerResult profilerResult = {};
+                results.push_back(profilerResult);
             }
+        }
 
-            // Fetch our results
-            else
+        // Fetch our results
+        else
+        {
+            for (UINT j = 0; j < currGroup.groupMeasurementCount; j++)
             {
-                for (UINT j = 0; j < currGroup.groupMeasurementCount; j++)
-                {
-                    ProfilerResult profilerResult = {};
-
-                    memcpy(&profilerResult.measurementInfo, &currGroup.measurementInfos[j], sizeof(ProfilerMeasurementInfo));
-
-                    if (pTimestampData != nullptr)
-                    {
-                        UINT64* pTimerBegin = &pTimestampData[j].start;
-                        UINT64* pTimerEnd = &pTimestampData[j].end;
-                        UINT64 baseClock = pTimestampData[0].start;
+                ProfilerResult profilerResult = {};
 
-                        // Make sure the reported clock values aren't zero
-                        PROFILER_ASSERT((*pTimerBegin != 0) && (*pTimerEnd != 0));
+                memcpy(&profilerResult.measurementInfo, &currGroup.measurementInfos[j], sizeof(ProfilerMeasurementInfo));
 
-                        // Store raw clocks
-                        profilerResult.timestampResult.rawClocks.start = *pTimerBegin;
-                        profilerResult.timestampResult.rawClocks.end = *pTimerEnd;
+                if (pTimestampData != nullptr)
+                {
+                    UINT64* pTimerBegin = &pTimestampData[j].start;
+                    UINT64* pTimerEnd = &pTimestampData[j].end;
+                    UINT64 baseClock = pTimestampData[0].start;
 
-                        // Calculate adjusted clocks
-                        profilerResult.timestampResult.adjustedClocks.start = *pTimerBegin - baseClock;
-                        profilerResult.timestampResult.adjustedClocks.end = *pTimerEnd - baseClock;
+                    // Make sure the reported clock values aren't zero
+                    PROFILER_ASSERT((*pTimerBegin != 0) && (*pTimerEnd != 0));
 
-                        // Calculate exec time
-                        profilerResult.timestampResult.execMicroSecs = static_cast<double>(*pTimerEnd - *pTimerBegin) / queueFrequency;
-                        profilerResult.timestampResult.execMicroSecs *= 1000000;
-                    }
+                    // Store raw clocks
+                    profilerResult.timestampResult.rawClocks.start = *pTimerBegin;
+                    profilerResult.timestampResult.rawClocks.end = *pTimerEnd;
 
-                    if (pPipelineStatsData != nullptr)
-                    {
-                        memcpy(&profilerResult.pipeStatsResult, pPipelineStatsData, sizeof(D3D12_QUERY_DATA_PIPELINE_STATISTICS));
-                    }
+                    // Calculate adjusted clocks
+                    profilerResult.timestampResult.adjustedClocks.start = *pTimerBegin - baseClock;
+                    profilerResult.timestampResult.adjustedClocks.end = *pTimerEnd - baseClock;
 
-                    results.push_back(profilerResult);
+                    // Calculate exec time
+                    profilerResult.timestampResult.execMicroSecs = static_cast<double>(*pTimerEnd - *pTimerBegin) / queueFrequency;
+                    profilerResult.timestampResult.execMicroSecs *= 1000000;
                 }
 
-                D3D12_RANGE unmapRange = {};
-
                 if (pPipelineStatsData != nullptr)
                 {
-                    currGroup.pPipeStatsBuffer->Unmap(0, &unmapRange);
+                    memcpy(&profilerResult.pipeStatsResult, pPipelineStatsData, sizeof(D3D12_QUERY_DATA_PIPELINE_STATISTICS));
                 }
 
-                if (pTimestampData != nullptr)
-                {
-                    currGroup.pTimestampBuffer->Unmap(0, &unmapRange);
-                }
+                results.push_back(profilerResult);
+            }
+
+            D3D12_RANGE unmapRange = {};
+
+            if (pPipelineStatsData != nullptr)
+            {
+                currGroup.pPipeStatsBuffer->Unmap(0, &unmapRange);
+            }
+
+            if (pTimestampData != nullptr)
+            {
+                currGroup.pTimestampBuffer->Unmap(0, &unmapRange);
             }
         }
+    }
 
-        // We're done profiling this command list, so free up used resources
-        result = ReleaseProfilerData(cmdListData);
-        PROFILER_ASSERT(result == S_OK);
+    UNREFERENCED_PARAMETER(result);
+}
+
+/**
+***************************************************************************************************
+*   DX12CmdListProfiler::GetQueueData
+*
+*   @brief
+*       Find the fence and scheduler for a queue, creating them the first time the queue is seen.
+*
+*   @return
+*       Pointer to the queue's data. Return nullptr if the fence couldn't be created.
+***************************************************************************************************
+*/
+ProfilerQueueData* DX12CmdListProfiler::GetQueueData(ID3D12CommandQueue* pCmdQueue)
+{
+    ProfilerQueueData* pQueueData = nullptr;
 
-        m_cmdListMap.erase(pCmdList);
+    QueueDataMap::iterator queueIter = m_queueData.find(pCmdQueue);
+
+    if (queueIter != m_queueData.end())
+    {
+        pQueueData = &queueIter->second;
     }
     else
     {
-        profilerResultCode = PROFILER_THIS_CMD_LIST_WAS_NOT_MEASURED;
+        DX12ProfilerQueueFence* pQueueFence = DX12ProfilerQueueFence::Create(m_pDevice, pCmdQueue);
+
+        if (pQueueFence != nullptr)
+        {
+            ProfilerQueueData queueData = {};
+            queueData.pQueueFence = pQueueFence;
+            queueData.pScheduler  = new ProfilerResultScheduler<ProfilerPendingCmdList>(pQueueFence);
+
+            pQueueData = &(m_queueData[pCmdQueue] = queueData);
+        }
     }
 
-    return profilerResultCode;
+    return pQueueData;
 }
 
 /**
@@ -623,39 +717,121 @@ HRESULT DX12CmdListProfiler::ReleaseProfilerData(
 
 /**
 ***************************************************************************************************
-*   DX12CmdListProfiler::IsFenceComplete
+*   DX12ProfilerQueueFence::Create
 *
 *   @brief
-*       Determine if a fence has come back.
+*       Static method that creates a fence to be signaled by a single queue.
 *
 *   @return
-*       True if fence is complete.
+*       Pointer to the queue fence. Return nullptr if the fence or its event couldn't be created.
+***************************************************************************************************
+*/
+DX12ProfilerQueueFence* DX12ProfilerQueueFence::Create(
+    ID3D12Device*       pDevice,    ///< [in] Handle to the device
+    ID3D12CommandQueue* pCmdQueue)  ///< [in] Handle to the queue that will signal the fence
+{
+    DX12ProfilerQueueFence* pOut = new DX12ProfilerQueueFence(pCmdQueue);
+
+    HRESULT result = pDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&pOut->m_pFence));
+
+    if (result == S_OK)
+    {
+        pOut->m_pFence->SetName(L"DX12ProfilerQueueFence::m_pFence");
+
+        pOut->m_fenceEvent = CreateEvent(nullptr, false, false, nullptr);
+    }
+
+    if ((result != S_OK) || (pOut->m_fenceEvent == nullptr))
+    {
+        delete pOut;
+        pOut = nullptr;
+    }
+
+    return pOut;
+}
+
+/**
+***************************************************************************************************
+*   DX12ProfilerQueueFence::DX12ProfilerQueueFence
+*
+*   @brief
+*       Constructor.
+***************************************************************************************************
+*/
+DX12ProfilerQueueFence::DX12ProfilerQueueFence(ID3D12CommandQueue* pCmdQueue)
+    :
+    m_pCmdQueue(pCmdQueue),
+    m_pFence(nullptr),
+    m_fenceEvent(nullptr)
+{
+}
+
+/**
+***************************************************************************************************
+*   DX12ProfilerQueueFence::~DX12ProfilerQueueFence
+*
+*   @brief
+*       Destructor.
 ***************************************************************************************************
 */
-bool DX12CmdListProfiler::IsFenceComplete(UINT64 fenceValue)
+DX12ProfilerQueueFence::~DX12ProfilerQueueFence()
 {
-    if (fenceValue > m_lastCompletedFenceValue)
+    if (m_fenceEvent != nullptr)
     {
-        m_lastCompletedFenceValue = Max(m_lastCompletedFenceValue, m_pFence->GetCompletedValue());
+        CloseHandle(m_fenceEvent);
     }
 
-    return fenceValue <= m_lastCompletedFenceValue;
+    if (m_pFence != nullptr)
+    {
+        m_pFence->Release();
+    }
+}
+
+/**
+***************************************************************************************************
+*   DX12ProfilerQueueFence::Signal
+*
+*   @brief
+*       Signal the fence from the queue, after all work submitted so far.
+*
+*   @return
+*       True if the signal was added to the queue.
+***************************************************************************************************
+*/
+bool DX12ProfilerQueueFence::Signal(uint64_t fenceValue)
+{
+    return (m_pCmdQueue->Signal(m_pFence, fenceValue) == S_OK);
+}
+
+/**
+***************************************************************************************************
+*   DX12ProfilerQueueFence::GetCompletedValue
+*
+*   @brief
+*       Read the fence without blocking.
+*
+*   @return
+*       The last value reached by the GPU.
+***************************************************************************************************
+*/
+uint64_t DX12ProfilerQueueFence::GetCompletedValue()
+{
+    return m_pFence->GetCompletedValue();
 }
 
 /**
 ***************************************************************************************************
-*   DX12CmdListProfiler::WaitForFence
+*   DX12ProfilerQueueFence::WaitForValue
 *
 *   @brief
-*       Wait for a fence to come back.
+*       Wait for the fence to reach a value.
 ***************************************************************************************************
 */
-void DX12CmdListProfiler::WaitForFence(UINT64 fenceValue)
+void DX12ProfilerQueueFence::WaitForValue(uint64_t fenceValue)
 {
-    if (IsFenceComplete(fenceValue) == false)
+    if (m_pFence->GetCompletedValue() < fenceValue)
     {
         m_pFence->SetEventOnCompletion(fenceValue, m_fenceEvent);
         WaitForSingleObject(m_fenceEvent, INFINITE);
-        m_lastCompletedFenceValue = fenceValue;
     }
 }
@@ -12,6 +12,8 @@
 
 #include <d3d12.h>
 #include <unordered_map>
+#include "ProfilerResultScheduler.h"
+#include "ProfilerCmdListMap.h"
 
 #ifdef _DEBUG
 #define PROFILER_ASSERT(__expr__) if (!(__expr__)) __debugbreak();
@@ -156,13 +158,72 @@ struct ProfilerCmdListData
     ProfilerMeasurementGroup*             pActiveMeasurementGroup;
 };
 
+/**
+***************************************************************************************************
+*   @brief  A command list that has been submitted, and is waiting for the GPU to write its results.
+***************************************************************************************************
+*/
+struct ProfilerPendingCmdList
+{
+    ID3D12GraphicsCommandList* pCmdList;
+    ProfilerCmdListData        cmdListData;
+};
+
+/**
+***************************************************************************************************
+*   DX12ProfilerQueueFence
+*
+*   @brief
+*       A fence owned by the profiler and signaled only through a single command queue.
+***************************************************************************************************
+*/
+class DX12ProfilerQueueFence : public IProfilerQueueFence
+{
+public:
+    static DX12ProfilerQueueFence* Create(
+        ID3D12Device*       pDevice,
+        ID3D12CommandQueue* pCmdQueue);
+
+    virtual ~DX12ProfilerQueueFence();
+
+    virtual bool Signal(uint64_t fenceValue);
+
+    virtual uint64_t GetCompletedValue();
+
+    virtual void WaitForValue(uint64_t fenceValue);
+
+private:
+    DX12ProfilerQueueFence(ID3D12CommandQueue* pCmdQueue);
+
+    // The queue that signals the fence
+    ID3D12CommandQueue* m_pCmdQueue;
+
+    // The fence signaled after each profiled submit
+    ID3D12Fence* m_pFence;
+
+    // Event used when a caller needs to block on the fence
+    HANDLE m_fenceEvent;
+};
+
+/**
+***************************************************************************************************
+*   @brief  Everything the profiler tracks for each command queue that has submitted measured work.
+***************************************************************************************************
+*/
+struct ProfilerQueueData
+{
+    DX12ProfilerQueueFence*                          pQueueFence;
+    ProfilerResultScheduler<ProfilerPendingCmdList>* pScheduler;
+};
+
 /**
 ***************************************************************************************************
 *   @brief  Utility typedefs
 ***************************************************************************************************
 */
-typedef std::unordered_map<ID3D12GraphicsCommandList*, ProfilerCmdListData> CmdListDataMap;
 typedef std::unordered_map<ID3D12CommandQueue*, UINT64> QueueFrequencies;
+typedef std::unordered_map<ID3D12CommandQueue*, ProfilerQueueData> QueueDataMap;
+typedef std::unordered_map<ID3D12CommandQueue*, std::vector<ProfilerResult>> ProfilerQueueResults;
 
 /**
 ***************************************************************************************************
@@ -226,6 +287,48 @@ private:
     DX12ProfilerCriticalSection& m_cs;
 };
 
+/**
+***************************************************************************************************
+*   DX12ProfilerReadWriteLock
+*
+*   @brief
+*       Helper class to wrap a Windows SRWLOCK, so that many readers can hold the lock at once.
+***************************************************************************************************
+*/
+class DX12ProfilerReadWriteLock
+{
+public:
+    DX12ProfilerReadWriteLock()
+    {
+        InitializeSRWLock(&m_srwLock);
+    }
+
+    void EnterShared()
+    {
+        AcquireSRWLockShared(&m_srwLock);
+    }
+
+    void LeaveShared()
+    {
+        ReleaseSRWLockShared(&m_srwLock);
+    }
+
+    void EnterExclusive()
+    {
+        AcquireSRWLockExclusive(&m_srwLock);
+    }
+
+    void LeaveExclusive()
+    {
+        ReleaseSRWLockExclusive(&m_srwLock);
+    }
+
+protected:
+    SRWLOCK m_srwLock;
+};
+
+typedef ProfilerCmdListMap<ID3D12GraphicsCommandList, ProfilerCmdListData, DX12ProfilerReadWriteLock> CmdListDataMap;
+
 /**
 ***************************************************************************************************
 *   DX12CmdListProfiler
@@ -249,10 +352,15 @@ public:
 
     ProfilerResultCode EndCmdMeasurement(ID3D12GraphicsCommandList* pCmdList);
 
-    ProfilerResultCode GetCmdListResults(
-        ID3D12GraphicsCommandList*   pCmdList,
-        ID3D12CommandQueue*          pCmdQueue,
-        std::vector<ProfilerResult>& results);
+    // Call after a command list has been submitted. Its results are collected later through HarvestResults.
+    ProfilerResultCode RetireCmdList(
+        ID3D12GraphicsCommandList* pCmdList,
+        ID3D12CommandQueue*        pCmdQueue);
+
+    // Collect the results of every retired command list that the GPU has finished with.
+    ProfilerResultCode HarvestResults(
+        bool                  waitForGpu,
+        ProfilerQueueResults& results);
 
     // Use this to change whether we want timestamps/counters or both
     void UpdateMeasurementType(ProfilerMeasurementTypeFlags measurementTypeFlags)
@@ -273,21 +381,12 @@ private:
 
     HRESULT CreateQueryBuffer(ID3D12Resource** pResource, UINT size);
 
-    // This determines if a command list has already been seen
-    inline bool IsCmdListBeingMeasured(ID3D12GraphicsCommandList* pCmdList)
-    {
-        return (m_cmdListMap.find(pCmdList) != m_cmdListMap.end());
-    }
-
-    // Maximum of two numbers
-    inline UINT64 Max(UINT64 val1, UINT64 val2)
-    {
-        return (val1 > val2) ? val1 : val2;
-    }
+    ProfilerQueueData* GetQueueData(ID3D12CommandQueue* pCmdQueue);
 
-    bool IsFenceComplete(UINT64 FenceValue);
-
-    void WaitForFence(UINT64 FenceValue);
+    void ReadCmdListResults(
+        ProfilerCmdListData&         cmdListData,
+        UINT64                       queueFrequency,
+        std::vector<ProfilerResult>& results);
 
     HRESULT ReleaseProfilerData(ProfilerCmdListData& data);
 
@@ -300,16 +399,13 @@ private:
     // Holds per-command list information for each begin-end measurement
     QueueFrequencies m_queueFrequencies;
 
-    // Critical section object
+    // Guards the queue data, for retiring and harvesting command lists
     DX12ProfilerCriticalSection m_cs;
 
     // Profiler configuration
     DX12CmdListProfilerConfig m_config;
 
-    // Synchronization members used to wait for a command list to finish
-    ID3D12Fence* m_pFence;
-    UINT64 m_nextFenceValue;
-    UINT64 m_lastCompletedFenceValue;
-    HANDLE m_fenceEvent;
+    // Holds the fence and the retired command lists for each queue
+    QueueDataMap m_queueData;
 };
 #endif // __DX12_CMD_LIST_PROFILER_H__
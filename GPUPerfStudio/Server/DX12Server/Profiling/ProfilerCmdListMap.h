@@ -0,0 +1,104 @@
+//=================================================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file   ProfilerCmdListMap.h
+/// \brief  Holds the measurement data for each command list that is being recorded. Many
+///         threads can record their own command lists at once, so lookups only take the lock
+///         in shared mode. This has no dependency on D3D12, or on the lock implementation.
+//=================================================================================================
+
+#ifndef __PROFILER_CMD_LIST_MAP_H__
+#define __PROFILER_CMD_LIST_MAP_H__
+
+#include <unordered_map>
+
+/**
+***************************************************************************************************
+*   ProfilerCmdListMap
+*
+*   @brief
+*       Maps each command list to its measurement data. The lock only guards the structure of the
+*       map. Each entry is only used by the thread recording its command list, so an entry found
+*       through Find or FindOrAdd is used without a lock, and stays valid until it's removed.
+*       LockType must provide EnterShared, LeaveShared, EnterExclusive and LeaveExclusive.
+***************************************************************************************************
+*/
+template <typename CmdListType, typename CmdListDataType, typename LockType>
+class ProfilerCmdListMap
+{
+public:
+    // Returns nullptr if the command list hasn't been measured since it was last removed
+    CmdListDataType* Find(CmdListType* pCmdList)
+    {
+        m_lock.EnterShared();
+
+        typename DataMap::iterator cmdListIter = m_map.find(pCmdList);
+        CmdListDataType* pCmdListData = (cmdListIter != m_map.end()) ? &cmdListIter->second : nullptr;
+
+        m_lock.LeaveShared();
+
+        return pCmdListData;
+    }
+
+    // Add zeroed data for the command list if it hasn't been measured yet. Only the insert is exclusive.
+    CmdListDataType& FindOrAdd(CmdListType* pCmdList)
+    {
+        CmdListDataType* pCmdListData = Find(pCmdList);
+
+        if (pCmdListData == nullptr)
+        {
+            m_lock.EnterExclusive();
+            pCmdListData = &m_map.insert(std::make_pair(pCmdList, CmdListDataType())).first->second;
+            m_lock.LeaveExclusive();
+        }
+
+        return *pCmdListData;
+    }
+
+    // Pass the command list's data to removeFunc, and remove it if removeFunc returns true.
+    // Returns false if the command list hasn't been measured.
+    template <typename RemoveFunc>
+    bool RemoveIf(CmdListType* pCmdList, RemoveFunc removeFunc)
+    {
+        m_lock.EnterExclusive();
+
+        typename DataMap::iterator cmdListIter = m_map.find(pCmdList);
+        const bool found = (cmdListIter != m_map.end());
+
+        if (found && removeFunc(cmdListIter->second))
+        {
+            m_map.erase(cmdListIter);
+        }
+
+        m_lock.LeaveExclusive();
+
+        return found;
+    }
+
+    // Pass the data for each command list to func, with the lock held exclusively
+    template <typename Func>
+    void ForEach(Func func)
+    {
+        m_lock.EnterExclusive();
+
+        for (typename DataMap::iterator iterator = m_map.begin();
+             iterator != m_map.end();
+             iterator++)
+        {
+            func(iterator->second);
+        }
+
+        m_lock.LeaveExclusive();
+    }
+
+private:
+    typedef std::unordered_map<CmdListType*, CmdListDataType> DataMap;
+
+    // The measurement data for each command list
+    DataMap m_map;
+
+    // Guards the structure of m_map
+    LockType m_lock;
+};
+
+#endif // __PROFILER_CMD_LIST_MAP_H__
@@ -0,0 +1,149 @@
+//=================================================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file   ProfilerResultScheduler.h
+/// \brief  Tracks profiled work that has been submitted to a queue, and hands it back
+///         once the GPU has finished with it. This has no dependency on D3D12, so the
+///         scheduling can be driven by any queue/fence implementation.
+//=================================================================================================
+
+#ifndef __PROFILER_RESULT_SCHEDULER_H__
+#define __PROFILER_RESULT_SCHEDULER_H__
+
+#include <stddef.h>
+#include <deque>
+#include <stdint.h>
+
+/**
+***************************************************************************************************
+*   IProfilerQueueFence
+*
+*   @brief
+*       A queue paired with a fence that only that queue signals. Values signaled through a
+*       single queue complete in order, so a single completed value covers all earlier work.
+***************************************************************************************************
+*/
+class IProfilerQueueFence
+{
+public:
+    virtual ~IProfilerQueueFence() {}
+
+    // Insert a signal of the given value at the end of the queue's current work
+    virtual bool Signal(uint64_t fenceValue) = 0;
+
+    // Read the last value that the GPU has reached, without blocking
+    virtual uint64_t GetCompletedValue() = 0;
+
+    // Block until the GPU reaches the given value
+    virtual void WaitForValue(uint64_t fenceValue) = 0;
+};
+
+/**
+***************************************************************************************************
+*   ProfilerResultScheduler
+*
+*   @brief
+*       Work is retired to a pending queue, keyed by the fence value signaled after it. Harvest
+*       polls the fence and returns all work that the GPU has finished, so the CPU never has to
+*       wait on a submit unless the caller asks for it.
+***************************************************************************************************
+*/
+template <typename PendingType>
+class ProfilerResultScheduler
+{
+public:
+    explicit ProfilerResultScheduler(IProfilerQueueFence* pQueueFence)
+        :
+        m_pQueueFence(pQueueFence),
+        m_nextFenceValue(1),
+        m_lastCompletedFenceValue(0)
+    {
+    }
+
+    // Signal the queue after the work that was just submitted, and hold the work until the signal completes
+    bool Retire(const PendingType& pending)
+    {
+        const uint64_t fenceValue = m_nextFenceValue;
+
+        if (m_pQueueFence->Signal(fenceValue) == false)
+        {
+            return false;
+        }
+
+        m_nextFenceValue++;
+
+        PendingEntry entry;
+        entry.fenceValue = fenceValue;
+        entry.pending    = pending;
+        m_pending.push_back(entry);
+
+        return true;
+    }
+
+    // Pass each finished piece of work to harvestFunc, oldest first. Returns the number harvested.
+    template <typename HarvestFunc>
+    size_t Harvest(bool waitForGpu, HarvestFunc harvestFunc)
+    {
+        if (m_pending.empty())
+        {
+            return 0;
+        }
+
+        const uint64_t lastRetiredValue = m_pending.back().fenceValue;
+
+        if (waitForGpu && (IsFenceComplete(lastRetiredValue) == false))
+        {
+            m_pQueueFence->WaitForValue(lastRetiredValue);
+            m_lastCompletedFenceValue = lastRetiredValue;
+        }
+
+        size_t numHarvested = 0;
+
+        while ((m_pending.empty() == false) && IsFenceComplete(m_pending.front().fenceValue))
+        {
+            harvestFunc(m_pending.front().pending);
+            m_pending.pop_front();
+            numHarvested++;
+        }
+
+        return numHarvested;
+    }
+
+    size_t GetNumPending() const
+    {
+        return m_pending.size();
+    }
+
+private:
+    struct PendingEntry
+    {
+        uint64_t    fenceValue;
+        PendingType pending;
+    };
+
+    // Only reads the fence when the cached value isn't already far enough along
+    bool IsFenceComplete(uint64_t fenceValue)
+    {
+        if (fenceValue > m_lastCompletedFenceValue)
+        {
+            const uint64_t completedValue = m_pQueueFence->GetCompletedValue();
+            m_lastCompletedFenceValue = (completedValue > m_lastCompletedFenceValue) ? completedValue : m_lastCompletedFenceValue;
+        }
+
+        return fenceValue <= m_lastCompletedFenceValue;
+    }
+
+    // The queue/fence that work is retired against
+    IProfilerQueueFence* m_pQueueFence;
+
+    // The value that the next Retire will signal
+    uint64_t m_nextFenceValue;
+
+    // The most recent value known to have been reached by the GPU
+    uint64_t m_lastCompletedFenceValue;
+
+    // Retired work, in the order it was signaled
+    std::deque<PendingEntry> m_pending;
+};
+
+#endif // __PROFILER_RESULT_SCHEDULER_H__
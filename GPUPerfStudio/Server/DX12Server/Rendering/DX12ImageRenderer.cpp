@@ -9,7 +9,6 @@
 #include "DX12ImageRenderer.h"
 
 #include <d3dcompiler.h>
-#include <png.h>
 #include <fstream>
 #include "../Util/d3dx12.h"
 
@@ -525,26 +524,16 @@ void DX12ImageRenderer::WaitCmdListFinish()
     }
 }
 
-/**
-***************************************************************************************************
-*   CustomPngWriteCb
-*
-*   @brief
-*       Callback function used in PNG dumps.
-***************************************************************************************************
-*/
-void CustomPngWriteCb(png_structp png_ptr, png_bytep data, png_size_t length)
-{
-    std::vector<UCHAR>* pVec = (std::vector<UCHAR>*)png_get_io_ptr(png_ptr);
-    pVec->insert(pVec->end(), data, data + length);
-}
-
 /**
 ***************************************************************************************************
 *   DX12ImageRenderer::CpuImageToPng
 *
 *   @brief
 *       Take an RGBA CpuImage ptr and put it in PNG form resident in system memory.
+*       The image is encoded on several threads. Use PNG_COMPRESSION_FAST for images that
+*       are sent straight to the client, and PNG_COMPRESSION_DEFAULT for images that are kept.
+*       An image that is also written to fileName is kept, so it uses at least PNG_COMPRESSION_DEFAULT.
+*       PNG_COMPRESSION_MAX is only used when it's asked for.
 *
 *       IMPORTANT: Memory inside ppImage is allocated on behalf of the caller, so it is their
 *       responsibility to free it.
@@ -554,63 +543,45 @@ void CustomPngWriteCb(png_structp png_ptr, png_bytep data, png_size_t length)
 ***************************************************************************************************
 */
 bool DX12ImageRenderer::CpuImageToPng(
-    CpuImage*          pImage,
-    UCHAR**            ppPngMem,
-    UINT*              pMemSize,
-    const std::string& fileName) // Optional
+    CpuImage*            pImage,
+    UCHAR**              ppPngMem,
+    UINT*                pMemSize,
+    const std::string&   fileName, // Optional
+    PngCompressionPreset preset)
 {
     bool success = false;
 
     if ((pImage != nullptr) && (ppPngMem != nullptr) && (pMemSize != nullptr))
     {
-        png_structp png_ptr = png_create_write_struct(PNG_LIBPNG_VER_STRING, NULL, NULL, NULL);
+        const bool saved = (fileName != "");
+        ParallelPngEncoder encoder((saved && (preset == PNG_COMPRESSION_FAST)) ? PNG_COMPRESSION_DEFAULT : preset);
 
-        if (png_ptr)
-        {
-            png_infop info_ptr = png_create_info_struct(png_ptr);
-            png_set_IHDR(png_ptr, info_ptr, pImage->width, pImage->height, 8, PNG_COLOR_TYPE_RGBA, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
-
-            std::vector<UCHAR*> rows(pImage->height);
-            for (UINT i = 0; i < pImage->height; i++)
-            {
-                rows[i] = (UCHAR*)pImage->pData + i * pImage->width * 4;
-            }
-
-            png_set_rows(png_ptr, info_ptr, &rows[0]);
-
-            std::vector<UCHAR> pngData;
-            png_set_write_fn(png_ptr, &pngData, CustomPngWriteCb, NULL);
-
-            png_write_png(png_ptr, info_ptr, PNG_TRANSFORM_IDENTITY, NULL);
-            png_destroy_write_struct(&png_ptr, NULL);
+        std::vector<UCHAR> pngData;
 
+        if (encoder.Encode((const UCHAR*)pImage->pData, pImage->width, pImage->height, (int)pImage->pitch, pngData))
+        {
             const UINT memSize = (UINT)pngData.size();
 
-            if (memSize != 0)
-            {
-                UCHAR* pOut = new UCHAR[memSize];
+            UCHAR* pOut = new UCHAR[memSize];
 
-                if (pOut != nullptr)
-                {
-                    memcpy(pOut, &pngData[0], memSize);
+            if (pOut != nullptr)
+            {
+                memcpy(pOut, &pngData[0], memSize);
 
-                    *ppPngMem = pOut;
-                    *pMemSize = memSize;
+                *ppPngMem = pOut;
+                *pMemSize = memSize;
 
-                    success = true;
+                success = true;
 
-                    // Optionally, dump it out to file
-                    if (fileName != "")
-                    {
-                        std::ofstream outfile(fileName.c_str(), std::ios::out | std::ios::binary);
-                        outfile.write((const char*)pOut, memSize);
-                        outfile.close();
-                    }
+                // Optionally, dump it out to file
+                if (fileName != "")
+                {
+                    std::ofstream outfile(fileName.c_str(), std::ios::out | std::ios::binary);
+                    outfile.write((const char*)pOut, memSize);
+                    outfile.close();
                 }
             }
         }
-
-
     }
 
     return success;
@@ -8,6 +8,7 @@
 
 #include <d3d12.h>
 #include <vector>
+#include "../Common/ParallelPngEncoder.h"
 
 #ifndef __DX12_IMAGE_RENDERER_H__
 #define __DX12_IMAGE_RENDERER_H__
@@ -53,10 +54,11 @@ class DX12ImageRenderer
 {
 public:
     static bool CpuImageToPng(
-        CpuImage*          pImage,
-        UCHAR**            ppPngMem,
-        UINT*              pMemSize,
-        const std::string& fileName = ""); // Optional
+        CpuImage*            pImage,
+        UCHAR**              ppPngMem,
+        UINT*                pMemSize,
+        const std::string&   fileName = "", // Optional
+        PngCompressionPreset preset = PNG_COMPRESSION_FAST);
 
     static DX12ImageRenderer* Create(const DX12ImageRendererConfig& config);
 
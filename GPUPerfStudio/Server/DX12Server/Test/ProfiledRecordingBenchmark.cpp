@@ -0,0 +1,337 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Benchmark for command list recording while GPU time is collected.
+///         N threads each record their own command list, and every call is
+///         profiled the way DX12Interceptor::PreCall/PostCall do it. This is
+///         run three times:
+///         - the GPA path as it ships (USE_GPA_PROFILING is 1), where the GPA
+///           lock is only held while the command list is selected and its
+///           sample is begun, and again while it's selected and the sample is
+///           ended, so other threads record while the real call runs;
+///         - the GPA path as it used to be, with the lock held from selecting
+///           the command list until its sample ends, across the real call;
+///         - the DX12CmdListProfiler path, where the command list's measurement
+///           data is found through the real ProfilerCmdListMap and no lock is
+///           held across the call.
+///         Checks that every sample is ended in the command list it was begun in.
+///
+///         The interceptor and the profiler need D3D12, so the sample ids, the
+///         active sample and the runtime call are stood in for here. The map
+///         uses a pthread read-write lock in place of the profiler's SRWLOCK:
+///         g++ -std=c++11 -O2 ProfiledRecordingBenchmark.cpp -lpthread
+//==============================================================================
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../Profiling/ProfilerCmdListMap.h"
+
+//--------------------------------------------------------------------------
+/// The number of profiled calls each thread records.
+//--------------------------------------------------------------------------
+static const unsigned int s_CallsPerThread = 200000;
+
+//--------------------------------------------------------------------------
+/// The amount of work done by the stand-in for the real runtime call.
+//--------------------------------------------------------------------------
+static const unsigned int s_RuntimeCallWork = 200;
+
+//--------------------------------------------------------------------------
+/// Stands in for a command list that's being recorded.
+//--------------------------------------------------------------------------
+struct BenchmarkCmdList
+{
+    /// Stands in for the sample GPA has open in the command list's context. Only used under the GPA lock.
+    unsigned int mOpenGPASampleId;
+
+    /// Keeps each command list on its own cache line.
+    char mPadding[60];
+};
+
+//--------------------------------------------------------------------------
+/// Stands in for ProfilerCmdListData, which holds D3D12 query heaps.
+//--------------------------------------------------------------------------
+struct BenchmarkCmdListData
+{
+    /// The number of measurements begun in the command list.
+    unsigned int mNumMeasurements;
+
+    /// The sample id of the measurement in progress.
+    unsigned int mActiveSampleId;
+};
+
+//--------------------------------------------------------------------------
+/// Stands in for DX12ProfilerReadWriteLock, with a pthread read-write lock in place of the SRWLOCK.
+//--------------------------------------------------------------------------
+class BenchmarkReadWriteLock
+{
+public:
+    BenchmarkReadWriteLock() { pthread_rwlock_init(&mLock, NULL); }
+    ~BenchmarkReadWriteLock() { pthread_rwlock_destroy(&mLock); }
+    void EnterShared() { pthread_rwlock_rdlock(&mLock); }
+    void LeaveShared() { pthread_rwlock_unlock(&mLock); }
+    void EnterExclusive() { pthread_rwlock_wrlock(&mLock); }
+    void LeaveExclusive() { pthread_rwlock_unlock(&mLock); }
+
+private:
+    /// The lock.
+    pthread_rwlock_t mLock;
+};
+
+//--------------------------------------------------------------------------
+/// The active sample of the calling thread, between PreCall and PostCall, like DX12Interceptor's sActiveSample.
+//--------------------------------------------------------------------------
+static thread_local unsigned int s_ActiveSampleId = 0;
+
+//--------------------------------------------------------------------------
+/// Stands in for the real runtime call recording a command.
+//--------------------------------------------------------------------------
+static unsigned int RecordCommand(unsigned int inSeed)
+{
+    unsigned int value = inSeed;
+
+    for (unsigned int i = 0; i < s_RuntimeCallWork; i++)
+    {
+        value = (value * 1664525u) + 1013904223u;
+    }
+
+    return value;
+}
+
+//--------------------------------------------------------------------------
+/// The GPA path: GPA begins and ends samples in whichever command list is selected,
+/// and keeps each command list's open sample separately.
+//--------------------------------------------------------------------------
+class GPALockRecorder
+{
+public:
+    //--------------------------------------------------------------------------
+    /// Constructor.
+    /// \param inbHoldAcrossCall True to hold the lock across the real call, as the GPA path used to.
+    //--------------------------------------------------------------------------
+    explicit GPALockRecorder(bool inbHoldAcrossCall) : mbHoldAcrossCall(inbHoldAcrossCall), mSampleIndex(0), mSelectedCmdList(NULL), mNumSamples(0), mNumMismatchedSamples(0) { }
+
+    //--------------------------------------------------------------------------
+    /// Record one profiled call into a command list.
+    //--------------------------------------------------------------------------
+    unsigned int RecordCall(BenchmarkCmdList* inCmdList, unsigned int inSeed)
+    {
+        // PreCall: select the command list and begin the sample
+        s_ActiveSampleId = mSampleIndex.fetch_add(1, std::memory_order_relaxed) + 1;
+
+        mGPALock.lock();
+        mSelectedCmdList = inCmdList;
+        mSelectedCmdList->mOpenGPASampleId = s_ActiveSampleId;
+        mNumSamples++;
+
+        if (mbHoldAcrossCall == false)
+        {
+            mGPALock.unlock();
+        }
+
+        unsigned int result = RecordCommand(inSeed);
+
+        // PostCall: select the command list again, and end the sample
+        if (mbHoldAcrossCall == false)
+        {
+            mGPALock.lock();
+            mSelectedCmdList = inCmdList;
+        }
+
+        if (mSelectedCmdList->mOpenGPASampleId != s_ActiveSampleId)
+        {
+            mNumMismatchedSamples++;
+        }
+
+        mSelectedCmdList->mOpenGPASampleId = 0;
+        mSelectedCmdList = NULL;
+        mGPALock.unlock();
+
+        s_ActiveSampleId = 0;
+
+        return result;
+    }
+
+    //--------------------------------------------------------------------------
+    /// Return the number of samples that were begun.
+    //--------------------------------------------------------------------------
+    unsigned int GetNumSamples() const { return mNumSamples; }
+
+    //--------------------------------------------------------------------------
+    /// Return the number of samples that weren't open in their command list when they were ended.
+    //--------------------------------------------------------------------------
+    unsigned int GetNumMismatchedSamples() const { return mNumMismatchedSamples; }
+
+private:
+    /// True to hold the lock from selecting the command list until its sample ends.
+    bool mbHoldAcrossCall;
+
+    /// Held while a command list is selected and a sample is begun or ended.
+    std::mutex mGPALock;
+
+    /// The sample id counter.
+    std::atomic<unsigned int> mSampleIndex;
+
+    /// Stands in for the command list that GPA has selected.
+    BenchmarkCmdList* mSelectedCmdList;
+
+    /// The number of samples that were begun.
+    unsigned int mNumSamples;
+
+    /// The number of samples that weren't open in their command list when they were ended.
+    unsigned int mNumMismatchedSamples;
+};
+
+//--------------------------------------------------------------------------
+/// The DX12CmdListProfiler path: the measurement is begun in the command list's own
+/// data, found through the real ProfilerCmdListMap, and nothing is held across the call.
+//--------------------------------------------------------------------------
+class CmdListProfilerRecorder
+{
+public:
+    //--------------------------------------------------------------------------
+    /// Constructor.
+    //--------------------------------------------------------------------------
+    CmdListProfilerRecorder() : mSampleIndex(0) { }
+
+    //--------------------------------------------------------------------------
+    /// Record one profiled call into a command list.
+    //--------------------------------------------------------------------------
+    unsigned int RecordCall(BenchmarkCmdList* inCmdList, unsigned int inSeed)
+    {
+        // PreCall, and DX12CmdListProfiler::BeginCmdMeasurement
+        s_ActiveSampleId = mSampleIndex.fetch_add(1, std::memory_order_relaxed) + 1;
+
+        BenchmarkCmdListData& cmdListData = mCmdLists.FindOrAdd(inCmdList);
+        cmdListData.mNumMeasurements++;
+        cmdListData.mActiveSampleId = s_ActiveSampleId;
+
+        unsigned int result = RecordCommand(inSeed);
+
+        // PostCall, and DX12CmdListProfiler::EndCmdMeasurement
+        BenchmarkCmdListData* pCmdListData = mCmdLists.Find(inCmdList);
+
+        if (pCmdListData != nullptr)
+        {
+            pCmdListData->mActiveSampleId = 0;
+        }
+
+        s_ActiveSampleId = 0;
+
+        return result;
+    }
+
+    //--------------------------------------------------------------------------
+    /// Return the number of measurements that were begun, and remove every command list
+    /// the way DX12CmdListProfiler::RetireCmdList does.
+    //--------------------------------------------------------------------------
+    unsigned int RetireAll(std::vector<BenchmarkCmdList>& inCmdLists)
+    {
+        unsigned int numMeasurements = 0;
+
+        for (size_t cmdListIndex = 0; cmdListIndex < inCmdLists.size(); cmdListIndex++)
+        {
+            mCmdLists.RemoveIf(&inCmdLists[cmdListIndex], [&](BenchmarkCmdListData& cmdListData)
+            {
+                numMeasurements += cmdListData.mNumMeasurements;
+                return true;
+            });
+        }
+
+        return numMeasurements;
+    }
+
+private:
+    /// The sample id counter.
+    std::atomic<unsigned int> mSampleIndex;
+
+    /// The measurement data for each command list.
+    ProfilerCmdListMap<BenchmarkCmdList, BenchmarkCmdListData, BenchmarkReadWriteLock> mCmdLists;
+};
+
+//--------------------------------------------------------------------------
+/// Record s_CallsPerThread calls into each command list, one thread per list, and return the calls per second.
+//--------------------------------------------------------------------------
+template <typename RecorderType>
+static double RunBenchmark(RecorderType& ioRecorder, std::vector<BenchmarkCmdList>& ioCmdLists)
+{
+    std::vector<std::thread> threads;
+    std::atomic<unsigned int> checksum(0);
+
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+    for (unsigned int threadIndex = 0; threadIndex < ioCmdLists.size(); threadIndex++)
+    {
+        threads.push_back(std::thread([&, threadIndex]()
+        {
+            unsigned int value = threadIndex;
+
+            for (unsigned int call = 0; call < s_CallsPerThread; call++)
+            {
+                value = ioRecorder.RecordCall(&ioCmdLists[threadIndex], value);
+            }
+
+            checksum += value;
+        }));
+    }
+
+    for (unsigned int threadIndex = 0; threadIndex < threads.size(); threadIndex++)
+    {
+        threads[threadIndex].join();
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    return (static_cast<double>(ioCmdLists.size()) * s_CallsPerThread) / seconds;
+}
+
+int main(int argc, char* argv[])
+{
+    unsigned int maxThreads = (argc > 1) ? static_cast<unsigned int>(atoi(argv[1])) : 16;
+    int result = 0;
+
+    printf("%u hardware threads\n", std::thread::hardware_concurrency());
+    printf("%8s %20s %20s %20s\n", "threads", "GPA Mcall/s", "GPA held Mcall/s", "per list Mcall/s");
+
+    for (unsigned int numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+    {
+        std::vector<BenchmarkCmdList> cmdLists(numThreads);
+
+        GPALockRecorder gpaRecorder(false);
+        double gpaRate = RunBenchmark(gpaRecorder, cmdLists);
+
+        GPALockRecorder gpaHeldRecorder(true);
+        double gpaHeldRate = RunBenchmark(gpaHeldRecorder, cmdLists);
+
+        CmdListProfilerRecorder profilerRecorder;
+        double perCmdListRate = RunBenchmark(profilerRecorder, cmdLists);
+
+        printf("%8u %20.2f %20.2f %20.2f\n", numThreads, gpaRate / 1000000.0, gpaHeldRate / 1000000.0, perCmdListRate / 1000000.0);
+
+        // Every call must have begun exactly one sample or measurement, and ended it in its own command list.
+        unsigned int expectedCalls = numThreads * s_CallsPerThread;
+        unsigned int numMeasurements = profilerRecorder.RetireAll(cmdLists);
+
+        if (gpaRecorder.GetNumSamples() != expectedCalls || gpaHeldRecorder.GetNumSamples() != expectedCalls || numMeasurements != expectedCalls)
+        {
+            printf("error: %u, %u samples and %u measurements, expected %u\n", gpaRecorder.GetNumSamples(), gpaHeldRecorder.GetNumSamples(), numMeasurements, expectedCalls);
+            result = 1;
+        }
+
+        if (gpaRecorder.GetNumMismatchedSamples() != 0 || gpaHeldRecorder.GetNumMismatchedSamples() != 0)
+        {
+            printf("error: %u, %u samples ended in the wrong command list\n", gpaRecorder.GetNumMismatchedSamples(), gpaHeldRecorder.GetNumMismatchedSamples());
+            result = 1;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,246 @@
+//==============================================================================
+// Copyright (c) 2015 Advanced Micro Devices, Inc. All rights reserved.
+/// \author AMD Developer Tools Team
+/// \file
+/// \brief  Tests for ProfilerResultScheduler, driven by a mock queue fence in
+///         place of a D3D12 queue. Covers retiring work, harvesting finished
+///         work in order, and the blocking harvest. Returns non-zero if any
+///         check fails.
+///
+///         Standalone, since the scheduler has no dependency on D3D12:
+///         g++ -std=c++11 ProfilerResultSchedulerTest.cpp -o ProfilerResultSchedulerTest
+//==============================================================================
+
+#include <vector>
+#include <stdio.h>
+
+#include "../Profiling/ProfilerResultScheduler.h"
+
+//--------------------------------------------------------------------------
+/// The number of checks that failed.
+//--------------------------------------------------------------------------
+static unsigned int s_NumFailures = 0;
+
+//--------------------------------------------------------------------------
+/// Report a failed check, without stopping the test.
+//--------------------------------------------------------------------------
+#define CHECK(condition)                                                        \
+    if (!(condition))                                                           \
+    {                                                                           \
+        printf("%s(%d): check failed: %s\n", __FILE__, __LINE__, #condition);  \
+        s_NumFailures++;                                                        \
+    }
+
+//--------------------------------------------------------------------------
+/// A queue fence whose progress is set by the test instead of by a GPU.
+//--------------------------------------------------------------------------
+class MockQueueFence : public IProfilerQueueFence
+{
+public:
+    //--------------------------------------------------------------------------
+    /// Constructor. Nothing has been signaled or reached yet.
+    //--------------------------------------------------------------------------
+    MockQueueFence()
+        : mCompletedValue(0)
+        , mNumCompletedReads(0)
+        , mbFailSignal(false)
+    {
+    }
+
+    //--------------------------------------------------------------------------
+    /// Record the signaled value, or fail if the test asked for it.
+    //--------------------------------------------------------------------------
+    virtual bool Signal(uint64_t fenceValue)
+    {
+        if (mbFailSignal)
+        {
+            return false;
+        }
+
+        mSignaledValues.push_back(fenceValue);
+        return true;
+    }
+
+    //--------------------------------------------------------------------------
+    /// Return the value the test says the GPU has reached.
+    //--------------------------------------------------------------------------
+    virtual uint64_t GetCompletedValue()
+    {
+        mNumCompletedReads++;
+        return mCompletedValue;
+    }
+
+    //--------------------------------------------------------------------------
+    /// Stand in for the GPU catching up to the value that's waited on.
+    //--------------------------------------------------------------------------
+    virtual void WaitForValue(uint64_t fenceValue)
+    {
+        mWaitedValues.push_back(fenceValue);
+
+        if (fenceValue > mCompletedValue)
+        {
+            mCompletedValue = fenceValue;
+        }
+    }
+
+    /// The last value the GPU has reached.
+    uint64_t mCompletedValue;
+
+    /// The number of times GetCompletedValue was called.
+    unsigned int mNumCompletedReads;
+
+    /// If true, Signal fails.
+    bool mbFailSignal;
+
+    /// The values passed to Signal, in order.
+    std::vector<uint64_t> mSignaledValues;
+
+    /// The values passed to WaitForValue, in order.
+    std::vector<uint64_t> mWaitedValues;
+};
+
+//--------------------------------------------------------------------------
+/// Collects harvested work, in the order it was harvested.
+//--------------------------------------------------------------------------
+struct HarvestCollector
+{
+    /// The harvested work.
+    std::vector<int>* mHarvested;
+
+    //--------------------------------------------------------------------------
+    /// Called by Harvest for each finished piece of work.
+    //--------------------------------------------------------------------------
+    void operator()(int inPending) const
+    {
+        mHarvested->push_back(inPending);
+    }
+};
+
+//--------------------------------------------------------------------------
+/// Retire signals one increasing fence value per piece of work, and keeps it pending.
+//--------------------------------------------------------------------------
+static void TestRetire()
+{
+    MockQueueFence fence;
+    ProfilerResultScheduler<int> scheduler(&fence);
+
+    CHECK(scheduler.GetNumPending() == 0);
+
+    CHECK(scheduler.Retire(10));
+    CHECK(scheduler.Retire(11));
+    CHECK(scheduler.Retire(12));
+
+    CHECK(scheduler.GetNumPending() == 3);
+    CHECK(fence.mSignaledValues.size() == 3);
+    CHECK(fence.mSignaledValues[0] == 1);
+    CHECK(fence.mSignaledValues[1] == 2);
+    CHECK(fence.mSignaledValues[2] == 3);
+
+    // A failed signal keeps nothing, and doesn't use up a fence value.
+    fence.mbFailSignal = true;
+    CHECK(scheduler.Retire(13) == false);
+    CHECK(scheduler.GetNumPending() == 3);
+
+    fence.mbFailSignal = false;
+    CHECK(scheduler.Retire(14));
+    CHECK(fence.mSignaledValues.back() == 4);
+    CHECK(scheduler.GetNumPending() == 4);
+}
+
+//--------------------------------------------------------------------------
+/// Harvest returns only the work the GPU has finished, oldest first, without waiting.
+//--------------------------------------------------------------------------
+static void TestHarvestInOrder()
+{
+    MockQueueFence fence;
+    ProfilerResultScheduler<int> scheduler(&fence);
+
+    std::vector<int> harvested;
+    HarvestCollector collector = { &harvested };
+
+    // Nothing retired, so there's nothing to harvest and no reason to read the fence.
+    CHECK(scheduler.Harvest(false, collector) == 0);
+    CHECK(fence.mNumCompletedReads == 0);
+
+    for (int i = 0; i < 5; i++)
+    {
+        CHECK(scheduler.Retire(100 + i));
+    }
+
+    // The GPU hasn't finished anything.
+    CHECK(scheduler.Harvest(false, collector) == 0);
+    CHECK(harvested.empty());
+
+    // The GPU has finished the first two submits.
+    fence.mCompletedValue = 2;
+    CHECK(scheduler.Harvest(false, collector) == 2);
+    CHECK(harvested.size() == 2);
+    CHECK(harvested[0] == 100);
+    CHECK(harvested[1] == 101);
+    CHECK(scheduler.GetNumPending() == 3);
+
+    // The GPU has finished everything. The rest comes back in the order it was retired.
+    fence.mCompletedValue = 5;
+    CHECK(scheduler.Harvest(false, collector) == 3);
+    CHECK(harvested.size() == 5);
+
+    for (int i = 0; i < 5 && i < static_cast<int>(harvested.size()); i++)
+    {
+        CHECK(harvested[i] == 100 + i);
+    }
+
+    CHECK(scheduler.GetNumPending() == 0);
+    CHECK(fence.mWaitedValues.empty());
+}
+
+//--------------------------------------------------------------------------
+/// A blocking harvest waits for the last retired value, then returns all of the work.
+//--------------------------------------------------------------------------
+static void TestBlockingHarvest()
+{
+    MockQueueFence fence;
+    ProfilerResultScheduler<int> scheduler(&fence);
+
+    std::vector<int> harvested;
+    HarvestCollector collector = { &harvested };
+
+    for (int i = 0; i < 4; i++)
+    {
+        CHECK(scheduler.Retire(200 + i));
+    }
+
+    fence.mCompletedValue = 1;
+
+    CHECK(scheduler.Harvest(true, collector) == 4);
+    CHECK(fence.mWaitedValues.size() == 1 && fence.mWaitedValues[0] == 4);
+    CHECK(harvested.size() == 4);
+
+    for (int i = 0; i < 4 && i < static_cast<int>(harvested.size()); i++)
+    {
+        CHECK(harvested[i] == 200 + i);
+    }
+
+    CHECK(scheduler.GetNumPending() == 0);
+
+    // When the GPU is already done, a blocking harvest doesn't wait.
+    CHECK(scheduler.Retire(300));
+    fence.mCompletedValue = 5;
+
+    CHECK(scheduler.Harvest(true, collector) == 1);
+    CHECK(fence.mWaitedValues.size() == 1);
+    CHECK(harvested.back() == 300);
+}
+
+int main()
+{
+    TestRetire();
+    TestHarvestInOrder();
+    TestBlockingHarvest();
+
+    if (s_NumFailures == 0)
+    {
+        printf("ProfilerResultScheduler: all checks passed\n");
+    }
+
+    return (s_NumFailures == 0) ? 0 : 1;
+}